@@ -32,6 +32,7 @@
 #include <glib.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <pthread.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -47,7 +48,9 @@
 #include "pho_type_utils.h"
 
 #include "admin_utils.h"
+#include "gc.h"
 #include "import.h"
+#include "scrub.h"
 
 enum pho_cfg_params_admin {
     /* Actual admin parameters */
@@ -127,6 +130,71 @@ int _send_and_receive(struct pho_comm_info *comm, pho_req_t *req,
     return rc;
 }
 
+int admin_read_alloc_medium(struct admin_handle *adm,
+                            const struct pho_id *medium,
+                            enum read_target_allocation_op operation,
+                            enum pho_qos_class qos, pho_resp_t **resp)
+{
+    pho_req_t req;
+    int rc;
+
+    pho_srl_request_read_alloc(&req, 1);
+    req.id = 0;
+    req.has_qos = true;
+    req.qos = qos;
+    req.ralloc->n_required = 1;
+    req.ralloc->operation = operation;
+    req.ralloc->med_ids[0]->family = medium->family;
+    req.ralloc->med_ids[0]->name = xstrdup(medium->name);
+    req.ralloc->med_ids[0]->library = xstrdup(medium->library);
+
+    rc = _send_and_receive(&adm->phobosd_comm, &req, resp);
+    if (rc)
+        LOG_RETURN(rc,
+                   "Failed to send or receive read allocation for medium "
+                   "(family '%s', name '%s', library '%s')",
+                   rsc_family2str(medium->family), medium->name,
+                   medium->library);
+
+    if (pho_response_is_error(*resp)) {
+        rc = (*resp)->error->rc;
+        LOG_GOTO(free_resp, rc, "Received error response to read allocation");
+    } else if (!pho_response_is_read(*resp) || (*resp)->req_id != 0 ||
+               (*resp)->ralloc->n_media != 1) {
+        LOG_GOTO(free_resp, rc = -EPROTO,
+                 "Received a wrong response to the read allocation");
+    }
+
+    return 0;
+
+free_resp:
+    pho_srl_response_free(*resp, true);
+
+    return rc;
+}
+
+int admin_release_medium(struct admin_handle *adm, const struct pho_id *medium)
+{
+    pho_req_t req;
+    int rc;
+
+    pho_srl_request_release_alloc(&req, 1);
+    req.id = 1;
+    req.release->media[0]->med_id->family = medium->family;
+    req.release->media[0]->med_id->name = xstrdup(medium->name);
+    req.release->media[0]->med_id->library = xstrdup(medium->library);
+    req.release->media[0]->size_written = 0;
+    req.release->media[0]->nb_extents_written = 0;
+    req.release->media[0]->rc = 0;
+    req.release->media[0]->to_sync = false;
+
+    rc = _send(&adm->phobosd_comm, &req);
+    if (rc)
+        pho_error(rc, "Failed to send release request");
+
+    return rc;
+}
+
 static int _admin_notify(struct admin_handle *adm, struct pho_id *id,
                          enum notify_op op, bool need_to_wait)
 {
@@ -1311,149 +1379,177 @@ static ssize_t _sum_extent_size(struct extent *extents, int count)
     return total_size;
 }
 
-static int _get_source_medium(struct admin_handle *adm,
-                              const struct pho_id *source,
-                              struct pho_ext_loc *loc,
-                              struct pho_io_descr *iod,
-                              struct io_adapter_module **ioa,
-                              enum fs_type *fs_type)
+static int _send_and_recv_release(struct admin_handle *adm,
+                                  const struct pho_id *sources,
+                                  const struct pho_io_descr *iod_sources,
+                                  int n_sources,
+                                  int req_id, const struct pho_id *target,
+                                  const struct pho_io_descr *iod_target,
+                                  ssize_t total_size_written,
+                                  ssize_t nb_extents_written)
 {
     pho_resp_t *resp;
     pho_req_t req;
     int rc;
+    int i;
 
-    pho_srl_request_read_alloc(&req, 1);
-    req.id = 1;
-    req.ralloc->n_required = 1;
-    req.ralloc->operation = PHO_READ_TARGET_ALLOC_OP_READ;
-    req.ralloc->med_ids[0]->family = source->family;
-    req.ralloc->med_ids[0]->name = xstrdup(source->name);
-    req.ralloc->med_ids[0]->library = xstrdup(source->library);
+    if (target != NULL)
+        pho_srl_request_release_alloc(&req, n_sources + 1);
+    else
+        pho_srl_request_release_alloc(&req, n_sources);
+    req.id = req_id;
+    for (i = 0; i < n_sources; ++i) {
+        pho_req_release_elt_t *elt = req.release->media[i];
+
+        elt->med_id->family = sources[i].family;
+        elt->med_id->name = xstrdup(sources[i].name);
+        elt->med_id->library = xstrdup(sources[i].library);
+        elt->rc = iod_sources[i].iod_rc;
+        elt->size_written = 0;
+        elt->nb_extents_written = 0;
+        elt->to_sync = false;
+    }
+
+    if (target == NULL) {
+        rc = _send(&adm->phobosd_comm, &req);
+
+        return rc;
+    }
+
+    req.release->media[n_sources]->med_id->family = target->family;
+    req.release->media[n_sources]->med_id->name = xstrdup(target->name);
+    req.release->media[n_sources]->med_id->library =
+        xstrdup(target->library);
+    req.release->media[n_sources]->rc = iod_target->iod_rc;
+    req.release->media[n_sources]->size_written = total_size_written;
+    req.release->media[n_sources]->nb_extents_written = nb_extents_written;
+    req.release->media[n_sources]->to_sync = true;
 
     rc = _send_and_receive(&adm->phobosd_comm, &req, &resp);
     if (rc)
         return rc;
 
-    if (pho_response_is_error(resp) && resp->req_id == 1)
-        LOG_RETURN(resp->error->rc, "Error for read allocation");
+    if (pho_response_is_error(resp) && resp->req_id == req_id)
+        LOG_RETURN(resp->error->rc, "Error for release request");
 
-    if (!(pho_response_is_read(resp) && resp->req_id == 1))
-        LOG_RETURN(-EBADMSG, "Bad response for read allocation: ID #%d - '%s'",
+    if (!(pho_response_is_release(resp) && resp->req_id == req_id))
+        LOG_RETURN(-EBADMSG, "Bad response for release request: ID #%d - '%s'",
                    resp->req_id, pho_srl_response_kind_str(resp));
 
-    *fs_type = (enum fs_type)resp->ralloc->media[0]->fs_type;
-    rc = get_io_adapter(*fs_type, ioa);
-    if (rc)
-        LOG_GOTO(free_resp, rc, "Failed to init read IO adapter");
-
-    loc->root_path = xstrdup(resp->ralloc->media[0]->root_path);
-    loc->addr_type = (enum address_type)resp->ralloc->media[0]->addr_type;
-    iod->iod_loc = loc;
-
-free_resp:
     pho_srl_response_free(resp, true);
 
     return rc;
 }
 
-static int _get_target_medium(struct admin_handle *adm,
-                              const struct pho_id *source,
-                              ssize_t total_size,
-                              struct tags *tags,
-                              struct pho_ext_loc *loc,
-                              struct pho_io_descr *iod,
-                              struct pho_id *target)
+/**
+ * Allocate the media to read and a medium to copy their extents to, in a
+ * single write allocation which carries the source media. The LRS answers
+ * once all these media are mounted.
+ *
+ * The target is an empty medium if \p empty_target is true, otherwise the LRS
+ * prefers a medium already holding \p grouping. It is neither one of the
+ * sources nor one of the \p n_excluded media of \p excluded.
+ */
+static int _get_source_and_target_media(struct admin_handle *adm,
+                                        const struct pho_id *sources,
+                                        int n_sources,
+                                        const struct pho_id *excluded,
+                                        int n_excluded,
+                                        ssize_t total_size,
+                                        struct tags *tags,
+                                        const char *grouping,
+                                        bool empty_target,
+                                        struct pho_ext_loc *loc_sources,
+                                        struct pho_io_descr *iod_sources,
+                                        struct io_adapter_module **ioa,
+                                        enum fs_type *fs_type,
+                                        struct pho_ext_loc *loc_target,
+                                        struct pho_io_descr *iod_target,
+                                        struct pho_id *target)
 {
+    pho_resp_write_elt_t *wresp;
     pho_resp_t *resp;
     pho_req_t req;
     int rc;
     int i;
 
     pho_srl_request_write_alloc(&req, 1, &tags->n_tags);
+    pho_srl_request_write_alloc_sources(&req, n_sources);
+    if (n_excluded > 0)
+        pho_srl_request_write_alloc_excluded(&req, n_excluded);
     req.id = 2;
-    req.walloc->family = source->family;
+    req.has_qos = true;
+    req.qos = PHO_QOS_BULK;
+    req.walloc->family = sources[0].family;
     req.walloc->prevent_duplicate = true;
+    if (grouping)
+        req.walloc->grouping = xstrdup(grouping);
     req.walloc->media[0]->size = total_size;
-    req.walloc->media[0]->empty_medium = true;
+    req.walloc->media[0]->empty_medium = empty_target;
     for (i = 0; i < tags->n_tags; ++i)
         req.walloc->media[0]->tags[i] = xstrdup(tags->tags[i]);
+    for (i = 0; i < n_sources; ++i) {
+        req.walloc->sources[i]->family = sources[i].family;
+        req.walloc->sources[i]->name = xstrdup(sources[i].name);
+        req.walloc->sources[i]->library = xstrdup(sources[i].library);
+    }
+    for (i = 0; i < n_excluded; ++i) {
+        req.walloc->excluded[i]->family = excluded[i].family;
+        req.walloc->excluded[i]->name = xstrdup(excluded[i].name);
+        req.walloc->excluded[i]->library = xstrdup(excluded[i].library);
+    }
 
     rc = _send_and_receive(&adm->phobosd_comm, &req, &resp);
     if (rc)
         return rc;
 
     if (pho_response_is_error(resp) && resp->req_id == 2)
-        LOG_RETURN(resp->error->rc, "Error for write allocation");
-
-    if (!(pho_response_is_write(resp) && resp->req_id == 2))
-        LOG_RETURN(-EBADMSG, "Bad response for write allocation: ID #%d - '%s'",
-                   resp->req_id, pho_srl_response_kind_str(resp));
+        LOG_GOTO(free_resp, rc = resp->error->rc,
+                 "Error for read and write allocation");
 
-    loc->root_path = xstrdup(resp->walloc->media[0]->root_path);
-    loc->addr_type =
-        (enum address_type)resp->walloc->media[0]->addr_type;
-    iod->iod_flags = PHO_IO_REPLACE | PHO_IO_NO_REUSE;
-    iod->iod_loc = loc;
+    if (!(pho_response_is_write(resp) && resp->req_id == 2 &&
+          resp->walloc->n_sources == n_sources))
+        LOG_GOTO(free_resp, rc = -EBADMSG,
+                 "Bad response for read and write allocation: ID #%d - '%s'",
+                 resp->req_id, pho_srl_response_kind_str(resp));
 
-    target->family = resp->walloc->media[0]->med_id->family;
-    pho_id_name_set(target, resp->walloc->media[0]->med_id->name,
-                    resp->walloc->media[0]->med_id->library);
+    wresp = resp->walloc->media[0];
+    target->family = wresp->med_id->family;
+    pho_id_name_set(target, wresp->med_id->name, wresp->med_id->library);
 
-    pho_srl_response_free(resp, true);
-
-    return rc;
-}
-
-static int _send_and_recv_release(struct admin_handle *adm,
-                                  const struct pho_id *source,
-                                  const struct pho_io_descr *iod_source,
-                                  int req_id, const struct pho_id *target,
-                                  const struct pho_io_descr *iod_target,
-                                  ssize_t total_size_written,
-                                  ssize_t nb_extents_written)
-{
-    pho_resp_t *resp;
-    pho_req_t req;
-    int rc;
+    *fs_type = (enum fs_type)resp->walloc->sources[0]->fs_type;
+    rc = get_io_adapter(*fs_type, ioa);
+    if (rc) {
+        int rc2;
 
-    if (target != NULL)
-        pho_srl_request_release_alloc(&req, 2);
-    else
-        pho_srl_request_release_alloc(&req, 1);
-    req.id = req_id;
-    req.release->media[0]->med_id->family = source->family;
-    req.release->media[0]->med_id->name = xstrdup(source->name);
-    req.release->media[0]->med_id->library = xstrdup(source->library);
-    req.release->media[0]->rc = iod_source->iod_rc;
-    req.release->media[0]->size_written = 0;
-    req.release->media[0]->nb_extents_written = 0;
-    req.release->media[0]->to_sync = false;
+        pho_error(rc, "Failed to init read IO adapter");
 
-    if (target == NULL) {
-        rc = _send(&adm->phobosd_comm, &req);
+        /* nothing was copied, give all the allocated media back */
+        for (i = 0; i < n_sources; ++i)
+            iod_sources[i].iod_rc = rc;
+        iod_target->iod_rc = rc;
+        rc2 = _send_and_recv_release(adm, sources, iod_sources, n_sources, 3,
+                                     target, iod_target, 0, 0);
+        if (rc2)
+            pho_error(rc2, "Failed to release the allocated media");
 
-        return rc;
+        goto free_resp;
     }
 
-    req.release->media[1]->med_id->family = target->family;
-    req.release->media[1]->med_id->name = xstrdup(target->name);
-    req.release->media[1]->med_id->library = xstrdup(target->library);
-    req.release->media[1]->rc = iod_target->iod_rc;
-    req.release->media[1]->size_written = total_size_written;
-    req.release->media[1]->nb_extents_written = nb_extents_written;
-    req.release->media[1]->to_sync = true;
-
-    rc = _send_and_receive(&adm->phobosd_comm, &req, &resp);
-    if (rc)
-        return rc;
+    for (i = 0; i < n_sources; ++i) {
+        pho_resp_read_elt_t *rresp = resp->walloc->sources[i];
 
-    if (pho_response_is_error(resp) && resp->req_id == req_id)
-        LOG_RETURN(resp->error->rc, "Error for release request");
+        loc_sources[i].root_path = xstrdup(rresp->root_path);
+        loc_sources[i].addr_type = (enum address_type)rresp->addr_type;
+        iod_sources[i].iod_loc = &loc_sources[i];
+    }
 
-    if (!(pho_response_is_release(resp) && resp->req_id == req_id))
-        LOG_RETURN(-EBADMSG, "Bad response for release request: ID #%d - '%s'",
-                   resp->req_id, pho_srl_response_kind_str(resp));
+    loc_target->root_path = xstrdup(wresp->root_path);
+    loc_target->addr_type = (enum address_type)wresp->addr_type;
+    iod_target->iod_flags = PHO_IO_REPLACE | PHO_IO_NO_REUSE;
+    iod_target->iod_loc = loc_target;
 
+free_resp:
     pho_srl_response_free(resp, true);
 
     return rc;
@@ -1558,8 +1654,16 @@ static int _retrieve_fstype_from_medium(struct admin_handle *adm,
     return 0;
 }
 
-int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
-                        struct tags *tags)
+/**
+ * Copy the live extents of \p source to another medium, then format it.
+ *
+ * The extents copied are swapped in the DSS once the target is synced, even if
+ * the copy is interrupted, so that a next repack of \p source only copies the
+ * remaining ones.
+ */
+static int _repack_medium(struct admin_handle *adm, const struct pho_id *source,
+                          struct tags *tags, const char *grouping,
+                          bool empty_target)
 {
     enum fs_type source_fs_type = PHO_FS_INVAL;
     struct pho_io_descr iod_source = {0};
@@ -1572,13 +1676,11 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
     int ext_cnt_done = 0;
     struct pho_id target;
     ssize_t total_size;
+    int copy_rc = 0;
     int ext_cnt;
     int rc;
     int i;
 
-    if (source->family != PHO_RSC_TAPE)
-        LOG_RETURN(-ENOTSUP, "Repack operation is only available for tapes");
-
     /* Invoke garbage collector for source tape */
     rc = dss_update_gc_for_tape(&adm->dss, source);
     if (rc)
@@ -1595,21 +1697,15 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
 
     new_ext_uuids = g_array_new(FALSE, TRUE, sizeof(ext_res[0].uuid));
 
-    /* Prepare read allocation */
-    rc = _get_source_medium(adm, source, &loc_source, &iod_source, &ioa,
-                            &source_fs_type);
+    /* Prepare read and write allocation */
+    rc = _get_source_and_target_media(adm, source, 1, NULL, 0, total_size,
+                                      tags, grouping, empty_target,
+                                      &loc_source, &iod_source, &ioa,
+                                      &source_fs_type, &loc_target,
+                                      &iod_target, &target);
     if (rc)
         goto free_ext;
 
-    /* Prepare write allocation */
-    rc = _get_target_medium(adm, source, total_size, tags, &loc_target,
-                            &iod_target, &target);
-    if (rc) {
-        free(loc_source.root_path);
-        _send_and_recv_release(adm, source, &iod_source, 3, NULL, NULL, 0, 0);
-        goto free_ext;
-    }
-
     /* Copy loop */
     for (i = 0; i < ext_cnt; ++i, ++ext_cnt_done) {
         struct extent ext_new = {0};
@@ -1639,10 +1735,11 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
 
     if (rc) {
         pho_error(rc, "Error encountered, repack is interrupted");
-        goto free_ext;
+        /* keep the extents already copied */
+        copy_rc = rc;
     }
 
-    rc = _send_and_recv_release(adm, source, &iod_source, 3,
+    rc = _send_and_recv_release(adm, source, &iod_source, 1, 3,
                                 &target, &iod_target,
                                 ext_cnt_done == ext_cnt ?
                                     total_size :
@@ -1662,6 +1759,9 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
     g_array_free(new_ext_uuids, TRUE);
     new_ext_uuids = NULL;
 
+    if (copy_rc)
+        GOTO(free_ext, rc = copy_rc);
+
 format:
     if (source_fs_type == PHO_FS_INVAL) {
         rc = _retrieve_fstype_from_medium(adm, source, &source_fs_type);
@@ -1682,13 +1782,15 @@ format:
 
 free_ext:
     if (new_ext_uuids) {
-        rc = dss_update_extent_state(&adm->dss,
-                                     (const char **)new_ext_uuids->data,
-                                     (int)new_ext_uuids->len,
-                                     PHO_EXT_ST_ORPHAN);
+        int rc2;
+
+        rc2 = dss_update_extent_state(&adm->dss,
+                                      (const char **)new_ext_uuids->data,
+                                      (int)new_ext_uuids->len,
+                                      PHO_EXT_ST_ORPHAN);
         g_array_free(new_ext_uuids, TRUE);
-        if (rc)
-            pho_error(rc, "Failed to update state of new extents to orphan");
+        if (rc2)
+            pho_error(rc2, "Failed to update state of new extents to orphan");
 
     }
     dss_res_free(ext_res, ext_cnt);
@@ -1696,93 +1798,1082 @@ free_ext:
     return rc;
 }
 
-int phobos_admin_ping_lrs(struct admin_handle *adm)
+int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
+                        struct tags *tags)
 {
-    pho_resp_t *resp;
-    pho_req_t req;
-    int rid = 1;
-    int rc;
+    if (source->family != PHO_RSC_TAPE)
+        LOG_RETURN(-ENOTSUP, "Repack operation is only available for tapes");
 
-    pho_srl_request_ping_alloc(&req);
+    return _repack_medium(adm, source, tags, NULL, true);
+}
 
-    req.id = rid;
+/** A medium to migrate */
+struct migrate_source {
+    struct media_info *medium;   /**< DSS information of the medium */
+    const char *grouping;        /**< Grouping its extents are consolidated
+                                   *  with, NULL if none
+                                   */
+    bool put_forbidden;          /**< Whether this run forbade the writes on
+                                   *  the medium, and must restore them
+                                   */
+};
 
-    rc = _send_and_receive(&adm->phobosd_comm, &req, &resp);
-    if (rc)
-        LOG_RETURN(rc, "Error with phobosd communication");
+/** Media migrated one after the other by the same stream */
+struct migrate_batch {
+    struct migrate_source *sources;
+    int n_sources;
+    ssize_t size;                /**< Space used on the media of the batch */
+};
 
-    /* expect ping response, send error otherwise */
-    if (!(pho_response_is_ping(resp) && resp->req_id == rid))
-        pho_error(rc = -EBADMSG, "Bad response from phobosd");
+/** State shared by the streams of a migration */
+struct migrate_engine {
+    pthread_mutex_t mutex;       /**< Protects next_batch and rc */
+    struct migrate_batch *batches;
+    int n_batches;
+    int next_batch;              /**< Next batch to hand to a stream */
+    struct tags *tags;           /**< Tags of the target media */
+    int rc;                      /**< First error of the streams */
+};
 
-    pho_srl_response_free(resp, false);
+static struct migrate_batch *_migrate_next_batch(struct migrate_engine *engine)
+{
+    struct migrate_batch *batch = NULL;
 
-    return rc;
+    MUTEX_LOCK(&engine->mutex);
+    if (engine->next_batch < engine->n_batches)
+        batch = &engine->batches[engine->next_batch++];
+    MUTEX_UNLOCK(&engine->mutex);
+
+    return batch;
 }
 
-int phobos_admin_ping_tlc(const char *library, bool *library_is_up)
+static void _migrate_set_rc(struct migrate_engine *engine, int rc)
 {
-    struct lib_handle lib_hdl;
-    int rc2;
+    MUTEX_LOCK(&engine->mutex);
+    if (!engine->rc)
+        engine->rc = rc;
+    MUTEX_UNLOCK(&engine->mutex);
+}
+
+/**
+ * Stream of a migration: repack the media of the batches, using its own DSS
+ * and LRS connections.
+ *
+ * The first medium of a grouping is copied to an empty medium, which records
+ * the grouping, so that the next media of the grouping are consolidated on it.
+ */
+static void *_migrate_stream(void *arg)
+{
+    struct migrate_engine *engine = arg;
+    struct migrate_batch *batch;
+    struct admin_handle adm;
     int rc;
+    int i;
 
-    ENTRY;
+    rc = phobos_admin_init(&adm, true, NULL);
+    if (rc) {
+        _migrate_set_rc(engine, rc);
+        return NULL;
+    }
 
-    rc = get_lib_adapter_and_open(PHO_LIB_SCSI, &lib_hdl, library);
+    while ((batch = _migrate_next_batch(engine)) != NULL) {
+        for (i = 0; i < batch->n_sources; ++i) {
+            struct migrate_source *source = &batch->sources[i];
+            struct pho_id *id = &source->medium->rsc.id;
+
+            pho_info("Migrating medium (family '%s', name '%s', library "
+                     "'%s')", rsc_family2str(id->family), id->name,
+                     id->library);
+            rc = _repack_medium(&adm, id, engine->tags, source->grouping,
+                                i == 0 || !source->grouping);
+            if (rc) {
+                pho_error(rc, "Failed to migrate medium (family '%s', name "
+                          "'%s', library '%s')", rsc_family2str(id->family),
+                          id->name, id->library);
+                _migrate_set_rc(engine, rc);
+            }
+        }
+    }
+
+    phobos_admin_fini(&adm);
+
+    return NULL;
+}
+
+static int _migrate_fetch_medium(struct admin_handle *adm,
+                                 const struct pho_id *id,
+                                 struct media_info **medium)
+{
+    struct dss_filter filter;
+    int count;
+    int rc;
+
+    rc = dss_filter_build(&filter,
+                          "{\"$AND\": ["
+                          "  {\"DSS::MDA::family\": \"%s\"},"
+                          "  {\"DSS::MDA::id\": \"%s\"},"
+                          "  {\"DSS::MDA::library\": \"%s\"}"
+                          "]}", rsc_family2str(id->family), id->name,
+                          id->library);
     if (rc)
-        return rc;
+        LOG_RETURN(rc, "Failed to build medium filter");
 
-    rc = ldm_lib_ping(&lib_hdl, library_is_up);
-    rc2 = ldm_lib_close(&lib_hdl);
-    if (rc2)
-        pho_error(rc2, "Failed to close library");
+    rc = dss_media_get(&adm->dss, &filter, medium, &count, NULL);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc,
+                   "Failed to retrieve medium (family '%s', name '%s', library "
+                   "'%s') info from DSS", rsc_family2str(id->family),
+                   id->name, id->library);
 
-    rc = rc ? : rc2;
+    if (count != 1) {
+        dss_res_free(*medium, count);
+        *medium = NULL;
+        LOG_RETURN(-ENXIO,
+                   "Medium (family '%s', name '%s', library '%s') not found",
+                   rsc_family2str(id->family), id->name, id->library);
+    }
 
-    return rc;
+    return 0;
 }
 
 /**
- * Construct the medium string for the extent list filter.
- *
- * The caller must ensure medium_str is initialized before calling.
- *
- * \param[in,out]   medium_str      Empty medium string.
- * \param[in]       medium          Medium filter.
+ * Number of the unlocked drives of \p family, 0 if they cannot be counted.
  */
-static void phobos_construct_medium(GString *medium_str, const char *medium)
+static int _migrate_count_drives(struct admin_handle *adm,
+                                 enum rsc_family family)
 {
-    /**
-     * We prefered putting this line in a separate function to ease a
-     * possible future change that would allow for multiple medium selection.
-     */
-    g_string_append_printf(medium_str, "{\"DSS::EXT::medium_id\": \"%s\"}",
-                           medium);
+    struct dss_filter filter;
+    struct dev_info *devs;
+    int count;
+    int rc;
+
+    rc = dss_filter_build(&filter,
+                          "{\"$AND\": ["
+                          "  {\"DSS::DEV::family\": \"%s\"},"
+                          "  {\"DSS::DEV::adm_status\": \"%s\"}"
+                          "]}", rsc_family2str(family),
+                          rsc_adm_status2str(PHO_RSC_ADM_ST_UNLOCKED));
+    if (rc)
+        return 0;
+
+    rc = dss_device_get(&adm->dss, &filter, &devs, &count, NULL);
+    dss_filter_free(&filter);
+    if (rc)
+        return 0;
+
+    dss_res_free(devs, count);
+
+    return count;
+}
+
+static int _migrate_source_cmp(const void *lhs, const void *rhs)
+{
+    const struct migrate_source *a = lhs;
+    const struct migrate_source *b = rhs;
+    int cmp;
+
+    /* media without grouping last */
+    if (!a->grouping || !b->grouping)
+        cmp = (a->grouping == NULL) - (b->grouping == NULL);
+    else
+        cmp = strcmp(a->grouping, b->grouping);
+    if (cmp)
+        return cmp;
+
+    return (a->medium->stats.logc_spc_used >
+            b->medium->stats.logc_spc_used) -
+           (a->medium->stats.logc_spc_used <
+            b->medium->stats.logc_spc_used);
+}
+
+static int _migrate_batch_cmp(const void *lhs, const void *rhs)
+{
+    const struct migrate_batch *a = lhs;
+    const struct migrate_batch *b = rhs;
+
+    return (a->size > b->size) - (a->size < b->size);
 }
 
 /**
- * Construct the extent string for the extent list filter.
- *
- * The caller must ensure extent_str is initialized before calling.
- *
- * \param[in,out]   extent_str      Empty extent string.
- * \param[in]       res             Ressource filter.
- * \param[in]       n_res           Number of requested resources.
- * \param[in]       is_pattern      True if search done using POSIX pattern.
+ * Group the sources by grouping, each medium without grouping being its own
+ * batch, and order the batches by the space used on their media so that the
+ * smallest ones, which are the quickest to free, are migrated first.
  */
-static void phobos_construct_extent(GString *extent_str, const char **res,
-                                    int n_res, bool is_pattern)
+static struct migrate_batch *_migrate_build_batches(
+    struct migrate_source *sources, int n_sources, int *n_batches)
 {
-    char *res_prefix = (is_pattern ? "{\"$REGEXP\": " : "");
-    char *res_suffix = (is_pattern ? "}" : "");
+    struct migrate_batch *batches;
     int i;
 
-    if (n_res > 1)
-        g_string_append_printf(extent_str, "{\"$OR\" : [");
+    qsort(sources, n_sources, sizeof(*sources), _migrate_source_cmp);
 
-    for (i = 0; i < n_res; ++i)
-        g_string_append_printf(extent_str,
-                               "%s {\"DSS::OBJ::oid\":\"%s\"}%s %s",
+    batches = xcalloc(n_sources, sizeof(*batches));
+    *n_batches = 0;
+    for (i = 0; i < n_sources; ++i) {
+        const char *grouping = sources[i].grouping;
+        struct migrate_batch *batch = NULL;
+
+        if (*n_batches > 0 && grouping) {
+            batch = &batches[*n_batches - 1];
+            if (!batch->sources[0].grouping ||
+                strcmp(grouping, batch->sources[0].grouping))
+                batch = NULL;
+        }
+
+        if (!batch) {
+            batch = &batches[(*n_batches)++];
+            batch->sources = &sources[i];
+        }
+
+        batch->n_sources++;
+        batch->size += sources[i].medium->stats.logc_spc_used;
+    }
+
+    qsort(batches, *n_batches, sizeof(*batches), _migrate_batch_cmp);
+
+    return batches;
+}
+
+/**
+ * Forbid or restore the writes on the media to migrate, so that they are not
+ * chosen as targets.
+ *
+ * The writes are only restored on the media on which this run forbade them:
+ * the media already write-forbidden, by an admin or by an interrupted run, are
+ * left as they were.
+ */
+static void _migrate_set_put(struct admin_handle *adm,
+                             struct migrate_source *sources, int n_sources,
+                             bool migrating)
+{
+    int i;
+
+    for (i = 0; i < n_sources; ++i) {
+        struct media_info *medium = sources[i].medium;
+        struct media_info updated;
+        int rc;
+
+        if (migrating ? !medium->flags.put : !sources[i].put_forbidden)
+            continue;
+
+        updated = *medium;
+        updated.flags.put = !migrating;
+        rc = dss_media_update(&adm->dss, medium, &updated, 1, PUT_ACCESS);
+        if (rc) {
+            pho_warn("Failed to update put flag of medium (family '%s', name "
+                     "'%s', library '%s'): %s",
+                     rsc_family2str(medium->rsc.id.family),
+                     medium->rsc.id.name, medium->rsc.id.library,
+                     strerror(-rc));
+            continue;
+        }
+
+        sources[i].put_forbidden = migrating;
+    }
+}
+
+int phobos_admin_migrate(struct admin_handle *adm, const struct pho_id *ids,
+                         int n_ids, struct tags *tags, int nb_streams)
+{
+    struct migrate_engine engine = {0};
+    struct migrate_source *sources;
+    pthread_t *streams;
+    int n_sources = 0;
+    int n_streams;
+    int n_drives;
+    int rc = 0;
+    int i;
+
+    for (i = 0; i < n_ids; ++i)
+        if (ids[i].family != PHO_RSC_TAPE)
+            LOG_RETURN(-ENOTSUP,
+                       "Migrate operation is only available for tapes");
+
+    sources = xcalloc(n_ids, sizeof(*sources));
+    for (i = 0; i < n_ids; ++i) {
+        struct media_info *medium;
+
+        rc = _migrate_fetch_medium(adm, &ids[i], &medium);
+        if (rc)
+            goto free_sources;
+
+        /* already migrated by a previous run */
+        if (medium->fs.status == PHO_FS_STATUS_BLANK ||
+            medium->fs.status == PHO_FS_STATUS_EMPTY) {
+            pho_verb("Medium (family '%s', name '%s', library '%s') is "
+                     "empty, skipping it", rsc_family2str(ids[i].family),
+                     ids[i].name, ids[i].library);
+            dss_res_free(medium, 1);
+            continue;
+        }
+
+        sources[n_sources].medium = medium;
+        if (medium->groupings.n_tags > 0)
+            sources[n_sources].grouping = medium->groupings.tags[0];
+        n_sources++;
+    }
+
+    if (n_sources == 0)
+        goto free_sources;
+
+    engine.batches = _migrate_build_batches(sources, n_sources,
+                                            &engine.n_batches);
+    engine.tags = tags;
+
+    /* each stream reads a medium and writes another one */
+    n_drives = _migrate_count_drives(adm, PHO_RSC_TAPE);
+    n_streams = max(n_drives / 2, 1);
+    if (nb_streams > 0)
+        n_streams = min(n_streams, nb_streams);
+    n_streams = min(n_streams, engine.n_batches);
+
+    rc = pthread_mutex_init(&engine.mutex, NULL);
+    if (rc)
+        LOG_GOTO(free_batches, rc = -rc,
+                 "Unable to init the migration mutex");
+
+    _migrate_set_put(adm, sources, n_sources, true);
+
+    pho_info("Migrating %d media with %d streams", n_sources, n_streams);
+    streams = xcalloc(n_streams, sizeof(*streams));
+    for (i = 0; i < n_streams; ++i) {
+        rc = pthread_create(&streams[i], NULL, _migrate_stream, &engine);
+        if (rc) {
+            pho_error(-rc, "Unable to start migration stream %d", i);
+            _migrate_set_rc(&engine, -rc);
+            break;
+        }
+    }
+
+    n_streams = i;
+    for (i = 0; i < n_streams; ++i)
+        pthread_join(streams[i], NULL);
+
+    free(streams);
+    _migrate_set_put(adm, sources, n_sources, false);
+    pthread_mutex_destroy(&engine.mutex);
+    rc = engine.rc;
+
+free_batches:
+    free(engine.batches);
+
+free_sources:
+    for (i = 0; i < n_sources; ++i)
+        dss_res_free(sources[i].medium, 1);
+    free(sources);
+
+    return rc;
+}
+
+/** The media of the alive extents of a split being rebuilt */
+struct rebuild_split {
+    struct pho_id *media;        /**< Media of the surviving and already
+                                   *  rebuilt extents, which cannot hold a
+                                   *  rebuilt one
+                                   */
+    int n_media;
+};
+
+/** An extent of a failed medium and the extents it is rebuilt from */
+struct rebuild_extent {
+    struct extent *lost;         /**< Extent stored on a failed medium */
+    struct extent *sources[2];   /**< Surviving extents of its split */
+    int n_sources;
+    int redundancy;              /**< Number of extents of the split which
+                                   *  can still be lost
+                                   */
+    struct rebuild_split *split; /**< Split of the lost extent */
+};
+
+static bool _rebuild_medium_is_failed(struct media_info *failed, int n_failed,
+                                      const struct pho_id *id)
+{
+    int i;
+
+    for (i = 0; i < n_failed; ++i)
+        if (pho_id_equal(&failed[i].rsc.id, id))
+            return true;
+
+    return false;
+}
+
+static int _rebuild_get_failed_media(struct admin_handle *adm,
+                                     struct media_info **failed,
+                                     int *n_failed)
+{
+    struct dss_filter filter;
+    int rc;
+
+    rc = dss_filter_build(&filter, "{\"DSS::MDA::adm_status\": \"%s\"}",
+                          rsc_adm_status2str(PHO_RSC_ADM_ST_FAILED));
+    if (rc)
+        LOG_RETURN(rc, "Failed to build failed media filter");
+
+    rc = dss_media_get(&adm->dss, &filter, failed, n_failed, NULL);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to retrieve failed media");
+
+    return 0;
+}
+
+/**
+ * Fetch the full layouts of the objects with extents on \p medium, skipping
+ * the ones already in \p layouts.
+ */
+static int _rebuild_get_layouts(struct admin_handle *adm,
+                                const struct pho_id *medium,
+                                GPtrArray *layouts)
+{
+    struct layout_info *partial;
+    struct dss_filter filter;
+    int count;
+    int rc;
+    int i;
+
+    rc = dss_filter_build(&filter,
+                          "{\"$AND\": ["
+                          "  {\"DSS::EXT::medium_family\": \"%s\"},"
+                          "  {\"DSS::EXT::medium_id\": \"%s\"},"
+                          "  {\"DSS::EXT::medium_library\": \"%s\"}"
+                          "]}", rsc_family2str(medium->family), medium->name,
+                          medium->library);
+    if (rc)
+        LOG_RETURN(rc, "Failed to build medium filter");
+
+    /* the extents returned are only the ones of the medium */
+    rc = dss_full_layout_get(&adm->dss, NULL, &filter, &partial, &count,
+                             NULL);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc,
+                   "Failed to retrieve the layouts of medium (family '%s', "
+                   "name '%s', library '%s')", rsc_family2str(medium->family),
+                   medium->name, medium->library);
+
+    for (i = 0; i < count; ++i) {
+        struct layout_info *layout;
+        bool known = false;
+        int cnt;
+        int j;
+
+        for (j = 0; j < layouts->len && !known; ++j) {
+            layout = g_ptr_array_index(layouts, j);
+            known = !strcmp(layout->uuid, partial[i].uuid) &&
+                    layout->version == partial[i].version;
+        }
+
+        if (known)
+            continue;
+
+        rc = dss_filter_build(&filter,
+                              "{\"$AND\": ["
+                                  "{\"DSS::LYT::object_uuid\": \"%s\"}, "
+                                  "{\"DSS::LYT::version\": \"%d\"}"
+                              "]}", partial[i].uuid, partial[i].version);
+        if (rc)
+            LOG_GOTO(free_partial, rc, "Cannot build filter");
+
+        rc = dss_full_layout_get(&adm->dss, &filter, NULL, &layout, &cnt,
+                                 NULL);
+        dss_filter_free(&filter);
+        if (rc)
+            LOG_GOTO(free_partial, rc,
+                     "Failed to retrieve the layout of object '%s'",
+                     partial[i].oid);
+
+        if (cnt != 1) {
+            dss_res_free(layout, cnt);
+            LOG_GOTO(free_partial, rc = -ENOENT,
+                     "Did not retrieve one layout for object '%s', %d "
+                     "instead", partial[i].oid, cnt);
+        }
+
+        g_ptr_array_add(layouts, layout);
+    }
+
+free_partial:
+    dss_res_free(partial, count);
+
+    return rc;
+}
+
+/**
+ * Add to \p plan the extents of \p layout stored on failed media, each with
+ * the surviving extents of its split it is rebuilt from.
+ *
+ * A raid1 split is rebuilt by copying any of its surviving replicas, a raid4
+ * split by XORing its two surviving extents. Other layouts are not rebuilt.
+ *
+ * The plan is keyed by lost extent: an extent shared by several layouts is
+ * only rebuilt once, since its migration repoints all of them. \p planned
+ * holds the UUIDs of the extents already in \p plan, \p splits the splits
+ * they belong to.
+ *
+ * \return 0 on success, -ENODATA if a split lost too many extents to be
+ *         rebuilt, -ENOTSUP if the layout cannot be rebuilt.
+ */
+static int _rebuild_plan_layout(struct layout_info *layout,
+                                struct media_info *failed, int n_failed,
+                                GHashTable *planned, GPtrArray *splits,
+                                GArray *plan)
+{
+    const char *mod_name = layout->layout_desc.mod_name;
+    int n_needed;
+    int width;
+    int split;
+
+    if (!strcmp(mod_name, "raid1")) {
+        const char *repl_count;
+
+        repl_count = pho_attr_get(&layout->layout_desc.mod_attrs,
+                                  "raid1.repl_count");
+        if (!repl_count || atoi(repl_count) <= 0)
+            LOG_RETURN(-EINVAL, "Invalid replica count of object '%s'",
+                       layout->oid);
+
+        width = atoi(repl_count);
+        n_needed = 1;
+    } else if (!strcmp(mod_name, "raid4")) {
+        width = 3;
+        n_needed = 2;
+    } else {
+        LOG_RETURN(-ENOTSUP, "Cannot rebuild object '%s' of layout '%s'",
+                   layout->oid, mod_name);
+    }
+
+    for (split = 0; split < layout->ext_count / width; ++split) {
+        struct extent *surviving[width];
+        struct rebuild_split *alive;
+        struct extent *lost[width];
+        int n_surviving = 0;
+        int n_lost = 0;
+        int i;
+
+        for (i = 0; i < layout->ext_count; ++i) {
+            struct extent *extent = &layout->extents[i];
+
+            if (extent->layout_idx / width != split)
+                continue;
+
+            if (!_rebuild_medium_is_failed(failed, n_failed, &extent->media))
+                surviving[n_surviving++] = extent;
+            else if (!g_hash_table_contains(planned, extent->uuid))
+                lost[n_lost++] = extent;
+        }
+
+        if (n_lost == 0)
+            continue;
+
+        if (n_surviving < n_needed)
+            LOG_RETURN(-ENODATA,
+                       "Split %d of object '%s' lost %d extents, it cannot "
+                       "be rebuilt", split, layout->oid, n_lost);
+
+        /* the rebuilt extents are added to the alive ones of the split */
+        alive = xmalloc(sizeof(*alive));
+        alive->media = xcalloc(width, sizeof(*alive->media));
+        alive->n_media = n_surviving;
+        for (i = 0; i < n_surviving; ++i)
+            pho_id_copy(&alive->media[i], &surviving[i]->media);
+        g_ptr_array_add(splits, alive);
+
+        for (i = 0; i < n_lost; ++i) {
+            struct rebuild_extent rebuild = {
+                .lost = lost[i],
+                .n_sources = n_needed,
+                .redundancy = n_surviving - n_needed,
+                .split = alive,
+            };
+
+            memcpy(rebuild.sources, surviving,
+                   n_needed * sizeof(*surviving));
+            g_array_append_val(plan, rebuild);
+            g_hash_table_add(planned, lost[i]->uuid);
+        }
+    }
+
+    return 0;
+}
+
+static void _rebuild_split_free(void *split)
+{
+    free(((struct rebuild_split *)split)->media);
+    free(split);
+}
+
+static int _rebuild_extent_cmp(const void *lhs, const void *rhs)
+{
+    const struct rebuild_extent *left = lhs;
+    const struct rebuild_extent *right = rhs;
+
+    return left->redundancy - right->redundancy;
+}
+
+static int _rebuild_copy_info_cb(const char *key, const char *value,
+                                 void *udata)
+{
+    pho_attr_set(udata, key, value);
+
+    return 0;
+}
+
+static int _rebuild_get_extent(struct admin_handle *adm, const char *uuid,
+                               struct extent **extent)
+{
+    struct dss_filter filter;
+    int count;
+    int rc;
+
+    rc = dss_filter_build(&filter, "{\"DSS::EXT::uuid\": \"%s\"}", uuid);
+    if (rc)
+        LOG_RETURN(rc, "Failed to build extent filter");
+
+    rc = dss_extent_get(&adm->dss, &filter, extent, &count);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to retrieve extent '%s'", uuid);
+
+    if (count != 1) {
+        dss_res_free(*extent, count);
+        LOG_RETURN(-ENOENT, "Did not retrieve one extent '%s', %d instead",
+                   uuid, count);
+    }
+
+    return 0;
+}
+
+/**
+ * Rebuild an extent of a failed medium on a medium holding no other extent of
+ * its split, then swap it with the lost one in the layouts once the target is
+ * synced.
+ */
+static int _rebuild_extent(struct admin_handle *adm,
+                           struct rebuild_extent *rebuild, struct tags *tags)
+{
+    struct pho_io_descr iod_sources[2] = {0};
+    struct pho_ext_loc loc_sources[2] = {0};
+    struct pho_io_descr iod_target = {0};
+    struct pho_ext_loc loc_target = {0};
+    struct io_adapter_module *ioa = NULL;
+    struct extent ext_new = {0};
+    struct pho_id source_ids[2];
+    struct extent *ext_lost;
+    enum fs_type fs_type;
+    struct pho_id target;
+    int copy_rc;
+    int rc;
+    int i;
+
+    /* the full layouts do not carry the attributes of the extents */
+    rc = _rebuild_get_extent(adm, rebuild->lost->uuid, &ext_lost);
+    if (rc)
+        return rc;
+
+    for (i = 0; i < rebuild->n_sources; ++i)
+        pho_id_copy(&source_ids[i], &rebuild->sources[i]->media);
+
+    rc = _get_source_and_target_media(adm, source_ids, rebuild->n_sources,
+                                      rebuild->split->media,
+                                      rebuild->split->n_media,
+                                      ext_lost->size, tags, NULL, false,
+                                      loc_sources, iod_sources, &ioa,
+                                      &fs_type, &loc_target, &iod_target,
+                                      &target);
+    if (rc)
+        goto free_lost;
+
+    _build_new_extent(&target, ext_lost, &ext_new, &iod_sources[0],
+                      &iod_target);
+    ext_new.offset = ext_lost->offset;
+    pho_attrs_foreach(&ext_lost->info, _rebuild_copy_info_cb, &ext_new.info);
+    for (i = 0; i < rebuild->n_sources; ++i) {
+        iod_sources[i].iod_loc->extent = rebuild->sources[i];
+        iod_sources[i].iod_size = rebuild->sources[i]->size;
+    }
+
+    if (rebuild->n_sources == 1) {
+        /* the replica is copied at the address of the source */
+        free(ext_new.address.buff);
+        ext_new.address.buff = NULL;
+        copy_rc = copy_extent(ioa, &iod_sources[0], ioa, &iod_target);
+    } else {
+        iod_target.iod_size = ext_new.size;
+        copy_rc = xor_extents(ioa, iod_sources, ioa, &iod_target);
+    }
+
+    if (copy_rc)
+        pho_error(copy_rc, "Failed to rebuild extent '%s'", ext_lost->uuid);
+    else
+        copy_rc = dss_extent_insert(&adm->dss, &ext_new, 1);
+
+    rc = _send_and_recv_release(adm, source_ids, iod_sources,
+                                rebuild->n_sources, 3, &target, &iod_target,
+                                copy_rc ? 0 : ext_new.size, copy_rc ? 0 : 1);
+    if (copy_rc)
+        GOTO(free_new, rc = copy_rc);
+
+    if (rc)
+        pho_error(rc, "Failed to send/receive release");
+    else
+        rc = dss_update_extent_migrate(&adm->dss, ext_lost->uuid,
+                                       ext_new.uuid);
+
+    if (rc) {
+        int rc2;
+
+        rc2 = dss_update_extent_state(&adm->dss,
+                                      (const char **)&ext_new.uuid, 1,
+                                      PHO_EXT_ST_ORPHAN);
+        if (rc2)
+            pho_error(rc2, "Failed to update state of new extent to orphan");
+    } else {
+        struct rebuild_split *split = rebuild->split;
+
+        pho_id_copy(&split->media[split->n_media++], &target);
+    }
+
+free_new:
+    for (i = 0; i < rebuild->n_sources; ++i)
+        free(loc_sources[i].root_path);
+    free(loc_target.root_path);
+    pho_attrs_free(&iod_sources[0].iod_attrs);
+    pho_attrs_free(&ext_new.info);
+    free(ext_new.address.buff);
+    free(ext_new.uuid);
+
+free_lost:
+    dss_res_free(ext_lost, 1);
+
+    return rc;
+}
+
+void admin_throttle(const struct timespec *start, ssize_t size,
+                    size_t max_rate)
+{
+    struct timespec now;
+    double elapsed;
+    double expected;
+
+    if (max_rate == 0)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - start->tv_sec) +
+              (now.tv_nsec - start->tv_nsec) / 1000000000.0;
+    expected = (double)size / max_rate;
+    if (expected > elapsed)
+        usleep((expected - elapsed) * 1000000);
+}
+
+int phobos_admin_rebuild(struct admin_handle *adm, struct tags *tags,
+                         size_t max_rate, int *n_rebuilt)
+{
+    struct media_info *failed = NULL;
+    struct timespec start;
+    ssize_t size_done = 0;
+    GHashTable *planned;
+    GPtrArray *layouts;
+    GPtrArray *splits;
+    int n_failed = 0;
+    GArray *plan;
+    int rc = 0;
+    int i;
+
+    *n_rebuilt = 0;
+
+    rc = _rebuild_get_failed_media(adm, &failed, &n_failed);
+    if (rc)
+        return rc;
+
+    layouts = g_ptr_array_new();
+    splits = g_ptr_array_new_with_free_func(_rebuild_split_free);
+    planned = g_hash_table_new(g_str_hash, g_str_equal);
+    plan = g_array_new(FALSE, TRUE, sizeof(struct rebuild_extent));
+
+    for (i = 0; i < n_failed; ++i) {
+        rc = _rebuild_get_layouts(adm, &failed[i].rsc.id, layouts);
+        if (rc)
+            goto free_plan;
+    }
+
+    for (i = 0; i < layouts->len; ++i) {
+        int rc2;
+
+        rc2 = _rebuild_plan_layout(g_ptr_array_index(layouts, i), failed,
+                                   n_failed, planned, splits, plan);
+        rc = rc ? : rc2;
+    }
+
+    /* the splits with the least redundancy left are rebuilt first */
+    g_array_sort(plan, _rebuild_extent_cmp);
+
+    pho_info("Rebuilding %u extents of %d failed media", plan->len,
+             n_failed);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < plan->len; ++i) {
+        struct rebuild_extent *rebuild = &g_array_index(plan,
+                                                        struct rebuild_extent,
+                                                        i);
+        int rc2;
+
+        rc2 = _rebuild_extent(adm, rebuild, tags);
+        if (rc2) {
+            rc = rc ? : rc2;
+            continue;
+        }
+
+        (*n_rebuilt)++;
+        size_done += rebuild->lost->size;
+        pho_info("Rebuilt %d/%u extents (%zd bytes)", *n_rebuilt, plan->len,
+                 size_done);
+        admin_throttle(&start, size_done, max_rate);
+    }
+
+free_plan:
+    g_array_free(plan, TRUE);
+    g_hash_table_destroy(planned);
+    g_ptr_array_free(splits, TRUE);
+    for (i = 0; i < layouts->len; ++i)
+        dss_res_free(g_ptr_array_index(layouts, i), 1);
+    g_ptr_array_free(layouts, TRUE);
+    dss_res_free(failed, n_failed);
+
+    return rc;
+}
+
+int phobos_admin_gc(struct admin_handle *adm, struct tags *tags,
+                    int batch_size, double repack_threshold,
+                    size_t *reclaimed_size, int *n_repacked)
+{
+    static const enum rsc_family families[] = {
+        PHO_RSC_DIR,
+        PHO_RSC_RADOS_POOL,
+    };
+    struct dss_medium_usage *usage;
+    struct timespec start;
+    struct timespec end;
+    double elapsed;
+    int count;
+    int rc = 0;
+    int rc2;
+    int i;
+
+    *reclaimed_size = 0;
+    *n_repacked = 0;
+
+    if (batch_size <= 0)
+        LOG_RETURN(-EINVAL, "Invalid batch size %d", batch_size);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* the orphan extents of these media can be deleted one by one */
+    for (i = 0; i < sizeof(families) / sizeof(families[0]); ++i) {
+        rc2 = gc_orphan_extents(adm, families[i], batch_size, reclaimed_size);
+        rc = rc ? : rc2;
+    }
+
+    if (repack_threshold <= 0)
+        goto out;
+
+    /* a tape only gets its space back by being repacked */
+    rc2 = dss_medium_usage_get(&adm->dss, PHO_RSC_TAPE, &usage, &count);
+    if (rc2) {
+        pho_error(rc2, "Failed to retrieve the usage of the tapes");
+        rc = rc ? : rc2;
+        goto out;
+    }
+
+    for (i = 0; i < count; ++i) {
+        struct pho_id *id = &usage[i].medium;
+        ssize_t total_size = usage[i].live_size + usage[i].dead_size;
+
+        if (usage[i].dead_size == 0 ||
+            (double)usage[i].dead_size / total_size < repack_threshold)
+            continue;
+
+        pho_info("Repacking tape (name '%s', library '%s'), %zd of its %zd "
+                 "bytes are dead", id->name, id->library, usage[i].dead_size,
+                 total_size);
+        rc2 = _repack_medium(adm, id, tags, NULL, true);
+        if (rc2) {
+            pho_error(rc2, "Failed to repack tape (name '%s', library '%s')",
+                      id->name, id->library);
+            rc = rc ? : rc2;
+            continue;
+        }
+
+        (*n_repacked)++;
+        *reclaimed_size += usage[i].dead_size;
+    }
+
+    free(usage);
+
+out:
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - start.tv_sec) +
+              (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    pho_info("Garbage collection reclaimed %zu bytes in %.0f s (%.0f bytes "
+             "per hour), %d tapes repacked", *reclaimed_size, elapsed,
+             elapsed > 0 ? *reclaimed_size * 3600 / elapsed : 0,
+             *n_repacked);
+
+    return rc;
+}
+
+int phobos_admin_scrub(struct admin_handle *adm, struct pho_id *ids,
+                       int n_ids, size_t max_rate, int max_time,
+                       int *n_checked, int *n_corrupted)
+{
+    struct scrub_stats stats = {0};
+    struct pho_id *media = ids;
+    struct timespec deadline;
+    struct timespec end;
+    int n_media = n_ids;
+    double elapsed;
+    int rc = 0;
+    int rc2;
+    int i;
+
+    *n_checked = 0;
+    *n_corrupted = 0;
+
+    if (max_time < 0)
+        LOG_RETURN(-EINVAL, "Invalid scrubbing time %d", max_time);
+
+    if (n_ids == 0) {
+        rc = scrub_get_media(adm, &media, &n_media);
+        if (rc)
+            return rc;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stats.start);
+    deadline = stats.start;
+    deadline.tv_sec += max_time;
+
+    for (i = 0; i < n_media; ++i) {
+        struct timespec now;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (max_time && cmp_timespec(&now, &deadline) >= 0)
+            break;
+
+        rc2 = scrub_medium(adm, &media[i], max_rate,
+                           max_time ? &deadline : NULL, &stats);
+        if (rc2)
+            pho_error(rc2, "Failed to scrub medium (family '%s', name '%s', "
+                      "library '%s')", rsc_family2str(media[i].family),
+                      media[i].name, media[i].library);
+
+        rc = rc2 == -EBADMSG ? rc2 : (rc ? : rc2);
+    }
+
+    if (n_ids == 0)
+        free(media);
+
+    *n_checked = stats.n_checked;
+    *n_corrupted = stats.n_corrupted;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - stats.start.tv_sec) +
+              (end.tv_nsec - stats.start.tv_nsec) / 1000000000.0;
+    pho_info("Scrubbed %d media, %d extents (%zu bytes) in %.0f s (%.0f "
+             "bytes per second), %d corrupted, %d could not be read", i,
+             stats.n_checked, stats.size, elapsed,
+             elapsed > 0 ? stats.size / elapsed : 0, stats.n_corrupted,
+             stats.n_failed);
+
+    return rc;
+}
+
+int phobos_admin_ping_lrs(struct admin_handle *adm)
+{
+    pho_resp_t *resp;
+    pho_req_t req;
+    int rid = 1;
+    int rc;
+
+    pho_srl_request_ping_alloc(&req);
+
+    req.id = rid;
+
+    rc = _send_and_receive(&adm->phobosd_comm, &req, &resp);
+    if (rc)
+        LOG_RETURN(rc, "Error with phobosd communication");
+
+    /* expect ping response, send error otherwise */
+    if (!(pho_response_is_ping(resp) && resp->req_id == rid))
+        pho_error(rc = -EBADMSG, "Bad response from phobosd");
+
+    pho_srl_response_free(resp, false);
+
+    return rc;
+}
+
+int phobos_admin_ping_tlc(const char *library, bool *library_is_up)
+{
+    struct lib_handle lib_hdl;
+    int rc2;
+    int rc;
+
+    ENTRY;
+
+    rc = get_lib_adapter_and_open(PHO_LIB_SCSI, &lib_hdl, library);
+    if (rc)
+        return rc;
+
+    rc = ldm_lib_ping(&lib_hdl, library_is_up);
+    rc2 = ldm_lib_close(&lib_hdl);
+    if (rc2)
+        pho_error(rc2, "Failed to close library");
+
+    rc = rc ? : rc2;
+
+    return rc;
+}
+
+/**
+ * Construct the medium string for the extent list filter.
+ *
+ * The caller must ensure medium_str is initialized before calling.
+ *
+ * \param[in,out]   medium_str      Empty medium string.
+ * \param[in]       medium          Medium filter.
+ */
+static void phobos_construct_medium(GString *medium_str, const char *medium)
+{
+    /**
+     * We prefered putting this line in a separate function to ease a
+     * possible future change that would allow for multiple medium selection.
+     */
+    g_string_append_printf(medium_str, "{\"DSS::EXT::medium_id\": \"%s\"}",
+                           medium);
+}
+
+/**
+ * Construct the extent string for the extent list filter.
+ *
+ * The caller must ensure extent_str is initialized before calling.
+ *
+ * \param[in,out]   extent_str      Empty extent string.
+ * \param[in]       res             Ressource filter.
+ * \param[in]       n_res           Number of requested resources.
+ * \param[in]       is_pattern      True if search done using POSIX pattern.
+ */
+static void phobos_construct_extent(GString *extent_str, const char **res,
+                                    int n_res, bool is_pattern)
+{
+    char *res_prefix = (is_pattern ? "{\"$REGEXP\": " : "");
+    char *res_suffix = (is_pattern ? "}" : "");
+    int i;
+
+    if (n_res > 1)
+        g_string_append_printf(extent_str, "{\"$OR\" : [");
+
+    for (i = 0; i < n_res; ++i)
+        g_string_append_printf(extent_str,
+                               "%s {\"DSS::OBJ::oid\":\"%s\"}%s %s",
                                res_prefix,
                                res[i],
                                res_suffix,
@@ -1879,7 +2970,16 @@ int phobos_admin_medium_locate(struct admin_handle *adm,
     if (rc)
         LOG_RETURN(rc, "Error when locating medium");
 
-    /* Return NULL if medium is unlocked, not an error */
+    if (*node_name)
+        return 0;
+
+    /* an unlocked medium goes to the host which will mount it soon */
+    rc = dss_medium_reservation(&adm->dss, medium_id, node_name, NULL);
+    if (rc && rc != -ENOLCK)
+        pho_warn("Unable to get the reservation of medium '%s': %s",
+                 medium_id->name, strerror(-rc));
+
+    /* Return NULL if medium is unlocked and not reserved, not an error */
     return 0;
 }
 
@@ -1918,7 +3018,8 @@ int phobos_admin_clean_locks(struct admin_handle *adm, bool global,
                        lock_type);
 
         else if (lock_type != DSS_MEDIA && lock_type != DSS_OBJECT &&
-            lock_type != DSS_DEVICE && lock_type != DSS_MEDIA_UPDATE_LOCK)
+            lock_type != DSS_DEVICE && lock_type != DSS_MEDIA_UPDATE_LOCK &&
+            lock_type != DSS_MEDIA_RESERVATION)
             LOG_RETURN(-EINVAL, "Specified type parameter is "
                                 "not supported: %s.", type_str);
     }
@@ -1926,7 +3027,8 @@ int phobos_admin_clean_locks(struct admin_handle *adm, bool global,
     if (dev_family != PHO_RSC_NONE) {
         if (lock_type != DSS_DEVICE &&
             lock_type != DSS_MEDIA &&
-            lock_type != DSS_MEDIA_UPDATE_LOCK)
+            lock_type != DSS_MEDIA_UPDATE_LOCK &&
+            lock_type != DSS_MEDIA_RESERVATION)
             LOG_RETURN(-EINVAL, "Lock type '%s' not supported.", type_str);
 
         family_str = rsc_family2str(dev_family);
@@ -1,6 +1,9 @@
 #ifndef _ADMIN_UTILS
 #define _ADMIN_UTILS
 
+#include <time.h>
+
+#include "phobos_admin.h"
 #include "pho_srl_lrs.h"
 
 int _send(struct pho_comm_info *comm, pho_req_t *lrs_req);
@@ -8,4 +11,44 @@ int _send(struct pho_comm_info *comm, pho_req_t *lrs_req);
 int _send_and_receive(struct pho_comm_info *comm, pho_req_t *req,
                       pho_resp_t **resp);
 
+/**
+ * Allocate \p medium for reading through the local daemon.
+ *
+ * @param[in]  adm        Admin module handler.
+ * @param[in]  medium     Medium to allocate.
+ * @param[in]  operation  Operation the medium is allocated for.
+ * @param[in]  qos        QoS class of the allocation.
+ * @param[out] resp       Read allocation response, to be freed with
+ *                        pho_srl_response_free().
+ *
+ * @return 0 on success, -errno on failure.
+ */
+int admin_read_alloc_medium(struct admin_handle *adm,
+                            const struct pho_id *medium,
+                            enum read_target_allocation_op operation,
+                            enum pho_qos_class qos, pho_resp_t **resp);
+
+/**
+ * Release \p medium allocated by admin_read_alloc_medium(), without waiting
+ * for the response of the daemon.
+ *
+ * @param[in]  adm        Admin module handler.
+ * @param[in]  medium     Medium to release.
+ *
+ * @return 0 on success, -errno on failure.
+ */
+int admin_release_medium(struct admin_handle *adm, const struct pho_id *medium);
+
+/**
+ * Sleep as long as needed for \p size bytes processed since \p start to not
+ * exceed \p max_rate bytes per second.
+ *
+ * @param[in]  start      Start (CLOCK_MONOTONIC) of the processing.
+ * @param[in]  size       Number of bytes processed since \p start.
+ * @param[in]  max_rate   Maximum number of bytes per second, 0 for no
+ *                        limit.
+ */
+void admin_throttle(const struct timespec *start, ssize_t size,
+                    size_t max_rate);
+
 #endif /* _ADMIN_UTILS */
@@ -0,0 +1,293 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos admin garbage collector
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pho_common.h"
+#include "pho_dss_wrapper.h"
+#include "pho_io.h"
+#include "pho_ldm.h"
+#include "pho_srl_lrs.h"
+#include "pho_type_utils.h"
+
+#include "admin_utils.h"
+#include "gc.h"
+
+static int _gc_get_orphans(struct admin_handle *adm, enum rsc_family family,
+                           struct extent **extents, int *count)
+{
+    struct dss_filter filter;
+    int rc;
+
+    rc = dss_filter_build(&filter,
+                          "{\"$AND\": ["
+                          "  {\"DSS::EXT::medium_family\": \"%s\"},"
+                          "  {\"DSS::EXT::state\": \"%s\"}"
+                          "]}", rsc_family2str(family),
+                          extent_state2str(PHO_EXT_ST_ORPHAN));
+    if (rc)
+        LOG_RETURN(rc, "Failed to build orphan extents filter");
+
+    rc = dss_extent_get(&adm->dss, &filter, extents, count);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to retrieve the orphan extents of family '%s'",
+                   rsc_family2str(family));
+
+    return 0;
+}
+
+static int _gc_extent_medium_cmp(const void *lhs, const void *rhs)
+{
+    const struct extent *left = lhs;
+    const struct extent *right = rhs;
+    int rc;
+
+    rc = strcmp(left->media.library, right->media.library);
+    if (rc)
+        return rc;
+
+    return strcmp(left->media.name, right->media.name);
+}
+
+/**
+ * Update the statistics of \p medium after \p n_extents extents of total size
+ * \p size were deleted from it, its physical space from the filesystem
+ * mounted at \p root_path.
+ */
+static int _gc_update_medium(struct admin_handle *adm,
+                             const struct pho_id *medium,
+                             enum fs_type fs_type, const char *root_path,
+                             ssize_t size, int n_extents)
+{
+    uint64_t fields = NB_OBJ_ADD | LOGC_SPC_USED_ADD;
+    struct ldm_fs_space space = {0};
+    struct fs_adapter_module *fsa;
+    struct media_info *medium_info;
+    json_t *message = NULL;
+    int rc;
+
+    rc = dss_one_medium_get_from_id(&adm->dss, medium, &medium_info);
+    if (rc)
+        return rc;
+
+    medium_info->stats.nb_obj = -n_extents;
+    medium_info->stats.logc_spc_used = -size;
+
+    rc = get_fs_adapter(fs_type, &fsa);
+    if (!rc)
+        rc = ldm_fs_df(fsa, root_path, &space, &message);
+    json_decref(message);
+    if (rc) {
+        pho_warn("Cannot retrieve the space used on medium (family '%s', "
+                 "name '%s', library '%s'): %s",
+                 rsc_family2str(medium->family), medium->name,
+                 medium->library, strerror(-rc));
+    } else {
+        medium_info->stats.phys_spc_used = space.spc_used;
+        medium_info->stats.phys_spc_free = space.spc_avail;
+        fields |= PHYS_SPC_USED | PHYS_SPC_FREE;
+        /* the medium can be written again */
+        if (medium_info->fs.status == PHO_FS_STATUS_FULL &&
+            space.spc_avail > 0) {
+            medium_info->fs.status = PHO_FS_STATUS_USED;
+            fields |= FS_STATUS;
+        }
+    }
+
+    rc = dss_media_update(&adm->dss, medium_info, medium_info, 1, fields);
+    dss_res_free(medium_info, 1);
+    if (rc)
+        LOG_RETURN(rc,
+                   "Failed to update the statistics of medium (family '%s', "
+                   "name '%s', library '%s')", rsc_family2str(medium->family),
+                   medium->name, medium->library);
+
+    return 0;
+}
+
+/**
+ * Delete a batch of orphan extents of the same medium.
+ *
+ * The extents are first removed from the DSS, only if they are still orphan
+ * and not referenced by any layout, then deleted from the medium. Those which
+ * could not be deleted from the medium are put back in the DSS, to be
+ * collected again later. The extents deleted from the medium are moved at the
+ * beginning of \p extents.
+ */
+static int _gc_medium_batch(struct admin_handle *adm, struct extent *extents,
+                            int count, size_t *reclaimed_size)
+{
+    struct pho_id medium = extents[0].media;
+    struct io_adapter_module *ioa;
+    pho_resp_read_elt_t *rresp;
+    ssize_t size_deleted = 0;
+    int n_deleted = 0;
+    pho_resp_t *resp;
+    int n_claimed;
+    int rc2;
+    int rc;
+    int i;
+
+    rc = dss_extent_orphan_claim(&adm->dss, extents, count, &n_claimed);
+    if (rc)
+        LOG_RETURN(rc, "Failed to claim the orphan extents of medium (family "
+                   "'%s', name '%s', library '%s')",
+                   rsc_family2str(medium.family), medium.name, medium.library);
+
+    /* referenced again or collected by a concurrent gc */
+    if (n_claimed < count)
+        pho_verb("%d extents of medium (family '%s', name '%s', library '%s') "
+                 "are no longer orphan and are kept", count - n_claimed,
+                 rsc_family2str(medium.family), medium.name, medium.library);
+
+    if (n_claimed == 0)
+        return 0;
+
+    rc = admin_read_alloc_medium(adm, &medium,
+                                 PHO_READ_TARGET_ALLOC_OP_DELETE,
+                                 PHO_QOS_NORMAL, &resp);
+    if (rc)
+        goto restore;
+
+    rresp = resp->ralloc->media[0];
+    rc = get_io_adapter((enum fs_type)rresp->fs_type, &ioa);
+    if (rc)
+        LOG_GOTO(release, rc, "Failed to get IO adapter");
+
+    for (i = 0; i < n_claimed; ++i) {
+        struct pho_ext_loc loc = {
+            .root_path = rresp->root_path,
+            .extent = &extents[i],
+            .addr_type = (enum address_type)rresp->addr_type,
+        };
+        struct pho_io_descr iod = {
+            .iod_loc = &loc,
+        };
+
+        rc2 = ioa_open(ioa, NULL, &iod, false);
+        if (!rc2) {
+            rc2 = ioa_del(ioa, &iod);
+            ioa_close(ioa, &iod);
+        }
+
+        /* already deleted by a previous collection */
+        if (rc2 && rc2 != -ENOENT) {
+            pho_warn("Failed to delete orphan extent '%s' at '%s': %s",
+                     extents[i].uuid, extents[i].address.buff,
+                     strerror(-rc2));
+            continue;
+        }
+
+        if (i != n_deleted) {
+            struct extent tmp = extents[n_deleted];
+
+            extents[n_deleted] = extents[i];
+            extents[i] = tmp;
+        }
+
+        size_deleted += extents[n_deleted].size;
+        n_deleted++;
+    }
+
+    if (n_deleted)
+        _gc_update_medium(adm, &medium, (enum fs_type)rresp->fs_type,
+                          rresp->root_path, size_deleted, n_deleted);
+
+release:
+    rc2 = admin_release_medium(adm, &medium);
+    rc = rc ? : rc2;
+    pho_srl_response_free(resp, true);
+
+restore:
+    /* the extents still on the medium are collected again later */
+    if (n_deleted < n_claimed) {
+        rc2 = dss_extent_insert(&adm->dss, &extents[n_deleted],
+                                n_claimed - n_deleted);
+        if (rc2)
+            pho_error(rc2, "Failed to put back %d orphan extents in the DSS",
+                      n_claimed - n_deleted);
+        rc = rc ? : rc2;
+    }
+
+    if (n_deleted == 0)
+        return rc;
+
+    *reclaimed_size += size_deleted;
+    pho_verb("Deleted %d orphan extents (%zd bytes) from medium (family "
+             "'%s', name '%s', library '%s')", n_deleted, size_deleted,
+             rsc_family2str(medium.family), medium.name, medium.library);
+
+    return rc;
+}
+
+int gc_orphan_extents(struct admin_handle *adm, enum rsc_family family,
+                      int batch_size, size_t *reclaimed_size)
+{
+    struct extent *extents;
+    int count;
+    int first;
+    int rc2;
+    int rc;
+
+    rc = _gc_get_orphans(adm, family, &extents, &count);
+    if (rc)
+        return rc;
+
+    qsort(extents, count, sizeof(*extents), _gc_extent_medium_cmp);
+
+    for (first = 0; first < count; ) {
+        int last = first + 1;
+
+        while (last < count && last - first < batch_size &&
+               pho_id_equal(&extents[first].media, &extents[last].media))
+            last++;
+
+        rc2 = _gc_medium_batch(adm, &extents[first], last - first,
+                               reclaimed_size);
+        if (rc2) {
+            pho_error(rc2, "Failed to collect the orphan extents of medium "
+                      "(family '%s', name '%s', library '%s')",
+                      rsc_family2str(family), extents[first].media.name,
+                      extents[first].media.library);
+            /* the next batches of this medium would fail the same way */
+            while (last < count &&
+                   pho_id_equal(&extents[first].media, &extents[last].media))
+                last++;
+        }
+
+        rc = rc ? : rc2;
+        first = last;
+    }
+
+    dss_res_free(extents, count);
+
+    return rc;
+}
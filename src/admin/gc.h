@@ -0,0 +1,49 @@
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \brief  Phobos admin garbage collector header
+ */
+
+#ifndef _PHO_ADMIN_GC_H
+#define _PHO_ADMIN_GC_H
+
+#include "phobos_admin.h"
+
+/**
+ * Delete the orphan extents of the media of a family from these media, then
+ * from the DSS, and update the statistics of the media.
+ *
+ * The extents of a medium are deleted by batches, each batch in a single
+ * allocation of the medium. Extents which cannot be deleted are kept in the
+ * DSS to be collected again later.
+ *
+ * @param[in]  adm              Admin module handler.
+ * @param[in]  family           Family of the media, which must support the
+ *                              deletion of a single extent.
+ * @param[in]  batch_size       Maximum number of extents deleted per
+ *                              allocation.
+ * @param[out] reclaimed_size   Size of the extents deleted.
+ *
+ * @return 0 on success, -errno on failure.
+ */
+int gc_orphan_extents(struct admin_handle *adm, enum rsc_family family,
+                      int batch_size, size_t *reclaimed_size);
+
+#endif
@@ -0,0 +1,452 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos admin extent scrubber
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "pho_common.h"
+#include "pho_dss.h"
+#include "pho_io.h"
+#include "pho_srl_lrs.h"
+#include "pho_type_utils.h"
+
+#include "admin_utils.h"
+#include "raid_common.h"
+#include "scrub.h"
+
+/* LTFS attribute giving the first block of a file on the tape */
+#define SCRUB_LTFS_STARTBLOCK "ltfs.startblock"
+
+/* smaller reads would not keep a tape drive streaming */
+#define SCRUB_MIN_IO_SIZE (8 * 1024 * 1024)
+
+/** A medium which can be scrubbed */
+struct scrub_candidate {
+    struct pho_id  id;
+    struct timeval last;    /**< time of its last scrub, 0 if never scrubbed */
+};
+
+/** An extent to scrub */
+struct scrub_extent {
+    struct extent      *extent;
+    unsigned long long  block;  /**< first block of the extent on its medium */
+};
+
+static int _scrub_candidate_cmp(const void *lhs, const void *rhs)
+{
+    const struct scrub_candidate *left = lhs;
+    const struct scrub_candidate *right = rhs;
+
+    if (timercmp(&left->last, &right->last, <))
+        return -1;
+    if (timercmp(&left->last, &right->last, >))
+        return 1;
+
+    return 0;
+}
+
+/**
+ * Set the time of the last scrub of each candidate from the scrub logs.
+ */
+static int _scrub_get_last_scrubs(struct admin_handle *adm,
+                                  struct scrub_candidate *candidates,
+                                  int count)
+{
+    struct dss_filter filter;
+    struct pho_log *logs;
+    GHashTable *by_id;
+    int n_logs;
+    int rc;
+    int i;
+
+    rc = dss_filter_build(&filter, "{\"DSS::LOG::cause\": \"%s\"}",
+                          operation_type2str(PHO_MEDIUM_SCRUB));
+    if (rc)
+        LOG_RETURN(rc, "Failed to build scrub logs filter");
+
+    rc = dss_logs_get(&adm->dss, &filter, &logs, &n_logs);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to retrieve the scrub logs");
+
+    by_id = g_hash_table_new(g_pho_id_hash, g_pho_id_equal);
+    for (i = 0; i < count; ++i)
+        g_hash_table_insert(by_id, &candidates[i].id, &candidates[i]);
+
+    for (i = 0; i < n_logs; ++i) {
+        struct scrub_candidate *candidate;
+
+        candidate = g_hash_table_lookup(by_id, &logs[i].medium);
+        if (candidate && timercmp(&candidate->last, &logs[i].time, <))
+            candidate->last = logs[i].time;
+    }
+
+    g_hash_table_destroy(by_id);
+    dss_res_free(logs, n_logs);
+
+    return 0;
+}
+
+int scrub_get_media(struct admin_handle *adm, struct pho_id **media,
+                    int *count)
+{
+    struct scrub_candidate *candidates;
+    struct dss_filter filter;
+    struct media_info *infos;
+    int n_infos;
+    int rc;
+    int i;
+
+    rc = dss_filter_build(&filter,
+                          "{\"$AND\": ["
+                          "  {\"$OR\": ["
+                          "    {\"DSS::MDA::family\": \"%s\"},"
+                          "    {\"DSS::MDA::family\": \"%s\"}"
+                          "  ]},"
+                          "  {\"DSS::MDA::adm_status\": \"%s\"},"
+                          "  {\"DSS::MDA::get\": \"t\"},"
+                          "  {\"$OR\": ["
+                          "    {\"DSS::MDA::fs_status\": \"%s\"},"
+                          "    {\"DSS::MDA::fs_status\": \"%s\"}"
+                          "  ]}"
+                          "]}", rsc_family2str(PHO_RSC_TAPE),
+                          rsc_family2str(PHO_RSC_DIR),
+                          rsc_adm_status2str(PHO_RSC_ADM_ST_UNLOCKED),
+                          fs_status2str(PHO_FS_STATUS_USED),
+                          fs_status2str(PHO_FS_STATUS_FULL));
+    if (rc)
+        LOG_RETURN(rc, "Failed to build media to scrub filter");
+
+    rc = dss_media_get(&adm->dss, &filter, &infos, &n_infos, NULL);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to retrieve the media to scrub");
+
+    *media = NULL;
+    *count = n_infos;
+    if (n_infos == 0)
+        goto free_infos;
+
+    candidates = xcalloc(n_infos, sizeof(*candidates));
+    for (i = 0; i < n_infos; ++i)
+        pho_id_copy(&candidates[i].id, &infos[i].rsc.id);
+
+    rc = _scrub_get_last_scrubs(adm, candidates, n_infos);
+    if (rc)
+        goto free_candidates;
+
+    qsort(candidates, n_infos, sizeof(*candidates), _scrub_candidate_cmp);
+
+    *media = xcalloc(n_infos, sizeof(**media));
+    for (i = 0; i < n_infos; ++i)
+        pho_id_copy(&(*media)[i], &candidates[i].id);
+
+free_candidates:
+    free(candidates);
+free_infos:
+    dss_res_free(infos, n_infos);
+
+    return rc;
+}
+
+static int _scrub_get_extents(struct admin_handle *adm,
+                              const struct pho_id *medium,
+                              struct extent **extents, int *count)
+{
+    struct dss_filter filter;
+    int rc;
+
+    rc = dss_filter_build(&filter,
+                          "{\"$AND\": ["
+                          "  {\"DSS::EXT::medium_family\": \"%s\"},"
+                          "  {\"DSS::EXT::medium_id\": \"%s\"},"
+                          "  {\"DSS::EXT::medium_library\": \"%s\"},"
+                          "  {\"DSS::EXT::state\": \"%s\"}"
+                          "]}", rsc_family2str(medium->family), medium->name,
+                          medium->library, extent_state2str(PHO_EXT_ST_SYNC));
+    if (rc)
+        LOG_RETURN(rc, "Failed to build extents filter");
+
+    rc = dss_extent_get(&adm->dss, &filter, extents, count);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc,
+                   "Failed to retrieve the extents of medium (family '%s', "
+                   "name '%s', library '%s')", rsc_family2str(medium->family),
+                   medium->name, medium->library);
+
+    return 0;
+}
+
+/**
+ * Get the first block of the extent at \p loc on an LTFS tape, ULLONG_MAX if
+ * it is unknown.
+ */
+static unsigned long long _scrub_get_block(struct io_adapter_module *ioa,
+                                           struct pho_ext_loc *loc)
+{
+    struct pho_io_descr iod = {
+        .iod_flags = PHO_IO_MD_ONLY,
+        .iod_loc = loc,
+    };
+    unsigned long long block = ULLONG_MAX;
+    const char *value;
+
+    pho_attr_set(&iod.iod_attrs, SCRUB_LTFS_STARTBLOCK, "");
+
+    /* a metadata only open does not need to be closed */
+    if (ioa_open(ioa, NULL, &iod, false) == 0) {
+        value = pho_attr_get(&iod.iod_attrs, SCRUB_LTFS_STARTBLOCK);
+        if (value && value[0] != '\0')
+            block = strtoull(value, NULL, 10);
+    }
+
+    pho_attrs_free(&iod.iod_attrs);
+
+    return block;
+}
+
+static int _scrub_extent_cmp(const void *lhs, const void *rhs)
+{
+    const struct scrub_extent *left = lhs;
+    const struct scrub_extent *right = rhs;
+
+    if (left->block != right->block)
+        return left->block < right->block ? -1 : 1;
+
+    return strcmp(left->extent->address.buff, right->extent->address.buff);
+}
+
+int scrub_extent_verify(struct io_adapter_module *ioa,
+                        struct pho_ext_loc *loc, char **buffer,
+                        size_t *buf_size, size_t max_rate,
+                        struct scrub_stats *stats)
+{
+    struct extent *extent = loc->extent;
+    struct pho_io_descr iod = {
+        .iod_loc = loc,
+        .iod_size = extent->size,
+    };
+    struct extent_hash hash = {0};
+    size_t left = extent->size;
+    int rc2;
+    int rc;
+
+    rc = ioa_open(ioa, NULL, &iod, false);
+    if (rc)
+        LOG_RETURN(rc, "Failed to open extent '%s' at '%s'", extent->uuid,
+                   extent->address.buff);
+
+    if (*buffer == NULL) {
+        get_preferred_io_block_size(buf_size, ioa, &iod);
+        *buf_size = max(*buf_size, (size_t)SCRUB_MIN_IO_SIZE);
+        *buffer = xmalloc(*buf_size);
+    }
+
+    rc = extent_hash_init(&hash, extent->with_md5, extent->with_xxh128);
+    if (!rc)
+        rc = extent_hash_reset(&hash);
+    if (rc)
+        goto fini;
+
+    while (left) {
+        ssize_t nb_read;
+
+        nb_read = ioa_read(ioa, &iod, *buffer, min(*buf_size, left));
+        if (nb_read < 0)
+            LOG_GOTO(fini, rc = nb_read, "Failed to read extent '%s' at '%s'",
+                     extent->uuid, extent->address.buff);
+        else if (nb_read == 0)
+            LOG_GOTO(fini, rc = -ENODATA,
+                     "Extent '%s' at '%s' is shorter than its %zd bytes",
+                     extent->uuid, extent->address.buff, extent->size);
+
+        rc = extent_hash_update(&hash, *buffer, nb_read);
+        if (rc)
+            goto fini;
+
+        left -= nb_read;
+        stats->size += nb_read;
+        admin_throttle(&stats->start, stats->size, max_rate);
+    }
+
+    rc = extent_hash_digest(&hash);
+    if (rc)
+        goto fini;
+
+    /* a mismatch is -EINVAL there, which the read errors could be too */
+    if (extent_hash_compare(&hash, extent))
+        rc = -EBADMSG;
+
+fini:
+    extent_hash_fini(&hash);
+    rc2 = ioa_close(ioa, &iod);
+
+    return rc ? : rc2;
+}
+
+static bool _scrub_deadline_reached(const struct timespec *deadline)
+{
+    struct timespec now;
+
+    if (!deadline)
+        return false;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return cmp_timespec(&now, deadline) >= 0;
+}
+
+int scrub_medium(struct admin_handle *adm, const struct pho_id *medium,
+                 size_t max_rate, const struct timespec *deadline,
+                 struct scrub_stats *stats)
+{
+    size_t size_start = stats->size;
+    struct scrub_extent *to_scrub;
+    struct io_adapter_module *ioa;
+    pho_resp_read_elt_t *rresp;
+    struct pho_id medium_id;
+    struct extent *extents;
+    struct pho_id device;
+    size_t buf_size = 0;
+    char *buffer = NULL;
+    json_t *corrupted;
+    struct pho_log log;
+    json_t *failed;
+    int n_checked = 0;
+    pho_resp_t *resp;
+    int count;
+    int rc2;
+    int rc;
+    int i;
+
+    /* the other media cannot be read sequentially */
+    if (medium->family != PHO_RSC_TAPE && medium->family != PHO_RSC_DIR)
+        LOG_RETURN(-ENOTSUP,
+                   "Cannot scrub medium (family '%s', name '%s', library "
+                   "'%s'), only tapes and directories can be scrubbed",
+                   rsc_family2str(medium->family), medium->name,
+                   medium->library);
+
+    rc = _scrub_get_extents(adm, medium, &extents, &count);
+    if (rc)
+        return rc;
+
+    if (count == 0)
+        goto free_extents;
+
+    rc = admin_read_alloc_medium(adm, medium, PHO_READ_TARGET_ALLOC_OP_READ,
+                                 PHO_QOS_BULK, &resp);
+    if (rc)
+        goto free_extents;
+
+    rresp = resp->ralloc->media[0];
+    rc = get_io_adapter((enum fs_type)rresp->fs_type, &ioa);
+    if (rc)
+        LOG_GOTO(release, rc, "Failed to get IO adapter");
+
+    /* read the extents of a tape in their order on the tape to not seek */
+    to_scrub = xcalloc(count, sizeof(*to_scrub));
+    for (i = 0; i < count; ++i) {
+        struct pho_ext_loc loc = {
+            .root_path = rresp->root_path,
+            .extent = &extents[i],
+            .addr_type = (enum address_type)rresp->addr_type,
+        };
+
+        to_scrub[i].extent = &extents[i];
+        if ((enum fs_type)rresp->fs_type == PHO_FS_LTFS)
+            to_scrub[i].block = _scrub_get_block(ioa, &loc);
+    }
+
+    qsort(to_scrub, count, sizeof(*to_scrub), _scrub_extent_cmp);
+
+    corrupted = json_array();
+    failed = json_array();
+    for (i = 0; i < count && !_scrub_deadline_reached(deadline); ++i) {
+        struct pho_ext_loc loc = {
+            .root_path = rresp->root_path,
+            .extent = to_scrub[i].extent,
+            .addr_type = (enum address_type)rresp->addr_type,
+        };
+
+        rc2 = scrub_extent_verify(ioa, &loc, &buffer, &buf_size, max_rate,
+                                  stats);
+        if (rc2 == -EBADMSG) {
+            json_array_append_new(corrupted, json_string(loc.extent->uuid));
+            stats->n_corrupted++;
+            /* a corruption prevails over the failures to read */
+            rc = rc2;
+        } else if (rc2) {
+            pho_error(rc2, "Failed to scrub extent '%s'", loc.extent->uuid);
+            json_array_append_new(failed, json_string(loc.extent->uuid));
+            stats->n_failed++;
+            rc = rc ? : rc2;
+            continue;
+        }
+
+        n_checked++;
+    }
+
+    stats->n_checked += n_checked;
+    if (i < count)
+        pho_info("Scrubbing time exhausted, %d of the %d extents of medium "
+                 "(family '%s', name '%s', library '%s') were not checked",
+                 count - i, count, rsc_family2str(medium->family),
+                 medium->name, medium->library);
+
+    pho_id_copy(&medium_id, medium);
+    device.family = medium->family;
+    pho_id_name_set(&device, "", medium->library);
+    init_pho_log(&log, &device, &medium_id, PHO_MEDIUM_SCRUB);
+    log.message = json_object();
+    json_insert_element(log.message, "extents", json_integer(n_checked));
+    json_insert_element(log.message, "size",
+                        json_integer(stats->size - size_start));
+    json_insert_element(log.message, "complete", json_boolean(i == count));
+    json_insert_element(log.message, "corrupted", corrupted);
+    json_insert_element(log.message, "failed", failed);
+    emit_log_after_action(&adm->dss, &log, PHO_MEDIUM_SCRUB, rc);
+
+    free(buffer);
+    free(to_scrub);
+
+release:
+    rc2 = admin_release_medium(adm, medium);
+    rc = rc ? : rc2;
+    pho_srl_response_free(resp, true);
+
+free_extents:
+    dss_res_free(extents, count);
+
+    return rc;
+}
@@ -0,0 +1,106 @@
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \brief  Phobos admin extent scrubber header
+ */
+
+#ifndef _PHO_ADMIN_SCRUB_H
+#define _PHO_ADMIN_SCRUB_H
+
+#include <time.h>
+
+#include "phobos_admin.h"
+#include "pho_io.h"
+
+/** Progress of a scrubbing of several media */
+struct scrub_stats {
+    struct timespec start;       /**< start of the scrubbing */
+    size_t          size;        /**< number of bytes read */
+    int             n_checked;   /**< number of extents verified */
+    int             n_corrupted; /**< number of corrupted extents found */
+    int             n_failed;    /**< number of unreadable extents */
+};
+
+/**
+ * Get the media which can be scrubbed, the least recently scrubbed first.
+ *
+ * These are the unlocked tapes and directories with data that can be read,
+ * the media never scrubbed coming first.
+ *
+ * @param[in]  adm      Admin module handler.
+ * @param[out] media    Media to scrub, to be freed with free().
+ * @param[out] count    Number of media to scrub.
+ *
+ * @return 0 on success, -errno on failure.
+ */
+int scrub_get_media(struct admin_handle *adm, struct pho_id **media,
+                    int *count);
+
+/**
+ * Read the sync extents of a medium in their order on the medium and verify
+ * their checksums.
+ *
+ * The medium is allocated with a bulk QoS so that the scrubbing gives way to
+ * the other requests. The outcome is recorded as a "Medium scrub" log of the
+ * medium, which counts in its health.
+ *
+ * @param[in]     adm       Admin module handler.
+ * @param[in]     medium    Medium to scrub.
+ * @param[in]     max_rate  Maximum number of bytes read per second since
+ *                          \p stats->start, 0 for no limit.
+ * @param[in]     deadline  Time (CLOCK_MONOTONIC) after which no extent is
+ *                          read anymore, NULL for no limit.
+ * @param[in,out] stats     Progress of the scrubbing, updated with the
+ *                          extents of \p medium.
+ *
+ * Only the extents whose checksums do not match are counted as corrupted, the
+ * ones which cannot be read are counted as failed.
+ *
+ * @return 0 on success, -EBADMSG if an extent is corrupted, -errno if an
+ *         extent could not be read or on other failures.
+ */
+int scrub_medium(struct admin_handle *adm, const struct pho_id *medium,
+                 size_t max_rate, const struct timespec *deadline,
+                 struct scrub_stats *stats);
+
+/**
+ * Read the extent at \p loc and compare its checksums with the ones stored in
+ * the DSS.
+ *
+ * @param[in]     ioa       IO adapter of the medium of the extent.
+ * @param[in]     loc       Location of the extent.
+ * @param[in,out] buffer    Read buffer, allocated on the first call with a
+ *                          size suited to the medium, to be freed with
+ *                          free().
+ * @param[in,out] buf_size  Size of \p buffer.
+ * @param[in]     max_rate  Maximum number of bytes read per second since
+ *                          \p stats->start, 0 for no limit.
+ * @param[in,out] stats     Progress of the scrubbing, its size is updated
+ *                          with the bytes read.
+ *
+ * @return 0 if the checksums match, -EBADMSG if they do not, -errno if the
+ *         extent cannot be read.
+ */
+int scrub_extent_verify(struct io_adapter_module *ioa,
+                        struct pho_ext_loc *loc, char **buffer,
+                        size_t *buf_size, size_t max_rate,
+                        struct scrub_stats *stats);
+
+#endif
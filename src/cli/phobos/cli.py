@@ -37,6 +37,7 @@ from logging.handlers import SysLogHandler
 from shlex import shlex
 import sys
 import datetime
+import time
 
 import os
 import os.path
@@ -63,6 +64,8 @@ from phobos.core.log import LogControl, DISABLED, WARNING, INFO, VERBOSE, DEBUG
 from phobos.core.store import XferClient, UtilClient, attrs_as_dict, PutParams
 from phobos.output import dump_object_list
 
+QOS_CLASSES = ['interactive', 'normal', 'bulk']
+
 def phobos_log_handler(log_record):
     """
     Receive log records emitted from lower layers and inject them into the
@@ -137,6 +140,22 @@ def mput_file_line_parser(line):
 
     return file_entry
 
+def parse_range(value):
+    """Convert an 'offset:size' range into an (offset, size) tuple."""
+    offset, _, size = value.partition(':')
+    try:
+        offset = int(offset)
+        size = int(size) if size else 0
+    except ValueError:
+        raise argparse.ArgumentTypeError("'%s' is not a valid range, "
+                                         "expected OFFSET[:SIZE]" % value)
+
+    if offset < 0 or size < 0:
+        raise argparse.ArgumentTypeError("range offset and size must be "
+                                         "positive")
+
+    return (offset, size)
+
 
 class BaseOptHandler:
     """
@@ -300,6 +319,17 @@ class StoreGetHandler(XferOptHandler):
                                  "most optimal one or if the object can be "
                                  "accessed from any node, else return the best "
                                  "hostname to get this object")
+        parser.add_argument('--range', type=parse_range,
+                            default=(0, 0), metavar='OFFSET[:SIZE]',
+                            help="Only retrieve SIZE bytes of the object "
+                                 "starting at OFFSET (SIZE can be omitted to "
+                                 "read up to the end of the object). Extent "
+                                 "hashes are not checked on partially read "
+                                 "extents")
+        parser.add_argument('--qos', choices=QOS_CLASSES,
+                            help="QoS class of the retrieval, 'interactive' "
+                                 "recalls are scheduled before 'normal' and "
+                                 "'bulk' ones")
 
     def exec_get(self):
         """Retrieve an object from backend."""
@@ -308,8 +338,10 @@ class StoreGetHandler(XferOptHandler):
         version = self.params.get('version')
         uuid = self.params.get('uuid')
         best_host = self.params.get('best_host')
+        offset, size = self.params.get('range')
         self.logger.debug("Retrieving object 'objid:%s' to '%s'", oid, dst)
-        self.client.get_register(oid, dst, (uuid, version), best_host)
+        self.client.get_register(oid, dst, (uuid, version, offset, size),
+                                 best_host, qos=self.params.get('qos'))
         try:
             self.client.run()
         except IOError as err:
@@ -351,7 +383,7 @@ class StoreGenericPutHandler(XferOptHandler):
                             help='Desired library (if not set, any available '
                             'library will be used)')
         parser.add_argument('-l', '--layout', '--lyt',
-                            choices=["raid1", "raid4"],
+                            choices=["raid1", "raid4", "rs", "pack"],
                             help='Desired storage layout')
         parser.add_argument('-a', '--alias',
                             help='Desired alias for family, tags and layout. '
@@ -362,6 +394,13 @@ class StoreGenericPutHandler(XferOptHandler):
                             'specific parameters.')
         parser.add_argument('--grouping',
                             help='Set the grouping of the new objects')
+        parser.add_argument('--compression',
+                            help='Compress the object data, as '
+                            '<codec>[:<level>] with codec zstd or lz4 '
+                            '(overrides the alias setting)')
+        parser.add_argument('--qos', choices=QOS_CLASSES,
+                            help='QoS class of the writes (overrides the '
+                            'alias setting)')
 
 
 
@@ -417,7 +456,8 @@ class StorePutHandler(StoreGenericPutHandler):
 
             self.logger.debug("Inserting object '%s' to 'objid:%s'", src, oid)
             self.client.put_register(oid, src, attrs=attrs,
-                                     put_params=put_params)
+                                     put_params=put_params,
+                                     qos=self.params.get('qos'))
 
         if fin is not sys.stdin:
             fin.close()
@@ -453,6 +493,7 @@ class StorePutHandler(StoreGenericPutHandler):
             self.logger.debug("Loaded layout params set %r", lyt_attrs)
 
         put_params = PutParams(alias=self.params.get('alias'),
+                               compression=self.params.get('compression'),
                                grouping=self.params.get('grouping'),
                                family=self.params.get('family'),
                                library=self.params.get('library'),
@@ -465,7 +506,8 @@ class StorePutHandler(StoreGenericPutHandler):
             self.register_multi_puts(mput_file, put_params)
         else:
             self.client.put_register(oid, src, attrs=attrs,
-                                     put_params=put_params)
+                                     put_params=put_params,
+                                     qos=self.params.get('qos'))
             self.logger.debug("Inserting object '%s' to 'objid:%s'", src, oid)
 
         try:
@@ -1014,6 +1056,200 @@ class RenameOptHandler(BaseOptHandler):
             self.logger.error(env_error_format(err))
             sys.exit(abs(err.errno))
 
+class RebuildOptHandler(BaseOptHandler):
+    """Rebuild the extents of the failed media"""
+
+    label = 'rebuild'
+    descr = ('Rebuild the extents stored on failed media from the other '
+             'extents of their layout, the least redundant first')
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+    @classmethod
+    def add_options(cls, parser):
+        """Add command options for rebuild."""
+        super(RebuildOptHandler, cls).add_options(parser)
+        parser.set_defaults(verb=cls.label)
+        parser.add_argument('-T', '--tags', type=lambda t: t.split(','),
+                            help='Only use media that contain this set of '
+                                 'tags as targets (comma-separated: foo,bar)')
+        parser.add_argument('--rate', type=int, default=0,
+                            help='Max rebuild throughput in MB/s, 0 means '
+                                 'no limit (default is 0)')
+        parser.add_argument('--interval', type=int, default=0,
+                            help='Look for failed media every INTERVAL '
+                                 'seconds until interrupted, 0 means only '
+                                 'once (default is 0)')
+
+    def exec_rebuild(self):
+        """Rebuild the extents of the failed media"""
+        interval = self.params.get('interval')
+        max_rate = self.params.get('rate') * 1000 * 1000
+
+        try:
+            with AdminClient(lrs_required=True) as adm:
+                while True:
+                    count = adm.rebuild(self.params.get('tags', []),
+                                        max_rate)
+                    if count:
+                        self.logger.info("%d extent(s) rebuilt", count)
+
+                    if interval <= 0:
+                        break
+
+                    time.sleep(interval)
+        except EnvironmentError as err:
+            self.logger.error(env_error_format(err))
+            sys.exit(abs(err.errno))
+        except KeyboardInterrupt:
+            pass
+
+class GcOptHandler(BaseOptHandler):
+    """Reclaim the space of the dead extents"""
+
+    label = 'gc'
+    descr = ('Delete the orphan extents of the directories and RADOS pools, '
+             'and repack the tapes with too much dead space')
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+    @classmethod
+    def add_options(cls, parser):
+        """Add command options for gc."""
+        super(GcOptHandler, cls).add_options(parser)
+        parser.set_defaults(verb=cls.label)
+        parser.add_argument('-T', '--tags', type=lambda t: t.split(','),
+                            help='Only use tapes that contain this set of '
+                                 'tags as repack targets (comma-separated: '
+                                 'foo,bar)')
+        parser.add_argument('--batch-size', type=int, default=1000,
+                            help='Max number of extents deleted per medium '
+                                 'allocation (default is 1000)')
+        parser.add_argument('--repack-threshold', type=int, default=50,
+                            help='Percentage of dead space from which a tape '
+                                 'is repacked, 0 means tapes are not '
+                                 'repacked (default is 50)')
+        parser.add_argument('--interval', type=int, default=0,
+                            help='Collect every INTERVAL seconds until '
+                                 'interrupted, 0 means only once (default is '
+                                 '0)')
+
+    def exec_gc(self):
+        """Reclaim the space of the dead extents"""
+        interval = self.params.get('interval')
+        threshold = self.params.get('repack_threshold')
+        if threshold < 0 or threshold > 100:
+            self.logger.error("Repack threshold must be a percentage")
+            sys.exit(os.EX_USAGE)
+
+        start = time.monotonic()
+        total_size = 0
+        try:
+            with AdminClient(lrs_required=True) as adm:
+                while True:
+                    size, count = adm.gc(self.params.get('tags', []),
+                                         self.params.get('batch_size'),
+                                         threshold / 100)
+                    total_size += size
+                    hours = (time.monotonic() - start) / 3600
+                    self.logger.info("%d bytes reclaimed, %d tape(s) "
+                                     "repacked (%d bytes per hour since "
+                                     "start)", size, count,
+                                     total_size / hours if hours else 0)
+
+                    if interval <= 0:
+                        break
+
+                    time.sleep(interval)
+        except EnvironmentError as err:
+            self.logger.error(env_error_format(err))
+            sys.exit(abs(err.errno))
+        except KeyboardInterrupt:
+            pass
+
+class ScrubOptHandler(BaseOptHandler):
+    """Verify the checksums of the extents of media"""
+
+    label = 'scrub'
+    descr = ('Read the extents of media and verify their checksums to detect '
+             'silent corruption, the least recently scrubbed media first')
+    family = ResourceFamily(ResourceFamily.RSC_TAPE)
+    library = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+    @classmethod
+    def add_options(cls, parser):
+        """Add command options for scrub."""
+        super(ScrubOptHandler, cls).add_options(parser)
+        parser.set_defaults(verb=cls.label)
+        parser.add_argument('res', nargs='*',
+                            help='Media to scrub, every unlocked tape and '
+                                 'directory with data if not set')
+        parser.add_argument('-f', '--family', choices=["dir", "tape"],
+                            default="tape",
+                            help='Family of the media to scrub (default is '
+                                 'tape)')
+        parser.add_argument('--library',
+                            help="Library containing the media to scrub")
+        parser.add_argument('--rate', type=int, default=0,
+                            help='Max scrub throughput in MB/s, 0 means no '
+                                 'limit (default is 0)')
+        parser.add_argument('--max-time', type=int, default=0,
+                            help='Stop reading extents after MAX_TIME '
+                                 'seconds, 0 means no limit (default is 0)')
+        parser.add_argument('--interval', type=int, default=0,
+                            help='Scrub every INTERVAL seconds until '
+                                 'interrupted, 0 means only once (default is '
+                                 '0)')
+
+    def exec_scrub(self):
+        """Verify the checksums of the extents of media"""
+        interval = self.params.get('interval')
+        max_rate = self.params.get('rate') * 1000 * 1000
+        max_time = self.params.get('max_time')
+        if max_time < 0:
+            self.logger.error("Max time must be positive")
+            sys.exit(os.EX_USAGE)
+
+        media = []
+        if self.params.get('res'):
+            if self.params.get('family') == "dir":
+                self.family = ResourceFamily(ResourceFamily.RSC_DIR)
+            set_library(self)
+            media = list(NodeSet.fromlist(self.params.get('res')))
+
+        try:
+            with AdminClient(lrs_required=True) as adm:
+                while True:
+                    checked, corrupted = adm.scrub(self.family, media,
+                                                   self.library, max_rate,
+                                                   max_time)
+                    self.logger.info("%d extent(s) checked, %d corrupted",
+                                     checked, corrupted)
+
+                    if interval <= 0:
+                        break
+
+                    time.sleep(interval)
+        except EnvironmentError as err:
+            self.logger.error(env_error_format(err))
+            sys.exit(abs(err.errno))
+        except KeyboardInterrupt:
+            pass
+
 class LocateOptHandler(BaseOptHandler):
     """Locate object handler."""
 
@@ -1075,6 +1311,38 @@ class RepackOptHandler(BaseOptHandler):
         parser.add_argument('--library',
                             help="Library containing the medium to repack")
 
+class MigrateOptHandler(BaseOptHandler):
+    """Migrate a set of media."""
+    label = 'migrate'
+    descr = ('Migrate a set of media, by repacking them with several '
+             'concurrent streams')
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+    @classmethod
+    def add_options(cls, parser):
+        super(MigrateOptHandler, cls).add_options(parser)
+        parser.add_argument('-T', '--tags', type=lambda t: t.split(','),
+                            help='Only use media that contain this set of '
+                                 'tags as targets (comma-separated: foo,bar)')
+        parser.add_argument('-n', '--nb-streams', metavar='STREAMS', type=int,
+                            default=0,
+                            help='Max number of parallel migration streams, 0 '
+                                 'means only bounded by the drives (default is '
+                                 '0)')
+        parser.add_argument('--model',
+                            help='Migrate the media of this model')
+        parser.add_argument('--source-tags', type=lambda t: t.split(','),
+                            help='Migrate the media that contain this set of '
+                                 'tags (comma-separated: foo,bar)')
+        parser.add_argument('--library',
+                            help="Library containing the media to migrate")
+        parser.add_argument('res', nargs='*', help='Media to migrate')
+
 class ExtentListOptHandler(ListOptHandler):
     """
     Specific version of the 'list' command for extent, with a couple
@@ -1546,7 +1814,7 @@ class LogsDumpOptHandler(BaseOptHandler):
                                      "device_lookup", "medium_lookup",
                                      "device_load", "device_unload",
                                      "ltfs_mount", "ltfs_umount", "ltfs_format",
-                                     "ltfs_df", "ltfs_sync"])
+                                     "ltfs_df", "ltfs_sync", "medium_scrub"])
         parser.add_argument('--start', type=str_to_timestamp, default=0,
                             help="timestamp of the most recent logs to dump,"
                                  "in format YYYY-MM-DD [hh:mm:ss]")
@@ -1585,7 +1853,7 @@ class LogsClearOptHandler(BaseOptHandler):
                                      "device_lookup", "medium_lookup",
                                      "device_load", "device_unload",
                                      "ltfs_mount", "ltfs_umount", "ltfs_format",
-                                     "ltfs_df", "ltfs_sync"])
+                                     "ltfs_df", "ltfs_sync", "medium_scrub"])
         parser.add_argument('--start', type=str_to_timestamp, default=0,
                             help="timestamp of the most recent logs to dump,"
                                  "in format YYYY-MM-DD [hh:mm:ss]")
@@ -1685,6 +1953,49 @@ class LogsOptHandler(BaseOptHandler):
             sys.exit(abs(err.errno))
 
 
+class CacheStatsOptHandler(BaseOptHandler):
+    """Handler for read cache statistics"""
+    label = "stats"
+    descr = "display the statistics of the read cache of the node"
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+
+class CacheOptHandler(BaseOptHandler):
+    """Handler of read cache commands"""
+    label = "cache"
+    descr = "interact with the read cache of the node"
+    verbs = [
+        CacheStatsOptHandler,
+    ]
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        pass
+
+    def exec_stats(self):
+        """Display the read cache statistics"""
+        try:
+            stats = UtilClient.read_cache_stats()
+        except EnvironmentError as err:
+            self.logger.error(env_error_format(err))
+            sys.exit(abs(err.errno))
+
+        lookups = stats.hits + stats.misses
+        print("hits: %d" % stats.hits)
+        print("misses: %d" % stats.misses)
+        print("hit_ratio: %.2f" % (stats.hits / lookups if lookups else 0))
+        print("evictions: %d" % stats.evictions)
+        print("entries: %d" % stats.n_entries)
+        print("size: %d" % stats.size)
+        print("max_size: %d" % stats.max_size)
+
 def set_library(obj):
     """Set the library of obj first from its 'library' param, then its family"""
     obj.library = obj.params.get('library')
@@ -2067,6 +2378,39 @@ class MediaOptHandler(BaseResourceOptHandler):
             self.logger.error(env_error_format(err))
             sys.exit(abs(err.errno))
 
+    def exec_migrate(self):
+        """Migrate a set of media"""
+        set_library(self)
+        kwargs = {}
+        if self.params.get('model'):
+            kwargs['model'] = self.params.get('model')
+        if self.params.get('source_tags'):
+            kwargs['tags'] = self.params.get('source_tags')
+        if self.params.get('res'):
+            media = list(NodeSet.fromlist(self.params.get('res')))
+        elif kwargs:
+            media = [medium.name
+                     for medium in self.client.media.get(
+                         family=self.family, library=self.library, **kwargs)]
+        else:
+            self.logger.error("No media to migrate, give their names or "
+                              "select them with --model or --source-tags")
+            sys.exit(os.EX_USAGE)
+
+        if not media:
+            self.logger.info("No media to migrate")
+            return
+
+        try:
+            with AdminClient(lrs_required=True) as adm:
+                self.logger.info("Migrating media '%s'", ','.join(media))
+                adm.migrate(self.family, media, self.library,
+                            self.params.get('tags', []),
+                            self.params.get('nb_streams'))
+        except EnvironmentError as err:
+            self.logger.error(env_error_format(err))
+            sys.exit(abs(err.errno))
+
     def exec_delete(self):
         """Delete a medium"""
         resources = self.params.get('res')
@@ -2259,6 +2603,7 @@ class DriveStatus(CLIManagedResourceMixin): #pylint: disable=too-many-instance-a
         self.media = values.get("media", "")
         self.ongoing_io = values.get("ongoing_io", "")
         self.currently_dedicated_to = values.get("currently_dedicated_to", "")
+        self.reserved_for = values.get("reserved_for", "")
 
     def get_display_fields(self, max_width=None):
         """Return a dict of available fields and optional display formatters."""
@@ -2272,6 +2617,7 @@ class DriveStatus(CLIManagedResourceMixin): #pylint: disable=too-many-instance-a
             'media': None,
             'ongoing_io': None,
             'currently_dedicated_to': None,
+            'reserved_for': None,
         }
 
 class DriveLookupOptHandler(BaseOptHandler):
@@ -2446,9 +2792,9 @@ class DriveOptHandler(DeviceOptHandler):
         try:
             with AdminClient(lrs_required=True) as adm:
                 status = json.loads(adm.device_status(PHO_RSC_TAPE))
-                # disable pylint's warning as it's suggestion does not work
-                for i in range(len(status)): #pylint: disable=consider-using-enumerate
-                    status[i] = DriveStatus(status[i])
+                # the QoS statistics are not a drive
+                status = [DriveStatus(entry) for entry in status
+                          if 'qos' not in entry]
 
                 dump_object_list(sorted(status, key=lambda x: x.address),
                                  self.params.get('output'))
@@ -2538,6 +2884,7 @@ class TapeOptHandler(MediaOptHandler):
         MediumLocateOptHandler,
         TapeImportOptHandler,
         RepackOptHandler,
+        MigrateOptHandler,
         ResourceDeleteOptHandler,
         MediaRenameOptHandler,
     ]
@@ -2742,9 +3089,9 @@ class CleanOptHandler(BaseOptHandler):
                             help='clean locks even if phobosd is on')
         parser.add_argument('-t', '--type',
                             help='lock type to clean, between [device, media, '
-                                 'object, media_update]',
-                            choices=["device", "media",
-                                     "object", "media_update"])
+                                 'object, media_update, media_reservation]',
+                            choices=["device", "media", "object",
+                                     "media_update", "media_reservation"])
         parser.add_argument('-f', '--family',
                             help='Family of locked ressources to clean, '
                                  'between [dir, tape]; object type '
@@ -2804,10 +3151,14 @@ class PhobosActionContext:
         UndeleteOptHandler,
         PingOptHandler,
         RenameOptHandler,
+        RebuildOptHandler,
+        GcOptHandler,
+        ScrubOptHandler,
         LocateOptHandler,
         LocksOptHandler,
         SchedOptHandler,
         LogsOptHandler,
+        CacheOptHandler,
 
         # Store command interfaces
         StoreGetHandler,
@@ -27,7 +27,7 @@ import errno
 import json
 
 from ctypes import (addressof, byref, c_int, c_char_p, c_void_p, pointer,
-                    Structure, c_size_t, c_bool)
+                    Structure, c_size_t, c_bool, c_double)
 
 from phobos.core.const import (PHO_FS_LTFS, PHO_FS_POSIX, # pylint: disable=no-name-in-module
                                PHO_FS_RADOS, PHO_RSC_TAPE,
@@ -490,6 +490,74 @@ class Client: # pylint: disable=too-many-public-methods
             raise EnvironmentError(rc, f"Failed to repack {medium} from "
                                        f"library {library}")
 
+    def migrate(self, family, media, library, tags, nb_streams): # pylint: disable=too-many-arguments
+        """Migrate a set of tapes"""
+        tags = Tags(tags)
+        c_id = Id * len(media)
+        med_ids = [Id(family, name=medium, library=library)
+                   for medium in media]
+        rc = LIBPHOBOS_ADMIN.phobos_admin_migrate(byref(self.handle),
+                                                  c_id(*med_ids), len(media),
+                                                  byref(tags), nb_streams)
+
+        if rc:
+            raise EnvironmentError(rc, f"Failed to migrate some medium in "
+                                       f"'{','.join(media)}' from library "
+                                       f"{library}")
+
+    def rebuild(self, tags, max_rate):
+        """Rebuild the extents of the failed media"""
+        tags = Tags(tags)
+        n_rebuilt = c_int(0)
+        rc = LIBPHOBOS_ADMIN.phobos_admin_rebuild(byref(self.handle),
+                                                  byref(tags),
+                                                  c_size_t(max_rate),
+                                                  byref(n_rebuilt))
+
+        if rc:
+            raise EnvironmentError(rc, f"Failed to rebuild some extents, "
+                                       f"{n_rebuilt.value} rebuilt")
+
+        return n_rebuilt.value
+
+    def gc(self, tags, batch_size, repack_threshold): # pylint: disable=invalid-name
+        """Reclaim the space of the dead extents"""
+        tags = Tags(tags)
+        reclaimed_size = c_size_t(0)
+        n_repacked = c_int(0)
+        rc = LIBPHOBOS_ADMIN.phobos_admin_gc(byref(self.handle), byref(tags),
+                                             batch_size,
+                                             c_double(repack_threshold),
+                                             byref(reclaimed_size),
+                                             byref(n_repacked))
+
+        if rc:
+            raise EnvironmentError(rc, f"Failed to reclaim some space, "
+                                       f"{reclaimed_size.value} bytes "
+                                       f"reclaimed")
+
+        return reclaimed_size.value, n_repacked.value
+
+    def scrub(self, family, media, library, max_rate, max_time): # pylint: disable=too-many-arguments
+        """Verify the checksums of the extents of media"""
+        c_id = Id * len(media)
+        med_ids = [Id(family, name=medium, library=library)
+                   for medium in media]
+        n_checked = c_int(0)
+        n_corrupted = c_int(0)
+        rc = LIBPHOBOS_ADMIN.phobos_admin_scrub(byref(self.handle),
+                                                c_id(*med_ids), len(media),
+                                                c_size_t(max_rate), max_time,
+                                                byref(n_checked),
+                                                byref(n_corrupted))
+
+        if rc:
+            raise EnvironmentError(rc, f"Failed to scrub some media, "
+                                       f"{n_corrupted.value} corrupted "
+                                       f"extent(s) found")
+
+        return n_checked.value, n_corrupted.value
+
     def medium_rename(self, family, media, library, new_lib):
         """Rename medium (for now, only the library)."""
         c_id = Id * len(media)
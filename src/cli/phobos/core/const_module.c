@@ -94,6 +94,21 @@ static PyObject *py_str2rsc_family(PyObject *self, PyObject *args)
     return Py_BuildValue("i", family);
 }
 
+static PyObject *py_str2qos_class(PyObject *self, PyObject *args)
+{
+    enum pho_qos_class qos;
+    const char *str_repr;
+
+    if (!PyArg_ParseTuple(args, "s", &str_repr)) {
+        PyErr_SetString(ValueError, "Unrecognized QoS class");
+        return Py_BuildValue("i", PHO_QOS_INVAL);
+    }
+
+    qos = str2qos_class(str_repr);
+
+    return Py_BuildValue("i", qos);
+}
+
 static PyObject *py_rsc_adm_status2str(PyObject *self, PyObject *args)
 {
     enum rsc_adm_status status;
@@ -218,6 +233,8 @@ static PyObject *py_str2operation_type(PyObject *self, PyObject *args)
         return Py_BuildValue("i", PHO_LTFS_DF);
     else if (!strcmp(str_repr, "ltfs_sync"))
         return Py_BuildValue("i", PHO_LTFS_SYNC);
+    else if (!strcmp(str_repr, "medium_scrub"))
+        return Py_BuildValue("i", PHO_MEDIUM_SCRUB);
 
     return Py_BuildValue("i", PHO_OPERATION_INVALID);
 }
@@ -232,6 +249,8 @@ static PyMethodDef ConstMethods[] = {
      "printable dev family name."},
     {"str2rsc_family", py_str2rsc_family, METH_VARARGS,
      "family enum value from name."},
+    {"str2qos_class", py_str2qos_class, METH_VARARGS,
+     "QoS class enum value from name."},
     {"rsc_adm_status2str", py_rsc_adm_status2str, METH_VARARGS,
      "printable fs status."},
     {"fs_status2str", py_fs_status2str, METH_VARARGS,
@@ -290,6 +309,14 @@ PyMODINIT_FUNC PyInit_const(void)
     PyModule_AddIntMacro(mod, PHO_RSC_RADOS_POOL);
     PyModule_AddIntMacro(mod, PHO_RSC_LAST);
 
+    /* enum pho_qos_class */
+    PyModule_AddIntMacro(mod, PHO_QOS_INVAL);
+    PyModule_AddIntMacro(mod, PHO_QOS_UNSET);
+    PyModule_AddIntMacro(mod, PHO_QOS_NORMAL);
+    PyModule_AddIntMacro(mod, PHO_QOS_INTERACTIVE);
+    PyModule_AddIntMacro(mod, PHO_QOS_BULK);
+    PyModule_AddIntMacro(mod, PHO_QOS_LAST);
+
     /* enum rsc_adm_status */
     PyModule_AddIntMacro(mod, PHO_RSC_ADM_ST_INVAL);
     PyModule_AddIntMacro(mod, PHO_RSC_ADM_ST_LOCKED);
@@ -349,6 +376,7 @@ PyMODINIT_FUNC PyInit_const(void)
     PyModule_AddIntMacro(mod, DSS_DEVICE);
     PyModule_AddIntMacro(mod, DSS_MEDIA);
     PyModule_AddIntMacro(mod, DSS_MEDIA_UPDATE_LOCK);
+    PyModule_AddIntMacro(mod, DSS_MEDIA_RESERVATION);
     PyModule_AddIntMacro(mod, DSS_LAST);
 
     /* Media update bit fields */
@@ -413,6 +413,7 @@ class MediaInfo(Structure, CLIManagedResourceMixin):
         ('lock', DSSLock),
         ('flags', OperationFlags),
         ('health', c_size_t),
+        ('_groupings', Tags),
     ]
 
     def get_display_fields(self, max_width=None):
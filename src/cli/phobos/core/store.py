@@ -28,14 +28,16 @@ import logging
 import os
 
 from collections import namedtuple
-from ctypes import (byref, c_bool, c_char_p, c_int, c_ssize_t, c_void_p, cast,
+from ctypes import (byref, c_bool, c_char_p, c_int, c_size_t, c_ssize_t,
+                    c_void_p, cast,
                     CFUNCTYPE, pointer, POINTER, py_object, Structure, Union)
 
 from phobos.core.ffi import LIBPHOBOS, DeprecatedObjectInfo, ObjectInfo, Tags
 from phobos.core.const import (PHO_XFER_OBJ_REPLACE, PHO_XFER_OBJ_BEST_HOST, # pylint: disable=no-name-in-module
                                PHO_XFER_OBJ_HARD_DEL,
                                PHO_XFER_OP_GET, PHO_XFER_OP_GETMD,
-                               PHO_XFER_OP_PUT, PHO_RSC_INVAL, str2rsc_family)
+                               PHO_XFER_OP_PUT, PHO_RSC_INVAL, str2rsc_family,
+                               PHO_QOS_UNSET, str2qos_class)
 from phobos.core.dss import dss_sort
 
 ATTRS_FOREACH_CB_TYPE = CFUNCTYPE(c_int, c_char_p, c_char_p, c_void_p)
@@ -79,6 +81,7 @@ class XferPutParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         ("tags", Tags),
         ("_alias", c_char_p),
         ("overwrite", c_bool),
+        ("_compression", c_char_p),
     ]
 
     def set_lyt_params(self, val):
@@ -99,6 +102,7 @@ class XferPutParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         self.tags = Tags(put_params.tags)
         self.alias = put_params.alias
         self.overwrite = put_params.overwrite
+        self.compression = put_params.compression
 
         if put_params.family is None:
             self.family = PHO_RSC_INVAL
@@ -149,9 +153,20 @@ class XferPutParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         # pylint: disable=attribute-defined-outside-init
         self._alias = val.encode('utf-8') if val else None
 
+    @property
+    def compression(self):
+        """Wrapper to get compression"""
+        return self._compression.decode('utf-8') if self._compression else None
+
+    @compression.setter
+    def compression(self, val):
+        """Wrapper to set compression"""
+        # pylint: disable=attribute-defined-outside-init
+        self._compression = val.encode('utf-8') if val else None
+
 class PutParams(namedtuple('PutParams',
-                           'alias family grouping library layout lyt_params '
-                           'overwrite tags')):
+                           'alias compression family grouping library layout '
+                           'lyt_params overwrite tags')):
     """
     Transition data structure for put parameters between
     the CLI and the XFer data structure.
@@ -163,11 +178,15 @@ class XferGetParams(Structure): # pylint: disable=too-few-public-methods, too-ma
     """Phobos GET parameters of the XferDescriptor."""
     _fields_ = [
         ("_node_name", c_char_p),
+        ("offset", c_size_t),
+        ("size", c_size_t),
     ]
 
-    def __init__(self):
+    def __init__(self, offset=0, size=0):
         super().__init__()
         self._node_name = None
+        self.offset = offset
+        self.size = size
 
     @property
     def node_name(self):
@@ -200,6 +219,7 @@ class XferDescriptor(Structure): # pylint: disable=too-many-instance-attributes
         ("xd_params", XferOpParams),
         ("xd_flags", c_int),
         ("xd_rc", c_int),
+        ("xd_qos", c_int),
     ]
 
     def __init__(self):
@@ -209,6 +229,7 @@ class XferDescriptor(Structure): # pylint: disable=too-many-instance-attributes
         self.xd_flags = 0
         self.xd_rc = 0
         self.xd_version = -1
+        self.xd_qos = PHO_QOS_UNSET
 
     @property
     def xd_objid(self):
@@ -275,8 +296,8 @@ class XferDescriptor(Structure): # pylint: disable=too-many-instance-attributes
         """
         xfer_descriptor initialization by using python-list descriptor.
         It opens the file descriptor of the given path. The python-list
-        contains the tuple (id, path, attrs, flags, put or get parameters, op)
-        describing the opened file.
+        contains the tuple (id, path, attrs, flags, put or get parameters, op,
+        qos class) describing the opened file.
         """
         self.xd_op = desc[5]
         if self.xd_op == PHO_XFER_OP_PUT:
@@ -286,11 +307,12 @@ class XferDescriptor(Structure): # pylint: disable=too-many-instance-attributes
         elif self.xd_op == PHO_XFER_OP_GET:
             self.xd_objuuid = desc[4][0]
             self.xd_version = desc[4][1]
-            self.xd_params.get = XferGetParams()
+            self.xd_params.get = XferGetParams(*desc[4][2:])
 
         self.xd_objid = desc[0]
         self.xd_flags = desc[3]
         self.xd_rc = 0
+        self.xd_qos = str2qos_class(desc[6]) if desc[6] else PHO_QOS_UNSET
 
         if desc[2]:
             for k, v in desc[2].items():
@@ -328,7 +350,7 @@ class Store:
         """
         Internal conversion method to turn a python list into an array of
         struct xfer_descriptor as expected by phobos_{get,put} functions.
-        xfer_descriptors is a list of (id, path, attrs, flags, tags, op).
+        xfer_descriptors is a list of (id, path, attrs, flags, tags, op, qos).
         The element conversion is made by the xfer_descriptor initializer.
         """
         xfer_array_type = XferDescriptor * len(xfer_descriptors)
@@ -381,20 +403,22 @@ class XferClient: # pylint: disable=too-many-instance-attributes
     def getmd_register(self, oid, data_path, attrs=None):
         """Enqueue a GETMD transfer."""
         self.getmd_session.append((oid, data_path, attrs, 0, None,
-                                   PHO_XFER_OP_GETMD))
+                                   PHO_XFER_OP_GETMD, None))
 
-    def get_register(self, oid, data_path, get_args, best_host, attrs=None):
+    def get_register(self, oid, data_path, get_args, best_host, attrs=None,
+                     qos=None):
         # pylint: disable=too-many-arguments
         """Enqueue a GET transfer."""
         flags = PHO_XFER_OBJ_BEST_HOST if best_host else 0
         self.get_session.append((oid, data_path, attrs, flags, get_args,
-                                 PHO_XFER_OP_GET))
+                                 PHO_XFER_OP_GET, qos))
 
     def put_register(self, oid, data_path, attrs=None,
-                     put_params=PutParams()):
+                     put_params=PutParams(), qos=None):
+        # pylint: disable=too-many-arguments
         """Enqueue a PUT transfert."""
         self.put_session.append((oid, data_path, attrs, 0, put_params,
-                                 PHO_XFER_OP_PUT))
+                                 PHO_XFER_OP_PUT, qos))
 
     def clear(self):
         """Release resources associated to the current queues."""
@@ -447,6 +471,17 @@ class XferClient: # pylint: disable=too-many-instance-attributes
 
         self.clear()
 
+class ReadCacheStats(Structure): # pylint: disable=too-few-public-methods
+    """Statistics of the read cache of the node."""
+    _fields_ = [
+        ('hits', c_size_t),
+        ('misses', c_size_t),
+        ('evictions', c_size_t),
+        ('n_entries', c_size_t),
+        ('size', c_size_t),
+        ('max_size', c_size_t),
+    ]
+
 class UtilClient:
     """Secondary class: issue user commands without data transfers."""
     def __init__(self, **kwargs):
@@ -564,3 +599,14 @@ class UtilClient:
 
         return (hostname.value.decode('utf-8') if hostname.value else "",
                 nb_new_lock)
+
+    @staticmethod
+    def read_cache_stats():
+        """Get the statistics of the read cache"""
+        stats = ReadCacheStats()
+        rc = LIBPHOBOS.phobos_read_cache_stats(byref(stats))
+        if rc:
+            raise EnvironmentError(rc, "Failed to get the read cache "
+                                   "statistics")
+
+        return stats
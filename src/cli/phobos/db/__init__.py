@@ -31,8 +31,9 @@ import psycopg2
 from phobos.core import cfg
 from phobos.core.ffi import (LIBPHOBOS, ResourceFamily)
 
-ORDERED_SCHEMAS = ["1.1", "1.2", "1.91", "1.92", "1.93", "1.95", "2.0", "2.1"]
-FUTURE_SCHEMAS = ["2.2"]
+ORDERED_SCHEMAS = ["1.1", "1.2", "1.91", "1.92", "1.93", "1.95", "2.0", "2.1",
+                   "2.2"]
+FUTURE_SCHEMAS = []
 CURRENT_SCHEMA_VERSION = ORDERED_SCHEMAS[-1]
 AVAIL_SCHEMAS = set(ORDERED_SCHEMAS) | set(FUTURE_SCHEMAS)
 
@@ -630,7 +631,8 @@ class Migrator:
             self.convert_schema_2_0_to_2_1()
 
     def convert_schema_2_1_to_2_2(self):
-        """DB schema changes: add _grouping and groupings columnst"""
+        """DB schema changes: add groupings columns, dedup table, media
+           reservations and medium scrub logs"""
         cur = self.conn.cursor()
         cur.execute(f"""
             -- add _grouping to object and deprecated_object tables
@@ -640,6 +642,55 @@ class Migrator:
             -- add groupings to media table
             ALTER TABLE media ADD COLUMN groupings JSONB;
 
+            -- index layouts by extent to count extent references
+            CREATE INDEX ON layout(extent_uuid);
+
+            -- add the deduplication index
+            CREATE TABLE dedup(
+                digest          varchar(64),
+                size            bigint,
+                object_uuid     varchar(36) NOT NULL,
+                version         integer NOT NULL,
+
+                PRIMARY KEY (digest, size)
+            );
+
+            -- new lock_type type with the 'media_reservation' value
+            ALTER TYPE lock_type RENAME TO old_lock_type;
+            CREATE TYPE lock_type AS ENUM('object', 'device', 'media',
+                                          'media_update', 'extent',
+                                          'media_reservation');
+
+            -- use new type in lock table
+            ALTER TABLE lock ALTER COLUMN type
+                SET DATA TYPE lock_type
+                USING type::text::lock_type;
+
+            -- delete old_lock_type type
+            DROP TYPE old_lock_type;
+
+            -- add the expected mount time of the media reservations
+            ALTER TABLE lock ADD COLUMN expected timestamp;
+
+            -- new operation_type type with the 'Medium scrub' value
+            ALTER TYPE operation_type RENAME TO old_operation_type;
+            CREATE TYPE operation_type AS ENUM (
+                'Library scan', 'Library open',
+                'Device lookup', 'Medium lookup',
+                'Device load', 'Device unload',
+                'LTFS mount', 'LTFS umount',
+                'LTFS format', 'LTFS df',
+                'LTFS sync', 'Medium scrub'
+            );
+
+            -- use new type in logs table
+            ALTER TABLE logs ALTER COLUMN cause
+                SET DATA TYPE operation_type
+                USING cause::text::operation_type;
+
+            -- delete old_operation_type type
+            DROP TYPE old_operation_type;
+
             -- update current schema version
             UPDATE schema_info SET version = '2.2';
         """)
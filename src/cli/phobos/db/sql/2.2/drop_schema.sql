@@ -6,6 +6,7 @@ DROP TABLE IF EXISTS
     deprecated_object,
     layout,
     extent,
+    dedup,
     lock,
     logs CASCADE;
 
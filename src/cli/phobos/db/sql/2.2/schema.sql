@@ -7,13 +7,13 @@ CREATE TYPE address_type AS ENUM ('PATH', 'HASH1', 'OPAQUE');
 CREATE TYPE fs_status AS ENUM ('blank', 'empty', 'used', 'full', 'importing');
 CREATE TYPE extent_state AS ENUM ('pending','sync','orphan');
 CREATE TYPE lock_type AS ENUM('object', 'device', 'media', 'media_update',
-                              'extent');
+                              'extent', 'media_reservation');
 CREATE TYPE operation_type AS ENUM ('Library scan', 'Library open',
                                     'Device lookup', 'Medium lookup',
                                     'Device load', 'Device unload',
                                     'LTFS mount', 'LTFS umount',
                                     'LTFS format', 'LTFS df',
-                                    'LTFS sync');
+                                    'LTFS sync', 'Medium scrub');
 CREATE TYPE obj_status AS ENUM ('incomplete', 'readable', 'complete');
 
 -- to extend enums: ALTER TYPE type ADD VALUE 'value'
@@ -118,6 +118,18 @@ CREATE TABLE layout(
 
     PRIMARY KEY (object_uuid, version, layout_index)
 );
+-- used to count the references to an extent shared by several layouts
+CREATE INDEX ON layout(extent_uuid);
+
+-- content-addressed index of object versions, used to deduplicate PUTs
+CREATE TABLE dedup(
+    digest          varchar(64),
+    size            bigint,
+    object_uuid     varchar(36) NOT NULL,
+    version         integer NOT NULL,
+
+    PRIMARY KEY (digest, size)
+);
 
 CREATE TABLE lock(
     type            lock_type,
@@ -125,6 +137,8 @@ CREATE TABLE lock(
     hostname        varchar(256) NOT NULL,
     owner           integer NOT NULL,
     timestamp       timestamp DEFAULT now(),
+    -- expected mount time of a media_reservation lock
+    expected        timestamp,
 
     PRIMARY KEY (type, id)
 );
@@ -106,6 +106,19 @@ class CLIParametersTest(unittest.TestCase):
                                   'name,family'])
         self.check_cmdline_valid(['tape', 'repack', 'A'])
         self.check_cmdline_valid(['tape', 'repack', '-T', 't1,t2', 'A'])
+        self.check_cmdline_valid(['tape', 'migrate', 'A', 'B'])
+        self.check_cmdline_valid(['tape', 'migrate', '-n', '2', '-T', 't1',
+                                  '--model', 'LTO5'])
+        self.check_cmdline_valid(['rebuild'])
+        self.check_cmdline_valid(['rebuild', '-T', 't1', '--rate', '100',
+                                  '--interval', '60'])
+        self.check_cmdline_valid(['gc'])
+        self.check_cmdline_valid(['gc', '--batch-size', '100',
+                                  '--repack-threshold', '30', '-T', 't1'])
+        self.check_cmdline_valid(['scrub'])
+        self.check_cmdline_valid(['scrub', '--rate', '100', '--max-time',
+                                  '3600', '--interval', '86400'])
+        self.check_cmdline_valid(['scrub', '-f', 'dir', 'A', 'B'])
         self.check_cmdline_valid(['object', 'list'])
         self.check_cmdline_valid(['object', 'list', '"obj.*"'])
         self.check_cmdline_valid(['object', 'list', '"obj.?2"'])
@@ -236,6 +249,12 @@ class CLIParametersTest(unittest.TestCase):
         self.check_cmdline_exit(['dir', 'rename', '--new-library', 'blob'],
                                 code=2)
 
+    def test_cli_cache_command(self):
+        """Check cache specific commands"""
+        self.check_cmdline_valid(['cache', 'stats'])
+        self.check_cmdline_exit(['cache', 'stats', 'blob'], code=2)
+        self.check_cmdline_exit(['cache', 'flush'], code=2)
+
     def test_cli_logs_command(self): # pylint: disable=too-many-statements
         """Check logs specific commands"""
         self.check_cmdline_valid(['logs', 'clear'])
@@ -129,6 +129,7 @@ void media_info_copy(struct media_info *dst, const struct media_info *src)
     memcpy(dst, src, sizeof(*dst));
     dst->rsc.model = xstrdup_safe(src->rsc.model);
     tags_dup(&dst->tags, &src->tags);
+    tags_dup(&dst->groupings, &src->groupings);
     pho_lock_cpy(&dst->lock, &src->lock);
 }
 
@@ -142,6 +143,7 @@ struct media_info *media_info_dup(const struct media_info *mda)
     media_out->rsc.model = xstrdup_safe(mda->rsc.model);
 
     tags_dup(&media_out->tags, &mda->tags);
+    tags_dup(&media_out->groupings, &mda->groupings);
 
     pho_lock_cpy(&media_out->lock, &mda->lock);
 
@@ -156,6 +158,7 @@ void media_info_cleanup(struct media_info *medium)
     pho_lock_clean(&medium->lock);
     free(medium->rsc.model);
     tags_free(&medium->tags);
+    tags_free(&medium->groupings);
 }
 
 void media_info_free(struct media_info *mda)
@@ -166,6 +169,7 @@ void media_info_free(struct media_info *mda)
     pho_lock_clean(&mda->lock);
     free(mda->rsc.model);
     tags_free(&mda->tags);
+    tags_free(&mda->groupings);
     free(mda);
 }
 
@@ -43,13 +43,14 @@
 #include "deprecated.h"
 #include "device.h"
 #include "dss_config.h"
+#include "dss_statements.h"
 #include "dss_utils.h"
 #include "filters.h"
 #include "media.h"
 #include "resources.h"
 #include "object.h"
 
-#define SCHEMA_INFO "2.1"
+#define SCHEMA_INFO "2.2"
 
 struct dss_result {
     PGresult *pg_res;
@@ -137,10 +138,33 @@ int dss_init(struct dss_handle *handle)
     }
 
     (void)PQsetNoticeProcessor(handle->dh_conn, dss_pg_logger, NULL);
+    dss_statements_init(handle);
 
     return check_db_version(handle);
 }
 
+int dss_check(struct dss_handle *handle)
+{
+    PGconn *conn = handle->dh_conn;
+
+    /* Notices, or the loss of the connection, sent while it was idle */
+    if (PQstatus(conn) == CONNECTION_OK && !PQconsumeInput(conn))
+        pho_debug("Connection to database lost: %s", PQerrorMessage(conn));
+
+    if (PQstatus(conn) != CONNECTION_OK) {
+        /* also forgets the statements prepared on the former connection */
+        PQreset(conn);
+        if (PQstatus(conn) != CONNECTION_OK)
+            LOG_RETURN(-ENOTCONN, "Connection to database failed: %s",
+                       PQerrorMessage(conn));
+    }
+
+    if (PQtransactionStatus(conn) != PQTRANS_IDLE)
+        return -EBUSY;
+
+    return 0;
+}
+
 void dss_fini(struct dss_handle *handle)
 {
     PQfinish(handle->dh_conn);
@@ -250,6 +274,34 @@ out:
     return rc;
 }
 
+/**
+ * Insert or update resources with prepared statements sent in a single batch.
+ *
+ * @return -ENOTSUP if the resources cannot be set with prepared statements
+ */
+static int dss_batch_set(struct dss_handle *handle, enum dss_type type,
+                         void *src_list, void *dst_list, int item_cnt,
+                         int64_t fields, bool update)
+{
+    struct dss_batch batch;
+    int rc;
+
+    dss_batch_init(&batch);
+
+    if (update)
+        rc = get_update_batch(type, src_list, dst_list, item_cnt, fields,
+                              &batch);
+    else
+        rc = get_insert_batch(type, src_list, item_cnt, fields, &batch);
+
+    if (!rc)
+        rc = dss_batch_execute(handle, &batch);
+
+    dss_batch_clean(&batch);
+
+    return rc;
+}
+
 static int dss_generic_set(struct dss_handle *handle, enum dss_type type,
                            void *item_list, int item_cnt,
                            enum dss_set_action action)
@@ -265,6 +317,17 @@ static int dss_generic_set(struct dss_handle *handle, enum dss_type type,
         LOG_RETURN(-EINVAL, "conn: %p, item_list: %p, item_cnt: %d",
                    conn, item_list, item_cnt);
 
+    if (action == DSS_SET_INSERT || action == DSS_SET_FULL_INSERT) {
+        rc = dss_batch_set(handle, type, item_list, NULL, item_cnt,
+                           action == DSS_SET_INSERT ? INSERT_OBJECT :
+                                                      INSERT_FULL_OBJECT,
+                           false);
+        if (rc != -ENOTSUP)
+            return rc;
+
+        rc = 0;
+    }
+
     request = g_string_new("BEGIN;");
 
     switch (action) {
@@ -311,6 +374,11 @@ static int dss_generic_update(struct dss_handle *handle, enum dss_type type,
                    "conn: %p, src_list: %p, dst_list: %p, item_cnt: %d",
                    conn, src_list, dst_list, item_cnt);
 
+    rc = dss_batch_set(handle, type, src_list, dst_list, item_cnt, fields,
+                       true);
+    if (rc != -ENOTSUP)
+        return rc;
+
     request = g_string_new("BEGIN;");
 
     rc = get_update_query(type, conn, src_list, dst_list,  item_cnt,
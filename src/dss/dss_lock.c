@@ -29,6 +29,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <string.h>
 
@@ -36,6 +37,7 @@
 
 #include "dss_utils.h"
 #include "dss_lock.h"
+#include "dss_statements.h"
 #include "pho_common.h"
 #include "pho_dss.h"
 #include "pho_type_utils.h"
@@ -54,97 +56,40 @@ do {                                                  \
     free((_ids));                                     \
 } while (0)
 
-struct simple_param {
-    struct pho_lock *locks;
-    int (*basic_func)(struct dss_handle *handle, enum dss_type lock_type,
-                      const char *lock_id, struct pho_lock *locks);
+/**
+ * Operations applied to a whole list of lock ids by a single request.
+ */
+enum lock_set_op {
+    LOCK_SET_LOCK,
+    LOCK_SET_REFRESH,
+    LOCK_SET_UNLOCK,
+    LOCK_SET_UNLOCK_FORCE,
+    LOCK_SET_RESERVE,
 };
 
-struct dual_param {
-    const char *lock_hostname;
-    int lock_owner;
-    int (*basic_func)(struct dss_handle *handle, enum dss_type lock_type,
-                      const char *lock_id, int lock_owner,
-                      const char *lock_hostname);
+static const char * const lock_set_action[] = {
+    [LOCK_SET_LOCK]         = "lock",
+    [LOCK_SET_REFRESH]      = "refresh",
+    [LOCK_SET_UNLOCK]       = "unlock",
+    [LOCK_SET_UNLOCK_FORCE] = "unlock",
+    [LOCK_SET_RESERVE]      = "reserve",
 };
 
-/** This structure serves as an abstraction for the basic_* calls */
-struct dss_generic_call {
-    union {
-        struct simple_param simple;
-        struct dual_param dual;
-    } params;
-    bool is_simple;
-    int (*rollback_func)(struct dss_handle *handle, enum dss_type type,
-                         GString **ids, int rollback_cnt);
-    bool all_or_nothing;
-    const char *action;
+static const enum dss_statement lock_set_statement[] = {
+    [LOCK_SET_LOCK]         = DSS_STMT_LOCK,
+    [LOCK_SET_REFRESH]      = DSS_STMT_LOCK_REFRESH,
+    [LOCK_SET_UNLOCK]       = DSS_STMT_UNLOCK,
+    [LOCK_SET_UNLOCK_FORCE] = DSS_STMT_UNLOCK_FORCE,
+    [LOCK_SET_RESERVE]      = DSS_STMT_RESERVE,
 };
 
 enum lock_query_idx {
-    DSS_LOCK_QUERY,
-    DSS_REFRESH_QUERY,
-    DSS_UNLOCK_QUERY,
-    DSS_UNLOCK_FORCE_QUERY,
-    DSS_STATUS_QUERY,
     DSS_CLEAN_DEVICE_QUERY,
     DSS_CLEAN_MEDIA_QUERY,
     DSS_PURGE_ALL_LOCKS_QUERY,
 };
 
-#define DECLARE_BLOCK " DECLARE lock_type lock_type:= '%s'::lock_type;" \
-                      "         lock_id TEXT:= '%s';"                   \
-                      "         lock_hostname TEXT:="                   \
-                      "             (SELECT hostname FROM lock"         \
-                      "              WHERE type = lock_type AND "       \
-                      "                    id = lock_id);"              \
-                      "         lock_owner INTEGER:="                   \
-                      "             (SELECT owner FROM lock"            \
-                      "              WHERE type = lock_type AND "       \
-                      "                    id = lock_id);"              \
-
-#define CHECK_VALID_OWNER_HOSTNAME " IF lock_owner IS NULL OR "         \
-                                   "    lock_hostname IS NULL THEN"     \
-                                   "  RAISE USING errcode = 'PHLK1';"   \
-                                   " END IF;"
-
-#define CHECK_OWNER_HOSTNAME_EXISTS " IF lock_owner <> '%d' OR "        \
-                                    "    lock_hostname <> '%s' THEN"    \
-                                    "  RAISE USING errcode = 'PHLK2';"  \
-                                    " END IF;"
-
-#define WHERE_CONDITION " WHERE type = lock_type AND id = lock_id AND " \
-                        "       owner = lock_owner AND "                \
-                        "       hostname = lock_hostname;"
-
 static const char * const lock_query[] = {
-    [DSS_LOCK_QUERY]         = "INSERT INTO lock (type, id, owner, hostname)"
-                               " VALUES ('%s'::lock_type, '%s', %d, '%s');",
-    [DSS_REFRESH_QUERY]      = "DO $$"
-                                 DECLARE_BLOCK
-                               " BEGIN"
-                                 CHECK_VALID_OWNER_HOSTNAME
-                                 CHECK_OWNER_HOSTNAME_EXISTS
-                               " UPDATE lock SET timestamp = now()"
-                                 WHERE_CONDITION
-                               "END $$;",
-    [DSS_UNLOCK_QUERY]       = "DO $$"
-                                 DECLARE_BLOCK
-                               " BEGIN"
-                                 CHECK_VALID_OWNER_HOSTNAME
-                                 CHECK_OWNER_HOSTNAME_EXISTS
-                               " DELETE FROM lock"
-                                 WHERE_CONDITION
-                               "END $$;",
-    [DSS_UNLOCK_FORCE_QUERY] = "DO $$"
-                                  DECLARE_BLOCK
-                               "  BEGIN"
-                                  CHECK_VALID_OWNER_HOSTNAME
-                               "  DELETE FROM lock"
-                               "   WHERE type = lock_type AND id = lock_id;"
-                               "END $$;",
-    [DSS_STATUS_QUERY]       = "SELECT hostname, owner, timestamp FROM lock "
-                               "  WHERE type = '%s'::lock_type AND id = '%s';",
     [DSS_CLEAN_DEVICE_QUERY] = "WITH id_host AS (SELECT id || '_' || library "
                                "                        AS id, host "
                                "                     FROM device "
@@ -167,7 +112,8 @@ static const char * const lock_query[] = {
                                 * all of them to allow the LRS to update the
                                 * media
                                 */
-                               "         OR type = 'media_update'::lock_type);",
+                               "         OR type IN ('media_update', "
+                               "                     'media_reservation'));",
     [DSS_PURGE_ALL_LOCKS_QUERY] = "TRUNCATE TABLE lock; "
 };
 
@@ -182,7 +128,8 @@ static const char *dss_translate_prefix(enum dss_type type,
         return dev_ls[pos].rsc.id.name;
     }
     case DSS_MEDIA:
-    case DSS_MEDIA_UPDATE_LOCK: {
+    case DSS_MEDIA_UPDATE_LOCK:
+    case DSS_MEDIA_RESERVATION: {
         const struct media_info *mda_ls = item_list;
 
         return mda_ls[pos].rsc.id.name;
@@ -215,7 +162,8 @@ static const char *dss_translate_suffix(enum dss_type type,
         return dev_ls[pos].rsc.id.library;
     }
     case DSS_MEDIA:
-    case DSS_MEDIA_UPDATE_LOCK: {
+    case DSS_MEDIA_UPDATE_LOCK:
+    case DSS_MEDIA_RESERVATION: {
         const struct media_info *mda_ls = item_list;
 
         return mda_ls[pos].rsc.id.library;
@@ -227,22 +175,8 @@ static const char *dss_translate_suffix(enum dss_type type,
     return NULL;
 }
 
-static void append_escaped_to_id(PGconn *conn, const char *string, GString *id)
-{
-    unsigned int escape_len;
-    char *escape_string;
-
-    escape_len = strlen(string) * 2 + 1;
-    escape_string = xmalloc(escape_len);
-
-    PQescapeStringConn(conn, escape_string, string, escape_len, NULL);
-    g_string_append(id, escape_string);
-    free(escape_string);
-}
-
-static int dss_build_lock_id_list(PGconn *conn, const void *item_list,
-                                  int item_cnt, enum dss_type type,
-                                  GString **ids)
+static int dss_build_lock_id_list(const void *item_list, int item_cnt,
+                                  enum dss_type type, GString **ids)
 {
     const char   *name;
     int           i;
@@ -252,13 +186,11 @@ static int dss_build_lock_id_list(PGconn *conn, const void *item_list,
         if (!name)
             LOG_RETURN(-EINVAL, "no lock id prefix found");
 
-        append_escaped_to_id(conn, name, ids[i]);
+        g_string_append(ids[i], name);
 
         name = dss_translate_suffix(type, item_list, i);
-        if (name) {
-            g_string_append(ids[i], "_");
-            append_escaped_to_id(conn, name, ids[i]);
-        }
+        if (name)
+            g_string_append_printf(ids[i], "_%s", name);
 
         if (ids[i]->len > PHO_DSS_MAX_LOCK_ID_LEN)
             LOG_RETURN(-EINVAL, "lock_id name too long");
@@ -267,207 +199,269 @@ static int dss_build_lock_id_list(PGconn *conn, const void *item_list,
     return 0;
 }
 
-static int basic_lock(struct dss_handle *handle, enum dss_type lock_type,
-                      const char *lock_id, int lock_owner,
-                      const char *lock_hostname)
+/**
+ * Join the ids whose outcome in \p filter is 0, or all of them if \p filter is
+ * NULL, in a PostgreSQL array literal given as a statement parameter.
+ *
+ * @return the number of ids in the array
+ */
+static int join_lock_ids(GString **ids, int item_cnt, const int *filter,
+                         GString *array)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
-    PGresult *res;
-    int rc;
-
-    if (lock_type == DSS_DEPREC)
-        lock_type = DSS_OBJECT;
-
-    g_string_printf(request, lock_query[DSS_LOCK_QUERY],
-                    dss_type_names[lock_type], lock_id, lock_owner,
-                    lock_hostname);
-
-    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
-
-    PQclear(res);
-    g_string_free(request, true);
+    int count = 0;
+    int i;
 
-    return rc;
-}
+    g_string_assign(array, "{");
 
-static int basic_refresh(struct dss_handle *handle, enum dss_type lock_type,
-                         const char *lock_id, int lock_owner,
-                         const char *lock_hostname)
-{
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
-    PGresult *res;
-    int rc = 0;
+    for (i = 0; i < item_cnt; ++i) {
+        const char *c;
 
-    g_string_printf(request, lock_query[DSS_REFRESH_QUERY],
-                    dss_type_names[lock_type], lock_id, lock_owner,
-                    lock_hostname);
+        if (filter && filter[i])
+            continue;
 
-    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
+        g_string_append(array, count ? ",\"" : "\"");
+        for (c = ids[i]->str; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\')
+                g_string_append_c(array, '\\');
+            g_string_append_c(array, *c);
+        }
+        g_string_append_c(array, '"');
+        count++;
+    }
 
-    PQclear(res);
-    g_string_free(request, true);
+    g_string_append_c(array, '}');
 
-    return rc;
+    return count;
 }
 
-static int basic_unlock(struct dss_handle *handle, enum dss_type lock_type,
-                        const char *lock_id, int lock_owner,
-                        const char *lock_hostname)
+/**
+ * Find the ids of \p ids which already appear earlier in the list, since a
+ * single request cannot insert or update the same lock twice.
+ *
+ * @param[out]  first   Index of the first occurrence of each id
+ *
+ * @return the number of distinct ids
+ */
+static int find_duplicate_ids(GString **ids, int item_cnt, int *first)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
-    PGresult *res;
-    int rc;
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    int count = 0;
+    int i;
 
-    if (lock_owner)
-        g_string_printf(request, lock_query[DSS_UNLOCK_QUERY],
-                        dss_type_names[lock_type], lock_id, lock_owner,
-                        lock_hostname);
-    else
-        g_string_printf(request, lock_query[DSS_UNLOCK_FORCE_QUERY],
-                        dss_type_names[lock_type], lock_id);
+    for (i = 0; i < item_cnt; ++i) {
+        gpointer index;
 
-    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
+        if (g_hash_table_lookup_extended(seen, ids[i]->str, NULL, &index)) {
+            first[i] = GPOINTER_TO_INT(index);
+            continue;
+        }
 
-    PQclear(res);
-    g_string_free(request, true);
+        g_hash_table_insert(seen, ids[i]->str, GINT_TO_POINTER(i));
+        first[i] = i;
+        count++;
+    }
 
-    return rc;
+    g_hash_table_destroy(seen);
+
+    return count;
 }
 
-static int basic_status(struct dss_handle *handle, enum dss_type lock_type,
-                        const char *lock_id, struct pho_lock *lock)
+/**
+ * Apply \p op to the \p item_cnt lock ids of \p id_array in a single request.
+ *
+ * @param[in]   expected    Expected mount time of a reservation, NULL for the
+ *                          other operations.
+ * @param[out]  rcs     Outcome of the operation for each id: 0 on success,
+ *                      -EEXIST if a lock to take already exists, -ENOLCK if a
+ *                      lock to refresh or release does not exist and -EACCES
+ *                      if it is not owned by \p lock_owner on
+ *                      \p lock_hostname.
+ *
+ * @return 0 if the request was executed, even if the operation failed on some
+ *         of the ids, the error of the request otherwise.
+ */
+static int lock_set_execute(struct dss_handle *handle, enum lock_set_op op,
+                            enum dss_type type, const char *id_array,
+                            int item_cnt, const char *lock_hostname,
+                            int lock_owner, const char *expected, int *rcs)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
-    struct timeval lock_timestamp;
+    struct dss_params params = {0};
     PGresult *res;
-    int rc = 0;
+    int rc;
+    int i;
 
-    g_string_printf(request, lock_query[DSS_STATUS_QUERY],
-                    dss_type_names[lock_type], lock_id);
+    dss_params_add_str(&params, dss_type_names[type]);
+    dss_params_add_str(&params, id_array);
+    if (op != LOCK_SET_UNLOCK_FORCE) {
+        dss_params_add_int4(&params, lock_owner);
+        dss_params_add_str(&params, lock_hostname);
+    }
+    if (op == LOCK_SET_RESERVE)
+        dss_params_add_str(&params, expected);
 
-    rc = execute(conn, request->str, &res, PGRES_TUPLES_OK);
+    rc = execute_prepared(handle, lock_set_statement[op], &params, &res,
+                          PGRES_TUPLES_OK);
     if (rc)
         goto out_cleanup;
 
-    if (PQntuples(res) == 0) {
-        pho_debug("Requested lock '%s' was not found, request: '%s' ",
-                  lock_id, request->str);
-        rc = -ENOLCK;
-        if (lock) {
-            lock->hostname = NULL;
-            lock->owner = 0;
-        }
-        goto out_cleanup;
-    }
+    if (PQntuples(res) != item_cnt)
+        LOG_GOTO(out_cleanup, rc = -EPROTO,
+                 "Expected %d lock outcomes, got %d", item_cnt,
+                 PQntuples(res));
 
-    if (lock) {
-        str2timeval(PQgetvalue(res, 0, 2), &lock_timestamp);
-        init_pho_lock(lock, PQgetvalue(res, 0, 0),
-                      (int) strtoll(PQgetvalue(res, 0, 1), NULL, 10),
-                      &lock_timestamp);
+    for (i = 0; i < item_cnt; ++i) {
+        bool done = !strcmp(PQgetvalue(res, i, 0), "t");
+        bool existed = !strcmp(PQgetvalue(res, i, 1), "t");
+
+        if (done)
+            rcs[i] = 0;
+        else if (op == LOCK_SET_LOCK || op == LOCK_SET_RESERVE)
+            rcs[i] = -EEXIST;
+        else
+            rcs[i] = existed ? -EACCES : -ENOLCK;
     }
 
 out_cleanup:
     PQclear(res);
-    g_string_free(request, true);
+    dss_params_clean(&params);
 
     return rc;
 }
 
-static int dss_generic(struct dss_handle *handle, enum dss_type type,
-                       const void *item_list, int item_cnt,
-                       struct dss_generic_call *callee)
+/**
+ * Lock, refresh or unlock a list of resources with a single request, instead
+ * of one request per resource.
+ *
+ * If \p all_or_nothing is set and the operation fails on any resource, the
+ * locks taken on the other resources are released (only used to lock).
+ *
+ * \p expected is only used to reserve, see lock_set_execute.
+ *
+ * A resource given several times is only sent once: its other occurrences
+ * fail with -EEXIST when locking or reserving, as it is already taken by the
+ * first one, and share the outcome of the first one otherwise.
+ *
+ * @param[out]  rcs     If not NULL, outcome of the operation for each resource
+ *
+ * @return 0 on success, the first error in the list of resources otherwise
+ */
+static int dss_lock_set(struct dss_handle *handle, enum lock_set_op op,
+                        enum dss_type type, const void *item_list,
+                        int item_cnt, const char *lock_hostname,
+                        int lock_owner, const char *expected,
+                        bool all_or_nothing, int *rcs)
 {
-    PGconn *conn = handle->dh_conn;
+    enum dss_type lock_type = type;
+    int *outcomes = rcs;
+    int *distinct_rcs;
+    GString *id_array;
+    int distinct_cnt;
     GString **ids;
+    int *first;
     int rc = 0;
     int i;
+    int j;
 
     ENTRY;
 
+    if (item_cnt == 0)
+        return 0;
+
+    /* deprecated objects are locked as objects, but keep their uuid as id */
+    if (type == DSS_DEPREC)
+        lock_type = DSS_OBJECT;
+
+    if (!outcomes)
+        outcomes = xcalloc(item_cnt, sizeof(*outcomes));
+
+    id_array = g_string_new("");
     LOCK_ID_LIST_ALLOCATE(ids, item_cnt);
+    first = xmalloc(item_cnt * sizeof(*first));
+    distinct_rcs = NULL;
 
-    rc = dss_build_lock_id_list(conn, item_list, item_cnt, type, ids);
-    if (rc)
+    rc = dss_build_lock_id_list(item_list, item_cnt, type, ids);
+    if (rc) {
+        for (i = 0; i < item_cnt; ++i)
+            outcomes[i] = rc;
         LOG_GOTO(cleanup, rc, "Ids list build failed");
+    }
 
-    for (i = 0; i < item_cnt; ++i) {
-        int rc2;
+    distinct_cnt = find_duplicate_ids(ids, item_cnt, first);
+    for (i = 0; i < item_cnt; ++i)
+        outcomes[i] = first[i] == i ? 0 : -EEXIST;
+
+    join_lock_ids(ids, item_cnt, outcomes, id_array);
+    distinct_rcs = xcalloc(distinct_cnt, sizeof(*distinct_rcs));
+    rc = lock_set_execute(handle, op, lock_type, id_array->str, distinct_cnt,
+                          lock_hostname, lock_owner, expected, distinct_rcs);
+    if (rc) {
+        for (i = 0; i < item_cnt; ++i)
+            outcomes[i] = rc;
+        LOG_GOTO(cleanup, rc, "Failed to %s %d lock(s)", lock_set_action[op],
+                 item_cnt);
+    }
 
-        if (callee->is_simple) {
-            struct simple_param *param = &callee->params.simple;
+    for (i = 0, j = 0; i < item_cnt; ++i) {
+        if (first[i] == i)
+            outcomes[i] = distinct_rcs[j++];
+        else if (op == LOCK_SET_LOCK || op == LOCK_SET_RESERVE)
+            outcomes[i] = -EEXIST;
+        else
+            outcomes[i] = outcomes[first[i]];
+    }
+
+    for (i = 0; i < item_cnt; ++i) {
+        if (!outcomes[i])
+            continue;
 
-            rc2 = param->basic_func(handle, type, ids[i]->str,
-                                    param->locks ? param->locks + i : NULL);
+        rc = rc ? : outcomes[i];
+        pho_debug("Failed to %s %s (%s)", lock_set_action[op], ids[i]->str,
+                  strerror(-outcomes[i]));
+    }
 
-        } else {
-            struct dual_param *param = &callee->params.dual;
+    if (all_or_nothing && rc) {
+        int *rollback_rcs;
+        int rollback_cnt;
+        int rc2;
 
-            rc2 = param->basic_func(handle, type, ids[i]->str,
-                                    param->lock_owner, param->lock_hostname);
-        }
+        rollback_cnt = join_lock_ids(ids, item_cnt, outcomes, id_array);
+        if (rollback_cnt == 0)
+            goto cleanup;
 
-        if (rc2) {
-            rc = rc ? : rc2;
-            pho_debug("Failed to %s %s (%s)", callee->action, ids[i]->str,
-                                              strerror(-rc2));
-            if (callee->all_or_nothing)
+        /* If a lock failure happens, we force every unlock */
+        rollback_rcs = xcalloc(rollback_cnt, sizeof(*rollback_rcs));
+        rc2 = lock_set_execute(handle, LOCK_SET_UNLOCK_FORCE, lock_type,
+                               id_array->str, rollback_cnt, NULL, 0, NULL,
+                               rollback_rcs);
+        for (i = 0; i < rollback_cnt; ++i)
+            if (rc2 || rollback_rcs[i])
                 break;
-        }
-    }
 
-    if (callee->all_or_nothing && rc)
-        callee->rollback_func(handle, type, ids, i - 1);
+        if (i < rollback_cnt)
+            pho_error(rc2 ? : rollback_rcs[i],
+                      "Failed to unlock %s after lock failure, database may "
+                      "be corrupted", id_array->str);
+
+        free(rollback_rcs);
+    }
 
 cleanup:
     LOCK_ID_LIST_FREE(ids, item_cnt);
+    g_string_free(id_array, true);
+    free(distinct_rcs);
+    free(first);
+    if (outcomes != rcs)
+        free(outcomes);
 
     return rc;
 }
 
-static int dss_lock_rollback(struct dss_handle *handle, enum dss_type type,
-                             GString **ids, int rollback_cnt)
-{
-    int rc = 0;
-    int i;
-
-    for (i = rollback_cnt; i >= 0; --i) {
-        int rc2;
-
-        /* If a lock failure happens, we force every unlock */
-        rc2 = basic_unlock(handle, type, ids[i]->str, 0, NULL);
-        if (rc2) {
-            rc = rc ? : rc2;
-            pho_error(rc2, "Failed to unlock %s after lock failure, "
-                           "database may be corrupted", ids[i]->str);
-        }
-    }
-    return rc;
-}
-
 int _dss_lock(struct dss_handle *handle, enum dss_type type,
               const void *item_list, int item_cnt, const char *lock_hostname,
               int lock_pid)
 {
-    struct dss_generic_call callee = {
-        .params = {
-            .dual = {
-                .lock_hostname = lock_hostname,
-                .lock_owner = lock_pid,
-                .basic_func = basic_lock
-            }
-        },
-        .is_simple = false,
-        .all_or_nothing = true,
-        .rollback_func = dss_lock_rollback,
-        .action = "lock"
-    };
-
-    return dss_generic(handle, type, item_list, item_cnt, &callee);
+    return dss_lock_set(handle, LOCK_SET_LOCK, type, item_list, item_cnt,
+                        lock_hostname, lock_pid, NULL, true, NULL);
 }
 
 int dss_lock(struct dss_handle *handle, enum dss_type type,
@@ -494,24 +488,23 @@ int dss_lock_hostname(struct dss_handle *handle, enum dss_type type,
     return _dss_lock(handle, type, item_list, item_cnt, hostname, pid);
 }
 
+int dss_lock_hostname_each(struct dss_handle *handle, enum dss_type type,
+                           const void *item_list, int item_cnt,
+                           const char *hostname, int *rcs)
+{
+    int pid;
+
+    pid = getpid();
+    return dss_lock_set(handle, LOCK_SET_LOCK, type, item_list, item_cnt,
+                        hostname, pid, NULL, false, rcs);
+}
+
 int _dss_lock_refresh(struct dss_handle *handle, enum dss_type type,
                       const void *item_list, int item_cnt,
                       const char *lock_hostname, int lock_owner)
 {
-    struct dss_generic_call callee = {
-        .params = {
-            .dual = {
-                .lock_hostname = lock_hostname,
-                .lock_owner = lock_owner,
-                .basic_func = basic_refresh
-            }
-        },
-        .is_simple = false,
-        .all_or_nothing = false,
-        .action = "refresh"
-    };
-
-    return dss_generic(handle, type, item_list, item_cnt, &callee);
+    return dss_lock_set(handle, LOCK_SET_REFRESH, type, item_list, item_cnt,
+                        lock_hostname, lock_owner, NULL, false, NULL);
 }
 
 int dss_lock_refresh(struct dss_handle *handle, enum dss_type type,
@@ -530,24 +523,22 @@ int _dss_unlock(struct dss_handle *handle, enum dss_type type,
                 const void *item_list, int item_cnt, const char *lock_hostname,
                 int lock_owner)
 {
-    struct dss_generic_call callee = {
-        .params = {
-            .dual = {
-                .lock_hostname = lock_hostname,
-                .lock_owner = lock_owner,
-                .basic_func = basic_unlock
-            }
-        },
-        .is_simple = false,
-        .all_or_nothing = false,
-        .action = "unlock"
-    };
-
-    return dss_generic(handle, type, item_list, item_cnt, &callee);
+    return dss_lock_set(handle,
+                        lock_owner ? LOCK_SET_UNLOCK : LOCK_SET_UNLOCK_FORCE,
+                        type, item_list, item_cnt, lock_hostname, lock_owner,
+                        NULL, false, NULL);
 }
 
 int dss_unlock(struct dss_handle *handle, enum dss_type type,
                const void *item_list, int item_cnt, bool force_unlock)
+{
+    return dss_unlock_each(handle, type, item_list, item_cnt, force_unlock,
+                           NULL);
+}
+
+int dss_unlock_each(struct dss_handle *handle, enum dss_type type,
+                    const void *item_list, int item_cnt, bool force_unlock,
+                    int *rcs)
 {
     const char *hostname = NULL;
     int pid = 0;
@@ -555,26 +546,152 @@ int dss_unlock(struct dss_handle *handle, enum dss_type type,
     if (!force_unlock && fill_host_owner(&hostname, &pid))
         LOG_RETURN(-EINVAL, "Couldn't retrieve hostname");
 
-    return _dss_unlock(handle, type, item_list, item_cnt, hostname, pid);
+    return dss_lock_set(handle,
+                        force_unlock ? LOCK_SET_UNLOCK_FORCE : LOCK_SET_UNLOCK,
+                        type, item_list, item_cnt, hostname, pid, NULL, false,
+                        rcs);
 }
 
 int dss_lock_status(struct dss_handle *handle, enum dss_type type,
                     const void *item_list, int item_cnt,
                     struct pho_lock *locks)
 {
-    struct dss_generic_call callee = {
-        .params = {
-            .simple = {
-                .locks = locks,
-                .basic_func = basic_status
+    struct dss_params params = {0};
+    PGresult *res = NULL;
+    GString *id_array;
+    GString **ids;
+    int rc = 0;
+    int i;
+
+    ENTRY;
+
+    if (item_cnt == 0)
+        return 0;
+
+    id_array = g_string_new("");
+    LOCK_ID_LIST_ALLOCATE(ids, item_cnt);
+
+    rc = dss_build_lock_id_list(item_list, item_cnt, type, ids);
+    if (rc)
+        LOG_GOTO(cleanup, rc, "Ids list build failed");
+
+    join_lock_ids(ids, item_cnt, NULL, id_array);
+    dss_params_add_str(&params,
+                       dss_type_names[type == DSS_DEPREC ? DSS_OBJECT : type]);
+    dss_params_add_str(&params, id_array->str);
+
+    rc = execute_prepared(handle, DSS_STMT_LOCK_STATUS, &params, &res,
+                          PGRES_TUPLES_OK);
+    if (rc)
+        goto cleanup;
+
+    if (PQntuples(res) != item_cnt)
+        LOG_GOTO(cleanup, rc = -EPROTO, "Expected %d lock statuses, got %d",
+                 item_cnt, PQntuples(res));
+
+    for (i = 0; i < item_cnt; ++i) {
+        struct timeval lock_timestamp;
+
+        if (PQgetisnull(res, i, 0)) {
+            pho_debug("Requested lock '%s' was not found", ids[i]->str);
+            rc = rc ? : -ENOLCK;
+            if (locks) {
+                locks[i].hostname = NULL;
+                locks[i].owner = 0;
             }
-        },
-        .is_simple = true,
-        .all_or_nothing = false,
-        .action = "status"
-    };
+            continue;
+        }
+
+        if (locks) {
+            str2timeval(PQgetvalue(res, i, 2), &lock_timestamp);
+            init_pho_lock(locks + i, PQgetvalue(res, i, 0),
+                          (int) strtoll(PQgetvalue(res, i, 1), NULL, 10),
+                          &lock_timestamp);
+        }
+    }
+
+cleanup:
+    PQclear(res);
+    dss_params_clean(&params);
+    LOCK_ID_LIST_FREE(ids, item_cnt);
+    g_string_free(id_array, true);
+
+    return rc;
+}
+
+int _dss_medium_reserve(struct dss_handle *handle,
+                        const struct media_info *med_ls, int med_cnt,
+                        const struct timeval *expected,
+                        const char *lock_hostname, int lock_owner)
+{
+    char expected_str[PHO_TIMEVAL_MAX_LEN];
+
+    timeval2str(expected, expected_str);
+
+    return dss_lock_set(handle, LOCK_SET_RESERVE, DSS_MEDIA_RESERVATION,
+                        med_ls, med_cnt, lock_hostname, lock_owner,
+                        expected_str, false, NULL);
+}
+
+int dss_medium_reserve(struct dss_handle *handle,
+                       const struct media_info *med_ls, int med_cnt,
+                       const struct timeval *expected)
+{
+    const char *hostname;
+    int pid;
+
+    if (fill_host_owner(&hostname, &pid))
+        LOG_RETURN(-EINVAL, "Couldn't retrieve hostname");
+
+    return _dss_medium_reserve(handle, med_ls, med_cnt, expected, hostname,
+                               pid);
+}
+
+int dss_medium_reservation(struct dss_handle *handle,
+                           const struct pho_id *medium_id, char **hostname,
+                           struct timeval *expected)
+{
+    struct media_info medium = { .rsc.id = *medium_id };
+    struct dss_params params = {0};
+    PGresult *res = NULL;
+    GString **ids;
+    int rc = 0;
+    int i;
+
+    ENTRY;
+
+    *hostname = NULL;
+    LOCK_ID_LIST_ALLOCATE(ids, 1);
+
+    rc = dss_build_lock_id_list(&medium, 1, DSS_MEDIA_RESERVATION, ids);
+    if (rc)
+        LOG_GOTO(cleanup, rc, "Ids list build failed");
 
-    return dss_generic(handle, type, item_list, item_cnt, &callee);
+    dss_params_add_str(&params, ids[0]->str);
+
+    rc = execute_prepared(handle, DSS_STMT_RESERVATION_STATUS, &params, &res,
+                          PGRES_TUPLES_OK);
+    if (rc)
+        goto cleanup;
+
+    if (PQntuples(res) == 0) {
+        pho_debug("Medium '%s' is not reserved", ids[0]->str);
+        GOTO(cleanup, rc = -ENOLCK);
+    }
+
+    if (expected && PQgetisnull(res, 0, 1))
+        timerclear(expected);
+    else if (expected)
+        str2timeval(PQgetvalue(res, 0, 1), expected);
+
+    *hostname = xstrdup(PQgetvalue(res, 0, 0));
+
+cleanup:
+    PQclear(res);
+    dss_params_clean(&params);
+    LOCK_ID_LIST_FREE(ids, 1);
+
+    return rc;
 }
 
 int dss_lock_device_clean(struct dss_handle *handle, const char *lock_family,
@@ -660,8 +777,9 @@ int dss_lock_clean_select(struct dss_handle *handle,
 
         g_string_append_printf(request, " type = '%s'::lock_type", lock_type);
         if (dev_family) {
-            lock_type = (strcmp(lock_type, "media_update") == 0) ? "media"
-                                                                 : lock_type;
+            if (strcmp(lock_type, "media_update") == 0 ||
+                strcmp(lock_type, "media_reservation") == 0)
+                lock_type = "media";
             g_string_append_printf(request, " AND id IN "
                                             "         (SELECT id || '_' || "
                                             "                 library FROM %s "
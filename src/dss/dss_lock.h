@@ -48,4 +48,9 @@ int _dss_unlock(struct dss_handle *handle, enum dss_type type,
                 const void *item_list, int item_cnt, const char *lock_hostname,
                 int lock_owner);
 
+int _dss_medium_reserve(struct dss_handle *handle,
+                        const struct media_info *med_ls, int med_cnt,
+                        const struct timeval *expected,
+                        const char *lock_hostname, int lock_owner);
+
 #endif
@@ -0,0 +1,594 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Prepared statements of Phobos's Distributed State Service.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <endian.h>
+#include <errno.h>
+#include <libpq-events.h>
+#include <string.h>
+
+#include "dss_statements.h"
+#include "dss_utils.h"
+#include "pho_common.h"
+
+/**
+ * Number of statements sent in a pipeline before reading their results, so
+ * that neither the client nor the server blocks on a full socket buffer.
+ */
+#define DSS_PIPELINE_DEPTH 128
+
+#define DUPLICATE_PREPARED_STATEMENT "42P05"
+
+/**
+ * Statements prepared on a connection, attached to it as the instance data of
+ * dss_statements_event so that it follows the connection and not the handles
+ * sharing it.
+ */
+struct dss_prepared {
+    bool done[DSS_STMT_COUNT];
+};
+
+struct dss_statement_desc {
+    const char *name;
+    const char *query;
+};
+
+/**
+ * The ids of a lock request are given as an array, each one is numbered by its
+ * position so that the outcomes are returned in the order of the ids.
+ */
+#define IDS_BLOCK "WITH ids AS (SELECT $1::lock_type AS lock_type, *"      \
+                  "             FROM unnest($2::varchar[])"                \
+                  "                  WITH ORDINALITY AS t(lock_id, idx))"
+
+#define IDS_CONDITION " lock.type = ids.lock_type AND lock.id = ids.lock_id"
+
+#define OWNER_HOSTNAME_CONDITION " AND owner = $3::integer"                \
+                                 " AND hostname = $4::varchar"
+
+/**
+ * For each id, whether the operation was applied ("done" lists the ids on
+ * which it was) and whether the lock existed before the request. As the
+ * statements of a request all see the same snapshot of the table, the lock
+ * table joined here does not reflect the changes made by "done".
+ */
+#define OUTCOME_SELECT " SELECT done.id IS NOT NULL, lock.id IS NOT NULL"  \
+                       "  FROM ids"                                        \
+                       "   LEFT JOIN done ON done.id = ids.lock_id"        \
+                       "   LEFT JOIN lock ON" IDS_CONDITION                \
+                       "  ORDER BY ids.idx;"
+
+#define HEALTH_SELECT "SELECT errno FROM logs"                             \
+                      " WHERE family = $1::dev_family AND library = $3"
+
+static const struct dss_statement_desc statements[] = {
+    [DSS_STMT_LOCK] = {
+        .name  = "phobos_lock",
+        .query = IDS_BLOCK
+                 ", done AS ("
+                 "  INSERT INTO lock (type, id, owner, hostname)"
+                 "   SELECT lock_type, lock_id, $3::integer, $4::varchar"
+                 "    FROM ids"
+                 "   ON CONFLICT DO NOTHING RETURNING id)"
+                 OUTCOME_SELECT,
+    },
+    [DSS_STMT_LOCK_REFRESH] = {
+        .name  = "phobos_lock_refresh",
+        .query = IDS_BLOCK
+                 ", done AS ("
+                 "  UPDATE lock SET timestamp = now() FROM ids"
+                 "   WHERE" IDS_CONDITION OWNER_HOSTNAME_CONDITION
+                 "   RETURNING lock.id)"
+                 OUTCOME_SELECT,
+    },
+    [DSS_STMT_UNLOCK] = {
+        .name  = "phobos_unlock",
+        .query = IDS_BLOCK
+                 ", done AS ("
+                 "  DELETE FROM lock USING ids"
+                 "   WHERE" IDS_CONDITION OWNER_HOSTNAME_CONDITION
+                 "   RETURNING lock.id)"
+                 OUTCOME_SELECT,
+    },
+    [DSS_STMT_UNLOCK_FORCE] = {
+        .name  = "phobos_unlock_force",
+        .query = IDS_BLOCK
+                 ", done AS ("
+                 "  DELETE FROM lock USING ids"
+                 "   WHERE" IDS_CONDITION
+                 "   RETURNING lock.id)"
+                 OUTCOME_SELECT,
+    },
+    [DSS_STMT_LOCK_STATUS] = {
+        .name  = "phobos_lock_status",
+        .query = IDS_BLOCK
+                 " SELECT hostname, owner, timestamp"
+                 "  FROM ids LEFT JOIN lock ON" IDS_CONDITION
+                 "  ORDER BY ids.idx;",
+    },
+    /* a reservation is renewed by its owner, or taken over if sooner or past */
+    [DSS_STMT_RESERVE] = {
+        .name  = "phobos_reserve",
+        .query = IDS_BLOCK
+                 ", done AS ("
+                 "  INSERT INTO lock (type, id, owner, hostname, expected)"
+                 "   SELECT lock_type, lock_id, $3::integer, $4::varchar,"
+                 "          $5::timestamp"
+                 "    FROM ids"
+                 "   ON CONFLICT (type, id) DO UPDATE"
+                 "    SET owner = EXCLUDED.owner,"
+                 "        hostname = EXCLUDED.hostname,"
+                 "        expected = EXCLUDED.expected,"
+                 "        timestamp = now()"
+                 "    WHERE (lock.owner = EXCLUDED.owner"
+                 "           AND lock.hostname = EXCLUDED.hostname)"
+                 "       OR lock.expected > EXCLUDED.expected"
+                 "       OR lock.expected < now()"
+                 "   RETURNING id)"
+                 OUTCOME_SELECT,
+    },
+    [DSS_STMT_RESERVATION_STATUS] = {
+        .name  = "phobos_reservation_status",
+        .query = "SELECT hostname, expected FROM lock"
+                 " WHERE type = 'media_reservation'::lock_type AND id = $1;",
+    },
+    [DSS_STMT_OBJECT_INSERT] = {
+        .name  = "phobos_object_insert",
+        .query = "INSERT INTO object (oid, user_md, obj_status)"
+                 " VALUES ($1, $2::jsonb, $3::obj_status);",
+    },
+    [DSS_STMT_OBJECT_FULL_INSERT] = {
+        .name  = "phobos_object_full_insert",
+        .query = "INSERT INTO object (oid, object_uuid, version, user_md,"
+                 "                    obj_status)"
+                 " VALUES ($1, $2, $3::integer, $4::jsonb, $5::obj_status);",
+    },
+    [DSS_STMT_EXTENT_INSERT] = {
+        .name  = "phobos_extent_insert",
+        .query = "INSERT INTO extent (extent_uuid, state, size, offsetof,"
+                 "                    medium_family, medium_id,"
+                 "                    medium_library, address, hash, info)"
+                 " VALUES ($1, $2::extent_state, $3::bigint, $4::bigint,"
+                 "         $5::dev_family, $6, $7, $8, $9::jsonb,"
+                 "         $10::jsonb);",
+    },
+    [DSS_STMT_LAYOUT_INSERT] = {
+        .name  = "phobos_layout_insert",
+        .query = "INSERT INTO layout (object_uuid, version, extent_uuid,"
+                 "                    layout_index)"
+                 " VALUES ((SELECT object_uuid FROM object WHERE oid = $1),"
+                 "         (SELECT version FROM object WHERE oid = $1),"
+                 "         (SELECT extent_uuid FROM extent"
+                 "           WHERE address = $2),"
+                 "         $3::integer);",
+    },
+    [DSS_STMT_LAYOUT_INFO_UPDATE] = {
+        .name  = "phobos_layout_info_update",
+        .query = "UPDATE object SET lyt_info = $1::jsonb WHERE oid = $2;",
+    },
+    [DSS_STMT_MEDIA_STATS_UPDATE] = {
+        .name  = "phobos_media_stats_update",
+        .query = "UPDATE media SET stats = $1::jsonb"
+                 " WHERE family = $2::dev_family AND id = $3"
+                 "   AND library = $4;",
+    },
+    [DSS_STMT_MEDIUM_HEALTH] = {
+        .name  = "phobos_medium_health",
+        .query = HEALTH_SELECT " AND medium = $2 ORDER BY time;",
+    },
+    [DSS_STMT_DEVICE_HEALTH] = {
+        .name  = "phobos_device_health",
+        .query = HEALTH_SELECT " AND device = $2 ORDER BY time;",
+    },
+};
+
+void dss_params_add_str(struct dss_params *params, const char *value)
+{
+    assert(params->count < DSS_MAX_PARAMS);
+
+    params->values[params->count] = xstrdup_safe(value);
+    params->lengths[params->count] = 0;
+    params->formats[params->count] = 0;
+    params->count++;
+}
+
+void dss_params_add_int4(struct dss_params *params, int32_t value)
+{
+    uint32_t network = htobe32(value);
+
+    assert(params->count < DSS_MAX_PARAMS);
+
+    params->values[params->count] = NULL;
+    memcpy(&params->binary[params->count], &network, sizeof(network));
+    params->lengths[params->count] = sizeof(network);
+    params->formats[params->count] = 1;
+    params->count++;
+}
+
+void dss_params_add_int8(struct dss_params *params, int64_t value)
+{
+    uint64_t network = htobe64(value);
+
+    assert(params->count < DSS_MAX_PARAMS);
+
+    params->values[params->count] = NULL;
+    memcpy(&params->binary[params->count], &network, sizeof(network));
+    params->lengths[params->count] = sizeof(network);
+    params->formats[params->count] = 1;
+    params->count++;
+}
+
+void dss_params_clean(struct dss_params *params)
+{
+    int i;
+
+    for (i = 0; i < params->count; i++)
+        free(params->values[i]);
+
+    params->count = 0;
+}
+
+/** Get the values of \p params as expected by libpq */
+static void params_values(const struct dss_params *params,
+                          const char **values)
+{
+    int i;
+
+    for (i = 0; i < params->count; i++)
+        values[i] = params->formats[i] ?
+            (const char *)&params->binary[i] : params->values[i];
+}
+
+static int dss_statements_event(PGEventId id, void *info, void *pass_through)
+{
+    struct dss_prepared *prepared;
+    PGconn *conn;
+
+    (void) pass_through;
+
+    switch (id) {
+    case PGEVT_REGISTER:
+        conn = ((PGEventRegister *)info)->conn;
+        prepared = xcalloc(1, sizeof(*prepared));
+        return PQsetInstanceData(conn, dss_statements_event, prepared);
+    case PGEVT_CONNRESET:
+        /* the statements prepared on the former connection are lost */
+        conn = ((PGEventConnReset *)info)->conn;
+        prepared = PQinstanceData(conn, dss_statements_event);
+        if (prepared)
+            memset(prepared, 0, sizeof(*prepared));
+        return 1;
+    case PGEVT_CONNDESTROY:
+        conn = ((PGEventConnDestroy *)info)->conn;
+        free(PQinstanceData(conn, dss_statements_event));
+        return 1;
+    default:
+        return 1;
+    }
+}
+
+static struct dss_prepared *dss_prepared_get(struct dss_handle *handle)
+{
+    struct dss_prepared *prepared;
+
+    prepared = PQinstanceData(handle->dh_conn, dss_statements_event);
+    if (prepared)
+        return prepared;
+
+    dss_statements_init(handle);
+
+    return PQinstanceData(handle->dh_conn, dss_statements_event);
+}
+
+void dss_statements_init(struct dss_handle *handle)
+{
+    if (!PQregisterEventProc(handle->dh_conn, dss_statements_event,
+                             "dss_statements", NULL))
+        pho_warn("Failed to attach the prepared statements registry to the "
+                 "connection, the statements will be prepared again");
+}
+
+void dss_statements_reset(struct dss_handle *handle)
+{
+    struct dss_prepared *prepared;
+
+    prepared = PQinstanceData(handle->dh_conn, dss_statements_event);
+    if (prepared)
+        memset(prepared, 0, sizeof(*prepared));
+}
+
+static int prepare(struct dss_handle *handle, enum dss_statement stmt)
+{
+    struct dss_prepared *prepared = dss_prepared_get(handle);
+    PGconn *conn = handle->dh_conn;
+    PGresult *res;
+    int rc;
+
+    if (prepared && prepared->done[stmt])
+        return 0;
+
+    pho_debug("Preparing statement '%s': '%s'", statements[stmt].name,
+              statements[stmt].query);
+
+    res = PQprepare(conn, statements[stmt].name, statements[stmt].query, 0,
+                    NULL);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+
+        /* already prepared on this connection before a reset of the registry */
+        if (sqlstate && !strcmp(sqlstate, DUPLICATE_PREPARED_STATEMENT))
+            goto prepared;
+
+        rc = psql_state2errno(res);
+        pho_error(rc, "Failed to prepare statement '%s': %s",
+                  statements[stmt].name,
+                  PQresultErrorField(res, PG_DIAG_MESSAGE_PRIMARY));
+        PQclear(res);
+        return rc;
+    }
+
+prepared:
+    PQclear(res);
+    if (prepared)
+        prepared->done[stmt] = true;
+
+    return 0;
+}
+
+int execute_prepared(struct dss_handle *handle, enum dss_statement stmt,
+                     const struct dss_params *params, PGresult **res,
+                     ExecStatusType tested)
+{
+    const char *values[DSS_MAX_PARAMS];
+    int rc;
+
+    *res = NULL;
+
+    rc = prepare(handle, stmt);
+    if (rc)
+        return rc;
+
+    pho_debug("Executing statement '%s'", statements[stmt].name);
+
+    params_values(params, values);
+    *res = PQexecPrepared(handle->dh_conn, statements[stmt].name,
+                          params->count, values, params->lengths,
+                          params->formats, 0);
+    if (PQresultStatus(*res) != tested)
+        LOG_RETURN(psql_state2errno(*res), "Statement '%s' failed: %s",
+                   statements[stmt].name,
+                   PQresultErrorField(*res, PG_DIAG_MESSAGE_PRIMARY));
+
+    return 0;
+}
+
+void dss_batch_init(struct dss_batch *batch)
+{
+    batch->stmts = g_array_new(FALSE, FALSE, sizeof(enum dss_statement));
+    batch->params = g_array_new(FALSE, FALSE, sizeof(struct dss_params));
+}
+
+void dss_batch_add(struct dss_batch *batch, enum dss_statement stmt,
+                   struct dss_params *params)
+{
+    g_array_append_val(batch->stmts, stmt);
+    g_array_append_val(batch->params, *params);
+}
+
+void dss_batch_clean(struct dss_batch *batch)
+{
+    int i;
+
+    for (i = 0; i < batch->params->len; i++)
+        dss_params_clean(&g_array_index(batch->params, struct dss_params, i));
+
+    g_array_free(batch->stmts, TRUE);
+    g_array_free(batch->params, TRUE);
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+
+/**
+ * Read the results of \p count statements of a pipeline.
+ *
+ * @return the error of the first failed statement, 0 if none failed
+ */
+static int pipeline_results(PGconn *conn, int count)
+{
+    int rc = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        PGresult *res;
+
+        while ((res = PQgetResult(conn)) != NULL) {
+            ExecStatusType status = PQresultStatus(res);
+
+            if (status == PGRES_FATAL_ERROR) {
+                int rc2 = psql_state2errno(res);
+
+                pho_error(rc2, "Pipelined statement failed: %s",
+                          PQresultErrorField(res, PG_DIAG_MESSAGE_PRIMARY));
+                rc = rc ? : rc2;
+            } else if (status == PGRES_PIPELINE_ABORTED) {
+                /* skipped after the failure of a previous statement */
+                rc = rc ? : -ECANCELED;
+            }
+
+            PQclear(res);
+        }
+    }
+
+    return rc;
+}
+
+/**
+ * Send the statements of \p batch in a pipeline ended by a single
+ * synchronization point, so that they are executed in one implicit
+ * transaction, and read their results.
+ */
+static int batch_pipeline(struct dss_handle *handle, struct dss_batch *batch)
+{
+    PGconn *conn = handle->dh_conn;
+    int received = 0;
+    PGresult *res;
+    int sent = 0;
+    int rc = 0;
+    int rc2;
+    int i;
+
+    if (!PQenterPipelineMode(conn))
+        LOG_RETURN(-ECOMM, "Failed to enter pipeline mode: %s",
+                   PQerrorMessage(conn));
+
+    for (i = 0; i < batch->stmts->len; i++) {
+        enum dss_statement stmt = g_array_index(batch->stmts,
+                                                enum dss_statement, i);
+        struct dss_params *params = &g_array_index(batch->params,
+                                                   struct dss_params, i);
+        const char *values[DSS_MAX_PARAMS];
+
+        params_values(params, values);
+        if (!PQsendQueryPrepared(conn, statements[stmt].name, params->count,
+                                 values, params->lengths, params->formats,
+                                 0)) {
+            pho_error(rc = -ECOMM, "Failed to send statement '%s': %s",
+                      statements[stmt].name, PQerrorMessage(conn));
+            break;
+        }
+        sent++;
+
+        if (sent - received < DSS_PIPELINE_DEPTH)
+            continue;
+
+        if (!PQsendFlushRequest(conn) || PQflush(conn)) {
+            pho_error(rc = -ECOMM, "Failed to flush pipeline: %s",
+                      PQerrorMessage(conn));
+            break;
+        }
+
+        rc2 = pipeline_results(conn, sent - received);
+        received = sent;
+        if (rc2) {
+            rc = rc2;
+            break;
+        }
+    }
+
+    if (!PQpipelineSync(conn)) {
+        pho_error(-ECOMM, "Failed to synchronize pipeline: %s",
+                  PQerrorMessage(conn));
+        return rc ? : -ECOMM;
+    }
+
+    rc2 = pipeline_results(conn, sent - received);
+    rc = rc ? : rc2;
+
+    res = PQgetResult(conn);
+    if (PQresultStatus(res) != PGRES_PIPELINE_SYNC)
+        pho_error(rc2 = -EPROTO, "Unexpected pipeline result '%s'",
+                  PQresStatus(PQresultStatus(res)));
+    else
+        rc2 = 0;
+    PQclear(res);
+    rc = rc ? : rc2;
+
+    if (!PQexitPipelineMode(conn))
+        pho_error(rc2 = -ECOMM, "Failed to exit pipeline mode: %s",
+                  PQerrorMessage(conn));
+
+    return rc ? : rc2;
+}
+
+#else /* !LIBPQ_HAS_PIPELINING */
+
+/** Execute the statements of \p batch one by one in an explicit transaction */
+static int batch_transaction(struct dss_handle *handle,
+                             struct dss_batch *batch)
+{
+    PGconn *conn = handle->dh_conn;
+    PGresult *res;
+    int rc;
+    int i;
+
+    rc = execute(conn, "BEGIN;", &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    if (rc)
+        return rc;
+
+    for (i = 0; i < batch->stmts->len; i++) {
+        rc = execute_prepared(handle,
+                              g_array_index(batch->stmts, enum dss_statement,
+                                            i),
+                              &g_array_index(batch->params, struct dss_params,
+                                             i),
+                              &res, PGRES_COMMAND_OK);
+        PQclear(res);
+        if (rc)
+            break;
+    }
+
+    if (rc) {
+        pho_info("Attempting to rollback after transaction failure");
+        execute(conn, "ROLLBACK;", &res, PGRES_COMMAND_OK);
+        PQclear(res);
+        return rc;
+    }
+
+    rc = execute(conn, "COMMIT;", &res, PGRES_COMMAND_OK);
+    PQclear(res);
+
+    return rc;
+}
+
+#endif /* LIBPQ_HAS_PIPELINING */
+
+int dss_batch_execute(struct dss_handle *handle, struct dss_batch *batch)
+{
+    int rc;
+    int i;
+
+    ENTRY;
+
+    if (batch->stmts->len == 0)
+        return 0;
+
+    /* statements cannot be prepared in the middle of a pipeline */
+    for (i = 0; i < batch->stmts->len; i++) {
+        rc = prepare(handle, g_array_index(batch->stmts, enum dss_statement,
+                                           i));
+        if (rc)
+            return rc;
+    }
+
+#ifdef LIBPQ_HAS_PIPELINING
+    return batch_pipeline(handle, batch);
+#else
+    return batch_transaction(handle, batch);
+#endif
+}
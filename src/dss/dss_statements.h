@@ -0,0 +1,141 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Prepared statements of Phobos's Distributed State Service.
+ *
+ * The queries whose shape does not depend on their arguments are prepared
+ * once per connection, and executed with their arguments given as parameters
+ * instead of escaped literals.
+ */
+#ifndef _PHO_DSS_STATEMENTS_H
+#define _PHO_DSS_STATEMENTS_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <libpq-fe.h>
+#include <stdint.h>
+
+#include "pho_dss.h"
+
+/** Queries prepared on each DSS connection */
+enum dss_statement {
+    DSS_STMT_LOCK,
+    DSS_STMT_LOCK_REFRESH,
+    DSS_STMT_UNLOCK,
+    DSS_STMT_UNLOCK_FORCE,
+    DSS_STMT_LOCK_STATUS,
+    DSS_STMT_RESERVE,
+    DSS_STMT_RESERVATION_STATUS,
+    DSS_STMT_OBJECT_INSERT,
+    DSS_STMT_OBJECT_FULL_INSERT,
+    DSS_STMT_EXTENT_INSERT,
+    DSS_STMT_LAYOUT_INSERT,
+    DSS_STMT_LAYOUT_INFO_UPDATE,
+    DSS_STMT_MEDIA_STATS_UPDATE,
+    DSS_STMT_MEDIUM_HEALTH,
+    DSS_STMT_DEVICE_HEALTH,
+
+    DSS_STMT_COUNT
+};
+
+#define DSS_MAX_PARAMS 10
+
+/**
+ * Parameters of the execution of a prepared statement.
+ *
+ * Strings are given in text format, integers in binary format. The structure
+ * owns a copy of its strings, so it can be copied until it is cleaned.
+ */
+struct dss_params {
+    int count;
+    char *values[DSS_MAX_PARAMS];   /**< Text values, NULL for SQL NULL */
+    int64_t binary[DSS_MAX_PARAMS]; /**< Binary values, in network order */
+    int lengths[DSS_MAX_PARAMS];
+    int formats[DSS_MAX_PARAMS];    /**< 0 for text, 1 for binary */
+};
+
+/** Append a string parameter, which may be NULL */
+void dss_params_add_str(struct dss_params *params, const char *value);
+
+/** Append an integer parameter */
+void dss_params_add_int4(struct dss_params *params, int32_t value);
+
+/** Append a bigint parameter */
+void dss_params_add_int8(struct dss_params *params, int64_t value);
+
+/** Free the strings of \p params */
+void dss_params_clean(struct dss_params *params);
+
+/**
+ * Independent executions of prepared statements, sent to the database at once
+ * and applied in a single transaction.
+ */
+struct dss_batch {
+    GArray *stmts;  /**< enum dss_statement */
+    GArray *params; /**< struct dss_params */
+};
+
+void dss_batch_init(struct dss_batch *batch);
+
+/** Append an execution of \p stmt, \p batch takes ownership of \p params */
+void dss_batch_add(struct dss_batch *batch, enum dss_statement stmt,
+                   struct dss_params *params);
+
+void dss_batch_clean(struct dss_batch *batch);
+
+/**
+ * Execute the statements of a batch in one transaction.
+ *
+ * The statements are sent in pipeline mode when libpq supports it, so that
+ * the batch only costs one round trip. Otherwise, they are executed one by
+ * one in an explicit transaction.
+ *
+ * @return 0 on success, the error of the first failed statement otherwise,
+ *         in which case none of the statements is applied.
+ */
+int dss_batch_execute(struct dss_handle *handle, struct dss_batch *batch);
+
+/**
+ * Execute a prepared statement, preparing it first if it was not yet on the
+ * connection of \p handle.
+ *
+ * Like execute, \p res must be cleared by the caller even on failure.
+ */
+int execute_prepared(struct dss_handle *handle, enum dss_statement stmt,
+                     const struct dss_params *params, PGresult **res,
+                     ExecStatusType tested);
+
+/**
+ * Attach the registry of the statements prepared on a new connection to it.
+ *
+ * The registry is emptied when libpq resets the connection and freed when it
+ * closes it.
+ */
+void dss_statements_init(struct dss_handle *handle);
+
+/** Forget the statements prepared on the connection of \p handle */
+void dss_statements_reset(struct dss_handle *handle);
+
+#endif
@@ -155,6 +155,43 @@ static int extent_insert_query(PGconn *conn, void *void_extent, int item_cnt,
     return 0;
 }
 
+static int extent_insert_batch(void *void_extent, int item_cnt,
+                               int64_t fields, struct dss_batch *batch)
+{
+    (void) fields;
+
+    for (int i = 0; i < item_cnt; ++i) {
+        struct extent *extent = ((struct extent *) void_extent) + i;
+        struct dss_params params = {0};
+        GString *info;
+        char *hash;
+
+        hash = dss_extent_hash_encode(extent);
+        if (hash == NULL)
+            return -EINVAL;
+
+        info = g_string_new("");
+        pho_attrs_to_json(&extent->info, info, JSON_COMPACT);
+
+        dss_params_add_str(&params, extent->uuid);
+        dss_params_add_str(&params, extent_state2str(extent->state));
+        dss_params_add_int8(&params, extent->size);
+        dss_params_add_int8(&params, extent->offset);
+        dss_params_add_str(&params, rsc_family2str(extent->media.family));
+        dss_params_add_str(&params, extent->media.name);
+        dss_params_add_str(&params, extent->media.library);
+        dss_params_add_str(&params, extent->address.buff);
+        dss_params_add_str(&params, hash);
+        dss_params_add_str(&params, info->str);
+        dss_batch_add(batch, DSS_STMT_EXTENT_INSERT, &params);
+
+        g_string_free(info, TRUE);
+        free(hash);
+    }
+
+    return 0;
+}
+
 static int extent_update_query(PGconn *conn, void *src_extent, void *dst_extent,
                                int item_cnt, int64_t fields, GString *request)
 {
@@ -322,6 +359,7 @@ const struct dss_resource_ops extent_ops = {
     .update_query = extent_update_query,
     .select_query = extent_select_query,
     .delete_query = extent_delete_query,
+    .insert_batch = extent_insert_batch,
     .create       = extent_from_pg_row,
     .free         = extent_result_free,
     .size         = sizeof(struct extent),
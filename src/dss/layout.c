@@ -154,6 +154,40 @@ static int layout_insert_query(PGconn *conn, void *void_layout, int item_cnt,
     return 0;
 }
 
+static int layout_insert_batch(void *void_layout, int item_cnt,
+                               int64_t fields, struct dss_batch *batch)
+{
+    (void) fields;
+
+    for (int i = 0; i < item_cnt; ++i) {
+        struct layout_info *layout = ((struct layout_info *) void_layout) + i;
+        struct dss_params params = {0};
+        char *layout_description;
+
+        for (int j = 0; j < layout->ext_count; ++j) {
+            struct extent *extent = &layout->extents[j];
+            struct dss_params extent_params = {0};
+
+            dss_params_add_str(&extent_params, layout->oid);
+            dss_params_add_str(&extent_params, extent->address.buff);
+            dss_params_add_int4(&extent_params, extent->layout_idx);
+            dss_batch_add(batch, DSS_STMT_LAYOUT_INSERT, &extent_params);
+        }
+
+        layout_description = dss_layout_desc_encode(&layout->layout_desc);
+        if (!layout_description)
+            LOG_RETURN(-EINVAL, "JSON layout desc encoding error");
+
+        dss_params_add_str(&params, layout_description);
+        dss_params_add_str(&params, layout->oid);
+        dss_batch_add(batch, DSS_STMT_LAYOUT_INFO_UPDATE, &params);
+
+        free(layout_description);
+    }
+
+    return 0;
+}
+
 static int layout_select_query(GString **conditions, int n_conditions,
                                GString *request, struct dss_sort *sort)
 {
@@ -314,6 +348,7 @@ const struct dss_resource_ops layout_ops = {
     .update_query = NULL,
     .select_query = layout_select_query,
     .delete_query = layout_delete_query,
+    .insert_batch = layout_insert_batch,
     .create       = layout_from_pg_row,
     .free         = layout_result_free,
     .size         = sizeof(struct layout_info),
@@ -36,6 +36,7 @@
 
 #include <libpq-fe.h>
 
+#include "dss_statements.h"
 #include "dss_utils.h"
 #include "pho_common.h"
 #include "pho_dss.h"
@@ -366,9 +367,9 @@ void emit_log_after_action(struct dss_handle *dss,
         json_decref(log->message);
 }
 
-static ssize_t count_health(struct pho_log *logs, size_t count,
-                            size_t max_health)
+static ssize_t count_health(PGresult *res, size_t max_health)
 {
+    size_t count = PQntuples(res);
     ssize_t health = max_health;
     size_t i = 0;
 
@@ -377,7 +378,7 @@ static ssize_t count_health(struct pho_log *logs, size_t count,
         return max_health;
 
     /* skip successes before first error, they should not count in the health */
-    while (i < count && !logs[i].error_number)
+    while (i < count && !atoi(PQgetvalue(res, i, 0)))
         i++;
 
     if (i == count)
@@ -385,7 +386,7 @@ static ssize_t count_health(struct pho_log *logs, size_t count,
         return max_health;
 
     for (; i < count; i++) {
-        if (logs[i].error_number)
+        if (atoi(PQgetvalue(res, i, 0)))
             health--;
         else
             health++;
@@ -401,41 +402,33 @@ int dss_resource_health(struct dss_handle *dss,
                         enum dss_type resource, size_t max_health,
                         size_t *health)
 {
-    struct pho_log_filter log_filter = {0};
-    struct dss_filter *pfilter;
-    struct dss_filter filter;
-    struct pho_log *logs;
-    int count;
+    struct dss_params params = {0};
+    enum dss_statement stmt;
+    PGresult *res;
     int rc;
 
-    pfilter = &filter;
     switch (resource) {
     case DSS_MEDIA:
-        log_filter.device.family = PHO_RSC_NONE;
-        pho_id_copy(&log_filter.medium, medium_id);
+        stmt = DSS_STMT_MEDIUM_HEALTH;
         break;
     case DSS_DEVICE:
-        log_filter.medium.family = PHO_RSC_NONE;
-        pho_id_copy(&log_filter.device, medium_id);
+        stmt = DSS_STMT_DEVICE_HEALTH;
         break;
     default:
         LOG_RETURN(-EINVAL, "Ressource type %s does not have a health counter",
                    dss_type2str(resource));
     }
 
-    log_filter.cause = PHO_OPERATION_INVALID;
+    dss_params_add_str(&params, rsc_family2str(medium_id->family));
+    dss_params_add_str(&params, medium_id->name);
+    dss_params_add_str(&params, medium_id->library);
 
-    rc = create_logs_filter(&log_filter, &pfilter);
-    if (rc)
-        return rc;
+    rc = execute_prepared(dss, stmt, &params, &res, PGRES_TUPLES_OK);
+    dss_params_clean(&params);
+    if (!rc)
+        *health = count_health(res, max_health);
 
-    rc = dss_logs_get(dss, &filter, &logs, &count);
-    dss_filter_free(&filter);
-    if (rc)
-        return rc;
+    PQclear(res);
 
-    *health = count_health(logs, count, max_health);
-    dss_res_free(logs, count);
-
-    return 0;
+    return rc;
 }
@@ -382,32 +382,34 @@ static int append_label_update_request(PGconn *conn, GString *request,
  * \param[in]  conn       The connection to the database, used to escape the
  *                        tags
  * \param[out] request    The request in which to add the tags update
- * \param[in]  medium     The medium to extract the tags from
+ * \param[in]  field      The column to update, with a '%s' for its value
+ * \param[in]  tags       The tags to set
  * \param[in]  add_comma  Whether a comma and space should be added in \p
  *                        request
  *
  * \return 0 on success, -EINVAL if the tags encoding or escaping fail
  */
 static int append_tags_update_request(PGconn *conn, GString *request,
-                                      struct media_info *medium, bool add_comma)
+                                      const char *field,
+                                      const struct tags *tags, bool add_comma)
 {
     char *tmp_tags = NULL;
-    char *tags = NULL;
+    char *escaped = NULL;
 
-    tmp_tags = dss_tags_encode(&medium->tags);
+    tmp_tags = dss_tags_encode(tags);
     if (!tmp_tags)
         LOG_RETURN(-EINVAL,
                    "Failed to encode tags for media update");
 
-    tags = dss_char4sql(conn, tmp_tags);
+    escaped = dss_char4sql(conn, tmp_tags);
     free(tmp_tags);
 
-    if (!tags)
+    if (!escaped)
         LOG_RETURN(-EINVAL,
                    "Failed to build tags media update SQL request");
 
-    append_update_request(request, "tags = %s", tags, add_comma);
-    free_dss_char4sql(tags);
+    append_update_request(request, field, escaped, add_comma);
+    free_dss_char4sql(escaped);
 
     return 0;
 }
@@ -486,8 +488,23 @@ static int media_update_query(PGconn *conn, void *src_med, void *dst_med,
         }
 
         if (TAGS & fields) {
-            rc = append_tags_update_request(conn, sub_request, dst,
-                                            (fields ^= TAGS) != 0);
+            rc = append_tags_update_request(conn, sub_request, "tags = %s",
+                                            &dst->tags, (fields ^= TAGS) != 0);
+            if (rc)
+                return rc;
+        }
+
+        /* only the groupings not yet on the medium are appended, in the same
+         * request, so that concurrent additions are all kept
+         */
+        if (GROUPINGS_ADD & fields) {
+            rc = append_tags_update_request(conn, sub_request,
+                "groupings = COALESCE(groupings, '[]'::jsonb) || "
+                "(SELECT COALESCE(jsonb_agg(g), '[]'::jsonb) "
+                "FROM jsonb_array_elements(%s::jsonb) AS g "
+                "WHERE NOT COALESCE(media.groupings, '[]'::jsonb) @> "
+                "jsonb_build_array(g))",
+                &dst->groupings, (fields ^= GROUPINGS_ADD) != 0);
             if (rc)
                 return rc;
         }
@@ -538,13 +555,45 @@ static int media_update_query(PGconn *conn, void *src_med, void *dst_med,
     return 0;
 }
 
+/**
+ * Only the updates of the media stats, done after each write, are done with a
+ * prepared statement.
+ */
+static int media_update_batch(void *src_med, void *dst_med, int item_cnt,
+                              int64_t update_fields, struct dss_batch *batch)
+{
+    if (update_fields == 0 || (update_fields & ~IS_STAT(update_fields)))
+        return -ENOTSUP;
+
+    for (int i = 0; i < item_cnt; ++i) {
+        struct media_info *src = ((struct media_info *) src_med) + i;
+        struct media_info *dst = ((struct media_info *) dst_med) + i;
+        struct dss_params params = {0};
+        char *stats;
+
+        stats = dss_media_stats_encode(dst->stats);
+        if (!stats)
+            LOG_RETURN(-EINVAL, "Failed to encode stats for media update");
+
+        dss_params_add_str(&params, stats);
+        dss_params_add_str(&params, rsc_family2str(src->rsc.id.family));
+        dss_params_add_str(&params, src->rsc.id.name);
+        dss_params_add_str(&params, src->rsc.id.library);
+        dss_batch_add(batch, DSS_STMT_MEDIA_STATS_UPDATE, &params);
+
+        free(stats);
+    }
+
+    return 0;
+}
+
 static int media_select_query(GString **conditions, int n_conditions,
                               GString *request, struct dss_sort *sort)
 {
     g_string_append(request,
                     "SELECT family, model, media.id, media.library, adm_status,"
                     " address_type, fs_type, fs_status, fs_label, stats, tags, "
-                    " put, get, delete FROM media");
+                    " put, get, delete, groupings FROM media");
 
     if (sort && sort->is_lock)
         g_string_append(request,
@@ -615,6 +664,12 @@ static int media_from_pg_row(struct dss_handle *handle, void *void_media,
     pho_debug("Decoded %lu tags (%s)",
               medium->tags.n_tags, PQgetvalue(res, row_num, 10));
 
+    rc = dss_tags_decode(&medium->groupings, PQgetvalue(res, row_num, 14));
+    if (rc) {
+        pho_error(rc, "dss_media groupings decode error");
+        return rc;
+    }
+
     rc = dss_lock_status(handle, DSS_MEDIA, medium, 1, &medium->lock);
     if (rc == -ENOLCK) {
         medium->lock.hostname = NULL;
@@ -633,6 +688,7 @@ static void media_result_free(void *void_media)
 
     pho_lock_clean(&media->lock);
     tags_free(&media->tags);
+    tags_free(&media->groupings);
 }
 
 const struct dss_resource_ops media_ops = {
@@ -640,6 +696,7 @@ const struct dss_resource_ops media_ops = {
     .update_query = media_update_query,
     .select_query = media_select_query,
     .delete_query = media_delete_query,
+    .update_batch = media_update_batch,
     .create       = media_from_pg_row,
     .free         = media_result_free,
     .size         = sizeof(struct media_info),
@@ -74,6 +74,30 @@ static int object_insert_query(PGconn *conn, void *void_object, int item_cnt,
     return 0;
 }
 
+static int object_insert_batch(void *void_object, int item_cnt,
+                               int64_t fields, struct dss_batch *batch)
+{
+    for (int i = 0; i < item_cnt; ++i) {
+        struct object_info *object = ((struct object_info *) void_object) + i;
+        struct dss_params params = {0};
+
+        dss_params_add_str(&params, object->oid);
+        if (fields & INSERT_OBJECT) {
+            dss_params_add_str(&params, object->user_md);
+            dss_params_add_str(&params, obj_status2str(object->obj_status));
+            dss_batch_add(batch, DSS_STMT_OBJECT_INSERT, &params);
+        } else {
+            dss_params_add_str(&params, object->uuid);
+            dss_params_add_int4(&params, object->version);
+            dss_params_add_str(&params, object->user_md);
+            dss_params_add_str(&params, obj_status2str(object->obj_status));
+            dss_batch_add(batch, DSS_STMT_OBJECT_FULL_INSERT, &params);
+        }
+    }
+
+    return 0;
+}
+
 static inline const char *_get_user_md(void *object)
 {
     return ((struct object_info *) object)->user_md;
@@ -178,6 +202,7 @@ const struct dss_resource_ops object_ops = {
     .update_query = object_update_query,
     .select_query = object_select_query,
     .delete_query = object_delete_query,
+    .insert_batch = object_insert_batch,
     .create       = object_from_pg_row,
     .free         = object_result_free,
     .size         = sizeof(struct object_info),
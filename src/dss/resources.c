@@ -102,6 +102,31 @@ int get_update_query(enum dss_type type, PGconn *conn, void *src_resource,
                                       item_count, fields, request);
 }
 
+int get_insert_batch(enum dss_type type, void *void_resource, int item_count,
+                     int64_t fields, struct dss_batch *batch)
+{
+    const struct dss_resource_ops *resource_ops = get_resource_ops(type);
+
+    if (resource_ops == NULL || resource_ops->insert_batch == NULL)
+        return -ENOTSUP;
+
+    return resource_ops->insert_batch(void_resource, item_count, fields,
+                                      batch);
+}
+
+int get_update_batch(enum dss_type type, void *src_resource,
+                     void *dst_resource, int item_count, int64_t fields,
+                     struct dss_batch *batch)
+{
+    const struct dss_resource_ops *resource_ops = get_resource_ops(type);
+
+    if (resource_ops == NULL || resource_ops->update_batch == NULL)
+        return -ENOTSUP;
+
+    return resource_ops->update_batch(src_resource, dst_resource, item_count,
+                                      fields, batch);
+}
+
 int get_select_query(enum dss_type type, GString **conditions, int n_conditions,
                      GString *request, struct dss_sort *sort)
 {
@@ -31,6 +31,7 @@
 #include <libpq-fe.h>
 #include <stddef.h>
 
+#include "dss_statements.h"
 #include "pho_dss.h"
 
 /**
@@ -52,6 +53,10 @@ struct dss_resource_ops {
     int (*select_query)(GString **conditions, int n_conditions,
                         GString *request, struct dss_sort *sort);
     int (*delete_query)(void *void_resource, int item_count, GString *request);
+    int (*insert_batch)(void *void_resource, int item_count, int64_t fields,
+                        struct dss_batch *batch);
+    int (*update_batch)(void *src_resource, void *dst_resource, int item_count,
+                        int64_t fields, struct dss_batch *batch);
     int (*create)(struct dss_handle *handle, void *void_resource,
                   PGresult *res, int row_num);
     void (*free)(void *void_resource);
@@ -103,6 +108,45 @@ int get_update_query(enum dss_type type, PGconn *conn, void *src_resource,
                      void *dst_resource, int item_count, int64_t fields,
                      GString *request);
 
+/**
+ * Get the prepared statements inserting resources into \p batch.
+ *
+ * \param[in]  type           The resource type whose insert_batch function
+ *                            should be called
+ * \param[in]  void_resource  The resources to insert
+ * \param[in]  item_count     The number of resources to insert
+ * \param[in]  fields         Additionnal fields used to specify the type of
+ *                            insert
+ * \param[out] batch          The batch in which to add the statements
+ *
+ * \return 0 on success, -ENOTSUP if the resource or this type of insert is not
+ *                                done with prepared statements, in which case
+ *                                get_insert_query should be used
+ *                       negative error code otherwise
+ */
+int get_insert_batch(enum dss_type type, void *void_resource, int item_count,
+                     int64_t fields, struct dss_batch *batch);
+
+/**
+ * Get the prepared statements updating resources into \p batch.
+ *
+ * \param[in]  type           The resource type whose update_batch function
+ *                            should be called
+ * \param[in]  src_resource   The resources to update
+ * \param[in]  dst_resource   The values to update the resources with
+ * \param[in]  item_count     The number of resources to update
+ * \param[in]  fields         The fields to update
+ * \param[out] batch          The batch in which to add the statements
+ *
+ * \return 0 on success, -ENOTSUP if the resource or this type of update is not
+ *                                done with prepared statements, in which case
+ *                                get_update_query should be used
+ *                       negative error code otherwise
+ */
+int get_update_batch(enum dss_type type, void *src_resource,
+                     void *dst_resource, int item_count, int64_t fields,
+                     struct dss_batch *batch);
+
 /**
  * Get the select query of a resource into \p request.
  *
@@ -27,8 +27,10 @@
 #include <assert.h>
 #include <errno.h>
 #include <glib.h>
+#include <jansson.h>
 #include <libpq-fe.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "pho_common.h"
 #include "pho_dss.h"
@@ -617,6 +619,12 @@ int dss_update_gc_for_tape(struct dss_handle *handle, const struct pho_id *tape)
         "  SELECT 1 FROM objects"
         "  WHERE object_uuid = layout.object_uuid"
         "   AND version = layout.version"
+        ");"
+        "DELETE FROM dedup "
+        "WHERE NOT EXISTS ("
+        "  SELECT 1 FROM layout"
+        "  WHERE object_uuid = dedup.object_uuid"
+        "   AND version = dedup.version"
         ");", tape->name, rsc_family2str(tape->family), tape->library);
 
     rc = execute_and_commit_or_rollback(handle->dh_conn, request, &res,
@@ -627,3 +635,367 @@ int dss_update_gc_for_tape(struct dss_handle *handle, const struct pho_id *tape)
 
     return check_orphan(handle, tape);
 }
+
+/** Append the SQL list of \p uuids, as "('uuid0', 'uuid1', ...)" */
+static void append_uuid_list(GString *request, const char **uuids,
+                             int num_uuids)
+{
+    int i;
+
+    for (i = 0; i < num_uuids; ++i)
+        g_string_append_printf(request, "%s'%s'%s", i == 0 ? "(" : "",
+                               uuids[i], i == num_uuids - 1 ? ")" : ", ");
+}
+
+int dss_update_extent_release(struct dss_handle *handle, const char **uuids,
+                              int num_uuids, const char *obj_uuid,
+                              int obj_version)
+{
+    GString *sharer;
+    GString *request;
+    int rc = 0;
+
+    if (num_uuids < 1)
+        return 0;
+
+    /* Another object version whose layout references all the extents */
+    sharer = g_string_new(
+        "SELECT object_uuid, version FROM layout WHERE extent_uuid IN ");
+    append_uuid_list(sharer, uuids, num_uuids);
+    g_string_append_printf(sharer,
+        " AND NOT (object_uuid = '%s' AND version = %d)"
+        " GROUP BY object_uuid, version"
+        " HAVING COUNT(DISTINCT extent_uuid) = %d"
+        " LIMIT 1", obj_uuid, obj_version, num_uuids);
+
+    request = g_string_new("BEGIN;");
+
+    /* Move the dedup entries to another user of the same extents, if any */
+    g_string_append_printf(request,
+        "DELETE FROM dedup "
+        "WHERE object_uuid = '%s' AND version = %d AND NOT EXISTS (%s);"
+        "UPDATE dedup SET (object_uuid, version) = (%s) "
+        "WHERE object_uuid = '%s' AND version = %d;",
+        obj_uuid, obj_version, sharer->str, sharer->str, obj_uuid,
+        obj_version);
+    g_string_free(sharer, true);
+
+    g_string_append(request,
+                    "UPDATE extent SET state = 'orphan' "
+                    "WHERE NOT EXISTS ("
+                    "  SELECT 1 FROM layout"
+                    "  WHERE layout.extent_uuid = extent.extent_uuid"
+                    ") AND extent_uuid IN ");
+    append_uuid_list(request, uuids, num_uuids);
+    g_string_append(request, ";");
+
+    rc = execute_and_commit_or_rollback(handle->dh_conn, request, NULL,
+                                        PGRES_COMMAND_OK);
+    g_string_free(request, true);
+    return rc;
+}
+
+int dss_dedup_lookup(struct dss_handle *handle, const char *digest,
+                     ssize_t size, enum rsc_family family,
+                     const char *layout_name, const char *library,
+                     const struct tags *tags, char **uuid, int *version)
+{
+    GString *request = g_string_new(NULL);
+    char *escaped_library = NULL;
+    char *escaped_layout;
+    char *escaped_tags = NULL;
+    PGresult *res = NULL;
+    int rc = 0;
+
+    *uuid = NULL;
+
+    escaped_layout = dss_char4sql(handle->dh_conn, layout_name);
+    if (!escaped_layout)
+        GOTO(out, rc = -EINVAL);
+
+    if (library) {
+        escaped_library = dss_char4sql(handle->dh_conn, library);
+        if (!escaped_library)
+            GOTO(out, rc = -EINVAL);
+    }
+
+    if (tags && tags->n_tags > 0) {
+        json_t *array = json_array();
+        char *tags_str;
+        size_t i;
+
+        for (i = 0; i < tags->n_tags; ++i)
+            json_array_append_new(array, json_string(tags->tags[i]));
+        tags_str = json_dumps(array, 0);
+        json_decref(array);
+        if (!tags_str)
+            GOTO(out, rc = -ENOMEM);
+
+        escaped_tags = dss_char4sql(handle->dh_conn, tags_str);
+        free(tags_str);
+        if (!escaped_tags)
+            GOTO(out, rc = -EINVAL);
+    }
+
+    /*
+     * Only match object versions whose extents are all still alive, and
+     * stored where the PUT asked for: same layout, family and library, on
+     * media having the requested tags.
+     */
+    g_string_printf(request,
+        "SELECT object_uuid, version FROM dedup "
+        "WHERE digest = '%s' AND size = %zd"
+        " AND EXISTS ("
+        "  SELECT 1 FROM layout"
+        "  WHERE layout.object_uuid = dedup.object_uuid"
+        "   AND layout.version = dedup.version"
+        " ) AND EXISTS ("
+        "  SELECT 1 FROM object"
+        "  WHERE object.object_uuid = dedup.object_uuid"
+        "   AND object.version = dedup.version"
+        "   AND object.lyt_info->>'name' = %s"
+        "  UNION ALL SELECT 1 FROM deprecated_object"
+        "  WHERE deprecated_object.object_uuid = dedup.object_uuid"
+        "   AND deprecated_object.version = dedup.version"
+        "   AND deprecated_object.lyt_info->>'name' = %s"
+        " ) AND NOT EXISTS ("
+        "  SELECT 1 FROM layout INNER JOIN extent USING (extent_uuid)"
+        "  LEFT JOIN media ON media.family = extent.medium_family"
+        "   AND media.id = extent.medium_id"
+        "   AND media.library = extent.medium_library"
+        "  WHERE layout.object_uuid = dedup.object_uuid"
+        "   AND layout.version = dedup.version"
+        "   AND (extent.state != 'sync'"
+        "    OR extent.medium_family != '%s'",
+        digest, size, escaped_layout, escaped_layout,
+        rsc_family2str(family));
+
+    if (escaped_library)
+        g_string_append_printf(request,
+                               " OR extent.medium_library != %s",
+                               escaped_library);
+
+    if (escaped_tags)
+        g_string_append_printf(request,
+                               " OR media.tags IS NULL"
+                               " OR NOT media.tags @> %s::jsonb",
+                               escaped_tags);
+
+    g_string_append(request, "));");
+
+    rc = execute(handle->dh_conn, request->str, &res, PGRES_TUPLES_OK);
+    if (rc)
+        goto out;
+
+    if (PQntuples(res) == 1) {
+        *uuid = xstrdup(PQgetvalue(res, 0, 0));
+        *version = atoi(PQgetvalue(res, 0, 1));
+    }
+
+out:
+    PQclear(res);
+    free_dss_char4sql(escaped_tags);
+    free_dss_char4sql(escaped_library);
+    free_dss_char4sql(escaped_layout);
+    g_string_free(request, true);
+    return rc;
+}
+
+int dss_dedup_register(struct dss_handle *handle, const char *digest,
+                       ssize_t size, const char *uuid, int version)
+{
+    GString *request = g_string_new("BEGIN;");
+    int rc = 0;
+
+    g_string_append_printf(request,
+        "INSERT INTO dedup (digest, size, object_uuid, version)"
+        " VALUES ('%s', %zd, '%s', %d)"
+        " ON CONFLICT (digest, size) DO UPDATE"
+        "  SET object_uuid = EXCLUDED.object_uuid,"
+        "      version = EXCLUDED.version;",
+        digest, size, uuid, version);
+
+    rc = execute_and_commit_or_rollback(handle->dh_conn, request, NULL,
+                                        PGRES_COMMAND_OK);
+    g_string_free(request, true);
+    return rc;
+}
+
+int dss_layout_share(struct dss_handle *handle, const char *src_uuid,
+                     int src_version, const char *oid)
+{
+    GString *request = g_string_new("BEGIN;");
+    char *escaped_oid;
+    PGresult *res;
+    int rc = 0;
+
+    escaped_oid = dss_char4sql(handle->dh_conn, oid);
+    if (!escaped_oid) {
+        g_string_free(request, true);
+        return -EINVAL;
+    }
+
+    /*
+     * The extents are locked so that they cannot be released while they are
+     * shared, and they are only shared if they are all still sync.
+     */
+    g_string_append_printf(request,
+        "WITH src AS ("
+        "  SELECT layout.extent_uuid, layout.layout_index, extent.state"
+        "  FROM layout INNER JOIN extent USING (extent_uuid)"
+        "  WHERE layout.object_uuid = '%s' AND layout.version = %d"
+        "  FOR SHARE OF extent"
+        "), shared AS ("
+        "  INSERT INTO layout (object_uuid, version, extent_uuid,"
+        "                      layout_index)"
+        "  SELECT object.object_uuid, object.version, src.extent_uuid,"
+        "         src.layout_index"
+        "  FROM src, object"
+        "  WHERE object.oid = %s"
+        "   AND NOT EXISTS (SELECT 1 FROM src WHERE state != 'sync')"
+        "  RETURNING 1"
+        ") SELECT COUNT(*) FROM shared;",
+        src_uuid, src_version, escaped_oid);
+
+    rc = execute(handle->dh_conn, request->str, &res, PGRES_TUPLES_OK);
+    if (!rc && atoi(PQgetvalue(res, 0, 0)) == 0) {
+        pho_warn("The extents of object '%s:%d' are no longer alive, its "
+                 "layout cannot be shared", src_uuid, src_version);
+        rc = -ENOENT;
+    }
+    PQclear(res);
+
+    if (rc) {
+        execute(handle->dh_conn, "ROLLBACK;", &res, PGRES_COMMAND_OK);
+        PQclear(res);
+        goto out;
+    }
+
+    g_string_printf(request,
+        "UPDATE object SET lyt_info = ("
+        "  SELECT lyt_info FROM object"
+        "  WHERE object_uuid = '%s' AND version = %d"
+        "  UNION SELECT lyt_info FROM deprecated_object"
+        "  WHERE object_uuid = '%s' AND version = %d"
+        "  LIMIT 1"
+        ") WHERE oid = %s;",
+        src_uuid, src_version, src_uuid, src_version, escaped_oid);
+
+    rc = execute_and_commit_or_rollback(handle->dh_conn, request, NULL,
+                                        PGRES_COMMAND_OK);
+
+out:
+    free_dss_char4sql(escaped_oid);
+    g_string_free(request, true);
+    return rc;
+}
+
+int dss_medium_usage_get(struct dss_handle *handle, enum rsc_family family,
+                         struct dss_medium_usage **usage, int *count)
+{
+    GString *request = g_string_new(NULL);
+    PGresult *res;
+    int rc = 0;
+    int i;
+
+    *usage = NULL;
+    *count = 0;
+
+    /* pending extents are being written and are neither live nor dead */
+    g_string_printf(request,
+        "SELECT medium_id, medium_library,"
+        " COALESCE(SUM(size) FILTER (WHERE live), 0),"
+        " COALESCE(SUM(size) FILTER (WHERE NOT live), 0)"
+        " FROM ("
+        "  SELECT extent.medium_id, extent.medium_library, extent.size,"
+        "   EXISTS ("
+        "    SELECT 1 FROM layout INNER JOIN object"
+        "     USING (object_uuid, version)"
+        "    WHERE layout.extent_uuid = extent.extent_uuid"
+        "   ) AS live"
+        "  FROM extent INNER JOIN media"
+        "   ON media.family = extent.medium_family"
+        "   AND media.id = extent.medium_id"
+        "   AND media.library = extent.medium_library"
+        "  WHERE extent.medium_family = '%s'"
+        "   AND extent.state != 'pending'"
+        "   AND media.adm_status = 'unlocked'"
+        " ) AS extents"
+        " GROUP BY medium_id, medium_library;", rsc_family2str(family));
+
+    rc = execute(handle->dh_conn, request->str, &res, PGRES_TUPLES_OK);
+    g_string_free(request, true);
+    if (rc)
+        goto out;
+
+    *count = PQntuples(res);
+    if (*count == 0)
+        goto out;
+
+    *usage = xcalloc(*count, sizeof(**usage));
+    for (i = 0; i < *count; i++) {
+        (*usage)[i].medium.family = family;
+        pho_id_name_set(&(*usage)[i].medium, PQgetvalue(res, i, 0),
+                        PQgetvalue(res, i, 1));
+        (*usage)[i].live_size = strtoll(PQgetvalue(res, i, 2), NULL, 10);
+        (*usage)[i].dead_size = strtoll(PQgetvalue(res, i, 3), NULL, 10);
+    }
+
+out:
+    PQclear(res);
+    return rc;
+}
+
+int dss_extent_orphan_claim(struct dss_handle *handle, struct extent *extents,
+                            int count, int *n_claimed)
+{
+    GString *request;
+    GHashTable *claimed;
+    PGresult *res;
+    int rc = 0;
+    int i;
+
+    *n_claimed = 0;
+    if (count < 1)
+        return 0;
+
+    request = g_string_new(
+        "DELETE FROM extent "
+        "WHERE state = 'orphan' AND NOT EXISTS ("
+        "  SELECT 1 FROM layout"
+        "  WHERE layout.extent_uuid = extent.extent_uuid"
+        ") AND extent_uuid IN (");
+
+    for (i = 0; i < count; ++i)
+        g_string_append_printf(request, "'%s'%s", extents[i].uuid,
+                               i == count - 1 ? ")" : ", ");
+    g_string_append(request, " RETURNING extent_uuid;");
+
+    rc = execute(handle->dh_conn, request->str, &res, PGRES_TUPLES_OK);
+    g_string_free(request, true);
+    if (rc)
+        goto out;
+
+    claimed = g_hash_table_new(g_str_hash, g_str_equal);
+    for (i = 0; i < PQntuples(res); ++i)
+        g_hash_table_add(claimed, PQgetvalue(res, i, 0));
+
+    for (i = 0; i < count; ++i) {
+        if (!g_hash_table_contains(claimed, extents[i].uuid))
+            continue;
+
+        if (i != *n_claimed) {
+            struct extent tmp = extents[*n_claimed];
+
+            extents[*n_claimed] = extents[i];
+            extents[i] = tmp;
+        }
+        (*n_claimed)++;
+    }
+
+    g_hash_table_destroy(claimed);
+
+out:
+    PQclear(res);
+    return rc;
+}
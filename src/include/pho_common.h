@@ -213,6 +213,7 @@ enum operation_type {
     PHO_LTFS_DF,
     PHO_LTFS_SYNC,
     PHO_LTFS_RELEASE,
+    PHO_MEDIUM_SCRUB,
     PHO_OPERATION_LAST,
 };
 
@@ -229,6 +230,7 @@ static const char * const OPERATION_TYPE_NAMES[] = {
     [PHO_LTFS_DF]       = "LTFS df",
     [PHO_LTFS_SYNC]     = "LTFS sync",
     [PHO_LTFS_RELEASE]  = "LTFS release",
+    [PHO_MEDIUM_SCRUB]  = "Medium scrub",
 };
 
 static inline const char *operation_type2str(enum operation_type op)
@@ -51,6 +51,7 @@ enum dss_type {
     DSS_MEDIA_UPDATE_LOCK,
     DSS_LOGS,
     DSS_FULL_LAYOUT,
+    DSS_MEDIA_RESERVATION,
     DSS_LAST,
 };
 
@@ -64,6 +65,7 @@ static const char * const dss_type_names[] = {
     [DSS_MEDIA_UPDATE_LOCK]  = "media_update",
     [DSS_LOGS] = "logs",
     [DSS_FULL_LAYOUT] = "full_layout",
+    [DSS_MEDIA_RESERVATION] = "media_reservation",
 };
 
 #define MAX_UPDATE_LOCK_TRY 5
@@ -249,6 +251,7 @@ static inline const char *dss_fields_pub2implem(const char *public_name)
 #define NB_OBJ              (1<<11)
 #define LOGC_SPC_USED       (1<<12)
 #define LIBRARY             (1<<13)
+#define GROUPINGS_ADD       (1<<14)
 
 #define IS_STAT(_f) ((NB_OBJ | NB_OBJ_ADD | LOGC_SPC_USED | LOGC_SPC_USED_ADD |\
                       PHYS_SPC_USED | PHYS_SPC_FREE) & (_f))
@@ -307,6 +310,15 @@ struct dss_handle {
  */
 int dss_init(struct dss_handle *handle);
 
+/**
+ *  Check that a connection can be used for new requests, after having been
+ *  kept idle. A connection closed by the server is reestablished.
+ *  @param[in,out]  handle  Connection handle
+ *  @return 0 on success, -ENOTCONN if the connection could not be
+ *          reestablished, -EBUSY if a transaction is still open on it.
+ */
+int dss_check(struct dss_handle *handle);
+
 /**
  *  Closes a connection
  *  @param[in,out]  handle  Connection handle
@@ -749,6 +761,28 @@ int dss_lock_hostname(struct dss_handle *handle, enum dss_type type,
                       const void *item_list, int item_cnt,
                       const char *hostname);
 
+/**
+ * Take locks on a specific hostname, independently from each other.
+ *
+ * All the locks are requested at once, and the ones which could be taken are
+ * kept even if others could not (as-much-as-possible policy).
+ *
+ * @param[in]   handle          DSS handle.
+ * @param[in]   type            Type of the resources to lock.
+ * @param[in]   item_list       List of resources to lock.
+ * @param[in]   item_cnt        Number of resources to lock.
+ * @param[in]   hostname        Hostname of the lock to set
+ * @param[out]  rcs             Outcome for each resource (0 or -EEXIST),
+ *                              ignored if NULL.
+ *
+ * @return                      0 on success,
+ *                             -EEXIST if one of the targeted locks already
+ *                              exists.
+ */
+int dss_lock_hostname_each(struct dss_handle *handle, enum dss_type type,
+                           const void *item_list, int item_cnt,
+                           const char *hostname, int *rcs);
+
 /**
  * Refresh lock timestamps.
  *
@@ -792,6 +826,26 @@ int dss_lock_refresh(struct dss_handle *handle, enum dss_type type,
 int dss_unlock(struct dss_handle *handle, enum dss_type type,
                const void *item_list, int item_cnt, bool force_unlock);
 
+/**
+ * Release locks and report the outcome of each unlock.
+ *
+ * Same as dss_unlock, the error of each resource being set in \p rcs.
+ *
+ * @param[in]   handle          DSS handle.
+ * @param[in]   type            Type of the ressources to unlock.
+ * @param[in]   item_list       List of ressources to unlock.
+ * @param[in]   item_cnt        Number of ressources to unlock.
+ * @param[in]   force_unlock    Whether we ignore the lock's hostname and owner
+ *                              or not.
+ * @param[out]  rcs             Outcome for each resource (0, -ENOLCK or
+ *                              -EACCES), ignored if NULL.
+ *
+ * @return                      0 on success, the first error otherwise.
+ */
+int dss_unlock_each(struct dss_handle *handle, enum dss_type type,
+                    const void *item_list, int item_cnt, bool force_unlock,
+                    int *rcs);
+
 /**
  * Retrieve the status of locks.
  *
@@ -818,6 +872,51 @@ int dss_lock_status(struct dss_handle *handle, enum dss_type type,
                     const void *item_list, int item_cnt,
                     struct pho_lock *locks);
 
+/**
+ * Reserve media for the host of the caller, which expects to mount them at
+ * \p expected.
+ *
+ * A reservation is a DSS_MEDIA_RESERVATION lock whose expected mount time is
+ * kept along with its host. It does not prevent anyone from locking the
+ * medium, it only tells where the medium will be mounted soon. A reservation
+ * of the caller is updated, one of another host or owner is only taken over
+ * if \p expected is sooner than its own expected mount time, or if this time
+ * is past: its owner did not refresh it while still expecting the medium.
+ *
+ * The media are reserved independently from each other (as-much-as-possible
+ * policy). The reservations are released with dss_unlock on
+ * DSS_MEDIA_RESERVATION.
+ *
+ * @param[in]   handle          DSS handle.
+ * @param[in]   med_ls          List of media to reserve.
+ * @param[in]   med_cnt         Number of media to reserve.
+ * @param[in]   expected        Expected mount time of the media.
+ *
+ * @return                      0 on success,
+ *                             -EEXIST if one of the media is reserved sooner,
+ *                              and not past, by another host or owner.
+ */
+int dss_medium_reserve(struct dss_handle *handle,
+                       const struct media_info *med_ls, int med_cnt,
+                       const struct timeval *expected);
+
+/**
+ * Retrieve the reservation of a medium.
+ *
+ * @param[in]   handle          DSS handle.
+ * @param[in]   medium_id       Medium whose reservation is queried.
+ * @param[out]  hostname        Host which reserved the medium, must be freed
+ *                              by the caller.
+ * @param[out]  expected        Expected mount time of the medium on
+ *                              \p hostname, ignored if NULL.
+ *
+ * @return                      0 on success,
+ *                             -ENOLCK if the medium is not reserved.
+ */
+int dss_medium_reservation(struct dss_handle *handle,
+                           const struct pho_id *medium_id, char **hostname,
+                           struct timeval *expected);
+
 /**
  * Clean locks based on hostname and type.
  *
@@ -229,4 +229,128 @@ int dss_update_extent_state(struct dss_handle *handle, const char **uuids,
 int dss_update_gc_for_tape(struct dss_handle *handle,
                            const struct pho_id *tape);
 
+/**
+ * Orphan the given extents once they are no longer referenced by any layout.
+ *
+ * Extents may be shared by several layouts when objects are deduplicated, so
+ * an extent released by an object only becomes orphan when its last reference
+ * is removed. The dedup entries which pointed to the released object version
+ * are moved to another object version still referencing the same extents, or
+ * removed if there is none.
+ *
+ * @param[in]   handle          DSS handle
+ * @param[in]   uuids           UUIDs of the released extents
+ * @param[in]   num_uuids       Number of released extents
+ * @param[in]   obj_uuid        UUID of the object releasing the extents
+ * @param[in]   obj_version     Version of the object releasing the extents
+ *
+ * @return 0 on success, -errno on failure
+ */
+int dss_update_extent_release(struct dss_handle *handle, const char **uuids,
+                              int num_uuids, const char *obj_uuid,
+                              int obj_version);
+
+/**
+ * Find an object version storing a content of digest \p digest and size
+ * \p size, whose extents are all still sync and stored where a PUT asked for.
+ *
+ * @param[in]   handle          DSS handle
+ * @param[in]   digest          Hexadecimal content digest
+ * @param[in]   size            Content size
+ * @param[in]   family          Family of the media of the extents
+ * @param[in]   layout_name     Name of the layout of the object version
+ * @param[in]   library         Library of the media of the extents, NULL for
+ *                              any library
+ * @param[in]   tags            Tags the media of the extents must have, NULL
+ *                              or empty for any media
+ * @param[out]  uuid            UUID of the matching object version, NULL if
+ *                              there is none (must be freed by the caller)
+ * @param[out]  version         Version of the matching object
+ *
+ * @return 0 on success, -errno on failure
+ */
+int dss_dedup_lookup(struct dss_handle *handle, const char *digest,
+                     ssize_t size, enum rsc_family family,
+                     const char *layout_name, const char *library,
+                     const struct tags *tags, char **uuid, int *version);
+
+/**
+ * Record that object version (\p uuid, \p version) stores a content of digest
+ * \p digest and size \p size, replacing any previous entry for this content.
+ *
+ * @param[in]   handle          DSS handle
+ * @param[in]   digest          Hexadecimal content digest
+ * @param[in]   size            Content size
+ * @param[in]   uuid            UUID of the object
+ * @param[in]   version         Version of the object
+ *
+ * @return 0 on success, -errno on failure
+ */
+int dss_dedup_register(struct dss_handle *handle, const char *digest,
+                       ssize_t size, const char *uuid, int version);
+
+/**
+ * Make the current version of object \p oid share the layout of the object
+ * version (\p src_uuid, \p src_version): its layout references the same
+ * extents and its layout description is copied.
+ *
+ * The layout is only shared if all its extents are still sync, and they are
+ * locked until the share is committed so that they cannot be released
+ * meanwhile.
+ *
+ * @param[in]   handle          DSS handle
+ * @param[in]   src_uuid        UUID of the object whose layout is shared
+ * @param[in]   src_version     Version of the object whose layout is shared
+ * @param[in]   oid             Object which gets the shared layout
+ *
+ * @return 0 on success, -ENOENT if an extent of the layout is not sync
+ *         anymore, -errno on other failures
+ */
+int dss_layout_share(struct dss_handle *handle, const char *src_uuid,
+                     int src_version, const char *oid);
+
+/** Space used on a medium by its live and dead extents */
+struct dss_medium_usage {
+    struct pho_id medium;
+    ssize_t       live_size;   /**< Size of the extents of alive objects */
+    ssize_t       dead_size;   /**< Size of the orphan extents and of the
+                                 *  extents only referenced by deprecated
+                                 *  objects, which a repack reclaims
+                                 */
+};
+
+/**
+ * Retrieve the space used by the live and the dead extents of each unlocked
+ * medium of a family.
+ *
+ * @param[in]   handle          DSS handle
+ * @param[in]   family          Family of the media
+ * @param[out]  usage           Usage of each medium holding extents (must be
+ *                              freed by the caller)
+ * @param[out]  count           Number of media in \p usage
+ *
+ * @return 0 on success, -errno on failure
+ */
+int dss_medium_usage_get(struct dss_handle *handle, enum rsc_family family,
+                         struct dss_medium_usage **usage, int *count);
+
+/**
+ * Remove from the DSS the given extents which are still orphan and not
+ * referenced by any layout, so that their data can be deleted from their
+ * medium.
+ *
+ * The check and the removal are done by a single statement, so an extent
+ * referenced again since it was listed is never claimed. The claimed extents
+ * are moved at the beginning of \p extents.
+ *
+ * @param[in]       handle      DSS handle
+ * @param[in, out]  extents     Orphan extents to claim
+ * @param[in]       count       Number of extents in \p extents
+ * @param[out]      n_claimed   Number of extents claimed
+ *
+ * @return 0 on success, -errno on failure
+ */
+int dss_extent_orphan_claim(struct dss_handle *handle, struct extent *extents,
+                            int count, int *n_claimed);
+
 #endif
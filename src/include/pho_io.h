@@ -100,6 +100,7 @@ struct pho_io_adapter_module_ops {
                     bool is_put);
     int (*ioa_write)(struct pho_io_descr *iod, const void *buf, size_t count);
     ssize_t (*ioa_read)(struct pho_io_descr *iod, void *buf, size_t count);
+    int (*ioa_seek)(struct pho_io_descr *iod, off_t offset);
     int (*ioa_close)(struct pho_io_descr *iod);
     int (*ioa_medium_sync)(const char *root_path, json_t **message);
     ssize_t (*ioa_preferred_io_size)(struct pho_io_descr *iod);
@@ -306,6 +307,31 @@ static inline ssize_t ioa_read(const struct io_adapter_module *ioa,
     return ioa->ops->ioa_read(iod, buf, count);
 }
 
+/**
+ * Move the read position of the IO adapter private context to \p offset
+ * bytes from the beginning of the extent. Subsequent ioa_read or ioa_get
+ * calls on this iod start from this position.
+ * This call is optional: adapters that cannot seek inside an extent leave it
+ * unset and only support whole extent reads.
+ *
+ * \param[in]      ioa     Suitable I/O adapter for the media
+ * \param[in]      iod     I/O descriptor opened by ioa_open
+ * \param[in]      offset  Offset in bytes from the beginning of the extent
+ *
+ * \return 0 on success, -ENOTSUP if the adapter does not support seeking,
+ *         negative error code on failure
+ */
+static inline int ioa_seek(const struct io_adapter_module *ioa,
+                           struct pho_io_descr *iod, off_t offset)
+{
+    assert(ioa != NULL);
+    assert(ioa->ops != NULL);
+    if (ioa->ops->ioa_seek == NULL)
+        return -ENOTSUP;
+
+    return ioa->ops->ioa_seek(iod, offset);
+}
+
 /**
  * Clean and free the iod_ctx
  * All I/O adapters must implement this call.
@@ -423,6 +449,31 @@ int copy_extent(struct io_adapter_module *ioa_source,
                 struct io_adapter_module *ioa_target,
                 struct pho_io_descr *iod_target);
 
+/*
+ * Write to a medium the XOR of two extents, which rebuilds the third extent of
+ * a raid4 split from the two others. The shortest source is padded with
+ * zeroes, and the target is truncated to its size.
+ *
+ * The source I/O descriptors must be filled as follows:
+ * iod_loc          Address and root path of the extent.
+ * iod_size         Size of the extent.
+ *
+ * The target I/O descriptor must be filled as follows:
+ * iod_loc          Address and root path of the extent.
+ * iod_size         Size of the extent.
+ *
+ * \param[in]       ioa_source   I/O adapter of the source media.
+ * \param[in, out]  iod_sources  I/O descriptors of the two source objects.
+ * \param[in]       ioa_target   I/O adapter of the target medium.
+ * \param[in, out]  iod_target   I/O descriptor of the target object.
+ *
+ * \return 0 on success, negative error code on failure.
+ */
+int xor_extents(struct io_adapter_module *ioa_source,
+                struct pho_io_descr *iod_sources,
+                struct io_adapter_module *ioa_target,
+                struct pho_io_descr *iod_target);
+
 /**
  * Set the common information regarding an object and the extent being
  * processed to the io adapter.
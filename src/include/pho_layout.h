@@ -73,6 +73,12 @@ struct pho_layout_module_ops {
 
     /** Updates the status of an object based on its extents */
     int (*reconstruct)(struct layout_info lyt, struct object_info *obj);
+
+    /**
+     * Make an encoder write the data of another encoder's object in its own
+     * extents (optional, only for layouts packing small objects together)
+     */
+    int (*pack)(struct pho_encoder *enc, struct pho_encoder *member);
 };
 
 /**
@@ -93,6 +99,9 @@ struct pho_enc_ops {
 
     /** Destroy this encoder / decoder */
     void (*destroy)(struct pho_encoder *enc);
+
+    /** Get the size of the object of this decoder (optional) */
+    int (*object_size)(struct pho_encoder *dec, size_t *size);
 };
 
 /**
@@ -231,6 +240,25 @@ static inline int layout_step(struct pho_encoder *enc, pho_resp_t *resp,
     return enc->ops->step(enc, resp, reqs, n_reqs);
 }
 
+/**
+ * Get the size of the object retrieved by a decoder, as recorded in its layout.
+ *
+ * @param[in]   dec     The decoder.
+ * @param[out]  size    Size of the whole object, regardless of the byte range
+ *                      requested.
+ *
+ * @return 0 on success, -ENOTSUP if the layout of \a dec does not provide it.
+ */
+static inline int layout_object_size(struct pho_encoder *dec, size_t *size)
+{
+    assert(dec->is_decoder);
+
+    if (!dec->ops->object_size)
+        return -ENOTSUP;
+
+    return dec->ops->object_size(dec, size);
+}
+
 /**
  * Update extent and layout metadata without attributes retrieved from the
  * extent using the io adapter provided.
@@ -258,6 +286,26 @@ int layout_get_specific_attrs(struct pho_io_descr *iod,
  */
 int layout_reconstruct(struct layout_info lyt, struct object_info *obj);
 
+/**
+ * Pack the object of encoder \a member in the extents written by encoder
+ * \a enc: \a enc will write the data of \a member after its own one, and
+ * \a member is marked as done without emitting any request.
+ *
+ * Once \a enc is done, the layout of \a member must be completed with the
+ * extents of \a enc before being saved. The layout description of \a member
+ * locates its data in these extents.
+ *
+ * Both encoders must be PUT encoders which have not emitted any request yet.
+ *
+ * @param[in]   enc     The encoder writing the packed data.
+ * @param[in]   member  The encoder whose object is packed.
+ *
+ * @return 0 on success, -errno on error. -ENOTSUP is returned if the layout of
+ * \a enc does not support packing or if the objects cannot be written in the
+ * same extents, -ENOSPC if \a enc cannot hold more data.
+ */
+int layout_pack(struct pho_encoder *enc, struct pho_encoder *member);
+
 /**
  * Destroy this encoder or decoder and all associated resources.
  */
@@ -216,7 +216,8 @@ struct lib_handle;
  *
  * lib_drive_lookup is mandatory.
  * lib_open, lib_close, lib_scan, lib_load, lib_unload, lib_refresh and
- * lib_ping do noop if they are NULL.
+ * lib_ping do noop if they are NULL. lib_stage is optional, the media of a
+ * library without it are only moved on load and unload.
  */
 struct pho_lib_adapter_module_ops {
     /* adapter functions */
@@ -230,6 +231,8 @@ struct pho_lib_adapter_module_ops {
                     const char *medium_label);
     int (*lib_unload)(struct lib_handle *lib, const char *device_serial,
                       const char *medium_label);
+    int (*lib_stage)(struct lib_handle *lib, const char *device_serial,
+                     const char *medium_label);
     int (*lib_refresh)(struct lib_handle *lib);
     int (*lib_ping)(struct lib_handle *lib, bool *library_is_up);
 };
@@ -431,6 +434,31 @@ static inline int ldm_lib_unload(struct lib_handle *lib_hdl,
                                                medium_label);
 }
 
+/**
+ * Move a medium to the free storage slot nearest to a device, so that its
+ * future load into this device is faster. The medium stays in the library
+ * and can still be loaded into any device.
+ *
+ * @param[in,out]   lib_hdl         Lib handle holding an opened library
+ *                                  adapter.
+ * @param[in]       device_serial   Serial number of the target device
+ * @param[in]       medium_label    Label of the medium to stage
+ *
+ * @return 0 on success, -ENOTSUP if the library cannot stage media, negative
+ *         error code on failure.
+ */
+static inline int ldm_lib_stage(struct lib_handle *lib_hdl,
+                                const char *device_serial,
+                                const char *medium_label)
+{
+    assert(lib_hdl->ld_module != NULL);
+    assert(lib_hdl->ld_module->ops != NULL);
+    if (lib_hdl->ld_module->ops->lib_stage == NULL)
+        return -ENOTSUP;
+    return lib_hdl->ld_module->ops->lib_stage(lib_hdl, device_serial,
+                                              medium_label);
+}
+
 static inline int ldm_lib_refresh(struct lib_handle *lib_hdl)
 {
     assert(lib_hdl->ld_module != NULL);
@@ -177,6 +177,22 @@ static inline bool pho_request_is_monitor(const pho_req_t *req)
     return req->monitor != NULL;
 }
 
+/**
+ * QoS class of a request.
+ *
+ * \param[in]   req    request
+ *
+ * \return             the class set by the client, PHO_QOS_NORMAL if it is
+ *                     unset or unknown.
+ */
+static inline enum pho_qos_class pho_request_qos(const pho_req_t *req)
+{
+    if (!req->has_qos || !qos_class2str((enum pho_qos_class)req->qos))
+        return PHO_QOS_NORMAL;
+
+    return (enum pho_qos_class)req->qos;
+}
+
 /**
  * Response write alloc checker.
  *
@@ -339,6 +355,24 @@ const char *pho_srl_error_kind_str(pho_resp_error_t *err);
 void pho_srl_request_write_alloc(pho_req_t *req, size_t n_media,
                                  size_t *n_tags);
 
+/**
+ * Allocation of the media to read of a write request, allocated with the
+ * media to write.
+ *
+ * \param[in, out]  req         Pointer to the write request data structure.
+ * \param[in]       n_sources   Number of media to read.
+ */
+void pho_srl_request_write_alloc_sources(pho_req_t *req, size_t n_sources);
+
+/**
+ * Allocation of the media which must not be allocated to write by a write
+ * request.
+ *
+ * \param[in, out]  req         Pointer to the write request data structure.
+ * \param[in]       n_excluded  Number of media to exclude.
+ */
+void pho_srl_request_write_alloc_excluded(pho_req_t *req, size_t n_excluded);
+
 /**
  * Allocation of read request contents.
  *
@@ -407,6 +441,14 @@ void pho_srl_request_free(pho_req_t *req, bool unpack);
  */
 void pho_srl_response_write_alloc(pho_resp_t *resp, size_t n_media);
 
+/**
+ * Allocation of the media to read of a write response.
+ *
+ * \param[in, out]  resp        Pointer to the write response data structure.
+ * \param[in]       n_sources   Number of media to read.
+ */
+void pho_srl_response_write_alloc_sources(pho_resp_t *resp, size_t n_sources);
+
 /**
  * Allocation of read response contents.
  *
@@ -41,6 +41,7 @@ typedef PhoTlcResponse__Ping        pho_tlc_resp_ping_t;
 typedef PhoTlcResponse__DriveLookup pho_tlc_resp_drive_lookup_t;
 typedef PhoTlcResponse__Load        pho_tlc_resp_load_t;
 typedef PhoTlcResponse__Unload      pho_tlc_resp_unload_t;
+typedef PhoTlcResponse__Stage       pho_tlc_resp_stage_t;
 typedef PhoTlcResponse__Status      pho_tlc_resp_status_t;
 
 /******************************************************************************/
@@ -115,6 +116,19 @@ static inline bool pho_tlc_request_is_unload(const pho_tlc_req_t *req)
     return req->unload != NULL;
 }
 
+/**
+ * Request stage checker.
+ *
+ * \param[in]       req         Request.
+ *
+ * \return                      true if the request is a stage one,
+ *                              false otherwise.
+ */
+static inline bool pho_tlc_request_is_stage(const pho_tlc_req_t *req)
+{
+    return req->stage != NULL;
+}
+
 /**
  * Request status checker.
  *
@@ -205,6 +219,20 @@ static inline bool pho_tlc_response_is_unload(const pho_tlc_resp_t *resp)
 {
     return resp->unload != NULL;
 }
+
+/**
+ * Response stage checker.
+ *
+ * \param[in]       resp        Response.
+ *
+ * \return                      true if the response is a stage one, false
+ *                              otherwise.
+ */
+static inline bool pho_tlc_response_is_stage(const pho_tlc_resp_t *resp)
+{
+    return resp->stage != NULL;
+}
+
 /**
  * Response status checker.
  *
@@ -264,6 +292,13 @@ void pho_srl_tlc_request_load_alloc(pho_tlc_req_t *req);
  */
 void pho_srl_tlc_request_unload_alloc(pho_tlc_req_t *req);
 
+/**
+ * Allocation of stage request contents.
+ *
+ * \param[out]      req         Pointer to the request data structure.
+ */
+void pho_srl_tlc_request_stage_alloc(pho_tlc_req_t *req);
+
 /**
  * Allocation of status request contents.
  *
@@ -315,6 +350,13 @@ void pho_srl_tlc_response_load_alloc(pho_tlc_resp_t *resp);
  */
 void pho_srl_tlc_response_unload_alloc(pho_tlc_resp_t *resp);
 
+/**
+ * Allocation of stage response content.
+ *
+ * \param[out]      resp        Pointer to the response data structure.
+ */
+void pho_srl_tlc_response_stage_alloc(pho_tlc_resp_t *resp);
+
 /**
  * Allocation of status response content.
  *
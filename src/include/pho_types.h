@@ -304,6 +304,45 @@ static inline enum rsc_family str2rsc_family(const char *str)
     return PHO_RSC_INVAL;
 }
 
+/**
+ * Quality of service class of the requests sent to the LRS.
+ * The LRS shares its devices between the classes according to their weights.
+ */
+enum pho_qos_class {
+    PHO_QOS_INVAL       = -1,
+    PHO_QOS_UNSET       =  0, /**< No class set, so that a zeroed structure
+                                *  does not select one
+                                */
+    PHO_QOS_NORMAL      =  1, /**< Default class */
+    PHO_QOS_INTERACTIVE =  2, /**< User requests waiting for their data */
+    PHO_QOS_BULK        =  3, /**< Background traffic (repack, migration) */
+    PHO_QOS_LAST,
+    PHO_QOS_FIRST       = PHO_QOS_NORMAL,
+};
+
+static const char * const qos_class_names[] = {
+    [PHO_QOS_NORMAL]      = "normal",
+    [PHO_QOS_INTERACTIVE] = "interactive",
+    [PHO_QOS_BULK]        = "bulk",
+};
+
+static inline const char *qos_class2str(enum pho_qos_class qos)
+{
+    if (qos >= PHO_QOS_LAST || qos < PHO_QOS_FIRST)
+        return NULL;
+    return qos_class_names[qos];
+}
+
+static inline enum pho_qos_class str2qos_class(const char *str)
+{
+    int i;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++)
+        if (!strcmp(str, qos_class_names[i]))
+            return i;
+    return PHO_QOS_INVAL;
+}
+
 /** Identifier */
 struct pho_id {
     enum rsc_family family;             /**< Resource family. */
@@ -519,6 +558,9 @@ struct media_info {
     struct pho_lock        lock;         /**< Distributed access lock */
     struct operation_flags flags;        /**< Media operation flags */
     size_t                 health;       /**< Current health of the medium */
+    struct tags            groupings;    /**< Groupings of the objects written
+                                           *  on the medium
+                                           */
 };
 
 enum obj_status {
@@ -289,6 +289,117 @@ int phobos_admin_format(struct admin_handle *adm, const struct pho_id *ids,
 int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
                         struct tags *tags);
 
+/**
+ * Migrate a set of tapes, by repacking them with several concurrent streams.
+ *
+ * Each stream copies the live extents of a source medium to a target medium,
+ * so the number of streams is bounded by half the number of unlocked drives.
+ * The media sharing a grouping are migrated by the same stream, and their
+ * extents consolidated on the same targets. The copied extents are recorded
+ * in the DSS as soon as the target is synced, so an interrupted migration is
+ * resumed by calling this function again with the same media.
+ *
+ * \param[in]       adm             Admin module handle.
+ * \param[in]       ids             Source media IDs.
+ * \param[in]       n_ids           Number of source media.
+ * \param[in]       tags            Tags for the destination media.
+ * \param[in]       nb_streams      Maximum number of concurrent streams, 0
+ *                                  to only be bounded by the drives.
+ *
+ * \return                          0     on success,
+ *                                 -errno on failure.
+ *
+ * This must be called with an admin_handle initialized with phobos_admin_init.
+ */
+int phobos_admin_migrate(struct admin_handle *adm, const struct pho_id *ids,
+                         int n_ids, struct tags *tags, int nb_streams);
+
+/**
+ * Rebuild the extents stored on failed media, from the surviving extents of
+ * their layout, on other media.
+ *
+ * The raid1 extents are copied from a surviving replica, the raid4 extents
+ * are recomputed from the two other extents of their split. The splits with
+ * the least redundancy left are rebuilt first, and each rebuilt extent
+ * replaces the lost one in the DSS as soon as its medium is synced, so an
+ * interrupted rebuild is resumed by calling this function again.
+ *
+ * \param[in]       adm             Admin module handle.
+ * \param[in]       tags            Tags for the destination media.
+ * \param[in]       max_rate        Maximum number of bytes rebuilt per
+ *                                  second, 0 for no limit.
+ * \param[out]      n_rebuilt       Number of extents rebuilt.
+ *
+ * \return                          0         on success,
+ *                                 -ENODATA  if a split lost too many extents
+ *                                           to be rebuilt,
+ *                                 -ENOTSUP  if an object has a layout which
+ *                                           cannot be rebuilt,
+ *                                 -errno    on other failures.
+ *
+ * This must be called with an admin_handle initialized with phobos_admin_init.
+ */
+int phobos_admin_rebuild(struct admin_handle *adm, struct tags *tags,
+                         size_t max_rate, int *n_rebuilt);
+
+/**
+ * Reclaim the space used by dead extents.
+ *
+ * The orphan extents of the directories and RADOS pools are deleted from their
+ * medium by batches, then from the DSS. As a tape cannot delete a single
+ * extent, the tapes whose dead extents, orphan or only referenced by
+ * deprecated objects, use at least \p repack_threshold of the space of their
+ * extents are repacked.
+ *
+ * \param[in]       adm              Admin module handle.
+ * \param[in]       tags             Tags for the target tapes of the repacks.
+ * \param[in]       batch_size       Maximum number of extents deleted per
+ *                                   allocation of a medium.
+ * \param[in]       repack_threshold Ratio of dead space, between 0 and 1,
+ *                                   from which a tape is repacked, 0 to not
+ *                                   repack tapes.
+ * \param[out]      reclaimed_size   Number of bytes reclaimed.
+ * \param[out]      n_repacked       Number of tapes repacked.
+ *
+ * \return                           0     on success,
+ *                                  -errno on failure.
+ *
+ * This must be called with an admin_handle initialized with phobos_admin_init.
+ */
+int phobos_admin_gc(struct admin_handle *adm, struct tags *tags,
+                    int batch_size, double repack_threshold,
+                    size_t *reclaimed_size, int *n_repacked);
+
+/**
+ * Verify the checksums of the extents of media, to detect silent corruption.
+ *
+ * The extents of each medium are read in one allocation, with a bulk QoS, in
+ * their order on the medium. The outcome of each medium is recorded as a
+ * "Medium scrub" log, which counts in the health of the medium.
+ *
+ * \param[in]       adm             Admin module handle.
+ * \param[in]       ids             Media to scrub, or NULL to scrub every
+ *                                  unlocked tape and directory with data, the
+ *                                  least recently scrubbed first.
+ * \param[in]       n_ids           Number of media in \p ids.
+ * \param[in]       max_rate        Maximum number of bytes read per second,
+ *                                  0 for no limit.
+ * \param[in]       max_time        Number of seconds after which no extent is
+ *                                  read anymore, 0 for no limit.
+ * \param[out]      n_checked       Number of extents verified.
+ * \param[out]      n_corrupted     Number of corrupted extents found.
+ *
+ * \return                          0         on success,
+ *                                 -EBADMSG  if a corrupted extent was found,
+ *                                 -errno    if an extent could not be read
+ *                                           or on other failures.
+ *
+ * This must be called with an admin_handle initialized with phobos_admin_init.
+ */
+int phobos_admin_scrub(struct admin_handle *adm, struct pho_id *ids,
+                       int n_ids, size_t max_rate, int max_time,
+                       int *n_checked, int *n_corrupted);
+
 /*
  * Ping the lrs phobosd daemon to check if it is online or not.
  *
@@ -351,6 +462,9 @@ void phobos_admin_layout_list_free(struct layout_info *layouts, int n_layouts);
  * Retrieve the name of the node which holds a medium or NULL if any node can
  * access this media.
  *
+ * A medium which is not locked is located on the node which reserved it to
+ * mount it soon, if any.
+ *
  * @param[in]   adm         Admin module handler.
  * @param[in]   medium_id   ID of the medium to locate.
  * @param[out]  node_name   Name of the node which holds \p medium_id or NULL.
@@ -383,7 +497,8 @@ int phobos_admin_medium_locate(struct admin_handle *adm,
  * If a given type or family is not valid or supported, return -EINVAL.
  *
  * If a valid family is given without a type or with a type different from
- * 'device', 'media_update' or 'media', an -EINVAL error is returned.
+ * 'device', 'media_update', 'media_reservation' or 'media', an -EINVAL error
+ * is returned.
  *
  * @param[in]   handle          Admin handle.
  * @param[in]   global          Bool parameter indicating if all locks should be
@@ -108,15 +108,35 @@ struct pho_xfer_put_params {
     bool             overwrite;   /**< true if the put command could be an
                                     *  update.
                                     */
+    const char      *compression; /**< Compression of the object data, as
+                                    *  "<codec>[:<level>]" (NULL or "none"
+                                    *  for no compression).
+                                    */
 };
 
 /**
  * GET parameters.
  * Node_name corresponds to the name of the node the object can be retrieved
  * from, if a phobos_get call fails.
+ *
+ * Offset and size describe the byte range of the object to retrieve. A null
+ * size means "up to the end of the object", so the default zeroed parameters
+ * retrieve the whole object. Only the extents overlapping the range are read
+ * from the media.
+ *
+ * Extent hashes cannot be checked on a partially read extent: when a range is
+ * requested, the hash verification is only done on the extents that are read
+ * in full and skipped for the others.
  */
 struct pho_xfer_get_params {
     char *node_name;                    /**< Node name [out] */
+    size_t offset;                      /**< Offset of the first byte to
+                                          *  retrieve [in]
+                                          */
+    size_t size;                        /**< Number of bytes to retrieve,
+                                          *  0 to read up to the end of the
+                                          *  object [in]
+                                          */
 };
 
 /**
@@ -147,18 +167,26 @@ struct pho_xfer_desc {
     union pho_xfer_params   xd_params; /**< Operation parameters. */
     enum pho_xfer_flags     xd_flags;  /**< See enum pho_xfer_flags doc. */
     int                     xd_rc;     /**< Outcome of this xfer. */
+    enum pho_qos_class      xd_qos;    /**< QoS class of the LRS requests of
+                                         *  this xfer (PHO_QOS_UNSET to use
+                                         *  the class of the put alias).
+                                         */
 };
 
 /**
  * Initialize the global context of Phobos.
  *
+ * Until phobos_fini is called, the connections to the DSS and the LRS opened
+ * by the store calls are kept open to be reused by the following calls. Calls
+ * made concurrently by several threads each use their own connections.
+ *
  * This must be called using the following order:
  *   phobos_init -> ... -> phobos_fini
  */
 int phobos_init(void);
 
 /**
- * Finalize the global context of Phobos.
+ * Finalize the global context of Phobos, closing the idle connections.
  *
  * This must be called using the following order:
  *   phobos_init -> ... -> phobos_fini
@@ -352,6 +380,33 @@ int phobos_locate(const char *obj_id, const char *uuid, int version,
  */
 int phobos_rename(const char *old_oid, const char *uuid, char *new_oid);
 
+/**
+ * Statistics of the read cache of the node, see the "cache_dir" parameter of
+ * the "store" section.
+ */
+struct pho_read_cache_stats {
+    size_t hits;            /**< GETs served by the cache */
+    size_t misses;          /**< GETs of objects which were not cached */
+    size_t evictions;       /**< Entries evicted to make room for others */
+    size_t n_entries;       /**< Number of cached object versions */
+    size_t size;            /**< Size of the cached object versions */
+    size_t max_size;        /**< Maximum size of the cached object versions */
+};
+
+/**
+ * Retrieve the statistics of the read cache of the node.
+ *
+ * The hits, misses and evictions are counted since the creation of the cache,
+ * by all the processes using it.
+ *
+ * @param[out]  stats   Statistics of the read cache
+ *
+ * @return              0 on success,
+ *                      -ENOTSUP if the read cache is disabled,
+ *                      -errno on other failures.
+ */
+int phobos_read_cache_stats(struct pho_read_cache_stats *stats);
+
 /**
  * Clean a pho_xfer_desc structure by freeing the uuid and attributes, and
  * the tags in case the xfer corresponds to a PUT operation.
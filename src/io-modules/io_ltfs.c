@@ -72,6 +72,7 @@ static const struct pho_io_adapter_module_ops IO_ADAPTER_LTFS_OPS = {
     .ioa_open              = pho_posix_open,
     .ioa_write             = pho_posix_write,
     .ioa_read              = pho_posix_read,
+    .ioa_seek              = pho_posix_seek,
     .ioa_close             = pho_posix_close,
     .ioa_medium_sync       = pho_ltfs_sync,
     .ioa_preferred_io_size = pho_posix_preferred_io_size,
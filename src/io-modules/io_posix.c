@@ -76,6 +76,7 @@ static const struct pho_io_adapter_module_ops IO_ADAPTER_POSIX_OPS = {
     .iod_from_fd           = pho_posix_iod_from_fd,
     .ioa_write             = pho_posix_write,
     .ioa_read              = pho_posix_read,
+    .ioa_seek              = pho_posix_seek,
     .ioa_close             = pho_posix_close,
     .ioa_medium_sync       = pho_posix_medium_sync,
     .ioa_preferred_io_size = pho_posix_preferred_io_size,
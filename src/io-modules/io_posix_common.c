@@ -801,6 +801,21 @@ ssize_t pho_posix_read(struct pho_io_descr *iod, void *buf, size_t count)
     return nb_read_bytes;
 }
 
+int pho_posix_seek(struct pho_io_descr *iod, off_t offset)
+{
+    struct posix_io_ctx *io_ctx;
+
+    io_ctx = iod->iod_ctx;
+    if (io_ctx == NULL || io_ctx->fd < 0)
+        LOG_RETURN(-EBADF, "Cannot seek in an extent which is not opened");
+
+    if (lseek(io_ctx->fd, offset, SEEK_SET) < 0)
+        LOG_RETURN(-errno, "Failed to seek to offset %jd in '%s'",
+                   (intmax_t) offset, io_ctx->fpath);
+
+    return 0;
+}
+
 /**
  * Closing iod->iod_ctx->fd and in-depth freeing of the iod->iod_ctx .
  */
@@ -214,6 +214,117 @@ memory:
     return rc;
 }
 
+int xor_extents(struct io_adapter_module *ioa_source,
+                struct pho_io_descr *iod_sources,
+                struct io_adapter_module *ioa_target,
+                struct pho_io_descr *iod_target)
+{
+    size_t left_to_read[2];
+    size_t left_to_write;
+    char *buffers[2];
+    size_t buf_size;
+    int n_opened = 0;
+    int rc2;
+    int rc;
+    int i;
+
+    get_preferred_io_block_size(&buf_size, ioa_target, iod_target);
+
+    buffers[0] = xcalloc(buf_size, sizeof(*buffers[0]));
+    buffers[1] = xcalloc(buf_size, sizeof(*buffers[1]));
+
+    /* retrieve the attributes describing the object from the first source */
+    pho_json_to_attrs(&iod_sources[0].iod_attrs,
+                      "{\"id\":\"\", \"user_md\":\"\", "
+                      "\"raid4.chunk_size\":\"\"}");
+
+    for (i = 0; i < 2; ++i, ++n_opened) {
+        rc = ioa_open(ioa_source, NULL, &iod_sources[i], false);
+        if (rc) {
+            iod_sources[i].iod_rc = rc;
+            LOG_GOTO(close_sources, rc, "Unable to open source object");
+        }
+
+        left_to_read[i] = iod_sources[i].iod_size;
+    }
+
+    iod_target->iod_attrs = iod_sources[0].iod_attrs;
+    left_to_write = iod_target->iod_size;
+
+    rc = ioa_open(ioa_target, NULL, iod_target, true);
+    if (rc) {
+        iod_target->iod_rc = rc;
+        LOG_GOTO(close_sources, rc, "Unable to open target object");
+    }
+
+    rc = ioa_set_md(ioa_target, NULL, iod_target);
+    if (rc) {
+        iod_target->iod_rc = rc;
+        LOG_GOTO(close, rc, "Unable to set attrs to target object");
+    }
+
+    while (left_to_write) {
+        size_t iter_size = min(buf_size, left_to_write);
+        size_t j;
+
+        /* the shortest source is padded with zeroes, as when it was written */
+        for (i = 0; i < 2; ++i) {
+            size_t to_read = min(iter_size, left_to_read[i]);
+            ssize_t nb_read_bytes = 0;
+
+            if (to_read) {
+                nb_read_bytes = ioa_read(ioa_source, &iod_sources[i],
+                                         buffers[i], to_read);
+                if (nb_read_bytes < 0) {
+                    iod_sources[i].iod_rc = nb_read_bytes;
+                    LOG_GOTO(close, rc = nb_read_bytes,
+                             "Unable to read %zu bytes", to_read);
+                }
+            }
+
+            if ((size_t)nb_read_bytes < iter_size)
+                memset(buffers[i] + nb_read_bytes, 0,
+                       iter_size - nb_read_bytes);
+
+            left_to_read[i] -= nb_read_bytes;
+        }
+
+        for (j = 0; j < iter_size; j++)
+            buffers[0][j] ^= buffers[1][j];
+
+        rc = ioa_write(ioa_target, iod_target, buffers[0], iter_size);
+        if (rc != 0) {
+            iod_target->iod_rc = rc;
+            LOG_GOTO(close, rc, "Unable to write %zu bytes", iter_size);
+        }
+
+        left_to_write -= iter_size;
+    }
+
+close:
+    rc2 = ioa_close(ioa_target, iod_target);
+    if (rc)
+        rc2 = ioa_del(ioa_target, iod_target);
+    if (!rc && rc2) {
+        iod_target->iod_rc = rc2;
+        rc = rc2;
+    }
+
+close_sources:
+    for (i = 0; i < n_opened; ++i) {
+        rc2 = ioa_close(ioa_source, &iod_sources[i]);
+        if (!rc && rc2) {
+            iod_sources[i].iod_rc = rc2;
+            rc = rc2;
+        }
+    }
+
+    free(buffers[0]);
+    free(buffers[1]);
+
+    return rc;
+}
+
 int set_object_md(const struct io_adapter_module *ioa, struct pho_io_descr *iod,
                   struct object_metadata *object_md)
 {
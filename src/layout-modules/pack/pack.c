@@ -0,0 +1,723 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2022 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Pack Layout plugin
+ *
+ * The pack layout writes the data of several small objects one after the
+ * other in the same replicated extents, called a container. Each object
+ * locates its data in the container with its offset and size, stored as
+ * layout attributes, so that it can be read alone with a ranged read of the
+ * container extents.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <jansson.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pho_attrs.h"
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_io.h"
+#include "pho_layout.h"
+#include "pho_module_loader.h"
+#include "pho_type_utils.h"
+#include "pack.h"
+#include "raid_common.h"
+
+#define PLUGIN_NAME     "pack"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc PACK_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+/**
+ * List of configuration parameters for this module
+ */
+enum pho_cfg_params_pack {
+    /* Actual parameters */
+    PHO_CFG_LYT_PACK_repl_count,
+    PHO_CFG_LYT_PACK_container_size,
+    PHO_CFG_LYT_PACK_max_objects,
+    PHO_CFG_LYT_PACK_extent_xxh128,
+    PHO_CFG_LYT_PACK_extent_md5,
+    PHO_CFG_LYT_PACK_check_hash,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_LYT_PACK_FIRST = PHO_CFG_LYT_PACK_repl_count,
+    PHO_CFG_LYT_PACK_LAST  = PHO_CFG_LYT_PACK_check_hash,
+};
+
+const struct pho_config_item cfg_lyt_pack[] = {
+    [PHO_CFG_LYT_PACK_repl_count] = {
+        .section = "layout_pack",
+        .name    = "repl_count",
+        .value   = "2"
+    },
+    [PHO_CFG_LYT_PACK_container_size] = {
+        .section = "layout_pack",
+        .name    = "container_size",
+        .value   = "1073741824" /* 1 GiB */
+    },
+    [PHO_CFG_LYT_PACK_max_objects] = {
+        .section = "layout_pack",
+        .name    = "max_objects",
+        .value   = "32"
+    },
+    [PHO_CFG_LYT_PACK_extent_xxh128] = {
+        .section = "layout_pack",
+        .name    = "extent_xxh128",
+        .value   = DEFAULT_XXH128,
+    },
+    [PHO_CFG_LYT_PACK_extent_md5] = {
+        .section = "layout_pack",
+        .name    = "extent_md5",
+        .value   = DEFAULT_MD5,
+    },
+    [PHO_CFG_LYT_PACK_check_hash] = {
+        .section = "layout_pack",
+        .name    = "check_hash",
+        .value   = DEFAULT_CHECK_HASH,
+    },
+};
+
+/**
+ * Private data of pack encoders and decoders.
+ */
+struct pack_io_context {
+    /** Generic RAID context, must stay first since it is the one expected in
+     * enc->priv_enc by the RAID common functions
+     */
+    struct raid_io_context raid;
+    /** Encoders whose objects are written after the own object of this
+     * encoder, in the order of their data in the container
+     */
+    GPtrArray *members;
+    /** Source being read: 0 for the own object, i for members[i - 1] */
+    size_t current_source;
+    /** Number of bytes left to read from the current source */
+    size_t source_left;
+};
+
+static int pack_attr_size(struct layout_info *layout, const char *name,
+                          size_t *value)
+{
+    const char *attr = pho_attr_get(&layout->layout_desc.mod_attrs, name);
+    int64_t parsed;
+
+    if (!attr)
+        LOG_RETURN(-EINVAL, "Unable to get '%s' from layout attrs", name);
+
+    parsed = str2int64(attr);
+    if (parsed < 0)
+        LOG_RETURN(-EINVAL, "Invalid '%s' layout attribute '%s'", name, attr);
+
+    *value = parsed;
+
+    return 0;
+}
+
+static void pack_attr_set_size(struct layout_info *layout, const char *name,
+                               size_t value)
+{
+    char str_buffer[32];
+
+    snprintf(str_buffer, sizeof(str_buffer), "%zu", value);
+    pho_attr_set(&layout->layout_desc.mod_attrs, name, str_buffer);
+}
+
+static size_t source_size(struct pack_io_context *pack, size_t source)
+{
+    struct pho_encoder *member;
+
+    if (source == 0)
+        return 0;
+
+    member = g_ptr_array_index(pack->members, source - 1);
+
+    return member->xfer->xd_params.put.size;
+}
+
+/**
+ * Return the I/O descriptor of the source to read next, moving to the next
+ * non empty source once the current one is fully read.
+ */
+static struct pho_io_descr *current_source(struct pack_io_context *pack)
+{
+    struct raid_io_context *member_context;
+    struct pho_encoder *member;
+
+    while (pack->source_left == 0 &&
+           pack->current_source < pack->members->len) {
+        pack->current_source++;
+        pack->source_left = source_size(pack, pack->current_source);
+    }
+
+    if (pack->current_source == 0)
+        return &pack->raid.posix;
+
+    member = g_ptr_array_index(pack->members, pack->current_source - 1);
+    member_context = member->priv_enc;
+
+    return &member_context->posix;
+}
+
+static int write_all_sources(struct pho_encoder *enc, size_t split_size)
+{
+    struct pack_io_context *pack = enc->priv_enc;
+    struct raid_io_context *io_context = &pack->raid;
+    size_t repl_count = n_total_extents(io_context);
+    struct pho_io_descr *iods = io_context->iods;
+    size_t buffer_size = io_context->buffers[0].size;
+    char *buffer = io_context->buffers[0].buff;
+    size_t to_write = split_size;
+    int rc;
+
+    while (to_write > 0) {
+        struct pho_io_descr *source = current_source(pack);
+        ssize_t read_size;
+        size_t i;
+
+        read_size = ioa_read(source->iod_ioa, source, buffer,
+                             min(min(to_write, buffer_size),
+                                 pack->source_left));
+        if (read_size < 0)
+            LOG_RETURN(read_size,
+                       "Error when reading source %zu in pack write, "
+                       "%zu remaining bytes", pack->current_source, to_write);
+        if (read_size == 0)
+            LOG_RETURN(-EIO,
+                       "Source %zu of pack write ended %zu bytes early",
+                       pack->current_source, pack->source_left);
+
+        for (i = 0; i < repl_count; ++i) {
+            rc = ioa_write(iods[i].iod_ioa, &iods[i], buffer, read_size);
+            if (rc)
+                LOG_RETURN(rc,
+                           "pack write: unable to write %zd bytes in replica "
+                           "%zu, %zu remaining bytes",
+                           read_size, i, to_write);
+
+            iods[i].iod_size += read_size;
+        }
+
+        rc = extent_hash_update(&io_context->hashes[0], buffer, read_size);
+        if (rc)
+            return rc;
+
+        to_write -= read_size;
+        pack->source_left -= read_size;
+    }
+
+    return 0;
+}
+
+static json_t *index_entry(struct pho_xfer_desc *xfer, size_t offset)
+{
+    return json_pack("{s:s, s:s, s:i, s:I, s:I}",
+                     "oid", xfer->xd_objid,
+                     "uuid", xfer->xd_objuuid,
+                     "version", xfer->xd_version,
+                     "offset", (json_int_t) offset,
+                     "size", (json_int_t) xfer->xd_params.put.size);
+}
+
+/**
+ * Build the in-container index of the extents of the current split: the list
+ * of the objects whose data overlap the split, with their container offset
+ * and size.
+ */
+static char *split_index(struct pho_encoder *enc, size_t split_offset,
+                         size_t split_size)
+{
+    struct pack_io_context *pack = enc->priv_enc;
+    size_t split_end = split_offset + split_size;
+    json_t *index = json_array();
+    size_t offset = 0;
+    char *str;
+    size_t i;
+
+    for (i = 0; i <= pack->members->len; i++) {
+        struct pho_xfer_desc *xfer;
+        size_t size;
+
+        if (i == 0) {
+            xfer = enc->xfer;
+        } else {
+            struct pho_encoder *member;
+
+            member = g_ptr_array_index(pack->members, i - 1);
+            xfer = member->xfer;
+        }
+
+        size = xfer->xd_params.put.size;
+        if (offset >= split_offset ? offset < split_end :
+                                     offset + size > split_offset)
+            json_array_append_new(index, index_entry(xfer, offset));
+
+        offset += size;
+    }
+
+    str = json_dumps(index, JSON_COMPACT);
+    json_decref(index);
+
+    return str;
+}
+
+static int set_layout_specific_md(struct pho_encoder *enc,
+                                  struct extent *extent,
+                                  struct pho_io_descr *iod, const char *index)
+{
+    struct raid_io_context *io_context = enc->priv_enc;
+    char str_buffer[16];
+    int rc;
+
+    rc = sprintf(str_buffer, "%d", extent->layout_idx);
+    if (rc < 0)
+        LOG_RETURN(-errno, "Unable to construct extent index buffer");
+
+    pho_attr_set(&iod->iod_attrs, PHO_EA_PACK_EXTENT_INDEX_NAME, str_buffer);
+
+    rc = sprintf(str_buffer, "%zu", n_total_extents(io_context));
+    if (rc < 0)
+        LOG_RETURN(-errno, "Unable to construct replica count buffer");
+
+    pho_attr_set(&iod->iod_attrs, PHO_EA_PACK_REPL_COUNT_NAME, str_buffer);
+    pho_attr_set(&iod->iod_attrs, PHO_EA_PACK_INDEX_NAME, index);
+
+    return 0;
+}
+
+static int pack_write_split(struct pho_encoder *enc, size_t split_size)
+{
+    struct raid_io_context *io_context = enc->priv_enc;
+    size_t repl_count = n_total_extents(io_context);
+    char *index;
+    int rc;
+    int i;
+
+    rc = write_all_sources(enc, split_size);
+    if (rc)
+        LOG_RETURN(rc, "Unable to write in pack encoder write");
+
+    rc = extent_hash_digest(&io_context->hashes[0]);
+    if (rc)
+        return rc;
+
+    index = split_index(enc, io_context->write.extents[0].offset, split_size);
+    if (!index)
+        LOG_RETURN(-ENOMEM, "Unable to build container index of '%s'",
+                   enc->xfer->xd_objid);
+
+    for (i = 0; i < repl_count; i++) {
+        struct extent *extent = &io_context->write.extents[i];
+
+        rc = extent_hash_copy(&io_context->hashes[0], extent);
+        if (rc)
+            break;
+
+        rc = set_layout_specific_md(enc, extent, &io_context->iods[i], index);
+        if (rc)
+            break;
+    }
+
+    free(index);
+
+    return rc;
+}
+
+static int checked_read(struct pho_encoder *dec, size_t size)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    struct pho_io_descr *iod = &io_context->iods[0];
+    size_t written = 0;
+    int rc;
+
+    while (written < size) {
+        ssize_t data_read;
+
+        data_read = ioa_read(iod->iod_ioa, iod, io_context->buffers[0].buff,
+                             min(io_context->buffers[0].size,
+                                 size - written));
+        if (data_read < 0)
+            return data_read;
+        if (data_read == 0)
+            return -EIO;
+
+        rc = ioa_write(io_context->posix.iod_ioa, &io_context->posix,
+                       io_context->buffers[0].buff, data_read);
+        if (rc)
+            return rc;
+
+        rc = extent_hash_update(&io_context->hashes[0],
+                                io_context->buffers[0].buff, data_read);
+        if (rc)
+            return rc;
+
+        written += data_read;
+    }
+
+    rc = extent_hash_digest(&io_context->hashes[0]);
+    if (rc)
+        return rc;
+
+    return extent_hash_compare(&io_context->hashes[0],
+                               io_context->read.extents[0]);
+}
+
+/**
+ * Read the part of the current split which belongs to the object. Extent
+ * hashes are only checked if the object covers the whole split.
+ */
+static int pack_read_split(struct pho_encoder *dec)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    struct pho_io_descr *iod = &io_context->iods[0];
+    struct pho_ext_loc loc;
+    bool full_split;
+    size_t offset;
+    size_t size;
+    int rc;
+
+    full_split = raid_read_split_window(dec, &offset, &size);
+    if (full_split && io_context->read.check_hash)
+        return checked_read(dec, size);
+
+    loc = make_ext_location(dec, 0);
+    if (offset > 0) {
+        rc = ioa_seek(iod->iod_ioa, iod, offset);
+        if (rc)
+            LOG_RETURN(rc, "Unable to seek at offset %zu in extent '%s'",
+                       offset, loc.extent->uuid);
+    }
+
+    iod->iod_fd = dec->xfer->xd_fd;
+    iod->iod_size = size;
+    iod->iod_loc = &loc;
+
+    return ioa_get(iod->iod_ioa, dec->xfer->xd_objid, iod);
+}
+
+static int pack_get_block_size(struct pho_encoder *enc, size_t *block_size)
+{
+    (void) enc;
+    (void) block_size;
+
+    return 0;
+}
+
+static void pack_encoder_destroy(struct pho_encoder *enc)
+{
+    struct pack_io_context *pack = enc->priv_enc;
+
+    if (pack && pack->members)
+        g_ptr_array_free(pack->members, TRUE);
+
+    raid_encoder_destroy(enc);
+}
+
+static const struct pho_enc_ops PACK_ENCODER_OPS = {
+    .step       = raid_encoder_step,
+    .destroy    = pack_encoder_destroy,
+    .object_size = raid_decoder_object_size,
+};
+
+static const struct raid_ops PACK_OPS = {
+    .write_split    = pack_write_split,
+    .read_split     = pack_read_split,
+    .get_block_size = pack_get_block_size,
+};
+
+static int pack_repl_count(struct layout_info *layout, unsigned int *repl_count)
+{
+    size_t value;
+    int rc;
+
+    rc = pack_attr_size(layout, PHO_EA_PACK_REPL_COUNT_NAME, &value);
+    if (rc)
+        return rc;
+
+    if (value == 0)
+        LOG_RETURN(-EINVAL, "Invalid replica count 0");
+
+    *repl_count = value;
+
+    return 0;
+}
+
+static int pack_set_repl_count(struct pho_encoder *enc,
+                               unsigned int *repl_count)
+{
+    const char *string_repl_count;
+
+    if (pho_attrs_is_empty(&enc->xfer->xd_params.put.lyt_params))
+        string_repl_count = PHO_CFG_GET(cfg_lyt_pack, PHO_CFG_LYT_PACK,
+                                        repl_count);
+    else
+        string_repl_count = pho_attr_get(&enc->xfer->xd_params.put.lyt_params,
+                                         "repl_count");
+
+    if (string_repl_count == NULL)
+        LOG_RETURN(-EINVAL, "Unable to get replica count from conf to "
+                            "build a pack encoder");
+
+    pho_attr_set(&enc->layout->layout_desc.mod_attrs,
+                 PHO_EA_PACK_REPL_COUNT_NAME, string_repl_count);
+
+    return pack_repl_count(enc->layout, repl_count);
+}
+
+/**
+ * Create an encoder. The encoder first writes its own object, then the objects
+ * packed with it by layout_pack_objects.
+ *
+ * Implements the layout_encode layout module methods.
+ */
+static int layout_pack_encode(struct pho_encoder *enc)
+{
+    struct pack_io_context *pack;
+    unsigned int repl_count;
+    enum pho_codec codec;
+    int level;
+    int rc;
+
+    /* The data of the members is appended as is to the container and read
+     * back as a range of the extents, which a compressed stream does not allow
+     */
+    rc = codec_parse(enc->xfer->xd_params.put.compression, &codec, &level);
+    if (rc)
+        return rc;
+
+    if (codec != PHO_CODEC_NONE)
+        LOG_RETURN(-ENOTSUP, "The pack layout does not support compression, "
+                             "cannot write '%s'", enc->xfer->xd_objid);
+
+    rc = pack_set_repl_count(enc, &repl_count);
+    if (rc)
+        return rc;
+
+    pack_attr_set_size(enc->layout, PHO_EA_PACK_OFFSET_NAME, 0);
+    pack_attr_set_size(enc->layout, PHO_EA_PACK_SIZE_NAME,
+                       enc->xfer->xd_params.put.size);
+
+    pack = xcalloc(1, sizeof(*pack));
+    enc->priv_enc = pack;
+    pack->members = g_ptr_array_new();
+    pack->source_left = enc->xfer->xd_params.put.size;
+    pack->raid.name = PLUGIN_NAME;
+    pack->raid.n_data_extents = 1;
+    pack->raid.n_parity_extents = repl_count - 1;
+    pack->raid.write.to_write = enc->xfer->xd_params.put.size;
+    pack->raid.nb_hashes = 1;
+    pack->raid.hashes = xcalloc(1, sizeof(*pack->raid.hashes));
+
+    rc = extent_hash_init(&pack->raid.hashes[0],
+                          PHO_CFG_GET_BOOL(cfg_lyt_pack, PHO_CFG_LYT_PACK,
+                                           extent_md5, false),
+                          PHO_CFG_GET_BOOL(cfg_lyt_pack, PHO_CFG_LYT_PACK,
+                                           extent_xxh128, false));
+    if (rc) {
+        pack->raid.nb_hashes = 0;
+        /* The rest will be free'd by layout_destroy */
+        return rc;
+    }
+
+    return raid_encoder_init(enc, &PACK_MODULE_DESC, &PACK_ENCODER_OPS,
+                             &PACK_OPS);
+}
+
+static bool str_eq_or_null(const char *lhs, const char *rhs)
+{
+    if (!lhs || !rhs)
+        return lhs == rhs;
+
+    return !strcmp(lhs, rhs);
+}
+
+/** Whether two objects can be written on the same media */
+static bool same_placement(struct pho_encoder *enc, struct pho_encoder *member)
+{
+    struct pho_xfer_put_params *lhs = &enc->xfer->xd_params.put;
+    struct pho_xfer_put_params *rhs = &member->xfer->xd_params.put;
+
+    return lhs->family == rhs->family &&
+           str_eq_or_null(lhs->library, rhs->library) &&
+           str_eq_or_null(lhs->grouping, rhs->grouping) &&
+           tags_eq(&lhs->tags, &rhs->tags) &&
+           str_eq_or_null(
+               pho_attr_get(&enc->layout->layout_desc.mod_attrs,
+                            PHO_EA_PACK_REPL_COUNT_NAME),
+               pho_attr_get(&member->layout->layout_desc.mod_attrs,
+                            PHO_EA_PACK_REPL_COUNT_NAME));
+}
+
+/** Implements the pack layout module method. */
+static int layout_pack_objects(struct pho_encoder *enc,
+                               struct pho_encoder *member)
+{
+    struct pack_io_context *pack = enc->priv_enc;
+    size_t size = member->xfer->xd_params.put.size;
+    int64_t container_size;
+    int max_objects;
+
+    if (pack->raid.requested_alloc)
+        LOG_RETURN(-EINVAL, "Cannot pack '%s' in '%s' once started",
+                   member->xfer->xd_objid, enc->xfer->xd_objid);
+
+    if (!same_placement(enc, member))
+        return -ENOTSUP;
+
+    container_size = str2int64(PHO_CFG_GET(cfg_lyt_pack, PHO_CFG_LYT_PACK,
+                                           container_size));
+    if (container_size < 0)
+        LOG_RETURN(-EINVAL, "Invalid value for container_size in section "
+                            "layout_pack");
+
+    max_objects = PHO_CFG_GET_INT(cfg_lyt_pack, PHO_CFG_LYT_PACK, max_objects,
+                                  0);
+    if (pack->members->len + 1 >= max_objects ||
+        enc->layout->wr_size + size > container_size)
+        return -ENOSPC;
+
+    pack_attr_set_size(member->layout, PHO_EA_PACK_OFFSET_NAME,
+                       enc->layout->wr_size);
+
+    g_ptr_array_add(pack->members, member);
+    pack->raid.write.to_write += size;
+    enc->layout->wr_size += size;
+    member->done = true;
+
+    pho_debug("Packing '%s' at offset %zu of the container of '%s'",
+              member->xfer->xd_objid, enc->layout->wr_size - size,
+              enc->xfer->xd_objid);
+
+    return 0;
+}
+
+/** Implements layout_decode layout module methods. */
+static int layout_pack_decode(struct pho_encoder *dec)
+{
+    struct pack_io_context *pack;
+    unsigned int repl_count;
+    size_t offset;
+    size_t size;
+    int rc;
+    int i;
+
+    ENTRY;
+
+    rc = pack_repl_count(dec->layout, &repl_count);
+    if (rc)
+        LOG_RETURN(rc, "Invalid replica count from layout to build pack "
+                       "decoder");
+
+    if (dec->layout->ext_count % repl_count != 0)
+        LOG_RETURN(-EINVAL, "layout extents count (%d) is not a multiple "
+                   "of replica count (%u)",
+                   dec->layout->ext_count, repl_count);
+
+    rc = pack_attr_size(dec->layout, PHO_EA_PACK_OFFSET_NAME, &offset);
+    if (rc)
+        return rc;
+
+    rc = pack_attr_size(dec->layout, PHO_EA_PACK_SIZE_NAME, &size);
+    if (rc)
+        return rc;
+
+    pack = xcalloc(1, sizeof(*pack));
+    dec->priv_enc = pack;
+    pack->raid.name = PLUGIN_NAME;
+    pack->raid.n_data_extents = 1;
+    pack->raid.n_parity_extents = repl_count - 1;
+    pack->raid.read.packed = true;
+    pack->raid.read.packed_offset = offset;
+    pack->raid.read.packed_size = size;
+    pack->raid.read.check_hash = PHO_CFG_GET_BOOL(cfg_lyt_pack,
+                                                  PHO_CFG_LYT_PACK,
+                                                  check_hash, true);
+    if (pack->raid.read.check_hash) {
+        pack->raid.nb_hashes = 1;
+        pack->raid.hashes = xcalloc(1, sizeof(*pack->raid.hashes));
+    }
+
+    rc = raid_decoder_init(dec, &PACK_MODULE_DESC, &PACK_ENCODER_OPS,
+                           &PACK_OPS);
+    if (rc)
+        return rc;
+
+    for (i = 0; i < dec->layout->ext_count / repl_count; i++)
+        pack->raid.read.to_read += dec->layout->extents[i * repl_count].size;
+
+    /* Empty GET does not need any IO */
+    if (pack->raid.read.to_read == 0 || size == 0)
+        dec->done = true;
+
+    return 0;
+}
+
+static int layout_pack_locate(struct dss_handle *dss,
+                              struct layout_info *layout,
+                              const char *focus_host, char **hostname,
+                              int *nb_new_locks)
+{
+    unsigned int repl_count;
+    int rc;
+
+    rc = pack_repl_count(layout, &repl_count);
+    if (rc)
+        LOG_RETURN(rc, "Invalid replica count from layout to locate");
+
+    return raid_locate(dss, layout, 1, repl_count - 1, focus_host, hostname,
+                       nb_new_locks);
+}
+
+static const struct pho_layout_module_ops LAYOUT_PACK_OPS = {
+    .encode = layout_pack_encode,
+    .decode = layout_pack_decode,
+    .locate = layout_pack_locate,
+    .get_specific_attrs = NULL,
+    .reconstruct = NULL,
+    .pack = layout_pack_objects,
+};
+
+/** Layout module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct layout_module *self = (struct layout_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = PACK_MODULE_DESC;
+    self->ops = &LAYOUT_PACK_OPS;
+
+    return 0;
+}
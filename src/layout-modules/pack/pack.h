@@ -0,0 +1,42 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2022 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Attribute names of the pack layout
+ */
+#ifndef _PHO_PACK_H
+#define _PHO_PACK_H
+
+/**
+ * Extended attributes' names for pack layout
+ */
+#define PHO_EA_PACK_EXTENT_INDEX_NAME    "pack.extent_index"
+#define PHO_EA_PACK_REPL_COUNT_NAME      "pack.repl_count"
+#define PHO_EA_PACK_INDEX_NAME           "pack.index"
+
+/**
+ * Layout attributes locating the data of an object in the extents of its
+ * container
+ */
+#define PHO_EA_PACK_OFFSET_NAME          "pack.offset"
+#define PHO_EA_PACK_SIZE_NAME            "pack.size"
+
+#endif
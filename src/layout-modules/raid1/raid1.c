@@ -137,11 +137,11 @@ static int write_all_chunks(struct raid_io_context *io_context,
     iods = io_context->iods;
 
     while (to_write > 0) {
+        size_t count = to_write > buffer_size ? buffer_size : to_write;
         ssize_t read_size;
         int i;
 
-        read_size = ioa_read(posix->iod_ioa, posix, buffer,
-                             to_write > buffer_size ? buffer_size : to_write);
+        read_size = ioa_read(posix->iod_ioa, posix, buffer, count);
         if (read_size < 0)
             LOG_RETURN(rc,
                        "Error when read buffer in raid1 write, "
@@ -166,6 +166,10 @@ static int write_all_chunks(struct raid_io_context *io_context,
             return rc;
 
         to_write -= read_size;
+
+        if (read_size < count)
+            /* end of a compressed stream, shorter than the split */
+            break;
     }
 
     return rc;
@@ -241,6 +245,11 @@ static int raid1_write_split(struct pho_encoder *enc, size_t split_size)
     return rc;
 }
 
+/**
+ * Copy the whole extent to the POSIX I/O descriptor of the decoder, checking
+ * its hash if configured to. The data goes through the decompression stage of
+ * the decoder, if any.
+ */
 static int checked_read(struct pho_encoder *dec)
 {
     struct raid_io_context *io_context = dec->priv_enc;
@@ -272,6 +281,9 @@ static int checked_read(struct pho_encoder *dec)
 
         written += data_read;
 
+        if (!io_context->read.check_hash)
+            continue;
+
         rc = extent_hash_update(&io_context->hashes[0],
                                 io_context->buffers[0].buff,
                                 data_read);
@@ -279,6 +291,9 @@ static int checked_read(struct pho_encoder *dec)
             return rc;
     }
 
+    if (!io_context->read.check_hash)
+        return 0;
+
     rc = extent_hash_digest(&io_context->hashes[0]);
     if (rc)
         return rc;
@@ -290,21 +305,41 @@ static int checked_read(struct pho_encoder *dec)
 /**
  * Read the data specified by \a extent from \a medium into the output fd of
  * dec->xfer.
+ *
+ * If only a part of the extent is requested by a ranged GET, seek to the first
+ * requested byte and only read the requested window. The extent hash cannot be
+ * checked in this case.
  */
 static int raid1_read_split(struct pho_encoder *dec)
 {
     struct raid_io_context *io_context = dec->priv_enc;
     struct pho_io_descr *iod;
     struct pho_ext_loc loc;
+    bool full_split;
+    size_t offset;
+    size_t size;
+    int rc;
 
-    if (io_context->read.check_hash)
+    full_split = raid_read_split_window(dec, &offset, &size);
+    if (full_split && (io_context->read.check_hash ||
+                       io_context->codec != PHO_CODEC_NONE))
         return checked_read(dec);
 
     iod = &io_context->iods[0];
     loc = make_ext_location(dec, 0);
 
+    if (!full_split) {
+        pho_debug("raid1: reading %zu bytes at offset %zu of extent '%s', "
+                  "skipping hash check", size, offset, loc.extent->uuid);
+
+        rc = ioa_seek(iod->iod_ioa, iod, offset);
+        if (rc)
+            LOG_RETURN(rc, "Unable to seek at offset %zu in extent '%s'",
+                       offset, loc.extent->uuid);
+    }
+
     iod->iod_fd = dec->xfer->xd_fd;
-    iod->iod_size = loc.extent->size;
+    iod->iod_size = size;
     iod->iod_loc = &loc;
 
     return ioa_get(iod->iod_ioa, dec->xfer->xd_objid, iod);
@@ -322,6 +357,7 @@ static int raid1_get_block_size(struct pho_encoder *enc,
 static const struct pho_enc_ops RAID1_ENCODER_OPS = {
     .step       = raid_encoder_step,
     .destroy    = raid_encoder_destroy,
+    .object_size = raid_decoder_object_size,
 };
 
 static const struct raid_ops RAID1_OPS = {
@@ -54,6 +54,7 @@ static struct raid_ops RAID4_OPS = {
 static const struct pho_enc_ops RAID4_ENCODER_OPS = {
     .step       = raid_encoder_step,
     .destroy    = raid_encoder_destroy,
+    .object_size = raid_decoder_object_size,
 };
 
 /**
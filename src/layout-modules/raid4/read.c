@@ -221,6 +221,137 @@ static int write_without_xor(struct pho_encoder *dec,
     return 0;
 }
 
+/**
+ * Write the part of [seg_start, seg_start + seg_size[ (offsets in the split
+ * data) which is inside the requested window [win_start, win_end[.
+ */
+static int write_window(struct pho_io_descr *posix, char *buff,
+                        size_t seg_start, size_t seg_size,
+                        size_t win_start, size_t win_end)
+{
+    size_t start = max(seg_start, win_start);
+    size_t end = min(seg_start + seg_size, win_end);
+
+    if (end <= start)
+        return 0;
+
+    return ioa_write(posix->iod_ioa, posix, buff + (start - seg_start),
+                     end - start);
+}
+
+static int read_chunk(struct pho_io_descr *iod, struct pho_buff *buff,
+                      size_t size)
+{
+    ssize_t data_read;
+
+    data_read = ioa_read(iod->iod_ioa, iod, buff->buff, size);
+    if (data_read < 0)
+        LOG_RETURN(data_read, "Failed to read file");
+
+    if (data_read != size)
+        LOG_RETURN(-EIO, "Short read of raid4 chunk: %zd/%zu bytes",
+                   data_read, size);
+
+    return 0;
+}
+
+/**
+ * Only read the stripes of the split which overlap the window requested by a
+ * ranged GET.
+ *
+ * A stripe is made of one chunk of part1 followed by one chunk of part2, all
+ * the stripes are full except the last one of the split, whose data is evenly
+ * split across the two parts. Both available extents are positioned at the
+ * first needed stripe, and only the needed stripes are read and, if necessary,
+ * reconstructed from the xor. The extent hashes are not checked.
+ */
+static int read_window(struct pho_encoder *dec, bool has_part1, bool has_xor,
+                       size_t win_offset, size_t win_size)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    struct pho_io_descr *posix = &io_context->posix;
+    struct pho_io_descr *iods = io_context->iods;
+    struct pho_buff *buffers = io_context->buffers;
+    size_t chunk_size = buffers[0].size;
+    size_t win_end = win_offset + win_size;
+    struct extent *split_extents;
+    size_t first_stripe;
+    size_t last_stripe;
+    size_t stripe;
+    int rc;
+    int i;
+
+    ENTRY;
+
+    split_extents = dec->layout->extents +
+        io_context->current_split * n_total_extents(io_context);
+
+    first_stripe = win_offset / (2 * chunk_size);
+    last_stripe = (win_end - 1) / (2 * chunk_size);
+
+    pho_debug("raid4: reading stripes %zu to %zu of split %zu, skipping hash "
+              "check", first_stripe, last_stripe, io_context->current_split);
+
+    for (i = 0; i < io_context->n_data_extents; i++) {
+        rc = ioa_seek(iods[i].iod_ioa, &iods[i], first_stripe * chunk_size);
+        if (rc)
+            LOG_RETURN(rc, "Unable to seek at stripe %zu of extent '%s'",
+                       first_stripe, io_context->read.extents[i]->uuid);
+    }
+
+    for (stripe = first_stripe; stripe <= last_stripe; stripe++) {
+        size_t stripe_start = stripe * 2 * chunk_size;
+        size_t part1_size;
+        size_t part2_size;
+        char *part1;
+        char *part2;
+
+        part1_size = min(chunk_size,
+                         split_extents[0].size - stripe * chunk_size);
+        part2_size = min(chunk_size,
+                         split_extents[1].size - stripe * chunk_size);
+
+        /* iods[0] is part1 if present, part2 otherwise. iods[1] is the xor if
+         * present, part2 otherwise. The xor chunk is as large as part1.
+         */
+        rc = read_chunk(&iods[0], &buffers[0],
+                        has_part1 ? part1_size : part2_size);
+        if (rc)
+            return rc;
+
+        rc = read_chunk(&iods[1], &buffers[1],
+                        has_xor ? part1_size : part2_size);
+        if (rc)
+            return rc;
+
+        if (has_part1 && !has_xor) {
+            part1 = buffers[0].buff;
+            part2 = buffers[1].buff;
+        } else if (has_part1) {
+            buffer_xor(&buffers[0], &buffers[1], &buffers[2], part2_size);
+            part1 = buffers[0].buff;
+            part2 = buffers[2].buff;
+        } else {
+            memset(buffers[0].buff + part2_size, 0, part1_size - part2_size);
+            buffer_xor(&buffers[0], &buffers[1], &buffers[2], part1_size);
+            part1 = buffers[2].buff;
+            part2 = buffers[0].buff;
+        }
+
+        rc = write_window(posix, part1, stripe_start, part1_size,
+                          win_offset, win_end);
+        if (rc)
+            LOG_RETURN(rc, "Failed to write in file");
+
+        rc = write_window(posix, part2, stripe_start + part1_size, part2_size,
+                          win_offset, win_end);
+        if (rc)
+            LOG_RETURN(rc, "Failed to write in file");
+    }
+
+    return 0;
+}
+
 /* has_part1 and has_xor are tested first as it is easier to check for their
  * presence.
  *
@@ -240,9 +371,14 @@ int raid4_read_split(struct pho_encoder *dec)
     bool has_part1 = (io_context->read.extents[0]->layout_idx % 3) == 0;
     bool has_xor = (io_context->read.extents[1]->layout_idx % 3) == 2;
     bool has_part2 = !has_part1 || !has_xor;
+    size_t win_offset;
+    size_t win_size;
 
     ENTRY;
 
+    if (!raid_read_split_window(dec, &win_offset, &win_size))
+        return read_window(dec, has_part1, has_xor, win_offset, win_size);
+
     if (has_part1 && has_part2)
         return write_without_xor(dec, &iods[0], &iods[1]);
     else if (has_part1 && has_xor)
@@ -108,7 +108,8 @@ int raid4_write_split(struct pho_encoder *enc, size_t split_size)
 
         left_to_read -= bytes_read1;
         left_to_read -= bytes_read2;
-        eof = (left_to_read == 0);
+        /* a short read marks the end of a compressed stream */
+        eof = (left_to_read == 0 || bytes_read2 < buf_size);
 
         rc = ioa_write(iods[0].iod_ioa, &iods[0], io_context->buffers[0].buff,
                        bytes_read1);
@@ -0,0 +1,338 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  GF(2^8) arithmetic of the Reed-Solomon layout
+ *
+ * Elements are reduced by the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d).
+ *
+ * Region multiplications use the "split table" method: the product of c by a
+ * byte is the xor of the products of c by its low and high nibbles, which are
+ * looked up in two 16-entry tables. With SSSE3 or AVX2, the lookups are done
+ * 16 or 32 bytes at a time by a byte shuffle. The kernel is selected at load
+ * time depending on the features of the CPU.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rs.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "pho_common.h"
+
+#define GF_POLYNOMIAL 0x11d
+
+static uint8_t gf_exp[2 * 255];
+static uint8_t gf_log[256];
+
+/**
+ * Region kernel: xor the product of src by the constant described by its
+ * nibble tables to dst, return the number of bytes processed (the remaining
+ * ones are processed by the generic code).
+ */
+typedef size_t (*gf_kernel_t)(const uint8_t *tbl_lo, const uint8_t *tbl_hi,
+                              const uint8_t *src, uint8_t *dst, size_t len);
+
+static gf_kernel_t gf_kernel;
+static const char *gf_kernel_str = "generic";
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("ssse3")))
+static size_t gf_kernel_ssse3(const uint8_t *tbl_lo, const uint8_t *tbl_hi,
+                              const uint8_t *src, uint8_t *dst, size_t len)
+{
+    __m128i lo = _mm_loadu_si128((const __m128i *)tbl_lo);
+    __m128i hi = _mm_loadu_si128((const __m128i *)tbl_hi);
+    __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(s, mask));
+        __m128i h = _mm_shuffle_epi8(hi,
+                                     _mm_and_si128(_mm_srli_epi64(s, 4),
+                                                   mask));
+
+        d = _mm_xor_si128(d, _mm_xor_si128(l, h));
+        _mm_storeu_si128((__m128i *)(dst + i), d);
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t gf_kernel_avx2(const uint8_t *tbl_lo, const uint8_t *tbl_hi,
+                             const uint8_t *src, uint8_t *dst, size_t len)
+{
+    __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)tbl_lo));
+    __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)tbl_hi));
+    __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(s, mask));
+        __m256i h = _mm256_shuffle_epi8(hi,
+                                        _mm256_and_si256(_mm256_srli_epi64(s,
+                                                                           4),
+                                                         mask));
+
+        d = _mm256_xor_si256(d, _mm256_xor_si256(l, h));
+        _mm256_storeu_si256((__m256i *)(dst + i), d);
+    }
+
+    return i;
+}
+#endif
+
+__attribute__((constructor)) static void gf_init(void)
+{
+    unsigned int x = 1;
+    int i;
+
+    for (i = 0; i < 255; i++) {
+        gf_exp[i] = x;
+        gf_exp[i + 255] = x;
+        gf_log[x] = i;
+
+        x <<= 1;
+        if (x & 0x100)
+            x ^= GF_POLYNOMIAL;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+#endif
+    if (gf_kernel_select("avx2"))
+        gf_kernel_select("ssse3");
+}
+
+int gf_kernel_select(const char *name)
+{
+    if (!strcmp(name, "generic")) {
+        gf_kernel = NULL;
+        gf_kernel_str = "generic";
+        return 0;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (!strcmp(name, "ssse3")) {
+        if (!__builtin_cpu_supports("ssse3"))
+            return -ENOTSUP;
+
+        gf_kernel = gf_kernel_ssse3;
+        gf_kernel_str = "ssse3";
+        return 0;
+    }
+
+    if (!strcmp(name, "avx2")) {
+        if (!__builtin_cpu_supports("avx2"))
+            return -ENOTSUP;
+
+        gf_kernel = gf_kernel_avx2;
+        gf_kernel_str = "avx2";
+        return 0;
+    }
+#endif
+
+    return -EINVAL;
+}
+
+const char *gf_kernel_name(void)
+{
+    return gf_kernel_str;
+}
+
+uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0)
+        return 0;
+
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static uint8_t gf_inv(uint8_t a)
+{
+    assert(a != 0);
+
+    return gf_exp[255 - gf_log[a]];
+}
+
+void gf_vect_mul_add(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    uint8_t tbl_lo[16];
+    uint8_t tbl_hi[16];
+    size_t i = 0;
+    int j;
+
+    if (c == 0)
+        return;
+
+    if (c == 1) {
+        for (i = 0; i < len; i++)
+            dst[i] ^= src[i];
+        return;
+    }
+
+    for (j = 0; j < 16; j++) {
+        tbl_lo[j] = gf_mul(c, j);
+        tbl_hi[j] = gf_mul(c, j << 4);
+    }
+
+    if (gf_kernel)
+        i = gf_kernel(tbl_lo, tbl_hi, src, dst, len);
+
+    for (; i < len; i++)
+        dst[i] ^= tbl_lo[src[i] & 0x0f] ^ tbl_hi[src[i] >> 4];
+}
+
+void rs_encoding_matrix(int k, int m, uint8_t *matrix)
+{
+    int i;
+    int j;
+
+    /* Cauchy matrix: 1 / (x_i + y_j) with x_i = k + i and y_j = j, which are
+     * all distinct elements of the field.
+     */
+    for (i = 0; i < m; i++)
+        for (j = 0; j < k; j++)
+            matrix[i * k + j] = gf_inv((k + i) ^ j);
+}
+
+/** Invert the n x n matrix \p in into \p out, \p in is modified */
+static int gf_invert_matrix(uint8_t *in, uint8_t *out, int n)
+{
+    int col;
+    int row;
+    int i;
+
+    memset(out, 0, n * n);
+    for (i = 0; i < n; i++)
+        out[i * n + i] = 1;
+
+    for (col = 0; col < n; col++) {
+        uint8_t pivot_inv;
+
+        /* find a non-null pivot and move it on the diagonal */
+        for (row = col; row < n && in[row * n + col] == 0; row++)
+            ;
+
+        if (row == n)
+            return -EINVAL;
+
+        if (row != col) {
+            for (i = 0; i < n; i++) {
+                uint8_t tmp;
+
+                tmp = in[row * n + i];
+                in[row * n + i] = in[col * n + i];
+                in[col * n + i] = tmp;
+
+                tmp = out[row * n + i];
+                out[row * n + i] = out[col * n + i];
+                out[col * n + i] = tmp;
+            }
+        }
+
+        pivot_inv = gf_inv(in[col * n + col]);
+        for (i = 0; i < n; i++) {
+            in[col * n + i] = gf_mul(in[col * n + i], pivot_inv);
+            out[col * n + i] = gf_mul(out[col * n + i], pivot_inv);
+        }
+
+        /* eliminate the column from the other rows */
+        for (row = 0; row < n; row++) {
+            uint8_t factor = in[row * n + col];
+
+            if (row == col || factor == 0)
+                continue;
+
+            for (i = 0; i < n; i++) {
+                in[row * n + i] ^= gf_mul(factor, in[col * n + i]);
+                out[row * n + i] ^= gf_mul(factor, out[col * n + i]);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int rs_decoding_matrix(int k, int m, const int *rows, const int *missing,
+                       int n_missing, uint8_t *matrix)
+{
+    uint8_t *encoding;
+    uint8_t *inverse;
+    uint8_t *sub;
+    int rc;
+    int i;
+
+    encoding = xmalloc(m * k);
+    sub = xcalloc(k * k, 1);
+    inverse = xmalloc(k * k);
+
+    rs_encoding_matrix(k, m, encoding);
+
+    /* rows of the encoding matrix which produced the available extents */
+    for (i = 0; i < k; i++) {
+        if (rows[i] < k)
+            sub[i * k + rows[i]] = 1;
+        else
+            memcpy(sub + i * k, encoding + (rows[i] - k) * k, k);
+    }
+
+    rc = gf_invert_matrix(sub, inverse, k);
+    if (rc)
+        LOG_GOTO(out, rc, "Unable to invert the Reed-Solomon decoding matrix");
+
+    for (i = 0; i < n_missing; i++)
+        memcpy(matrix + i * k, inverse + missing[i] * k, k);
+
+out:
+    free(inverse);
+    free(sub);
+    free(encoding);
+
+    return rc;
+}
+
+void rs_matrix_apply(const uint8_t *matrix, int n_out, int n_in,
+                     uint8_t **in, uint8_t **out, size_t len)
+{
+    int i;
+    int j;
+
+    for (i = 0; i < n_out; i++) {
+        memset(out[i], 0, len);
+        for (j = 0; j < n_in; j++)
+            gf_vect_mul_add(matrix[i * n_in + j], in[j], out[i], len);
+    }
+}
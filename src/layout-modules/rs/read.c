@@ -0,0 +1,255 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Reed-Solomon Layout plugin
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rs.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Write the part of [seg_start, seg_start + seg_size[ (offsets in the split
+ * data) which is inside the requested window [win_start, win_end[.
+ */
+static int write_window(struct pho_io_descr *posix, uint8_t *buff,
+                        size_t seg_start, size_t seg_size,
+                        size_t win_start, size_t win_end)
+{
+    size_t start = max(seg_start, win_start);
+    size_t end = min(seg_start + seg_size, win_end);
+
+    if (end <= start)
+        return 0;
+
+    return ioa_write(posix->iod_ioa, posix, buff + (start - seg_start),
+                     end - start);
+}
+
+/** Size of the chunk of the \p extent in stripe \p stripe */
+static size_t chunk_size_in_stripe(struct extent *extent, size_t stripe,
+                                   size_t chunk_size)
+{
+    if (extent->size <= stripe * chunk_size)
+        return 0;
+
+    return min(chunk_size, extent->size - stripe * chunk_size);
+}
+
+static int read_chunk(struct raid_io_context *io_context, int i, size_t size,
+                      size_t stripe_size, bool check_hash)
+{
+    struct pho_io_descr *iod = &io_context->iods[i];
+    char *buff = io_context->buffers[i].buff;
+    ssize_t data_read;
+    int rc;
+
+    if (size > 0) {
+        data_read = ioa_read(iod->iod_ioa, iod, buff, size);
+        if (data_read < 0)
+            LOG_RETURN(data_read, "Failed to read file");
+
+        if (data_read != size)
+            LOG_RETURN(-EIO, "Short read of rs chunk: %zd/%zu bytes",
+                       data_read, size);
+
+        if (check_hash) {
+            rc = extent_hash_update(&io_context->hashes[i], buff, size);
+            if (rc)
+                return rc;
+        }
+    }
+
+    /* the data chunks of the last stripe are zero-padded in the parity */
+    memset(buff + size, 0, stripe_size - size);
+
+    return 0;
+}
+
+/**
+ * Read the stripes of the current split overlapping [win_offset,
+ * win_offset + win_size[ from the k extents allocated by the LRS, rebuild the
+ * data chunks of the missing data extents if any, and write the requested
+ * window to the output file.
+ *
+ * The k read extents are sorted by layout index: the available data extents
+ * come first, followed by the parity extents.
+ */
+static int read_stripes(struct pho_encoder *dec, size_t win_offset,
+                        size_t win_size, bool check_hash)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    struct pho_io_descr *posix = &io_context->posix;
+    size_t chunk_size = io_context->buffers[0].size;
+    struct pho_io_descr *iods = io_context->iods;
+    int n_extents = n_total_extents(io_context);
+    int k = io_context->n_data_extents;
+    size_t win_end = win_offset + win_size;
+    uint8_t *rebuilt[RS_MAX_EXTENTS];
+    uint8_t *source[RS_MAX_EXTENTS];
+    uint8_t *data[RS_MAX_EXTENTS];
+    int missing[RS_MAX_EXTENTS] = {0};
+    struct extent *split_extents;
+    int rows[RS_MAX_EXTENTS] = {0};
+    uint8_t *matrix = NULL;
+    size_t first_stripe;
+    size_t last_stripe;
+    int n_missing = 0;
+    size_t stripe;
+    int rc = 0;
+    int i;
+
+    ENTRY;
+
+    if (win_size == 0)
+        return 0;
+
+    split_extents = dec->layout->extents +
+        io_context->current_split * n_extents;
+
+    for (i = 0; i < k; i++) {
+        rows[i] = io_context->read.extents[i]->layout_idx % n_extents;
+        source[i] = (uint8_t *)io_context->buffers[i].buff;
+        data[i] = NULL;
+    }
+
+    for (i = 0; i < k; i++)
+        if (rows[i] < k)
+            data[rows[i]] = source[i];
+
+    for (i = 0; i < k; i++) {
+        if (data[i])
+            continue;
+
+        rebuilt[n_missing] = (uint8_t *)io_context->buffers[k + n_missing].buff;
+        data[i] = rebuilt[n_missing];
+        missing[n_missing++] = i;
+    }
+
+    if (n_missing > 0) {
+        pho_verb("rs: rebuilding %d data extent(s) of split %zu of '%s'",
+                 n_missing, io_context->current_split, dec->xfer->xd_objid);
+
+        matrix = xmalloc(n_missing * k);
+        rc = rs_decoding_matrix(k, io_context->n_parity_extents, rows,
+                                missing, n_missing, matrix);
+        if (rc)
+            goto out;
+    }
+
+    first_stripe = win_offset / (k * chunk_size);
+    last_stripe = (win_end - 1) / (k * chunk_size);
+
+    if (first_stripe > 0) {
+        pho_debug("rs: reading stripes %zu to %zu of split %zu, skipping hash "
+                  "check", first_stripe, last_stripe,
+                  io_context->current_split);
+
+        for (i = 0; i < k; i++) {
+            rc = ioa_seek(iods[i].iod_ioa, &iods[i],
+                          first_stripe * chunk_size);
+            if (rc)
+                LOG_GOTO(out, rc,
+                         "Unable to seek at stripe %zu of extent '%s'",
+                         first_stripe, io_context->read.extents[i]->uuid);
+        }
+    }
+
+    for (stripe = first_stripe; stripe <= last_stripe; stripe++) {
+        size_t stripe_size = chunk_size_in_stripe(&split_extents[0], stripe,
+                                                  chunk_size);
+        size_t offset = stripe * k * chunk_size;
+
+        /* parity chunks are as large as the first data chunk */
+        for (i = 0; i < k; i++) {
+            size_t size = stripe_size;
+
+            if (rows[i] < k)
+                size = chunk_size_in_stripe(&split_extents[rows[i]], stripe,
+                                            chunk_size);
+
+            rc = read_chunk(io_context, i, size, stripe_size, check_hash);
+            if (rc)
+                goto out;
+        }
+
+        if (n_missing > 0)
+            rs_matrix_apply(matrix, n_missing, k, source, rebuilt,
+                            stripe_size);
+
+        for (i = 0; i < k; i++) {
+            size_t size = chunk_size_in_stripe(&split_extents[i], stripe,
+                                               chunk_size);
+
+            rc = write_window(posix, data[i], offset, size, win_offset,
+                              win_end);
+            if (rc)
+                LOG_GOTO(out, rc, "Failed to write in file");
+
+            offset += size;
+        }
+    }
+
+    if (check_hash) {
+        for (i = 0; i < io_context->nb_hashes; i++) {
+            rc = extent_hash_digest(&io_context->hashes[i]);
+            if (rc)
+                goto out;
+
+            rc = extent_hash_compare(&io_context->hashes[i],
+                                     io_context->read.extents[i]);
+            if (rc)
+                goto out;
+        }
+    }
+
+out:
+    free(matrix);
+
+    return rc;
+}
+
+/**
+ * The LRS allocates any k of the k + m extents of the split, favoring the
+ * ones which are already available. Only the data chunks of the missing data
+ * extents are computed, from the k chunks read in each stripe. The extent
+ * hashes are only checked when the whole split is read.
+ */
+int rs_read_split(struct pho_encoder *dec)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    size_t win_offset;
+    size_t win_size;
+    bool full_split;
+
+    ENTRY;
+
+    full_split = raid_read_split_window(dec, &win_offset, &win_size);
+
+    return read_stripes(dec, win_offset, win_size,
+                        full_split && io_context->read.check_hash);
+}
@@ -0,0 +1,344 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Reed-Solomon Layout plugin
+ *
+ * Each split of an object is made of k data extents and m parity extents, any
+ * k of them being enough to read the split back.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rs.h"
+
+#include "pho_module_loader.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PLUGIN_NAME     "rs"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc RS_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+static struct raid_ops RS_OPS = {
+    .write_split    = rs_write_split,
+    .read_split     = rs_read_split,
+    .get_block_size = rs_get_block_size,
+};
+
+static const struct pho_enc_ops RS_ENCODER_OPS = {
+    .step       = raid_encoder_step,
+    .destroy    = raid_encoder_destroy,
+    .object_size = raid_decoder_object_size,
+};
+
+/**
+ * List of configuration parameters for this module
+ */
+enum pho_cfg_params_rs {
+    /* Actual parameters */
+    PHO_CFG_LYT_RS_k,
+    PHO_CFG_LYT_RS_m,
+    PHO_CFG_LYT_RS_extent_xxh128,
+    PHO_CFG_LYT_RS_extent_md5,
+    PHO_CFG_LYT_RS_check_hash,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_LYT_RS_FIRST = PHO_CFG_LYT_RS_k,
+    PHO_CFG_LYT_RS_LAST  = PHO_CFG_LYT_RS_check_hash,
+};
+
+const struct pho_config_item rs_cfg_items[] = {
+    [PHO_CFG_LYT_RS_k] = {
+        .section = "layout_rs",
+        .name    = RS_K_ATTR_KEY,
+        .value   = "4",  /* # of data extents per split */
+    },
+    [PHO_CFG_LYT_RS_m] = {
+        .section = "layout_rs",
+        .name    = RS_M_ATTR_KEY,
+        .value   = "2",  /* # of parity extents per split */
+    },
+    [PHO_CFG_LYT_RS_extent_xxh128] = {
+        .section = "layout_rs",
+        .name    = "extent_xxh128",
+        .value   = DEFAULT_XXH128,
+    },
+    [PHO_CFG_LYT_RS_extent_md5] = {
+        .section = "layout_rs",
+        .name    = "extent_md5",
+        .value   = DEFAULT_MD5,
+    },
+    [PHO_CFG_LYT_RS_check_hash] = {
+        .section = "layout_rs",
+        .name    = "check_hash",
+        .value   = DEFAULT_CHECK_HASH,
+    },
+};
+
+static int rs_parse_count(const char *str, const char *name,
+                          unsigned int *count)
+{
+    int64_t value;
+
+    if (str == NULL)
+        LOG_RETURN(-ENOENT, "Unable to get rs '%s' parameter", name);
+
+    value = str2int64(str);
+    if (value < 1 || value >= RS_MAX_EXTENTS)
+        LOG_RETURN(-EINVAL, "Invalid rs '%s' parameter '%s'", name, str);
+
+    *count = value;
+
+    return 0;
+}
+
+/** Retrieve the number of data and parity extents of a rs layout */
+static int rs_params(struct layout_info *layout, unsigned int *k,
+                     unsigned int *m)
+{
+    int rc;
+
+    rc = rs_parse_count(pho_attr_get(&layout->layout_desc.mod_attrs,
+                                     PHO_EA_RS_K_NAME),
+                        RS_K_ATTR_KEY, k);
+    if (rc)
+        return rc;
+
+    rc = rs_parse_count(pho_attr_get(&layout->layout_desc.mod_attrs,
+                                     PHO_EA_RS_M_NAME),
+                        RS_M_ATTR_KEY, m);
+    if (rc)
+        return rc;
+
+    if (*k + *m > RS_MAX_EXTENTS)
+        LOG_RETURN(-EINVAL,
+                   "Invalid rs parameters k=%u m=%u: at most %d extents per "
+                   "split", *k, *m, RS_MAX_EXTENTS);
+
+    return 0;
+}
+
+/**
+ * Get the k and m parameters of an encoder from the layout parameters of the
+ * PUT, or from the configuration if not given, and save them in the layout
+ * attributes.
+ */
+static int rs_encoder_params(struct pho_encoder *enc, unsigned int *k,
+                             unsigned int *m)
+{
+    struct pho_attrs *lyt_params = &enc->xfer->xd_params.put.lyt_params;
+    const char *str_k = NULL;
+    const char *str_m = NULL;
+
+    if (!pho_attrs_is_empty(lyt_params)) {
+        str_k = pho_attr_get(lyt_params, RS_K_ATTR_KEY);
+        str_m = pho_attr_get(lyt_params, RS_M_ATTR_KEY);
+    }
+
+    if (str_k == NULL)
+        str_k = PHO_CFG_GET(rs_cfg_items, PHO_CFG_LYT_RS, k);
+    if (str_m == NULL)
+        str_m = PHO_CFG_GET(rs_cfg_items, PHO_CFG_LYT_RS, m);
+
+    if (str_k == NULL || str_m == NULL)
+        LOG_RETURN(-EINVAL, "Unable to get k and m from conf to build a rs "
+                            "encoder");
+
+    pho_attr_set(&enc->layout->layout_desc.mod_attrs, PHO_EA_RS_K_NAME, str_k);
+    pho_attr_set(&enc->layout->layout_desc.mod_attrs, PHO_EA_RS_M_NAME, str_m);
+
+    return rs_params(enc->layout, k, m);
+}
+
+static int layout_rs_encode(struct pho_encoder *enc)
+{
+    struct raid_io_context *io_context;
+    unsigned int k;
+    unsigned int m;
+    int rc;
+    int i;
+
+    ENTRY;
+
+    rc = rs_encoder_params(enc, &k, &m);
+    if (rc)
+        return rc;
+
+    io_context = xcalloc(1, sizeof(*io_context));
+    enc->priv_enc = io_context;
+    io_context->name = PLUGIN_NAME;
+    io_context->n_data_extents = k;
+    io_context->n_parity_extents = m;
+    io_context->write.to_write = enc->xfer->xd_params.put.size;
+    io_context->nb_hashes = k + m;
+    io_context->hashes = xcalloc(io_context->nb_hashes,
+                                 sizeof(*io_context->hashes));
+
+    for (i = 0; i < io_context->nb_hashes; i++) {
+        rc = extent_hash_init(&io_context->hashes[i],
+                              PHO_CFG_GET_BOOL(rs_cfg_items,
+                                               PHO_CFG_LYT_RS,
+                                               extent_md5,
+                                               false),
+                              PHO_CFG_GET_BOOL(rs_cfg_items,
+                                               PHO_CFG_LYT_RS,
+                                               extent_xxh128,
+                                               false));
+        if (rc)
+            goto out_hash;
+    }
+
+    return raid_encoder_init(enc, &RS_MODULE_DESC, &RS_ENCODER_OPS, &RS_OPS);
+
+out_hash:
+    for (i -= 1; i >= 0; i--)
+        extent_hash_fini(&io_context->hashes[i]);
+    io_context->nb_hashes = 0;
+
+    /* The rest will be free'd by layout_destroy */
+    return rc;
+}
+
+static int layout_rs_decode(struct pho_encoder *dec)
+{
+    struct raid_io_context *io_context;
+    unsigned int k;
+    unsigned int m;
+    int rc;
+    int i;
+
+    ENTRY;
+
+    rc = rs_params(dec->layout, &k, &m);
+    if (rc)
+        LOG_RETURN(rc, "Invalid rs parameters from layout to build decoder");
+
+    if (dec->layout->ext_count % (k + m) != 0)
+        LOG_RETURN(-EINVAL,
+                   "rs layout extents count (%d) is not a multiple of %u",
+                   dec->layout->ext_count, k + m);
+
+    io_context = xcalloc(1, sizeof(*io_context));
+    dec->priv_enc = io_context;
+    io_context->name = PLUGIN_NAME;
+    io_context->n_data_extents = k;
+    io_context->n_parity_extents = m;
+
+    io_context->read.check_hash = PHO_CFG_GET_BOOL(rs_cfg_items,
+                                                   PHO_CFG_LYT_RS,
+                                                   check_hash, true);
+
+    if (io_context->read.check_hash) {
+        io_context->nb_hashes = io_context->n_data_extents;
+        io_context->hashes = xcalloc(io_context->nb_hashes,
+                                     sizeof(*io_context->hashes));
+    }
+
+    rc = raid_decoder_init(dec, &RS_MODULE_DESC, &RS_ENCODER_OPS, &RS_OPS);
+    if (rc)
+        return rc;
+
+    /* The first extent of a split is the largest one, and the one whose size
+     * is subtracted from to_read once the split is read.
+     */
+    for (i = 0; i < dec->layout->ext_count; i += k + m)
+        io_context->read.to_read += dec->layout->extents[i].size;
+
+    /* Empty GET does not need any IO */
+    if (io_context->read.to_read == 0)
+        dec->done = true;
+
+    return 0;
+}
+
+static int layout_rs_locate(struct dss_handle *dss, struct layout_info *layout,
+                            const char *focus_host, char **hostname,
+                            int *nb_new_lock)
+{
+    unsigned int k;
+    unsigned int m;
+    int rc;
+
+    rc = rs_params(layout, &k, &m);
+    if (rc)
+        LOG_RETURN(rc, "Invalid rs parameters from layout to locate");
+
+    return raid_locate(dss, layout, k, m, focus_host, hostname, nb_new_lock);
+}
+
+static const struct pho_layout_module_ops LAYOUT_RS_OPS = {
+    .encode = layout_rs_encode,
+    .decode = layout_rs_decode,
+    .locate = layout_rs_locate,
+    .get_specific_attrs = NULL,
+    .reconstruct = NULL,
+};
+
+/** Layout module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct layout_module *self = (struct layout_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = RS_MODULE_DESC;
+    self->ops = &LAYOUT_RS_OPS;
+
+    return 0;
+}
+
+int rs_get_block_size(struct pho_encoder *enc, size_t *block_size)
+{
+    struct raid_io_context *io_context = enc->priv_enc;
+    struct extent *extent;
+    const char *attr;
+    int64_t value;
+
+    extent = &enc->layout->extents[io_context->current_split *
+                                   n_total_extents(io_context)];
+    attr = pho_attr_get(&extent->info, PHO_EA_RS_CHUNK_SIZE_NAME);
+    if (!attr)
+        LOG_RETURN(-EINVAL, "'%s' attribute not found on extent '%s'",
+                   PHO_EA_RS_CHUNK_SIZE_NAME, extent->uuid);
+
+    value = str2int64(attr);
+    if (value <= 0)
+        LOG_RETURN(-EINVAL,
+                   "Invalid block size '%s' found in '%s' on extent '%s'. "
+                   "Expected a positive integer",
+                   attr, PHO_EA_RS_CHUNK_SIZE_NAME, extent->uuid);
+
+    *block_size = value;
+
+    return 0;
+}
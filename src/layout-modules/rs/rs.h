@@ -0,0 +1,126 @@
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Reed-Solomon layout pieces of code shared for testing purpose
+ */
+#ifndef _PHO_RS_H
+#define _PHO_RS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pho_types.h" /* struct layout_info */
+#include "raid_common.h"
+
+/**
+ * Extended attributes' names for the Reed-Solomon layout
+ */
+#define PHO_EA_RS_K_NAME          "rs.k"
+#define PHO_EA_RS_M_NAME          "rs.m"
+#define PHO_EA_RS_CHUNK_SIZE_NAME "rs.chunk_size"
+
+/**
+ * Number of data (k) and parity (m) extents parameters that come from the
+ * configuration or the CLI.
+ */
+#define RS_K_ATTR_KEY "k"
+#define RS_M_ATTR_KEY "m"
+
+/**
+ * The codes are computed in GF(2^8), whose elements identify the extents of a
+ * split: there can be at most 256 extents per split.
+ */
+#define RS_MAX_EXTENTS 256
+
+/**
+ * Implementation of raid_ops::write_split
+ */
+int rs_write_split(struct pho_encoder *enc, size_t split_size);
+
+/**
+ * Implementation of raid_ops::read_split
+ */
+int rs_read_split(struct pho_encoder *dec);
+
+/**
+ * Implementation of raid_ops::get_block_size
+ */
+int rs_get_block_size(struct pho_encoder *enc, size_t *block_size);
+
+/**
+ * Name of the region multiplication kernel selected for this CPU ("avx2",
+ * "ssse3" or "generic").
+ */
+const char *gf_kernel_name(void);
+
+/**
+ * Use the region multiplication kernel \p name instead of the one selected
+ * for this CPU, e.g. to compare their throughput.
+ *
+ * \return 0 on success, -ENOTSUP if the CPU does not support this kernel,
+ *         -EINVAL if there is no such kernel
+ */
+int gf_kernel_select(const char *name);
+
+/** Product of \p a and \p b in GF(2^8) */
+uint8_t gf_mul(uint8_t a, uint8_t b);
+
+/**
+ * Multiply the \p len bytes of \p src by \p c in GF(2^8) and add (xor) the
+ * result to \p dst.
+ */
+void gf_vect_mul_add(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len);
+
+/**
+ * Build the m x k parity part of the systematic encoding matrix: the extent
+ * k + i of a split is the product of row i of \p matrix by the k data
+ * extents. Any k rows of the full (k + m) x k matrix, whose first k rows are
+ * the identity, form an invertible matrix.
+ *
+ * \param[in]   k       Number of data extents
+ * \param[in]   m       Number of parity extents
+ * \param[out]  matrix  m * k coefficients, row by row
+ */
+void rs_encoding_matrix(int k, int m, uint8_t *matrix);
+
+/**
+ * Build the matrix rebuilding the missing data extents from the k available
+ * extents of a split.
+ *
+ * \param[in]   k           Number of data extents
+ * \param[in]   m           Number of parity extents
+ * \param[in]   rows        Index in the split of the k available extents
+ * \param[in]   missing     Index of the n_missing data extents to rebuild
+ * \param[in]   n_missing   Number of data extents to rebuild
+ * \param[out]  matrix      n_missing * k coefficients, row by row
+ *
+ * \return 0 on success, -EINVAL if the available extents cannot rebuild the
+ *         data (i.e. if an extent index is given twice)
+ */
+int rs_decoding_matrix(int k, int m, const int *rows, const int *missing,
+                       int n_missing, uint8_t *matrix);
+
+/**
+ * Compute out[i] = sum(matrix[i][j] * in[j]) over \p len bytes, for i in
+ * [0, n_out[ and j in [0, n_in[.
+ */
+void rs_matrix_apply(const uint8_t *matrix, int n_out, int n_in,
+                     uint8_t **in, uint8_t **out, size_t len);
+
+#endif
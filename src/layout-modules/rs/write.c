@@ -0,0 +1,182 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Reed-Solomon Layout plugin
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rs.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static int set_rs_md(struct raid_io_context *io_context, size_t chunk_size)
+{
+    struct extent *extents = io_context->write.extents;
+    struct pho_io_descr *iods = io_context->iods;
+    char buff[64];
+    size_t i;
+    int rc;
+
+    rc = snprintf(buff, sizeof(buff), "%zu", chunk_size);
+    if (rc < 0)
+        LOG_RETURN(rc = -errno, "Unable to convert chunk size to string");
+
+    for (i = 0; i < n_total_extents(io_context); i++) {
+        pho_attr_set(&extents[i].info, PHO_EA_RS_CHUNK_SIZE_NAME, buff);
+        pho_attr_set(&iods[i].iod_attrs, PHO_EA_RS_CHUNK_SIZE_NAME, buff);
+    }
+
+    return 0;
+}
+
+static int write_chunk(struct raid_io_context *io_context, int i, size_t size)
+{
+    struct pho_io_descr *iod = &io_context->iods[i];
+    int rc;
+
+    if (size == 0)
+        return 0;
+
+    rc = ioa_write(iod->iod_ioa, iod, io_context->buffers[i].buff, size);
+    if (rc)
+        LOG_RETURN(rc, "Unable to write %zu bytes in rs write", size);
+
+    rc = extent_hash_update(&io_context->hashes[i],
+                            io_context->buffers[i].buff, size);
+    if (rc)
+        return rc;
+
+    iod->iod_size += size;
+
+    return 0;
+}
+
+/**
+ * Each stripe of a split is made of one chunk per extent. All the stripes are
+ * full except the last one, whose data is evenly split across the k data
+ * extents so that no extent exceeds the size allocated by the LRS. The data
+ * chunks of the last stripe are padded with zeroes to compute the parity
+ * chunks, which are as large as the first data chunk.
+ */
+int rs_write_split(struct pho_encoder *enc, size_t split_size)
+{
+    struct raid_io_context *io_context = enc->priv_enc;
+    size_t chunk_size = io_context->buffers[0].size;
+    struct pho_io_descr *posix = &io_context->posix;
+    int k = io_context->n_data_extents;
+    int m = io_context->n_parity_extents;
+    uint8_t *data[RS_MAX_EXTENTS];
+    uint8_t *parity[RS_MAX_EXTENTS];
+    size_t sizes[RS_MAX_EXTENTS];
+    size_t left_to_read;
+    uint8_t *matrix;
+    bool eof = false;
+    int rc;
+    int i;
+
+    ENTRY;
+
+    left_to_read = min(split_size * k, io_context->write.to_write);
+
+    rc = set_rs_md(io_context, chunk_size);
+    if (rc)
+        return rc;
+
+    matrix = xmalloc(m * k);
+    rs_encoding_matrix(k, m, matrix);
+
+    for (i = 0; i < k; i++)
+        data[i] = (uint8_t *)io_context->buffers[i].buff;
+    for (i = 0; i < m; i++)
+        parity[i] = (uint8_t *)io_context->buffers[k + i].buff;
+
+    while (!eof && left_to_read > 0) {
+        size_t stripe_size = chunk_size;
+        size_t stripe_read = 0;
+
+        if (left_to_read < k * chunk_size)
+            stripe_size = (left_to_read + k - 1) / k;
+
+        for (i = 0; i < k; i++) {
+            size_t request = 0;
+            ssize_t bytes_read = 0;
+
+            if (!eof && stripe_read < left_to_read)
+                request = min(stripe_size, left_to_read - stripe_read);
+
+            if (request > 0) {
+                bytes_read = ioa_read(posix->iod_ioa, posix, data[i], request);
+                if (bytes_read < 0)
+                    LOG_GOTO(out, rc = bytes_read,
+                             "Unable to read %zu bytes in rs write", request);
+            }
+
+            /* a short read marks the end of a compressed stream */
+            if ((size_t)bytes_read < request)
+                eof = true;
+
+            sizes[i] = bytes_read;
+            stripe_read += bytes_read;
+            memset(data[i] + bytes_read, 0, stripe_size - bytes_read);
+        }
+
+        if (stripe_read == 0)
+            break;
+
+        left_to_read -= stripe_read;
+
+        rs_matrix_apply(matrix, m, k, data, parity, sizes[0]);
+
+        for (i = 0; i < k; i++) {
+            rc = write_chunk(io_context, i, sizes[i]);
+            if (rc)
+                goto out;
+        }
+
+        for (i = 0; i < m; i++) {
+            rc = write_chunk(io_context, k + i, sizes[0]);
+            if (rc)
+                goto out;
+        }
+    }
+
+    for (i = 0; i < io_context->nb_hashes; i++) {
+        rc = extent_hash_digest(&io_context->hashes[i]);
+        if (rc)
+            goto out;
+
+        rc = extent_hash_copy(&io_context->hashes[i],
+                              &io_context->write.extents[i]);
+        if (rc)
+            goto out;
+    }
+
+out:
+    free(matrix);
+
+    return rc;
+}
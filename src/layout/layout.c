@@ -209,6 +209,35 @@ int layout_reconstruct(struct layout_info lyt, struct object_info *obj)
     return mod->ops->reconstruct(lyt, obj);
 }
 
+int layout_pack(struct pho_encoder *enc, struct pho_encoder *member)
+{
+    char layout_name[NAME_MAX];
+    struct layout_module *mod;
+    int rc;
+
+    if (enc->is_decoder || member->is_decoder || enc->done || member->done)
+        return -EINVAL;
+
+    if (strcmp(enc->layout->layout_desc.mod_name,
+               member->layout->layout_desc.mod_name))
+        return -ENOTSUP;
+
+    rc = build_layout_name(enc->layout->layout_desc.mod_name, layout_name,
+                           sizeof(layout_name));
+    if (rc)
+        return rc;
+
+    rc = load_module(layout_name, sizeof(*mod), phobos_context(),
+                     (void **) &mod);
+    if (rc)
+        return rc;
+
+    if (!mod->ops->pack)
+        return -ENOTSUP;
+
+    return mod->ops->pack(enc, member);
+}
+
 void layout_destroy(struct pho_encoder *enc)
 {
     /* Only encoders own their layout */
@@ -0,0 +1,699 @@
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Streaming compression stage of the RAID layouts
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_io.h"
+#include "raid_codec.h"
+
+/** Size of the buffers used to feed and drain the codec */
+#define CODEC_CHUNK_SIZE (128 * 1024)
+
+/**
+ * List of configuration parameters for the compression stage
+ */
+enum pho_cfg_params_compression {
+    /* Actual parameters */
+    PHO_CFG_COMPRESSION_workers,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_COMPRESSION_FIRST = PHO_CFG_COMPRESSION_workers,
+    PHO_CFG_COMPRESSION_LAST  = PHO_CFG_COMPRESSION_workers,
+};
+
+const struct pho_config_item cfg_compression[] = {
+    [PHO_CFG_COMPRESSION_workers] = {
+        .section = "compression",
+        .name    = "workers",
+        .value   = "2",
+    },
+};
+
+static const char * const codec_names[] = {
+    [PHO_CODEC_NONE] = "none",
+    [PHO_CODEC_ZSTD] = "zstd",
+    [PHO_CODEC_LZ4]  = "lz4",
+};
+
+const char *codec2str(enum pho_codec codec)
+{
+    if (codec < PHO_CODEC_NONE || codec >= PHO_CODEC_LAST)
+        return NULL;
+
+    return codec_names[codec];
+}
+
+enum pho_codec str2codec(const char *str)
+{
+    int i;
+
+    for (i = PHO_CODEC_NONE; i < PHO_CODEC_LAST; i++)
+        if (!strcmp(str, codec_names[i]))
+            return i;
+
+    return PHO_CODEC_INVAL;
+}
+
+static bool codec_is_supported(enum pho_codec codec)
+{
+    switch (codec) {
+    case PHO_CODEC_NONE:
+        return true;
+#ifdef HAVE_ZSTD
+    case PHO_CODEC_ZSTD:
+        return true;
+#endif
+#ifdef HAVE_LZ4
+    case PHO_CODEC_LZ4:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+int codec_parse(const char *spec, enum pho_codec *codec, int *level)
+{
+    const char *sep;
+    char *name;
+
+    *codec = PHO_CODEC_NONE;
+    *level = 0;
+
+    if (spec == NULL || *spec == '\0')
+        return 0;
+
+    sep = strchr(spec, ':');
+    name = sep ? xstrndup(spec, sep - spec) : xstrdup(spec);
+    *codec = str2codec(name);
+    free(name);
+
+    if (*codec == PHO_CODEC_INVAL)
+        LOG_RETURN(-EINVAL, "Unknown compression codec in '%s'", spec);
+
+    if (!codec_is_supported(*codec))
+        LOG_RETURN(-ENOTSUP, "Compression codec '%s' is not supported by "
+                             "this build of phobos", codec2str(*codec));
+
+    if (sep) {
+        int64_t value = str2int64(sep + 1);
+
+        if (value < 0 || value > INT_MAX)
+            LOG_RETURN(-EINVAL, "Invalid compression level in '%s'", spec);
+
+        *level = value;
+    }
+
+    return 0;
+}
+
+size_t codec_bound(enum pho_codec codec, size_t raw_size)
+{
+    switch (codec) {
+#ifdef HAVE_ZSTD
+    case PHO_CODEC_ZSTD:
+        return ZSTD_compressBound(raw_size);
+#endif
+#ifdef HAVE_LZ4
+    case PHO_CODEC_LZ4:
+        /* the stream is compressed chunk by chunk, each update may flush a
+         * partial block
+         */
+        return LZ4F_compressFrameBound(raw_size, NULL) + LZ4F_HEADER_SIZE_MAX +
+            (raw_size / CODEC_CHUNK_SIZE + 1) *
+            LZ4F_compressBound(0, NULL);
+#endif
+    default:
+        return raw_size;
+    }
+}
+
+struct codec_ctx {
+    enum pho_codec codec;
+    /** true if compressing on read, false if decompressing on write */
+    bool compress;
+    /** Wrapped I/O descriptor */
+    struct pho_io_descr inner;
+
+    char *in_buf;
+    size_t in_pos;
+    size_t in_len;
+    char *out_buf;
+    size_t out_size;
+    size_t out_pos;
+    size_t out_len;
+
+    /** Compression: number of uncompressed bytes left to read */
+    size_t raw_left;
+    /** Compression: all the uncompressed data has been read */
+    bool input_eof;
+    /** The end of the compressed stream has been produced or decoded */
+    bool stream_end;
+
+    /** Decompression: number of uncompressed bytes produced so far */
+    size_t raw_pos;
+    /** Decompression: range of uncompressed bytes written to inner */
+    size_t range_start;
+    size_t range_end;
+
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *zcctx;
+    ZSTD_DCtx *zdctx;
+#endif
+#ifdef HAVE_LZ4
+    LZ4F_cctx *lcctx;
+    LZ4F_dctx *ldctx;
+#endif
+};
+
+static void codec_ctx_free(struct codec_ctx *ctx)
+{
+#ifdef HAVE_ZSTD
+    ZSTD_freeCCtx(ctx->zcctx);
+    ZSTD_freeDCtx(ctx->zdctx);
+#endif
+#ifdef HAVE_LZ4
+    if (ctx->lcctx)
+        LZ4F_freeCompressionContext(ctx->lcctx);
+    if (ctx->ldctx)
+        LZ4F_freeDecompressionContext(ctx->ldctx);
+#endif
+    free(ctx->in_buf);
+    free(ctx->out_buf);
+    free(ctx);
+}
+
+/** Read the next chunk of uncompressed data from the wrapped descriptor */
+static int codec_fill_input(struct codec_ctx *ctx)
+{
+    size_t count = min(ctx->raw_left, (size_t) CODEC_CHUNK_SIZE);
+    ssize_t read_size;
+
+    ctx->in_pos = 0;
+    ctx->in_len = 0;
+
+    if (count > 0) {
+        read_size = ioa_read(ctx->inner.iod_ioa, &ctx->inner, ctx->in_buf,
+                             count);
+        if (read_size < 0)
+            LOG_RETURN(read_size, "Unable to read data to compress");
+
+        ctx->in_len = read_size;
+        ctx->raw_left -= read_size;
+        if (read_size < count)
+            /* short read: no more data in the source */
+            ctx->raw_left = 0;
+    }
+
+    if (ctx->raw_left == 0)
+        ctx->input_eof = true;
+
+    return 0;
+}
+
+#if defined(HAVE_ZSTD) || defined(HAVE_LZ4)
+/**
+ * Write the part of the \p len decompressed bytes in the output buffer that
+ * falls in the requested range.
+ */
+static int codec_emit(struct codec_ctx *ctx, size_t len)
+{
+    size_t start = max(ctx->raw_pos, ctx->range_start);
+    size_t end = min(ctx->raw_pos + len, ctx->range_end);
+    int rc = 0;
+
+    if (end > start)
+        rc = ioa_write(ctx->inner.iod_ioa, &ctx->inner,
+                       ctx->out_buf + (start - ctx->raw_pos), end - start);
+
+    ctx->raw_pos += len;
+
+    return rc;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static int zstd_compress_step(struct codec_ctx *ctx)
+{
+    ZSTD_inBuffer in = { ctx->in_buf, ctx->in_len, ctx->in_pos };
+    ZSTD_outBuffer out = { ctx->out_buf, ctx->out_size, 0 };
+    size_t remaining;
+
+    remaining = ZSTD_compressStream2(ctx->zcctx, &out, &in,
+                                     ctx->input_eof ? ZSTD_e_end :
+                                                      ZSTD_e_continue);
+    if (ZSTD_isError(remaining))
+        LOG_RETURN(-EIO, "zstd compression failed: %s",
+                   ZSTD_getErrorName(remaining));
+
+    ctx->in_pos = in.pos;
+    ctx->out_len = out.pos;
+    if (ctx->input_eof && in.pos == in.size && remaining == 0)
+        ctx->stream_end = true;
+
+    return 0;
+}
+
+static int zstd_decompress(struct codec_ctx *ctx, const void *buf,
+                           size_t count)
+{
+    ZSTD_inBuffer in = { buf, count, 0 };
+    ZSTD_outBuffer out;
+    size_t ret;
+    int rc;
+
+    do {
+        out = (ZSTD_outBuffer) { ctx->out_buf, ctx->out_size, 0 };
+        ret = ZSTD_decompressStream(ctx->zdctx, &out, &in);
+        if (ZSTD_isError(ret))
+            LOG_RETURN(-EIO, "zstd decompression failed: %s",
+                       ZSTD_getErrorName(ret));
+
+        if (ret == 0)
+            ctx->stream_end = true;
+
+        rc = codec_emit(ctx, out.pos);
+        if (rc)
+            return rc;
+    } while (in.pos < in.size || out.pos == out.size);
+
+    return 0;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static int lz4_compress_step(struct codec_ctx *ctx)
+{
+    size_t ret;
+
+    if (ctx->in_pos < ctx->in_len) {
+        ret = LZ4F_compressUpdate(ctx->lcctx, ctx->out_buf, ctx->out_size,
+                                  ctx->in_buf + ctx->in_pos,
+                                  ctx->in_len - ctx->in_pos, NULL);
+        ctx->in_pos = ctx->in_len;
+    } else if (ctx->input_eof) {
+        ret = LZ4F_compressEnd(ctx->lcctx, ctx->out_buf, ctx->out_size, NULL);
+        ctx->stream_end = true;
+    } else {
+        ret = 0;
+    }
+
+    if (LZ4F_isError(ret))
+        LOG_RETURN(-EIO, "lz4 compression failed: %s",
+                   LZ4F_getErrorName(ret));
+
+    ctx->out_len = ret;
+
+    return 0;
+}
+
+static int lz4_decompress(struct codec_ctx *ctx, const void *buf,
+                          size_t count)
+{
+    const char *src = buf;
+    size_t left = count;
+    size_t dst_size;
+    size_t ret;
+    int rc;
+
+    do {
+        size_t src_size = left;
+
+        dst_size = ctx->out_size;
+        ret = LZ4F_decompress(ctx->ldctx, ctx->out_buf, &dst_size, src,
+                              &src_size, NULL);
+        if (LZ4F_isError(ret))
+            LOG_RETURN(-EIO, "lz4 decompression failed: %s",
+                       LZ4F_getErrorName(ret));
+
+        if (ret == 0)
+            ctx->stream_end = true;
+
+        src += src_size;
+        left -= src_size;
+
+        rc = codec_emit(ctx, dst_size);
+        if (rc)
+            return rc;
+    } while (left > 0 || dst_size == ctx->out_size);
+
+    return 0;
+}
+#endif
+
+/** Produce the next chunk of compressed data in the output buffer */
+static int codec_compress_step(struct codec_ctx *ctx)
+{
+    int rc;
+
+    ctx->out_pos = 0;
+    ctx->out_len = 0;
+
+    if (ctx->in_pos == ctx->in_len && !ctx->input_eof) {
+        rc = codec_fill_input(ctx);
+        if (rc)
+            return rc;
+    }
+
+    switch (ctx->codec) {
+#ifdef HAVE_ZSTD
+    case PHO_CODEC_ZSTD:
+        return zstd_compress_step(ctx);
+#endif
+#ifdef HAVE_LZ4
+    case PHO_CODEC_LZ4:
+        return lz4_compress_step(ctx);
+#endif
+    default:
+        return -ENOTSUP;
+    }
+}
+
+/**
+ * Return up to \p count bytes of the compressed stream. As for the POSIX
+ * adapter, a short read means that the end of the stream is reached.
+ */
+static ssize_t codec_read(struct pho_io_descr *iod, void *buf, size_t count)
+{
+    struct codec_ctx *ctx = iod->iod_ctx;
+    size_t done = 0;
+    int rc;
+
+    if (!ctx->compress)
+        return -EINVAL;
+
+    while (done < count) {
+        size_t len;
+
+        if (ctx->out_pos == ctx->out_len) {
+            if (ctx->stream_end)
+                break;
+
+            rc = codec_compress_step(ctx);
+            if (rc)
+                return rc;
+
+            continue;
+        }
+
+        len = min(count - done, ctx->out_len - ctx->out_pos);
+        memcpy((char *)buf + done, ctx->out_buf + ctx->out_pos, len);
+        ctx->out_pos += len;
+        done += len;
+    }
+
+    return done;
+}
+
+static int codec_write(struct pho_io_descr *iod, const void *buf,
+                       size_t count)
+{
+    struct codec_ctx *ctx = iod->iod_ctx;
+
+    if (ctx->compress)
+        return -EINVAL;
+
+    if (count == 0)
+        return 0;
+
+    if (ctx->stream_end)
+        LOG_RETURN(-EIO, "Unexpected data after the end of the compressed "
+                         "stream");
+
+    switch (ctx->codec) {
+#ifdef HAVE_ZSTD
+    case PHO_CODEC_ZSTD:
+        return zstd_decompress(ctx, buf, count);
+#endif
+#ifdef HAVE_LZ4
+    case PHO_CODEC_LZ4:
+        return lz4_decompress(ctx, buf, count);
+#endif
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static ssize_t codec_preferred_io_size(struct pho_io_descr *iod)
+{
+    struct codec_ctx *ctx = iod->iod_ctx;
+
+    return ioa_preferred_io_size(ctx->inner.iod_ioa, &ctx->inner);
+}
+
+static int codec_close(struct pho_io_descr *iod)
+{
+    struct codec_ctx *ctx = iod->iod_ctx;
+    int rc;
+
+    if (!ctx)
+        return 0;
+
+    rc = ioa_close(ctx->inner.iod_ioa, &ctx->inner);
+    codec_ctx_free(ctx);
+    iod->iod_ctx = NULL;
+
+    return rc;
+}
+
+static const struct pho_io_adapter_module_ops IO_ADAPTER_CODEC_OPS = {
+    .ioa_write             = codec_write,
+    .ioa_read              = codec_read,
+    .ioa_close             = codec_close,
+    .ioa_preferred_io_size = codec_preferred_io_size,
+};
+
+static struct io_adapter_module IO_ADAPTER_CODEC = {
+    .desc = {
+        .mod_name  = "codec",
+        .mod_major = 0,
+        .mod_minor = 1,
+    },
+    .ops = &IO_ADAPTER_CODEC_OPS,
+};
+
+static void codec_wrap(struct pho_io_descr *iod, struct codec_ctx *ctx)
+{
+    ctx->inner = *iod;
+    iod->iod_ioa = &IO_ADAPTER_CODEC;
+    iod->iod_ctx = ctx;
+}
+
+#ifdef HAVE_ZSTD
+static int zstd_compress_init(struct codec_ctx *ctx, int level,
+                              size_t raw_size)
+{
+    int workers;
+    size_t ret;
+
+    ctx->zcctx = ZSTD_createCCtx();
+    if (!ctx->zcctx)
+        LOG_RETURN(-ENOMEM, "Unable to create zstd compression context");
+
+    if (level != 0) {
+        ret = ZSTD_CCtx_setParameter(ctx->zcctx, ZSTD_c_compressionLevel,
+                                     level);
+        if (ZSTD_isError(ret))
+            LOG_RETURN(-EINVAL, "Invalid zstd compression level %d: %s",
+                       level, ZSTD_getErrorName(ret));
+    }
+
+    workers = PHO_CFG_GET_INT(cfg_compression, PHO_CFG_COMPRESSION, workers,
+                              0);
+    if (workers > 0) {
+        ret = ZSTD_CCtx_setParameter(ctx->zcctx, ZSTD_c_nbWorkers, workers);
+        if (ZSTD_isError(ret))
+            pho_warn("Unable to use %d zstd workers, compressing in the "
+                     "calling thread: %s", workers, ZSTD_getErrorName(ret));
+    }
+
+    ret = ZSTD_CCtx_setPledgedSrcSize(ctx->zcctx, raw_size);
+    if (ZSTD_isError(ret))
+        LOG_RETURN(-EINVAL, "Unable to set zstd source size: %s",
+                   ZSTD_getErrorName(ret));
+
+    ctx->out_size = ZSTD_CStreamOutSize();
+
+    return 0;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static int lz4_compress_init(struct codec_ctx *ctx, int level,
+                             size_t raw_size)
+{
+    LZ4F_preferences_t prefs;
+    size_t ret;
+
+    ret = LZ4F_createCompressionContext(&ctx->lcctx, LZ4F_VERSION);
+    if (LZ4F_isError(ret))
+        LOG_RETURN(-ENOMEM, "Unable to create lz4 compression context: %s",
+                   LZ4F_getErrorName(ret));
+
+    memset(&prefs, 0, sizeof(prefs));
+    prefs.compressionLevel = level;
+    prefs.frameInfo.contentSize = raw_size;
+
+    ctx->out_size = max(LZ4F_compressBound(CODEC_CHUNK_SIZE, &prefs),
+                        (size_t) LZ4F_HEADER_SIZE_MAX);
+    ctx->out_buf = xmalloc(ctx->out_size);
+
+    /* the frame header is the first chunk of the compressed stream */
+    ret = LZ4F_compressBegin(ctx->lcctx, ctx->out_buf, ctx->out_size, &prefs);
+    if (LZ4F_isError(ret))
+        LOG_RETURN(-EIO, "Unable to start lz4 frame: %s",
+                   LZ4F_getErrorName(ret));
+
+    ctx->out_len = ret;
+
+    return 0;
+}
+#endif
+
+int codec_wrap_compress(struct pho_io_descr *iod, enum pho_codec codec,
+                        int level, size_t raw_size)
+{
+    struct codec_ctx *ctx;
+    int rc;
+
+    ctx = xcalloc(1, sizeof(*ctx));
+    ctx->codec = codec;
+    ctx->compress = true;
+    ctx->raw_left = raw_size;
+    ctx->in_buf = xmalloc(CODEC_CHUNK_SIZE);
+
+    switch (codec) {
+#ifdef HAVE_ZSTD
+    case PHO_CODEC_ZSTD:
+        rc = zstd_compress_init(ctx, level, raw_size);
+        break;
+#endif
+#ifdef HAVE_LZ4
+    case PHO_CODEC_LZ4:
+        rc = lz4_compress_init(ctx, level, raw_size);
+        break;
+#endif
+    default:
+        rc = -ENOTSUP;
+    }
+
+    if (rc) {
+        codec_ctx_free(ctx);
+        return rc;
+    }
+
+    if (!ctx->out_buf)
+        ctx->out_buf = xmalloc(ctx->out_size);
+
+    codec_wrap(iod, ctx);
+    pho_debug("Compressing %zu bytes with %s (level %d)", raw_size,
+              codec2str(codec), level);
+
+    return 0;
+}
+
+int codec_wrap_decompress(struct pho_io_descr *iod, enum pho_codec codec,
+                          size_t range_start, size_t range_end)
+{
+    struct codec_ctx *ctx;
+    int rc = 0;
+
+    ctx = xcalloc(1, sizeof(*ctx));
+    ctx->codec = codec;
+    ctx->compress = false;
+    ctx->range_start = range_start;
+    ctx->range_end = range_end;
+    ctx->out_size = CODEC_CHUNK_SIZE;
+    ctx->out_buf = xmalloc(ctx->out_size);
+
+    switch (codec) {
+#ifdef HAVE_ZSTD
+    case PHO_CODEC_ZSTD:
+        ctx->zdctx = ZSTD_createDCtx();
+        if (!ctx->zdctx)
+            rc = -ENOMEM;
+        break;
+#endif
+#ifdef HAVE_LZ4
+    case PHO_CODEC_LZ4:
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx->ldctx,
+                                                         LZ4F_VERSION)))
+            rc = -ENOMEM;
+        break;
+#endif
+    default:
+        rc = -ENOTSUP;
+    }
+
+    if (rc) {
+        codec_ctx_free(ctx);
+        LOG_RETURN(rc, "Unable to create %s decompression context",
+                   codec2str(codec));
+    }
+
+    codec_wrap(iod, ctx);
+
+    return 0;
+}
+
+bool codec_eof(struct pho_io_descr *iod)
+{
+    struct codec_ctx *ctx = iod->iod_ctx;
+
+    if (iod->iod_ioa != &IO_ADAPTER_CODEC)
+        return false;
+
+    return ctx->stream_end && ctx->out_pos == ctx->out_len;
+}
+
+int codec_check_end(struct pho_io_descr *iod, size_t raw_size)
+{
+    struct codec_ctx *ctx = iod->iod_ctx;
+
+    if (iod->iod_ioa != &IO_ADAPTER_CODEC)
+        return 0;
+
+    if (!ctx->stream_end)
+        LOG_RETURN(-EIO, "Truncated %s compressed stream",
+                   codec2str(ctx->codec));
+
+    if (ctx->raw_pos != raw_size)
+        LOG_RETURN(-EIO, "Decompressed %zu bytes, expected %zu",
+                   ctx->raw_pos, raw_size);
+
+    return 0;
+}
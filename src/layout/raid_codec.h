@@ -0,0 +1,105 @@
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Streaming compression stage of the RAID layouts
+ *
+ * The codec stage is inserted between the Xfer's file descriptor and the RAID
+ * encoder or decoder by wrapping the POSIX I/O descriptor of the layout:
+ * - when encoding, ioa_read returns the compressed stream of the data read
+ *   from the file descriptor;
+ * - when decoding, ioa_write decompresses the data it is given and writes
+ *   the result to the file descriptor.
+ */
+#ifndef RAID_CODEC_H
+#define RAID_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pho_io.h"
+
+/** Layout attribute storing the name of the codec of a compressed object */
+#define PHO_EA_COMPRESSION_CODEC_NAME    "compression.codec"
+/** Layout attribute storing the uncompressed size of a compressed object */
+#define PHO_EA_COMPRESSION_RAW_SIZE_NAME "compression.raw_size"
+
+enum pho_codec {
+    PHO_CODEC_INVAL = -1,
+    PHO_CODEC_NONE  = 0,
+    PHO_CODEC_ZSTD,
+    PHO_CODEC_LZ4,
+    PHO_CODEC_LAST,
+};
+
+const char *codec2str(enum pho_codec codec);
+
+enum pho_codec str2codec(const char *str);
+
+/**
+ * Parse a compression specification of the form "<codec>[:<level>]", as given
+ * in the PUT parameters or in an alias.
+ *
+ * \param[in]   spec    Compression specification, NULL means no compression
+ * \param[out]  codec   Codec to use
+ * \param[out]  level   Compression level, 0 selects the codec default
+ *
+ * \return 0 on success, -EINVAL if the specification cannot be parsed and
+ *         -ENOTSUP if the codec is not supported by this build
+ */
+int codec_parse(const char *spec, enum pho_codec *codec, int *level);
+
+/**
+ * Upper bound of the compressed size of \p raw_size bytes of data.
+ */
+size_t codec_bound(enum pho_codec codec, size_t raw_size);
+
+/**
+ * Insert a compression stage on top of \p iod: subsequent ioa_read calls on
+ * \p iod return the compressed stream of the first \p raw_size bytes read from
+ * the original descriptor.
+ *
+ * The original descriptor is closed by ioa_close.
+ */
+int codec_wrap_compress(struct pho_io_descr *iod, enum pho_codec codec,
+                        int level, size_t raw_size);
+
+/**
+ * Insert a decompression stage on top of \p iod: subsequent ioa_write calls on
+ * \p iod decompress the given data and write the bytes in
+ * [range_start, range_end[ of the decompressed stream to the original
+ * descriptor.
+ *
+ * The original descriptor is closed by ioa_close.
+ */
+int codec_wrap_decompress(struct pho_io_descr *iod, enum pho_codec codec,
+                          size_t range_start, size_t range_end);
+
+/** Whether the whole compressed stream has been produced by \p iod */
+bool codec_eof(struct pho_io_descr *iod);
+
+/**
+ * Check that the decompression stage of \p iod reached the end of the
+ * compressed stream and produced \p raw_size bytes.
+ *
+ * \return 0 on success, -EIO if the stream is truncated or does not match
+ *         the expected size
+ */
+int codec_check_end(struct pho_io_descr *iod, size_t raw_size);
+
+#endif
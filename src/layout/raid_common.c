@@ -90,6 +90,47 @@ static void close_posix_iod(struct pho_encoder *enc)
         ioa_close(io_context->posix.iod_ioa, &io_context->posix);
 }
 
+/**
+ * Insert the compression stage requested by the PUT parameters, if any, and
+ * record the codec and the uncompressed size of the object in the layout
+ * attributes.
+ *
+ * The compressed size is not known before the end of the stream, so the
+ * encoder writes up to the upper bound of the compressed size and stops at the
+ * end of the compressed stream.
+ */
+static int raid_encoder_init_codec(struct pho_encoder *enc)
+{
+    struct raid_io_context *io_context = enc->priv_enc;
+    size_t raw_size = enc->xfer->xd_params.put.size;
+    char str_buffer[32];
+    int level;
+    int rc;
+
+    rc = codec_parse(enc->xfer->xd_params.put.compression, &io_context->codec,
+                     &level);
+    if (rc || io_context->codec == PHO_CODEC_NONE)
+        return rc;
+
+    rc = codec_wrap_compress(&io_context->posix, io_context->codec, level,
+                             raw_size);
+    if (rc)
+        LOG_RETURN(rc, "Unable to set up %s compression of '%s'",
+                   codec2str(io_context->codec), enc->xfer->xd_objid);
+
+    io_context->raw_size = raw_size;
+    io_context->write.to_write = codec_bound(io_context->codec, raw_size);
+    enc->layout->wr_size = io_context->write.to_write;
+
+    pho_attr_set(&enc->layout->layout_desc.mod_attrs,
+                 PHO_EA_COMPRESSION_CODEC_NAME, codec2str(io_context->codec));
+    sprintf(str_buffer, "%zu", raw_size);
+    pho_attr_set(&enc->layout->layout_desc.mod_attrs,
+                 PHO_EA_COMPRESSION_RAW_SIZE_NAME, str_buffer);
+
+    return 0;
+}
+
 int raid_encoder_init(struct pho_encoder *enc,
                       const struct module_desc *module,
                       const struct pho_enc_ops *enc_ops,
@@ -134,6 +175,10 @@ int raid_encoder_init(struct pho_encoder *enc,
         /* io_context is free'd by layout_destroy */
         return rc;
 
+    rc = raid_encoder_init_codec(enc);
+    if (rc)
+        return rc;
+
     io_context->write.written_extents = g_array_new(FALSE, TRUE,
                                                     sizeof(struct extent));
     g_array_set_clear_func(io_context->write.written_extents,
@@ -187,6 +232,202 @@ void raid_encoder_destroy(struct pho_encoder *enc)
     enc->priv_enc = NULL;
 }
 
+/** Size of the object data stored in split \p split */
+static size_t split_data_size(struct pho_encoder *dec, size_t split)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    size_t n_extents = n_total_extents(io_context);
+    struct extent *extents;
+    size_t size = 0;
+    size_t i;
+
+    extents = dec->layout->extents + split * n_extents;
+    for (i = 0; i < io_context->n_data_extents; i++)
+        size += extents[i].size;
+
+    return size;
+}
+
+/** Object offset of the first byte stored in split \p split */
+static size_t split_object_offset(struct pho_encoder *dec, size_t split)
+{
+    size_t offset = 0;
+    size_t i;
+
+    for (i = 0; i < split; i++)
+        offset += split_data_size(dec, i);
+
+    return offset;
+}
+
+/**
+ * Restrict the decoder to the byte range requested in the GET parameters, if
+ * any: the decoder starts at the first split containing the range and only the
+ * needed part of each split is written to the output file.
+ *
+ * The data of a packed object is always read as a range of the extents.
+ */
+static int raid_decoder_set_range(struct pho_encoder *dec)
+{
+    struct pho_xfer_get_params *get = &dec->xfer->xd_params.get;
+    struct raid_io_context *io_context = dec->priv_enc;
+    size_t n_extents = n_total_extents(io_context);
+    size_t n_splits = dec->layout->ext_count / n_extents;
+    size_t split_start = 0;
+    size_t object_start = 0;
+    size_t object_size;
+    size_t i;
+
+    if (io_context->codec != PHO_CODEC_NONE)
+        /* the range is extracted by the decompression stage */
+        return 0;
+
+    if (!io_context->read.packed && get->offset == 0 && get->size == 0)
+        return 0;
+
+    if (io_context->read.packed) {
+        object_start = io_context->read.packed_offset;
+        object_size = io_context->read.packed_size;
+        if (object_start + object_size > split_object_offset(dec, n_splits))
+            LOG_RETURN(-EINVAL,
+                       "Packed object '%s' ends beyond its extents",
+                       dec->xfer->xd_objid);
+    } else {
+        object_size = split_object_offset(dec, n_splits);
+    }
+
+    if (get->offset > object_size)
+        LOG_RETURN(-ERANGE,
+                   "Range offset %zu is beyond the end of object '%s' "
+                   "(%zu bytes)",
+                   get->offset, dec->xfer->xd_objid, object_size);
+
+    io_context->read.ranged = true;
+    io_context->read.range_start = object_start + get->offset;
+    if (get->size == 0 || get->size > object_size - get->offset)
+        io_context->read.range_end = object_start + object_size;
+    else
+        io_context->read.range_end = object_start + get->offset + get->size;
+
+    if (io_context->read.range_start == io_context->read.range_end) {
+        pho_debug("Empty range requested on '%s'", dec->xfer->xd_objid);
+        dec->done = true;
+        return 0;
+    }
+
+    for (i = 0; i < n_splits; i++) {
+        size_t split_end = split_start + split_data_size(dec, i);
+
+        if (split_end > io_context->read.range_start)
+            break;
+
+        split_start = split_end;
+    }
+
+    io_context->current_split = i;
+    pho_debug("Reading range [%zu, %zu[ of '%s' from split %zu",
+              io_context->read.range_start, io_context->read.range_end,
+              dec->xfer->xd_objid, i);
+
+    return 0;
+}
+
+bool raid_read_split_window(struct pho_encoder *dec, size_t *offset,
+                            size_t *size)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    size_t split_start;
+    size_t split_size;
+    size_t start;
+    size_t end;
+
+    split_size = split_data_size(dec, io_context->current_split);
+    if (!io_context->read.ranged) {
+        *offset = 0;
+        *size = split_size;
+        return true;
+    }
+
+    split_start = split_object_offset(dec, io_context->current_split);
+    start = max(split_start, io_context->read.range_start);
+    end = min(split_start + split_size, io_context->read.range_end);
+
+    *offset = start - split_start;
+    *size = end > start ? end - start : 0;
+
+    return *offset == 0 && *size == split_size;
+}
+
+/** Whether the current split is the last one needed by a ranged decoder */
+static bool range_ends_in_current_split(struct pho_encoder *dec)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    size_t split_end;
+
+    if (!io_context->read.ranged)
+        return false;
+
+    split_end = split_object_offset(dec, io_context->current_split) +
+        split_data_size(dec, io_context->current_split);
+
+    return split_end >= io_context->read.range_end;
+}
+
+/**
+ * Insert the decompression stage on the POSIX I/O descriptor if the object
+ * data is compressed.
+ *
+ * A compressed stream can only be decoded from its beginning: all the splits
+ * are read and the byte range requested by the GET parameters, if any, is
+ * extracted from the decompressed data.
+ */
+static int raid_decoder_init_codec(struct pho_encoder *dec)
+{
+    struct pho_attrs *attrs = &dec->layout->layout_desc.mod_attrs;
+    struct pho_xfer_get_params *get = &dec->xfer->xd_params.get;
+    struct raid_io_context *io_context = dec->priv_enc;
+    const char *codec_str;
+    const char *raw_size_str;
+    int64_t raw_size;
+    size_t range_end;
+
+    codec_str = pho_attr_get(attrs, PHO_EA_COMPRESSION_CODEC_NAME);
+    if (codec_str == NULL)
+        return 0;
+
+    io_context->codec = str2codec(codec_str);
+    if (io_context->codec == PHO_CODEC_INVAL)
+        LOG_RETURN(-EINVAL, "Unknown compression codec '%s' in layout of '%s'",
+                   codec_str, dec->xfer->xd_objid);
+
+    raw_size_str = pho_attr_get(attrs, PHO_EA_COMPRESSION_RAW_SIZE_NAME);
+    raw_size = raw_size_str ? str2int64(raw_size_str) : -1;
+    if (raw_size < 0)
+        LOG_RETURN(-EINVAL, "Invalid uncompressed size in layout of '%s'",
+                   dec->xfer->xd_objid);
+
+    io_context->raw_size = raw_size;
+
+    if (get->offset > io_context->raw_size)
+        LOG_RETURN(-ERANGE,
+                   "Range offset %zu is beyond the end of object '%s' "
+                   "(%zu bytes)",
+                   get->offset, dec->xfer->xd_objid, io_context->raw_size);
+
+    if (get->size == 0 || get->size > io_context->raw_size - get->offset)
+        range_end = io_context->raw_size;
+    else
+        range_end = get->offset + get->size;
+
+    if (get->offset == range_end && (get->offset != 0 || get->size != 0)) {
+        pho_debug("Empty range requested on '%s'", dec->xfer->xd_objid);
+        dec->done = true;
+    }
+
+    return codec_wrap_decompress(&io_context->posix, io_context->codec,
+                                 get->offset, range_end);
+}
+
 int raid_decoder_init(struct pho_encoder *dec,
                       const struct module_desc *module,
                       const struct pho_enc_ops *enc_ops,
@@ -216,6 +457,25 @@ int raid_decoder_init(struct pho_encoder *dec,
         return rc;
     }
 
+    rc = raid_decoder_init_codec(dec);
+    if (rc)
+        return rc;
+
+    return raid_decoder_set_range(dec);
+}
+
+int raid_decoder_object_size(struct pho_encoder *dec, size_t *size)
+{
+    struct raid_io_context *io_context = dec->priv_enc;
+    size_t n_extents = n_total_extents(io_context);
+
+    if (io_context->codec != PHO_CODEC_NONE)
+        *size = io_context->raw_size;
+    else if (io_context->read.packed)
+        *size = io_context->read.packed_size;
+    else
+        *size = split_object_offset(dec, dec->layout->ext_count / n_extents);
+
     return 0;
 }
 
@@ -391,6 +651,10 @@ static void raid_build_read_allocation_req(struct pho_encoder *dec,
 
     req->ralloc->n_required = io_context->n_data_extents;
     req->ralloc->operation = PHO_READ_TARGET_ALLOC_OP_READ;
+    /* lets the LRS weigh the media to mount by the data they serve */
+    req->ralloc->has_size = true;
+    req->ralloc->size =
+        dec->layout->extents[split_first_extent_index(dec)].size;
 
     for (i = 0; i < n_extents; ++i) {
         unsigned int ext_idx;
@@ -520,7 +784,7 @@ static int write_split_setup(struct pho_encoder *enc, pho_resp_write_t *wresp,
     int rc;
     int i;
 
-    object_size = enc->xfer->xd_params.put.size;
+    object_size = enc->layout->wr_size;
     left_to_write = io_context->write.to_write;
 
     n_extents = n_total_extents(io_context);
@@ -643,6 +907,17 @@ static int write_split_fini(struct pho_encoder *enc, int io_rc,
     if (!io_rc) {
         io_context->write.to_write -= total_written;
 
+        if (codec_eof(&io_context->posix)) {
+            /* the compressed stream is shorter than its upper bound */
+            io_context->write.to_write = 0;
+        } else if (io_context->codec != PHO_CODEC_NONE &&
+                   io_context->write.to_write == 0) {
+            pho_error(-EOVERFLOW,
+                      "Compressed data of '%s' exceeds its expected bound",
+                      enc->xfer->xd_objid);
+            rc = rc ? : -EOVERFLOW;
+        }
+
         for (i = 0; i < n_extents; i++)
             raid_io_add_written_extent(io_context,
                                        &io_context->write.extents[i]);
@@ -1002,10 +1277,16 @@ skip_io:
         pho_buff_free(&io_context->buffers[i]);
 
     if (!rc) {
-        io_context->read.to_read -= split_size;
+        if (range_ends_in_current_split(dec))
+            io_context->read.to_read = 0;
+        else
+            io_context->read.to_read -= split_size;
         io_context->current_split++;
     }
 
+    if (!rc && io_context->read.to_read == 0)
+        rc = codec_check_end(&io_context->posix, io_context->raw_size);
+
     /* Nothing more to read: the decoder is done */
     if (io_context->read.to_read == 0) {
         pho_debug("Decoder for '%s' is now finished", dec->xfer->xd_objid);
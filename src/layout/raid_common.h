@@ -20,6 +20,7 @@
 #define RAID_COMMON_H
 
 #include "pho_layout.h"
+#include "raid_codec.h"
 
 #include <openssl/evp.h>
 #if HAVE_XXH128
@@ -49,6 +50,20 @@ struct read_io_context {
     size_t to_read;
     struct extent **extents;
     bool check_hash;
+    /** Whether only a byte range of the object is requested */
+    bool ranged;
+    /** Object offset of the first byte of the requested range */
+    size_t range_start;
+    /** Object offset of the byte following the requested range */
+    size_t range_end;
+    /**
+     * Whether the object data is packed with other objects in the extents,
+     * in which case it only spans the packed_size bytes starting at
+     * packed_offset in the extents data
+     */
+    bool packed;
+    size_t packed_offset;
+    size_t packed_size;
 };
 
 struct write_io_context {
@@ -123,6 +138,14 @@ struct raid_io_context {
     struct extent_hash *hashes;
     /** Size of \p hashes, initialized by the layout */
     size_t nb_hashes;
+
+    /**
+     * Codec of the compression stage inserted on the POSIX I/O descriptor,
+     * PHO_CODEC_NONE if the object data is not compressed
+     */
+    enum pho_codec codec;
+    /** Uncompressed size of the object data, if compressed */
+    size_t raw_size;
 };
 
 struct raid_ops {
@@ -159,6 +182,11 @@ int raid_locate(struct dss_handle *dss, struct layout_info *layout,
 
 void raid_encoder_destroy(struct pho_encoder *enc);
 
+/**
+ * Generic implementation of pho_enc_ops::object_size
+ */
+int raid_decoder_object_size(struct pho_encoder *dec, size_t *size);
+
 size_t n_total_extents(struct raid_io_context *io_context);
 
 int extent_hash_init(struct extent_hash *hash, bool use_md5, bool use_xxhash);
@@ -177,4 +205,18 @@ int extent_hash_compare(struct extent_hash *hash, struct extent *extent);
 
 struct pho_ext_loc make_ext_location(struct pho_encoder *enc, size_t i);
 
+/**
+ * Compute the part of the current split that must be written to the output
+ * file of a decoder.
+ *
+ * \param[in]   dec     The decoder
+ * \param[out]  offset  Offset in the split data of the first byte to write
+ * \param[out]  size    Number of bytes to write
+ *
+ * \return true if the whole split has to be written, false if only a window
+ *         of it is requested by a ranged GET
+ */
+bool raid_read_split_window(struct pho_encoder *dec, size_t *offset,
+                            size_t *size);
+
 #endif
@@ -60,6 +60,10 @@ struct extent_location {
      * not locked.
      */
     char *hostname;
+    /** Hostname of the node that reserved the medium of this extent to mount
+     * it soon, only set if the medium is not locked.
+     */
+    char *reserved_host;
 };
 
 static void host_capabilities_fini(gpointer data)
@@ -116,6 +120,7 @@ static void extent_location_fini(gpointer data)
         return;
 
     free(loc->hostname);
+    free(loc->reserved_host);
     media_info_free(loc->medium);
     free(loc);
 }
@@ -179,6 +184,17 @@ static int locate_all_extents(struct dss_handle *dss,
             }
 
             one_locate_succeeded = true;
+            if (loc->hostname)
+                continue;
+
+            rc = dss_medium_reservation(dss, medium_id, &loc->reserved_host,
+                                        NULL);
+            if (rc && rc != -ENOLCK)
+                pho_warn("Unable to get the reservation of medium "
+                         "(family %s, name %s, library %s) of extent %lu : %s",
+                         rsc_family2str(medium_id->family),
+                         medium_id->name, medium_id->library,
+                         ext_index, strerror(-rc));
         }
 
         if (!one_locate_succeeded)
@@ -409,6 +425,12 @@ static void filter_host_with_partial_access(GHashTable *hosts,
     g_ptr_array_unref(to_remove);
 }
 
+/**
+ * The best host is the one which already locked the most media, then the one
+ * which will mount the most media soon. As a medium is only reserved by the
+ * host expecting to mount it the soonest, the reservations lead the extents
+ * to the host where their media will be available first.
+ */
 static char *find_best_host(GHashTable *hosts, GPtrArray *extents,
                             size_t n_data_extents, size_t n_parity_extents,
                             const char *focus_host)
@@ -418,18 +440,22 @@ static char *find_best_host(GHashTable *hosts, GPtrArray *extents,
     struct {
         const char *hostname;
         size_t nb_locks;
+        size_t nb_reservations;
     } best_host = {
         .hostname = NULL,
         .nb_locks = 0,
+        .nb_reservations = 0,
     };
 
     hashtable_foreach(hosts, &key, &value) {
+        size_t nb_reservations = 0;
         char *hostname = key;
         size_t nb_locks = 0;
         int i;
         int j;
 
         for (i = 0; i < extents->len / extents_per_split; i++) {
+            size_t split_reservations = 0;
             size_t split_locks = 0;
 
             for (j = 0; j < extents_per_split; j++) {
@@ -438,68 +464,115 @@ static char *find_best_host(GHashTable *hosts, GPtrArray *extents,
 
                 loc = extents->pdata[ext_index];
 
-                if (!loc || !loc->hostname)
+                if (!loc)
                     continue;
 
-                if (!strcmp(hostname, loc->hostname))
+                if (loc->hostname && !strcmp(hostname, loc->hostname))
                     split_locks++;
+                else if (loc->reserved_host &&
+                         !strcmp(hostname, loc->reserved_host))
+                    split_reservations++;
             }
 
             nb_locks += (split_locks > n_data_extents) ?
                 n_data_extents : split_locks;
+            nb_reservations += min(split_reservations,
+                                   n_data_extents - min(split_locks,
+                                                        n_data_extents));
         }
 
         if (!best_host.hostname ||
             (nb_locks > best_host.nb_locks) ||
+            (nb_locks == best_host.nb_locks &&
+             nb_reservations > best_host.nb_reservations) ||
             /* In case of equality, focus_host wins */
-            (nb_locks == best_host.nb_locks && !strcmp(focus_host, hostname))) {
+            (nb_locks == best_host.nb_locks &&
+             nb_reservations == best_host.nb_reservations &&
+             !strcmp(focus_host, hostname))) {
 
             best_host.hostname = hostname;
             best_host.nb_locks = nb_locks;
+            best_host.nb_reservations = nb_reservations;
         }
     }
 
     return xstrdup_safe(best_host.hostname);
 }
 
-static void cleanup_locks(struct dss_handle *dss,
-                          struct pho_id **medium_locked,
-                          int nb_extents)
+static void release_locks(struct dss_handle *dss, struct media_info *media,
+                          int count)
 {
-    bool warned = false;
+    int *rcs;
     int i;
 
-    for (i = 0; i < nb_extents; i++) {
-        struct media_info medium;
-        int rc;
-
-        if (!medium_locked[i])
-            continue;
+    if (count == 0)
+        return;
 
-        if (!warned) {
-            /* only display the warning if at least one lock was taken */
-            pho_warn("locate: could not reserve enough locks after locate. "
-                     "Unlocking reserved locks.");
-            warned = true;
-        }
+    rcs = xcalloc(count, sizeof(*rcs));
+    dss_unlock_each(dss, DSS_MEDIA, media, count, false, rcs);
 
-        medium.rsc.id = *medium_locked[i];
-        rc = dss_unlock(dss, DSS_MEDIA, &medium, 1, false);
-        if (rc == -ENOLCK || rc == -EACCES)
+    for (i = 0; i < count; i++) {
+        if (rcs[i] == -ENOLCK || rcs[i] == -EACCES)
             pho_warn("locate: failed to unlock reserved lock for ('%s', '%s'). "
                      "Lock was modified by someone else: %s",
-                     medium.rsc.id.library, medium.rsc.id.name,
-                     strerror(-rc));
-        else if (rc)
+                     media[i].rsc.id.library, media[i].rsc.id.name,
+                     strerror(-rcs[i]));
+        else if (rcs[i])
             pho_warn("locate: failed to unlock reserved lock for ('%s', '%s') "
                      ": %s",
-                     medium.rsc.id.library, medium.rsc.id.name,
-                     strerror(-rc));
+                     media[i].rsc.id.library, media[i].rsc.id.name,
+                     strerror(-rcs[i]));
     }
+
+    free(rcs);
+}
+
+static void cleanup_locks(struct dss_handle *dss,
+                          struct pho_id **medium_locked,
+                          int nb_extents)
+{
+    struct media_info *media;
+    int count = 0;
+    int i;
+
+    media = xcalloc(nb_extents, sizeof(*media));
+    for (i = 0; i < nb_extents; i++)
+        if (medium_locked[i])
+            media[count++].rsc.id = *medium_locked[i];
+
+    /* only display the warning if at least one lock was taken */
+    if (count > 0)
+        pho_warn("locate: could not reserve enough locks after locate. "
+                 "Unlocking reserved locks.");
+
+    release_locks(dss, media, count);
+    free(media);
+}
+
+/**
+ * Whether \p id is already one of the \p count first \p media, in which case a
+ * single lock is requested for both extents.
+ */
+static bool medium_in_list(struct media_info *media, int count,
+                           const struct pho_id *id)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        if (pho_id_equal(&media[i].rsc.id, id))
+            return true;
+
+    return false;
 }
 
 /* XXX we do not check that the extents that are locked have a compatible device
  * on the selected host.
+ *
+ * As many locks as a split misses are requested at once for all the splits, in
+ * a single DSS call. The extents whose lock could not be taken are replaced by
+ * the next extents of their split in a new call, until each split has enough
+ * locks or no extent left to try, so that no more than n_data_extents media
+ * are locked per split.
  */
 static int lock_extents(struct dss_handle *dss,
                         GPtrArray *extents,
@@ -509,52 +582,92 @@ static int lock_extents(struct dss_handle *dss,
                         size_t n_parity_extents)
 {
     size_t extents_per_split = n_data_extents + n_parity_extents;
-    struct pho_id *medium_locked[extents->len];
+    struct pho_id **medium_locked;
+    struct media_info *media;
+    size_t *candidates;
     int nb_new_locks = 0;
+    int nb_candidates;
+    bool *tried;
+    int rc = 0;
+    int *rcs;
     int i, j;
 
-    for (i = 0; i < extents->len / extents_per_split; i++) {
-        if (nb_locks_per_split[i] >= n_data_extents)
-            continue;
+    medium_locked = xcalloc(extents->len, sizeof(*medium_locked));
+    candidates = xcalloc(extents->len, sizeof(*candidates));
+    media = xcalloc(extents->len, sizeof(*media));
+    tried = xcalloc(extents->len, sizeof(*tried));
+    rcs = xcalloc(extents->len, sizeof(*rcs));
 
-        for (j = 0; j < extents_per_split; j++) {
-            size_t ext_index = i * extents_per_split + j;
-            struct extent_location *loc;
-            struct media_info medium;
-            int rc;
+    while (true) {
+        nb_candidates = 0;
+        for (i = 0; i < extents->len / extents_per_split; i++) {
+            int missing = n_data_extents - nb_locks_per_split[i];
 
-            loc = extents->pdata[ext_index];
-            if (!loc)
-                continue;
+            for (j = 0; j < extents_per_split && missing > 0; j++) {
+                size_t ext_index = i * extents_per_split + j;
+                struct extent_location *loc;
 
-            medium.rsc.id = loc->medium->rsc.id;
-            rc = dss_lock_hostname(dss, DSS_MEDIA, &medium, 1, hostname);
-            if (rc == -EEXIST) {
+                loc = extents->pdata[ext_index];
+                if (!loc || tried[ext_index])
+                    continue;
+
+                tried[ext_index] = true;
+                if (medium_in_list(media, nb_candidates,
+                                   &loc->medium->rsc.id))
+                    continue;
+
+                media[nb_candidates].rsc.id = loc->medium->rsc.id;
+                candidates[nb_candidates++] = ext_index;
+                missing--;
+            }
+        }
+
+        if (nb_candidates == 0)
+            break;
+
+        /* the outcome of each lock is checked below */
+        dss_lock_hostname_each(dss, DSS_MEDIA, media, nb_candidates,
+                               hostname, rcs);
+
+        for (j = 0; j < nb_candidates; j++) {
+            struct extent_location *loc = extents->pdata[candidates[j]];
+
+            i = candidates[j] / extents_per_split;
+
+            if (rcs[j] == -EEXIST) {
                 /* somebody else took the lock */
                 continue;
-            } else if (rc) {
+            } else if (rcs[j]) {
                 pho_warn("locate: failed to reserve lock on medium ('%s', "
                          "'%s') for host '%s': %s",
-                         medium.rsc.id.library, medium.rsc.id.name, hostname,
-                         strerror(-rc));
+                         media[j].rsc.id.library, media[j].rsc.id.name,
+                         hostname, strerror(-rcs[j]));
                 continue;
             }
 
             nb_new_locks++;
             nb_locks_per_split[i]++;
             /* used for later cleanup in case of error */
-            medium_locked[ext_index] = &loc->medium->rsc.id;
-            if (nb_locks_per_split[i] >= n_data_extents)
-                break;
+            medium_locked[candidates[j]] = &loc->medium->rsc.id;
         }
+    }
 
+    for (i = 0; i < extents->len / extents_per_split; i++) {
         if (nb_locks_per_split[i] < n_data_extents) {
             cleanup_locks(dss, medium_locked, extents->len);
-            LOG_RETURN(-EAGAIN, "locate: not enough locks where taken");
+            LOG_GOTO(out_free, rc = -EAGAIN,
+                     "locate: not enough locks where taken");
         }
     }
 
-    return nb_new_locks;
+out_free:
+    free(rcs);
+    free(tried);
+    free(media);
+    free(candidates);
+    free(medium_locked);
+
+    return rc ? : nb_new_locks;
 }
 
 static int reserve_locks(struct dss_handle *dss, GHashTable *hosts,
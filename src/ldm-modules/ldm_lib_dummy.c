@@ -23,15 +23,27 @@
  * \brief  Phobos Local Device Manager: dummy library.
  *
  * Dummy library for devices that are always online.
+ *
+ * It can also simulate the timings of a robotic library: each load and unload
+ * takes mount_ms, plus move_ms if the medium has to be fetched from a storage
+ * slot which is not near the drive. A medium is near a drive once it has been
+ * staged for it or unloaded from it, until it is loaded into any drive.
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include "pho_cfg.h"
 #include "pho_common.h"
 #include "pho_ldm.h"
 #include "pho_module_loader.h"
 
+#include "ldm_lib_dummy.h"
+
+#include <glib.h>
+#include <pthread.h>
+#include <unistd.h>
+
 #define PLUGIN_NAME     "dummy"
 #define PLUGIN_MAJOR    0
 #define PLUGIN_MINOR    1
@@ -42,6 +54,143 @@ static struct module_desc LIB_ADAPTER_DUMMY_MODULE_DESC = {
     .mod_minor = PLUGIN_MINOR,
 };
 
+/** List of configuration parameters of the dummy library */
+enum pho_cfg_params_lib_dummy {
+    PHO_CFG_LIB_DUMMY_FIRST,
+
+    /* simulated timings */
+    PHO_CFG_LIB_DUMMY_move_ms = PHO_CFG_LIB_DUMMY_FIRST,
+    PHO_CFG_LIB_DUMMY_mount_ms,
+
+    PHO_CFG_LIB_DUMMY_LAST = PHO_CFG_LIB_DUMMY_mount_ms
+};
+
+const struct pho_config_item cfg_lib_dummy[] = {
+    [PHO_CFG_LIB_DUMMY_move_ms] = {
+        .section = "lib_dummy",
+        .name    = "move_ms",
+        .value   = "0"
+    },
+    [PHO_CFG_LIB_DUMMY_mount_ms] = {
+        .section = "lib_dummy",
+        .name    = "mount_ms",
+        .value   = "0"
+    },
+};
+
+/**
+ * Media staged near a drive: the key is the label of the medium, the value the
+ * serial of the drive. Shared by all the handles of the process, as the media
+ * of a real library.
+ */
+static GHashTable *staged_media;
+static pthread_mutex_t staged_media_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * The handles only live for an operation, so the media staged are kept until
+ * the module is unloaded.
+ */
+__attribute__((destructor)) static void staged_media_free(void)
+{
+    if (staged_media == NULL)
+        return;
+
+    g_hash_table_destroy(staged_media);
+    staged_media = NULL;
+}
+
+static void simulate_delay(int delay_ms)
+{
+    if (delay_ms > 0)
+        usleep(delay_ms * 1000);
+}
+
+/**
+ * Simulate the move of a medium from a slot which is not near the drive.
+ */
+static void simulate_move(struct lib_handle *lib)
+{
+    struct dummy_lib *dummy = lib->lh_lib;
+
+    MUTEX_LOCK(&staged_media_mutex);
+    dummy->moves++;
+    MUTEX_UNLOCK(&staged_media_mutex);
+
+    simulate_delay(PHO_CFG_GET_INT(cfg_lib_dummy, PHO_CFG_LIB_DUMMY, move_ms,
+                                   0));
+}
+
+/**
+ * Forget where \p medium_label is staged.
+ *
+ * @return true if it was staged near \p drive_serial, false otherwise
+ */
+static bool unstage_medium(const char *drive_serial, const char *medium_label)
+{
+    const char *staged_drive;
+    bool near = false;
+
+    MUTEX_LOCK(&staged_media_mutex);
+    if (staged_media) {
+        staged_drive = g_hash_table_lookup(staged_media, medium_label);
+        near = staged_drive && !strcmp(staged_drive, drive_serial);
+        g_hash_table_remove(staged_media, medium_label);
+    }
+    MUTEX_UNLOCK(&staged_media_mutex);
+
+    return near;
+}
+
+/** Whether \p medium_label is near \p drive_serial */
+static bool medium_is_near(const char *drive_serial, const char *medium_label)
+{
+    const char *staged_drive = NULL;
+    bool near;
+
+    MUTEX_LOCK(&staged_media_mutex);
+    if (staged_media)
+        staged_drive = g_hash_table_lookup(staged_media, medium_label);
+    near = staged_drive && !strcmp(staged_drive, drive_serial);
+    MUTEX_UNLOCK(&staged_media_mutex);
+
+    return near;
+}
+
+/** Record that \p medium_label is near \p drive_serial */
+static void stage_medium(const char *drive_serial, const char *medium_label)
+{
+    MUTEX_LOCK(&staged_media_mutex);
+    if (!staged_media)
+        staged_media = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+                                             free);
+
+    g_hash_table_insert(staged_media, xstrdup(medium_label),
+                        xstrdup(drive_serial));
+    MUTEX_UNLOCK(&staged_media_mutex);
+}
+
+static int dummy_open(struct lib_handle *lib)
+{
+    ENTRY;
+
+    lib->lh_lib = xcalloc(1, sizeof(struct dummy_lib));
+
+    return 0;
+}
+
+static int dummy_close(struct lib_handle *lib)
+{
+    ENTRY;
+
+    if (!lib->lh_lib) /* already closed */
+        return -EBADF;
+
+    free(lib->lh_lib);
+    lib->lh_lib = NULL;
+
+    return 0;
+}
+
 /**
  * Return drive info for an online device.
  */
@@ -66,14 +215,66 @@ static int dummy_drive_lookup(struct lib_handle *lib, const char *drive_serial,
     return 0;
 }
 
+/**
+ * Simulate the load of a medium, fetched from its slot unless it is near the
+ * drive.
+ */
+static int dummy_load(struct lib_handle *lib, const char *drive_serial,
+                      const char *medium_label)
+{
+    ENTRY;
+
+    if (!unstage_medium(drive_serial, medium_label))
+        simulate_move(lib);
+
+    simulate_delay(PHO_CFG_GET_INT(cfg_lib_dummy, PHO_CFG_LIB_DUMMY, mount_ms,
+                                   0));
+
+    return 0;
+}
+
+/**
+ * Simulate the unload of a medium, which is put back in a slot near the drive.
+ */
+static int dummy_unload(struct lib_handle *lib, const char *drive_serial,
+                        const char *medium_label)
+{
+    ENTRY;
+
+    simulate_delay(PHO_CFG_GET_INT(cfg_lib_dummy, PHO_CFG_LIB_DUMMY, mount_ms,
+                                   0));
+    if (medium_label)
+        stage_medium(drive_serial, medium_label);
+
+    return 0;
+}
+
+/**
+ * Simulate the move of a medium to a slot near a drive.
+ */
+static int dummy_stage(struct lib_handle *lib, const char *drive_serial,
+                       const char *medium_label)
+{
+    ENTRY;
+
+    if (medium_is_near(drive_serial, medium_label))
+        return 0;
+
+    simulate_move(lib);
+    stage_medium(drive_serial, medium_label);
+
+    return 0;
+}
+
 /** Exported library adapater */
 static struct pho_lib_adapter_module_ops LIB_ADAPTER_DUMMY_OPS = {
-    .lib_open         = NULL,
-    .lib_close        = NULL,
+    .lib_open         = dummy_open,
+    .lib_close        = dummy_close,
     .lib_drive_lookup = dummy_drive_lookup,
     .lib_scan         = NULL,
-    .lib_load         = NULL,
-    .lib_unload       = NULL,
+    .lib_load         = dummy_load,
+    .lib_unload       = dummy_unload,
+    .lib_stage        = dummy_stage,
     .lib_refresh      = NULL,
     .lib_ping         = NULL,
 };
@@ -362,6 +362,54 @@ free_resp:
     return rc;
 }
 
+static int lib_tlc_stage(struct lib_handle *hdl, const char *drive_serial,
+                         const char *tape_label)
+{
+    struct lib_descriptor *lib;
+    pho_tlc_resp_t *resp;
+    pho_tlc_req_t req;
+    int rid = 1;
+    int rc;
+
+    lib = hdl->lh_lib;
+
+    /* stage request to the tlc */
+    pho_srl_tlc_request_stage_alloc(&req);
+    req.id = rid;
+    req.stage->drive_serial = xstrdup(drive_serial);
+    req.stage->tape_label = xstrdup(tape_label);
+
+    rc = tlc_send_recv(&lib->tlc_comm, &req, &resp);
+    pho_srl_tlc_request_free(&req, false);
+    if (rc)
+        LOG_RETURN(rc,
+                   "Unable to send/recv stage request for drive '%s' (tape "
+                   "'%s') to tlc", drive_serial, tape_label);
+
+    /* manage tlc stage response, a tape which cannot be staged is not an
+     * error of the library
+     */
+    if (pho_tlc_response_is_error(resp) && resp->req_id == rid) {
+        rc = resp->error->rc;
+        pho_verb("TLC did not stage '%s' for '%s': %s (%s)", tape_label,
+                 drive_serial, resp->error->message ? : "no message",
+                 strerror(-rc));
+        goto free_resp;
+    } else if (!(pho_tlc_response_is_stage(resp) && resp->req_id == rid)) {
+        LOG_GOTO(free_resp, rc = -EPROTO,
+                 "TLC answered an unexpected response (id %d) to stage request "
+                 "for drive '%s' (tape '%s')",
+                 resp->req_id, drive_serial, tape_label);
+    }
+
+    pho_debug("Successful stage of '%s' for '%s' at address %#lx", tape_label,
+              drive_serial, resp->stage->addr);
+
+free_resp:
+    pho_srl_tlc_response_free(resp, true);
+    return rc;
+}
+
 static int lib_tlc_refresh(struct lib_handle *hdl)
 {
     struct lib_descriptor *lib;
@@ -457,6 +505,7 @@ static struct pho_lib_adapter_module_ops LA_SCSI_OPS = {
     .lib_scan         = lib_tlc_scan,
     .lib_load         = lib_tlc_load,
     .lib_unload       = lib_tlc_unload,
+    .lib_stage        = lib_tlc_stage,
     .lib_refresh      = lib_tlc_refresh,
     .lib_ping         = lib_tlc_ping,
 };
@@ -28,6 +28,9 @@
 
 #include <assert.h>
 #include <glib.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
 
 #include "io_sched.h"
 #include "pho_common.h"
@@ -56,6 +59,36 @@ struct pho_config_item cfg_io_sched[] = {
         .name    = "dispatch_algo",
         .value   = "none",
     },
+    [PHO_IO_SCHED_priority_algo] = {
+        .section = "io_sched",
+        .name    = "priority_algo",
+        .value   = NULL,
+    },
+    [PHO_IO_SCHED_qos_weights] = {
+        .section = "io_sched",
+        .name    = "qos_weights",
+        .value   = "interactive=8,normal=4,bulk=1",
+    },
+    [PHO_IO_SCHED_qos_reserved_devices] = {
+        .section = "io_sched",
+        .name    = "qos_reserved_devices",
+        .value   = NULL,
+    },
+    [PHO_IO_SCHED_grouped_read_policy] = {
+        .section = "io_sched",
+        .name    = "grouped_read_policy",
+        .value   = "first",
+    },
+    [PHO_IO_SCHED_grouped_read_mount_cost_s] = {
+        .section = "io_sched",
+        .name    = "grouped_read_mount_cost_s",
+        .value   = "90",
+    },
+    [PHO_IO_SCHED_grouped_read_deadline_s] = {
+        .section = "io_sched",
+        .name    = "grouped_read_deadline_s",
+        .value   = "3600",
+    },
 };
 
 static int io_sched_init(struct io_sched_handle *io_sched_hdl)
@@ -109,9 +142,99 @@ int io_sched_dispatch_devices(struct io_sched_handle *io_sched_hdl,
     return io_sched_hdl->dispatch_devices(io_sched_hdl, devices);
 }
 
+static void qos_push(struct io_qos *qos, struct req_container *reqc)
+{
+    enum pho_qos_class class = pho_request_qos(reqc->req);
+
+    /* An idle class cannot claim the share it did not use */
+    if (qos->stats[class].queued++ == 0)
+        qos->vtime[class] = max(qos->vtime[class], qos->last_vtime);
+}
+
+/* Account for the scheduling of one request of the class of \p reqc */
+static void qos_charge(struct io_qos *qos, struct req_container *reqc)
+{
+    enum pho_qos_class class = pho_request_qos(reqc->req);
+
+    qos->last_vtime = qos->vtime[class];
+    qos->vtime[class] += 1.0 / qos->weights[class];
+}
+
+static void qos_remove(struct io_qos *qos, struct req_container *reqc)
+{
+    enum pho_qos_class class = pho_request_qos(reqc->req);
+    struct io_qos_stats *stats = &qos->stats[class];
+
+    if (stats->queued > 0)
+        stats->queued--;
+}
+
+void io_sched_qos_scheduled(struct io_sched_handle *io_sched_hdl,
+                            struct req_container *reqc)
+{
+    enum pho_qos_class class = pho_request_qos(reqc->req);
+    struct io_qos_stats *stats = &io_sched_hdl->qos.stats[class];
+    struct timespec now;
+    struct timespec wait;
+    int64_t wait_ms;
+
+    qos_charge(&io_sched_hdl->qos, reqc);
+    stats->scheduled++;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    wait = diff_timespec(&now, &reqc->received_at);
+    wait_ms = max(wait.tv_sec * 1000 + wait.tv_nsec / 1000000, 0);
+    stats->total_wait_ms += wait_ms;
+    stats->max_wait_ms = max(stats->max_wait_ms, wait_ms);
+}
+
+enum pho_qos_class io_sched_qos_next_class(struct io_sched_handle *io_sched_hdl,
+                                           const bool backlogged[PHO_QOS_LAST])
+{
+    struct io_qos *qos = &io_sched_hdl->qos;
+    enum pho_qos_class next = PHO_QOS_INVAL;
+    int i;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++) {
+        if (!backlogged[i])
+            continue;
+
+        if (next == PHO_QOS_INVAL || qos->vtime[i] < qos->vtime[next] ||
+            (qos->vtime[i] == qos->vtime[next] &&
+             qos->weights[i] > qos->weights[next]))
+            next = i;
+    }
+
+    return next;
+}
+
+/**
+ * A device reserved to another class is of no use to \p reqc, unless it
+ * already holds the medium \p reqc needs and the class it is reserved to has
+ * nothing to schedule: the medium would stay stuck in it otherwise.
+ */
+static void qos_check_device(struct io_qos *qos, struct req_container *reqc,
+                             struct lrs_dev **dev)
+{
+    enum pho_qos_class class = pho_request_qos(reqc->req);
+
+    if (!*dev || dev_is_qos_allowed(*dev, class) ||
+        qos->stats[(*dev)->ld_qos_class].queued == 0)
+        return;
+
+    pho_debug("Device '%s' is reserved to %s requests, %s request %p must "
+              "wait", (*dev)->ld_dev_path, qos_class2str((*dev)->ld_qos_class),
+              qos_class2str(class), reqc);
+    *dev = NULL;
+}
+
 int io_sched_push_request(struct io_sched_handle *io_sched_hdl,
                           struct req_container *reqc)
 {
+    if (pho_request_is_read(reqc->req) || pho_request_is_write(reqc->req) ||
+        pho_request_is_format(reqc->req))
+        qos_push(&io_sched_hdl->qos, reqc);
+
     if (pho_request_is_read(reqc->req)) {
         io_sched_hdl->io_stats.nb_reads++;
         pho_debug("lrs received read allocation request (%p)", reqc->req);
@@ -146,6 +269,10 @@ int io_sched_requeue(struct io_sched_handle *io_sched_hdl,
 int io_sched_remove_request(struct io_sched_handle *io_sched_hdl,
                          struct req_container *reqc)
 {
+    if (pho_request_is_read(reqc->req) || pho_request_is_write(reqc->req) ||
+        pho_request_is_format(reqc->req))
+        qos_remove(&io_sched_hdl->qos, reqc);
+
     if (pho_request_is_read(reqc->req)) {
         io_sched_hdl->io_stats.nb_reads--;
         return io_sched_hdl->read.ops.remove_request(&io_sched_hdl->read, reqc);
@@ -194,6 +321,7 @@ int io_sched_get_device_medium_pair(struct io_sched_handle *io_sched_hdl,
                                     size_t *index)
 {
     struct io_scheduler *io_sched;
+    int rc;
 
     if (pho_request_is_read(reqc->req))
         io_sched = &io_sched_hdl->read;
@@ -205,7 +333,13 @@ int io_sched_get_device_medium_pair(struct io_sched_handle *io_sched_hdl,
         LOG_RETURN(-EINVAL, "Invalid request type: '%s'",
                    pho_srl_request_kind_str(reqc->req));
 
-    return io_sched->ops.get_device_medium_pair(io_sched, reqc, dev, index);
+    rc = io_sched->ops.get_device_medium_pair(io_sched, reqc, dev, index);
+    if (rc)
+        return rc;
+
+    qos_check_device(&io_sched_hdl->qos, reqc, dev);
+
+    return 0;
 }
 
 int io_sched_retry(struct io_sched_handle *io_sched_hdl,
@@ -213,6 +347,7 @@ int io_sched_retry(struct io_sched_handle *io_sched_hdl,
                    struct lrs_dev **dev)
 {
     struct io_scheduler *io_sched;
+    int rc;
 
     if (pho_request_is_read(sreq->reqc->req))
         io_sched = &io_sched_hdl->read;
@@ -224,7 +359,13 @@ int io_sched_retry(struct io_sched_handle *io_sched_hdl,
         LOG_RETURN(-EINVAL, "Invalid request type: '%s'",
                    pho_srl_request_kind_str(sreq->reqc->req));
 
-    return io_sched->ops.retry(io_sched, sreq, dev);
+    rc = io_sched->ops.retry(io_sched, sreq, dev);
+    if (rc)
+        return rc;
+
+    qos_check_device(&io_sched_hdl->qos, sreq->reqc, dev);
+
+    return 0;
 }
 
 int io_sched_remove_device(struct io_sched_handle *io_sched_hdl,
@@ -361,10 +502,9 @@ int io_sched_cfg_section_name(enum rsc_family family, char **section_name)
     return 0;
 }
 
-static int
-io_sched_get_param_from_cfg(enum pho_cfg_params_io_sched type,
-                            enum rsc_family family,
-                            const char **value)
+int io_sched_get_param_from_cfg(enum pho_cfg_params_io_sched type,
+                                enum rsc_family family,
+                                const char **value)
 {
     char *section_name;
     int rc;
@@ -441,8 +581,8 @@ static int set_dispatch_algorithm(struct io_sched_handle *io_sched_hdl,
         return rc;
 
     if (!strcmp(value, "none")) {
-        /* TODO load next_request from the configuration. For now, the dispatch
-         * algo imposes the next_request one so this is fine.
+        /* The dispatch algo imposes the next_request one, unless
+         * priority_algo is set.
          */
         io_sched_hdl->next_request = fifo_next_request;
         io_sched_hdl->dispatch_devices = no_dispatch;
@@ -454,6 +594,114 @@ static int set_dispatch_algorithm(struct io_sched_handle *io_sched_hdl,
         io_sched_hdl->next_request = round_robin;
     }
 
+    rc = io_sched_get_param_from_cfg(PHO_IO_SCHED_priority_algo, family,
+                                     &value);
+    if (rc == -ENODATA)
+        return 0;
+    if (rc)
+        return rc;
+
+    if (!strcmp(value, "fifo"))
+        io_sched_hdl->next_request = fifo_next_request;
+    else if (!strcmp(value, "round_robin"))
+        io_sched_hdl->next_request = round_robin;
+    else if (!strcmp(value, "weighted_fair"))
+        io_sched_hdl->next_request = weighted_fair;
+    else
+        LOG_RETURN(-EINVAL, "Unknown priority_algo '%s'", value);
+
+    return 0;
+}
+
+/**
+ * Parse a "class=value,..." list of the configuration into \p values, indexed
+ * by QoS class. The values of the classes which are not listed are kept.
+ */
+static int parse_qos_list(const char *list, const char *param,
+                          int64_t values[PHO_QOS_LAST])
+{
+    char *saveptr;
+    char *item;
+    char *dup;
+    int rc = 0;
+
+    dup = xstrdup(list);
+    for (item = strtok_r(dup, ",", &saveptr); item;
+         item = strtok_r(NULL, ",", &saveptr)) {
+        enum pho_qos_class class;
+        char *value;
+
+        value = strchr(item, '=');
+        if (!value)
+            LOG_GOTO(out, rc = -EINVAL,
+                     "Invalid item '%s' in '%s', expected 'class=value'",
+                     item, param);
+
+        *value++ = '\0';
+        class = str2qos_class(item);
+        if (class == PHO_QOS_INVAL)
+            LOG_GOTO(out, rc = -EINVAL, "Unknown QoS class '%s' in '%s'",
+                     item, param);
+
+        values[class] = str2int64(value);
+        if (values[class] == INT64_MIN || values[class] < 0)
+            LOG_GOTO(out, rc = -EINVAL,
+                     "Invalid value '%s' for class '%s' in '%s'",
+                     value, item, param);
+    }
+
+out:
+    free(dup);
+    return rc;
+}
+
+static int load_qos(struct io_sched_handle *io_sched_hdl,
+                    enum rsc_family family)
+{
+    struct io_qos *qos = &io_sched_hdl->qos;
+    int64_t values[PHO_QOS_LAST];
+    const char *value;
+    int rc;
+    int i;
+
+    memset(qos, 0, sizeof(*qos));
+
+    /* a class which is not listed gets the smallest share */
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++)
+        values[i] = 1;
+
+    rc = io_sched_get_param_from_cfg(PHO_IO_SCHED_qos_weights, family,
+                                     &value);
+    if (!rc)
+        rc = parse_qos_list(value, "qos_weights", values);
+    if (rc && rc != -ENODATA)
+        return rc;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++) {
+        if (values[i] == 0 || values[i] > UINT_MAX)
+            LOG_RETURN(-EINVAL, "Invalid weight %ld for QoS class '%s'",
+                       values[i], qos_class2str(i));
+
+        qos->weights[i] = values[i];
+        values[i] = 0;
+    }
+
+    rc = io_sched_get_param_from_cfg(PHO_IO_SCHED_qos_reserved_devices, family,
+                                     &value);
+    if (!rc)
+        rc = parse_qos_list(value, "qos_reserved_devices", values);
+    if (rc && rc != -ENODATA)
+        return rc;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++) {
+        if (values[i] > INT_MAX)
+            LOG_RETURN(-EINVAL,
+                       "Invalid number of devices %ld reserved to '%s'",
+                       values[i], qos_class2str(i));
+
+        qos->reserved_devices[i] = values[i];
+    }
+
     return 0;
 }
 
@@ -462,6 +710,7 @@ int io_sched_handle_load_from_config(struct io_sched_handle *io_sched_hdl,
 {
     int rc;
 
+    io_sched_hdl->family = family;
     io_sched_hdl->read.type = IO_REQ_READ;
     io_sched_hdl->write.type = IO_REQ_WRITE;
     io_sched_hdl->format.type = IO_REQ_FORMAT;
@@ -482,6 +731,10 @@ int io_sched_handle_load_from_config(struct io_sched_handle *io_sched_hdl,
     if (rc)
         LOG_RETURN(rc, "Failed to read 'dispatch_algo' from config");
 
+    rc = load_qos(io_sched_hdl, family);
+    if (rc)
+        LOG_RETURN(rc, "Failed to read QoS parameters from config");
+
     return io_sched_init(io_sched_hdl);
 }
 
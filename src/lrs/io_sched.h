@@ -50,6 +50,12 @@ enum pho_cfg_params_io_sched {
     PHO_IO_SCHED_write_algo,
     PHO_IO_SCHED_format_algo,
     PHO_IO_SCHED_dispatch_algo,
+    PHO_IO_SCHED_priority_algo,
+    PHO_IO_SCHED_qos_weights,
+    PHO_IO_SCHED_qos_reserved_devices,
+    PHO_IO_SCHED_grouped_read_policy,
+    PHO_IO_SCHED_grouped_read_mount_cost_s,
+    PHO_IO_SCHED_grouped_read_deadline_s,
 
     PHO_IO_SCHED_LAST
 };
@@ -205,6 +211,32 @@ struct io_stats {
     size_t nb_formats;
 };
 
+/** Queue depth and latency of the requests of one QoS class */
+struct io_qos_stats {
+    size_t queued;          /* requests currently waiting in the schedulers */
+    size_t scheduled;       /* requests which were scheduled */
+    int64_t total_wait_ms;  /* cumulated wait of the scheduled requests */
+    int64_t max_wait_ms;    /* longest wait of a scheduled request */
+};
+
+/**
+ * Weighted fair queueing state of the QoS classes.
+ *
+ * Each class has a virtual time which is increased by 1 / weight each time one
+ * of its requests is scheduled. The class to serve next is the
+ * backlogged one with the lowest virtual time, so that each class gets a share
+ * of the scheduling proportional to its weight. A class which becomes
+ * backlogged again starts from the virtual time of the last served class, so
+ * that it cannot claim the share it did not use while it was idle.
+ */
+struct io_qos {
+    unsigned int weights[PHO_QOS_LAST];  /* from "qos_weights" */
+    int reserved_devices[PHO_QOS_LAST];  /* from "qos_reserved_devices" */
+    double vtime[PHO_QOS_LAST];
+    double last_vtime;
+    struct io_qos_stats stats[PHO_QOS_LAST];
+};
+
 struct io_sched_handle {
     /**
      * Decide which request should be considered next. This callback will decide
@@ -252,6 +284,8 @@ struct io_sched_handle {
     struct lock_handle *lock_handle;
     struct tsqueue     *response_queue; /* reference to the response queue */
     struct io_stats     io_stats;
+    struct io_qos       qos;
+    enum rsc_family     family;
     GPtrArray          *global_device_list; /* reference to
                                              * lrs_sched::devices::ldh_devices
                                              */
@@ -338,6 +372,17 @@ int io_sched_peek_request(struct io_sched_handle *io_sched_hdl,
 int io_sched_remove_request(struct io_sched_handle *io_sched_hdl,
                             struct req_container *reqc);
 
+/**
+ * Account for the scheduling of a request removed from the scheduler: charge
+ * its QoS class and record how long it waited. A request which is requeued,
+ * deferred or which fails is not charged.
+ *
+ * \param[in]  io_sched_hdl   a valid io_sched_handle
+ * \param[in]  reqc           the request which was just scheduled
+ */
+void io_sched_qos_scheduled(struct io_sched_handle *io_sched_hdl,
+                            struct req_container *reqc);
+
 /**
  * Requeue a request. If a request cannot be scheduled immediatly, this function
  * will reschedule the request for later.
@@ -443,6 +488,20 @@ struct io_sched_weights {
 int io_sched_compute_scheduler_weights(struct io_sched_handle *io_sched_hdl,
                                        struct io_sched_weights *weights);
 
+/**
+ * Choose the QoS class whose request should be scheduled next, according to
+ * the weighted fair queueing state of \p io_sched_hdl (see struct io_qos).
+ *
+ * \param[in]  io_sched_hdl  a valid io_sched_handle
+ * \param[in]  backlogged    for each class, whether the caller has a request
+ *                           of that class to schedule
+ *
+ * \return                   the class to serve, PHO_QOS_INVAL if no class is
+ *                           backlogged
+ */
+enum pho_qos_class io_sched_qos_next_class(struct io_sched_handle *io_sched_hdl,
+                                           const bool backlogged[PHO_QOS_LAST]);
+
 /**
  * Count the number of devices of type \p techno in \p io_sched.
  *
@@ -458,4 +517,13 @@ size_t io_sched_count_device_per_techno(struct io_scheduler *io_sched,
 
 int io_sched_cfg_section_name(enum rsc_family family, char **section_name);
 
+/**
+ * Read a parameter of the I/O scheduler section of \p family.
+ *
+ * \return  0 on success, -ENODATA if the parameter is not set
+ */
+int io_sched_get_param_from_cfg(enum pho_cfg_params_io_sched type,
+                                enum rsc_family family,
+                                const char **value);
+
 #endif
@@ -21,9 +21,71 @@ static void io_scheduler_no_dispatch(struct io_scheduler *io_sched,
     }
 }
 
+/* Reserve io_qos::reserved_devices of the online devices to each QoS class.
+ * The current reservations are kept when possible so that the reserved devices
+ * do not change at each dispatch. At least one online device is always left
+ * unreserved.
+ */
+static void qos_reserve_devices(struct io_sched_handle *io_sched_hdl,
+                                GPtrArray *devices)
+{
+    int reserved[PHO_QOS_LAST] = { 0 };
+    struct io_qos *qos = &io_sched_hdl->qos;
+    int nb_reserved = 0;
+    int nb_online = 0;
+    int class;
+    int i;
+
+    for (i = 0; i < devices->len; i++)
+        if (dev_is_online(g_ptr_array_index(devices, i)))
+            nb_online++;
+
+    for (i = 0; i < devices->len; i++) {
+        struct lrs_dev *dev = g_ptr_array_index(devices, i);
+
+        if (!dev->ld_qos_reserved)
+            continue;
+
+        class = dev->ld_qos_class;
+        if (!dev_is_online(dev) ||
+            reserved[class] >= qos->reserved_devices[class] ||
+            nb_reserved + 1 >= nb_online) {
+            pho_debug("Device '%s' is no longer reserved to %s requests",
+                      dev->ld_dev_path, qos_class2str(class));
+            dev->ld_qos_reserved = false;
+            continue;
+        }
+
+        reserved[class]++;
+        nb_reserved++;
+    }
+
+    for (class = PHO_QOS_FIRST; class < PHO_QOS_LAST; class++) {
+        for (i = 0; i < devices->len; i++) {
+            struct lrs_dev *dev = g_ptr_array_index(devices, i);
+
+            if (reserved[class] >= qos->reserved_devices[class] ||
+                nb_reserved + 1 >= nb_online)
+                break;
+
+            if (dev->ld_qos_reserved || !dev_is_online(dev))
+                continue;
+
+            pho_debug("Device '%s' is reserved to %s requests",
+                      dev->ld_dev_path, qos_class2str(class));
+            dev->ld_qos_reserved = true;
+            dev->ld_qos_class = class;
+            reserved[class]++;
+            nb_reserved++;
+        }
+    }
+}
+
 int no_dispatch(struct io_sched_handle *io_sched_hdl,
                 GPtrArray *devices)
 {
+    qos_reserve_devices(io_sched_hdl, devices);
+
     io_scheduler_no_dispatch(&io_sched_hdl->read, devices);
     io_scheduler_no_dispatch(&io_sched_hdl->write, devices);
     io_scheduler_no_dispatch(&io_sched_hdl->format, devices);
@@ -754,6 +816,8 @@ int fair_share_number_of_requests(struct io_sched_handle *io_sched_hdl,
     int rc = 0;
     int i;
 
+    qos_reserve_devices(io_sched_hdl, _devices);
+
     if (io_sched_hdl->io_stats.nb_reads +
         io_sched_hdl->io_stats.nb_writes +
         io_sched_hdl->io_stats.nb_formats == 0)
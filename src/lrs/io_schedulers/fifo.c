@@ -26,8 +26,10 @@
 #include <pthread.h>
 #include <stdbool.h>
 
+#include "lrs_cache.h"
 #include "lrs_device.h"
 #include "lrs_sched.h"
+#include "lrs_utils.h"
 #include "pho_cfg.h"
 #include "pho_types.h"
 #include "io_sched.h"
@@ -53,18 +55,42 @@ static void print_queue(GQueue *queue)
     g_queue_foreach(queue, print_elem, NULL);
 }
 
+/* One queue per QoS class, served according to io_sched_qos_next_class */
+struct fifo_queues {
+    GQueue *queues[PHO_QOS_LAST];
+};
+
+static GQueue *fifo_queue(struct io_scheduler *io_sched,
+                          struct req_container *reqc)
+{
+    struct fifo_queues *fifo = io_sched->private_data;
+
+    return fifo->queues[pho_request_qos(reqc->req)];
+}
+
 static int fifo_init(struct io_scheduler *io_sched)
 {
-    io_sched->private_data = (void *)g_queue_new();
-    if (!io_sched->private_data)
-        return -ENOMEM;
+    struct fifo_queues *fifo;
+    int i;
+
+    fifo = xmalloc(sizeof(*fifo));
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++)
+        fifo->queues[i] = g_queue_new();
+
+    io_sched->private_data = fifo;
 
     return 0;
 }
 
 static void fifo_fini(struct io_scheduler *io_sched)
 {
-    g_queue_free((GQueue *) io_sched->private_data);
+    struct fifo_queues *fifo = io_sched->private_data;
+    int i;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++)
+        g_queue_free(fifo->queues[i]);
+
+    free(fifo);
     return;
 }
 
@@ -78,10 +104,11 @@ static int fifo_push_request(struct io_scheduler *io_sched,
     elem->reqc = reqc;
     elem->num_media_allocated = 0;
 
-    g_queue_push_head((GQueue *)io_sched->private_data, elem);
+    g_queue_push_head(fifo_queue(io_sched, reqc), elem);
 
-    pho_debug("Request %p pushed to fifo '%s' scheduler",
-              reqc, pho_srl_request_kind_str(reqc->req));
+    pho_debug("Request %p pushed to fifo '%s' scheduler (%s)",
+              reqc, pho_srl_request_kind_str(reqc->req),
+              qos_class2str(pho_request_qos(reqc->req)));
 
     return 0;
 }
@@ -106,7 +133,7 @@ static int fifo_remove_request(struct io_scheduler *io_sched,
     pho_debug("Request %p will be removed from fifo '%s' scheduler",
               reqc, pho_srl_request_kind_str(reqc->req));
 
-    queue = (GQueue *) io_sched->private_data;
+    queue = fifo_queue(io_sched, reqc);
 
     if (!is_reqc_the_first_element(queue, reqc))
         LOG_RETURN(-EINVAL, "element '%p' is not first, cannot remove it",
@@ -127,7 +154,7 @@ static int fifo_requeue(struct io_scheduler *io_sched,
     pho_debug("Request %p will be requeued into fifo '%s' scheduler",
               reqc, pho_srl_request_kind_str(reqc->req));
 
-    queue = (GQueue *) io_sched->private_data;
+    queue = fifo_queue(io_sched, reqc);
     if (!is_reqc_the_first_element(queue, reqc))
         return -EINVAL;
 
@@ -144,14 +171,22 @@ static int fifo_requeue(struct io_scheduler *io_sched,
 static int fifo_peek_request(struct io_scheduler *io_sched,
                              struct req_container **reqc)
 {
+    struct fifo_queues *fifo = io_sched->private_data;
+    bool backlogged[PHO_QOS_LAST];
     struct queue_element *elem;
+    enum pho_qos_class class;
+    int i;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++)
+        backlogged[i] = !g_queue_is_empty(fifo->queues[i]);
 
-    elem = g_queue_peek_tail((GQueue *) io_sched->private_data);
-    if (!elem) {
+    class = io_sched_qos_next_class(io_sched->io_sched_hdl, backlogged);
+    if (class == PHO_QOS_INVAL) {
         *reqc = NULL;
         return 0;
     }
 
+    elem = g_queue_peek_tail(fifo->queues[class]);
     *reqc = elem->reqc;
 
     return 0;
@@ -220,8 +255,9 @@ static int find_read_device(struct io_scheduler *io_sched,
                                 &sched_ready);
     if (!*dev) {
         *dev = dev_picker(io_sched->devices, PHO_DEV_OP_ST_UNSPEC,
-                          medium->rsc.id.library, select_empty_loaded_mount, 0,
-                          &NO_TAGS, medium, false, false, NULL);
+                          medium->rsc.id.library, pho_request_qos(reqc->req),
+                          select_earliest_completion, 0, &NO_TAGS, medium,
+                          false, false, NULL);
 
         return 0;
     }
@@ -243,12 +279,38 @@ static int find_read_device(struct io_scheduler *io_sched,
     return 0;
 }
 
+/**
+ * Return \p dev, or NULL if its medium is to be read or is excluded by the
+ * write allocation \p reqc, in which case it cannot be written by this
+ * allocation.
+ */
+static struct lrs_dev *skip_source_dev(struct req_container *reqc,
+                                       struct lrs_dev *dev)
+{
+    struct media_info *medium;
+    bool is_excluded;
+
+    if (!dev || (!reqc->req->walloc->n_sources &&
+                 !reqc->req->walloc->n_excluded))
+        return dev;
+
+    medium = atomic_dev_medium_get(dev);
+    if (!medium)
+        return dev;
+
+    is_excluded = reqc_is_excluded_medium(reqc, &medium->rsc.id);
+    lrs_medium_release(medium);
+
+    return is_excluded ? NULL : dev;
+}
+
 static int find_write_device(struct io_scheduler *io_sched,
                              struct req_container *reqc,
                              struct lrs_dev **dev,
                              size_t index,
                              bool handle_error)
 {
+    enum pho_qos_class qos = pho_request_qos(reqc->req);
     pho_req_write_t *wreq = reqc->req->walloc;
     struct media_info **medium =
         &reqc->params.rwalloc.media[index].alloc_medium;
@@ -272,19 +334,50 @@ static int find_write_device(struct io_scheduler *io_sched,
     tags.tags = wreq->media[index]->tags;
     size = wreq->media[index]->size;
 
+    /* 0) is there a loaded medium already holding the grouping to write? */
+    *dev = grouping_dev_picker(io_sched->devices, PHO_DEV_OP_ST_MOUNTED,
+                               wreq->library, qos, wreq->grouping,
+                               dev_select_policy, size, &tags,
+                               wreq->media[index]->empty_medium);
+    if (!*dev)
+        *dev = grouping_dev_picker(io_sched->devices, PHO_DEV_OP_ST_LOADED,
+                                   wreq->library, qos, wreq->grouping,
+                                   dev_select_policy, size, &tags,
+                                   wreq->media[index]->empty_medium);
+    /* the media to read of the allocation are not written */
+    *dev = skip_source_dev(reqc, *dev);
+    if (*dev)
+        return 0;
+
     /* 1a) is there a mounted filesystem with enough room? */
     *dev = dev_picker(io_sched->devices, PHO_DEV_OP_ST_MOUNTED, wreq->library,
-                      dev_select_policy, size, &tags, NULL, true,
+                      qos, dev_select_policy, size, &tags, NULL, true,
                       wreq->media[index]->empty_medium, &one_drive_available);
+    *dev = skip_source_dev(reqc, *dev);
     /* If we find a dev, we exit. */
+    if (*dev)
+        return 0;
+
+    /* 1a') is there a mounted filesystem waiting for the other media of an
+     * allocation, which can take this write meanwhile?
+     */
+    if (wreq->n_media == 1) {
+        *dev = backfill_dev_picker(io_sched->devices, wreq->library, qos, size,
+                                   &tags, wreq->media[index]->empty_medium);
+        *dev = skip_source_dev(reqc, *dev);
+        if (*dev)
+            return 0;
+    }
+
     /* If there is no chance to find a device, we also exit right now. */
-    if (*dev || !one_drive_available)
+    if (!one_drive_available)
         return 0;
 
     /* 1b) is there a loaded media with enough room? */
     *dev = dev_picker(io_sched->devices, PHO_DEV_OP_ST_LOADED, wreq->library,
-                      dev_select_policy, size, &tags, NULL, true,
+                      qos, dev_select_policy, size, &tags, NULL, true,
                       wreq->media[index]->empty_medium, &one_drive_available);
+    *dev = skip_source_dev(reqc, *dev);
     if (*dev || !one_drive_available)
         return 0;
 
@@ -318,8 +411,8 @@ static int find_write_device(struct io_scheduler *io_sched,
 
 find_device:
     *dev = dev_picker(io_sched->devices, PHO_DEV_OP_ST_UNSPEC, wreq->library,
-                      select_empty_loaded_mount, 0, &NO_TAGS, *medium, true,
-                      false, NULL);
+                      qos, select_earliest_completion, 0, &NO_TAGS, *medium,
+                      true, false, NULL);
     if (*dev)
         return 0;
 
@@ -347,9 +440,10 @@ static int find_format_device(struct io_scheduler *io_sched,
                                 med_id->name, med_id->library, &sched_ready);
     if (!*dev) {
         *dev = dev_picker(io_sched->devices, PHO_DEV_OP_ST_UNSPEC,
-                          med_id->library, select_empty_loaded_mount,
-                          0, &NO_TAGS, reqc->params.format.medium_to_format,
-                          false, false, NULL);
+                          med_id->library, pho_request_qos(reqc->req),
+                          select_earliest_completion, 0, &NO_TAGS,
+                          reqc->params.format.medium_to_format, false, false,
+                          NULL);
 
         return 0;
     }
@@ -456,7 +550,7 @@ static int fifo_get_device_medium_pair(struct io_scheduler *io_sched,
     GQueue *queue;
     int rc;
 
-    queue = (GQueue *) io_sched->private_data;
+    queue = fifo_queue(io_sched, reqc);
 
     if (pho_request_is_read(reqc->req) &&
         *reqc_get_medium_to_alloc(reqc, sreq.medium_index)) {
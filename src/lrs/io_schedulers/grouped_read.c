@@ -126,6 +126,11 @@ struct grouped_data {
                                  * request_queue. Key is the medium_id
                                  */
     struct queue_element *current_elem;
+    bool cost_policy;               /* choose the next queue to allocate with
+                                     * grouped_read_queue_score instead of the
+                                     * order of the table
+                                     */
+    struct grouped_read_cost cost;  /* parameters of the "cost" policy */
 };
 
 /* Iterate over all the element in the GList \p list. \p var is used as the
@@ -150,6 +155,60 @@ static ssize_t reqc_get_medium_index_from_medium_id(struct req_container *reqc,
     return -1;
 }
 
+static int cfg_get_seconds(enum pho_cfg_params_io_sched param,
+                           enum rsc_family family, double *seconds)
+{
+    const char *value;
+    int64_t number;
+    int rc;
+
+    rc = io_sched_get_param_from_cfg(param, family, &value);
+    if (rc)
+        return rc;
+
+    number = str2int64(value);
+    if (number == INT64_MIN || number < 0)
+        LOG_RETURN(-EINVAL, "Invalid number of seconds '%s' for %s", value,
+                   cfg_io_sched[param].name);
+
+    *seconds = number;
+
+    return 0;
+}
+
+static int load_policy(struct io_scheduler *io_sched,
+                       struct grouped_data *data)
+{
+    enum rsc_family family = io_sched->io_sched_hdl->family;
+    const char *policy;
+    int rc;
+
+    data->cost_policy = false;
+    rc = io_sched_get_param_from_cfg(PHO_IO_SCHED_grouped_read_policy,
+                                     family, &policy);
+    if (rc == -ENODATA)
+        return 0;
+    else if (rc)
+        return rc;
+
+    if (!strcmp(policy, "cost"))
+        data->cost_policy = true;
+    else if (strcmp(policy, "first"))
+        LOG_RETURN(-EINVAL, "Unknown grouped_read policy '%s', expected "
+                   "'first' or 'cost'", policy);
+
+    if (!data->cost_policy)
+        return 0;
+
+    rc = cfg_get_seconds(PHO_IO_SCHED_grouped_read_mount_cost_s, family,
+                         &data->cost.mount_cost_s);
+    if (rc)
+        return rc;
+
+    return cfg_get_seconds(PHO_IO_SCHED_grouped_read_deadline_s, family,
+                           &data->cost.deadline_s);
+}
+
 static int grouped_init(struct io_scheduler *io_sched)
 {
     struct grouped_data *data;
@@ -157,6 +216,10 @@ static int grouped_init(struct io_scheduler *io_sched)
 
     data = xmalloc(sizeof(*data));
 
+    rc = load_policy(io_sched, data);
+    if (rc)
+        GOTO(free_data, rc);
+
     data->request_queues = g_hash_table_new(g_pho_id_hash, g_pho_id_equal);
     if (!data->request_queues)
         GOTO(free_data, rc = -ENOMEM);
@@ -245,9 +308,6 @@ static struct device *find_device_from_lrs_dev(struct io_scheduler *io_sched,
  * ctxt::device will be set to the device found for the current queue if any.
  * Once ctxt::device is not NULL, the search is stopped.
  */
-/* TODO we can add a parameter which will tell the function to search for the
- * queue with the most requests that can be allocated now.
- */
 static gboolean glib_stop_at_first_compatible(gpointer _queue_name,
                                               gpointer _queue,
                                               gpointer _compat_ctxt)
@@ -456,6 +516,135 @@ static void empty_incompatible_queue(struct io_scheduler *io_sched,
     delete_queue(io_sched->private_data, queue);
 }
 
+/* Each request is worth this amount of data in the score of a queue, so that a
+ * mount serving many small objects is not dwarfed by a single large one.
+ */
+#define REQUEST_CREDIT_MIB 64.0
+
+/* Score of the queues whose oldest request is past the deadline, to which their
+ * age is added.
+ */
+#define EXPIRED_SCORE 1e12
+
+double grouped_read_queue_score(const struct grouped_read_cost *cost,
+                                size_t n_requests, size_t pending_bytes,
+                                double oldest_age_s, bool in_drive)
+{
+    double mount_cost_s = in_drive ? 0. : cost->mount_cost_s;
+    double work;
+
+    if (cost->deadline_s > 0. && oldest_age_s >= cost->deadline_s)
+        return EXPIRED_SCORE + oldest_age_s;
+
+    /* a queue whose oldest request waited for as long as a mount serves
+     * twice as much
+     */
+    work = (double)pending_bytes / (1024 * 1024) +
+        n_requests * REQUEST_CREDIT_MIB;
+    work *= 1. + oldest_age_s / max(cost->mount_cost_s, 1.);
+
+    /* one second is added so that the media already in a drive are still
+     * compared on the work they serve
+     */
+    return work / (mount_cost_s + 1.);
+}
+
+struct scored_queue {
+    struct request_queue *queue;
+    double                score;
+};
+
+static gint scored_queue_cmp(gconstpointer _a, gconstpointer _b)
+{
+    const struct scored_queue *a = _a;
+    const struct scored_queue *b = _b;
+
+    /* highest score first */
+    return a->score < b->score ? 1 : a->score > b->score ? -1 : 0;
+}
+
+static double queue_score(struct io_scheduler *io_sched,
+                          struct request_queue *queue,
+                          struct timespec *now)
+{
+    struct grouped_data *data = io_sched->private_data;
+    struct queue_element *oldest;
+    size_t pending_bytes = 0;
+    struct timespec age;
+    bool sched_ready;
+    bool in_drive;
+
+    glist_foreach(iter, queue->queue->head) {
+        struct queue_element *elem = iter->data;
+        pho_req_read_t *ralloc = elem->reqc->req->ralloc;
+
+        if (ralloc->has_size)
+            pending_bytes += ralloc->size;
+    }
+
+    oldest = g_queue_peek_tail(queue->queue);
+    age = diff_timespec(now, &oldest->reqc->received_at);
+    in_drive = search_in_use_medium(io_sched->io_sched_hdl->global_device_list,
+                                    queue->medium_id.name,
+                                    queue->medium_id.library,
+                                    &sched_ready) != NULL;
+
+    return grouped_read_queue_score(&data->cost,
+                                    g_queue_get_length(queue->queue),
+                                    pending_bytes,
+                                    age.tv_sec + age.tv_nsec / 1e9, in_drive);
+}
+
+/* Return the queues without a device, sorted by decreasing score */
+static GArray *sorted_free_queues(struct io_scheduler *io_sched)
+{
+    struct grouped_data *data = io_sched->private_data;
+    GArray *queues = g_array_new(FALSE, FALSE, sizeof(struct scored_queue));
+    GHashTableIter iter;
+    struct timespec now;
+    gpointer value;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    g_hash_table_iter_init(&iter, data->request_queues);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        struct scored_queue scored = { .queue = value };
+
+        if (scored.queue->device)
+            continue;
+
+        scored.score = queue_score(io_sched, scored.queue, &now);
+        g_array_append_val(queues, scored);
+    }
+
+    g_array_sort(queues, scored_queue_cmp);
+
+    return queues;
+}
+
+static struct request_queue *
+find_best_compatible_queue(struct io_scheduler *io_sched,
+                           struct find_compatible_context *ctxt)
+{
+    struct request_queue *queue = NULL;
+    GArray *queues;
+    int i;
+
+    queues = sorted_free_queues(io_sched);
+    for (i = 0; i < queues->len; i++) {
+        struct request_queue *candidate;
+
+        candidate = g_array_index(queues, struct scored_queue, i).queue;
+        if (glib_stop_at_first_compatible(NULL, candidate, ctxt)) {
+            queue = candidate;
+            break;
+        }
+    }
+    g_array_free(queues, TRUE);
+
+    return queue;
+}
+
 static struct request_queue *
 find_and_allocate_queue(struct io_scheduler *io_sched,
                         size_t available_devices)
@@ -471,9 +660,12 @@ find_and_allocate_queue(struct io_scheduler *io_sched,
     struct request_queue *queue = NULL;
     int i;
 
-    queue = g_hash_table_find(data->request_queues,
-                              glib_stop_at_first_compatible,
-                              &ctxt);
+    if (data->cost_policy)
+        queue = find_best_compatible_queue(io_sched, &ctxt);
+    else
+        queue = g_hash_table_find(data->request_queues,
+                                  glib_stop_at_first_compatible,
+                                  &ctxt);
     if (queue) {
         assert(ctxt.device);
 
@@ -679,6 +871,78 @@ free_list:
     return res;
 }
 
+/* Return the queues without a device, in the order in which
+ * find_and_allocate_queue considers them.
+ */
+static GPtrArray *next_free_queues(struct io_scheduler *io_sched)
+{
+    struct grouped_data *data = io_sched->private_data;
+    GPtrArray *next = g_ptr_array_new();
+    GHashTableIter iter;
+    gpointer value;
+    int i;
+
+    if (data->cost_policy) {
+        GArray *queues = sorted_free_queues(io_sched);
+
+        for (i = 0; i < queues->len; i++) {
+            struct scored_queue *scored;
+
+            scored = &g_array_index(queues, struct scored_queue, i);
+            g_ptr_array_add(next, scored->queue);
+        }
+        g_array_free(queues, TRUE);
+
+        return next;
+    }
+
+    g_hash_table_iter_init(&iter, data->request_queues);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        struct request_queue *queue = value;
+
+        if (!queue->device)
+            g_ptr_array_add(next, queue);
+    }
+
+    return next;
+}
+
+/* When every device is busy, the next free queues will be the next ones
+ * allocated by find_and_allocate_queue. Hint their media to the busy devices,
+ * one medium per device, so that the devices can stage them while their
+ * current medium is in use.
+ */
+static void hint_next_media(struct io_scheduler *io_sched)
+{
+    GPtrArray *queues = next_free_queues(io_sched);
+    int i = 0;
+    int j;
+
+    for (j = 0; i < io_sched->devices->len && j < queues->len; j++) {
+        struct request_queue *queue = g_ptr_array_index(queues, j);
+
+        for (; i < io_sched->devices->len; i++) {
+            struct device *device = g_ptr_array_index(io_sched->devices, i);
+            bool is_compatible;
+
+            if (!device->queue ||
+                strcmp(device->device->ld_dss_dev_info->rsc.id.library,
+                       queue->medium_id.library))
+                continue;
+
+            if (tape_drive_compat(queue->medium_info, device->device,
+                                  &is_compatible) || !is_compatible)
+                continue;
+
+            dev_stage_hint(device->device, &queue->medium_id);
+            i++;
+            break;
+        }
+    }
+
+    g_ptr_array_free(queues, TRUE);
+}
+
 static int grouped_peek_request(struct io_scheduler *io_sched,
                                 struct req_container **reqc)
 {
@@ -756,6 +1020,8 @@ static int grouped_peek_request(struct io_scheduler *io_sched,
         assert(g_list_length(elem->pair->used) == 0);
         *reqc = elem->reqc;
         data->current_elem = elem;
+    } else {
+        hint_next_media(io_sched);
     }
 
     return 0;
@@ -109,3 +109,39 @@ struct req_container *round_robin(struct io_sched_handle *io_sched_hdl,
 
     return NULL;
 }
+
+/* Whether \p a should be scheduled before \p b with weighted_fair */
+static bool weighted_fair_before(struct io_qos *qos,
+                                 const struct req_container *a,
+                                 const struct req_container *b)
+{
+    double vtime_a;
+    double vtime_b;
+
+    if (!a || !b)
+        return a != NULL;
+
+    vtime_a = qos->vtime[pho_request_qos(a->req)];
+    vtime_b = qos->vtime[pho_request_qos(b->req)];
+    if (vtime_a != vtime_b)
+        return vtime_a < vtime_b;
+
+    return oldest_request(a, b) == a;
+}
+
+struct req_container *weighted_fair(struct io_sched_handle *io_sched_hdl,
+                                    struct req_container *read,
+                                    struct req_container *write,
+                                    struct req_container *format)
+{
+    struct io_qos *qos = &io_sched_hdl->qos;
+    struct req_container *next = read;
+
+    if (weighted_fair_before(qos, write, next))
+        next = write;
+
+    if (weighted_fair_before(qos, format, next))
+        next = format;
+
+    return next;
+}
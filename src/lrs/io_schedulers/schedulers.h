@@ -30,6 +30,40 @@
 extern struct io_scheduler_ops IO_SCHED_FIFO_OPS;
 extern struct io_scheduler_ops IO_SCHED_GROUPED_READ_OPS;
 
+/**
+ * Parameters of the "cost" policy of grouped_read, which chooses the next
+ * medium to mount among the media with pending requests.
+ */
+struct grouped_read_cost {
+    double mount_cost_s; /* estimated time to load and mount a medium */
+    double deadline_s;   /* wait after which the requests of a medium must be
+                          * served before any other
+                          */
+};
+
+/**
+ * Score of the queue of requests of one medium for the "cost" policy of
+ * grouped_read, the queue with the highest score is mounted first.
+ *
+ * The score is the amount of work the mount serves, i.e. the pending bytes plus
+ * a fixed credit per request, divided by the cost of the mount, which is null
+ * if the medium is already in a drive. The longer the oldest request waited,
+ * compared to the cost of a mount, the higher the score, and a queue whose
+ * oldest request waited more than the deadline scores above any queue within
+ * its deadline, the oldest first.
+ *
+ * \param[in]  cost           parameters of the policy
+ * \param[in]  n_requests     number of requests in the queue
+ * \param[in]  pending_bytes  amount of data these requests read on the medium
+ * \param[in]  oldest_age_s   age of the oldest request of the queue
+ * \param[in]  in_drive       whether the medium is already in a drive
+ *
+ * \return                    the score of the queue
+ */
+double grouped_read_queue_score(const struct grouped_read_cost *cost,
+                                size_t n_requests, size_t pending_bytes,
+                                double oldest_age_s, bool in_drive);
+
 /********************************
  * Device dispatcher algorithms *
  ********************************/
@@ -95,4 +129,13 @@ struct req_container *round_robin(struct io_sched_handle *io_sched_hdl,
                                   struct req_container *write,
                                   struct req_container *format);
 
+/**
+ * Weighted fair: return the request whose QoS class has the lowest virtual
+ * time (see struct io_qos), the oldest one between requests of the same class.
+ */
+struct req_container *weighted_fair(struct io_sched_handle *io_sched_hdl,
+                                    struct req_container *read,
+                                    struct req_container *write,
+                                    struct req_container *format);
+
 #endif
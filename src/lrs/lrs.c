@@ -139,8 +139,16 @@ static int _delete_lock_file(const char *lock_file)
 
 static enum rsc_family _determine_family(const pho_req_t *req)
 {
-    if (pho_request_is_write(req))
+    if (pho_request_is_write(req)) {
+        size_t i;
+
+        /* the media to read are allocated by the same scheduler */
+        for (i = 0; i < req->walloc->n_sources; i++)
+            if (req->walloc->sources[i]->family != req->walloc->family)
+                return PHO_RSC_INVAL;
+
         return (enum rsc_family)req->walloc->family;
+    }
 
     if (pho_request_is_read(req)) {
         if (!req->ralloc->n_med_ids)
@@ -231,7 +239,8 @@ static void notify_device_request_is_canceled(struct resp_container *respc)
 
     for (i = 0; i < respc->devices_len; i++) {
         MUTEX_LOCK(&respc->devices[i]->ld_mutex);
-        respc->devices[i]->ld_ongoing_io = false;
+        dev_client_remove(respc->devices[i], respc->socket_id,
+                          respc->resp->req_id, 0);
         MUTEX_UNLOCK(&respc->devices[i]->ld_mutex);
     }
 }
@@ -328,6 +337,20 @@ cancel:
     return rc;
 }
 
+/* Responses to the requests of the LRS itself are only logged */
+static void log_internal_response(struct resp_container *respc)
+{
+    if (pho_response_is_format(respc->resp))
+        pho_info("Background format of medium (family '%s', name '%s', "
+                 "library '%s') done",
+                 rsc_family2str(respc->resp->format->med_id->family),
+                 respc->resp->format->med_id->name,
+                 respc->resp->format->med_id->library);
+    else if (pho_response_is_error(respc->resp))
+        pho_error(respc->resp->error->rc, "Background %s request failed",
+                  pho_srl_error_kind_str(respc->resp->error));
+}
+
 static int send_responses_from_queue(struct lrs *lrs)
 {
     struct resp_container *respc;
@@ -335,6 +358,12 @@ static int send_responses_from_queue(struct lrs *lrs)
     int rc2;
 
     while ((respc = tsqueue_pop(&lrs->response_queue)) != NULL) {
+        if (respc->socket_id == SCHED_INTERNAL_SOCKET_ID) {
+            log_internal_response(respc);
+            sched_resp_free_with_cont(respc);
+            continue;
+        }
+
         rc2 = _send_message(&lrs->comm, respc);
         rc = rc ? : rc2;
         sched_resp_free_with_cont(respc);
@@ -442,7 +471,8 @@ static void init_rwalloc_container(struct req_container *reqc)
     size_t i;
 
     if (is_write)
-        rwalloc_params->n_media = reqc->req->walloc->n_media;
+        rwalloc_params->n_media = reqc->req->walloc->n_media +
+                                  reqc->req->walloc->n_sources;
     else
         rwalloc_params->n_media = reqc->req->ralloc->n_required;
 
@@ -458,12 +488,19 @@ static void init_rwalloc_container(struct req_container *reqc)
     rwalloc_params->respc->resp = xcalloc(1,
                                           sizeof(*rwalloc_params->respc->resp));
 
-    if (is_write)
+    if (is_write) {
+        pho_req_write_t *wreq = reqc->req->walloc;
+
         pho_srl_response_write_alloc(rwalloc_params->respc->resp,
-                                     rwalloc_params->n_media);
-    else
+                                     wreq->n_media);
+        /* the media to read come after the media to write */
+        if (wreq->n_sources)
+            pho_srl_response_write_alloc_sources(rwalloc_params->respc->resp,
+                                                 wreq->n_sources);
+    } else {
         pho_srl_response_read_alloc(rwalloc_params->respc->resp,
                                     rwalloc_params->n_media);
+    }
 
     rwalloc_params->respc->resp->req_id = reqc->req->id;
     rwalloc_params->respc->devices_len = rwalloc_params->n_media;
@@ -538,8 +575,12 @@ static int release_medium(struct lrs_sched *sched,
         rc = update_phys_spc_free(comm_dss, dev->ld_dss_media_info,
                                   release->size_written);
 
-    /* Acknowledgement of the request */
-    dev->ld_ongoing_io = false;
+    /* Acknowledgement of the request, the space reserved by the client is
+     * replaced by the size it actually wrote, from which the throughput of the
+     * device is learnt
+     */
+    dev_client_remove(dev, reqc->socket_id, reqc->req->id,
+                      release->rc == 0 ? release->size_written : 0);
     MUTEX_UNLOCK(&dev->ld_mutex);
 
     if (release->to_sync)
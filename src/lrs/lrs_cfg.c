@@ -83,6 +83,41 @@ const struct pho_config_item cfg_lrs[] = {
         .name    = "max_health",
         .value   = "1",
     },
+    [PHO_CFG_LRS_max_clients_per_medium] = {
+        .section = "lrs",
+        .name    = "max_clients_per_medium",
+        .value   = "tape=1,dir=4,rados_pool=4",
+    },
+    [PHO_CFG_LRS_sync_latency_slo_ms] = {
+        .section = "lrs",
+        .name    = "sync_latency_slo_ms",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_sync_time_min_ms] = {
+        .section = "lrs",
+        .name    = "sync_time_min_ms",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_stage_media] = {
+        .section = "lrs",
+        .name    = "stage_media",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_format_low_watermark] = {
+        .section = "lrs",
+        .name    = "format_low_watermark",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_reserve_media] = {
+        .section = "lrs",
+        .name    = "reserve_media",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_backfill] = {
+        .section = "lrs",
+        .name    = "backfill",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
 };
 
 static int _get_substring_value_from_token(const char *cfg_param,
@@ -105,7 +140,8 @@ static int _get_substring_value_from_token(const char *cfg_param,
     if (key == NULL)
         key = token_dup;
 
-    rc = -EINVAL;
+    /* the family is not listed */
+    rc = -ENODATA;
 
     do {
         char *value = strchr(key, '=');
@@ -154,19 +190,98 @@ static int _get_unsigned_long_from_string(const char *value,
     return 0;
 }
 
-int get_cfg_sync_time_ms_value(enum rsc_family family,
-                               struct timespec *threshold)
+/**
+ * Get the value of \p cfg_param for \p family, between \p min_limit and
+ * \p max_limit.
+ *
+ * \return 0 on success, -ENODATA if \p family is not listed in \p cfg_param,
+ *         -EINVAL or -ERANGE if its value is not valid.
+ */
+static int _get_family_value(const char *cfg_param, enum rsc_family family,
+                             unsigned long min_limit, unsigned long max_limit,
+                             unsigned long *ul_value)
 {
-    unsigned long num_milliseconds;
     char *value;
     int rc;
 
-    rc = _get_substring_value_from_token("sync_time_ms", family, &value);
+    rc = _get_substring_value_from_token(cfg_param, family, &value);
     if (rc)
         return rc;
 
-    rc = _get_unsigned_long_from_string(value, 0, ULONG_MAX, &num_milliseconds);
+    rc = _get_unsigned_long_from_string(value, min_limit, max_limit, ul_value);
     free(value);
+
+    return rc;
+}
+
+/**
+ * Same as _get_family_value, for a parameter every family must be listed in.
+ */
+static int _get_mandatory_family_value(const char *cfg_param,
+                                       enum rsc_family family,
+                                       unsigned long min_limit,
+                                       unsigned long max_limit,
+                                       unsigned long *ul_value)
+{
+    int rc;
+
+    rc = _get_family_value(cfg_param, family, min_limit, max_limit, ul_value);
+    if (rc == -ENODATA)
+        /* a family missing from the list is a configuration error */
+        return -EINVAL;
+
+    return rc;
+}
+
+/**
+ * Same as _get_family_value, \p ul_value is set to \p default_value if
+ * \p family is not listed in \p cfg_param.
+ */
+static int _get_optional_family_value(const char *cfg_param,
+                                      enum rsc_family family,
+                                      unsigned long min_limit,
+                                      unsigned long max_limit,
+                                      unsigned long default_value,
+                                      unsigned long *ul_value)
+{
+    int rc;
+
+    rc = _get_family_value(cfg_param, family, min_limit, max_limit, ul_value);
+    if (rc == -ENODATA) {
+        /* not configured for this family */
+        *ul_value = default_value;
+        return 0;
+    }
+
+    return rc;
+}
+
+/**
+ * Get the boolean \p cfg_param of \p family, false if it is not listed.
+ */
+static int _get_optional_family_bool(const char *cfg_param,
+                                     enum rsc_family family, bool *value)
+{
+    unsigned long ul_value;
+    int rc;
+
+    rc = _get_optional_family_value(cfg_param, family, 0, 1, 0, &ul_value);
+    if (rc)
+        return rc;
+
+    *value = ul_value;
+
+    return 0;
+}
+
+int get_cfg_sync_time_ms_value(enum rsc_family family,
+                               struct timespec *threshold)
+{
+    unsigned long num_milliseconds;
+    int rc;
+
+    rc = _get_mandatory_family_value("sync_time_ms", family, 0, ULONG_MAX,
+                                     &num_milliseconds);
     if (rc)
         return rc;
 
@@ -179,38 +294,113 @@ int get_cfg_sync_time_ms_value(enum rsc_family family,
 int get_cfg_sync_nb_req_value(enum rsc_family family, unsigned int *threshold)
 {
     unsigned long ul_value;
-    char *value;
     int rc;
 
-    rc = _get_substring_value_from_token("sync_nb_req", family, &value);
+    rc = _get_mandatory_family_value("sync_nb_req", family, 1, UINT_MAX,
+                                     &ul_value);
     if (rc)
         return rc;
 
-    rc = _get_unsigned_long_from_string(value, 1, UINT_MAX, &ul_value);
-    free(value);
+    *threshold = ul_value;
+
+    return 0;
+}
+
+int get_cfg_sync_wsize_value(enum rsc_family family, unsigned long *threshold)
+{
+    int rc;
+
+    rc = _get_mandatory_family_value("sync_wsize_kb", family, 1,
+                                     ULONG_MAX / 1024, threshold);
     if (rc)
         return rc;
 
-    *threshold = ul_value;
+    *threshold *= 1024; // converting from KiB to bytes
 
     return 0;
 }
 
-int get_cfg_sync_wsize_value(enum rsc_family family, unsigned long *threshold)
+int get_cfg_max_clients_value(enum rsc_family family,
+                              unsigned int *max_clients)
 {
-    char *value;
+    unsigned long ul_value;
     int rc;
 
-    rc = _get_substring_value_from_token("sync_wsize_kb", family, &value);
+    *max_clients = 1;
+    /* a tape drive handles a single stream at a time */
+    if (family == PHO_RSC_TAPE)
+        return 0;
+
+    rc = _get_optional_family_value("max_clients_per_medium", family, 1,
+                                    UINT_MAX, 1, &ul_value);
     if (rc)
         return rc;
 
-    rc = _get_unsigned_long_from_string(value, 1, ULONG_MAX / 1024, threshold);
-    free(value);
+    *max_clients = ul_value;
+
+    return 0;
+}
+
+int get_cfg_sync_latency_slo_value(enum rsc_family family,
+                                   struct timespec *slo)
+{
+    unsigned long num_milliseconds;
+    int rc;
+
+    rc = _get_optional_family_value("sync_latency_slo_ms", family, 0,
+                                    ULONG_MAX, 0, &num_milliseconds);
     if (rc)
         return rc;
 
-    *threshold *= 1024; // converting from KiB to bytes
+    slo->tv_sec = num_milliseconds / 1000;
+    slo->tv_nsec = (num_milliseconds % 1000) * 1000000;
+
+    return 0;
+}
+
+int get_cfg_sync_time_min_value(enum rsc_family family, struct timespec *min)
+{
+    unsigned long num_milliseconds;
+    int rc;
+
+    rc = _get_optional_family_value("sync_time_min_ms", family, 0, ULONG_MAX,
+                                    0, &num_milliseconds);
+    if (rc)
+        return rc;
+
+    min->tv_sec = num_milliseconds / 1000;
+    min->tv_nsec = (num_milliseconds % 1000) * 1000000;
+
+    return 0;
+}
+
+int get_cfg_stage_media_value(enum rsc_family family, bool *stage)
+{
+    return _get_optional_family_bool("stage_media", family, stage);
+}
+
+int get_cfg_format_low_watermark_value(enum rsc_family family,
+                                       unsigned int *watermark)
+{
+    unsigned long ul_value;
+    int rc;
+
+    rc = _get_optional_family_value("format_low_watermark", family, 0,
+                                    UINT_MAX, 0, &ul_value);
+    if (rc)
+        return rc;
+
+    *watermark = ul_value;
 
     return 0;
 }
+
+int get_cfg_reserve_media_value(enum rsc_family family, bool *reserve)
+{
+    return _get_optional_family_bool("reserve_media", family, reserve);
+}
+
+int get_cfg_backfill_value(enum rsc_family family, bool *backfill)
+{
+    return _get_optional_family_bool("backfill", family, backfill);
+}
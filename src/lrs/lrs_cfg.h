@@ -43,8 +43,15 @@ enum pho_cfg_params_lrs {
     PHO_CFG_LRS_sync_nb_req,
     PHO_CFG_LRS_sync_wsize_kb,
     PHO_CFG_LRS_max_health,
+    PHO_CFG_LRS_max_clients_per_medium,
+    PHO_CFG_LRS_sync_latency_slo_ms,
+    PHO_CFG_LRS_sync_time_min_ms,
+    PHO_CFG_LRS_stage_media,
+    PHO_CFG_LRS_format_low_watermark,
+    PHO_CFG_LRS_reserve_media,
+    PHO_CFG_LRS_backfill,
 
-    PHO_CFG_LRS_LAST = PHO_CFG_LRS_max_health,
+    PHO_CFG_LRS_LAST = PHO_CFG_LRS_backfill,
 };
 
 extern const struct pho_config_item cfg_lrs[];
@@ -80,4 +87,103 @@ int get_cfg_sync_nb_req_value(enum rsc_family family, unsigned int *threshold);
  */
 int get_cfg_sync_wsize_value(enum rsc_family family, unsigned long *threshold);
 
+/**
+ * Getter of the maximum number of clients doing I/Os at the same time on a
+ * mounted medium of a given family.
+ *
+ * Tapes are never shared, and a family not listed in the configuration
+ * defaults to 1 client per medium.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  max_clients Returned maximum number of clients.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_max_clients_value(enum rsc_family family,
+                              unsigned int *max_clients);
+
+/**
+ * Getter of the latency target of the releases to sync for a given family.
+ *
+ * A family not listed in the configuration, or with a target of 0, has no
+ * latency target: its sync thresholds are not tuned.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  slo         Returned latency target.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_sync_latency_slo_value(enum rsc_family family,
+                                   struct timespec *slo);
+
+/**
+ * Getter of the lower bound of the time threshold tuned from the latency
+ * target for a given family.
+ *
+ * A family not listed in the configuration has no lower bound other than its
+ * measured sync duration.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  min         Returned lower bound.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_sync_time_min_value(enum rsc_family family, struct timespec *min);
+
+/**
+ * Getter of whether the media of a given family are staged near the devices
+ * which are expected to load them next.
+ *
+ * A family not listed in the configuration is not staged.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  stage       Returned true if the media are staged.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_stage_media_value(enum rsc_family family, bool *stage);
+
+/**
+ * Getter of the minimum number of formatted media that can be written to, per
+ * library and tags, below which the blank media of a given family are formatted
+ * in the background.
+ *
+ * A family not listed in the configuration, or with a watermark of 0, is not
+ * formatted in the background.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  watermark   Returned watermark.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_format_low_watermark_value(enum rsc_family family,
+                                       unsigned int *watermark);
+
+/**
+ * Getter of whether the media of a given family are reserved in the DSS by the
+ * devices which are expected to load them next, so that the locate of their
+ * extents leads to this host.
+ *
+ * A family not listed in the configuration is not reserved.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  reserve     Returned true if the media are reserved.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_reserve_media_value(enum rsc_family family, bool *reserve);
+
+/**
+ * Getter of whether the devices of a given family which wait for the other
+ * media of a multi-medium allocation handle short requests meanwhile.
+ *
+ * A family not listed in the configuration does not backfill.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  backfill    Returned true if the devices backfill.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_backfill_value(enum rsc_family family, bool *backfill);
+
 #endif
@@ -28,6 +28,7 @@
 
 #include <assert.h>
 #include <stdatomic.h>
+#include <sys/time.h>
 
 #include "health.h"
 #include "lrs_cache.h"
@@ -97,12 +98,41 @@ int lrs_dev_hdl_init(struct lrs_dev_hdl *handle, enum rsc_family family)
     if (rc)
         return rc;
 
+    rc = get_cfg_max_clients_value(family, &handle->max_clients);
+    if (rc)
+        return rc;
+
+    rc = get_cfg_sync_latency_slo_value(family, &handle->sync_latency_slo);
+    if (rc)
+        return rc;
+
+    rc = get_cfg_sync_time_min_value(family, &handle->sync_time_min);
+    if (rc)
+        return rc;
+
+    rc = get_cfg_stage_media_value(family, &handle->stage_media);
+    if (rc)
+        return rc;
+
+    rc = get_cfg_reserve_media_value(family, &handle->reserve_media);
+    if (rc)
+        return rc;
+
+    rc = get_cfg_backfill_value(family, &handle->backfill);
+    if (rc)
+        return rc;
+
+    rc = perf_models_init(&handle->perf_models);
+    if (rc)
+        return rc;
+
     return 0;
 }
 
 void lrs_dev_hdl_fini(struct lrs_dev_hdl *handle)
 {
     g_ptr_array_unref(handle->ldh_devices);
+    perf_models_fini(&handle->perf_models);
 }
 
 static int lrs_dev_init_from_info(struct lrs_dev_hdl *handle,
@@ -119,6 +149,8 @@ static int lrs_dev_init_from_info(struct lrs_dev_hdl *handle,
         GOTO(err_dev, rc = -ENOMEM);
 
     sync_params_init(&(*dev)->ld_sync_params);
+    perf_model_init(&(*dev)->ld_perf);
+    (*dev)->ld_clients = g_array_new(false, false, sizeof(struct dev_client));
 
     rc = dss_init(&(*dev)->ld_device_thread.dss);
     if (rc)
@@ -131,6 +163,8 @@ static int lrs_dev_init_from_info(struct lrs_dev_hdl *handle,
     (*dev)->ld_handle = handle;
     (*dev)->ld_sub_request = NULL;
     (*dev)->ld_mnt_path[0] = 0;
+    (*dev)->ld_max_clients = handle->max_clients;
+    sync_thresholds_update(handle, &(*dev)->ld_sync_params);
 
     if ((*dev)->ld_dss_dev_info->rsc.model) {
         /* not every family has a model set */
@@ -171,6 +205,8 @@ err_techno:
 err_dss:
     dss_fini(&(*dev)->ld_device_thread.dss);
 err_info:
+    perf_model_fini(&(*dev)->ld_perf);
+    g_array_free((*dev)->ld_clients, true);
     g_ptr_array_free((*dev)->ld_sync_params.tosync_array, true);
     dev_info_free((*dev)->ld_dss_dev_info, 1);
 err_dev:
@@ -208,6 +244,8 @@ static void lrs_dev_info_clean(struct lrs_dev_hdl *handle,
     g_ptr_array_foreach(dev->ld_sync_params.tosync_array,
                         sub_request_free_wrapper, NULL);
     g_ptr_array_unref(dev->ld_sync_params.tosync_array);
+    g_array_free(dev->ld_clients, true);
+    perf_model_fini(&dev->ld_perf);
     sub_request_free(dev->ld_sub_request);
     dev_info_free(dev->ld_dss_dev_info, 1);
     dss_fini(&dev->ld_device_thread.dss);
@@ -444,6 +482,59 @@ static void sync_params_init(struct sync_params *params)
     params->oldest_tosync.tv_nsec = 0;
     params->tosync_size = 0;
     params->tosync_nb_extents = 0;
+    params->sync_cost_ms = 0;
+    params->release_interval_ms = 0;
+    params->release_size = 0;
+    params->last_release.tv_sec = 0;
+    params->last_release.tv_nsec = 0;
+    params->sync_count = 0;
+    params->sync_total_ms = 0;
+    params->queue_delay_ms = 0;
+}
+
+/* weight of a new measurement in the averages of the sync parameters */
+#define SYNC_EWMA_WEIGHT 0.25
+
+static inline double ewma(double average, double sample)
+{
+    if (average == 0)
+        return sample;
+
+    return average + SYNC_EWMA_WEIGHT * (sample - average);
+}
+
+static inline double timespec2ms(struct timespec t)
+{
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+void sync_thresholds_update(const struct lrs_dev_hdl *handle,
+                            struct sync_params *params)
+{
+    double slo_ms = timespec2ms(handle->sync_latency_slo);
+    double time_ms;
+
+    params->sync_time = handle->sync_time_ms;
+    params->sync_nb_req = handle->sync_nb_req;
+    params->sync_wsize = handle->sync_wsize_kb;
+
+    /* no latency target, or no sync cost measured yet */
+    if (slo_ms == 0 || params->sync_count == 0)
+        return;
+
+    time_ms = max(slo_ms - params->sync_cost_ms, params->sync_cost_ms);
+    time_ms = max(time_ms, timespec2ms(handle->sync_time_min));
+    time_ms = min(time_ms, timespec2ms(handle->sync_time_ms));
+    params->sync_time.tv_sec = ms2sec(time_ms);
+    params->sync_time.tv_nsec = ms2nsec(time_ms);
+
+    if (params->release_interval_ms > 0) {
+        double nb_req = time_ms / params->release_interval_ms + 1;
+
+        params->sync_nb_req = clamp(nb_req, 1, handle->sync_nb_req);
+        params->sync_wsize = clamp(params->sync_nb_req * params->release_size,
+                                   1, handle->sync_wsize_kb);
+    }
 }
 
 static const struct timespec MINSLEEP = {
@@ -463,9 +554,9 @@ static int compute_wakeup_date(struct lrs_dev *dev, struct timespec *date)
         LOG_RETURN(-errno, "clock_gettime: unable to get CLOCK_REALTIME");
 
     if (oldest_tosync->tv_sec == 0 && oldest_tosync->tv_nsec == 0) {
-        *date = add_timespec(&now, &dev->ld_handle->sync_time_ms);
+        *date = add_timespec(&now, &dev->ld_sync_params.sync_time);
     } else {
-        *date = add_timespec(oldest_tosync, &dev->ld_handle->sync_time_ms);
+        *date = add_timespec(oldest_tosync, &dev->ld_sync_params.sync_time);
 
         diff = diff_timespec(date, &now);
         if (cmp_timespec(&diff, &MINSLEEP) == -1)
@@ -613,6 +704,245 @@ static int tosync_rc(struct req_container *reqc, int index)
     return reqc->params.release.tosync_media[index].client_rc;
 }
 
+/* Elapsed time since \p start in milliseconds, 0 if the clock went back */
+static double elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (!is_older_or_equal(*start, now))
+        return 0;
+
+    return timespec2ms(diff_timespec(&now, start));
+}
+
+/* Record the duration of \p op, started at \p start, in the models of the
+ * device, of \p medium_model and of all the devices
+ */
+static void dev_perf_add_op(struct lrs_dev *dev, const char *medium_model,
+                            enum perf_op op, const struct timespec *start)
+{
+    double duration_ms = elapsed_ms(start);
+    struct perf_models *models;
+
+    pho_debug("%s: device '%s' took %.0f ms", perf_op2str(op),
+              dev->ld_dev_path, duration_ms);
+
+    perf_model_add_op(&dev->ld_perf, op, duration_ms);
+    if (!dev->ld_handle)
+        return;
+
+    models = &dev->ld_handle->perf_models;
+    perf_model_add_op(perf_models_get(models, medium_model), op, duration_ms);
+    perf_model_add_op(&models->all, op, duration_ms);
+}
+
+/* Record that \p size bytes were transferred since \p start */
+static void dev_perf_add_transfer(struct lrs_dev *dev,
+                                  const char *medium_model, size_t size,
+                                  const struct timespec *start)
+{
+    double duration_ms = elapsed_ms(start);
+    struct perf_models *models;
+
+    perf_model_add_transfer(&dev->ld_perf, size, duration_ms);
+    if (!dev->ld_handle)
+        return;
+
+    models = &dev->ld_handle->perf_models;
+    perf_model_add_transfer(perf_models_get(models, medium_model), size,
+                            duration_ms);
+    perf_model_add_transfer(&models->all, size, duration_ms);
+}
+
+double dev_perf_op_ms(struct lrs_dev *dev, const char *medium_model,
+                      enum perf_op op)
+{
+    struct perf_models *models;
+    double duration_ms;
+
+    duration_ms = perf_model_op_ms(&dev->ld_perf, op);
+    if (duration_ms != 0 || !dev->ld_handle)
+        return duration_ms;
+
+    models = &dev->ld_handle->perf_models;
+    if (medium_model) {
+        duration_ms = perf_model_op_ms(perf_models_get(models, medium_model),
+                                       op);
+        if (duration_ms != 0)
+            return duration_ms;
+    }
+
+    return perf_model_op_ms(&models->all, op);
+}
+
+double dev_perf_transfer_ms(struct lrs_dev *dev, const char *medium_model,
+                            size_t size)
+{
+    struct perf_models *models;
+    double duration_ms;
+
+    duration_ms = perf_model_transfer_ms(&dev->ld_perf, size);
+    if (duration_ms != 0 || !dev->ld_handle)
+        return duration_ms;
+
+    models = &dev->ld_handle->perf_models;
+    if (medium_model) {
+        duration_ms =
+            perf_model_transfer_ms(perf_models_get(models, medium_model),
+                                   size);
+        if (duration_ms != 0)
+            return duration_ms;
+    }
+
+    return perf_model_transfer_ms(&models->all, size);
+}
+
+double dev_switch_ms(struct lrs_dev *dev)
+{
+    double switch_ms = 0;
+
+    if (dev_is_mounted(dev))
+        switch_ms += dev_perf_op_ms(dev, NULL, PERF_OP_UMOUNT);
+
+    if (dev_is_mounted(dev) || dev_is_loaded(dev))
+        switch_ms += dev_perf_op_ms(dev, NULL, PERF_OP_UNLOAD);
+
+    return switch_ms + dev_perf_op_ms(dev, NULL, PERF_OP_LOAD) +
+           dev_perf_op_ms(dev, NULL, PERF_OP_MOUNT);
+}
+
+double dev_eta_ms(struct lrs_dev *dev)
+{
+    const char *medium_model = NULL;
+    double eta_ms = 0;
+    guint i;
+
+    if (dev->ld_dss_media_info)
+        medium_model = dev->ld_dss_media_info->rsc.model;
+
+    /* the clients do their I/Os concurrently */
+    for (i = 0; dev->ld_clients && i < dev->ld_clients->len; i++) {
+        struct dev_client *client;
+        double remaining_ms;
+
+        client = &g_array_index(dev->ld_clients, struct dev_client, i);
+        remaining_ms = dev_perf_transfer_ms(dev, medium_model,
+                                            client->reserved_size) -
+                       elapsed_ms(&client->since);
+        eta_ms = max(eta_ms, remaining_ms);
+    }
+
+    if (dev->ld_needs_sync || dev->ld_sync_params.tosync_array->len > 0)
+        eta_ms += dev_perf_op_ms(dev, medium_model, PERF_OP_SYNC);
+
+    if (dev->ld_sub_request)
+        eta_ms += dev_switch_ms(dev);
+
+    return eta_ms;
+}
+
+/* Time left before \p end in milliseconds, 0 if it is past */
+static double remaining_ms(const struct timespec *end)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (is_older_or_equal(*end, now))
+        return 0;
+
+    return timespec2ms(diff_timespec(end, &now));
+}
+
+/* Time left before the expected mount of the other media of the allocation
+ * \p dev waits for, 0 if it does not wait.
+ */
+static double backfill_window_ms(struct lrs_dev *dev)
+{
+    struct backfill_params *params = &dev->ld_backfill;
+
+    if (!dev->ld_handle || !dev->ld_handle->backfill ||
+        (params->until.tv_sec == 0 && params->until.tv_nsec == 0))
+        return 0;
+
+    return remaining_ms(&params->until);
+}
+
+double dev_backfill_ms(struct lrs_dev *dev, size_t size)
+{
+    double window_ms = backfill_window_ms(dev);
+    double duration_ms;
+
+    if (window_ms == 0 || size == 0)
+        return 0;
+
+    /* only one client is backfilled at a time, on top of the clients of the
+     * allocation
+     */
+    if (!thread_is_running(&dev->ld_device_thread) || !dev_is_mounted(dev) ||
+        dev->ld_ongoing_io > dev->ld_max_clients || dev->ld_needs_sync ||
+        dev->ld_sub_request || dev->ld_ongoing_scheduled ||
+        dev->ld_dss_dev_info->rsc.adm_status != PHO_RSC_ADM_ST_UNLOCKED)
+        return 0;
+
+    duration_ms = dev_perf_transfer_ms(dev, dev->ld_dss_media_info->rsc.model,
+                                       size);
+    if (duration_ms <= 0 || duration_ms > window_ms)
+        return 0;
+
+    return duration_ms;
+}
+
+void dev_backfill_account(struct lrs_dev *dev, double duration_ms)
+{
+    dev->ld_backfill.count++;
+    dev->ld_backfill.recovered_ms += duration_ms;
+    pho_debug("backfill: device '%s' recovered %.0f ms", dev->ld_dev_path,
+              duration_ms);
+}
+
+void dev_client_add(struct lrs_dev *dev, int socket_id, int req_id,
+                    size_t reserved_size)
+{
+    struct dev_client client = {
+        .socket_id = socket_id,
+        .req_id = req_id,
+        .reserved_size = reserved_size,
+    };
+
+    clock_gettime(CLOCK_REALTIME, &client.since);
+    g_array_append_val(dev->ld_clients, client);
+    dev->ld_reserved_size += reserved_size;
+    dev->ld_ongoing_io++;
+    pho_debug("Device '%s' has %u client(s), %zu bytes reserved",
+              dev->ld_dev_path, dev->ld_ongoing_io, dev->ld_reserved_size);
+}
+
+void dev_client_remove(struct lrs_dev *dev, int socket_id, int req_id,
+                       size_t written_size)
+{
+    struct dev_client *client;
+    guint i;
+
+    for (i = 0; i < dev->ld_clients->len; i++) {
+        client = &g_array_index(dev->ld_clients, struct dev_client, i);
+        if (client->socket_id == socket_id && client->req_id == req_id)
+            break;
+    }
+
+    /* not a client of this device, or already removed */
+    if (i == dev->ld_clients->len)
+        return;
+
+    if (written_size > 0 && dev->ld_dss_media_info)
+        dev_perf_add_transfer(dev, dev->ld_dss_media_info->rsc.model,
+                              written_size, &client->since);
+
+    dev->ld_reserved_size -= client->reserved_size;
+    dev->ld_ongoing_io--;
+    g_array_remove_index(dev->ld_clients, i);
+}
+
 void push_new_sync_to_device(struct lrs_dev *dev, struct req_container *reqc,
                              size_t medium_index)
 {
@@ -636,6 +966,24 @@ void push_new_sync_to_device(struct lrs_dev *dev, struct req_container *reqc,
         reqc->params.release.tosync_media[medium_index].nb_extents_written;
     update_oldest_tosync(&sync_params->oldest_tosync, reqc->received_at);
 
+    /* arrival rate and size of the releases, to tune the sync thresholds */
+    if ((sync_params->last_release.tv_sec != 0 ||
+         sync_params->last_release.tv_nsec != 0) &&
+        is_older_or_equal(sync_params->last_release, reqc->received_at)) {
+        struct timespec interval = diff_timespec(&reqc->received_at,
+                                                 &sync_params->last_release);
+
+        sync_params->release_interval_ms =
+            ewma(sync_params->release_interval_ms, timespec2ms(interval));
+    }
+    if (is_older_or_equal(sync_params->last_release, reqc->received_at))
+        sync_params->last_release = reqc->received_at;
+
+    sync_params->release_size =
+        ewma(sync_params->release_size,
+             reqc->params.release.tosync_media[medium_index].written_size);
+    sync_thresholds_update(dev->ld_handle, sync_params);
+
     MUTEX_UNLOCK(&dev->ld_mutex);
 
     thread_signal(&dev->ld_device_thread);
@@ -729,10 +1077,10 @@ static void check_needs_sync(struct lrs_dev_hdl *handle, struct lrs_dev *dev)
 
     MUTEX_LOCK(&dev->ld_mutex);
     dev->ld_needs_sync = sync_params->tosync_array->len > 0 &&
-                      (sync_params->tosync_array->len >= handle->sync_nb_req ||
-                       is_past(add_timespec(&sync_params->oldest_tosync,
-                                            &handle->sync_time_ms)) ||
-                       sync_params->tosync_size >= handle->sync_wsize_kb);
+                  (sync_params->tosync_array->len >= sync_params->sync_nb_req ||
+                   is_past(add_timespec(&sync_params->oldest_tosync,
+                                        &sync_params->sync_time)) ||
+                   sync_params->tosync_size >= sync_params->sync_wsize);
     dev->ld_needs_sync |= (!running && sync_params->tosync_array->len > 0);
     dev->ld_needs_sync |= (thread_is_stopping(&dev->ld_device_thread) &&
                            sync_params->tosync_array->len > 0);
@@ -743,6 +1091,35 @@ static void check_needs_sync(struct lrs_dev_hdl *handle, struct lrs_dev *dev)
     MUTEX_UNLOCK(&dev->ld_mutex);
 }
 
+/* Whether the medium of a device waiting for the other media of an allocation
+ * is synced meanwhile, if the sync is expected to end before their mount.
+ */
+static bool check_backfill_sync(struct lrs_dev *dev)
+{
+    bool backfill = false;
+    double duration_ms;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    /* the only client is the one of the allocation, which waits */
+    if (dev->ld_ongoing_io != 1 || dev->ld_sub_request ||
+        dev->ld_ongoing_scheduled || !dev_is_mounted(dev) ||
+        dev->ld_sync_params.tosync_array->len == 0)
+        goto out;
+
+    duration_ms = dev_perf_op_ms(dev, dev->ld_dss_media_info->rsc.model,
+                                 PERF_OP_SYNC);
+    if (duration_ms > 0 && duration_ms <= backfill_window_ms(dev)) {
+        dev->ld_needs_sync = true;
+        dev_backfill_account(dev, duration_ms);
+        backfill = true;
+    }
+
+out:
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    return backfill;
+}
+
 /* called with a lock on \p dev */
 int medium_sync(struct lrs_dev *dev)
 {
@@ -862,6 +1239,36 @@ static int lrs_dev_media_update(struct lrs_dev *dev, size_t size_written,
     return rc;
 }
 
+/**
+ * Account a sync which started at \p start and ended at \p end, and tune the
+ * sync thresholds accordingly.
+ *
+ * This function must be called with a lock on \p dev .
+ */
+static void sync_stats_update(struct lrs_dev *dev, struct timespec *start,
+                              struct timespec *end)
+{
+    struct sync_params *sync_params = &dev->ld_sync_params;
+    double duration_ms = 0;
+
+    if (is_older_or_equal(*start, *end))
+        duration_ms = timespec2ms(diff_timespec(end, start));
+
+    sync_params->sync_count++;
+    sync_params->sync_total_ms += duration_ms;
+    sync_params->sync_cost_ms = ewma(sync_params->sync_cost_ms, duration_ms);
+
+    if ((sync_params->oldest_tosync.tv_sec != 0 ||
+         sync_params->oldest_tosync.tv_nsec != 0) &&
+        is_older_or_equal(sync_params->oldest_tosync, *start))
+        sync_params->queue_delay_ms =
+            ewma(sync_params->queue_delay_ms,
+                 timespec2ms(diff_timespec(start,
+                                           &sync_params->oldest_tosync)));
+
+    sync_thresholds_update(dev->ld_handle, sync_params);
+}
+
 /* Sync dev, update the media in the DSS, and flush tosync_array */
 static int dev_sync(struct lrs_dev *dev)
 {
@@ -872,9 +1279,18 @@ static int dev_sync(struct lrs_dev *dev)
     MUTEX_LOCK(&dev->ld_mutex);
 
     /* Do not sync on error as we don't know what happened on the tape. */
-    if (dev->ld_last_client_rc == 0)
+    if (dev->ld_last_client_rc == 0) {
+        struct timespec start;
+        struct timespec end;
+
+        clock_gettime(CLOCK_REALTIME, &start);
         rc = medium_sync(dev);
-    else
+        clock_gettime(CLOCK_REALTIME, &end);
+        sync_stats_update(dev, &start, &end);
+        if (rc == 0)
+            dev_perf_add_op(dev, dev->ld_dss_media_info->rsc.model,
+                            PERF_OP_SYNC, &start);
+    } else
         /* this will cause the device thread to stop */
         rc = dev->ld_last_client_rc;
 
@@ -911,6 +1327,7 @@ static int dev_sync(struct lrs_dev *dev)
 int dev_umount(struct lrs_dev *dev)
 {
     struct fs_adapter_module *fsa;
+    struct timespec start;
     struct dss_handle *dss;
     struct pho_log log;
     int rc;
@@ -938,7 +1355,11 @@ int dev_umount(struct lrs_dev *dev)
                    dev->ld_dss_media_info->rsc.id.name,
                    dev->ld_dss_media_info->rsc.id.library, dev->ld_dev_path);
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_fs_umount(fsa, dev->ld_dev_path, dev->ld_mnt_path, &log.message);
+    if (rc == 0)
+        dev_perf_add_op(dev, dev->ld_dss_media_info->rsc.model,
+                        PERF_OP_UMOUNT, &start);
     emit_log_after_action(dss, &log, PHO_LTFS_UMOUNT, rc);
     clean_tosync_array(dev, rc);
     if (rc)
@@ -1001,6 +1422,7 @@ int dev_unload(struct lrs_dev *dev)
     /* let the library select the target location */
     struct media_info *unloaded_medium = NULL;
     struct lib_handle lib_hdl;
+    struct timespec start;
     int rc2;
     int rc;
 
@@ -1023,6 +1445,7 @@ int dev_unload(struct lrs_dev *dev)
                    lrs_dev_name(dev),
                    dev_request_kind(dev));
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_lib_unload(&lib_hdl, dev->ld_dss_dev_info->rsc.id.name,
                         dev->ld_dss_media_info->rsc.id.name);
     if (rc != 0)
@@ -1034,6 +1457,9 @@ int dev_unload(struct lrs_dev *dev)
          */
         LOG_GOTO(out_close, rc, "Media unload failed");
 
+    dev_perf_add_op(dev, dev->ld_dss_media_info->rsc.model, PERF_OP_UNLOAD,
+                    &start);
+
     MUTEX_LOCK(&dev->ld_mutex);
     dev->ld_op_status = PHO_DEV_OP_ST_EMPTY;
     unloaded_medium = dev->ld_dss_media_info;
@@ -1112,9 +1538,365 @@ void fail_release_medium(struct lrs_dev *dev, struct media_info *medium)
     pho_lock_clean(&medium->lock);
 }
 
+/** Period at which the reservation of a medium hinted again is refreshed */
+#define RESERVATION_REFRESH_MS 1000
+
+/** Whether the reservation of \p dev is due for a refresh, under ld_mutex */
+static bool reservation_refresh_due(struct lrs_dev *dev)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return timespec2ms(diff_timespec(&now, &params->reserved_at)) >=
+        RESERVATION_REFRESH_MS;
+}
+
+void dev_stage_hint(struct lrs_dev *dev, const struct pho_id *medium_id)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+
+    if (!dev->ld_handle->stage_media && !dev->ld_handle->reserve_media)
+        return;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    if (pho_id_equal(&params->next_medium, medium_id)) {
+        MUTEX_UNLOCK(&dev->ld_mutex);
+        return;
+    }
+
+    if (pho_id_equal(&params->reserved_medium, medium_id) ?
+            !reservation_refresh_due(dev) :
+            pho_id_equal(&params->staged_medium, medium_id)) {
+        MUTEX_UNLOCK(&dev->ld_mutex);
+        return;
+    }
+
+    params->next_medium = *medium_id;
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    thread_signal(&dev->ld_device_thread);
+}
+
+/**
+ * Move \p medium_id to the free slot nearest to \p dev.
+ *
+ * Only uses constant fields of \p dev, so that it can be called outside of the
+ * device thread.
+ *
+ * @param[out]  duration_ms     Duration of the move
+ *
+ * @return 0 on success, -ENOTSUP if the library of \p dev does not stage
+ *         media, negative error code on failure.
+ */
+static int dev_stage_medium(struct lrs_dev *dev, const struct pho_id *medium_id,
+                            double *duration_ms)
+{
+    const struct pho_id *dev_id = lrs_dev_id(dev);
+    struct lib_handle lib_hdl;
+    struct timespec start;
+    struct timespec end;
+    int rc2;
+    int rc;
+
+    clock_gettime(CLOCK_REALTIME, &start);
+
+    rc = wrap_lib_open(dev_id->family, dev_id->library, &lib_hdl);
+    if (rc)
+        return rc;
+
+    rc = ldm_lib_stage(&lib_hdl, dev_id->name, medium_id->name);
+    rc2 = ldm_lib_close(&lib_hdl);
+
+    clock_gettime(CLOCK_REALTIME, &end);
+    *duration_ms = timespec2ms(diff_timespec(&end, &start));
+
+    return rc ? : rc2;
+}
+
+/** Record that \p medium_id is staged near \p dev */
+static void stage_done(struct lrs_dev *dev, const struct pho_id *medium_id,
+                       double hidden_ms)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    params->staged_medium = *medium_id;
+    params->staged_ms = hidden_ms;
+    params->stage_count++;
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    pho_verb("stage: medium (family '%s', name '%s', library '%s') staged for "
+             "device '%s', %.0f ms of its mount hidden",
+             rsc_family2str(medium_id->family), medium_id->name,
+             medium_id->library, lrs_dev_name(dev), hidden_ms);
+}
+
+/**
+ * Release the reservation of the medium reserved for \p dev, if any.
+ *
+ * The reservation may have been taken over by a host expecting to mount the
+ * medium sooner, in which case it is left to this host.
+ */
+static void dev_unreserve_medium(struct lrs_dev *dev)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+    struct media_info medium = {0};
+    int rc;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    medium.rsc.id = params->reserved_medium;
+    params->reserved_medium.name[0] = '\0';
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    if (medium.rsc.id.name[0] == '\0')
+        return;
+
+    rc = dss_unlock(&dev->ld_device_thread.dss, DSS_MEDIA_RESERVATION, &medium,
+                    1, false);
+    if (rc && rc != -ENOLCK && rc != -EACCES)
+        pho_warn("Unable to release the reservation of medium (family '%s', "
+                 "name '%s', library '%s'): %s",
+                 rsc_family2str(medium.rsc.id.family), medium.rsc.id.name,
+                 medium.rsc.id.library, strerror(-rc));
+}
+
+/** Whether \p medium_id is the medium reserved for \p dev */
+static bool dev_reserved(struct lrs_dev *dev, const struct pho_id *medium_id)
+{
+    bool reserved;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    reserved = pho_id_equal(&dev->ld_stage_params.reserved_medium, medium_id);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    return reserved;
+}
+
+/**
+ * Reserve \p medium_id in the DSS for \p dev, with the time at which \p dev
+ * is expected to have mounted it: once its ongoing work is done and its
+ * current medium is switched.
+ *
+ * The previous reservation of \p dev is released, as it was replaced by the
+ * scheduler, unless it is the one of \p medium_id, which is then refreshed.
+ * Failures only make the locate of \p medium_id ignore \p dev.
+ */
+static void dev_reserve_medium(struct lrs_dev *dev,
+                               const struct pho_id *medium_id)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+    struct media_info medium = {0};
+    struct timeval expected;
+    double expected_ms;
+    int rc;
+
+    if (!dev_reserved(dev, medium_id))
+        dev_unreserve_medium(dev);
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    expected_ms = dev_eta_ms(dev) + dev_switch_ms(dev);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    gettimeofday(&expected, NULL);
+    expected.tv_sec += (time_t)expected_ms / 1000;
+    expected.tv_usec += ((long)expected_ms % 1000) * 1000;
+    if (expected.tv_usec >= 1000000) {
+        expected.tv_sec++;
+        expected.tv_usec -= 1000000;
+    }
+
+    medium.rsc.id = *medium_id;
+    rc = dss_medium_reserve(&dev->ld_device_thread.dss, &medium, 1,
+                            &expected);
+    if (rc) {
+        pho_verb("reserve: medium (family '%s', name '%s', library '%s') not "
+                 "reserved for device '%s': %s",
+                 rsc_family2str(medium_id->family), medium_id->name,
+                 medium_id->library, lrs_dev_name(dev), strerror(-rc));
+        /* a refreshed reservation may have been taken over meanwhile */
+        MUTEX_LOCK(&dev->ld_mutex);
+        if (pho_id_equal(&params->reserved_medium, medium_id))
+            params->reserved_medium.name[0] = '\0';
+        MUTEX_UNLOCK(&dev->ld_mutex);
+        return;
+    }
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    params->reserved_medium = *medium_id;
+    clock_gettime(CLOCK_REALTIME, &params->reserved_at);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    pho_verb("reserve: medium (family '%s', name '%s', library '%s') reserved "
+             "for device '%s', expected to be mounted in %.0f ms",
+             rsc_family2str(medium_id->family), medium_id->name,
+             medium_id->library, lrs_dev_name(dev), expected_ms);
+}
+
+/**
+ * Reserve and stage the medium hinted by the scheduler, while the current
+ * medium of \p dev is used by its clients.
+ *
+ * A medium that cannot be staged is simply loaded from its current location,
+ * so failures are not errors of the device.
+ */
+static void dev_stage_next_medium(struct lrs_dev *dev)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+    struct pho_id medium_id;
+    double duration_ms;
+    bool staged;
+    int rc;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    medium_id = params->next_medium;
+    params->next_medium.name[0] = '\0';
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    if (medium_id.name[0] == '\0')
+        return;
+
+    if (dev->ld_handle->reserve_media)
+        dev_reserve_medium(dev, &medium_id);
+
+    if (!dev->ld_handle->stage_media)
+        return;
+
+    /* only the reservation of a staged medium is refreshed */
+    MUTEX_LOCK(&dev->ld_mutex);
+    staged = pho_id_equal(&params->staged_medium, &medium_id);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+    if (staged)
+        return;
+
+    rc = dev_stage_medium(dev, &medium_id, &duration_ms);
+    if (rc) {
+        pho_verb("stage: medium (family '%s', name '%s', library '%s') not "
+                 "staged for device '%s': %s",
+                 rsc_family2str(medium_id.family), medium_id.name,
+                 medium_id.library, lrs_dev_name(dev), strerror(-rc));
+        return;
+    }
+
+    stage_done(dev, &medium_id, duration_ms);
+}
+
+/** Staging of a medium done while the medium of a device is unmounted */
+struct stage_thread {
+    pthread_t       tid;
+    struct lrs_dev *dev;
+    struct pho_id   medium_id;
+    double          duration_ms;
+    int             rc;
+};
+
+static void *stage_thread_routine(void *arg)
+{
+    struct stage_thread *stage = arg;
+
+    stage->rc = dev_stage_medium(stage->dev, &stage->medium_id,
+                                 &stage->duration_ms);
+
+    return NULL;
+}
+
+/**
+ * Empty \p dev to load \p medium_to_load, moving \p medium_to_load near
+ * \p dev while its current medium is unmounted when the family of \p dev
+ * stages its media.
+ *
+ * The library arm is idle during the unmount, which can be long for LTFS as it
+ * writes its index, so the move from a far slot is hidden by the unmount and
+ * only the short move from the nearest slot remains for the load.
+ */
+static int dev_empty_and_stage(struct lrs_dev *dev,
+                               struct media_info *medium_to_load)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+    struct stage_thread stage;
+    struct timespec start;
+    struct timespec end;
+    bool staged;
+    int rc;
+
+    if (!dev_is_mounted(dev) || !dev->ld_handle->stage_media)
+        return dev_empty(dev);
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    staged = pho_id_equal(&params->staged_medium, &medium_to_load->rsc.id);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+    if (staged)
+        return dev_empty(dev);
+
+    stage.dev = dev;
+    stage.medium_id = medium_to_load->rsc.id;
+    stage.duration_ms = 0;
+    stage.rc = 0;
+    rc = pthread_create(&stage.tid, NULL, stage_thread_routine, &stage);
+    if (rc) {
+        pho_warn("Unable to start the staging of medium (family '%s', name "
+                 "'%s', library '%s'): %s",
+                 rsc_family2str(medium_to_load->rsc.id.family),
+                 medium_to_load->rsc.id.name, medium_to_load->rsc.id.library,
+                 strerror(rc));
+        return dev_empty(dev);
+    }
+
+    clock_gettime(CLOCK_REALTIME, &start);
+    rc = dev_umount(dev);
+    clock_gettime(CLOCK_REALTIME, &end);
+
+    pthread_join(stage.tid, NULL);
+    if (stage.rc)
+        pho_verb("stage: medium (family '%s', name '%s', library '%s') not "
+                 "staged for device '%s': %s",
+                 rsc_family2str(medium_to_load->rsc.id.family),
+                 medium_to_load->rsc.id.name, medium_to_load->rsc.id.library,
+                 lrs_dev_name(dev), strerror(-stage.rc));
+    else
+        /* only the part of the move overlapping the unmount is hidden */
+        stage_done(dev, &medium_to_load->rsc.id,
+                   min(stage.duration_ms,
+                       timespec2ms(diff_timespec(&end, &start))));
+
+    if (rc)
+        return rc;
+
+    return dev_empty(dev);
+}
+
+/**
+ * Account the load of \p medium into \p dev in the staging statistics.
+ */
+static void stage_load_account(struct lrs_dev *dev, struct media_info *medium)
+{
+    struct stage_params *params = &dev->ld_stage_params;
+    double hidden_ms;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    if (!pho_id_equal(&params->staged_medium, &medium->rsc.id)) {
+        MUTEX_UNLOCK(&dev->ld_mutex);
+        return;
+    }
+
+    hidden_ms = params->staged_ms;
+    params->stage_hits++;
+    params->hidden_ms += hidden_ms;
+    params->staged_medium.name[0] = '\0';
+    params->staged_ms = 0;
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    pho_verb("load: staging of medium (family '%s', name '%s', library '%s') "
+             "hid %.0f ms of its mount in '%s'",
+             rsc_family2str(medium->rsc.id.family), medium->rsc.id.name,
+             medium->rsc.id.library, hidden_ms, dev->ld_dev_path);
+}
+
 int dev_load(struct lrs_dev *dev, struct media_info *medium)
 {
     struct lib_handle lib_hdl;
+    struct timespec start;
     int rc2;
     int rc;
 
@@ -1132,6 +1914,7 @@ int dev_load(struct lrs_dev *dev, struct media_info *medium)
     if (rc)
         return rc;
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_lib_load(&lib_hdl, dev->ld_dss_dev_info->rsc.id.name,
                       medium->rsc.id.name);
     if (rc) {
@@ -1139,6 +1922,13 @@ int dev_load(struct lrs_dev *dev, struct media_info *medium)
         LOG_GOTO(out_close, rc, "Media load failed");
     }
 
+    dev_perf_add_op(dev, medium->rsc.model, PERF_OP_LOAD, &start);
+
+    stage_load_account(dev, medium);
+    /* the medium is locked by now, its reservation is useless */
+    if (dev_reserved(dev, &medium->rsc.id))
+        dev_unreserve_medium(dev);
+
     medium = lrs_medium_acquire(&medium->rsc.id);
     if (!medium)
         GOTO(out_close, rc = -errno);
@@ -1437,10 +2227,16 @@ static void fill_rwalloc_resp_container(struct lrs_dev *dev,
     struct resp_container *respc = sub_request->reqc->params.rwalloc.respc;
     pho_resp_t *resp = respc->resp;
 
-    if (pho_request_is_read(sub_request->reqc->req)) {
+    if (pho_request_is_read(sub_request->reqc->req) ||
+        reqc_medium_is_source(sub_request->reqc, sub_request->medium_index)) {
+        pho_req_t *req = sub_request->reqc->req;
+        size_t index = sub_request->medium_index;
         pho_resp_read_elt_t *rresp;
 
-        rresp = resp->ralloc->media[sub_request->medium_index];
+        if (pho_request_is_read(req))
+            rresp = resp->ralloc->media[index];
+        else
+            rresp = resp->walloc->sources[index - req->walloc->n_media];
         rresp->fs_type = dev->ld_dss_media_info->fs.type;
         rresp->addr_type = dev->ld_dss_media_info->addr_type;
         rresp->root_path = xstrdup(dev->ld_mnt_path);
@@ -1453,14 +2249,11 @@ static void fill_rwalloc_resp_container(struct lrs_dev *dev,
 
         wresp = resp->walloc->media[sub_request->medium_index];
 
-        /* phys_spc_free is also updated by the communication thread on release.
-         * But since we are about to send an allocation response to the client,
-         * we know that no concurrent release can occur. No need to lock.
-         *
-         * /!\ when families other than tape are allowed multiple concurrent
-         * requests, the device mutex must be taken here.
+        /* phys_spc_free is also updated by the communication thread on the
+         * release of the other clients of the medium, the device mutex is held
+         * by the caller. The space reserved by these clients is not available.
          */
-        wresp->avail_size = dev->ld_dss_media_info->stats.phys_spc_free;
+        wresp->avail_size = dev_free_space(dev);
 
         wresp->med_id->family = dev->ld_dss_media_info->rsc.id.family;
         wresp->root_path = xstrdup(dev->ld_mnt_path);
@@ -1497,6 +2290,35 @@ static bool rwalloc_can_be_requeued(struct sub_request *sub_request)
     return rml_nb_usable_media(list) > ralloc->n_required;
 }
 
+/**
+ * The media of an allocation are all mounted, its devices stop waiting.
+ *
+ * Called with a lock on \p dev and on \p reqc.
+ */
+static void rwalloc_end_backfill(struct lrs_dev *dev,
+                                 struct req_container *reqc)
+{
+    struct resp_container *respc = reqc->params.rwalloc.respc;
+    size_t i;
+
+    /* a single-medium allocation does not wait, it may be backfilled */
+    if (respc->devices_len <= 1)
+        return;
+
+    for (i = 0; i < respc->devices_len; i++) {
+        struct lrs_dev *waiting = respc->devices[i];
+
+        if (!waiting)
+            continue;
+
+        if (waiting != dev)
+            MUTEX_LOCK(&waiting->ld_mutex);
+        waiting->ld_backfill.until = (struct timespec) {0};
+        if (waiting != dev)
+            MUTEX_UNLOCK(&waiting->ld_mutex);
+    }
+}
+
 /**
  * Set sub_request result in request. Called with lock on \p dev.
  *
@@ -1570,9 +2392,13 @@ static void handle_rwalloc_sub_request_result(struct lrs_dev *dev,
 try_send_response:
     ended = is_rwalloc_ended(reqc);
     if (!sub_request_rc && ended) {
+        rwalloc_end_backfill(dev, reqc);
         tsqueue_push(dev->ld_response_queue, reqc->params.rwalloc.respc);
         /* do not free the response in sched_req_free */
         reqc->params.rwalloc.respc = NULL;
+    } else if (!sub_request_rc) {
+        /* the medium waits for the mount of the others */
+        dev->ld_backfill.until = reqc->params.rwalloc.ready_at;
     }
 
 out_free:
@@ -1609,6 +2435,7 @@ int dev_mount(struct lrs_dev *dev)
 {
     struct dss_handle *dss = &dev->ld_device_thread.dss;
     struct fs_adapter_module *fsa;
+    struct timespec start;
     struct pho_log log;
     char *mnt_root;
     const char *id;
@@ -1655,9 +2482,13 @@ int dev_mount(struct lrs_dev *dev)
              dev->ld_dss_dev_info->rsc.id.library,
              mnt_root);
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_fs_mount(fsa, dev->ld_dev_path, mnt_root,
                       dev->ld_dss_media_info->fs.label,
                       &log.message);
+    if (rc == 0)
+        dev_perf_add_op(dev, dev->ld_dss_media_info->rsc.model,
+                        PERF_OP_MOUNT, &start);
     emit_log_after_action(dss, &log, PHO_LTFS_MOUNT, rc);
     if (rc)
         goto out_free;
@@ -1711,8 +2542,12 @@ static int dev_handle_read_write(struct lrs_dev *dev)
     struct sub_request *sub_request = dev->ld_sub_request;
     struct req_container *reqc = sub_request->reqc;
     struct medium_switch_context context = {0};
+    int socket_id = reqc->socket_id;
+    int req_id = reqc->req->id;
     struct media_info *medium_to_alloc;
     bool sub_request_requeued = false;
+    size_t reserved_size = 0;
+    size_t session_size = 0;
     bool io_ended = false;
     bool cancel = false;
     bool locked = false;
@@ -1720,6 +2555,17 @@ static int dev_handle_read_write(struct lrs_dev *dev)
 
     ENTRY;
 
+    /* reqc may be freed once the response is sent, keep what the release of
+     * this client needs
+     */
+    if (pho_request_is_write(reqc->req) &&
+        !reqc_medium_is_source(reqc, sub_request->medium_index)) {
+        reserved_size =
+            reqc->req->walloc->media[sub_request->medium_index]->size;
+        if (reqc->req->walloc->has_session_size)
+            session_size = reqc->req->walloc->session_size;
+    }
+
     if (cancel_subrequest_on_error(sub_request)) {
         io_ended = true;
         goto out_free;
@@ -1759,8 +2605,16 @@ out_free:
     if (!locked)
         MUTEX_LOCK(&dev->ld_mutex);
 
-    if (!io_ended && !sub_request_requeued)
-        dev->ld_ongoing_io = true;
+    if (!io_ended && !sub_request_requeued) {
+        /* A write session may append up to session_size bytes before
+         * releasing the medium, keep them from the other clients.
+         */
+        if (session_size > reserved_size)
+            reserved_size = max(reserved_size,
+                                min(session_size, dev_free_space(dev)));
+
+        dev_client_add(dev, socket_id, req_id, reserved_size);
+    }
 
     dev->ld_sub_request = NULL;
     if (!sub_request_requeued) {
@@ -2018,6 +2872,7 @@ static void dev_thread_end(struct lrs_dev *device)
     }
 
     cancel_pending_format(device);
+    dev_unreserve_medium(device);
 
     if (!device->ld_device_thread.status) {
         int rc = dev_cleanup_medium_at_stop(device);
@@ -2038,7 +2893,11 @@ static void dev_thread_end(struct lrs_dev *device)
     if (device->ld_device_thread.status)
         dev_cleanup_on_error(device);
 
-    device->ld_ongoing_io = false;
+    MUTEX_LOCK(&device->ld_mutex);
+    g_array_set_size(device->ld_clients, 0);
+    device->ld_reserved_size = 0;
+    device->ld_ongoing_io = 0;
+    MUTEX_UNLOCK(&device->ld_mutex);
 }
 
 /**
@@ -2052,6 +2911,7 @@ static void *lrs_dev_thread(void *tdata)
     thread = &device->ld_device_thread;
 
     while (!thread_is_stopped(thread)) {
+        bool backfill_sync;
         int rc = 0;
 
         if (device->ld_sub_request &&
@@ -2074,8 +2934,16 @@ static void *lrs_dev_thread(void *tdata)
             thread->state = THREAD_STOPPED;
         }
 
-        if (!device->ld_ongoing_io) {
-            if (device->ld_needs_sync) {
+        backfill_sync = device->ld_ongoing_io &&
+                        check_backfill_sync(device);
+
+        /* The sub request of a new client of a shared medium is handled
+         * without waiting for the end of the ongoing I/Os, the scheduler only
+         * allocates a busy device to a client of its mounted medium.
+         */
+        if (!device->ld_ongoing_io || device->ld_sub_request || backfill_sync) {
+            if ((!device->ld_ongoing_io || backfill_sync) &&
+                device->ld_needs_sync) {
                 rc = dev_sync(device);
                 if (rc) {
                     const struct pho_id *dev_id = lrs_dev_id(device);
@@ -2117,6 +2985,13 @@ static void *lrs_dev_thread(void *tdata)
             }
         }
 
+        /* The device thread has nothing to do until the current medium is
+         * released: reserve the medium expected next and move it near the
+         * device meanwhile.
+         */
+        if (!device->ld_sub_request && thread_is_running(thread))
+            dev_stage_next_medium(device);
+
         if (!thread_is_stopped(thread)) {
             rc = dev_wait_for_signal(device);
             if (rc < 0) {
@@ -2316,7 +3191,7 @@ static int dev_medium_switch(struct lrs_dev *dev,
         return 0;
     }
 
-    rc = dev_empty(dev);
+    rc = dev_empty_and_stage(dev, medium_to_load);
     if (rc) {
         dev_id = lrs_dev_id(dev);
         context->failure_on_device = true;
@@ -2403,7 +3278,9 @@ static int dev_medium_switch_mount(struct lrs_dev *dev,
      * damaged disks. Mark the media as full, let it be mounted and try to find
      * a new one.
      */
-    if (pho_request_is_write(reqc->req) && !dev_mount_is_writable(dev)) {
+    if (pho_request_is_write(reqc->req) &&
+        !reqc_medium_is_source(reqc, subreq->medium_index) &&
+        !dev_mount_is_writable(dev)) {
         int rc2;
 
         med_id = lrs_dev_med_id(dev);
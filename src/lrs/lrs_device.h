@@ -29,6 +29,7 @@
 #include <pthread.h>
 #include <stdbool.h>
 
+#include "lrs_perf.h"
 #include "lrs_thread.h"
 
 #include "pho_dss.h"
@@ -55,6 +56,34 @@ struct lrs_dev_hdl {
     unsigned long   sync_wsize_kb; /**< Written size threshold for
                                      *  medium synchronization
                                      */
+    unsigned int    max_clients;   /**< Maximum number of clients doing
+                                     *  I/Os on a mounted medium at the
+                                     *  same time
+                                     */
+    struct timespec sync_latency_slo;
+                                   /**< Latency target of the releases to
+                                     *  sync, the thresholds above are then
+                                     *  upper bounds of the thresholds tuned
+                                     *  by each device. 0 if the thresholds
+                                     *  are not tuned.
+                                     */
+    struct timespec sync_time_min; /**< Lower bound of the tuned time
+                                     *  threshold
+                                     */
+    bool            stage_media;   /**< Whether the media expected to be
+                                     *  loaded next are staged near the
+                                     *  devices
+                                     */
+    bool            reserve_media; /**< Whether the media expected to be
+                                     *  loaded next are reserved in the DSS
+                                     */
+    bool            backfill;      /**< Whether the devices waiting for the
+                                     *  other media of an allocation handle
+                                     *  short requests meanwhile
+                                     */
+    struct perf_models perf_models; /**< Durations of the operations and
+                                      *  throughput learnt per medium model
+                                      */
 };
 
 /** Request pushed to a device */
@@ -184,6 +213,119 @@ struct sync_params {
                                     /**< total number of extents written in
                                      *   \p tosync_array
                                      */
+    struct timespec  sync_time;     /**< time threshold in use */
+    unsigned int     sync_nb_req;   /**< number of requests threshold in use */
+    unsigned long    sync_wsize;    /**< written size threshold in use */
+    double           sync_cost_ms;  /**< average duration of a sync */
+    double           release_interval_ms;
+                                    /**< average time between the arrivals of
+                                     *   two release requests to sync
+                                     */
+    double           release_size;  /**< average size of a release request */
+    struct timespec  last_release;  /**< arrival of the last release request
+                                      *  to sync
+                                      */
+    unsigned long    sync_count;    /**< number of syncs done */
+    double           sync_total_ms; /**< time spent in syncs */
+    double           queue_delay_ms;/**< average time the oldest release
+                                     *   request waited for its sync
+                                     */
+};
+
+/**
+ * Set the sync thresholds of a device from the configured ones and, if the
+ * family has a latency target, from the measurements of \p params.
+ *
+ * The time threshold leaves the average sync duration within the latency
+ * target, but does not go below this duration so that the device does not
+ * spend most of its time syncing, nor below the configured lower bound of the
+ * family. The number of requests and written size thresholds are what is
+ * expected to be released during this time at the measured arrival rate. The
+ * configured thresholds are upper bounds.
+ *
+ * @param[in]       handle  Handle of the devices of the family
+ * @param[in,out]   params  Sync parameters of a device
+ */
+void sync_thresholds_update(const struct lrs_dev_hdl *handle,
+                            struct sync_params *params);
+
+/**
+ * Speculative staging of the medium a device is expected to load next.
+ *
+ * The medium is moved to the free slot nearest to the device while the device
+ * is busy, so that only the short move from this slot remains when it is
+ * loaded. Protected by lrs_dev::ld_mutex.
+ */
+struct stage_params {
+    struct pho_id   next_medium;   /**< medium to stage, as hinted by the
+                                     *  scheduler, empty name if none
+                                     */
+    struct pho_id   staged_medium; /**< medium staged near the device, empty
+                                     *  name if none
+                                     */
+    struct pho_id   reserved_medium;
+                                   /**< medium reserved in the DSS for the
+                                     *  device, empty name if none
+                                     */
+    struct timespec reserved_at;   /**< time of the last reservation of
+                                     *  \p reserved_medium
+                                     */
+    double          staged_ms;     /**< duration of the staging of
+                                     *  \p staged_medium, hidden from its
+                                     *  load
+                                     */
+    unsigned long   stage_count;   /**< number of media staged */
+    unsigned long   stage_hits;    /**< number of loads of a staged medium */
+    double          hidden_ms;     /**< mount latency hidden by the staging */
+};
+
+/**
+ * Hint the device thread of \p dev that \p medium_id is expected to be loaded
+ * next into \p dev, so that it is staged near it while its current medium is
+ * in use, and reserved in the DSS with its expected mount time. Does nothing if
+ * the family of \p dev neither stages nor reserves its media.
+ *
+ * A medium hinted again keeps its reservation refreshed, with an up to date
+ * expected mount time, so that it is not taken over once this time is past.
+ *
+ * @param[in]   dev         Device
+ * @param[in]   medium_id   Medium expected to be loaded next into \p dev
+ */
+void dev_stage_hint(struct lrs_dev *dev, const struct pho_id *medium_id);
+
+/**
+ * Backfilling of a device whose medium is mounted for a multi-medium
+ * allocation, while the other media of this allocation are being mounted.
+ *
+ * Until the expected mount of the other media, the device accepts the short
+ * requests on its medium whose estimated duration ends before it. Protected by
+ * lrs_dev::ld_mutex.
+ */
+struct backfill_params {
+    struct timespec until;         /**< expected mount of the other media of
+                                     *  the allocation, 0 if the device does
+                                     *  not wait
+                                     */
+    unsigned long   count;         /**< number of requests and syncs
+                                     *  backfilled
+                                     */
+    double          recovered_ms;  /**< estimated idle time used by the
+                                     *  backfilled requests and syncs
+                                     */
+};
+
+/** Client doing I/Os on the medium of a device */
+struct dev_client {
+    int             socket_id;     /**< socket of the client, as given by its
+                                     *  requests
+                                     */
+    int             req_id;        /**< id of the allocation request, shared
+                                     *  by its release
+                                     */
+    size_t          reserved_size; /**< space reserved for the writes of the
+                                     *  client
+                                     */
+    struct timespec since;         /**< allocation time of the medium */
 };
 
 /**
@@ -253,7 +395,20 @@ struct lrs_dev {
     bool                 ld_ongoing_scheduled;  /**< one I/O is going to be
                                                   *  scheduled
                                                   */
-    bool                 ld_ongoing_io;         /**< one I/O is ongoing */
+    unsigned int         ld_ongoing_io;         /**< number of ongoing I/Os,
+                                                  *  one per client in
+                                                  *  ld_clients
+                                                  */
+    unsigned int         ld_max_clients;        /**< maximum number of
+                                                  *  ongoing I/Os on the
+                                                  *  mounted medium
+                                                  */
+    GArray              *ld_clients;            /**< struct dev_client of the
+                                                  *  ongoing I/Os
+                                                  */
+    size_t               ld_reserved_size;      /**< space of the medium
+                                                  *  reserved by the clients
+                                                  */
     bool                 ld_needs_sync;         /**< medium needs to be sync */
     struct thread_info   ld_device_thread;      /**< thread handling the actions
                                                   * executed on the device
@@ -261,6 +416,18 @@ struct lrs_dev {
     struct sync_params   ld_sync_params;        /**< pending synchronization
                                                   * requests
                                                   */
+    struct stage_params  ld_stage_params;       /**< staging of the medium
+                                                  * to load next
+                                                  */
+    struct backfill_params ld_backfill;         /**< short requests accepted
+                                                  * while waiting for the
+                                                  * other media of an
+                                                  * allocation
+                                                  */
+    struct perf_model    ld_perf;               /**< durations of the
+                                                  * operations and throughput
+                                                  * learnt on this device
+                                                  */
     struct tsqueue      *ld_response_queue;     /**< reference to the response
                                                   * queue
                                                   */
@@ -280,6 +447,12 @@ struct lrs_dev {
          * have access to this device. Modified by
          * io_sched_handle::dispatch_devices.
          */
+    bool                 ld_qos_reserved;
+    enum pho_qos_class   ld_qos_class;
+        /**< If ld_qos_reserved is set, only the requests of ld_qos_class can
+         * be allocated this device. Modified by
+         * io_sched_handle::dispatch_devices.
+         */
     int                  ld_last_client_rc;     /**< last I/O error of a client
                                                   *  sent on release.
                                                   */
@@ -330,12 +503,55 @@ static inline bool dev_is_sched_ready(struct lrs_dev *dev)
            (dev->ld_dss_dev_info->rsc.adm_status == PHO_RSC_ADM_ST_UNLOCKED);
 }
 
+/**
+ * Whether a device busy with the I/Os of some clients can be allocated to one
+ * more client of its mounted medium.
+ *
+ * Only the families configured with several clients per medium share their
+ * media, see lrs_dev_hdl::max_clients.
+ */
+static inline bool dev_is_shareable(struct lrs_dev *dev)
+{
+    return dev && thread_is_running(&dev->ld_device_thread) &&
+           dev->ld_ongoing_io > 0 &&
+           dev->ld_ongoing_io < dev->ld_max_clients &&
+           dev_is_mounted(dev) && !dev->ld_needs_sync &&
+           !dev->ld_sub_request && !dev->ld_ongoing_scheduled &&
+           (dev->ld_dss_dev_info->rsc.adm_status == PHO_RSC_ADM_ST_UNLOCKED);
+}
+
+/**
+ * Space of the loaded medium of \p dev which is not reserved by the ongoing
+ * writes.
+ *
+ * Must be called with the device lock held.
+ */
+static inline size_t dev_free_space(struct lrs_dev *dev)
+{
+    ssize_t free_space = dev->ld_dss_media_info->stats.phys_spc_free;
+
+    if (free_space < 0 || (size_t) free_space <= dev->ld_reserved_size)
+        return 0;
+
+    return free_space - dev->ld_reserved_size;
+}
+
 static inline bool dev_is_online(struct lrs_dev *dev)
 {
     return dev && thread_is_running(&dev->ld_device_thread) &&
         (dev->ld_dss_dev_info->rsc.adm_status == PHO_RSC_ADM_ST_UNLOCKED);
 }
 
+/**
+ * Whether a request of class \p qos can be allocated \p dev, i.e. \p dev is
+ * not reserved to another class.
+ */
+static inline bool dev_is_qos_allowed(struct lrs_dev *dev,
+                                      enum pho_qos_class qos)
+{
+    return !dev->ld_qos_reserved || dev->ld_qos_class == qos;
+}
+
 static inline bool is_device_shared_between_schedulers(struct lrs_dev *dev)
 {
     return __builtin_popcount(dev->ld_io_request_type & 0b111) != 0;
@@ -351,6 +567,92 @@ static inline bool is_device_shared_between_schedulers(struct lrs_dev *dev)
 void push_new_sync_to_device(struct lrs_dev *dev, struct req_container *reqc,
                              size_t medium_index);
 
+/**
+ * Register a new client of the medium of a device, once its allocation is
+ * granted, and reserve \p reserved_size bytes of the medium for its writes.
+ *
+ * Must be called with the device lock held.
+ */
+void dev_client_add(struct lrs_dev *dev, int socket_id, int req_id,
+                    size_t reserved_size);
+
+/**
+ * Unregister a client of the medium of a device, on release or cancellation
+ * of its allocation, and free the space it reserved.
+ *
+ * The client is identified by its socket and the id of its allocation
+ * request, which its release shares. Nothing is done if no such client uses
+ * the device.
+ *
+ * The throughput of the device is learnt from \p written_size, the number of
+ * bytes written by the client since its allocation, if not 0.
+ *
+ * Must be called with the device lock held.
+ */
+void dev_client_remove(struct lrs_dev *dev, int socket_id, int req_id,
+                       size_t written_size);
+
+/**
+ * Estimated duration of an operation on a device, in milliseconds.
+ *
+ * The measurements of the device are used first, then those of the media of
+ * model \p medium_model and lastly those of all the devices of the handle.
+ *
+ * \param[in]   dev           Device
+ * \param[in]   medium_model  Model of the medium concerned, may be NULL
+ * \param[in]   op            Operation
+ *
+ * \return                    The estimated duration, 0 if unknown
+ */
+double dev_perf_op_ms(struct lrs_dev *dev, const char *medium_model,
+                      enum perf_op op);
+
+/**
+ * Estimated duration of the transfer of \p size bytes by a device, in
+ * milliseconds, 0 if unknown.
+ */
+double dev_perf_transfer_ms(struct lrs_dev *dev, const char *medium_model,
+                            size_t size);
+
+/**
+ * Estimated duration to mount a new medium on a device from its current state,
+ * in milliseconds: unmount and unload its medium if any, then load and mount
+ * the new one.
+ */
+double dev_switch_ms(struct lrs_dev *dev);
+
+/**
+ * Estimated time before a device completes its ongoing work, in milliseconds:
+ * the writes of its clients, the pending synchronization and the medium switch
+ * of its sub request.
+ *
+ * Must be called with the device lock held.
+ */
+double dev_eta_ms(struct lrs_dev *dev);
+
+/**
+ * Whether a device waiting for the other media of a multi-medium allocation
+ * can handle the transfer of \p size bytes on its mounted medium before their
+ * expected mount.
+ *
+ * Must be called with the device lock held.
+ *
+ * \param[in]   dev    Device
+ * \param[in]   size   Size of the transfer
+ *
+ * \return             The estimated duration of the transfer in milliseconds
+ *                     if it can be backfilled, 0 otherwise
+ */
+double dev_backfill_ms(struct lrs_dev *dev, size_t size);
+
+/**
+ * Record that a request of an estimated duration of \p duration_ms was
+ * backfilled on \p dev.
+ *
+ * Must be called with the device lock held.
+ */
+void dev_backfill_account(struct lrs_dev *dev, double duration_ms);
+
 /**
  * Synchronize the medium of a device
  *
@@ -0,0 +1,179 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS performance model of the device operations
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lrs_perf.h"
+#include "pho_common.h"
+
+/* weight of a new measurement in the moving averages */
+#define PERF_EWMA_WEIGHT 0.25
+
+static const char * const perf_op_names[] = {
+    [PERF_OP_LOAD]   = "load",
+    [PERF_OP_UNLOAD] = "unload",
+    [PERF_OP_MOUNT]  = "mount",
+    [PERF_OP_UMOUNT] = "umount",
+    [PERF_OP_SYNC]   = "sync",
+};
+
+const char *perf_op2str(enum perf_op op)
+{
+    if (op < 0 || op >= PERF_OP_LAST)
+        return NULL;
+
+    return perf_op_names[op];
+}
+
+static inline double ewma(double average, double sample)
+{
+    if (average == 0)
+        return sample;
+
+    return average + PERF_EWMA_WEIGHT * (sample - average);
+}
+
+void perf_model_init(struct perf_model *model)
+{
+    memset(model, 0, sizeof(*model));
+    pthread_mutex_init(&model->mutex, NULL);
+}
+
+void perf_model_fini(struct perf_model *model)
+{
+    pthread_mutex_destroy(&model->mutex);
+}
+
+void perf_model_add_op(struct perf_model *model, enum perf_op op,
+                       double duration_ms)
+{
+    if (duration_ms <= 0)
+        return;
+
+    MUTEX_LOCK(&model->mutex);
+    model->op_ms[op] = ewma(model->op_ms[op], duration_ms);
+    model->op_count[op]++;
+    MUTEX_UNLOCK(&model->mutex);
+}
+
+void perf_model_add_transfer(struct perf_model *model, size_t size,
+                             double duration_ms)
+{
+    if (size == 0 || duration_ms <= 0)
+        return;
+
+    MUTEX_LOCK(&model->mutex);
+    model->bytes_per_ms = ewma(model->bytes_per_ms, size / duration_ms);
+    model->transfer_count++;
+    MUTEX_UNLOCK(&model->mutex);
+}
+
+double perf_model_op_ms(struct perf_model *model, enum perf_op op)
+{
+    double duration_ms;
+
+    MUTEX_LOCK(&model->mutex);
+    duration_ms = model->op_ms[op];
+    MUTEX_UNLOCK(&model->mutex);
+
+    return duration_ms;
+}
+
+double perf_model_bytes_per_ms(struct perf_model *model)
+{
+    double bytes_per_ms;
+
+    MUTEX_LOCK(&model->mutex);
+    bytes_per_ms = model->bytes_per_ms;
+    MUTEX_UNLOCK(&model->mutex);
+
+    return bytes_per_ms;
+}
+
+double perf_model_transfer_ms(struct perf_model *model, size_t size)
+{
+    double bytes_per_ms = perf_model_bytes_per_ms(model);
+
+    if (bytes_per_ms == 0)
+        return 0;
+
+    return size / bytes_per_ms;
+}
+
+static void perf_model_free(gpointer model)
+{
+    perf_model_fini(model);
+    free(model);
+}
+
+int perf_models_init(struct perf_models *models)
+{
+    int rc;
+
+    rc = pthread_mutex_init(&models->mutex, NULL);
+    if (rc)
+        LOG_RETURN(-rc, "Unable to init the perf models mutex");
+
+    models->models = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+                                           perf_model_free);
+    perf_model_init(&models->all);
+
+    return 0;
+}
+
+void perf_models_fini(struct perf_models *models)
+{
+    if (!models->models)
+        return;
+
+    g_hash_table_destroy(models->models);
+    models->models = NULL;
+    perf_model_fini(&models->all);
+    pthread_mutex_destroy(&models->mutex);
+}
+
+struct perf_model *perf_models_get(struct perf_models *models,
+                                   const char *medium_model)
+{
+    struct perf_model *model;
+
+    if (!medium_model)
+        medium_model = "";
+
+    MUTEX_LOCK(&models->mutex);
+    model = g_hash_table_lookup(models->models, medium_model);
+    if (!model) {
+        model = xmalloc(sizeof(*model));
+        perf_model_init(model);
+        g_hash_table_insert(models->models, xstrdup(medium_model), model);
+    }
+    MUTEX_UNLOCK(&models->mutex);
+
+    return model;
+}
@@ -0,0 +1,122 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS performance model of the device operations
+ *
+ * The durations of the operations done by the device threads and the
+ * throughput of the clients are learnt online, per device and per medium
+ * model, so that the scheduler can estimate when a request would complete.
+ */
+#ifndef _PHO_LRS_PERF_H
+#define _PHO_LRS_PERF_H
+
+#include <glib.h>
+#include <pthread.h>
+#include <stddef.h>
+
+/** Operations of a device whose duration is learnt */
+enum perf_op {
+    PERF_OP_LOAD,
+    PERF_OP_UNLOAD,
+    PERF_OP_MOUNT,
+    PERF_OP_UMOUNT,
+    PERF_OP_SYNC,
+    PERF_OP_LAST,
+};
+
+const char *perf_op2str(enum perf_op op);
+
+/**
+ * Moving averages of the durations of the operations and of the throughput.
+ *
+ * A value of 0 means that nothing was measured yet.
+ */
+struct perf_model {
+    pthread_mutex_t mutex;
+    double          op_ms[PERF_OP_LAST]; /**< duration of each operation */
+    unsigned long   op_count[PERF_OP_LAST];
+                                         /**< number of measurements of
+                                           *  each operation
+                                           */
+    double          bytes_per_ms;        /**< throughput of the clients */
+    unsigned long   transfer_count;      /**< number of measurements of
+                                           *  the throughput
+                                           */
+};
+
+/** Performance models of the media models, and of all the media */
+struct perf_models {
+    pthread_mutex_t   mutex;  /**< protects models */
+    GHashTable       *models; /**< medium model -> struct perf_model */
+    struct perf_model all;    /**< measurements of every medium model */
+};
+
+void perf_model_init(struct perf_model *model);
+
+void perf_model_fini(struct perf_model *model);
+
+/**
+ * Record that \p op took \p duration_ms milliseconds
+ */
+void perf_model_add_op(struct perf_model *model, enum perf_op op,
+                       double duration_ms);
+
+/**
+ * Record that a client transferred \p size bytes in \p duration_ms
+ * milliseconds
+ */
+void perf_model_add_transfer(struct perf_model *model, size_t size,
+                             double duration_ms);
+
+/**
+ * Estimated duration of \p op in milliseconds, 0 if unknown.
+ */
+double perf_model_op_ms(struct perf_model *model, enum perf_op op);
+
+/**
+ * Estimated duration of the transfer of \p size bytes in milliseconds, 0 if
+ * unknown.
+ */
+double perf_model_transfer_ms(struct perf_model *model, size_t size);
+
+/**
+ * Throughput of the clients in bytes per millisecond, 0 if unknown.
+ */
+double perf_model_bytes_per_ms(struct perf_model *model);
+
+int perf_models_init(struct perf_models *models);
+
+void perf_models_fini(struct perf_models *models);
+
+/**
+ * Get the performance model of the media of model \p medium_model, created on
+ * first use. It remains valid until perf_models_fini is called.
+ *
+ * \param[in]  models        Performance models
+ * \param[in]  medium_model  Model of the media, may be NULL
+ *
+ * \return                   The performance model of \p medium_model
+ */
+struct perf_model *perf_models_get(struct perf_models *models,
+                                   const char *medium_model);
+
+#endif
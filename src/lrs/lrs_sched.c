@@ -114,6 +114,143 @@ void format_medium_remove(struct format_media *format_media,
     pthread_mutex_unlock(&format_media->mutex);
 }
 
+static bool format_medium_contains(struct format_media *format_media,
+                                   const struct pho_id *medium_id)
+{
+    bool found;
+
+    pthread_mutex_lock(&format_media->mutex);
+    found = g_hash_table_contains(format_media->media, medium_id);
+    pthread_mutex_unlock(&format_media->mutex);
+
+    return found;
+}
+
+/* Period of the count of the formatted media for the background format */
+#define AUTO_FORMAT_CHECK_INTERVAL_S 60
+
+/* Longest delay before formatting again a medium whose format failed */
+#define AUTO_FORMAT_MAX_RETRY_DELAY_S (24 * 3600)
+
+/* Retries of the background format of a blank medium */
+struct auto_format_retry {
+    unsigned int    attempts; /* number of background formats which ended */
+    struct timespec next;     /* date before which it is not formatted again */
+};
+
+int auto_format_init(struct auto_format *auto_format, enum rsc_family family)
+{
+    int rc;
+
+    rc = get_cfg_format_low_watermark_value(family,
+                                            &auto_format->low_watermark);
+    if (rc)
+        LOG_RETURN(rc, "Invalid format_low_watermark for family '%s'",
+                   rsc_family2str(family));
+
+    rc = format_media_init(&auto_format->media);
+    if (rc)
+        return rc;
+
+    auto_format->pending = g_queue_new();
+    auto_format->retries = g_hash_table_new_full(g_pho_id_hash, g_pho_id_equal,
+                                                 free, free);
+    auto_format->next_check.tv_sec = 0;
+    auto_format->next_check.tv_nsec = 0;
+
+    return 0;
+}
+
+void auto_format_clean(struct auto_format *auto_format)
+{
+    /* freeing the pending requests removes their media from the table */
+    g_queue_free_full(auto_format->pending, sched_req_free);
+    auto_format->pending = NULL;
+    g_hash_table_unref(auto_format->retries);
+    auto_format->retries = NULL;
+    format_media_clean(&auto_format->media);
+}
+
+void auto_format_end(struct req_container *reqc)
+{
+    struct auto_format *auto_format = reqc->params.format.auto_format;
+    pho_rsc_id_t *med_id = reqc->req->format->med_id;
+    struct auto_format_retry *retry;
+    struct timespec delay = {0};
+    struct pho_id medium_id;
+    struct timespec now;
+    unsigned int i;
+
+    medium_id.family = (enum rsc_family)med_id->family;
+    pho_id_name_set(&medium_id, med_id->name, med_id->library);
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    pthread_mutex_lock(&auto_format->media.mutex);
+    g_hash_table_remove(auto_format->media.media, &medium_id);
+
+    /* only matters if the medium is still blank at the next check, the
+     * delay doubles with each failed format
+     */
+    retry = g_hash_table_lookup(auto_format->retries, &medium_id);
+    if (!retry) {
+        retry = xcalloc(1, sizeof(*retry));
+        g_hash_table_insert(auto_format->retries, pho_id_dup(&medium_id),
+                            retry);
+    }
+
+    delay.tv_sec = AUTO_FORMAT_CHECK_INTERVAL_S;
+    for (i = 0; i < retry->attempts &&
+                delay.tv_sec < AUTO_FORMAT_MAX_RETRY_DELAY_S; i++)
+        delay.tv_sec *= 2;
+    delay.tv_sec = min(delay.tv_sec, (time_t)AUTO_FORMAT_MAX_RETRY_DELAY_S);
+
+    retry->attempts++;
+    retry->next = add_timespec(&now, &delay);
+    pthread_mutex_unlock(&auto_format->media.mutex);
+}
+
+bool auto_format_retry_due(struct auto_format *auto_format,
+                           const struct pho_id *medium,
+                           const struct timespec *now)
+{
+    struct auto_format_retry *retry;
+    bool due;
+
+    pthread_mutex_lock(&auto_format->media.mutex);
+    retry = g_hash_table_lookup(auto_format->retries, medium);
+    due = !retry || cmp_timespec(now, &retry->next) >= 0;
+    pthread_mutex_unlock(&auto_format->media.mutex);
+
+    return due;
+}
+
+static gboolean auto_format_retry_is_stale(gpointer key, gpointer value,
+                                           gpointer blank_ids)
+{
+    (void) value;
+
+    return !g_hash_table_contains(blank_ids, key);
+}
+
+/* Forget the retries of the media which are not blank anymore */
+static void auto_format_retries_prune(struct auto_format *auto_format,
+                                      struct media_info *blank, int n_blank)
+{
+    GHashTable *blank_ids;
+    int i;
+
+    blank_ids = g_hash_table_new(g_pho_id_hash, g_pho_id_equal);
+    for (i = 0; i < n_blank; i++)
+        g_hash_table_add(blank_ids, &blank[i].rsc.id);
+
+    pthread_mutex_lock(&auto_format->media.mutex);
+    g_hash_table_foreach_remove(auto_format->retries,
+                                auto_format_retry_is_stale, blank_ids);
+    pthread_mutex_unlock(&auto_format->media.mutex);
+
+    g_hash_table_destroy(blank_ids);
+}
+
 void sched_req_free(void *reqc)
 {
     struct req_container *cont = (struct req_container *)reqc;
@@ -682,9 +819,14 @@ int sched_init(struct lrs_sched *sched, enum rsc_family family,
     if (rc)
         LOG_GOTO(err_clean_cache, rc,  "Failed to init sched format media");
 
+    rc = auto_format_init(&sched->auto_format, family);
+    if (rc)
+        LOG_GOTO(err_format_media, rc,
+                 "Failed to init sched background format");
+
     rc = lrs_dev_hdl_init(&sched->devices, family);
     if (rc)
-        LOG_GOTO(err_format_media, rc, "Failed to initialize device handle");
+        LOG_GOTO(err_auto_format, rc, "Failed to initialize device handle");
 
     /* Connect to the DSS */
     rc = dss_init(&sched->sched_thread.dss);
@@ -747,6 +889,8 @@ err_dss_fini:
     dss_fini(&sched->sched_thread.dss);
 err_hdl_fini:
     lrs_dev_hdl_fini(&sched->devices);
+err_auto_format:
+    auto_format_clean(&sched->auto_format);
 err_format_media:
     format_media_clean(&sched->ongoing_format);
 err_clean_cache:
@@ -830,6 +974,7 @@ void sched_fini(struct lrs_sched *sched)
     dss_fini(&sched->sched_thread.dss);
     tsqueue_destroy(&sched->incoming, sched_req_free);
     tsqueue_destroy(&sched->retry_queue, sub_request_free_cb);
+    auto_format_clean(&sched->auto_format);
     format_media_clean(&sched->ongoing_format);
     lrs_cache_cleanup(sched->family);
 }
@@ -1016,6 +1161,8 @@ int sched_select_medium(struct io_scheduler *io_sched,
 {
     struct lock_handle *lock_handle = io_sched->io_sched_hdl->lock_handle;
     bool with_tags = tags != NULL && tags->n_tags > 0;
+    const char *grouping = reqc->req->walloc->grouping;
+    struct media_info *grouping_media_best = NULL;
     struct media_info *split_media_best = NULL;
     struct media_info *whole_media_best = NULL;
     struct media_info *chosen_media = NULL;
@@ -1113,13 +1260,13 @@ int sched_select_medium(struct io_scheduler *io_sched,
         bool already_alloc;
         bool sched_ready;
 
-        /* exclude medium already booked for this allocation */
+        /* exclude media already booked for or excluded by this allocation */
         rc = medium_in_devices(curr, reqc, n_med, not_alloc, &already_alloc);
         if (rc)
             LOG_GOTO(free_res, rc = -EAGAIN,
                      "Unable to test if medium is already alloc");
 
-        if (already_alloc)
+        if (already_alloc || reqc_is_excluded_medium(reqc, &curr->rsc.id))
             continue;
 
         avail_size += curr->stats.phys_spc_free;
@@ -1160,6 +1307,13 @@ int sched_select_medium(struct io_scheduler *io_sched,
         if (whole_media_best == NULL ||
             curr->stats.phys_spc_free < whole_media_best->stats.phys_spc_free)
             whole_media_best = curr;
+
+        /* collocate the objects of a same grouping */
+        if (grouping && tag_exists(&curr->groupings, grouping) &&
+            (grouping_media_best == NULL ||
+             curr->stats.phys_spc_free <
+                grouping_media_best->stats.phys_spc_free))
+            grouping_media_best = curr;
     }
 
     if (avail_size < required_size) {
@@ -1168,7 +1322,11 @@ int sched_select_medium(struct io_scheduler *io_sched,
         GOTO(free_res, rc = -ENOSPC);
     }
 
-    if (whole_media_best != NULL) {
+    if (grouping_media_best != NULL) {
+        chosen_media = grouping_media_best;
+        pho_debug("Medium '%s' already holds grouping '%s'",
+                  chosen_media->rsc.id.name, grouping);
+    } else if (whole_media_best != NULL) {
         chosen_media = whole_media_best;
     } else if (split_media_best != NULL) {
         chosen_media = split_media_best;
@@ -1274,6 +1432,8 @@ typedef int (*device_select_func_t)(size_t required_size,
  * @param op_st   Filter devices by the given operational status.
  *                No filtering is op_st is PHO_DEV_OP_ST_UNSPEC.
  * @param library        If set, selected device must be from library
+ * @param qos            QoS class of the request, the devices reserved to
+ *                       another class are skipped
  * @param select_func    Drive selection function.
  * @param required_size  Required size for the operation.
  * @param media_tags     Mandatory tags for the contained media (for write
@@ -1289,6 +1449,7 @@ typedef int (*device_select_func_t)(size_t required_size,
 struct lrs_dev *dev_picker(GPtrArray *devices,
                            enum dev_op_status op_st,
                            const char *library,
+                           enum pho_qos_class qos,
                            device_select_func_t select_func,
                            size_t required_size,
                            const struct tags *media_tags,
@@ -1311,7 +1472,12 @@ struct lrs_dev *dev_picker(GPtrArray *devices,
         struct lrs_dev *prev = selected;
 
         MUTEX_LOCK(&itr->ld_mutex);
-        if (itr->ld_ongoing_io || itr->ld_needs_sync || itr->ld_sub_request ||
+        /* a device with ongoing I/Os can only take one more writer of its
+         * mounted medium
+         */
+        if ((itr->ld_ongoing_io &&
+             (pmedia || !is_write || !dev_is_shareable(itr))) ||
+            itr->ld_needs_sync || itr->ld_sub_request ||
             itr->ld_ongoing_scheduled) {
             pho_debug("Skipping busy device '%s'", itr->ld_dev_path);
             goto unlock_continue;
@@ -1330,6 +1496,12 @@ struct lrs_dev *dev_picker(GPtrArray *devices,
             goto unlock_continue;
         }
 
+        if (!dev_is_qos_allowed(itr, qos)) {
+            pho_debug("Skipping device '%s' reserved to %s requests",
+                      itr->ld_dev_path, qos_class2str(itr->ld_qos_class));
+            goto unlock_continue;
+        }
+
         if (one_drive_available)
             *one_drive_available = true;
 
@@ -1405,6 +1577,81 @@ unlock_continue:
     return selected;
 }
 
+struct lrs_dev *grouping_dev_picker(GPtrArray *devices,
+                                    enum dev_op_status op_st,
+                                    const char *library,
+                                    enum pho_qos_class qos,
+                                    const char *grouping,
+                                    device_select_func_t select_func,
+                                    size_t required_size,
+                                    const struct tags *media_tags,
+                                    bool empty_medium)
+{
+    GPtrArray *stream_devices;
+    struct lrs_dev *selected;
+    int i;
+
+    ENTRY;
+
+    if (!grouping || empty_medium)
+        return NULL;
+
+    stream_devices = g_ptr_array_new();
+    for (i = 0; i < devices->len; i++) {
+        struct lrs_dev *itr = g_ptr_array_index(devices, i);
+
+        MUTEX_LOCK(&itr->ld_mutex);
+        if (itr->ld_dss_media_info &&
+            tag_exists(&itr->ld_dss_media_info->groupings, grouping))
+            g_ptr_array_add(stream_devices, itr);
+        MUTEX_UNLOCK(&itr->ld_mutex);
+    }
+
+    selected = NULL;
+    if (stream_devices->len > 0)
+        selected = dev_picker(stream_devices, op_st, library, qos,
+                              select_func, required_size, media_tags, NULL,
+                              true, false, NULL);
+
+    g_ptr_array_free(stream_devices, true);
+
+    return selected;
+}
+
+struct lrs_dev *backfill_dev_picker(GPtrArray *devices,
+                                    const char *library,
+                                    enum pho_qos_class qos,
+                                    size_t required_size,
+                                    const struct tags *media_tags,
+                                    bool empty_medium)
+{
+    struct lrs_dev *selected = NULL;
+    int i;
+
+    ENTRY;
+
+    for (i = 0; i < devices->len && !selected; i++) {
+        struct lrs_dev *itr = g_ptr_array_index(devices, i);
+
+        MUTEX_LOCK(&itr->ld_mutex);
+        if (dev_backfill_ms(itr, required_size) > 0 &&
+            dev_is_qos_allowed(itr, qos) &&
+            (!library ||
+             !strcmp(library, itr->ld_dss_dev_info->rsc.id.library)) &&
+            medium_is_write_compatible(itr->ld_dss_media_info, media_tags,
+                                       empty_medium) &&
+            dev_free_space(itr) >= required_size)
+            selected = itr;
+        MUTEX_UNLOCK(&itr->ld_mutex);
+    }
+
+    if (selected)
+        pho_debug("backfill: picked device '%s' waiting for an allocation",
+                  selected->ld_dev_path);
+
+    return selected;
+}
+
 /**
  * Get the first device with enough space.
  * @retval 0 to stop searching for a device
@@ -1419,7 +1666,7 @@ int select_first_fit(size_t required_size,
     if (dev_curr->ld_dss_media_info == NULL)
         return 1;
 
-    if (dev_curr->ld_dss_media_info->stats.phys_spc_free >= required_size) {
+    if (dev_free_space(dev_curr) >= required_size) {
         *dev_selected = dev_curr;
         return 0;
     }
@@ -1440,16 +1687,15 @@ static int select_best_fit(size_t required_size,
         return 1;
 
     /* does it fit? */
-    if (dev_curr->ld_dss_media_info->stats.phys_spc_free < required_size)
+    if (dev_free_space(dev_curr) < required_size)
         return 1;
 
     /* no previous fit, or better fit */
     if (*dev_selected == NULL ||
-        (dev_curr->ld_dss_media_info->stats.phys_spc_free <
-         (*dev_selected)->ld_dss_media_info->stats.phys_spc_free)) {
+        dev_free_space(dev_curr) < dev_free_space(*dev_selected)) {
         *dev_selected = dev_curr;
 
-        if (required_size == dev_curr->ld_dss_media_info->stats.phys_spc_free)
+        if (required_size == dev_free_space(dev_curr))
             /* exact match, stop searching */
             return 0;
     }
@@ -1479,6 +1725,51 @@ int select_empty_loaded_mount(size_t required_size,
     return 1;
 }
 
+/* Rank of the status of a device: empty first, then loaded, lastly mounted */
+static int dev_status_rank(struct lrs_dev *dev)
+{
+    if (dev_is_empty(dev))
+        return 0;
+    if (dev_is_loaded(dev))
+        return 1;
+    return 2;
+}
+
+/* Estimated time for a device to mount a new medium and write \p size bytes */
+static double dev_completion_ms(struct lrs_dev *dev, size_t size)
+{
+    return dev_switch_ms(dev) + dev_perf_transfer_ms(dev, NULL, size);
+}
+
+/**
+ * Select the device that would complete the request the earliest, from the
+ * durations of the operations learnt on each device. The devices are selected
+ * as in select_empty_loaded_mount if their durations are equal or unknown.
+ *
+ * @return 1 to evaluate every device.
+ */
+int select_earliest_completion(size_t required_size,
+                               struct lrs_dev *dev_curr,
+                               struct lrs_dev **dev_selected)
+{
+    double selected_ms;
+    double curr_ms;
+
+    if (*dev_selected == NULL) {
+        *dev_selected = dev_curr;
+        return 1;
+    }
+
+    curr_ms = dev_completion_ms(dev_curr, required_size);
+    selected_ms = dev_completion_ms(*dev_selected, required_size);
+    if (curr_ms < selected_ms ||
+        (curr_ms == selected_ms &&
+         dev_status_rank(dev_curr) < dev_status_rank(*dev_selected)))
+        *dev_selected = dev_curr;
+
+    return 1;
+}
+
 /** return the device policy function depending on configuration */
 device_select_func_t get_dev_policy(void)
 {
@@ -1715,6 +2006,36 @@ static int sched_device_unlock(struct lrs_sched *sched, const char *name,
     return sched_device_add(sched, sched->family, name, library);
 }
 
+/**
+ * Set the time at which all the media of \p reqc are expected to be mounted:
+ * the response waits for the slowest device to mount its medium.
+ */
+static void rwalloc_set_ready_at(struct req_container *reqc)
+{
+    struct lrs_dev **devices = reqc->params.rwalloc.respc->devices;
+    size_t devices_len = reqc->params.rwalloc.respc->devices_len;
+    struct timespec wait;
+    struct timespec now;
+    double switch_ms = 0;
+    size_t i;
+
+    for (i = 0; i < devices_len; i++) {
+        struct media_info *medium = reqc->params.rwalloc.media[i].alloc_medium;
+        struct lrs_dev *dev = devices[i];
+
+        MUTEX_LOCK(&dev->ld_mutex);
+        if (!dev_is_mounted(dev) || !dev->ld_dss_media_info ||
+            !pho_id_equal(&dev->ld_dss_media_info->rsc.id, &medium->rsc.id))
+            switch_ms = max(switch_ms, dev_switch_ms(dev));
+        MUTEX_UNLOCK(&dev->ld_mutex);
+    }
+
+    wait.tv_sec = switch_ms / 1000;
+    wait.tv_nsec = ((long) switch_ms % 1000) * 1000000;
+    clock_gettime(CLOCK_REALTIME, &now);
+    reqc->params.rwalloc.ready_at = add_timespec(&now, &wait);
+}
+
 /** remove written_size from phys_spc_free in media_info and DSS */
 static void push_sub_request_to_device(struct req_container *reqc)
 {
@@ -1733,6 +2054,9 @@ static void push_sub_request_to_device(struct req_container *reqc)
         sub_requests[i]->failure_on_medium = false;
     }
 
+    if (devices_len > 1)
+        rwalloc_set_ready_at(reqc);
+
     for (i = 0; i < devices_len; i++) {
         devices[i]->ld_sub_request = sub_requests[i];
         devices[i]->ld_ongoing_scheduled = false;
@@ -1767,8 +2091,10 @@ static int publish_or_cancel(struct lrs_sched *sched,
                       pho_srl_request_kind_str(reqc->req));
     }
 
-    if (!reqc_rc && !rc)
+    if (!reqc_rc && !rc) {
+        io_sched_qos_scheduled(&sched->io_sched_hdl, reqc);
         push_sub_request_to_device(reqc);
+    }
 
     if (reqc_rc || rc) {
         for (i = 0; i < n_selected; i++)
@@ -1815,6 +2141,65 @@ static bool medium_is_loaded(struct lrs_dev *dev, struct media_info *medium)
     return loaded;
 }
 
+/**
+ * Record in the DSS that objects of \p grouping are written on \p medium, so
+ * that the next writes of this grouping are collocated on it.
+ *
+ * A failure is not fatal to the write, the grouping is only a placement hint.
+ */
+static void sched_medium_add_grouping(struct lrs_sched *sched,
+                                      struct media_info *medium,
+                                      const char *grouping)
+{
+    struct media_info updated;
+    char **values;
+    size_t n;
+    int rc;
+
+    if (!grouping || tag_exists(&medium->groupings, grouping))
+        return;
+
+    /* the DSS appends the grouping to the ones already recorded */
+    updated = *medium;
+    tags_init(&updated.groupings, (char **) &grouping, 1);
+    rc = dss_media_update(&sched->sched_thread.dss, medium, &updated, 1,
+                          GROUPINGS_ADD);
+    tags_free(&updated.groupings);
+    if (rc) {
+        pho_warn("Failed to record grouping '%s' on medium (family '%s', "
+                 "name '%s', library '%s'): %s", grouping,
+                 rsc_family2str(medium->rsc.id.family), medium->rsc.id.name,
+                 medium->rsc.id.library, strerror(-rc));
+        return;
+    }
+
+    n = medium->groupings.n_tags;
+    values = xmalloc((n + 1) * sizeof(*values));
+    if (n > 0)
+        memcpy(values, medium->groupings.tags, n * sizeof(*values));
+    values[n] = (char *) grouping;
+    tags_free(&medium->groupings);
+    tags_init(&medium->groupings, values, n + 1);
+    free(values);
+}
+
+/**
+ * Account the transfer of \p size bytes allocated on \p dev as backfilled if
+ * the device only accepted it because it waits for the other media of an
+ * allocation.
+ */
+static void sched_backfill_account(struct lrs_dev *dev, size_t size)
+{
+    double duration_ms = 0;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    if (dev->ld_ongoing_io >= dev->ld_max_clients)
+        duration_ms = dev_backfill_ms(dev, size);
+    if (duration_ms > 0)
+        dev_backfill_account(dev, duration_ms);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+}
+
 static int sched_write_alloc_one_medium(struct lrs_sched *sched,
                                         struct allocation *alloc,
                                         size_t index_to_alloc,
@@ -1850,7 +2235,7 @@ lock_race_retry:
         /* a device containing a medium with enough space was found */
         goto select_device;
     } else if (dev && medium_is_loaded(dev, *alloc_medium)) {
-        if (dev_is_sched_ready(dev)) {
+        if (dev_is_sched_ready(dev) || dev_is_shareable(dev)) {
             goto select_device;
         } else {
             pho_debug("Selected medium for write is already loaded in a busy "
@@ -1893,10 +2278,75 @@ notify_error:
     return rc;
 
 select_device:
+    sched_backfill_account(dev, wreq->media[index_to_alloc]->size);
     dev->ld_ongoing_scheduled = true;
     reqc->params.rwalloc.respc->devices[index_to_alloc] = dev;
+    sched_medium_add_grouping(sched, *alloc_medium, wreq->grouping);
+
+    return 0;
+}
+
+int sched_source_alloc_one_medium(struct lrs_sched *sched,
+                                  struct req_container *reqc, size_t index)
+{
+    struct media_info **medium = reqc_get_medium_to_alloc(reqc, index);
+    struct lrs_dev *dev;
+    bool sched_ready;
+    int rc;
+
+    if (!*medium) {
+        rc = fetch_and_check_medium_info(&sched->lock_handle, reqc, NULL,
+                                         index, medium);
+        if (rc)
+            goto release;
+    }
+
+    dev = search_in_use_medium(sched->devices.ldh_devices,
+                               (*medium)->rsc.id.name,
+                               (*medium)->rsc.id.library, &sched_ready);
+    if (dev) {
+        if (!dev_is_sched_ready(dev) &&
+            !(dev_is_shareable(dev) && medium_is_loaded(dev, *medium))) {
+            pho_debug("Source medium (family '%s', name '%s', library '%s') "
+                      "is used by a busy device",
+                      rsc_family2str((*medium)->rsc.id.family),
+                      (*medium)->rsc.id.name, (*medium)->rsc.id.library);
+            return -EAGAIN;
+        }
+    } else {
+        dev = dev_picker(sched->devices.ldh_devices, PHO_DEV_OP_ST_UNSPEC,
+                         (*medium)->rsc.id.library, pho_request_qos(reqc->req),
+                         select_earliest_completion, 0, &NO_TAGS, *medium,
+                         false, false, NULL);
+    }
+
+    if (!dev) {
+        if (compatible_drive_exists(sched, *medium,
+                                    reqc->params.rwalloc.respc->devices, index,
+                                    index, false, reqc->socket_id))
+            return -EAGAIN;
+
+        LOG_GOTO(release, rc = -ENODEV,
+                 "No compatible device found to read the source medium "
+                 "(family '%s', name '%s', library '%s')",
+                 rsc_family2str((*medium)->rsc.id.family),
+                 (*medium)->rsc.id.name, (*medium)->rsc.id.library);
+    }
+
+    rc = ensure_medium_lock(&sched->lock_handle, *medium);
+    if (rc)
+        goto release;
+
+    dev->ld_ongoing_scheduled = true;
+    reqc->params.rwalloc.respc->devices[index] = dev;
 
     return 0;
+
+release:
+    lrs_medium_release(*medium);
+    *medium = NULL;
+
+    return rc;
 }
 
 /**
@@ -1940,6 +2390,16 @@ static int sched_handle_write_alloc(struct lrs_sched *sched,
             break;
     }
 
+    /* the media to read are allocated with the media to write, so that the
+     * response is only sent once all of them are mounted
+     */
+    for (; !rc && next_medium_index < reqc->params.rwalloc.n_media;
+         next_medium_index++) {
+        rc = sched_source_alloc_one_medium(sched, reqc, next_medium_index);
+        if (rc)
+            break;
+    }
+
 end:
     return publish_or_cancel(sched, reqc, rc, next_medium_index);
 }
@@ -2013,11 +2473,13 @@ static int _check_medium_on_delete_alloc(struct req_container *reqc,
 }
 
 static int check_medium_permission_and_status(struct req_container *reqc,
+                                              size_t index,
                                               struct media_info *medium)
 {
+    bool is_source = reqc_medium_is_source(reqc, index);
 
     if (medium->fs.status == PHO_FS_STATUS_IMPORTING &&
-        !pho_request_is_read(reqc->req))
+        !pho_request_is_read(reqc->req) && !is_source)
         LOG_RETURN(-EINVAL,
                    "Medium (family '%s', name '%s', library '%s') is being "
                    "imported. Can only read from it.",
@@ -2025,10 +2487,11 @@ static int check_medium_permission_and_status(struct req_container *reqc,
                    medium->rsc.id.name, medium->rsc.id.library);
 
     if (medium->fs.status != PHO_FS_STATUS_IMPORTING &&
-        pho_request_is_read(reqc->req)) {
+        (pho_request_is_read(reqc->req) || is_source)) {
         int rc;
 
-        if ((int)reqc->req->ralloc->operation ==
+        if (is_source ||
+            (int)reqc->req->ralloc->operation ==
             PHO_READ_TARGET_ALLOC_OP_READ) {
             rc = _check_medium_on_read_alloc(reqc, medium);
             if (rc)
@@ -2078,7 +2541,7 @@ int fetch_and_check_medium_info(struct lock_handle *lock_handle,
     if (rc)
         return rc;
 
-    rc = check_medium_permission_and_status(reqc, medium);
+    rc = check_medium_permission_and_status(reqc, index, medium);
     *target_medium = medium;
     if (rc)
         return rc;
@@ -2088,6 +2551,27 @@ int fetch_and_check_medium_info(struct lock_handle *lock_handle,
     return 0;
 }
 
+/**
+ * Whether the single-medium read \p reqc of a known size can be backfilled on
+ * \p dev, whose mounted \p medium waits for the other media of an allocation.
+ */
+static bool read_is_backfilled(struct lrs_dev *dev, struct req_container *reqc,
+                               struct media_info *medium)
+{
+    pho_req_read_t *ralloc = reqc->req->ralloc;
+    double duration_ms;
+
+    if (ralloc->n_required != 1 || !ralloc->has_size ||
+        !medium_is_loaded(dev, medium))
+        return false;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    duration_ms = dev_backfill_ms(dev, ralloc->size);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    return duration_ms > 0;
+}
+
 enum allocation_status {
     AS_ALLOCATED,
     AS_RETRY,
@@ -2127,7 +2611,13 @@ static int sched_try_alloc_medium(struct lrs_sched *sched,
             rc = -ENODEV;
 
         goto skip_medium;
-    } else if (!dev_is_sched_ready(dev)) {
+    } else if (!dev_is_sched_ready(dev) &&
+               !(dev_is_shareable(dev) &&
+                 medium_is_loaded(dev, *medium_to_alloc)) &&
+               !read_is_backfilled(dev, reqc, *medium_to_alloc)) {
+        /* a busy device can only take one more reader of its mounted
+         * medium
+         */
         rc = -EAGAIN;
         goto skip_medium;
     }
@@ -2137,6 +2627,9 @@ static int sched_try_alloc_medium(struct lrs_sched *sched,
     if (rc)
         goto release_skip_medium;
 
+    if (reqc->req->ralloc->has_size)
+        sched_backfill_account(dev, reqc->req->ralloc->size);
+
     dev->ld_ongoing_scheduled = true;
     reqc->params.rwalloc.respc->devices[index_to_alloc] = dev;
     return AS_ALLOCATED;
@@ -2333,6 +2826,20 @@ static int sched_handle_format(struct lrs_sched *sched,
     struct pho_id m;
     int rc = 0;
 
+    if (reqc->params.format.auto_format &&
+        (sched->io_sched_hdl.io_stats.nb_reads ||
+         sched->io_sched_hdl.io_stats.nb_writes)) {
+        /* A read or write request arrived since this background format was
+         * pushed, it waits for the next idle period.
+         */
+        rc = io_sched_remove_request(&sched->io_sched_hdl, reqc);
+        if (rc)
+            LOG_RETURN(rc, "Failed to remove request from I/O scheduler");
+
+        g_queue_push_head(sched->auto_format.pending, reqc);
+        return 0;
+    }
+
     rc = fetch_and_check_medium_info(&sched->lock_handle, reqc, &m, 0,
                                      reqc_get_medium_to_alloc(reqc, 0));
     if (rc == -EALREADY)
@@ -2420,6 +2927,7 @@ static int sched_handle_format(struct lrs_sched *sched,
         LOG_GOTO(free_sub_request, rc,
                  "Failed to remove request from I/O scheduler");
 
+    io_sched_qos_scheduled(&sched->io_sched_hdl, reqc);
     MUTEX_LOCK(&device->ld_mutex);
     device->ld_sub_request = format_sub_request;
     MUTEX_UNLOCK(&device->ld_mutex);
@@ -2602,10 +3110,12 @@ void rwalloc_cancel_DONE_devices(struct req_container *reqc)
 
             MUTEX_LOCK(&respc->devices[i]->ld_mutex);
             reqc->params.rwalloc.media[i].status = SUB_REQUEST_CANCEL;
-            respc->devices[i]->ld_ongoing_io = false;
+            dev_client_remove(respc->devices[i], reqc->socket_id,
+                              reqc->req->id, 0);
+            respc->devices[i]->ld_backfill.until = (struct timespec) {0};
             MUTEX_UNLOCK(&respc->devices[i]->ld_mutex);
             respc->devices[i] = NULL;
-            if (is_write) {
+            if (is_write && !reqc_medium_is_source(reqc, i)) {
                 pho_resp_write_elt_t *wresp = resp->walloc->media[i];
 
                 free(wresp->root_path);
@@ -2615,7 +3125,13 @@ void rwalloc_cancel_DONE_devices(struct req_container *reqc)
                 free(wresp->med_id->library);
                 wresp->med_id->library = NULL;
             } else {
-                pho_resp_read_elt_t *rresp = resp->ralloc->media[i];
+                pho_resp_read_elt_t *rresp;
+
+                if (is_write)
+                    rresp = resp->walloc->sources[i -
+                                                  reqc->req->walloc->n_media];
+                else
+                    rresp = resp->ralloc->media[i];
 
                 free(rresp->root_path);
                 rresp->root_path = NULL;
@@ -2643,6 +3159,9 @@ static void sched_handle_read_or_write_error(struct lrs_sched *sched,
     *req_ended = false;
     if (pho_request_is_read(sreq->reqc->req)) {
         rc = sched_handle_read_alloc_error(sched, sreq);
+    } else if (reqc_medium_is_source(sreq->reqc, sreq->medium_index)) {
+        rc = sched_source_alloc_one_medium(sched, sreq->reqc,
+                                           sreq->medium_index);
     } else {
         device_select_func_t dev_select_policy;
 
@@ -2864,6 +3383,19 @@ static void _json_object_set_str(struct json_t *object,
     json_decref(str);
 }
 
+static void _json_object_set_int(json_t *object, const char *key,
+                                 json_int_t value)
+{
+    json_t *integer;
+
+    integer = json_integer(value);
+    if (!integer)
+        return;
+
+    json_object_set(object, key, integer);
+    json_decref(integer);
+}
+
 static const char *device_request_type2str(struct lrs_dev *device,
                                            char buf[4])
 {
@@ -2879,13 +3411,78 @@ static const char *device_request_type2str(struct lrs_dev *device,
     return buf;
 }
 
-static void sched_fetch_device_status(struct lrs_dev *device,
+/* Called with the device lock held */
+static void sched_fetch_sync_status(struct sync_params *sync_params,
+                                    json_t *device_status)
+{
+    _json_object_set_int(device_status, "sync_count",
+                         sync_params->sync_count);
+    _json_object_set_int(device_status, "sync_duration_ms",
+                         sync_params->sync_cost_ms);
+    _json_object_set_int(device_status, "sync_total_ms",
+                         sync_params->sync_total_ms);
+    _json_object_set_int(device_status, "sync_queue_delay_ms",
+                         sync_params->queue_delay_ms);
+    _json_object_set_int(device_status, "sync_time_ms",
+                         sync_params->sync_time.tv_sec * 1000 +
+                         sync_params->sync_time.tv_nsec / 1000000);
+    _json_object_set_int(device_status, "sync_nb_req",
+                         sync_params->sync_nb_req);
+    _json_object_set_int(device_status, "sync_wsize_kb",
+                         sync_params->sync_wsize / 1024);
+}
+
+/* Called with the device lock held */
+static void sched_fetch_stage_status(struct stage_params *stage_params,
+                                     json_t *device_status)
+{
+    _json_object_set_int(device_status, "stage_count",
+                         stage_params->stage_count);
+    _json_object_set_int(device_status, "stage_hits",
+                         stage_params->stage_hits);
+    _json_object_set_int(device_status, "stage_hidden_ms",
+                         stage_params->hidden_ms);
+}
+
+/* Called with the device lock held */
+static void sched_fetch_backfill_status(struct backfill_params *backfill,
+                                        json_t *device_status)
+{
+    _json_object_set_int(device_status, "backfill_count", backfill->count);
+    _json_object_set_int(device_status, "backfill_recovered_ms",
+                         backfill->recovered_ms);
+}
+
+/* Called with the device lock held, return the ETA of the device */
+static double sched_fetch_perf_status(struct lrs_dev *device,
                                       json_t *device_status)
+{
+    double eta_ms = dev_eta_ms(device);
+    char key[16];
+    int i;
+
+    _json_object_set_int(device_status, "eta_ms", eta_ms);
+    /* the duration of the syncs is already given by sync_duration_ms */
+    for (i = 0; i < PERF_OP_SYNC; i++) {
+        snprintf(key, sizeof(key), "%s_ms", perf_op2str(i));
+        _json_object_set_int(device_status, key,
+                             perf_model_op_ms(&device->ld_perf, i));
+    }
+    _json_object_set_int(device_status, "throughput_kb_s",
+                         perf_model_bytes_per_ms(&device->ld_perf) * 1000 /
+                         1024);
+
+    return eta_ms;
+}
+
+static double sched_fetch_device_status(struct lrs_dev *device,
+                                        json_t *device_status)
 {
     struct media_info *medium = NULL;
     char request_type[4];
     json_t *ongoing_io;
     json_t *integer;
+    double eta_ms;
 
     memset(request_type, 0, sizeof(request_type));
 
@@ -2897,6 +3494,9 @@ static void sched_fetch_device_status(struct lrs_dev *device,
                          device->ld_sys_dev_state.lds_serial);
     _json_object_set_str(device_status, "currently_dedicated_to",
                          device_request_type2str(device, request_type));
+    if (device->ld_qos_reserved)
+        _json_object_set_str(device_status, "reserved_for",
+                             qos_class2str(device->ld_qos_class));
 
     integer = json_integer(device->ld_lib_dev_info.ldi_addr.lia_addr -
                            device->ld_lib_dev_info.ldi_first_addr);
@@ -2911,31 +3511,106 @@ static void sched_fetch_device_status(struct lrs_dev *device,
         json_decref(ongoing_io);
     }
 
+    if (device->ld_max_clients > 1) {
+        integer = json_integer(device->ld_ongoing_io);
+        if (integer) {
+            json_object_set(device_status, "clients", integer);
+            json_decref(integer);
+        }
+    }
+
     /* The device thread could remove the device while we are reading it here.
      * Take a reference with the mutex lock held to make sure that our local
      * pointer `medium' will remain valid.
      */
     MUTEX_LOCK(&device->ld_mutex);
+    sched_fetch_sync_status(&device->ld_sync_params, device_status);
+    if (device->ld_handle->stage_media)
+        sched_fetch_stage_status(&device->ld_stage_params, device_status);
+    if (device->ld_handle->backfill)
+        sched_fetch_backfill_status(&device->ld_backfill, device_status);
+    eta_ms = sched_fetch_perf_status(device, device_status);
     if (device->ld_dss_media_info)
         medium = lrs_medium_acquire(&device->ld_dss_media_info->rsc.id);
     MUTEX_UNLOCK(&device->ld_mutex);
     if (!medium)
-        return;
+        return eta_ms;
 
     _json_object_set_str(device_status, "mount_path", device->ld_mnt_path);
     _json_object_set_str(device_status, "media", medium->rsc.id.name);
 
     lrs_medium_release(medium); /* release local reference */
+
+    return eta_ms;
+}
+
+/**
+ * Queue depth and latency of each QoS class, as an additional status entry.
+ *
+ * The ETA of the requests queued in a class is roughly estimated as the time
+ * for the first device to be free, \p free_ms, then \p service_ms per request,
+ * the time for the devices to serve one request.
+ */
+static int sched_fetch_qos_status(struct io_qos *qos, json_t *status,
+                                  double free_ms, double service_ms)
+{
+    json_t *qos_status;
+    json_t *classes;
+    int i;
+
+    classes = json_object();
+    if (!classes)
+        return -ENOMEM;
+
+    for (i = PHO_QOS_FIRST; i < PHO_QOS_LAST; i++) {
+        struct io_qos_stats *stats = &qos->stats[i];
+        json_t *class_status;
+
+        class_status = json_object();
+        if (!class_status) {
+            json_decref(classes);
+            return -ENOMEM;
+        }
+
+        _json_object_set_int(class_status, "weight", qos->weights[i]);
+        _json_object_set_int(class_status, "queued", stats->queued);
+        _json_object_set_int(class_status, "scheduled", stats->scheduled);
+        _json_object_set_int(class_status, "wait_avg_ms",
+                             stats->scheduled ?
+                                stats->total_wait_ms / stats->scheduled : 0);
+        _json_object_set_int(class_status, "wait_max_ms",
+                             stats->max_wait_ms);
+        _json_object_set_int(class_status, "eta_ms",
+                             stats->queued ?
+                                free_ms + stats->queued * service_ms : 0);
+        json_object_set_new(classes, qos_class2str(i), class_status);
+    }
+
+    qos_status = json_object();
+    if (!qos_status) {
+        json_decref(classes);
+        return -ENOMEM;
+    }
+
+    json_object_set_new(qos_status, "qos", classes);
+    if (json_array_append_new(status, qos_status) == -1)
+        return -ENOMEM;
+
+    return 0;
 }
 
 int sched_handle_monitor(struct lrs_sched *sched, json_t *status)
 {
+    double free_ms = 0;
+    double switch_ms = 0;
     json_t *device_status;
+    int nb_devices = 0;
     int rc = 0;
     int i;
 
     for (i = 0; i < sched->devices.ldh_devices->len; i++) {
         struct lrs_dev *device;
+        double eta_ms;
 
         device_status = json_object();
         if (!device_status)
@@ -2943,7 +3618,12 @@ int sched_handle_monitor(struct lrs_sched *sched, json_t *status)
 
         device = lrs_dev_hdl_get(&sched->devices, i);
 
-        sched_fetch_device_status(device, device_status);
+        eta_ms = sched_fetch_device_status(device, device_status);
+        if (!dev_is_failed(device)) {
+            free_ms = nb_devices ? min(free_ms, eta_ms) : eta_ms;
+            switch_ms += dev_switch_ms(device);
+            nb_devices++;
+        }
 
         rc = json_array_append_new(status, device_status);
         if (rc == -1)
@@ -2957,9 +3637,268 @@ free_device_status:
         json_decref(device_status);
     }
 
+    if (rc)
+        return rc;
+
+    /* each device serves one request per medium switch, concurrently */
+    rc = sched_fetch_qos_status(&sched->io_sched_hdl.qos, status, free_ms,
+                                nb_devices ?
+                                    switch_ms / nb_devices / nb_devices : 0);
+    if (rc)
+        LOG_RETURN(rc, "Failed to append QoS status to array");
+
+    return 0;
+}
+
+/* Formatted media that can be written to, of a library and tags */
+struct format_pool {
+    const char        *library;
+    const struct tags *tags;
+    unsigned int       count;      /* number of formatted media */
+    ssize_t            free_space; /* free space of these media */
+    unsigned int       formatting; /* number of background formats */
+};
+
+static struct format_pool *format_pool_get(GArray *pools,
+                                           struct media_info *medium)
+{
+    struct format_pool pool = {
+        .library = medium->rsc.id.library,
+        .tags    = &medium->tags,
+    };
+    int i;
+
+    for (i = 0; i < pools->len; i++) {
+        struct format_pool *iter;
+
+        iter = &g_array_index(pools, struct format_pool, i);
+        if (!strcmp(iter->library, pool.library) &&
+            tags_eq(iter->tags, pool.tags))
+            return iter;
+    }
+
+    g_array_append_val(pools, pool);
+
+    return &g_array_index(pools, struct format_pool, pools->len - 1);
+}
+
+/**
+ * Fetch the media of the family of \p sched that can be written to once
+ * formatted, either the blank ones or the formatted ones.
+ */
+static int fetch_writable_media(struct lrs_sched *sched, bool blank,
+                                struct media_info **media, int *count)
+{
+    struct dss_filter filter;
+    int rc;
+
+    if (blank)
+        rc = dss_filter_build(&filter,
+                              "{\"$AND\": ["
+                              "  {\"DSS::MDA::family\": \"%s\"},"
+                              "  {\"DSS::MDA::put\": \"t\"},"
+                              "  {\"DSS::MDA::adm_status\": \"%s\"},"
+                              "  {\"DSS::MDA::fs_status\": \"%s\"}"
+                              "]}",
+                              rsc_family2str(sched->family),
+                              rsc_adm_status2str(PHO_RSC_ADM_ST_UNLOCKED),
+                              fs_status2str(PHO_FS_STATUS_BLANK));
+    else
+        rc = dss_filter_build(&filter,
+                              "{\"$AND\": ["
+                              "  {\"DSS::MDA::family\": \"%s\"},"
+                              "  {\"DSS::MDA::put\": \"t\"},"
+                              "  {\"DSS::MDA::adm_status\": \"%s\"},"
+                              "  {\"$OR\": ["
+                              "    {\"DSS::MDA::fs_status\": \"%s\"},"
+                              "    {\"DSS::MDA::fs_status\": \"%s\"}"
+                              "  ]}"
+                              "]}",
+                              rsc_family2str(sched->family),
+                              rsc_adm_status2str(PHO_RSC_ADM_ST_UNLOCKED),
+                              fs_status2str(PHO_FS_STATUS_USED),
+                              fs_status2str(PHO_FS_STATUS_EMPTY));
+    if (rc)
+        return rc;
+
+    rc = dss_media_get(&sched->sched_thread.dss, &filter, media, count, NULL);
+    dss_filter_free(&filter);
+
+    return rc;
+}
+
+static int auto_format_request(struct lrs_sched *sched,
+                               struct media_info *medium,
+                               struct req_container **reqc)
+{
+    pho_req_t *req;
+    int rc;
+
+    req = xmalloc(sizeof(*req));
+    pho_srl_request_format_alloc(req);
+    req->format->fs = medium->fs.type;
+    req->format->unlock = false;
+    req->format->force = false;
+    req->format->med_id->family = medium->rsc.id.family;
+    req->format->med_id->name = xstrdup(medium->rsc.id.name);
+    req->format->med_id->library = xstrdup(medium->rsc.id.library);
+    req->has_qos = true;
+    req->qos = PHO_QOS_BULK;
+
+    *reqc = xcalloc(1, sizeof(**reqc));
+    rc = pthread_mutex_init(&(*reqc)->mutex, NULL);
+    if (rc) {
+        pho_srl_request_free(req, true);
+        free(*reqc);
+        LOG_RETURN(-rc, "Unable to init mutex at request container init");
+    }
+
+    (*reqc)->socket_id = SCHED_INTERNAL_SOCKET_ID;
+    (*reqc)->req = req;
+    (*reqc)->params.format.auto_format = &sched->auto_format;
+
+    return 0;
+}
+
+/**
+ * Count the formatted media that can be written to per library and tags, and
+ * queue the background format of blank media of the same library and tags for
+ * the ones below the watermark.
+ */
+static int auto_format_check(struct lrs_sched *sched)
+{
+    struct auto_format *auto_format = &sched->auto_format;
+    struct media_info *formatted = NULL;
+    struct media_info *blank = NULL;
+    int n_formatted = 0;
+    struct timespec now;
+    int n_blank = 0;
+    GArray *pools;
+    int rc;
+    int i;
+
+    rc = fetch_writable_media(sched, false, &formatted, &n_formatted);
+    if (rc)
+        LOG_RETURN(rc, "Failed to fetch the formatted media");
+
+    rc = fetch_writable_media(sched, true, &blank, &n_blank);
+    if (rc)
+        LOG_GOTO(free_formatted, rc, "Failed to fetch the blank media");
+
+    auto_format_retries_prune(auto_format, blank, n_blank);
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    pools = g_array_new(FALSE, FALSE, sizeof(struct format_pool));
+    for (i = 0; i < n_formatted; i++) {
+        struct format_pool *pool = format_pool_get(pools, &formatted[i]);
+
+        pool->count++;
+        pool->free_space += formatted[i].stats.phys_spc_free;
+    }
+
+    /* count the background formats already queued before adding new ones */
+    for (i = 0; i < n_blank; i++)
+        if (format_medium_contains(&auto_format->media, &blank[i].rsc.id))
+            format_pool_get(pools, &blank[i])->formatting++;
+
+    for (i = 0; i < n_blank; i++) {
+        struct media_info *medium = &blank[i];
+        struct req_container *reqc;
+        struct format_pool *pool;
+
+        if (format_medium_contains(&auto_format->media, &medium->rsc.id) ||
+            format_medium_contains(&sched->ongoing_format, &medium->rsc.id))
+            continue;
+
+        pool = format_pool_get(pools, medium);
+        if (pool->count + pool->formatting >= auto_format->low_watermark)
+            continue;
+
+        /* its last background format failed, it is not tried again yet */
+        if (!auto_format_retry_due(auto_format, &medium->rsc.id, &now))
+            continue;
+
+        rc = auto_format_request(sched, medium, &reqc);
+        if (rc)
+            break;
+
+        pho_info("%u formatted media with %zd bytes free in library '%s', "
+                 "formatting medium (family '%s', name '%s') in the "
+                 "background", pool->count, pool->free_space,
+                 medium->rsc.id.library, rsc_family2str(medium->rsc.id.family),
+                 medium->rsc.id.name);
+        format_medium_add(&auto_format->media, medium);
+        g_queue_push_tail(auto_format->pending, reqc);
+        pool->formatting++;
+    }
+
+    g_array_free(pools, TRUE);
+    dss_res_free(blank, n_blank);
+
+free_formatted:
+    dss_res_free(formatted, n_formatted);
+
     return rc;
 }
 
+/* Whether no read, write or format request waits and a device is ready */
+static bool sched_is_idle(struct lrs_sched *sched)
+{
+    struct io_stats *stats = &sched->io_sched_hdl.io_stats;
+    int i;
+
+    if (stats->nb_reads || stats->nb_writes || stats->nb_formats)
+        return false;
+
+    for (i = 0; i < sched->devices.ldh_devices->len; i++)
+        if (dev_is_sched_ready(lrs_dev_hdl_get(&sched->devices, i)))
+            return true;
+
+    return false;
+}
+
+/**
+ * Periodically queue the background format of blank media, and push the next
+ * one to the I/O schedulers when \p sched is idle.
+ */
+static void sched_auto_format(struct lrs_sched *sched)
+{
+    struct auto_format *auto_format = &sched->auto_format;
+    struct req_container *reqc;
+    struct timespec now;
+    int rc;
+
+    if (!auto_format->low_watermark)
+        return;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (cmp_timespec(&now, &auto_format->next_check) >= 0) {
+        struct timespec interval = {
+            .tv_sec = AUTO_FORMAT_CHECK_INTERVAL_S,
+            .tv_nsec = 0,
+        };
+
+        rc = auto_format_check(sched);
+        if (rc)
+            pho_error(rc, "'%s' scheduler: failed to queue background formats",
+                      rsc_family2str(sched->family));
+
+        auto_format->next_check = add_timespec(&now, &interval);
+    }
+
+    if (g_queue_is_empty(auto_format->pending) || !sched_is_idle(sched))
+        return;
+
+    reqc = g_queue_pop_head(auto_format->pending);
+    reqc->received_at = now;
+    rc = io_sched_push_request(&sched->io_sched_hdl, reqc);
+    if (rc) {
+        pho_error(rc, "'%s' scheduler: failed to push a background format",
+                  rsc_family2str(sched->family));
+        sched_req_free(reqc);
+    }
+}
+
 static int compute_wakeup_time(const struct timespec *timeout,
                                struct timespec *date)
 {
@@ -3005,6 +3944,8 @@ static void *lrs_sched_thread(void *sdata)
                      "'%s' scheduler: error while scheduling requests",
                      rsc_family2str(sched->family));
 
+        sched_auto_format(sched);
+
         rc = compute_wakeup_time(&timeout, &wakeup_date);
         if (rc)
             GOTO(end_thread, thread->status = rc);
@@ -73,6 +73,70 @@ struct format_media {
 void format_medium_remove(struct format_media *format_media,
                           struct media_info *medium);
 
+/**
+ * Background format of the blank media of a family, when the number of
+ * formatted media that can be written to of a library and tags falls below a
+ * watermark.
+ *
+ * The format requests are built by the scheduler thread, which pushes them to
+ * the I/O schedulers only while no read or write request waits and a device is
+ * ready, and takes them back if a read or write request arrives before they
+ * are scheduled.
+ */
+struct auto_format {
+    unsigned int        low_watermark; /**< Minimum number of formatted media
+                                         *  per library and tags, 0 to disable
+                                         *  the background format
+                                         */
+    struct timespec     next_check;    /**< Date of the next count of the
+                                         *  formatted media
+                                         */
+    GQueue             *pending;       /**< Format requests waiting for the
+                                         *  scheduler to be idle
+                                         */
+    struct format_media media;         /**< Media with a pending or ongoing
+                                         *  background format
+                                         */
+    GHashTable         *retries;       /**< Blank media whose background
+                                         *  format ended, by ID, with the date
+                                         *  of their next format, protected by
+                                         *  the mutex of media
+                                         */
+};
+
+/**
+ * Initialize the background format of the blank media of \p family.
+ *
+ * @param[out] auto_format  Background format to initialize.
+ * @param[in]  family       Family of the media to format.
+ *
+ * @return 0 on success, -errno on failure.
+ */
+int auto_format_init(struct auto_format *auto_format, enum rsc_family family);
+
+/**
+ * Free the pending requests and the resources of a background format.
+ */
+void auto_format_clean(struct auto_format *auto_format);
+
+/**
+ * Whether the background format of \p medium can be queued at \p now.
+ *
+ * A medium still blank after its background format ended is not formatted
+ * again before a delay which doubles with each attempt, from the period of the
+ * checks up to a day, so that a medium which cannot be formatted does not
+ * take a device every period.
+ */
+bool auto_format_retry_due(struct auto_format *auto_format,
+                           const struct pho_id *medium,
+                           const struct timespec *now);
+
+/**
+ * Socket ID of the requests emitted by the LRS itself, whose responses are
+ * not sent.
+ */
+#define SCHED_INTERNAL_SOCKET_ID (-1)
+
 /**
  * Local Resource Scheduler instance, manages media and local devices for the
  * actual IO to be performed.
@@ -88,6 +152,9 @@ struct lrs_sched {
                                              *  the device thread on error
                                              */
     struct format_media    ongoing_format; /**< Ongoing format media */
+    struct auto_format     auto_format;    /**< Background format of the
+                                             *  blank media
+                                             */
     struct tsqueue        *response_queue; /**< Queue for responses */
     struct timespec        sync_time_ms;   /**< Time threshold for medium
                                              *  synchronization
@@ -159,6 +226,10 @@ struct format_params {
     struct fs_adapter_module *fsa;       /**< fs_adapter_module to use for
                                            * format
                                            */
+    struct auto_format *auto_format;     /**< Background formats this request
+                                           * belongs to, NULL for the requests
+                                           * of a client
+                                           */
 };
 
 /**
@@ -197,6 +268,9 @@ struct rwalloc_params {
     struct resp_container *respc;   /**< Response container */
     /** State of the allocation of the media for this request */
     struct read_media_list media_list;
+    struct timespec ready_at;       /**< Expected time at which all the media
+                                      *  are mounted, 0 if unknown
+                                      */
 };
 
 /**
@@ -242,6 +316,13 @@ struct allocation {
 void sched_resp_free(void *respc);
 void sched_resp_free_with_cont(void *respc);
 
+/**
+ * Remove the medium of a background format request from the media being
+ * formatted in the background, once the request ends, and delay its next
+ * background format in case it failed.
+ */
+void auto_format_end(struct req_container *reqc);
+
 /**
  * Release memory allocated for params structure of a request container.
  */
@@ -251,6 +332,8 @@ static inline void destroy_container_params(struct req_container *cont)
         free(cont->params.release.tosync_media);
         free(cont->params.release.nosync_media);
     } else if (pho_request_is_format(cont->req)) {
+        if (cont->params.format.auto_format)
+            auto_format_end(cont);
         lrs_medium_release(cont->params.format.medium_to_format);
     } else if (pho_request_is_read(cont->req) ||
                pho_request_is_write(cont->req)) {
@@ -408,6 +491,10 @@ int select_empty_loaded_mount(size_t required_size,
                               struct lrs_dev *dev_curr,
                               struct lrs_dev **dev_selected);
 
+int select_earliest_completion(size_t required_size,
+                               struct lrs_dev *dev_curr,
+                               struct lrs_dev **dev_selected);
+
 int select_first_fit(size_t required_size,
                      struct lrs_dev *dev_curr,
                      struct lrs_dev **dev_selected);
@@ -415,6 +502,7 @@ int select_first_fit(size_t required_size,
 struct lrs_dev *dev_picker(GPtrArray *devices,
                            enum dev_op_status op_st,
                            const char *library,
+                           enum pho_qos_class qos,
                            device_select_func_t select_func,
                            size_t required_size,
                            const struct tags *media_tags,
@@ -422,6 +510,43 @@ struct lrs_dev *dev_picker(GPtrArray *devices,
                            bool is_write, bool empty_medium,
                            bool *one_drive_available);
 
+/**
+ * Select, among the devices whose medium already holds objects of
+ * \p grouping, a device according to a given status and policy function.
+ *
+ * The devices keep writing the objects of a grouping on their medium as long
+ * as it has enough room, instead of spreading them over all the loaded media.
+ *
+ * @return the selected device, NULL if no medium holding \p grouping is
+ *         usable or if \p grouping is NULL
+ */
+struct lrs_dev *grouping_dev_picker(GPtrArray *devices,
+                                    enum dev_op_status op_st,
+                                    const char *library,
+                                    enum pho_qos_class qos,
+                                    const char *grouping,
+                                    device_select_func_t select_func,
+                                    size_t required_size,
+                                    const struct tags *media_tags,
+                                    bool empty_medium);
+
+/**
+ * Select a device whose mounted medium waits for the mount of the other media
+ * of a multi-medium allocation, and which can write \p required_size bytes on
+ * this medium before their expected mount.
+ *
+ * Only the families configured to backfill their devices are considered, see
+ * lrs_dev_hdl::backfill.
+ *
+ * @return the selected device, NULL if no waiting device can take the write
+ */
+struct lrs_dev *backfill_dev_picker(GPtrArray *devices,
+                                    const char *library,
+                                    enum pho_qos_class qos,
+                                    size_t required_size,
+                                    const struct tags *media_tags,
+                                    bool empty_medium);
+
 device_select_func_t get_dev_policy(void);
 
 int sched_select_medium(struct io_scheduler *io_sched,
@@ -440,4 +565,17 @@ int fetch_and_check_medium_info(struct lock_handle *lock_handle,
                                 size_t index,
                                 struct media_info **target_medium);
 
+/**
+ * Allocate a device to the medium \p index of a write allocation which is one
+ * of its sources, to be read.
+ *
+ * The device holding the medium is used if it is ready, otherwise an empty or
+ * idle device compatible with the medium is chosen.
+ *
+ * @return  0 on success, -EAGAIN if the request should be rescheduled later,
+ *          a negative error code if the medium cannot be read.
+ */
+int sched_source_alloc_one_medium(struct lrs_sched *sched,
+                                  struct req_container *reqc, size_t index);
+
 #endif
@@ -26,6 +26,7 @@
 #include "pho_srl_lrs.h"
 
 #include <errno.h>
+#include <string.h>
 #include <unistd.h>
 
 int lock_handle_init(struct lock_handle *lock_handle, struct dss_handle *dss)
@@ -52,6 +53,53 @@ struct media_info **reqc_get_medium_to_alloc(struct req_container *reqc,
     return NULL;
 }
 
+bool reqc_medium_is_source(struct req_container *reqc, size_t index)
+{
+    return pho_request_is_write(reqc->req) &&
+           index >= reqc->req->walloc->n_media;
+}
+
+bool reqc_is_source_medium(struct req_container *reqc,
+                           const struct pho_id *medium_id)
+{
+    pho_req_write_t *wreq;
+    size_t i;
+
+    if (!pho_request_is_write(reqc->req))
+        return false;
+
+    wreq = reqc->req->walloc;
+    for (i = 0; i < wreq->n_sources; i++)
+        if ((int)wreq->sources[i]->family == (int)medium_id->family &&
+            !strcmp(wreq->sources[i]->name, medium_id->name) &&
+            !strcmp(wreq->sources[i]->library, medium_id->library))
+            return true;
+
+    return false;
+}
+
+bool reqc_is_excluded_medium(struct req_container *reqc,
+                             const struct pho_id *medium_id)
+{
+    pho_req_write_t *wreq;
+    size_t i;
+
+    if (reqc_is_source_medium(reqc, medium_id))
+        return true;
+
+    if (!pho_request_is_write(reqc->req))
+        return false;
+
+    wreq = reqc->req->walloc;
+    for (i = 0; i < wreq->n_excluded; i++)
+        if ((int)wreq->excluded[i]->family == (int)medium_id->family &&
+            !strcmp(wreq->excluded[i]->name, medium_id->name) &&
+            !strcmp(wreq->excluded[i]->library, medium_id->library))
+            return true;
+
+    return false;
+}
+
 static struct pho_id *get_sub_request_medium(struct sub_request *sub_request)
 {
     size_t medium_index = sub_request->medium_index;
@@ -85,6 +133,9 @@ void reqc_pho_id_from_index(struct req_container *reqc, size_t index,
 
     if (pho_request_is_read(reqc->req))
         res_id = reqc->req->ralloc->med_ids[index];
+    else if (reqc_medium_is_source(reqc, index))
+        res_id = reqc->req->walloc->sources[index -
+                                            reqc->req->walloc->n_media];
     else if (pho_request_is_format(reqc->req))
         res_id = reqc->req->format->med_id;
     else
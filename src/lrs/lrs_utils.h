@@ -46,6 +46,26 @@ int lock_handle_init(struct lock_handle *lock_handle, struct dss_handle *dss);
 struct media_info **reqc_get_medium_to_alloc(struct req_container *reqc,
                                              size_t index);
 
+/**
+ * Whether the medium \p index of a write allocation is one of its sources,
+ * which are read and come after the media to write.
+ */
+bool reqc_medium_is_source(struct req_container *reqc, size_t index);
+
+/**
+ * Whether \p medium_id is one of the sources of the write allocation \p reqc,
+ * which are read and thus cannot be chosen to be written.
+ */
+bool reqc_is_source_medium(struct req_container *reqc,
+                           const struct pho_id *medium_id);
+
+/**
+ * Whether \p medium_id cannot be chosen to be written by the write allocation
+ * \p reqc: it is one of its sources or of the media it excludes.
+ */
+bool reqc_is_excluded_medium(struct req_container *reqc,
+                             const struct pho_id *medium_id);
+
 struct lrs_dev *search_in_use_medium(GPtrArray *devices,
                                      const char *name, const char *library,
                                      bool *sched_ready);
@@ -140,6 +140,34 @@ void pho_srl_request_write_alloc(pho_req_t *req, size_t n_media,
     }
 }
 
+void pho_srl_request_write_alloc_sources(pho_req_t *req, size_t n_sources)
+{
+    int i;
+
+    req->walloc->n_sources = n_sources;
+    req->walloc->sources = xmalloc(n_sources * sizeof(*req->walloc->sources));
+
+    for (i = 0; i < n_sources; ++i) {
+        req->walloc->sources[i] = xmalloc(sizeof(*req->walloc->sources[i]));
+        pho_resource_id__init(req->walloc->sources[i]);
+    }
+}
+
+void pho_srl_request_write_alloc_excluded(pho_req_t *req, size_t n_excluded)
+{
+    int i;
+
+    req->walloc->n_excluded = n_excluded;
+    req->walloc->excluded =
+        xmalloc(n_excluded * sizeof(*req->walloc->excluded));
+
+    for (i = 0; i < n_excluded; ++i) {
+        req->walloc->excluded[i] =
+            xmalloc(sizeof(*req->walloc->excluded[i]));
+        pho_resource_id__init(req->walloc->excluded[i]);
+    }
+}
+
 void pho_srl_request_read_alloc(pho_req_t *req, size_t n_media)
 {
     int i;
@@ -245,7 +273,20 @@ void pho_srl_request_free(pho_req_t *req, bool unpack)
             free(req->walloc->media[i]);
         }
         free(req->walloc->media);
+        for (i = 0; i < req->walloc->n_sources; ++i) {
+            free(req->walloc->sources[i]->name);
+            free(req->walloc->sources[i]->library);
+            free(req->walloc->sources[i]);
+        }
+        free(req->walloc->sources);
+        for (i = 0; i < req->walloc->n_excluded; ++i) {
+            free(req->walloc->excluded[i]->name);
+            free(req->walloc->excluded[i]->library);
+            free(req->walloc->excluded[i]);
+        }
+        free(req->walloc->excluded);
         free(req->walloc->library);
+        free(req->walloc->grouping);
         free(req->walloc);
         req->walloc = NULL;
     }
@@ -323,6 +364,25 @@ void pho_srl_response_write_alloc(pho_resp_t *resp, size_t n_media)
     }
 }
 
+void pho_srl_response_write_alloc_sources(pho_resp_t *resp, size_t n_sources)
+{
+    int i;
+
+    resp->walloc->n_sources = n_sources;
+    resp->walloc->sources =
+        xmalloc(n_sources * sizeof(*resp->walloc->sources));
+
+    for (i = 0; i < n_sources; ++i) {
+        resp->walloc->sources[i] =
+            xmalloc(sizeof(*resp->walloc->sources[i]));
+        pho_response__read__elt__init(resp->walloc->sources[i]);
+
+        resp->walloc->sources[i]->med_id =
+            xmalloc(sizeof(*resp->walloc->sources[i]->med_id));
+        pho_resource_id__init(resp->walloc->sources[i]->med_id);
+    }
+}
+
 void pho_srl_response_read_alloc(pho_resp_t *resp, size_t n_media)
 {
     int i;
@@ -435,6 +495,14 @@ void pho_srl_response_free(pho_resp_t *resp, bool unpack)
             free(resp->walloc->media[i]);
         }
         free(resp->walloc->media);
+        for (i = 0; i < resp->walloc->n_sources; ++i) {
+            free(resp->walloc->sources[i]->med_id->name);
+            free(resp->walloc->sources[i]->med_id->library);
+            free(resp->walloc->sources[i]->med_id);
+            free(resp->walloc->sources[i]->root_path);
+            free(resp->walloc->sources[i]);
+        }
+        free(resp->walloc->sources);
         free(resp->walloc);
         resp->walloc = NULL;
     }
@@ -60,6 +60,13 @@ void pho_srl_tlc_request_unload_alloc(pho_tlc_req_t *req)
     pho_tlc_request__unload__init(req->unload);
 }
 
+void pho_srl_tlc_request_stage_alloc(pho_tlc_req_t *req)
+{
+    pho_tlc_request__init(req);
+    req->stage = xmalloc(sizeof(*req->stage));
+    pho_tlc_request__stage__init(req->stage);
+}
+
 void pho_srl_tlc_request_status_alloc(pho_tlc_req_t *req)
 {
     pho_tlc_request__init(req);
@@ -104,6 +111,13 @@ void pho_srl_tlc_request_free(pho_tlc_req_t *req, bool unpack)
         req->unload = NULL;
     }
 
+    if (req->stage) {
+        free(req->stage->drive_serial);
+        free(req->stage->tape_label);
+        free(req->stage);
+        req->stage = NULL;
+    }
+
     if (req->status) {
         free(req->status);
         req->status = NULL;
@@ -143,6 +157,13 @@ void pho_srl_tlc_response_unload_alloc(pho_tlc_resp_t *resp)
     pho_tlc_response__unload__init(resp->unload);
 }
 
+void pho_srl_tlc_response_stage_alloc(pho_tlc_resp_t *resp)
+{
+    pho_tlc_response__init(resp);
+    resp->stage = xmalloc(sizeof(*resp->stage));
+    pho_tlc_response__stage__init(resp->stage);
+}
+
 void pho_srl_tlc_response_status_alloc(pho_tlc_resp_t *resp)
 {
     pho_tlc_response__init(resp);
@@ -201,6 +222,12 @@ void pho_srl_tlc_response_free(pho_tlc_resp_t *resp, bool unpack)
         resp->unload = NULL;
     }
 
+    if (resp->stage) {
+        free(resp->stage->message);
+        free(resp->stage);
+        resp->stage = NULL;
+    }
+
     if (resp->status) {
         free(resp->status->lib_data);
         free(resp->status->message);
@@ -39,6 +39,10 @@
 #include "pho_type_utils.h"
 #include "pho_types.h"
 #include "store_alias.h"
+#include "store_cache.h"
+#include "store_dedup.h"
+#include "store_pool.h"
+#include "store_session.h"
 #include "store_utils.h"
 
 #include <attr/xattr.h>
@@ -60,12 +64,18 @@ enum pho_cfg_params_store {
 
     /* store parameters */
     PHO_CFG_STORE_lrs_socket = PHO_CFG_STORE_FIRST,
+    PHO_CFG_STORE_dedup,
 
     PHO_CFG_STORE_LAST
 };
 
 const struct pho_config_item cfg_store[] = {
     [PHO_CFG_STORE_lrs_socket] = LRS_SOCKET_CFG_ITEM,
+    [PHO_CFG_STORE_dedup] = {
+        .section = "store",
+        .name    = "dedup",
+        .value   = "false"
+    },
 };
 
 /**
@@ -91,8 +101,24 @@ struct phobos_handle {
                                      *  may need to roll them back in case of
                                      *  failure)
                                      */
+    struct dedup_info *dedup;       /**< Deduplication state of each PUT
+                                      *  transfer, NULL if deduplication is
+                                      *  disabled
+                                      */
+    ssize_t *packed_in;             /**< Index of the transfer whose encoder
+                                      *  writes the data of each transfer, -1
+                                      *  if written by its own encoder
+                                      */
+    struct read_cache cache;        /**< Read cache of the GET transfers */
+    struct cache_info *cache_info;  /**< Read cache state of each GET
+                                      *  transfer, NULL if the read cache is
+                                      *  disabled
+                                      */
 
     struct pho_comm_info comm;      /**< Communication socket info. */
+    struct write_sessions sessions; /**< Allocations shared by several PUT
+                                      *  transfers
+                                      */
 
     pho_completion_cb_t cb;         /**< Callback called on xfer completion */
     void *udata;                    /**< User-provided argument to `cb` */
@@ -106,11 +132,14 @@ int phobos_init(void)
     if (rc)
         return rc;
 
+    store_pool_init();
+
     return 0;
 }
 
 void phobos_fini(void)
 {
+    store_pool_fini();
     pho_context_fini();
 }
 
@@ -207,7 +236,7 @@ err:
  * encoder's next requests and forward them back to the LRS.
  *
  * @param[in/out]   enc     The encoder to give the response to.
- * @param[in]       ci      Communication information.
+ * @param[in]       ws      Write sessions, through which requests are sent.
  * @param[in]       resp    The response to be forwarded to \a enc. Can be NULL
  *                          to generate the first request from \a enc.
  * @param[in]       enc_id  Identifier of this encoder (for request / response
@@ -216,11 +245,10 @@ err:
  * @return 0 on success, -errno on error.
  */
 static int encoder_communicate(struct pho_encoder *enc,
-                               struct pho_comm_info *comm, pho_resp_t *resp,
+                               struct write_sessions *ws, pho_resp_t *resp,
                                int enc_id)
 {
     pho_req_t *requests = NULL;
-    struct pho_comm_data data;
     size_t n_reqs = 0;
     size_t i = 0;
     int rc;
@@ -247,15 +275,18 @@ static int encoder_communicate(struct pho_encoder *enc,
             req->walloc->family = enc->xfer->xd_params.put.family;
             req->walloc->library =
                 xstrdup_safe(enc->xfer->xd_params.put.library);
+            req->walloc->grouping =
+                xstrdup_safe(enc->xfer->xd_params.put.grouping);
         }
 
-        data = pho_comm_data_init(comm);
-        pho_srl_request_pack(req, &data.buf);
-        pho_srl_request_free(req, false);
+        if ((pho_request_is_write(req) || pho_request_is_read(req)) &&
+            qos_class2str(enc->xfer->xd_qos)) {
+            req->has_qos = true;
+            req->qos = enc->xfer->xd_qos;
+        }
 
-        /* Send the request to the socket */
-        rc2 = pho_comm_send(&data);
-        free(data.buf.buff);
+        /* Send the request to the socket, unless a write session serves it */
+        rc2 = write_sessions_send(ws, req);
         if (rc2) {
             pho_error(rc2, "Error while sending request to LRS for %s",
                       enc->xfer->xd_objid);
@@ -561,8 +592,8 @@ static int object_hard_delete(struct dss_handle *dss, struct object_info *obj,
 {
     struct layout_info *layouts;
     struct dss_filter filter;
-    struct extent *extents;
-    GString *filter_str;
+    const char **uuids;
+    int ext_count = 0;
     int count;
     int i, j;
     int rc;
@@ -581,51 +612,31 @@ static int object_hard_delete(struct dss_handle *dss, struct object_info *obj,
         LOG_RETURN(rc, "Unable to retrieve layouts from object '%s:%d'",
                    obj->uuid, obj->version);
 
-    filter_str = g_string_new(NULL);
-    for (i = 0; i < count; ++i) {
-        for (j = 0; j < layouts[i].ext_count; ++j) {
-            int end_of_string = i == count - 1 && j == layouts[i].ext_count - 1;
-
-            g_string_append_printf(filter_str,
-                                   "  {\"DSS::EXT::uuid\": \"%s\"}%s",
-                                   layouts[i].extents[j].uuid,
-                                   end_of_string ? "" : ",");
-        }
-    }
+    for (i = 0; i < count; ++i)
+        ext_count += layouts[i].ext_count;
 
-    rc = dss_filter_build(&filter,
-                          "{\"$OR\": ["
-                          "  %s"
-                          "]}", filter_str->str);
-    g_string_free(filter_str, true);
-    if (rc) {
-        dss_res_free(layouts, count);
-        LOG_RETURN(rc,
-                   "Unable to build extents filter in object hard delete");
-    }
+    uuids = xcalloc(ext_count, sizeof(*uuids));
+    for (i = 0, ext_count = 0; i < count; ++i)
+        for (j = 0; j < layouts[i].ext_count; ++j)
+            uuids[ext_count++] = layouts[i].extents[j].uuid;
 
     rc = dss_layout_delete(dss, layouts, count);
-    dss_res_free(layouts, count);
-    if (rc) {
-        dss_filter_free(&filter);
-        LOG_RETURN(rc, "Unable to delete layouts for object '%s:%d'",
-                   obj->uuid, obj->version);
-    }
-
-    rc = dss_extent_get(dss, &filter, &extents, &count);
-    dss_filter_free(&filter);
     if (rc)
-        LOG_RETURN(rc, "Unable to retrieve extents from object '%s:%d'",
-                   obj->uuid, obj->version);
+        LOG_GOTO(out_free, rc, "Unable to delete layouts for object '%s:%d'",
+                 obj->uuid, obj->version);
 
-    for (i = 0; i < count; ++i)
-        extents[i].state = PHO_EXT_ST_ORPHAN;
+    /* Extents shared with deduplicated objects are kept alive */
+    rc = dss_update_extent_release(dss, uuids, ext_count, obj->uuid,
+                                   obj->version);
+    if (rc)
+        LOG_GOTO(out_free, rc, "Unable to release object '%s:%d' extents",
+                 obj->uuid, obj->version);
 
-    rc = dss_extent_update(dss, extents, extents, count);
-    dss_res_free(extents, count);
+out_free:
+    free(uuids);
+    dss_res_free(layouts, count);
     if (rc)
-        LOG_RETURN(rc, "Unable to update object '%s:%d' extents state",
-                   obj->uuid, obj->version);
+        return rc;
 
     if (is_deprec)
         rc = dss_deprecated_object_delete(dss, obj, 1);
@@ -999,6 +1010,65 @@ static const char *oid_or_uuid_val(struct pho_xfer_desc *xfer)
     return is_uuid_arg(xfer) ? xfer->xd_objuuid : xfer->xd_objid;
 }
 
+/**
+ * Record the content digest of a successfully written PUT transfer, so that
+ * later PUTs of the same content can share its layout. A failure only prevents
+ * further deduplication and is not reported to the transfer.
+ */
+static void dedup_register(struct phobos_handle *pho, size_t xfer_idx)
+{
+    struct pho_xfer_desc *xfer = &pho->xfers[xfer_idx];
+    int rc;
+
+    rc = dss_dedup_register(&pho->dss, pho->dedup[xfer_idx].digest,
+                            xfer->xd_params.put.size, xfer->xd_objuuid,
+                            xfer->xd_version);
+    if (rc)
+        pho_warn("Unable to register the content of objid:'%s' for "
+                 "deduplication (%d, %s)", xfer->xd_objid, rc, strerror(-rc));
+}
+
+/**
+ * Save the layout of a packed PUT transfer once its packing encoder has
+ * written the data: the layout references the extents of the packing encoder,
+ * which have already been saved.
+ */
+static int store_save_packed_layout(struct phobos_handle *pho,
+                                    size_t xfer_idx)
+{
+    struct layout_info *container =
+        pho->encoders[pho->packed_in[xfer_idx]].layout;
+    struct layout_info *layout = pho->encoders[xfer_idx].layout;
+    struct pho_xfer_desc *xfer = &pho->xfers[xfer_idx];
+    struct object_info obj = {
+        .oid = xfer->xd_objid,
+        .obj_status = PHO_OBJ_STATUS_COMPLETE,
+    };
+    int rc;
+
+    pho_debug("Saving packed layout for objid:'%s'", xfer->xd_objid);
+
+    /* The extents are owned by the packing encoder layout */
+    layout->extents = container->extents;
+    layout->ext_count = container->ext_count;
+    rc = dss_layout_insert(&pho->dss, layout, 1);
+    layout->extents = NULL;
+    layout->ext_count = 0;
+    if (rc)
+        LOG_RETURN(rc, "Error while saving layout for objid: '%s'",
+                   xfer->xd_objid);
+
+    rc = dss_object_update(&pho->dss, &obj, &obj, 1,
+                           DSS_OBJECT_UPDATE_OBJ_STATUS);
+    if (rc)
+        LOG_RETURN(rc, "Error while updating object status to complete");
+
+    if (pho->dedup && pho->dedup[xfer_idx].digest)
+        dedup_register(pho, xfer_idx);
+
+    return 0;
+}
+
 /**
  * Mark the end of a transfer (successful or not) by updating the encoder
  * structure, saving the encoder layout to the DSS if necessary, properly
@@ -1016,6 +1086,7 @@ static void store_end_xfer(struct phobos_handle *pho, size_t xfer_idx, int rc)
 {
     struct pho_encoder *enc = &pho->encoders[xfer_idx];
     struct pho_xfer_desc *xfer = &pho->xfers[xfer_idx];
+    int rc2;
     int i;
 
     /* Don't end an encoder twice */
@@ -1027,6 +1098,36 @@ static void store_end_xfer(struct phobos_handle *pho, size_t xfer_idx, int rc)
     pho->n_ended_xfers++;
     enc->done = true;
 
+    /* A write session does not wait for the release of this transfer */
+    rc2 = write_sessions_xfer_end(&pho->sessions, xfer_idx);
+    if (rc2)
+        pho_error(rc2, "Error while closing write session of objid: '%s'",
+                  xfer->xd_objid);
+    rc = rc ? : rc2;
+
+    /* A packed object gets the extents written by its packing encoder */
+    if (!enc->is_decoder && xfer->xd_rc == 0 && rc == 0 && pho->packed_in &&
+            pho->packed_in[xfer_idx] >= 0) {
+        rc = store_save_packed_layout(pho, xfer_idx);
+        goto cont;
+    }
+
+    /* A duplicated object already shares the layout of its duplicate */
+    if (!enc->is_decoder && xfer->xd_rc == 0 && rc == 0 && pho->dedup &&
+            pho->dedup[xfer_idx].match_uuid) {
+        struct object_info obj = {
+            .oid = xfer->xd_objid,
+            .obj_status = PHO_OBJ_STATUS_COMPLETE,
+        };
+
+        rc = dss_object_update(&pho->dss, &obj, &obj, 1,
+                               DSS_OBJECT_UPDATE_OBJ_STATUS);
+        if (rc)
+            pho_error(rc, "Error while updating object status to complete");
+
+        goto cont;
+    }
+
     /* Once the encoder is done and successful, save the layout and metadata */
     if (!enc->is_decoder && xfer->xd_rc == 0 && rc == 0) {
         pho_debug("Saving layout for objid:'%s'", xfer->xd_objid);
@@ -1038,8 +1139,6 @@ static void store_end_xfer(struct phobos_handle *pho, size_t xfer_idx, int rc)
         } else {
             rc = dss_layout_insert(&pho->dss, enc->layout, 1);
             if (rc) {
-                int rc2;
-
                 pho_error(rc, "Error while saving layout for objid: '%s'",
                           xfer->xd_objid);
 
@@ -1063,6 +1162,8 @@ static void store_end_xfer(struct phobos_handle *pho, size_t xfer_idx, int rc)
                 if (rc)
                     pho_error(rc,
                               "Error while updating object status to complete");
+                else if (pho->dedup && pho->dedup[xfer_idx].digest)
+                    dedup_register(pho, xfer_idx);
             }
         }
     }
@@ -1071,6 +1172,10 @@ static void store_end_xfer(struct phobos_handle *pho, size_t xfer_idx, int rc)
     if (xfer->xd_rc == 0 && rc == 0 && xfer->xd_op == PHO_XFER_OP_GET) {
         struct object_info *obj;
 
+        /* A failure to cache the object does not fail the transfer */
+        if (pho->cache_info)
+            read_cache_add(&pho->cache, xfer, &pho->cache_info[xfer_idx]);
+
         rc = dss_lazy_find_object(&pho->dss, xfer->xd_objid,
                                   xfer->xd_objuuid, xfer->xd_version, &obj);
         if (rc)
@@ -1114,8 +1219,20 @@ cont:
             xfer->xd_op == PHO_XFER_OP_PUT && xfer->xd_rc)
         object_md_del(&pho->dss, xfer);
 
+    /* The cached versions of an overwritten object are not read anymore */
+    if (pho->cache_info && xfer->xd_op == PHO_XFER_OP_PUT &&
+            xfer->xd_rc == 0 && (xfer->xd_flags & PHO_XFER_OBJ_REPLACE))
+        read_cache_invalidate(&pho->cache, xfer->xd_objuuid);
+
     if (pho->cb)
         pho->cb(pho->udata, xfer, rc);
+
+    /* The objects packed by this encoder end with it */
+    if (pho->packed_in) {
+        for (i = 0; i < pho->n_xfers; i++)
+            if (pho->packed_in[i] == (ssize_t) xfer_idx)
+                store_end_xfer(pho, i, xfer->xd_rc);
+    }
 }
 
 /**
@@ -1124,8 +1241,12 @@ cont:
  */
 static void store_fini(struct phobos_handle *pho, int rc)
 {
+    bool sessions_idle = write_sessions_idle(&pho->sessions);
     size_t i;
 
+    /* Sessions still opened are left to the LRS with the connection */
+    write_sessions_fini(&pho->sessions);
+
     /* Cleanup encoders */
     for (i = 0; i < pho->n_xfers; i++) {
         /**
@@ -1148,18 +1269,27 @@ static void store_fini(struct phobos_handle *pho, int rc)
         }
     }
 
+    if (pho->dedup)
+        for (i = 0; i < pho->n_xfers; i++)
+            dedup_info_clean(&pho->dedup[i]);
+
     free(pho->encoders);
     free(pho->ended_xfers);
     free(pho->md_created);
+    free(pho->dedup);
+    free(pho->packed_in);
+    free(pho->cache_info);
     pho->encoders = NULL;
     pho->ended_xfers = NULL;
     pho->md_created = NULL;
-
-    rc = pho_comm_close(&pho->comm);
-    if (rc)
-        pho_error(rc, "Cannot close the communication socket");
-
-    dss_fini(&pho->dss);
+    pho->dedup = NULL;
+    pho->packed_in = NULL;
+    pho->cache_info = NULL;
+    read_cache_fini(&pho->cache);
+
+    /* Responses to the requests of failed transfers may still be received */
+    store_pool_put_lrs(&pho->comm, rc == 0 && sessions_idle);
+    store_pool_put_dss(&pho->dss);
 }
 
 /**
@@ -1177,7 +1307,7 @@ static void store_fini(struct phobos_handle *pho, int rc)
 static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
                       size_t n_xfers, pho_completion_cb_t cb, void *udata)
 {
-    union pho_comm_addr sock_addr;
+    const char *sock_path;
     size_t i;
     int rc;
 
@@ -1192,6 +1322,9 @@ static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
     pho->ended_xfers = NULL;
     pho->encoders = NULL;
     pho->md_created = NULL;
+    pho->dedup = NULL;
+    pho->packed_in = NULL;
+    pho->cache_info = NULL;
 
     /* Check xfers consistency */
     for (i = 0; i < n_xfers; i++) {
@@ -1205,15 +1338,16 @@ static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
     if (rc && rc != -EALREADY)
         return rc;
 
-    sock_addr.af_unix.path = PHO_CFG_GET(cfg_store, PHO_CFG_STORE, lrs_socket);
+    sock_path = PHO_CFG_GET(cfg_store, PHO_CFG_STORE, lrs_socket);
+    write_sessions_init(&pho->sessions, &pho->comm);
 
     /* Connect to the DSS */
-    rc = dss_init(&pho->dss);
+    rc = store_pool_get_dss(&pho->dss);
     if (rc != 0)
         return rc;
 
     /* Connect to the LRS */
-    rc = pho_comm_open(&pho->comm, &sock_addr, PHO_COMM_UNIX_CLIENT);
+    rc = store_pool_get_lrs(&pho->comm, sock_path);
     if (rc)
         LOG_GOTO(out, rc, "Cannot contact 'phobosd': will abort");
 
@@ -1229,6 +1363,22 @@ static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
      */
     pho->md_created = xcalloc(n_xfers, sizeof(*pho->md_created));
 
+    if (PHO_CFG_GET_BOOL(cfg_store, PHO_CFG_STORE, dedup, false))
+        pho->dedup = xcalloc(n_xfers, sizeof(*pho->dedup));
+
+    /* Transfers are written by their own encoder unless packed */
+    pho->packed_in = xmalloc(n_xfers * sizeof(*pho->packed_in));
+    for (i = 0; i < n_xfers; i++)
+        pho->packed_in[i] = -1;
+
+    read_cache_init(&pho->cache);
+    if (pho->cache.dir) {
+        pho->cache_info = xcalloc(n_xfers, sizeof(*pho->cache_info));
+        /* nothing is cached until read_cache_get() says so */
+        for (i = 0; i < n_xfers; i++)
+            pho->cache_info[i].start = -1;
+    }
+
     /* Initialize all the encoders */
     for (i = 0; i < n_xfers; i++) {
         pho_debug("Initializing %s %ld for objid:'%s'",
@@ -1254,14 +1404,19 @@ static int store_lrs_response_process(struct phobos_handle *pho,
                                       pho_resp_t *resp)
 {
     struct pho_encoder *encoder = &pho->encoders[resp->req_id];
+    int rc2;
     int rc;
 
+    /* The release of a write session was already answered to its transfers */
+    if (write_sessions_recv(&pho->sessions, resp))
+        return 0;
+
     pho_debug("%s for objid:'%s' received a response of type %s",
               encoder->is_decoder ? "Decoder" : "Encoder",
               encoder->xfer->xd_objid,
               pho_srl_response_kind_str(resp));
 
-    rc = encoder_communicate(encoder, &pho->comm, resp, resp->req_id);
+    rc = encoder_communicate(encoder, &pho->sessions, resp, resp->req_id);
 
     /* Success or failure final callback */
     if (rc || encoder->done)
@@ -1271,7 +1426,12 @@ static int store_lrs_response_process(struct phobos_handle *pho,
         pho_error(rc, "Error while sending response to layout for %s",
                   encoder->xfer->xd_objid);
 
-    return rc;
+    /* The requests waiting for this allocation can now be served */
+    rc2 = write_sessions_flush(&pho->sessions);
+    if (rc2)
+        pho_error(rc2, "Error while sending write session requests to LRS");
+
+    return rc ? : rc2;
 }
 
 static int store_dispatch_loop(struct phobos_handle *pho)
@@ -1281,6 +1441,19 @@ static int store_dispatch_loop(struct phobos_handle *pho)
     int rc = 0;
     int i;
     pho_resp_t **resps = NULL;
+    pho_resp_t *resp;
+
+    /* Responses built by the write sessions are dispatched first */
+    resp = write_sessions_pop_response(&pho->sessions);
+    if (resp) {
+        do {
+            rc = store_lrs_response_process(pho, resp);
+            write_sessions_response_free(resp);
+        } while (!rc &&
+                 (resp = write_sessions_pop_response(&pho->sessions)));
+
+        return rc;
+    }
 
     /* Collect LRS responses */
     rc = pho_comm_recv(&pho->comm, &responses, &n_responses);
@@ -1339,6 +1512,46 @@ static int store_dispatch_loop(struct phobos_handle *pho)
     return rc;
 }
 
+/**
+ * Pack the data of the PUT transfers in the extents written by the encoder of
+ * a previous PUT transfer of the batch, when their layout supports it. A
+ * packed transfer does not emit any request and ends with its packing
+ * encoder.
+ *
+ * Packing is done once the metadata of the objects are saved, so that failed
+ * or deduplicated objects are not packed.
+ *
+ * @param[in]   pho     Phobos handle describing the transfers.
+ */
+static void store_pack_xfers(struct phobos_handle *pho)
+{
+    ssize_t container = -1;
+    size_t i;
+
+    for (i = 0; i < pho->n_xfers; i++) {
+        int rc;
+
+        if (pho->xfers[i].xd_op != PHO_XFER_OP_PUT || pho->encoders[i].done)
+            continue;
+
+        if (container >= 0) {
+            rc = layout_pack(&pho->encoders[container], &pho->encoders[i]);
+            if (rc == 0) {
+                pho->packed_in[i] = container;
+                continue;
+            }
+
+            if (rc != -ENOTSUP && rc != -ENOSPC)
+                pho_warn("Unable to pack objid:'%s' with objid:'%s' (%d, %s)",
+                         pho->xfers[i].xd_objid,
+                         pho->xfers[container].xd_objid, rc, strerror(-rc));
+        }
+
+        /* Next objects may be packed with this one */
+        container = i;
+    }
+}
+
 /**
  * Perform the main store loop:
  * - collect requests from encoders
@@ -1373,6 +1586,8 @@ static int store_perform_xfers(struct phobos_handle *pho)
             if (rc)
                 pho_error(rc, "Error while deleting objid: '%s'",
                           pho->xfers[i].xd_objid);
+            else if (pho->cache_info)
+                read_cache_invalidate(&pho->cache, pho->xfers[i].xd_objuuid);
             store_end_xfer(pho, i, rc);
         }
 
@@ -1388,6 +1603,21 @@ static int store_perform_xfers(struct phobos_handle *pho)
             store_end_xfer(pho, i, rc);
         }
 
+        /* A cached object is retrieved without any allocation */
+        if (pho->xfers[i].xd_op == PHO_XFER_OP_GET && pho->cache_info &&
+                !pho->encoders[i].done) {
+            size_t object_size;
+
+            /* without the object size, an entry cannot be checked */
+            rc = layout_object_size(&pho->encoders[i], &object_size);
+            if (!rc)
+                rc = read_cache_get(&pho->cache, &pho->xfers[i], object_size,
+                                    &pho->cache_info[i]);
+            if (rc != -ENOENT && rc != -ENOTSUP)
+                store_end_xfer(pho, i, rc);
+            rc = 0;
+        }
+
         if (pho->xfers[i].xd_op != PHO_XFER_OP_PUT)
             continue;
         rc = object_md_save(&pho->dss, &pho->xfers[i]);
@@ -1397,20 +1627,46 @@ static int store_perform_xfers(struct phobos_handle *pho)
             store_end_xfer(pho, i, rc);
         }
         pho->md_created[i] = true;
+
+        if (!pho->dedup || pho->encoders[i].done)
+            continue;
+
+        /* An object with a known content is saved without any IO */
+        rc = dedup_lookup(&pho->dss, &pho->xfers[i], &pho->dedup[i]);
+        if (rc) {
+            pho_warn("Deduplication failed for objid:'%s' (%d, %s), "
+                     "its content will be written", pho->xfers[i].xd_objid,
+                     rc, strerror(-rc));
+        } else if (pho->dedup[i].match_uuid) {
+            /* the match is dropped if its extents were released meanwhile */
+            rc = dedup_share(&pho->dss, &pho->xfers[i], &pho->dedup[i]);
+            if (rc)
+                pho_error(rc, "Error while sharing layout for objid: '%s'",
+                          pho->xfers[i].xd_objid);
+            if (rc || pho->dedup[i].match_uuid)
+                store_end_xfer(pho, i, rc);
+        }
+        rc = 0;
     }
 
+    store_pack_xfers(pho);
+
     /* Generate all first requests of encoders */
     for (i = 0; i < pho->n_xfers; i++) {
         if (pho->encoders[i].done)
             continue;
 
-        rc = encoder_communicate(&pho->encoders[i], &pho->comm, NULL, i);
+        rc = encoder_communicate(&pho->encoders[i], &pho->sessions, NULL, i);
         if (rc)
             store_end_xfer(pho, i, rc);
     }
 
-    /* Handle all encoders and forward messages between them and the LRS */
-    while (pho->n_ended_xfers < pho->n_xfers) {
+    /*
+     * Handle all encoders and forward messages between them and the LRS, until
+     * the releases of the write sessions are acknowledged
+     */
+    while (pho->n_ended_xfers < pho->n_xfers ||
+           !write_sessions_idle(&pho->sessions)) {
         rc = store_dispatch_loop(pho);
         if (rc)
             break;
@@ -1600,12 +1856,33 @@ int phobos_undelete(struct pho_xfer_desc *xfers, size_t num_xfers)
     return phobos_xfer(xfers, num_xfers, NULL, NULL);
 }
 
+int phobos_read_cache_stats(struct pho_read_cache_stats *stats)
+{
+    struct read_cache cache;
+    int rc;
+
+    /* Ensure conf is loaded */
+    rc = pho_cfg_init_local(NULL);
+    if (rc && rc != -EALREADY)
+        return rc;
+
+    read_cache_init(&cache);
+    if (!cache.dir)
+        LOG_RETURN(-ENOTSUP, "The read cache is disabled, set 'cache_dir' "
+                   "and 'cache_max_bytes' in section 'store' to enable it");
+
+    rc = read_cache_stats_get(&cache, stats);
+    read_cache_fini(&cache);
+
+    return rc;
+}
+
 int phobos_rename(const char *old_oid, const char *uuid, char *new_oid)
 {
     struct object_info *deprec_objects = NULL;
     struct object_info *objects = NULL;
     struct dss_filter filter;
-    struct dss_handle dss;
+    struct dss_handle dss = {0};
     int objects_count = 0;
     int deprec_count = 0;
     int rc;
@@ -1625,7 +1902,7 @@ int phobos_rename(const char *old_oid, const char *uuid, char *new_oid)
         LOG_GOTO(clean, rc, "Cannot init access to local config parameters");
 
     /* Connect to the DSS */
-    rc = dss_init(&dss);
+    rc = store_pool_get_dss(&dss);
     if (rc)
         LOG_GOTO(clean, rc, "Cannot initialize a connection handle");
 
@@ -1702,7 +1979,7 @@ clean:
     if (old_oid)
         uuid = NULL;
 
-    dss_fini(&dss);
+    store_pool_put_dss(&dss);
 
     return rc;
 }
@@ -1748,7 +2025,7 @@ int phobos_locate(const char *oid, const char *uuid, int version,
         return rc;
 
     /* Connect to the DSS */
-    rc = dss_init(&dss);
+    rc = store_pool_get_dss(&dss);
     if (rc)
         return rc;
 
@@ -1782,6 +2059,6 @@ int phobos_locate(const char *oid, const char *uuid, int version,
 
 clean:
     object_info_free(obj);
-    dss_fini(&dss);
+    store_pool_put_dss(&dss);
     return rc;
 }
@@ -41,6 +41,8 @@
 #define ALIAS_LYT_PARAMS_CFG_PARAM "lyt-params"
 #define ALIAS_TAGS_CFG_PARAM "tags"
 #define ALIAS_LIBRARY_CFG_PARAM "library"
+#define ALIAS_COMPRESSION_CFG_PARAM "compression"
+#define ALIAS_QOS_CFG_PARAM "qos"
 
 /**
  * List of configuration parameters for alias store
@@ -207,6 +209,30 @@ static int apply_alias_to_put_params(struct pho_xfer_desc *xfer)
             goto out;
     }
 
+    // compression
+    if (xfer->xd_params.put.compression == NULL) {
+        rc = pho_cfg_get_val(section_name, ALIAS_COMPRESSION_CFG_PARAM,
+                             &cfg_val);
+        if (!rc)
+            xfer->xd_params.put.compression = cfg_val;
+        else if (rc != -ENODATA)
+            goto out;
+    }
+
+    // qos
+    if (xfer->xd_qos == PHO_QOS_UNSET) {
+        rc = pho_cfg_get_val(section_name, ALIAS_QOS_CFG_PARAM, &cfg_val);
+        if (!rc) {
+            xfer->xd_qos = str2qos_class(cfg_val);
+            if (xfer->xd_qos == PHO_QOS_INVAL)
+                LOG_GOTO(out, rc = -EINVAL,
+                         "Invalid QoS class '%s' in alias '%s'", cfg_val,
+                         xfer->xd_params.put.alias);
+        } else if (rc != -ENODATA) {
+            goto out;
+        }
+    }
+
     free(section_name);
     return 0;
 
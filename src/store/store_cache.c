@@ -0,0 +1,577 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Read cache of Phobos store
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "store_cache.h"
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * List of configuration parameters for the read cache of the store
+ */
+enum pho_cfg_params_store_cache {
+    PHO_CFG_STORE_FIRST,
+
+    /* store parameters */
+    PHO_CFG_STORE_cache_dir = PHO_CFG_STORE_FIRST,
+    PHO_CFG_STORE_cache_max_bytes,
+
+    PHO_CFG_STORE_LAST
+};
+
+const struct pho_config_item cfg_store_cache[] = {
+    [PHO_CFG_STORE_cache_dir] = {
+        .section = "store",
+        .name    = "cache_dir",
+        .value   = ""
+    },
+    [PHO_CFG_STORE_cache_max_bytes] = {
+        .section = "store",
+        .name    = "cache_max_bytes",
+        .value   = "0"
+    },
+};
+
+/**
+ * File of the counters shared by the users of the cache, its name starts with
+ * a '.' so that it is never taken for an entry.
+ */
+#define CACHE_STATS_FILE ".stats"
+
+struct cache_entry {
+    char *path;
+    off_t size;
+    struct timespec mtime;
+};
+
+void read_cache_init(struct read_cache *cache)
+{
+    const char *dir;
+
+    memset(cache, 0, sizeof(*cache));
+
+    dir = PHO_CFG_GET(cfg_store_cache, PHO_CFG_STORE, cache_dir);
+    if (!dir || dir[0] == '\0')
+        return;
+
+    cache->max_bytes = str2int64(PHO_CFG_GET(cfg_store_cache, PHO_CFG_STORE,
+                                             cache_max_bytes));
+    if (cache->max_bytes < 0)
+        pho_warn("Invalid value for cache_max_bytes in section store, the "
+                 "read cache is disabled");
+    if (cache->max_bytes <= 0)
+        return;
+
+    cache->dir = xstrdup(dir);
+}
+
+void read_cache_fini(struct read_cache *cache)
+{
+    free(cache->dir);
+    cache->dir = NULL;
+}
+
+/**
+ * Add \p hits, \p misses and \p evictions to the counters of the cache, and
+ * retrieve their new values in \p stats if not NULL.
+ *
+ * The counters file is locked so that the processes sharing the cache do not
+ * lose any update.
+ */
+static int cache_counters_update(const struct read_cache *cache, size_t hits,
+                                 size_t misses, size_t evictions,
+                                 struct pho_read_cache_stats *stats)
+{
+    struct pho_read_cache_stats counters = {0};
+    char buffer[128];
+    char *path;
+    ssize_t len;
+    int rc = 0;
+    int fd;
+
+    if (asprintf(&path, "%s/%s", cache->dir, CACHE_STATS_FILE) < 0)
+        return -ENOMEM;
+
+    fd = open(path, O_RDWR | O_CREAT, 0600);
+    free(path);
+    if (fd < 0)
+        LOG_RETURN(-errno, "Cannot open the statistics of read cache '%s'",
+                   cache->dir);
+
+    if (flock(fd, LOCK_EX))
+        LOG_GOTO(out, rc = -errno,
+                 "Cannot lock the statistics of read cache '%s'", cache->dir);
+
+    len = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (len < 0)
+        LOG_GOTO(out, rc = -errno,
+                 "Cannot read the statistics of read cache '%s'", cache->dir);
+
+    buffer[len] = '\0';
+    /* a new or damaged file restarts the counters from 0 */
+    if (sscanf(buffer, "%zu %zu %zu", &counters.hits, &counters.misses,
+               &counters.evictions) != 3)
+        memset(&counters, 0, sizeof(counters));
+
+    counters.hits += hits;
+    counters.misses += misses;
+    counters.evictions += evictions;
+
+    if (hits || misses || evictions) {
+        len = snprintf(buffer, sizeof(buffer), "%zu %zu %zu\n", counters.hits,
+                       counters.misses, counters.evictions);
+        if (pwrite(fd, buffer, len, 0) != len || ftruncate(fd, len))
+            LOG_GOTO(out, rc = -errno,
+                     "Cannot update the statistics of read cache '%s'",
+                     cache->dir);
+    }
+
+    if (stats) {
+        stats->hits = counters.hits;
+        stats->misses = counters.misses;
+        stats->evictions = counters.evictions;
+    }
+
+out:
+    /* releases the lock as well */
+    close(fd);
+    return rc;
+}
+
+/**
+ * Copy \p size bytes of \p in_fd from \p offset to the current offset of
+ * \p out_fd.
+ */
+static int copy_range(int out_fd, int in_fd, off_t offset, size_t size)
+{
+    while (size > 0) {
+        ssize_t nb_copied = sendfile(out_fd, in_fd, &offset, size);
+
+        if (nb_copied < 0) {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        /* the source is shorter than expected */
+        if (nb_copied == 0)
+            return -EIO;
+
+        size -= nb_copied;
+    }
+
+    return 0;
+}
+
+int read_cache_get(struct read_cache *cache, struct pho_xfer_desc *xfer,
+                   size_t object_size, struct cache_info *info)
+{
+    struct pho_xfer_get_params *params = &xfer->xd_params.get;
+    off_t start;
+    struct stat st;
+    char *path;
+    size_t size;
+    int fd;
+    int rc;
+
+    info->hit = false;
+    info->start = -1;
+
+    if (asprintf(&path, "%s/%s/%d", cache->dir, xfer->xd_objuuid,
+                 xfer->xd_version) < 0)
+        return -ENOMEM;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT)
+            pho_warn("Cannot open read cache entry '%s': %s", path,
+                     strerror(errno));
+        free(path);
+        goto miss;
+    }
+
+    if (fstat(fd, &st)) {
+        pho_warn("Cannot stat read cache entry '%s': %s", path,
+                 strerror(errno));
+        close(fd);
+        free(path);
+        goto miss;
+    }
+
+    /* an entry not matching its object, e.g. truncated, is never served */
+    if ((size_t)st.st_size != object_size) {
+        pho_warn("Read cache entry '%s' has %zu bytes instead of %zu, "
+                 "removing it", path, (size_t)st.st_size, object_size);
+        if (unlink(path) && errno != ENOENT)
+            pho_warn("Cannot remove read cache entry '%s': %s", path,
+                     strerror(errno));
+        close(fd);
+        free(path);
+        goto miss;
+    }
+    free(path);
+
+    /* let the object store report the ranges out of the object */
+    if (params->offset > (size_t)st.st_size) {
+        close(fd);
+        goto miss;
+    }
+
+    size = st.st_size - params->offset;
+    if (params->size && params->size < size)
+        size = params->size;
+
+    start = lseek(xfer->xd_fd, 0, SEEK_CUR);
+    rc = copy_range(xfer->xd_fd, fd, params->offset, size);
+    if (rc) {
+        close(fd);
+        /* nothing was written, the object can still be retrieved */
+        if (start >= 0 && lseek(xfer->xd_fd, 0, SEEK_CUR) == start) {
+            pho_warn("Cannot copy objid:'%s' from the read cache: %s",
+                     xfer->xd_objid, strerror(-rc));
+            goto miss;
+        }
+        LOG_RETURN(rc, "Cannot copy objid:'%s' from the read cache",
+                   xfer->xd_objid);
+    }
+
+    /* the entry is now the most recently used */
+    futimens(fd, NULL);
+    close(fd);
+
+    info->hit = true;
+    cache_counters_update(cache, 1, 0, 0, NULL);
+    pho_verb("objid:'%s' served by the read cache", xfer->xd_objid);
+
+    return 0;
+
+miss:
+    cache_counters_update(cache, 0, 1, 0, NULL);
+    /* only whole objects are cached */
+    if (params->offset == 0 && params->size == 0)
+        info->start = lseek(xfer->xd_fd, 0, SEEK_CUR);
+
+    return -ENOENT;
+}
+
+/**
+ * List the entries of the cache, appending a struct cache_entry to \p entries
+ * for each of them, and add their size to \p total.
+ *
+ * The temporary files and the counters, whose names start with a '.', are
+ * skipped.
+ */
+static int cache_entries_get(const struct read_cache *cache, GArray *entries,
+                             size_t *total)
+{
+    struct dirent *object;
+    DIR *root;
+
+    root = opendir(cache->dir);
+    if (!root)
+        LOG_RETURN(-errno, "Cannot open read cache '%s'", cache->dir);
+
+    while ((object = readdir(root)) != NULL) {
+        struct dirent *version;
+        char *object_path;
+        DIR *versions;
+
+        if (object->d_name[0] == '.')
+            continue;
+
+        if (asprintf(&object_path, "%s/%s", cache->dir, object->d_name) < 0)
+            continue;
+
+        versions = opendir(object_path);
+        if (!versions) {
+            free(object_path);
+            continue;
+        }
+
+        while ((version = readdir(versions)) != NULL) {
+            struct cache_entry entry;
+            struct stat st;
+
+            if (version->d_name[0] == '.')
+                continue;
+
+            if (fstatat(dirfd(versions), version->d_name, &st, 0) ||
+                !S_ISREG(st.st_mode))
+                continue;
+
+            if (asprintf(&entry.path, "%s/%s", object_path,
+                         version->d_name) < 0)
+                continue;
+
+            entry.size = st.st_size;
+            entry.mtime = st.st_mtim;
+            g_array_append_val(entries, entry);
+            *total += st.st_size;
+        }
+
+        closedir(versions);
+        free(object_path);
+    }
+
+    closedir(root);
+
+    return 0;
+}
+
+static void cache_entries_free(GArray *entries)
+{
+    guint i;
+
+    for (i = 0; i < entries->len; ++i)
+        free(g_array_index(entries, struct cache_entry, i).path);
+
+    g_array_free(entries, TRUE);
+}
+
+static gint cache_entry_mtime_cmp(gconstpointer lhs, gconstpointer rhs)
+{
+    const struct cache_entry *left = lhs;
+    const struct cache_entry *right = rhs;
+
+    return cmp_timespec(&left->mtime, &right->mtime);
+}
+
+/**
+ * Evict the least recently used entries until \p size more bytes fit in the
+ * cache.
+ *
+ * The size of the cache is not kept anywhere, so the whole cache is listed,
+ * i.e. one stat per entry, each time an object is added.
+ */
+static int cache_evict(struct read_cache *cache, size_t size)
+{
+    size_t n_evicted = 0;
+    size_t total = 0;
+    GArray *entries;
+    guint i;
+    int rc;
+
+    entries = g_array_new(FALSE, FALSE, sizeof(struct cache_entry));
+    rc = cache_entries_get(cache, entries, &total);
+    if (rc)
+        goto free_entries;
+
+    g_array_sort(entries, cache_entry_mtime_cmp);
+
+    for (i = 0; i < entries->len && total + size > cache->max_bytes; ++i) {
+        struct cache_entry *entry = &g_array_index(entries, struct cache_entry,
+                                                   i);
+        char *sep;
+
+        /* the entry may be evicted by another process at the same time */
+        if (unlink(entry->path) && errno != ENOENT) {
+            pho_warn("Cannot evict read cache entry '%s': %s", entry->path,
+                     strerror(errno));
+            continue;
+        }
+
+        total -= entry->size;
+        n_evicted++;
+
+        /* remove the directory of the object once empty */
+        sep = strrchr(entry->path, '/');
+        *sep = '\0';
+        rmdir(entry->path);
+    }
+
+    if (n_evicted) {
+        pho_verb("Evicted %zu entries from read cache '%s'", n_evicted,
+                 cache->dir);
+        cache_counters_update(cache, 0, 0, n_evicted, NULL);
+    }
+
+free_entries:
+    cache_entries_free(entries);
+
+    return rc;
+}
+
+int read_cache_add(struct read_cache *cache, struct pho_xfer_desc *xfer,
+                   const struct cache_info *info)
+{
+    char *tmp_path;
+    char *path;
+    char *dir;
+    char fd_path[64];
+    int out_fd = -1;
+    int in_fd = -1;
+    size_t size;
+    off_t end;
+    int rc;
+
+    if (info->hit || info->start < 0)
+        return 0;
+
+    end = lseek(xfer->xd_fd, 0, SEEK_CUR);
+    if (end < info->start)
+        return 0;
+
+    size = end - info->start;
+    if (size > cache->max_bytes) {
+        pho_verb("objid:'%s' is larger than read cache '%s', not cached",
+                 xfer->xd_objid, cache->dir);
+        return 0;
+    }
+
+    if (asprintf(&dir, "%s/%s", cache->dir, xfer->xd_objuuid) < 0)
+        return -ENOMEM;
+
+    if (asprintf(&path, "%s/%d", dir, xfer->xd_version) < 0) {
+        path = NULL;
+        GOTO(free_paths, rc = -ENOMEM);
+    }
+
+    /* written next to the entries, so that it can be renamed to its entry */
+    if (asprintf(&tmp_path, "%s/.%s.%d.%d", cache->dir, xfer->xd_objuuid,
+                 xfer->xd_version, getpid()) < 0) {
+        tmp_path = NULL;
+        GOTO(free_paths, rc = -ENOMEM);
+    }
+
+    /* the destination is usually opened for writing only */
+    snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", xfer->xd_fd);
+    in_fd = open(fd_path, O_RDONLY);
+    if (in_fd < 0)
+        LOG_GOTO(free_paths, rc = -errno,
+                 "Cannot read back objid:'%s' to add it to the read cache",
+                 xfer->xd_objid);
+
+    rc = cache_evict(cache, size);
+    if (rc)
+        goto close_in;
+
+    out_fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (out_fd < 0)
+        LOG_GOTO(close_in, rc = -errno, "Cannot create read cache entry '%s'",
+                 tmp_path);
+
+    rc = copy_range(out_fd, in_fd, info->start, size);
+    if (close(out_fd) && !rc)
+        rc = -errno;
+    if (rc)
+        LOG_GOTO(unlink_tmp, rc, "Cannot copy objid:'%s' to the read cache",
+                 xfer->xd_objid);
+
+    if (mkdir(dir, 0700) && errno != EEXIST)
+        LOG_GOTO(unlink_tmp, rc = -errno, "Cannot create directory '%s'",
+                 dir);
+
+    /* the entry is only visible once complete */
+    if (rename(tmp_path, path))
+        LOG_GOTO(unlink_tmp, rc = -errno,
+                 "Cannot add read cache entry '%s'", path);
+
+    pho_verb("objid:'%s' added to read cache '%s'", xfer->xd_objid,
+             cache->dir);
+    goto close_in;
+
+unlink_tmp:
+    unlink(tmp_path);
+close_in:
+    close(in_fd);
+free_paths:
+    free(tmp_path);
+    free(path);
+    free(dir);
+
+    return rc;
+}
+
+void read_cache_invalidate(struct read_cache *cache, const char *uuid)
+{
+    struct dirent *version;
+    DIR *versions;
+    char *dir;
+
+    if (asprintf(&dir, "%s/%s", cache->dir, uuid) < 0)
+        return;
+
+    versions = opendir(dir);
+    if (!versions) {
+        if (errno != ENOENT)
+            pho_warn("Cannot open read cache directory '%s': %s", dir,
+                     strerror(errno));
+        free(dir);
+        return;
+    }
+
+    while ((version = readdir(versions)) != NULL) {
+        if (!strcmp(version->d_name, ".") || !strcmp(version->d_name, ".."))
+            continue;
+
+        if (unlinkat(dirfd(versions), version->d_name, 0) && errno != ENOENT)
+            pho_warn("Cannot remove read cache entry '%s/%s': %s", dir,
+                     version->d_name, strerror(errno));
+    }
+
+    closedir(versions);
+    rmdir(dir);
+    pho_verb("Removed object '%s' from read cache '%s'", uuid, cache->dir);
+    free(dir);
+}
+
+int read_cache_stats_get(struct read_cache *cache,
+                         struct pho_read_cache_stats *stats)
+{
+    size_t total = 0;
+    GArray *entries;
+    int rc;
+
+    memset(stats, 0, sizeof(*stats));
+
+    rc = cache_counters_update(cache, 0, 0, 0, stats);
+    if (rc)
+        return rc;
+
+    entries = g_array_new(FALSE, FALSE, sizeof(struct cache_entry));
+    rc = cache_entries_get(cache, entries, &total);
+    if (!rc) {
+        stats->n_entries = entries->len;
+        stats->size = total;
+        stats->max_size = cache->max_bytes;
+    }
+    cache_entries_free(entries);
+
+    return rc;
+}
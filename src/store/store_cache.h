@@ -0,0 +1,138 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Read cache of Phobos store
+ *
+ * The objects retrieved by GET transfers are kept in a local directory, the
+ * "cache_dir" of the "store" section, so that the next GETs of the same object
+ * version are served from it without any allocation of a medium. An entry is
+ * the file <cache_dir>/<uuid>/<version>, so the cache can be shared by all the
+ * processes of a node.
+ *
+ * The size of the entries is bounded by "cache_max_bytes": the least recently
+ * used entries are evicted first, the modification time of an entry being
+ * refreshed each time it is read. Finding them lists the whole cache for each
+ * object added, the cache is meant to hold a moderate number of entries.
+ *
+ * The entries and the statistics are only readable by the owner of the
+ * processes sharing the cache.
+ */
+#ifndef _STORE_CACHE_H
+#define _STORE_CACHE_H
+
+#include "phobos_store.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * Read cache of a store call.
+ */
+struct read_cache {
+    char *dir;                      /**< Directory of the entries, NULL if the
+                                      *  cache is disabled
+                                      */
+    int64_t max_bytes;              /**< Maximum size of the entries */
+};
+
+/**
+ * Read cache state of a GET transfer.
+ */
+struct cache_info {
+    bool hit;                       /**< The transfer was served by the cache */
+    off_t start;                    /**< Offset of the destination when the
+                                      *  transfer started, -1 if the object
+                                      *  is not to be cached
+                                      */
+};
+
+/**
+ * Initialize the read cache from the configuration.
+ *
+ * @param[out]  cache   Read cache, disabled if "cache_dir" or
+ *                      "cache_max_bytes" are not set
+ */
+void read_cache_init(struct read_cache *cache);
+
+/**
+ * Release the resources of a read cache.
+ */
+void read_cache_fini(struct read_cache *cache);
+
+/**
+ * Serve a GET transfer from the read cache if its object version is cached.
+ *
+ * An entry whose size is not the one of the object is removed and taken as a
+ * miss.
+ *
+ * On a miss, \p info records the offset of the destination, for the object to
+ * be added by read_cache_add() once retrieved. Only the GETs of whole objects
+ * to a seekable destination are added to the cache.
+ *
+ * @param[in]   cache        Read cache
+ * @param[in]   xfer         GET transfer, whose uuid and version are known
+ * @param[in]   object_size  Size of the object in its layout
+ * @param[out]  info         Read cache state of the transfer
+ *
+ * @return 0 if the transfer was served, -ENOENT on a miss, -errno on failure
+ */
+int read_cache_get(struct read_cache *cache, struct pho_xfer_desc *xfer,
+                   size_t object_size, struct cache_info *info);
+
+/**
+ * Add the object retrieved by a successful GET transfer to the read cache,
+ * evicting the least recently used entries to make room for it.
+ *
+ * The object is copied from the destination of the transfer, which is
+ * reopened for reading if needed.
+ *
+ * @param[in]   cache   Read cache
+ * @param[in]   xfer    GET transfer
+ * @param[in]   info    Read cache state of the transfer
+ *
+ * @return 0 on success, -errno on failure
+ */
+int read_cache_add(struct read_cache *cache, struct pho_xfer_desc *xfer,
+                   const struct cache_info *info);
+
+/**
+ * Remove every cached version of an object, after it was deleted or
+ * overwritten.
+ *
+ * @param[in]   cache   Read cache
+ * @param[in]   uuid    UUID of the object
+ */
+void read_cache_invalidate(struct read_cache *cache, const char *uuid);
+
+/**
+ * Get the statistics of the read cache, shared by all the processes using it.
+ *
+ * @param[in]   cache   Read cache
+ * @param[out]  stats   Statistics of the cache
+ *
+ * @return 0 on success, -errno on failure
+ */
+int read_cache_stats_get(struct read_cache *cache,
+                         struct pho_read_cache_stats *stats);
+
+#endif
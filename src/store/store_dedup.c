@@ -0,0 +1,165 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Deduplication helpers of Phobos store
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "store_dedup.h"
+
+#include "pho_common.h"
+#include "pho_dss_wrapper.h"
+
+#include <errno.h>
+#include <openssl/evp.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define DEDUP_READ_BUFFER_SIZE (1024 * 1024)
+
+/**
+ * Compute the SHA-256 digest of the first \p size bytes of \p fd, starting
+ * from its current offset, and rewind it to this offset.
+ */
+static int source_digest(int fd, ssize_t size, char **digest)
+{
+    unsigned char sha[EVP_MAX_MD_SIZE];
+    unsigned int sha_len;
+    ssize_t remaining;
+    EVP_MD_CTX *ctx;
+    char *buffer;
+    off_t start;
+    int rc = 0;
+
+    start = lseek(fd, 0, SEEK_CUR);
+    if (start < 0)
+        return -errno;
+
+    ctx = EVP_MD_CTX_create();
+    if (!ctx)
+        LOG_RETURN(-ENOMEM, "Failed to create SHA-256 context");
+
+    if (EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) == 0)
+        LOG_GOTO(out_ctx, rc = -ENOMEM, "Unable to initialize SHA-256");
+
+    buffer = xmalloc(DEDUP_READ_BUFFER_SIZE);
+    remaining = size;
+    while (remaining > 0) {
+        ssize_t nb_read;
+
+        nb_read = read(fd, buffer, min(remaining, DEDUP_READ_BUFFER_SIZE));
+        if (nb_read < 0)
+            LOG_GOTO(out_buf, rc = -errno, "Unable to read source");
+        if (nb_read == 0)
+            LOG_GOTO(out_buf, rc = -EIO,
+                     "Source is shorter than its announced size %zd", size);
+
+        if (EVP_DigestUpdate(ctx, buffer, nb_read) == 0)
+            LOG_GOTO(out_buf, rc = -ENOMEM, "Unable to update SHA-256");
+
+        remaining -= nb_read;
+    }
+
+    if (EVP_DigestFinal_ex(ctx, sha, &sha_len) == 0)
+        LOG_GOTO(out_buf, rc = -ENOMEM, "Unable to produce SHA-256 digest");
+
+    *digest = uchar2hex(sha, sha_len);
+    if (!*digest)
+        rc = -ENOMEM;
+
+out_buf:
+    free(buffer);
+    if (lseek(fd, start, SEEK_SET) < 0 && !rc)
+        LOG_GOTO(out_ctx, rc = -errno, "Unable to rewind source");
+
+out_ctx:
+    EVP_MD_CTX_destroy(ctx);
+    return rc;
+}
+
+int dedup_lookup(struct dss_handle *dss, struct pho_xfer_desc *xfer,
+                 struct dedup_info *dedup)
+{
+    struct pho_xfer_put_params *put = &xfer->xd_params.put;
+    ssize_t size = put->size;
+    int rc;
+
+    dedup->source_offset = lseek(xfer->xd_fd, 0, SEEK_CUR);
+    rc = source_digest(xfer->xd_fd, size, &dedup->digest);
+    if (rc == -ESPIPE) {
+        pho_verb("Source of objid:'%s' is not seekable, skip deduplication",
+                 xfer->xd_objid);
+        return 0;
+    } else if (rc) {
+        return rc;
+    }
+
+    /* The duplicate must be stored where this PUT asked for */
+    rc = dss_dedup_lookup(dss, dedup->digest, size, put->family,
+                          put->layout_name, put->library, &put->tags,
+                          &dedup->match_uuid, &dedup->match_version);
+    if (rc)
+        LOG_RETURN(rc, "Unable to look for duplicates of objid:'%s'",
+                   xfer->xd_objid);
+
+    if (dedup->match_uuid)
+        pho_verb("objid:'%s' has the same content as object '%s:%d'",
+                 xfer->xd_objid, dedup->match_uuid, dedup->match_version);
+
+    return 0;
+}
+
+int dedup_share(struct dss_handle *dss, struct pho_xfer_desc *xfer,
+                struct dedup_info *dedup)
+{
+    int rc;
+
+    pho_debug("Sharing layout of '%s:%d' with objid:'%s'",
+              dedup->match_uuid, dedup->match_version, xfer->xd_objid);
+    rc = dss_layout_share(dss, dedup->match_uuid, dedup->match_version,
+                          xfer->xd_objid);
+    if (rc != -ENOENT)
+        return rc;
+
+    /* the extents were released since the lookup, write the content */
+    pho_verb("Object '%s:%d' is no longer alive, the content of objid:'%s' "
+             "will be written", dedup->match_uuid, dedup->match_version,
+             xfer->xd_objid);
+    free(dedup->match_uuid);
+    dedup->match_uuid = NULL;
+
+    if (lseek(xfer->xd_fd, dedup->source_offset, SEEK_SET) < 0)
+        LOG_RETURN(-errno, "Unable to rewind source of objid:'%s'",
+                   xfer->xd_objid);
+
+    return 0;
+}
+
+void dedup_info_clean(struct dedup_info *dedup)
+{
+    free(dedup->digest);
+    free(dedup->match_uuid);
+    dedup->digest = NULL;
+    dedup->match_uuid = NULL;
+}
@@ -0,0 +1,91 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Deduplication helpers of Phobos store
+ */
+#ifndef _STORE_DEDUP_H
+#define _STORE_DEDUP_H
+
+#include "phobos_store.h"
+#include "pho_dss.h"
+
+#include <sys/types.h>
+
+/**
+ * Deduplication state of a PUT transfer.
+ */
+struct dedup_info {
+    char *digest;                   /**< Hexadecimal digest of the source,
+                                      *  NULL if it was not computed
+                                      */
+    char *match_uuid;               /**< UUID of an object version storing
+                                      *  the same content, NULL if none
+                                      */
+    int match_version;              /**< Version of the matching object */
+    off_t source_offset;            /**< Offset of the source before its
+                                      *  digest was computed
+                                      */
+};
+
+/**
+ * Compute the digest of the source of a PUT transfer and look for an object
+ * version already storing the same content.
+ *
+ * The source is read in full then rewound to its initial offset, so
+ * deduplication is skipped for sources which are not seekable (pipes,
+ * sockets...).
+ *
+ * @param[in]   dss     DSS handle
+ * @param[in]   xfer    PUT transfer
+ * @param[out]  dedup   Deduplication state of the transfer, left empty if the
+ *                      digest cannot be computed
+ *
+ * @return 0 on success, -errno on failure
+ */
+int dedup_lookup(struct dss_handle *dss, struct pho_xfer_desc *xfer,
+                 struct dedup_info *dedup);
+
+/**
+ * Make the object of a PUT transfer share the layout of the object version
+ * found by dedup_lookup.
+ *
+ * If the extents of this version were released since the lookup, the match is
+ * dropped and the source rewound, so that the transfer writes its content.
+ *
+ * @param[in]       dss     DSS handle
+ * @param[in]       xfer    PUT transfer
+ * @param[in, out]  dedup   Deduplication state of the transfer, whose
+ *                          match_uuid is NULL on return if the layout could
+ *                          not be shared
+ *
+ * @return 0 if the layout was shared or the transfer must write its content,
+ *         -errno on failure
+ */
+int dedup_share(struct dss_handle *dss, struct pho_xfer_desc *xfer,
+                struct dedup_info *dedup);
+
+/**
+ * Release the resources of a deduplication state.
+ */
+void dedup_info_clean(struct dedup_info *dedup);
+
+#endif
@@ -26,6 +26,8 @@
 #include "phobos_store.h"
 #include "pho_cfg.h"
 #include "pho_dss.h"
+#include "store_pool.h"
+
 #include <glib.h>
 
 /**
@@ -140,7 +142,7 @@ int phobos_store_object_list(const char **res, int n_res, bool is_pattern,
     if (rc && rc != -EALREADY)
         return rc;
 
-    rc = dss_init(&dss);
+    rc = store_pool_get_dss(&dss);
     if (rc != 0)
         return rc;
 
@@ -218,7 +220,7 @@ int phobos_store_object_list(const char **res, int n_res, bool is_pattern,
 err:
     g_string_free(metadata_str, TRUE);
     g_string_free(res_str, TRUE);
-    dss_fini(&dss);
+    store_pool_put_dss(&dss);
 
     return rc;
 }
@@ -0,0 +1,227 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Pool of the DSS and LRS connections of Phobos store
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "store_pool.h"
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+/**
+ * List of configuration parameters for the connection pool of the store
+ */
+enum pho_cfg_params_store_pool {
+    PHO_CFG_STORE_FIRST,
+
+    /* store parameters */
+    PHO_CFG_STORE_idle_connections = PHO_CFG_STORE_FIRST,
+
+    PHO_CFG_STORE_LAST
+};
+
+const struct pho_config_item cfg_store_pool[] = {
+    [PHO_CFG_STORE_idle_connections] = {
+        .section = "store",
+        .name    = "idle_connections",
+        .value   = "4"
+    },
+};
+
+/**
+ * Idle connections, only kept between store_pool_init() and
+ * store_pool_fini().
+ */
+static struct {
+    pthread_mutex_t lock;
+    bool active;
+    GQueue dss;                 /**< struct dss_handle */
+    GQueue lrs;                 /**< struct pho_comm_info */
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .active = false,
+    .dss = G_QUEUE_INIT,
+    .lrs = G_QUEUE_INIT,
+};
+
+void store_pool_init(void)
+{
+    pthread_mutex_lock(&pool.lock);
+    pool.active = true;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void store_pool_fini(void)
+{
+    struct pho_comm_info *comm;
+    struct dss_handle *dss;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.active = false;
+
+    while ((dss = g_queue_pop_head(&pool.dss)) != NULL) {
+        dss_fini(dss);
+        free(dss);
+    }
+
+    while ((comm = g_queue_pop_head(&pool.lrs)) != NULL) {
+        pho_comm_close(comm);
+        free(comm);
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static void *pop_idle(GQueue *idle)
+{
+    void *conn;
+
+    pthread_mutex_lock(&pool.lock);
+    conn = g_queue_pop_head(idle);
+    pthread_mutex_unlock(&pool.lock);
+
+    return conn;
+}
+
+/**
+ * Keep a released connection, unless the pool is inactive or full.
+ *
+ * @return true if \p conn was kept, false if it has to be closed
+ */
+static bool push_idle(GQueue *idle, void *conn)
+{
+    int max_idle;
+    bool kept = false;
+
+    max_idle = PHO_CFG_GET_INT(cfg_store_pool, PHO_CFG_STORE, idle_connections,
+                               0);
+
+    pthread_mutex_lock(&pool.lock);
+    if (pool.active && (int) g_queue_get_length(idle) < max_idle) {
+        g_queue_push_head(idle, conn);
+        kept = true;
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return kept;
+}
+
+int store_pool_get_dss(struct dss_handle *dss)
+{
+    struct dss_handle *idle;
+
+    while ((idle = pop_idle(&pool.dss)) != NULL) {
+        *dss = *idle;
+        free(idle);
+
+        if (!dss_check(dss))
+            return 0;
+
+        pho_debug("Closing an idle DSS connection which cannot be reused");
+        dss_fini(dss);
+    }
+
+    return dss_init(dss);
+}
+
+void store_pool_put_dss(struct dss_handle *dss)
+{
+    struct dss_handle *idle;
+
+    if (!dss->dh_conn)
+        return;
+
+    idle = xmalloc(sizeof(*idle));
+    *idle = *dss;
+    if (push_idle(&pool.dss, idle))
+        return;
+
+    free(idle);
+    dss_fini(dss);
+}
+
+/**
+ * An idle connection to the LRS can be reused if it was not closed by the LRS
+ * and no unexpected response is waiting on it.
+ */
+static bool lrs_conn_is_idle(struct pho_comm_info *comm)
+{
+    char byte;
+
+    return recv(comm->socket_fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) < 0 &&
+        (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+int store_pool_get_lrs(struct pho_comm_info *comm, const char *socket_path)
+{
+    union pho_comm_addr addr;
+    struct pho_comm_info *idle;
+
+    while (socket_path && (idle = pop_idle(&pool.lrs)) != NULL) {
+        *comm = *idle;
+        free(idle);
+
+        if (!strcmp(comm->path, socket_path) && lrs_conn_is_idle(comm))
+            return 0;
+
+        pho_debug("Closing an idle LRS connection which cannot be reused");
+        pho_comm_close(comm);
+    }
+
+    addr.af_unix.path = socket_path;
+
+    return pho_comm_open(comm, &addr, PHO_COMM_UNIX_CLIENT);
+}
+
+void store_pool_put_lrs(struct pho_comm_info *comm, bool reusable)
+{
+    struct pho_comm_info *idle;
+    int rc;
+
+    /* offline mode or not connected */
+    if (comm->socket_fd < 0)
+        return;
+
+    if (reusable) {
+        idle = xmalloc(sizeof(*idle));
+        *idle = *comm;
+        if (push_idle(&pool.lrs, idle))
+            return;
+
+        free(idle);
+    }
+
+    rc = pho_comm_close(comm);
+    if (rc)
+        pho_error(rc, "Cannot close the communication socket");
+}
@@ -0,0 +1,83 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Pool of the DSS and LRS connections of Phobos store
+ *
+ * Between phobos_init() and phobos_fini(), the connections opened by a store
+ * call are kept open once it ends, to be reused by the next calls instead of
+ * connecting again. A connection is only used by one call at a time, so that
+ * concurrent calls each get their own connections.
+ */
+#ifndef _STORE_POOL_H
+#define _STORE_POOL_H
+
+#include "pho_comm.h"
+#include "pho_dss.h"
+
+/**
+ * Start keeping the connections released by the store calls.
+ */
+void store_pool_init(void);
+
+/**
+ * Close the idle connections and stop keeping the released ones.
+ */
+void store_pool_fini(void);
+
+/**
+ * Get a connection to the DSS, reusing an idle one if any.
+ *
+ * @param[out]  dss     DSS handle
+ *
+ * @return 0 on success, -errno on failure
+ */
+int store_pool_get_dss(struct dss_handle *dss);
+
+/**
+ * Release a connection to the DSS, kept for later use if it is still usable,
+ * the pool is active and not full.
+ *
+ * @param[in]   dss     DSS handle got from store_pool_get_dss()
+ */
+void store_pool_put_dss(struct dss_handle *dss);
+
+/**
+ * Get a connection to the LRS, reusing an idle one if any.
+ *
+ * @param[out]  comm        Communication socket info
+ * @param[in]   socket_path Path of the socket of the LRS
+ *
+ * @return 0 on success, -errno on failure
+ */
+int store_pool_get_lrs(struct pho_comm_info *comm, const char *socket_path);
+
+/**
+ * Release a connection to the LRS.
+ *
+ * @param[in]   comm        Communication socket info got from
+ *                          store_pool_get_lrs()
+ * @param[in]   reusable    False if responses to previous requests may still
+ *                          be received on the connection, which is then closed
+ */
+void store_pool_put_lrs(struct pho_comm_info *comm, bool reusable);
+
+#endif
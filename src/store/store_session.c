@@ -0,0 +1,704 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Write sessions of Phobos store
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "store_session.h"
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_srl_common.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * List of configuration parameters for the write sessions of the store
+ */
+enum pho_cfg_params_store_session {
+    PHO_CFG_STORE_FIRST,
+
+    /* store parameters */
+    PHO_CFG_STORE_write_session_max_bytes = PHO_CFG_STORE_FIRST,
+    PHO_CFG_STORE_write_session_max_ms,
+
+    PHO_CFG_STORE_LAST
+};
+
+const struct pho_config_item cfg_store_session[] = {
+    [PHO_CFG_STORE_write_session_max_bytes] = {
+        .section = "store",
+        .name    = "write_session_max_bytes",
+        .value   = "0"
+    },
+    [PHO_CFG_STORE_write_session_max_ms] = {
+        .section = "store",
+        .name    = "write_session_max_ms",
+        .value   = "10000"
+    },
+};
+
+enum write_session_state {
+    WS_PENDING,         /**< Allocation requested to the LRS */
+    WS_OPENED,          /**< Allocation received, transfers can be added */
+    WS_FAILED,          /**< Allocation failed, the waiting requests have to
+                          *  be sent again
+                          */
+    WS_CLOSING,         /**< Release requested to the LRS */
+};
+
+struct ws_member {
+    int id;                     /**< Id of the requests of the transfer */
+    bool writing;               /**< The transfer did not release the media */
+    bool ended;                 /**< The transfer ended before the session */
+};
+
+struct write_session {
+    enum write_session_state state;
+    pho_req_t *req;             /**< Allocation request of the session, its id
+                                  *  is the one of the requests of the session
+                                  */
+    pho_resp_t *alloc;          /**< Allocation received from the LRS */
+    size_t *reserved;           /**< Bytes given to the transfers on each
+                                  *  medium of the allocation
+                                  */
+    pho_req_t release;          /**< Release of the media, aggregating the
+                                  *  releases of the transfers
+                                  */
+    struct timespec deadline;   /**< End of the addition of transfers */
+    bool owner_ended;           /**< The transfer which requested the
+                                  *  allocation ended before receiving it
+                                  */
+    GArray *members;            /**< struct ws_member */
+    GQueue waiting;             /**< pho_req_t, allocation requests waiting
+                                  *  for the allocation of the session
+                                  */
+};
+
+void write_sessions_init(struct write_sessions *ws, struct pho_comm_info *comm)
+{
+    memset(ws, 0, sizeof(*ws));
+    ws->comm = comm;
+    g_queue_init(&ws->responses);
+
+    ws->max_bytes = str2int64(PHO_CFG_GET(cfg_store_session, PHO_CFG_STORE,
+                                          write_session_max_bytes));
+    if (ws->max_bytes < 0) {
+        pho_warn("Invalid value for write_session_max_bytes in section "
+                 "store, write sessions are disabled");
+        ws->max_bytes = 0;
+    }
+
+    ws->max_ms = PHO_CFG_GET_INT(cfg_store_session, PHO_CFG_STORE,
+                                 write_session_max_ms, 0);
+    if (ws->max_ms <= 0)
+        ws->max_bytes = 0;
+}
+
+static int request_pack_send(struct pho_comm_info *comm, pho_req_t *req)
+{
+    struct pho_comm_data data;
+    int rc;
+
+    data = pho_comm_data_init(comm);
+    pho_srl_request_pack(req, &data.buf);
+
+    rc = pho_comm_send(&data);
+    free(data.buf.buff);
+
+    return rc;
+}
+
+static int request_send(struct pho_comm_info *comm, pho_req_t *req)
+{
+    int rc;
+
+    rc = request_pack_send(comm, req);
+    pho_srl_request_free(req, false);
+
+    return rc;
+}
+
+/** Take the content of \p req, which does not have to be freed anymore */
+static pho_req_t *request_keep(pho_req_t *req)
+{
+    pho_req_t *kept = xmalloc(sizeof(*kept));
+
+    *kept = *req;
+
+    return kept;
+}
+
+static void request_drop(pho_req_t *req)
+{
+    pho_srl_request_free(req, false);
+    free(req);
+}
+
+void write_sessions_response_free(pho_resp_t *resp)
+{
+    pho_srl_response_free(resp, false);
+    free(resp);
+}
+
+static void session_free(struct write_session *session)
+{
+    pho_req_t *req;
+
+    while ((req = g_queue_pop_head(&session->waiting)) != NULL)
+        request_drop(req);
+
+    if (session->alloc)
+        write_sessions_response_free(session->alloc);
+
+    if (session->release.release)
+        pho_srl_request_free(&session->release, false);
+
+    request_drop(session->req);
+    g_array_free(session->members, TRUE);
+    free(session->reserved);
+    free(session);
+}
+
+static void session_remove(struct write_sessions *ws,
+                           struct write_session *session)
+{
+    ws->sessions = g_list_remove(ws->sessions, session);
+    session_free(session);
+}
+
+void write_sessions_fini(struct write_sessions *ws)
+{
+    pho_resp_t *resp;
+
+    g_list_free_full(ws->sessions, (GDestroyNotify) session_free);
+    ws->sessions = NULL;
+
+    while ((resp = g_queue_pop_head(&ws->responses)) != NULL)
+        write_sessions_response_free(resp);
+}
+
+bool write_sessions_idle(struct write_sessions *ws)
+{
+    return ws->sessions == NULL && g_queue_is_empty(&ws->responses);
+}
+
+pho_resp_t *write_sessions_pop_response(struct write_sessions *ws)
+{
+    return g_queue_pop_head(&ws->responses);
+}
+
+/** Only plain write allocations can be shared by several transfers */
+static bool session_eligible(const pho_req_t *req)
+{
+    int i;
+
+    if (!pho_request_is_write(req) || req->walloc->prevent_duplicate ||
+        req->walloc->n_media == 0)
+        return false;
+
+    for (i = 0; i < req->walloc->n_media; i++)
+        if (req->walloc->media[i]->empty_medium)
+            return false;
+
+    return true;
+}
+
+static bool session_compatible(const struct write_session *session,
+                               const pho_req_t *req)
+{
+    const pho_req_write_t *model = session->req->walloc;
+    const pho_req_write_t *walloc = req->walloc;
+    int i;
+    int j;
+
+    if (model->family != walloc->family ||
+        model->n_media != walloc->n_media ||
+        g_strcmp0(model->library, walloc->library) ||
+        g_strcmp0(model->grouping, walloc->grouping))
+        return false;
+
+    for (i = 0; i < walloc->n_media; i++) {
+        if (model->media[i]->n_tags != walloc->media[i]->n_tags)
+            return false;
+
+        for (j = 0; j < walloc->media[i]->n_tags; j++)
+            if (strcmp(model->media[i]->tags[j], walloc->media[i]->tags[j]))
+                return false;
+    }
+
+    return true;
+}
+
+static void session_member_add(struct write_session *session, int id)
+{
+    struct ws_member member = {
+        .id = id,
+        .writing = true,
+        .ended = false,
+    };
+
+    g_array_append_val(session->members, member);
+}
+
+static struct ws_member *session_writing_member(struct write_session *session,
+                                                int id)
+{
+    int i;
+
+    for (i = 0; i < session->members->len; i++) {
+        struct ws_member *member = &g_array_index(session->members,
+                                                  struct ws_member, i);
+
+        if (member->id == id && member->writing)
+            return member;
+    }
+
+    return NULL;
+}
+
+/**
+ * Give to the transfer of \p req a part of the allocation of \p session, if
+ * the session is not over and the request fits in what remains of it.
+ */
+static bool session_serve(struct write_sessions *ws,
+                          struct write_session *session, pho_req_t *req)
+{
+    pho_resp_write_t *walloc = session->alloc->walloc;
+    struct timespec now;
+    pho_resp_t *resp;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (cmp_timespec(&now, &session->deadline) >= 0)
+        return false;
+
+    for (i = 0; i < walloc->n_media; i++) {
+        size_t limit = min(walloc->media[i]->avail_size,
+                           (size_t) ws->max_bytes);
+
+        if (session->reserved[i] + req->walloc->media[i]->size > limit)
+            return false;
+    }
+
+    resp = xmalloc(sizeof(*resp));
+    pho_srl_response_write_alloc(resp, walloc->n_media);
+    resp->req_id = req->id;
+
+    for (i = 0; i < walloc->n_media; i++) {
+        pho_resp_write_elt_t *elt = resp->walloc->media[i];
+
+        rsc_id_cpy(elt->med_id, walloc->media[i]->med_id);
+        elt->avail_size = walloc->media[i]->avail_size - session->reserved[i];
+        elt->root_path = xstrdup(walloc->media[i]->root_path);
+        elt->fs_type = walloc->media[i]->fs_type;
+        elt->addr_type = walloc->media[i]->addr_type;
+
+        session->reserved[i] += req->walloc->media[i]->size;
+    }
+
+    pho_debug("Write session of request %d serves request %d on '%s'",
+              session->req->id, req->id, walloc->media[0]->med_id->name);
+
+    session_member_add(session, req->id);
+    g_queue_push_tail(&ws->responses, resp);
+
+    return true;
+}
+
+/** Keep the allocation of \p session, whose transfers can now be added */
+static void session_opened(struct write_sessions *ws,
+                           struct write_session *session, pho_resp_t *resp)
+{
+    pho_resp_write_t *walloc = resp->walloc;
+    struct timespec duration = {
+        .tv_sec = ws->max_ms / 1000,
+        .tv_nsec = (ws->max_ms % 1000) * 1000000,
+    };
+    struct timespec now;
+    int i;
+
+    session->alloc = xmalloc(sizeof(*session->alloc));
+    pho_srl_response_write_alloc(session->alloc, walloc->n_media);
+    session->reserved = xcalloc(walloc->n_media, sizeof(*session->reserved));
+    pho_srl_request_release_alloc(&session->release, walloc->n_media);
+    session->release.id = session->req->id;
+
+    for (i = 0; i < walloc->n_media; i++) {
+        pho_resp_write_elt_t *elt = session->alloc->walloc->media[i];
+        pho_req_release_elt_t *rel = session->release.release->media[i];
+
+        rsc_id_cpy(elt->med_id, walloc->media[i]->med_id);
+        elt->avail_size = walloc->media[i]->avail_size;
+        elt->root_path = xstrdup(walloc->media[i]->root_path);
+        elt->fs_type = walloc->media[i]->fs_type;
+        elt->addr_type = walloc->media[i]->addr_type;
+
+        rsc_id_cpy(rel->med_id, walloc->media[i]->med_id);
+        rel->rc = 0;
+        rel->size_written = 0;
+        rel->nb_extents_written = 0;
+        rel->to_sync = true;
+
+        session->reserved[i] = min(session->req->walloc->media[i]->size,
+                                   walloc->media[i]->avail_size);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    session->deadline = add_timespec(&now, &duration);
+    session->state = WS_OPENED;
+    session_member_add(session, session->req->id);
+    if (session->owner_ended) {
+        struct ws_member *owner = session_writing_member(session,
+                                                         session->req->id);
+
+        owner->writing = false;
+        owner->ended = true;
+    }
+}
+
+/** Respond to the transfers of \p session as the LRS did to the session */
+static void session_respond(struct write_sessions *ws,
+                            struct write_session *session,
+                            const pho_resp_t *model)
+{
+    pho_resp_write_t *walloc = session->alloc->walloc;
+    int i;
+    int j;
+
+    for (i = 0; i < session->members->len; i++) {
+        struct ws_member *member = &g_array_index(session->members,
+                                                  struct ws_member, i);
+        pho_resp_t *resp = xmalloc(sizeof(*resp));
+
+        if (member->ended) {
+            free(resp);
+            continue;
+        }
+
+        if (pho_response_is_error(model)) {
+            pho_srl_response_error_alloc(resp);
+            resp->error->rc = model->error->rc;
+            resp->error->req_kind = model->error->req_kind;
+        } else {
+            pho_srl_response_release_alloc(resp, walloc->n_media);
+            for (j = 0; j < walloc->n_media; j++)
+                rsc_id_cpy(resp->release->med_ids[j],
+                           walloc->media[j]->med_id);
+        }
+
+        resp->req_id = member->id;
+        g_queue_push_tail(&ws->responses, resp);
+    }
+}
+
+/**
+ * Release the media of \p session if none of its transfers is writing or
+ * waiting for its allocation.
+ */
+static int session_close_if_over(struct write_sessions *ws,
+                                 struct write_session *session)
+{
+    pho_req_release_elt_t *rel;
+    int rc;
+    int i;
+
+    if (session->state != WS_OPENED || !g_queue_is_empty(&session->waiting))
+        return 0;
+
+    for (i = 0; i < session->members->len; i++)
+        if (g_array_index(session->members, struct ws_member, i).writing)
+            return 0;
+
+    rel = session->release.release->media[0];
+    pho_debug("Closing write session of request %d on '%s': %zu bytes, "
+              "%zu extents", session->req->id, rel->med_id->name,
+              (size_t) rel->size_written, (size_t) rel->nb_extents_written);
+
+    rc = request_pack_send(ws->comm, &session->release);
+    if (rc) {
+        pho_resp_t error = {
+            .error = &(pho_resp_error_t) {
+                .rc = rc,
+                .req_kind = PHO_REQUEST_KIND__RQ_RELEASE,
+            },
+        };
+
+        pho_error(rc, "Error while sending release of write session to LRS");
+        session_respond(ws, session, &error);
+        session_remove(ws, session);
+        return rc;
+    }
+
+    session->state = WS_CLOSING;
+
+    return 0;
+}
+
+/** Add the outcome of the release of a transfer to the one of the session */
+static bool session_add_release(struct write_session *session, pho_req_t *req)
+{
+    pho_req_release_t *total = session->release.release;
+    struct ws_member *member;
+    int i;
+
+    member = session_writing_member(session, req->id);
+    if (!member || req->release->n_media != total->n_media)
+        return false;
+
+    for (i = 0; i < total->n_media; i++)
+        if (strcmp(req->release->media[i]->med_id->name,
+                   total->media[i]->med_id->name))
+            return false;
+
+    for (i = 0; i < total->n_media; i++) {
+        pho_req_release_elt_t *elt = req->release->media[i];
+
+        total->media[i]->size_written += elt->size_written;
+        total->media[i]->nb_extents_written += elt->nb_extents_written;
+        if (total->media[i]->rc == 0)
+            total->media[i]->rc = elt->rc;
+    }
+
+    member->writing = false;
+
+    return true;
+}
+
+/** Open a session with the allocation requested by \p req */
+static int session_open(struct write_sessions *ws, pho_req_t *req)
+{
+    struct write_session *session;
+    int rc;
+
+    req->walloc->has_session_size = true;
+    req->walloc->session_size = ws->max_bytes;
+
+    rc = request_pack_send(ws->comm, req);
+    if (rc) {
+        pho_srl_request_free(req, false);
+        return rc;
+    }
+
+    session = xcalloc(1, sizeof(*session));
+    session->state = WS_PENDING;
+    session->req = request_keep(req);
+    session->members = g_array_new(FALSE, FALSE, sizeof(struct ws_member));
+    g_queue_init(&session->waiting);
+
+    ws->sessions = g_list_append(ws->sessions, session);
+
+    return 0;
+}
+
+int write_sessions_send(struct write_sessions *ws, pho_req_t *req)
+{
+    GList *item;
+
+    if (ws->max_bytes == 0)
+        return request_send(ws->comm, req);
+
+    if (pho_request_is_release(req)) {
+        for (item = ws->sessions; item; item = item->next) {
+            struct write_session *session = item->data;
+
+            if (session->state != WS_OPENED ||
+                !session_add_release(session, req))
+                continue;
+
+            pho_srl_request_free(req, false);
+            return session_close_if_over(ws, session);
+        }
+
+        return request_send(ws->comm, req);
+    }
+
+    if (!session_eligible(req))
+        return request_send(ws->comm, req);
+
+    for (item = ws->sessions; item; item = item->next) {
+        struct write_session *session = item->data;
+
+        if (!session_compatible(session, req))
+            continue;
+
+        if (session->state == WS_PENDING) {
+            g_queue_push_tail(&session->waiting, request_keep(req));
+            return 0;
+        }
+
+        if (session->state == WS_OPENED && session_serve(ws, session, req)) {
+            pho_srl_request_free(req, false);
+            return 0;
+        }
+    }
+
+    return session_open(ws, req);
+}
+
+static bool same_media(const pho_resp_write_t *walloc,
+                       const pho_resp_release_t *release)
+{
+    int i;
+
+    if (walloc->n_media != release->n_med_ids)
+        return false;
+
+    for (i = 0; i < release->n_med_ids; i++)
+        if (strcmp(walloc->media[i]->med_id->name, release->med_ids[i]->name))
+            return false;
+
+    return true;
+}
+
+bool write_sessions_recv(struct write_sessions *ws, pho_resp_t *resp)
+{
+    GList *item;
+
+    if (ws->max_bytes == 0)
+        return false;
+
+    for (item = ws->sessions; item; item = item->next) {
+        struct write_session *session = item->data;
+
+        if (session->req->id != resp->req_id)
+            continue;
+
+        if (session->state == WS_PENDING) {
+            if (pho_response_is_write(resp) &&
+                resp->walloc->n_media == session->req->walloc->n_media) {
+                session_opened(ws, session, resp);
+                return false;
+            }
+
+            if (pho_response_is_write(resp) || (pho_response_is_error(resp) &&
+                    resp->error->req_kind == PHO_REQUEST_KIND__RQ_WRITE)) {
+                session->state = WS_FAILED;
+                return false;
+            }
+        }
+
+        if (session->state == WS_CLOSING &&
+            ((pho_response_is_release(resp) &&
+              same_media(session->alloc->walloc, resp->release)) ||
+             (pho_response_is_error(resp) &&
+              resp->error->req_kind == PHO_REQUEST_KIND__RQ_RELEASE))) {
+            session_respond(ws, session, resp);
+            session_remove(ws, session);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int write_sessions_flush(struct write_sessions *ws)
+{
+    GList *sessions = g_list_copy(ws->sessions);
+    GList *item;
+    int rc = 0;
+
+    for (item = sessions; item; item = item->next) {
+        struct write_session *session = item->data;
+        GQueue waiting = G_QUEUE_INIT;
+        pho_req_t *req;
+        bool opened;
+
+        if (session->state != WS_OPENED && session->state != WS_FAILED)
+            continue;
+
+        /* The waiting requests join the session, or another one */
+        while ((req = g_queue_pop_head(&session->waiting)) != NULL)
+            g_queue_push_tail(&waiting, req);
+
+        opened = session->state == WS_OPENED;
+        if (!opened)
+            session_remove(ws, session);
+
+        while ((req = g_queue_pop_head(&waiting)) != NULL) {
+            int rc2 = write_sessions_send(ws, req);
+
+            free(req);
+            rc = rc ? : rc2;
+        }
+
+        if (opened) {
+            int rc2 = session_close_if_over(ws, session);
+
+            rc = rc ? : rc2;
+        }
+    }
+
+    g_list_free(sessions);
+
+    return rc;
+}
+
+int write_sessions_xfer_end(struct write_sessions *ws, int id)
+{
+    GList *item = ws->sessions;
+    int rc = 0;
+
+    while (item) {
+        struct write_session *session = item->data;
+        GList *waiting = session->waiting.head;
+        int rc2;
+        int i;
+
+        item = item->next;
+
+        if (session->state == WS_PENDING && session->req->id == id)
+            session->owner_ended = true;
+
+        while (waiting) {
+            GList *next = waiting->next;
+
+            if (((pho_req_t *) waiting->data)->id == id) {
+                request_drop(waiting->data);
+                g_queue_delete_link(&session->waiting, waiting);
+            }
+            waiting = next;
+        }
+
+        for (i = 0; i < session->members->len; i++) {
+            struct ws_member *member = &g_array_index(session->members,
+                                                      struct ws_member, i);
+
+            if (member->id != id)
+                continue;
+
+            member->writing = false;
+            member->ended = true;
+        }
+
+        rc2 = session_close_if_over(ws, session);
+        rc = rc ? : rc2;
+    }
+
+    return rc;
+}
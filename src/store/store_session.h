@@ -0,0 +1,139 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Write sessions of Phobos store
+ *
+ * A write session keeps the media allocated by the LRS for a PUT transfer to
+ * write the following transfers of the same store call which request the same
+ * kind of media. Their extents are appended on the media of the session, which
+ * are released with a single request once the session is over, instead of one
+ * allocation and one release per transfer. The transfers of a session end when
+ * this release, and therefore the sync of the media, is acknowledged.
+ *
+ * A session ends when none of its transfers are writing anymore, and does not
+ * accept new transfers once it reached the number of bytes or the duration
+ * configured in the "store" section.
+ */
+#ifndef _STORE_SESSION_H
+#define _STORE_SESSION_H
+
+#include "pho_comm.h"
+#include "pho_srl_lrs.h"
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Write sessions of a store call.
+ */
+struct write_sessions {
+    struct pho_comm_info *comm;     /**< Connection to the LRS */
+    int64_t max_bytes;              /**< Bytes written on a medium by a
+                                      *  session, 0 if sessions are disabled
+                                      */
+    int max_ms;                     /**< Time after which a session does not
+                                      *  accept new transfers
+                                      */
+    GList *sessions;                /**< struct write_session */
+    GQueue responses;               /**< pho_resp_t built by the sessions for
+                                      *  their transfers
+                                      */
+};
+
+/**
+ * Initialize the write sessions of a store call, from the configuration.
+ *
+ * @param[out]  ws      Write sessions to initialize
+ * @param[in]   comm    Connection to the LRS of the store call
+ */
+void write_sessions_init(struct write_sessions *ws, struct pho_comm_info *comm);
+
+/**
+ * Free the write sessions and the responses which were not delivered.
+ * Sessions still opened are not released, the connection to the LRS should be
+ * closed if write_sessions_idle() is false.
+ */
+void write_sessions_fini(struct write_sessions *ws);
+
+/**
+ * Whether no session is waiting for the LRS or for its transfers.
+ */
+bool write_sessions_idle(struct write_sessions *ws);
+
+/**
+ * Send a request to the LRS, unless it can be served by a write session.
+ *
+ * A write allocation request may be kept until the allocation of a compatible
+ * session is received, or answered by a response built from an opened
+ * session. The release request of a transfer of a session is kept until the
+ * end of the session. The request is freed, or kept, in any case.
+ *
+ * @param[in]   ws      Write sessions
+ * @param[in]   req     Request to send, whose id identifies its transfer
+ *
+ * @return 0 on success, -errno if the request could not be sent
+ */
+int write_sessions_send(struct write_sessions *ws, pho_req_t *req);
+
+/**
+ * Give a response of the LRS to the write sessions.
+ *
+ * @param[in]   ws      Write sessions
+ * @param[in]   resp    Response received from the LRS
+ *
+ * @return true if the response is the one of a session, which already built
+ *         the responses to its transfers, false if it has to be delivered to
+ *         the transfer it is addressed to.
+ */
+bool write_sessions_recv(struct write_sessions *ws, pho_resp_t *resp);
+
+/**
+ * Serve the requests waiting for an allocation which was received, and release
+ * the sessions which are over.
+ *
+ * @return 0 on success, -errno if a request could not be sent
+ */
+int write_sessions_flush(struct write_sessions *ws);
+
+/**
+ * Stop waiting for the release of an ended transfer, and release the media of
+ * the sessions which are over without it.
+ *
+ * @param[in]   ws      Write sessions
+ * @param[in]   id      Id of the requests of the transfer
+ *
+ * @return 0 on success, -errno if the release of a session could not be sent
+ */
+int write_sessions_xfer_end(struct write_sessions *ws, int id);
+
+/**
+ * Get the next response built by the write sessions for their transfers.
+ *
+ * @return the response, to be freed with write_sessions_response_free(), or
+ *         NULL if there is none.
+ */
+pho_resp_t *write_sessions_pop_response(struct write_sessions *ws);
+
+void write_sessions_response_free(pho_resp_t *resp);
+
+#endif
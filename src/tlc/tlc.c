@@ -348,6 +348,45 @@ static int process_unload_request(struct tlc *tlc, pho_tlc_req_t *req,
     return rc;
 }
 
+static int process_stage_request(struct tlc *tlc, pho_tlc_req_t *req,
+                                 int client_socket)
+{
+    struct lib_item_addr stage_addr;
+    json_t *json_message = NULL;
+    pho_tlc_resp_t *resp = NULL;
+    pho_tlc_resp_t stage_resp;
+    pho_tlc_resp_t error_resp;
+    int rc, rc2;
+
+    rc = tlc_library_stage(&tlc->lib, req->stage->drive_serial,
+                           req->stage->tape_label, &stage_addr, &json_message);
+    if (rc) {
+        tlc_build_response_error(&error_resp, req->id, rc, json_message);
+        if (json_message)
+            json_decref(json_message);
+
+        resp = &error_resp;
+    } else {
+        /* Build stage response */
+        pho_srl_tlc_response_stage_alloc(&stage_resp);
+        stage_resp.stage->addr = stage_addr.lia_addr;
+        stage_resp.req_id = req->id;
+        if (json_message) {
+            stage_resp.stage->message = json_dumps(json_message, 0);
+            json_decref(json_message);
+        }
+
+        resp = &stage_resp;
+    }
+
+    rc2 = tlc_response_send(resp, client_socket);
+    if (rc2)
+        rc = rc ? : rc2;
+
+    pho_srl_tlc_response_free(resp, false);
+    return rc;
+}
+
 static int process_status_request(struct tlc *tlc, pho_tlc_req_t *req,
                                   int client_socket)
 {
@@ -537,6 +576,11 @@ static int recv_work(struct tlc *tlc)
             goto out_request;
         }
 
+        if (pho_tlc_request_is_stage(req)) {
+            process_stage_request(tlc, req, data[i].fd);
+            goto out_request;
+        }
+
         if (pho_tlc_request_is_status(req)) {
             process_status_request(tlc, req, data[i].fd);
             goto out_request;
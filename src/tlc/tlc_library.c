@@ -661,20 +661,37 @@ int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
     return 0;
 }
 
-/** Search for a free slot in the library */
-static struct element_status *get_free_slot(struct lib_descriptor *lib)
+/** Distance between two element addresses */
+static unsigned int addr_distance(uint16_t addr1, uint16_t addr2)
 {
+    return addr1 > addr2 ? addr1 - addr2 : addr2 - addr1;
+}
+
+/**
+ * Search for the free slot of the library which is the nearest to a drive.
+ *
+ * Libraries number their slots along the path of their arm, so the slot whose
+ * address is the closest to the one of the drive is the quickest to reach.
+ */
+static struct element_status *get_free_slot_near(struct lib_descriptor *lib,
+                                                 uint16_t drive_addr)
+{
+    struct element_status *nearest = NULL;
     struct element_status *slot;
     int i;
 
     for (i = 0; i < lib->slots.count; i++) {
         slot = &lib->slots.items[i];
 
-        if (!slot->full)
-            return slot;
+        if (slot->full)
+            continue;
+
+        if (!nearest || addr_distance(slot->address, drive_addr) <
+                        addr_distance(nearest->address, drive_addr))
+            nearest = slot;
     }
 
-    return NULL;
+    return nearest;
 }
 
 /**
@@ -733,7 +750,8 @@ get_target_free_slot_from_source_or_any(struct lib_descriptor *lib,
     }
 
     if (unload_addr->lia_type != MED_LOC_SLOT) {
-        *target = get_free_slot(lib);
+        /* keep the tape near the drive, where it is the quickest to reload */
+        *target = get_free_slot_near(lib, drive->address);
         if (!*target) {
             *json_message = json_pack("{s:s}",
                                       "NO_FREE_SLOT",
@@ -831,6 +849,84 @@ int tlc_library_unload(struct dss_handle *dss, struct lib_descriptor *lib,
     return 0;
 }
 
+int tlc_library_stage(struct lib_descriptor *lib, const char *drive_serial,
+                      const char *tape_label, struct lib_item_addr *stage_addr,
+                      json_t **json_message)
+{
+    struct element_status *source_element_status;
+    struct element_status *target_element_status;
+    struct element_status *drive_element_status;
+    int rc;
+
+    stage_addr->lia_type = MED_LOC_UNKNOWN;
+    stage_addr->lia_addr = 0;
+    *json_message = NULL;
+
+    /* get device addr */
+    drive_element_status = drive_element_status_from_serial(lib, drive_serial);
+    if (!drive_element_status) {
+        *json_message = json_pack("{s:s}",
+                                  "DRIVE_SERIAL_UNKNOWN", drive_serial);
+        return -ENOENT;
+    }
+
+    /* get medium addr */
+    source_element_status = media_element_status_from_label(lib, tape_label);
+    if (!source_element_status) {
+        *json_message = json_pack("{s:s}",
+                                  "MEDIA_LABEL_UNKNOWN", tape_label);
+        return -ENOENT;
+    }
+
+    /* only a tape stored in a slot is staged */
+    if (source_element_status->type != SCSI_TYPE_SLOT) {
+        *json_message = json_pack("{s:s, s:s}",
+                                  "MEDIA_NOT_IN_SLOT", tape_label,
+                                  "ELEMENT_TYPE",
+                                  type2str(source_element_status->type));
+        return -EBUSY;
+    }
+
+    stage_addr->lia_type = MED_LOC_SLOT;
+    stage_addr->lia_addr = source_element_status->address;
+
+    target_element_status = get_free_slot_near(lib,
+                                               drive_element_status->address);
+    if (!target_element_status ||
+        addr_distance(source_element_status->address,
+                      drive_element_status->address) <=
+        addr_distance(target_element_status->address,
+                      drive_element_status->address)) {
+        pho_debug("Tape '%s' is already staged for drive '%s' in slot %#hx",
+                  tape_label, drive_serial, source_element_status->address);
+        return 0;
+    }
+
+    /* move medium to the slot near the device */
+    /* arm = 0 for default transport element */
+    *json_message = json_object();
+    rc = scsi_move_medium(lib->fd, 0, source_element_status->address,
+                          target_element_status->address, *json_message);
+    if (rc)
+        LOG_RETURN(rc,
+                   "SCSI move failed for stage of tape '%s' for drive '%s' to "
+                   "address %#hx", tape_label, drive_serial,
+                   target_element_status->address);
+
+    json_decref(*json_message);
+    *json_message = NULL;
+
+    pho_verb("Staged tape '%s' for drive '%s' from slot %#hx to slot %#hx",
+             tape_label, drive_serial, source_element_status->address,
+             target_element_status->address);
+
+    /* update element status lib cache */
+    move_tape_between_element_status(source_element_status,
+                                     target_element_status);
+    stage_addr->lia_addr = target_element_status->address;
+    return 0;
+}
+
 /**
  * Type for a scan callback function.
  *
@@ -121,7 +121,7 @@ int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
  * Unload a tape from a drive to a free slot
  *
  * If the source address is set and conforms to a free slot, we use it at
- * unload_addr otherwise we use any existing free slot.
+ * unload_addr otherwise we use the free slot nearest to the drive.
  *
  * @param[in]  lib              Library descriptor.
  * @param[in]  drive_serial     Serial number of the target drive.
@@ -145,6 +145,31 @@ int tlc_library_unload(struct dss_handle *dss, struct lib_descriptor *lib,
                        struct lib_item_addr *unload_addr,
                        json_t **json_message);
 
+/**
+ * Move a tape to the free slot nearest to a drive, ahead of its load into this
+ * drive.
+ *
+ * The tape is not moved if it is already nearer to the drive than any free
+ * slot.
+ *
+ * @param[in]  lib              Library descriptor.
+ * @param[in]  drive_serial     Serial number of the drive the tape is staged
+ *                              for.
+ * @param[in]  tape_label       Label of the tape to stage.
+ * @param[out] stage_addr       Returns on success the address of the slot
+ *                              where the tape is staged.
+ * @param[out] json_message     Set to NULL, if no message. On error or success,
+ *                              could be set to a value different from NULL,
+ *                              containing a message which describes the actions
+ *                              and must be decref by the caller.
+ *
+ * @return 0 on success, -EBUSY if the tape is not in a storage slot, negative
+ *         error code on failure.
+ */
+int tlc_library_stage(struct lib_descriptor *lib, const char *drive_serial,
+                      const char *tape_label, struct lib_item_addr *stage_addr,
+                      json_t **json_message);
+
 /**
  * Build a json describing the library's current status
  *
@@ -452,6 +452,37 @@ function test_put_get_split_with_missing_extents()
     rm "$file"
 }
 
+function test_get_range_split()
+{
+    local file=$(make_file 2740KB)
+    local oid=$FUNCNAME
+    local out=/tmp/out.$$
+    local range
+
+    $valg_phobos put "$file" $oid
+    check_extent_count "$oid" 6
+
+    # ranges inside the first split, across both splits and up to the end
+    for range in 0:1 12345:100000 1000000:1000000 2000000; do
+        local offset=${range%%:*}
+        local size=${range#*:}
+
+        [[ "$range" == "$offset" ]] && size=$(stat -c %s "$file")
+
+        for d in "" $($phobos dir list); do
+            [[ -n "$d" ]] && $phobos dir lock $d
+
+            $valg_phobos get --range $range $oid "$out"
+            cmp "$out" <(tail -c +$((offset + 1)) "$file" | head -c $size)
+            rm "$out"
+
+            [[ -n "$d" ]] && $phobos dir unlock $d
+        done
+    done
+
+    rm "$file"
+}
+
 function test_put_get_without_xxh128()
 {
     local oid=$FUNCNAME
@@ -702,6 +733,9 @@ TESTS=(
     "setup_dir_split even; \
      test_put_get_split_with_missing_extents; \
      cleanup_dir_split"
+    "setup_dir_split even; \
+     test_get_range_split; \
+     cleanup_dir_split"
 
     "setup_dir odd; \
      test_put_get; \
@@ -721,6 +755,9 @@ TESTS=(
     "setup_dir_split odd; \
      test_put_get_split_with_missing_extents; \
      cleanup_dir_split"
+    "setup_dir_split odd; \
+     test_get_range_split; \
+     cleanup_dir_split"
 )
 
 if [[ "$RAID_LAYOUT" == "raid4" ]]; then
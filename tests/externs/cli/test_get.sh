@@ -197,6 +197,35 @@ function test_creation_and_access_times
         || error "Access time should not be updated on undelete operation"
 }
 
+function test_get_range
+{
+    local size=$(stat -c %s /etc/services)
+
+    $phobos put --family dir /etc/services oid-range
+
+    $valg_phobos get --range 10:100 oid-range /tmp/out ||
+        error "Ranged get operation failed"
+    cmp /tmp/out <(tail -c +11 /etc/services | head -c 100) ||
+        error "Ranged get did not retrieve the expected bytes"
+    rm /tmp/out
+
+    $valg_phobos get --range 1000 oid-range /tmp/out ||
+        error "Ranged get operation failed"
+    cmp /tmp/out <(tail -c +1001 /etc/services) ||
+        error "Ranged get up to the end of the object failed"
+    rm /tmp/out
+
+    $valg_phobos get --range $((size - 10)):100 oid-range /tmp/out ||
+        error "Ranged get operation failed"
+    cmp /tmp/out <(tail -c 10 /etc/services) ||
+        error "Ranged get should be truncated at the end of the object"
+    rm /tmp/out
+
+    $valg_phobos get --range $((size + 1)):1 oid-range /tmp/out &&
+        error "Ranged get beyond the end of the object should fail" || true
+    rm -f /tmp/out
+}
+
 function test_errors
 {
     $valg_phobos get oid2 /tmp/out \
@@ -224,5 +253,6 @@ trap cleanup EXIT
 setup
 
 test_get
+test_get_range
 test_creation_and_access_times
 test_errors
@@ -248,6 +248,146 @@ function test_lyt_params
 
 test_lyt_params
 
+################################################################################
+#                            PUT WITH PACK LAYOUT                              #
+################################################################################
+
+function test_pack
+{
+    local nb_extents=$($PSQL -t -c "SELECT COUNT(*) FROM extent;")
+    local files=""
+    local i
+
+    for i in 1 2 3; do
+        files="$files $(mktemp /tmp/test.pho.XXXX)"
+    done
+
+    i=1
+    for f in $files; do
+        head -c $((i * 1000)) /dev/urandom > $f
+        echo "$f pack$i -" >> /tmp/pack_mput_list
+        i=$((i + 1))
+    done
+
+    $valg_phobos mput --family dir --layout pack /tmp/pack_mput_list ||
+        error "Objects should be put with the pack layout"
+    rm /tmp/pack_mput_list
+
+    # One container replicated twice
+    local nb=$($PSQL -t -c "SELECT COUNT(*) FROM extent;")
+    if [ $nb -ne $((nb_extents + 2)) ]; then
+        error "Packed objects should share the same extents"
+    fi
+
+    i=1
+    for f in $files; do
+        $valg_phobos get pack$i /tmp/pack_out ||
+            error "Object pack$i should be got"
+        diff $f /tmp/pack_out || error "Object pack$i content differs"
+        rm /tmp/pack_out
+        i=$((i + 1))
+    done
+
+    $valg_phobos get --range 100:50 pack2 /tmp/pack_out ||
+        error "A range of object pack2 should be got"
+    cmp <(tail -c +101 $(echo $files | cut -d' ' -f2) | head -c 50) \
+        /tmp/pack_out || error "Range of object pack2 differs"
+    rm /tmp/pack_out
+
+    $phobos delete --hard pack1 || error "Object pack1 should be deleted"
+    nb=$($PSQL -t -c "SELECT COUNT(*) FROM extent WHERE state='orphan';")
+    if [ $nb -ne 0 ]; then
+        error "Container extents should not be orphan while still used"
+    fi
+
+    rm $files
+}
+
+test_pack
+
+################################################################################
+#                             PUT WITH DEDUPLICATION                           #
+################################################################################
+
+function test_dedup
+{
+    local nb_extents=$($PSQL -t -c "SELECT COUNT(*) FROM extent;")
+
+    export PHOBOS_STORE_dedup=true
+
+    $valg_phobos put --family dir /etc/hosts dedup1 ||
+        error "Object dedup1 should be put"
+    $valg_phobos put --family dir /etc/hosts dedup2 ||
+        error "Object dedup2 should be put"
+
+    unset PHOBOS_STORE_dedup
+
+    local nb=$($PSQL -t -c "SELECT COUNT(*) FROM extent;")
+    if [ $nb -ne $((nb_extents + 1)) ]; then
+        error "Deduplicated object should not have written a new extent"
+    fi
+
+    $phobos delete --hard dedup1 || error "Object dedup1 should be deleted"
+
+    nb=$($PSQL -t -c "SELECT COUNT(*) FROM extent WHERE state='orphan';")
+    if [ $nb -ne 0 ]; then
+        error "Extent shared with dedup2 should not be orphan"
+    fi
+
+    $valg_phobos get dedup2 /tmp/dedup2 || error "Object dedup2 should be got"
+    diff /etc/hosts /tmp/dedup2 || error "Object dedup2 content differs"
+    rm /tmp/dedup2
+}
+
+test_dedup
+
+################################################################################
+#                             PUT WITH COMPRESSION                             #
+################################################################################
+
+function test_compression
+{
+    local input=$(mktemp /tmp/test.pho.XXXX)
+    local nb
+
+    # compressible data, larger than the compression chunks
+    yes "phobos compression test" | head -c 1000000 > $input
+
+    $valg_phobos put --family dir --compression zstd:3 $input comp1 ||
+        error "Object comp1 should be put with compression"
+
+    nb=$($PSQL -t -c "SELECT COUNT(*) FROM object
+                      WHERE oid = 'comp1' AND lyt_info::text LIKE '%zstd%';")
+    if [ $nb -ne 1 ]; then
+        error "The codec should be recorded in the layout of comp1"
+    fi
+
+    $valg_phobos get comp1 /tmp/comp1 || error "Object comp1 should be got"
+    diff $input /tmp/comp1 || error "Object comp1 content differs"
+    rm /tmp/comp1
+
+    $valg_phobos get --range 500000:100 comp1 /tmp/comp1 ||
+        error "A range of object comp1 should be got"
+    cmp <(tail -c +500001 $input | head -c 100) /tmp/comp1 ||
+        error "Range of object comp1 differs"
+    rm /tmp/comp1
+
+    $valg_phobos put --family dir --compression lz4 $input comp2 ||
+        error "Object comp2 should be put with compression"
+    $valg_phobos get comp2 /tmp/comp2 || error "Object comp2 should be got"
+    diff $input /tmp/comp2 || error "Object comp2 content differs"
+    rm /tmp/comp2
+
+    $valg_phobos put --family dir --compression foo $input comp3 &&
+        error "Put with an unknown codec should fail"
+
+    rm $input
+}
+
+if ldconfig -p | grep -q libzstd && ldconfig -p | grep -q liblz4; then
+    test_compression
+fi
+
 ################################################################################
 #                         PUT WITH --OVERWRITE OPTION                          #
 ################################################################################
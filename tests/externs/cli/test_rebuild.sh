@@ -0,0 +1,163 @@
+#!/bin/bash
+#
+#  All rights reserved (c) 2014-2024 CEA/DAM.
+#
+#  This file is part of Phobos.
+#
+#  Phobos is free software: you can redistribute it and/or modify it under
+#  the terms of the GNU Lesser General Public License as published by
+#  the Free Software Foundation, either version 2.1 of the Licence, or
+#  (at your option) any later version.
+#
+#  Phobos is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public License
+#  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# Integration test for the rebuild of the extents of failed media
+#
+
+test_dir=$(dirname $(readlink -e $0))
+. $test_dir/../../test_env.sh
+. $test_dir/../../setup_db.sh
+. $test_dir/../../test_launch_daemon.sh
+
+set -xe
+
+function setup
+{
+    setup_tables
+    invoke_lrs
+
+    dirs=""
+    for i in $(seq 4); do
+        dirs="$dirs $(mktemp -d /tmp/test.pho.XXXX)"
+    done
+    $phobos dir add $dirs
+    $phobos dir format --fs posix --unlock $dirs
+}
+
+function cleanup
+{
+    waive_lrs
+    drop_tables
+    rm -rf $dirs /tmp/oid-rebuild*
+}
+
+# Media holding the sync extents of object $1
+function object_media
+{
+    $PSQL -qtAc "SELECT medium_id FROM extent
+                   INNER JOIN layout USING (extent_uuid)
+                   INNER JOIN object USING (object_uuid, version)
+                 WHERE oid = '$1' AND state = 'sync'
+                 ORDER BY medium_id;"
+}
+
+# Fail one of the media of object $1, and export the medium which holds none
+# of its extents
+function fail_one_medium
+{
+    local media=$(object_media $1)
+
+    failed=$(echo "$media" | head -n 1)
+    free=""
+    for dir in $dirs; do
+        if ! echo "$media" | grep -qx "$dir"; then
+            free=$dir
+        fi
+    done
+
+    $PSQL -qc "UPDATE media SET adm_status = 'failed' WHERE id = '$failed';"
+}
+
+# Check that object $1 is stored on 3 distinct media, $free and not $failed
+function check_rebuilt
+{
+    local media=$(object_media $1)
+
+    if [ $(echo "$media" | sort -u | wc -l) -ne 3 ]; then
+        error "$1 should have 3 extents on distinct media: $media"
+    fi
+
+    echo "$media" | grep -qx "$free" ||
+        error "$1 should have been rebuilt on the free medium $free"
+    echo "$media" | grep -qx "$failed" &&
+        error "$1 should not be stored on the failed medium anymore"
+
+    $phobos get $1 /tmp/$1 || error "get $1 should have succeeded"
+    diff /etc/hosts /tmp/$1 || error "$1 is not correctly rebuilt"
+    rm -f /tmp/$1
+}
+
+function test_rebuild_raid1
+{
+    setup
+
+    $phobos put --family dir --lyt-params repl_count=3 /etc/hosts \
+        oid-rebuild-raid1
+    fail_one_medium oid-rebuild-raid1
+
+    # the surviving replicas are not valid targets, only the free medium is
+    $phobos rebuild
+    check_rebuilt oid-rebuild-raid1
+
+    cleanup
+}
+
+function test_rebuild_raid4
+{
+    setup
+
+    $phobos put --family dir --layout raid4 /etc/hosts oid-rebuild-raid4
+    fail_one_medium oid-rebuild-raid4
+
+    $phobos rebuild
+    check_rebuilt oid-rebuild-raid4
+
+    cleanup
+}
+
+function test_rebuild_shared
+{
+    setup
+
+    $phobos put --family dir --lyt-params repl_count=3 /etc/hosts \
+        oid-rebuild-src
+
+    # a second object shares the layout of the first one
+    $PSQL << EOF
+INSERT INTO object (oid, user_md, lyt_info)
+  SELECT 'oid-rebuild-dup', '{}', lyt_info FROM object
+  WHERE oid = 'oid-rebuild-src';
+INSERT INTO layout (object_uuid, version, extent_uuid, layout_index)
+  SELECT (SELECT object_uuid FROM object WHERE oid = 'oid-rebuild-dup'), 1,
+         extent_uuid, layout_index
+  FROM layout INNER JOIN object USING (object_uuid, version)
+  WHERE oid = 'oid-rebuild-src';
+EOF
+    fail_one_medium oid-rebuild-src
+
+    # the shared extent is rebuilt once for both objects
+    $phobos rebuild
+    nb=$($PSQL -qtAc "SELECT COUNT(*) FROM extent WHERE medium_id = '$free';")
+    if [ $nb -ne 1 ]; then
+        error "the shared extent should have been rebuilt once, not $nb times"
+    fi
+
+    check_rebuilt oid-rebuild-src
+    check_rebuilt oid-rebuild-dup
+
+    cleanup
+}
+
+trap cleanup ERR
+
+test_rebuild_raid1
+test_rebuild_raid4
+test_rebuild_shared
@@ -0,0 +1,119 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Time taken by the DSS to lock, refresh, query and unlock sets of
+ *         1, 100 and 10000 locks, each operation being done in a single call.
+ */
+
+#include "test_setup.h"
+#include "pho_common.h"
+#include "pho_dss.h"
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+static double elapsed_us(struct timeval *start)
+{
+    struct timeval end;
+
+    gettimeofday(&end, NULL);
+
+    return (end.tv_sec - start->tv_sec) * 1e6 +
+        (end.tv_usec - start->tv_usec);
+}
+
+static int bench_lock_set(struct dss_handle *handle, int count)
+{
+    struct object_info *objects;
+    struct timeval start;
+    double refresh_time = 0.;
+    double status_time = 0.;
+    double unlock_time;
+    double lock_time;
+    int rc2;
+    int rc;
+    int i;
+
+    objects = xcalloc(count, sizeof(*objects));
+    for (i = 0; i < count; i++)
+        objects[i].oid = g_strdup_printf("bench_object_%d", i);
+
+    gettimeofday(&start, NULL);
+    rc = dss_lock(handle, DSS_OBJECT, objects, count);
+    lock_time = elapsed_us(&start);
+    if (rc)
+        LOG_GOTO(free_objects, rc, "Failed to lock %d objects", count);
+
+    gettimeofday(&start, NULL);
+    rc = dss_lock_refresh(handle, DSS_OBJECT, objects, count);
+    refresh_time = elapsed_us(&start);
+    if (rc)
+        LOG_GOTO(unlock, rc, "Failed to refresh %d locks", count);
+
+    gettimeofday(&start, NULL);
+    rc = dss_lock_status(handle, DSS_OBJECT, objects, count, NULL);
+    status_time = elapsed_us(&start);
+    if (rc)
+        LOG_GOTO(unlock, rc, "Failed to query %d locks", count);
+
+unlock:
+    gettimeofday(&start, NULL);
+    rc2 = dss_unlock(handle, DSS_OBJECT, objects, count, false);
+    unlock_time = elapsed_us(&start);
+    rc = rc ? : rc2;
+
+    if (!rc)
+        printf("dss_lock: %d lock(s): lock %.1f us/lock, refresh %.1f "
+               "us/lock, status %.1f us/lock, unlock %.1f us/lock\n",
+               count, lock_time / count, refresh_time / count,
+               status_time / count, unlock_time / count);
+
+free_objects:
+    for (i = 0; i < count; i++)
+        g_free(objects[i].oid);
+    free(objects);
+
+    return rc;
+}
+
+int main(void)
+{
+    static const int counts[] = {1, 100, 10000};
+    void *state = NULL;
+    int rc = 0;
+    int c;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    if (global_setup_dss_with_dbinit(&state))
+        return EXIT_FAILURE;
+
+    for (c = 0; c < sizeof(counts) / sizeof(*counts) && !rc; c++)
+        rc = bench_lock_set(state, counts[c]);
+
+    global_teardown_dss_with_dbdrop(&state);
+
+    return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Rate of object inserts done by the DSS with SQL literals, one
+ *         prepared statement at a time and in pipelined batches.
+ */
+
+#include "test_setup.h"
+#include "dss_statements.h"
+#include "dss_utils.h"
+#include "pho_common.h"
+#include "pho_dss.h"
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+/* number of statements executed by each mode of the benchmark */
+#define BENCH_STATEMENTS 2000
+
+static double elapsed(struct timeval *start)
+{
+    struct timeval end;
+
+    gettimeofday(&end, NULL);
+
+    return (end.tv_sec - start->tv_sec) +
+        (end.tv_usec - start->tv_usec) / 1e6;
+}
+
+static int drop_objects(struct dss_handle *handle, const char *pattern)
+{
+    GString *request = g_string_new("");
+    PGresult *res;
+    int rc;
+
+    g_string_printf(request, "DELETE FROM object WHERE oid LIKE '%s';",
+                    pattern);
+    rc = execute(handle->dh_conn, request->str, &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    g_string_free(request, true);
+
+    return rc;
+}
+
+/* the statements built before the prepared ones, executed by PQexec */
+static int insert_literals(struct dss_handle *handle)
+{
+    GString *request = g_string_new("");
+    PGresult *res;
+    int rc = 0;
+    int i;
+
+    for (i = 0; i < BENCH_STATEMENTS && !rc; i++) {
+        char *oid = g_strdup_printf("bench_literal_%d", i);
+        char *escaped = dss_char4sql(handle->dh_conn, oid);
+
+        g_string_printf(request,
+                        "INSERT INTO object (oid, user_md, obj_status)"
+                        " VALUES (%s, '{}', 'incomplete');", escaped);
+        rc = execute(handle->dh_conn, request->str, &res, PGRES_COMMAND_OK);
+        PQclear(res);
+        free_dss_char4sql(escaped);
+        g_free(oid);
+    }
+
+    g_string_free(request, true);
+
+    return rc;
+}
+
+static void object_insert_params(struct dss_params *params, const char *mode,
+                                 int i)
+{
+    char *oid = g_strdup_printf("bench_%s_%d", mode, i);
+
+    dss_params_add_str(params, oid);
+    dss_params_add_str(params, "{}");
+    dss_params_add_str(params, "incomplete");
+    g_free(oid);
+}
+
+static int insert_prepared(struct dss_handle *handle)
+{
+    PGresult *res;
+    int rc = 0;
+    int i;
+
+    for (i = 0; i < BENCH_STATEMENTS && !rc; i++) {
+        struct dss_params params = {0};
+
+        object_insert_params(&params, "prepared", i);
+        rc = execute_prepared(handle, DSS_STMT_OBJECT_INSERT, &params, &res,
+                              PGRES_COMMAND_OK);
+        PQclear(res);
+        dss_params_clean(&params);
+    }
+
+    return rc;
+}
+
+static int insert_batch(struct dss_handle *handle)
+{
+    struct dss_batch batch;
+    int rc;
+    int i;
+
+    dss_batch_init(&batch);
+    for (i = 0; i < BENCH_STATEMENTS; i++) {
+        struct dss_params params = {0};
+
+        object_insert_params(&params, "batch", i);
+        dss_batch_add(&batch, DSS_STMT_OBJECT_INSERT, &params);
+    }
+
+    rc = dss_batch_execute(handle, &batch);
+    dss_batch_clean(&batch);
+
+    return rc;
+}
+
+static const struct bench_mode {
+    const char *name;
+    const char *pattern;
+    int (*insert)(struct dss_handle *handle);
+} bench_modes[] = {
+    { "SQL literals",        "bench_literal_%",  insert_literals },
+    { "prepared statements", "bench_prepared_%", insert_prepared },
+    { "pipelined batch",     "bench_batch_%",    insert_batch },
+};
+
+int main(void)
+{
+    void *state = NULL;
+    int rc = 0;
+    int i;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    if (global_setup_dss_with_dbinit(&state))
+        return EXIT_FAILURE;
+
+    for (i = 0; i < sizeof(bench_modes) / sizeof(*bench_modes) && !rc; i++) {
+        const struct bench_mode *mode = &bench_modes[i];
+        struct timeval start;
+        double seconds;
+
+        gettimeofday(&start, NULL);
+        rc = mode->insert(state);
+        seconds = elapsed(&start);
+        if (rc) {
+            pho_error(rc, "Failed to insert objects with %s", mode->name);
+            break;
+        }
+
+        printf("dss_statements: %-24s %8.0f statements/s\n", mode->name,
+               BENCH_STATEMENTS / seconds);
+        rc = drop_objects(state, mode->pattern);
+    }
+
+    global_teardown_dss_with_dbdrop(&state);
+
+    return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,353 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Replay of a read trace with the "first" and "cost" policies of the
+ *         grouped_read scheduler, reporting the mounts per hour and the recall
+ *         latency of each policy.
+ *
+ * Usage: bench_grouped_read_replay [trace]
+ *
+ * The trace is read from the given file, or from the file named by
+ * PHOBOS_READ_TRACE, one "<arrival in seconds> <medium index> <size in bytes>"
+ * line per request. Without trace, one with a few popular media is generated.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pho_common.h"
+
+#include "io_schedulers/schedulers.h"
+
+#define REPLAY_MEDIA       64
+#define REPLAY_DRIVES      4
+#define REPLAY_REQUESTS    4000
+#define REPLAY_MOUNT_S     90.
+#define REPLAY_MIB_PER_S   300.
+
+struct replay_request {
+    double arrival_s;
+    int    medium;
+    size_t size;
+    double done_s;
+};
+
+struct replay_trace {
+    struct replay_request *requests;
+    size_t                 count;
+    int                    n_media;
+};
+
+struct replay_result {
+    int    mounts;
+    double duration_s;
+    double p99_latency_s;
+    double mean_latency_s;
+};
+
+/**
+ * Generate a read trace of REPLAY_REQUESTS requests, with a few popular media.
+ */
+static void replay_trace_generate(struct replay_trace *trace)
+{
+    unsigned int seed = 42;
+    double arrival_s = 0.;
+    size_t i;
+
+    trace->requests = xcalloc(REPLAY_REQUESTS, sizeof(*trace->requests));
+    trace->count = REPLAY_REQUESTS;
+    trace->n_media = REPLAY_MEDIA;
+
+    for (i = 0; i < REPLAY_REQUESTS; i++) {
+        struct replay_request *req = &trace->requests[i];
+
+        arrival_s += rand_r(&seed) % 6;
+        req->arrival_s = arrival_s;
+        /* half the requests target an eighth of the media */
+        if (rand_r(&seed) % 2)
+            req->medium = rand_r(&seed) % (REPLAY_MEDIA / 8);
+        else
+            req->medium = rand_r(&seed) % REPLAY_MEDIA;
+        req->size = (1 + rand_r(&seed) % 256) * (1024 * 1024ULL);
+    }
+}
+
+static int cmp_arrival(const void *_a, const void *_b)
+{
+    const struct replay_request *a = _a;
+    const struct replay_request *b = _b;
+
+    return a->arrival_s < b->arrival_s ? -1 : a->arrival_s > b->arrival_s;
+}
+
+/**
+ * Load the read trace of \p path, sorted by arrival.
+ */
+static int replay_trace_load(const char *path, struct replay_trace *trace)
+{
+    size_t allocated = REPLAY_REQUESTS;
+    struct replay_request req = {0};
+    FILE *file;
+    int rc = 0;
+
+    file = fopen(path, "r");
+    if (!file)
+        LOG_RETURN(-errno, "Failed to open trace '%s'", path);
+
+    trace->requests = xcalloc(allocated, sizeof(*trace->requests));
+    trace->count = 0;
+    trace->n_media = 0;
+
+    while (fscanf(file, "%lf %d %zu", &req.arrival_s, &req.medium,
+                  &req.size) == 3) {
+        if (req.medium < 0)
+            LOG_GOTO(out_close, rc = -EINVAL,
+                     "Invalid medium index %d at line %zu of '%s'",
+                     req.medium, trace->count + 1, path);
+
+        if (trace->count == allocated) {
+            allocated *= 2;
+            trace->requests = xrealloc(trace->requests,
+                                       allocated * sizeof(*trace->requests));
+        }
+
+        trace->requests[trace->count++] = req;
+        trace->n_media = max(trace->n_media, req.medium + 1);
+    }
+
+    if (!feof(file))
+        LOG_GOTO(out_close, rc = -EINVAL, "Invalid line %zu of '%s'",
+                 trace->count + 1, path);
+
+    if (trace->count == 0)
+        LOG_GOTO(out_close, rc = -ENODATA, "Empty trace '%s'", path);
+
+    qsort(trace->requests, trace->count, sizeof(*trace->requests),
+          cmp_arrival);
+
+out_close:
+    fclose(file);
+    if (rc)
+        free(trace->requests);
+
+    return rc;
+}
+
+/* Medium of the oldest pending request (first), or of the pending requests with
+ * the best grouped_read_queue_score (cost), which is not in another drive.
+ */
+static int replay_pick_medium(struct replay_trace *trace,
+                              const struct grouped_read_cost *cost,
+                              const int *drive_medium, int drive, double now)
+{
+    struct replay_request *requests = trace->requests;
+    size_t *n_requests;
+    double best_score = -1.;
+    double *oldest;
+    size_t *bytes;
+    int best = -1;
+    size_t i;
+    int m;
+
+    n_requests = xcalloc(trace->n_media, sizeof(*n_requests));
+    bytes = xcalloc(trace->n_media, sizeof(*bytes));
+    oldest = xcalloc(trace->n_media, sizeof(*oldest));
+
+    for (i = 0; i < trace->count && requests[i].arrival_s <= now; i++) {
+        bool busy = false;
+        int d;
+
+        if (requests[i].done_s >= 0.)
+            continue;
+
+        m = requests[i].medium;
+        for (d = 0; d < REPLAY_DRIVES; d++)
+            if (d != drive && drive_medium[d] == m)
+                busy = true;
+        if (busy)
+            continue;
+
+        /* the trace is sorted by arrival */
+        if (!cost) {
+            best = m;
+            goto out_free;
+        }
+
+        if (!n_requests[m])
+            oldest[m] = requests[i].arrival_s;
+        n_requests[m]++;
+        bytes[m] += requests[i].size;
+    }
+
+    for (m = 0; m < trace->n_media; m++) {
+        double score;
+
+        if (!n_requests[m])
+            continue;
+
+        score = grouped_read_queue_score(cost, n_requests[m], bytes[m],
+                                         now - oldest[m],
+                                         drive_medium[drive] == m);
+        if (score > best_score) {
+            best_score = score;
+            best = m;
+        }
+    }
+
+out_free:
+    free(n_requests);
+    free(bytes);
+    free(oldest);
+
+    return best;
+}
+
+static int cmp_double(const void *_a, const void *_b)
+{
+    const double *a = _a;
+    const double *b = _b;
+
+    return *a < *b ? -1 : *a > *b;
+}
+
+/**
+ * Replay the trace on REPLAY_DRIVES drives. Each time a drive is free, it
+ * mounts the medium chosen by the policy, unless already loaded, and reads all
+ * the requests pending on it.
+ */
+static void replay(struct replay_trace *trace,
+                   const struct grouped_read_cost *cost,
+                   struct replay_result *result)
+{
+    struct replay_request *requests = trace->requests;
+    int drive_medium[REPLAY_DRIVES];
+    double drive_free[REPLAY_DRIVES];
+    size_t count = trace->count;
+    size_t served = 0;
+    double *latency;
+    size_t i;
+    int d;
+
+    for (i = 0; i < count; i++)
+        requests[i].done_s = -1.;
+    for (d = 0; d < REPLAY_DRIVES; d++) {
+        drive_medium[d] = -1;
+        drive_free[d] = 0.;
+    }
+    result->mounts = 0;
+
+    while (served < count) {
+        double now;
+        int m;
+
+        d = 0;
+        for (i = 1; i < REPLAY_DRIVES; i++)
+            if (drive_free[i] < drive_free[d])
+                d = i;
+        now = drive_free[d];
+
+        m = replay_pick_medium(trace, cost, drive_medium, d, now);
+        if (m < 0) {
+            /* idle until the next request arrives */
+            for (i = 0; i < count && requests[i].arrival_s <= now; i++)
+                ;
+            drive_free[d] = i < count ? requests[i].arrival_s : now + 1.;
+            continue;
+        }
+
+        if (drive_medium[d] != m) {
+            drive_medium[d] = m;
+            now += REPLAY_MOUNT_S;
+            result->mounts++;
+        }
+
+        for (i = 0; i < count && requests[i].arrival_s <= now; i++) {
+            if (requests[i].medium != m || requests[i].done_s >= 0.)
+                continue;
+
+            now += requests[i].size / (REPLAY_MIB_PER_S * 1024 * 1024);
+            requests[i].done_s = now;
+            served++;
+        }
+        drive_free[d] = now;
+    }
+
+    latency = xcalloc(count, sizeof(*latency));
+    result->duration_s = 0.;
+    result->mean_latency_s = 0.;
+    for (i = 0; i < count; i++) {
+        latency[i] = requests[i].done_s - requests[i].arrival_s;
+        result->mean_latency_s += latency[i] / count;
+        result->duration_s = max(result->duration_s, requests[i].done_s);
+    }
+    qsort(latency, count, sizeof(*latency), cmp_double);
+    result->p99_latency_s = latency[count * 99 / 100];
+    free(latency);
+}
+
+static void replay_report(const char *policy, struct replay_result *result)
+{
+    printf("  %-5s policy: %.1f mounts per hour, latency mean %.0fs, "
+           "p99 %.0fs\n", policy, result->mounts * 3600. / result->duration_s,
+           result->mean_latency_s, result->p99_latency_s);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : getenv("PHOBOS_READ_TRACE");
+    struct grouped_read_cost cost = {
+        .mount_cost_s = REPLAY_MOUNT_S,
+        .deadline_s = 3600.,
+    };
+    struct replay_result by_cost;
+    struct replay_result first;
+    struct replay_trace trace;
+    int rc;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    if (path) {
+        rc = replay_trace_load(path, &trace);
+        if (rc)
+            return EXIT_FAILURE;
+    } else {
+        replay_trace_generate(&trace);
+    }
+
+    replay(&trace, NULL, &first);
+    replay(&trace, &cost, &by_cost);
+
+    printf("grouped_read replay of %zu reads on %d media:\n", trace.count,
+           trace.n_media);
+    replay_report("first", &first);
+    replay_report("cost", &by_cost);
+
+    free(trace.requests);
+
+    return EXIT_SUCCESS;
+}
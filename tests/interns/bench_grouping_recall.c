@@ -0,0 +1,175 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Mounts needed to recall each grouping, with the objects placed by
+ *         the device selection policy only (before the grouping collocation),
+ *         then collocated by grouping.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_type_utils.h"
+
+#include "lrs_device.h"
+#include "lrs_sched.h"
+#include "pho_test_utils.h"
+
+#define LTO5_MODEL "ULTRIUM-TD5"
+
+#define BENCH_DRIVES    4
+#define BENCH_GROUPINGS 4
+#define BENCH_BATCHES   32
+
+static void medium_add_grouping(struct media_info *medium, const char *grouping)
+{
+    size_t n = medium->groupings.n_tags;
+
+    medium->groupings.tags = xrealloc(medium->groupings.tags,
+                                      (n + 1) * sizeof(char *));
+    medium->groupings.tags[n] = xstrdup(grouping);
+    medium->groupings.n_tags = n + 1;
+}
+
+/**
+ * Write BENCH_BATCHES batches of concurrent writes, one object of each
+ * grouping per batch in a random order, on as many mounted drives, and count
+ * the number of mounts needed to recall each grouping afterwards.
+ */
+static int grouping_recall_mounts(bool collocate, int *mounts)
+{
+    bool used[BENCH_GROUPINGS][BENCH_DRIVES] = {{false}};
+    char names[BENCH_DRIVES][16];
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium[BENCH_DRIVES];
+    struct lrs_dev device[BENCH_DRIVES];
+    unsigned int seed = 42;
+    int batch;
+    int rc = 0;
+    int i;
+
+    for (i = 0; i < BENCH_DRIVES; i++) {
+        snprintf(names[i], sizeof(names[i]), "bench%d", i);
+        create_device(&device[i], names[i], LTO5_MODEL, NULL);
+        create_medium(&medium[i], names[i]);
+        device[i].ld_op_status = PHO_DEV_OP_ST_MOUNTED;
+        device[i].ld_dss_media_info = &medium[i];
+        medium[i].stats.phys_spc_free = 1LL << 40;
+        g_ptr_array_add(devices, &device[i]);
+    }
+
+    for (batch = 0; batch < BENCH_BATCHES && !rc; batch++) {
+        int order[BENCH_GROUPINGS];
+
+        /* the writes of a batch reach the LRS in any order */
+        for (i = 0; i < BENCH_GROUPINGS; i++)
+            order[i] = i;
+        for (i = BENCH_GROUPINGS - 1; i > 0; i--) {
+            int j = rand_r(&seed) % (i + 1);
+            int tmp = order[i];
+
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+
+        for (i = 0; i < BENCH_GROUPINGS; i++) {
+            char grouping[16];
+            struct lrs_dev *dev = NULL;
+            int m;
+
+            snprintf(grouping, sizeof(grouping), "grouping%d", order[i]);
+            if (collocate)
+                dev = grouping_dev_picker(devices, PHO_DEV_OP_ST_MOUNTED,
+                                          NULL, PHO_QOS_NORMAL, grouping,
+                                          select_first_fit, 1, &NO_TAGS,
+                                          false);
+            if (!dev)
+                dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                                 PHO_QOS_NORMAL, select_first_fit, 1, &NO_TAGS,
+                                 NULL, true, false, NULL);
+            if (!dev)
+                LOG_GOTO(cleanup, rc = -ENODEV,
+                         "No device selected for grouping '%s'", grouping);
+
+            /* the drive is busy until the end of the batch */
+            dev->ld_ongoing_scheduled = true;
+            m = dev - device;
+            used[order[i]][m] = true;
+            if (collocate && !tag_exists(&medium[m].groupings, grouping))
+                medium_add_grouping(&medium[m], grouping);
+        }
+
+        for (i = 0; i < BENCH_DRIVES; i++)
+            device[i].ld_ongoing_scheduled = false;
+    }
+
+    *mounts = 0;
+    for (i = 0; i < BENCH_GROUPINGS; i++) {
+        int m;
+
+        for (m = 0; m < BENCH_DRIVES; m++)
+            *mounts += used[i][m];
+    }
+
+cleanup:
+    g_ptr_array_free(devices, true);
+    for (i = 0; i < BENCH_DRIVES; i++) {
+        tags_free(&medium[i].groupings);
+        cleanup_device(&device[i]);
+    }
+
+    return rc;
+}
+
+int main(void)
+{
+    int collocated;
+    int scattered;
+    int rc;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    rc = pho_cfg_init_local("../phobos.conf");
+    if (rc)
+        return EXIT_FAILURE;
+
+    rc = grouping_recall_mounts(false, &scattered);
+    if (!rc)
+        rc = grouping_recall_mounts(true, &collocated);
+    if (rc)
+        return EXIT_FAILURE;
+
+    printf("grouping recall: %.2f mounts per grouping without collocation, "
+           "%.2f with collocation\n",
+           (double) scattered / BENCH_GROUPINGS,
+           (double) collocated / BENCH_GROUPINGS);
+
+    return EXIT_SUCCESS;
+}
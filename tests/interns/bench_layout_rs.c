@@ -0,0 +1,163 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Encoding and worst case decoding (m lost data extents) throughput
+ *         of the Reed-Solomon layout for each GF(2^8) kernel, given in MB of
+ *         object data per second.
+ */
+
+#include "rs.h"
+#include "pho_common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* size of the data of each extent encoded by the benchmark */
+#define RS_BENCH_LEN (4 * 1024 * 1024)
+
+struct rs_geometry {
+    int k;
+    int m;
+};
+
+static const struct rs_geometry geometries[] = {
+    {1, 1}, {2, 1}, {4, 2}, {8, 3}, {10, 4},
+};
+
+static const char * const kernels[] = {"generic", "ssse3", "avx2"};
+
+static uint8_t **alloc_extents(int n, size_t len)
+{
+    uint8_t **extents = xmalloc(n * sizeof(*extents));
+    int i;
+
+    for (i = 0; i < n; i++)
+        extents[i] = xmalloc(len);
+
+    return extents;
+}
+
+static void free_extents(uint8_t **extents, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        free(extents[i]);
+    free(extents);
+}
+
+static double elapsed(struct timespec *start)
+{
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) +
+        (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int bench_geometry(int k, int m)
+{
+    uint8_t **extents = alloc_extents(k + m, RS_BENCH_LEN);
+    uint8_t **rebuilt = alloc_extents(m, RS_BENCH_LEN);
+    uint8_t *available[RS_MAX_EXTENTS];
+    int missing[RS_MAX_EXTENTS] = {0};
+    int rows[RS_MAX_EXTENTS] = {0};
+    int n_missing = min(k, m);
+    struct timespec start;
+    double encode_time;
+    double decode_time;
+    uint8_t *matrix;
+    size_t j;
+    int rc;
+    int i;
+
+    for (i = 0; i < k; i++)
+        for (j = 0; j < RS_BENCH_LEN; j++)
+            extents[i][j] = rand();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    matrix = xmalloc(k * m);
+    rs_encoding_matrix(k, m, matrix);
+    rs_matrix_apply(matrix, m, k, extents, extents + k, RS_BENCH_LEN);
+    encode_time = elapsed(&start);
+    free(matrix);
+
+    /* lose the n_missing first data extents */
+    for (i = 0; i < k; i++) {
+        rows[i] = i + n_missing;
+        available[i] = extents[rows[i]];
+    }
+    for (i = 0; i < n_missing; i++)
+        missing[i] = i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    matrix = xmalloc(n_missing * k);
+    rc = rs_decoding_matrix(k, m, rows, missing, n_missing, matrix);
+    if (rc)
+        LOG_GOTO(cleanup, rc, "Failed to build the decoding matrix");
+    rs_matrix_apply(matrix, n_missing, k, available, rebuilt, RS_BENCH_LEN);
+    decode_time = elapsed(&start);
+
+    for (i = 0; i < n_missing; i++)
+        if (memcmp(rebuilt[i], extents[i], RS_BENCH_LEN))
+            LOG_GOTO(cleanup, rc = -EILSEQ,
+                     "Extent %d was not rebuilt correctly", i);
+
+    printf("rs: %-7s k=%d m=%d: encode %.1f MB/s, decode %d lost "
+           "extent(s) %.1f MB/s\n", gf_kernel_name(), k, m,
+           (double)k * RS_BENCH_LEN / encode_time / 1e6, n_missing,
+           (double)k * RS_BENCH_LEN / decode_time / 1e6);
+
+cleanup:
+    free(matrix);
+    free_extents(rebuilt, m);
+    free_extents(extents, k + m);
+
+    return rc;
+}
+
+int main(void)
+{
+    int rc = 0;
+    int g;
+    int i;
+
+    srand(time(NULL));
+
+    for (i = 0; i < sizeof(kernels) / sizeof(*kernels) && !rc; i++) {
+        rc = gf_kernel_select(kernels[i]);
+        if (rc) {
+            printf("rs: %-7s not supported\n", kernels[i]);
+            rc = 0;
+            continue;
+        }
+
+        for (g = 0; g < sizeof(geometries) / sizeof(*geometries) && !rc; g++)
+            rc = bench_geometry(geometries[g].k, geometries[g].m);
+    }
+
+    return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
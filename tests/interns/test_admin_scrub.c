@@ -0,0 +1,231 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the extent verification of the scrubber
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "admin_utils.h"
+#include "raid_common.h"
+#include "scrub.h"
+
+#include "pho_common.h"
+#include "pho_io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define ADDRESS "scrub_extent"
+#define DATA "0123456789abcdef"
+#define DATA_SIZE (sizeof(DATA) - 1)
+
+static char root_dir[] = "/tmp/test_admin_scrub.XXXXXX";
+
+struct scrub_state {
+    struct io_adapter_module *ioa;
+    struct extent             extent;
+    struct pho_ext_loc        loc;
+    struct scrub_stats        stats;
+    char                     *path;
+    char                     *buffer;
+    size_t                    buf_size;
+};
+
+static void write_extent(const char *path, const char *data, size_t size)
+{
+    int fd;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    assert_true(fd >= 0);
+    assert_int_equal(write(fd, data, size), size);
+    close(fd);
+}
+
+static int scrub_setup(void **state)
+{
+    struct scrub_state *scrub = xcalloc(1, sizeof(*scrub));
+    struct extent_hash hash = {0};
+    int rc;
+
+    rc = get_io_adapter(PHO_FS_POSIX, &scrub->ioa);
+    assert_return_code(rc, -rc);
+
+    assert_true(asprintf(&scrub->path, "%s/%s", root_dir, ADDRESS) > 0);
+    write_extent(scrub->path, DATA, DATA_SIZE);
+
+    /* the checksum stored in the DSS when the extent was written */
+    rc = extent_hash_init(&hash, true, false);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_reset(&hash);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_update(&hash, DATA, DATA_SIZE);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_digest(&hash);
+    assert_return_code(rc, -rc);
+    memcpy(scrub->extent.md5, hash.md5, MD5_BYTE_LENGTH);
+    extent_hash_fini(&hash);
+
+    scrub->extent.uuid = "scrub-uuid";
+    scrub->extent.size = DATA_SIZE;
+    scrub->extent.with_md5 = true;
+    scrub->extent.address.buff = ADDRESS;
+    scrub->extent.address.size = strlen(ADDRESS) + 1;
+    scrub->loc.root_path = root_dir;
+    scrub->loc.extent = &scrub->extent;
+    scrub->loc.addr_type = PHO_ADDR_PATH;
+
+    *state = scrub;
+
+    return 0;
+}
+
+static int scrub_teardown(void **state)
+{
+    struct scrub_state *scrub = *state;
+
+    unlink(scrub->path);
+    free(scrub->path);
+    free(scrub->buffer);
+    free(scrub);
+
+    return 0;
+}
+
+static int verify(struct scrub_state *scrub)
+{
+    return scrub_extent_verify(scrub->ioa, &scrub->loc, &scrub->buffer,
+                               &scrub->buf_size, 0, &scrub->stats);
+}
+
+/* an intact extent is read entirely and verified */
+static void scrub_intact(void **state)
+{
+    struct scrub_state *scrub = *state;
+    int rc;
+
+    rc = verify(scrub);
+    assert_return_code(rc, -rc);
+    assert_int_equal(scrub->stats.size, DATA_SIZE);
+    assert_non_null(scrub->buffer);
+    assert_true(scrub->buf_size >= DATA_SIZE);
+
+    /* the buffer is reused for the next extents */
+    rc = verify(scrub);
+    assert_return_code(rc, -rc);
+    assert_int_equal(scrub->stats.size, 2 * DATA_SIZE);
+}
+
+/* only a checksum mismatch is reported as a corruption */
+static void scrub_corrupted(void **state)
+{
+    struct scrub_state *scrub = *state;
+    char data[] = DATA;
+
+    data[3] ^= 1;
+    write_extent(scrub->path, data, DATA_SIZE);
+
+    assert_int_equal(verify(scrub), -EBADMSG);
+    assert_int_equal(scrub->stats.size, DATA_SIZE);
+}
+
+/* an extent which cannot be read is not a corrupted one */
+static void scrub_missing(void **state)
+{
+    struct scrub_state *scrub = *state;
+    int rc;
+
+    unlink(scrub->path);
+
+    rc = verify(scrub);
+    assert_true(rc < 0);
+    assert_int_not_equal(rc, -EBADMSG);
+    assert_int_equal(scrub->stats.size, 0);
+}
+
+static void scrub_truncated(void **state)
+{
+    struct scrub_state *scrub = *state;
+
+    write_extent(scrub->path, DATA, DATA_SIZE / 2);
+
+    assert_int_equal(verify(scrub), -ENODATA);
+    assert_int_equal(scrub->stats.size, DATA_SIZE / 2);
+}
+
+/* the throttling waits for the processed bytes to match the rate */
+static void scrub_throttle(void **state)
+{
+    struct timespec start;
+    struct timespec end;
+    double elapsed;
+
+    (void) state;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    admin_throttle(&start, 100000, 0);
+    admin_throttle(&start, 100000, 1000000);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    /* 100 kB at 1 MB/s */
+    elapsed = (end.tv_sec - start.tv_sec) +
+              (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    assert_true(elapsed >= 0.099);
+}
+
+int main(void)
+{
+    const struct CMUnitTest admin_scrub_test_cases[] = {
+        cmocka_unit_test_setup_teardown(scrub_intact, scrub_setup,
+                                        scrub_teardown),
+        cmocka_unit_test_setup_teardown(scrub_corrupted, scrub_setup,
+                                        scrub_teardown),
+        cmocka_unit_test_setup_teardown(scrub_missing, scrub_setup,
+                                        scrub_teardown),
+        cmocka_unit_test_setup_teardown(scrub_truncated, scrub_setup,
+                                        scrub_teardown),
+        cmocka_unit_test(scrub_throttle),
+    };
+    int rc;
+
+    if (!mkdtemp(root_dir))
+        return EXIT_FAILURE;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    rc = cmocka_run_group_tests(admin_scrub_test_cases, NULL, NULL);
+    rmdir(root_dir);
+
+    return rc;
+}
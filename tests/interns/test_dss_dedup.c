@@ -0,0 +1,348 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the DSS functions of the deduplication
+ */
+
+#include "test_setup.h"
+#include "dss_utils.h"
+#include "store_dedup.h"
+#include "pho_dss.h"
+#include "pho_dss_wrapper.h"
+#include "pho_type_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define DIGEST "0123456789abcdef"
+#define SIZE 10
+
+static const char *EXTENTS[] = {"dd_ext_0", "dd_ext_1"};
+
+static void run_sql(struct dss_handle *handle, const char *request)
+{
+    PGresult *res;
+    int rc;
+
+    rc = execute(handle->dh_conn, request, &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    assert_return_code(rc, -rc);
+}
+
+static int count_rows(struct dss_handle *handle, const char *request)
+{
+    PGresult *res;
+    int count;
+    int rc;
+
+    rc = execute(handle->dh_conn, request, &res, PGRES_TUPLES_OK);
+    assert_return_code(rc, -rc);
+    count = atoi(PQgetvalue(res, 0, 0));
+    PQclear(res);
+
+    return count;
+}
+
+/*
+ * Object dd_src (raid1) stores DIGEST on two sync extents of the directory
+ * dd_dir, tagged "fast". Object dd_dst was just created by a PUT of the same
+ * content.
+ */
+static int dd_setup(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+
+    run_sql(handle,
+        "INSERT INTO media (family, id, adm_status, fs_type, address_type,"
+        "                   fs_status, stats, tags, library)"
+        " VALUES ('dir', 'dd_dir', 'unlocked', 'POSIX', 'PATH', 'used',"
+        "         '{}', '[\"fast\"]', 'legacy');"
+        "INSERT INTO object (oid, user_md, object_uuid, version, lyt_info)"
+        " VALUES ('dd_src', '{}', 'dd_src_uuid', 1, '{\"name\": \"raid1\"}'),"
+        "        ('dd_dst', '{}', 'dd_dst_uuid', 1, '{}');"
+        "INSERT INTO extent (extent_uuid, state, size, medium_family,"
+        "                    medium_id, medium_library, address)"
+        " VALUES ('dd_ext_0', 'sync', 10, 'dir', 'dd_dir', 'legacy', 'a'),"
+        "        ('dd_ext_1', 'sync', 10, 'dir', 'dd_dir', 'legacy', 'b');"
+        "INSERT INTO layout (object_uuid, version, extent_uuid, layout_index)"
+        " VALUES ('dd_src_uuid', 1, 'dd_ext_0', 0),"
+        "        ('dd_src_uuid', 1, 'dd_ext_1', 1);"
+        "INSERT INTO dedup (digest, size, object_uuid, version)"
+        " VALUES ('" DIGEST "', 10, 'dd_src_uuid', 1);");
+
+    return 0;
+}
+
+static int dd_teardown(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+
+    run_sql(handle,
+        "DELETE FROM dedup; DELETE FROM layout; DELETE FROM extent;"
+        "DELETE FROM object; DELETE FROM media;");
+
+    return 0;
+}
+
+/** Look for DIGEST, return whether dd_src matched */
+static bool lookup(struct dss_handle *handle, enum rsc_family family,
+                   const char *layout_name, const char *library,
+                   const struct tags *tags)
+{
+    bool found;
+    char *uuid;
+    int version;
+    int rc;
+
+    rc = dss_dedup_lookup(handle, DIGEST, SIZE, family, layout_name, library,
+                          tags, &uuid, &version);
+    assert_return_code(rc, -rc);
+
+    found = uuid != NULL;
+    if (found) {
+        assert_string_equal(uuid, "dd_src_uuid");
+        assert_int_equal(version, 1);
+    }
+    free(uuid);
+
+    return found;
+}
+
+static void dd_lookup_match(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    char *fast[] = {"fast"};
+    struct tags tags = {
+        .tags = fast,
+        .n_tags = 1,
+    };
+
+    assert_true(lookup(handle, PHO_RSC_DIR, "raid1", NULL, NULL));
+    assert_true(lookup(handle, PHO_RSC_DIR, "raid1", "legacy", &tags));
+}
+
+/* the duplicate must be stored where the PUT asked for */
+static void dd_lookup_placement(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    char *slow[] = {"slow"};
+    struct tags tags = {
+        .tags = slow,
+        .n_tags = 1,
+    };
+
+    assert_false(lookup(handle, PHO_RSC_TAPE, "raid1", NULL, NULL));
+    assert_false(lookup(handle, PHO_RSC_DIR, "raid4", NULL, NULL));
+    assert_false(lookup(handle, PHO_RSC_DIR, "raid1", "blob", NULL));
+    assert_false(lookup(handle, PHO_RSC_DIR, "raid1", NULL, &tags));
+}
+
+/* an object version with an extent which is not sync is not a duplicate */
+static void dd_lookup_not_sync(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+
+    run_sql(handle,
+            "UPDATE extent SET state = 'orphan'"
+            " WHERE extent_uuid = 'dd_ext_1';");
+    assert_false(lookup(handle, PHO_RSC_DIR, "raid1", NULL, NULL));
+}
+
+static void dd_share_ok(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    int rc;
+
+    rc = dss_layout_share(handle, "dd_src_uuid", 1, "dd_dst");
+    assert_return_code(rc, -rc);
+
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM layout WHERE object_uuid = 'dd_dst_uuid';"), 2);
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM object"
+        " WHERE oid = 'dd_dst' AND lyt_info->>'name' = 'raid1';"), 1);
+}
+
+/* a layout whose extents are being released is not shared */
+static void dd_share_not_sync(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    int rc;
+
+    run_sql(handle,
+            "UPDATE extent SET state = 'orphan'"
+            " WHERE extent_uuid = 'dd_ext_1';");
+
+    rc = dss_layout_share(handle, "dd_src_uuid", 1, "dd_dst");
+    assert_int_equal(rc, -ENOENT);
+
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM layout WHERE object_uuid = 'dd_dst_uuid';"), 0);
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM object"
+        " WHERE oid = 'dd_dst' AND lyt_info->>'name' = 'raid1';"), 0);
+}
+
+/* the extents of a shared layout are only orphaned by their last user */
+static void dd_release_shared(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    int rc;
+
+    rc = dss_layout_share(handle, "dd_src_uuid", 1, "dd_dst");
+    assert_return_code(rc, -rc);
+
+    /* the source object is deleted, the dedup entry moves to dd_dst */
+    run_sql(handle, "DELETE FROM layout WHERE object_uuid = 'dd_src_uuid';");
+    rc = dss_update_extent_release(handle, EXTENTS, 2, "dd_src_uuid", 1);
+    assert_return_code(rc, -rc);
+
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM extent WHERE state = 'sync';"), 2);
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM dedup WHERE object_uuid = 'dd_dst_uuid';"), 1);
+
+    /* the last user is deleted, all its extents are orphaned */
+    run_sql(handle, "DELETE FROM layout WHERE object_uuid = 'dd_dst_uuid';");
+    rc = dss_update_extent_release(handle, EXTENTS, 2, "dd_dst_uuid", 1);
+    assert_return_code(rc, -rc);
+
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM extent WHERE state = 'orphan';"), 2);
+    assert_int_equal(count_rows(handle, "SELECT COUNT(*) FROM dedup;"), 0);
+}
+
+/* a layout referencing only some of the released extents is not a sharer */
+static void dd_release_partial_sharer(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    int rc;
+
+    run_sql(handle,
+            "INSERT INTO layout (object_uuid, version, extent_uuid,"
+            "                    layout_index)"
+            " VALUES ('dd_dst_uuid', 1, 'dd_ext_1', 0);"
+            "DELETE FROM layout WHERE object_uuid = 'dd_src_uuid';");
+
+    rc = dss_update_extent_release(handle, EXTENTS, 2, "dd_src_uuid", 1);
+    assert_return_code(rc, -rc);
+
+    /* every released extent is handled, not only the first one */
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM extent"
+        " WHERE extent_uuid = 'dd_ext_0' AND state = 'orphan';"), 1);
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM extent"
+        " WHERE extent_uuid = 'dd_ext_1' AND state = 'sync';"), 1);
+    assert_int_equal(count_rows(handle, "SELECT COUNT(*) FROM dedup;"), 0);
+}
+
+/* SHA-256 digest of CONTENT, as computed by the store */
+#define CONTENT "0123456789"
+#define CONTENT_DIGEST \
+    "84d89877f0d4041efb6bf91a16f0248f2fd573e6af05c19f96bedb9f882f7882"
+
+/*
+ * A PUT whose match is released between the lookup and the share of its
+ * layout writes its content instead of failing.
+ */
+static void dd_share_released(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    char path[] = "/tmp/test_dss_dedup.XXXXXX";
+    struct pho_xfer_desc xfer = {0};
+    struct dedup_info dedup = {0};
+    int rc;
+
+    run_sql(handle,
+            "INSERT INTO dedup (digest, size, object_uuid, version)"
+            " VALUES ('" CONTENT_DIGEST "', 10, 'dd_src_uuid', 1);");
+
+    xfer.xd_fd = mkstemp(path);
+    assert_true(xfer.xd_fd >= 0);
+    unlink(path);
+    assert_int_equal(write(xfer.xd_fd, CONTENT, SIZE), SIZE);
+    assert_int_equal(lseek(xfer.xd_fd, 0, SEEK_SET), 0);
+
+    xfer.xd_objid = "dd_dst";
+    xfer.xd_params.put.size = SIZE;
+    xfer.xd_params.put.family = PHO_RSC_DIR;
+    xfer.xd_params.put.layout_name = "raid1";
+
+    rc = dedup_lookup(handle, &xfer, &dedup);
+    assert_return_code(rc, -rc);
+    assert_string_equal(dedup.digest, CONTENT_DIGEST);
+    assert_string_equal(dedup.match_uuid, "dd_src_uuid");
+
+    /* the extents of the matched object are released meanwhile */
+    run_sql(handle, "UPDATE extent SET state = 'orphan';");
+    assert_int_equal(lseek(xfer.xd_fd, 4, SEEK_SET), 4);
+
+    rc = dedup_share(handle, &xfer, &dedup);
+    assert_return_code(rc, -rc);
+    assert_null(dedup.match_uuid);
+    assert_int_equal(lseek(xfer.xd_fd, 0, SEEK_CUR), 0);
+    assert_int_equal(count_rows(handle,
+        "SELECT COUNT(*) FROM layout WHERE object_uuid = 'dd_dst_uuid';"), 0);
+
+    /* the written content can still be deduplicated afterwards */
+    assert_non_null(dedup.digest);
+
+    dedup_info_clean(&dedup);
+    close(xfer.xd_fd);
+}
+
+int main(void)
+{
+    const struct CMUnitTest dss_dedup_test_cases[] = {
+        cmocka_unit_test_setup_teardown(dd_lookup_match, dd_setup,
+                                        dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_lookup_placement, dd_setup,
+                                        dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_lookup_not_sync, dd_setup,
+                                        dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_share_ok, dd_setup, dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_share_not_sync, dd_setup,
+                                        dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_share_released, dd_setup,
+                                        dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_release_shared, dd_setup,
+                                        dd_teardown),
+        cmocka_unit_test_setup_teardown(dd_release_partial_sharer, dd_setup,
+                                        dd_teardown),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(dss_dedup_test_cases,
+                                  global_setup_dss_with_dbinit,
+                                  global_teardown_dss_with_dbdrop);
+}
@@ -0,0 +1,214 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the DSS functions of the garbage collector
+ */
+
+#include "test_setup.h"
+#include "dss_utils.h"
+#include "pho_dss.h"
+#include "pho_dss_wrapper.h"
+#include "pho_type_utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+static void run_sql(struct dss_handle *handle, const char *request)
+{
+    PGresult *res;
+    int rc;
+
+    rc = execute(handle->dh_conn, request, &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    assert_return_code(rc, -rc);
+}
+
+static int count_extents(struct dss_handle *handle, const char *uuid)
+{
+    struct dss_filter filter;
+    struct extent *extents;
+    int count;
+    int rc;
+
+    rc = dss_filter_build(&filter, "{\"DSS::EXT::uuid\": \"%s\"}", uuid);
+    assert_return_code(rc, -rc);
+
+    rc = dss_extent_get(handle, &filter, &extents, &count);
+    dss_filter_free(&filter);
+    assert_return_code(rc, -rc);
+    dss_res_free(extents, count);
+
+    return count;
+}
+
+/*
+ * Medium gc_used holds:
+ * - gc_live (100 bytes), referenced by the alive object gc_obj,
+ * - gc_deprec (20 bytes), only referenced by a deprecated object,
+ * - gc_orphan (5 bytes) and gc_shared (7 bytes), orphan, the latter
+ *   referenced again by gc_obj,
+ * - gc_pending (1000 bytes), being written.
+ * The locked medium gc_locked holds gc_locked_ext.
+ */
+static int gc_setup(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+
+    run_sql(handle,
+        "INSERT INTO media (family, id, adm_status, fs_type, address_type,"
+        "                   fs_status, stats, tags, library)"
+        " VALUES ('dir', 'gc_used', 'unlocked', 'POSIX', 'PATH', 'used',"
+        "         '{}', '[]', 'legacy'),"
+        "        ('dir', 'gc_locked', 'locked', 'POSIX', 'PATH', 'used',"
+        "         '{}', '[]', 'legacy');"
+        "INSERT INTO object (oid, user_md, object_uuid, version)"
+        " VALUES ('gc_obj', '{}', 'gc_obj_uuid', 1);"
+        "INSERT INTO deprecated_object (oid, user_md, object_uuid, version)"
+        " VALUES ('gc_old', '{}', 'gc_old_uuid', 1);"
+        "INSERT INTO extent (extent_uuid, state, size, medium_family,"
+        "                    medium_id, medium_library, address)"
+        " VALUES ('gc_live', 'sync', 100, 'dir', 'gc_used', 'legacy', 'a'),"
+        "        ('gc_deprec', 'sync', 20, 'dir', 'gc_used', 'legacy', 'b'),"
+        "        ('gc_orphan', 'orphan', 5, 'dir', 'gc_used', 'legacy', 'c'),"
+        "        ('gc_shared', 'orphan', 7, 'dir', 'gc_used', 'legacy', 'd'),"
+        "        ('gc_pending', 'pending', 1000, 'dir', 'gc_used', 'legacy',"
+        "         'e'),"
+        "        ('gc_locked_ext', 'sync', 3, 'dir', 'gc_locked', 'legacy',"
+        "         'f');"
+        "INSERT INTO layout (object_uuid, version, extent_uuid, layout_index)"
+        " VALUES ('gc_obj_uuid', 1, 'gc_live', 0),"
+        "        ('gc_obj_uuid', 1, 'gc_shared', 1),"
+        "        ('gc_old_uuid', 1, 'gc_deprec', 0);");
+
+    return 0;
+}
+
+static int gc_teardown(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+
+    run_sql(handle,
+        "DELETE FROM layout; DELETE FROM extent; DELETE FROM object;"
+        "DELETE FROM deprecated_object; DELETE FROM media;");
+
+    return 0;
+}
+
+static void gc_medium_usage(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct dss_medium_usage *usage;
+    int count;
+    int rc;
+
+    rc = dss_medium_usage_get(handle, PHO_RSC_DIR, &usage, &count);
+    assert_return_code(rc, -rc);
+
+    /* the locked medium is not reported */
+    assert_int_equal(count, 1);
+    assert_string_equal(usage[0].medium.name, "gc_used");
+    assert_string_equal(usage[0].medium.library, "legacy");
+    assert_int_equal(usage[0].medium.family, PHO_RSC_DIR);
+    /* gc_shared is counted as live since it is referenced again */
+    assert_int_equal(usage[0].live_size, 107);
+    /* the pending extent is neither live nor dead */
+    assert_int_equal(usage[0].dead_size, 25);
+    free(usage);
+
+    rc = dss_medium_usage_get(handle, PHO_RSC_TAPE, &usage, &count);
+    assert_return_code(rc, -rc);
+    assert_int_equal(count, 0);
+    assert_null(usage);
+}
+
+static void gc_orphan_claim(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct extent extents[] = {
+        { .uuid = "gc_live" },
+        { .uuid = "gc_shared" },
+        { .uuid = "gc_orphan" },
+        { .uuid = "gc_pending" },
+    };
+    int n_claimed;
+    int rc;
+
+    rc = dss_extent_orphan_claim(handle, extents, 4, &n_claimed);
+    assert_return_code(rc, -rc);
+
+    /* only the unreferenced orphan extent is claimed, and moved first */
+    assert_int_equal(n_claimed, 1);
+    assert_string_equal(extents[0].uuid, "gc_orphan");
+    assert_int_equal(count_extents(handle, "gc_orphan"), 0);
+
+    /* an orphan extent referenced again by a layout is kept */
+    assert_int_equal(count_extents(handle, "gc_shared"), 1);
+    assert_int_equal(count_extents(handle, "gc_live"), 1);
+    assert_int_equal(count_extents(handle, "gc_pending"), 1);
+
+    /* an extent is only claimed once */
+    rc = dss_extent_orphan_claim(handle, extents, 1, &n_claimed);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_claimed, 0);
+}
+
+/* a layout removed after the listing makes the extent claimable */
+static void gc_orphan_claim_unreferenced(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct extent extents[] = {
+        { .uuid = "gc_shared" },
+    };
+    int n_claimed;
+    int rc;
+
+    run_sql(handle, "DELETE FROM layout WHERE extent_uuid = 'gc_shared';");
+
+    rc = dss_extent_orphan_claim(handle, extents, 1, &n_claimed);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_claimed, 1);
+    assert_int_equal(count_extents(handle, "gc_shared"), 0);
+}
+
+int main(void)
+{
+    const struct CMUnitTest dss_gc_test_cases[] = {
+        cmocka_unit_test_setup_teardown(gc_medium_usage, gc_setup,
+                                        gc_teardown),
+        cmocka_unit_test_setup_teardown(gc_orphan_claim, gc_setup,
+                                        gc_teardown),
+        cmocka_unit_test_setup_teardown(gc_orphan_claim_unreferenced, gc_setup,
+                                        gc_teardown),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(dss_gc_test_cases,
+                                  global_setup_dss_with_dbinit,
+                                  global_teardown_dss_with_dbdrop);
+}
@@ -44,6 +44,11 @@ static const struct object_info GOOD_LOCKS[] = {
     { .oid = "object_2"}
 };
 
+static const struct media_info GOOD_MEDIA[] = {
+    { .rsc.id = { .family = PHO_RSC_TAPE, .name = "medium_0",
+                  .library = "library_0" } },
+};
+
 static bool check_newer(struct timeval old_ts, struct timeval new_ts)
 {
     if (old_ts.tv_sec == new_ts.tv_sec)
@@ -413,6 +418,288 @@ static void dss_lock_hostname_unlock_ok(void **state)
     pho_lock_clean(&lock);
 }
 
+static void dss_lock_hostname_each_partial(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    const char *lock_hostname = "A_TRUE_HOSTNAME";
+    int rcs[3];
+    int rc;
+
+    rc = dss_lock(handle, DSS_OBJECT, &GOOD_LOCKS[1], 1);
+    assert_return_code(rc, -rc);
+
+    rc = dss_lock_hostname_each(handle, DSS_OBJECT, GOOD_LOCKS, 3,
+                                lock_hostname, rcs);
+    assert_int_equal(rc, -EEXIST);
+    assert_int_equal(rcs[0], 0);
+    assert_int_equal(rcs[1], -EEXIST);
+    assert_int_equal(rcs[2], 0);
+
+    /* the locks of object_0 and object_2 are kept */
+    rc = dss_lock_status(handle, DSS_OBJECT, GOOD_LOCKS, 3, NULL);
+    assert_return_code(rc, -rc);
+
+    rc = dss_unlock_each(handle, DSS_OBJECT, GOOD_LOCKS, 3, false, rcs);
+    assert_int_equal(rc, -EACCES);
+    assert_int_equal(rcs[0], -EACCES);
+    assert_int_equal(rcs[1], 0);
+    assert_int_equal(rcs[2], -EACCES);
+
+    rc = dss_unlock_each(handle, DSS_OBJECT, GOOD_LOCKS, 3, true, rcs);
+    assert_int_equal(rc, -ENOLCK);
+    assert_int_equal(rcs[0], 0);
+    assert_int_equal(rcs[1], -ENOLCK);
+    assert_int_equal(rcs[2], 0);
+}
+
+/* a deprecated object is locked as an object identified by its uuid */
+static void dss_deprec_lock_unlock_ok(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct object_info deprec = {
+        .oid = "object_0",
+        .uuid = "deprec_uuid_0",
+    };
+    struct object_info by_uuid = { .oid = "deprec_uuid_0" };
+    int rc;
+
+    rc = dss_lock(handle, DSS_DEPREC, &deprec, 1);
+    assert_return_code(rc, -rc);
+
+    rc = dss_lock_status(handle, DSS_DEPREC, &deprec, 1, NULL);
+    assert_return_code(rc, -rc);
+    rc = dss_lock_status(handle, DSS_OBJECT, &by_uuid, 1, NULL);
+    assert_return_code(rc, -rc);
+
+    /* the alive object of the same oid is not locked */
+    rc = dss_lock_status(handle, DSS_OBJECT, &deprec, 1, NULL);
+    assert_int_equal(rc, -ENOLCK);
+
+    rc = dss_unlock(handle, DSS_DEPREC, &deprec, 1, false);
+    assert_return_code(rc, -rc);
+
+    rc = dss_lock_status(handle, DSS_DEPREC, &deprec, 1, NULL);
+    assert_int_equal(rc, -ENOLCK);
+}
+
+static void dss_medium_reserve_ok(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    static const char *OTHER_LOCK_HOSTNAME = "dummy_hostname2";
+    struct timeval expected;
+    struct timeval status;
+    char *hostname;
+    int rc;
+
+    gettimeofday(&expected, NULL);
+    expected.tv_sec += 60;
+    expected.tv_usec = 0;
+
+    rc = dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected);
+    assert_return_code(rc, -rc);
+
+    rc = dss_medium_reservation(handle, &GOOD_MEDIA[0].rsc.id, &hostname,
+                                &status);
+    assert_return_code(rc, -rc);
+    assert_string_equal(hostname, get_hostname());
+    assert_int_equal(status.tv_sec, expected.tv_sec);
+    free(hostname);
+
+    /* the owner of a reservation updates it */
+    expected.tv_sec += 60;
+    rc = dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected);
+    assert_return_code(rc, -rc);
+
+    rc = dss_unlock(handle, DSS_MEDIA_RESERVATION, GOOD_MEDIA, 1, false);
+    assert_return_code(rc, -rc);
+
+    rc = dss_medium_reservation(handle, &GOOD_MEDIA[0].rsc.id, &hostname,
+                                &status);
+    assert_int_equal(rc, -ENOLCK);
+    assert_null(hostname);
+
+    /* a reservation without expected mount time is never taken over */
+    rc = _dss_lock(handle, DSS_MEDIA_RESERVATION, GOOD_MEDIA, 1,
+                   OTHER_LOCK_HOSTNAME, 1337);
+    assert_return_code(rc, -rc);
+
+    rc = dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected);
+    assert_int_equal(rc, -EEXIST);
+
+    assert(dss_unlock(handle, DSS_MEDIA_RESERVATION, GOOD_MEDIA, 1,
+                      true) == 0);
+}
+
+/** Reserve GOOD_MEDIA for another host, expected in \p delay seconds */
+static void reserve_other(struct dss_handle *handle, int delay)
+{
+    static const char *OTHER_LOCK_HOSTNAME = "dummy_hostname2";
+    struct timeval expected;
+    int rc;
+
+    gettimeofday(&expected, NULL);
+    expected.tv_sec += delay;
+
+    rc = _dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected,
+                             OTHER_LOCK_HOSTNAME, 1337);
+    assert_return_code(rc, -rc);
+}
+
+static void dss_medium_reserve_takeover(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct timeval expected;
+    char *hostname;
+    int rc;
+
+    gettimeofday(&expected, NULL);
+    expected.tv_sec += 60;
+
+    /* a later mount does not take over the reservation */
+    reserve_other(handle, 30);
+    rc = dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected);
+    assert_int_equal(rc, -EEXIST);
+
+    rc = dss_medium_reservation(handle, &GOOD_MEDIA[0].rsc.id, &hostname,
+                                NULL);
+    assert_return_code(rc, -rc);
+    assert_string_equal(hostname, "dummy_hostname2");
+    free(hostname);
+
+    /* an earlier mount does */
+    assert(dss_unlock(handle, DSS_MEDIA_RESERVATION, GOOD_MEDIA, 1,
+                      true) == 0);
+    reserve_other(handle, 120);
+    rc = dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected);
+    assert_return_code(rc, -rc);
+
+    rc = dss_medium_reservation(handle, &GOOD_MEDIA[0].rsc.id, &hostname,
+                                NULL);
+    assert_return_code(rc, -rc);
+    assert_string_equal(hostname, get_hostname());
+    free(hostname);
+
+    /* so does any mount once the reserved one is past */
+    assert(dss_unlock(handle, DSS_MEDIA_RESERVATION, GOOD_MEDIA, 1,
+                      true) == 0);
+    reserve_other(handle, -10);
+    rc = dss_medium_reserve(handle, GOOD_MEDIA, 1, &expected);
+    assert_return_code(rc, -rc);
+
+    assert(dss_unlock(handle, DSS_MEDIA_RESERVATION, GOOD_MEDIA, 1,
+                      true) == 0);
+}
+
+/**
+ * A set of locks is taken, refreshed, queried and released in a single call,
+ * and is not taken at all if one of its locks exists.
+ */
+static void dss_lock_large_set(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    const char *lock_hostname = get_hostname();
+    const int lock_owner = getpid();
+    const int count = 1000;
+    struct object_info *objects;
+    struct pho_lock *locks;
+    int rc;
+    int i;
+
+    objects = xcalloc(count, sizeof(*objects));
+    for (i = 0; i < count; i++)
+        objects[i].oid = g_strdup_printf("set_object_%d", i);
+    locks = xcalloc(count, sizeof(*locks));
+
+    /* one existing lock prevents the whole set from being locked */
+    rc = dss_lock(handle, DSS_OBJECT, &objects[count / 2], 1);
+    assert_return_code(rc, -rc);
+    rc = dss_lock(handle, DSS_OBJECT, objects, count);
+    assert_int_equal(rc, -EEXIST);
+    rc = dss_lock_status(handle, DSS_OBJECT, objects, 1, NULL);
+    assert_int_equal(rc, -ENOLCK);
+    rc = dss_unlock(handle, DSS_OBJECT, &objects[count / 2], 1, false);
+    assert_return_code(rc, -rc);
+
+    rc = dss_lock(handle, DSS_OBJECT, objects, count);
+    assert_return_code(rc, -rc);
+    rc = dss_lock_refresh(handle, DSS_OBJECT, objects, count);
+    assert_return_code(rc, -rc);
+
+    /* the locks are returned in the order of the resources */
+    rc = dss_lock_status(handle, DSS_OBJECT, objects, count, locks);
+    assert_return_code(rc, -rc);
+    for (i = 0; i < count; i++) {
+        assert_string_equal(locks[i].hostname, lock_hostname);
+        assert_int_equal(locks[i].owner, lock_owner);
+        pho_lock_clean(&locks[i]);
+    }
+
+    rc = dss_unlock(handle, DSS_OBJECT, objects, count, false);
+    assert_return_code(rc, -rc);
+    rc = dss_lock_status(handle, DSS_OBJECT, &objects[count - 1], 1, NULL);
+    assert_int_equal(rc, -ENOLCK);
+
+    for (i = 0; i < count; i++)
+        g_free(objects[i].oid);
+    free(objects);
+    free(locks);
+}
+
+/**
+ * A resource given twice to a single call is only locked once, its second
+ * occurrence failing as already locked.
+ */
+static void dss_lock_duplicate_ids(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    const struct object_info objects[] = {
+        GOOD_LOCKS[0], GOOD_LOCKS[1], GOOD_LOCKS[0]
+    };
+    const struct media_info media[] = { GOOD_MEDIA[0], GOOD_MEDIA[0] };
+    struct timeval expected;
+    struct timeval status;
+    char *hostname;
+    int rcs[3];
+    int rc;
+
+    rc = dss_lock(handle, DSS_OBJECT, objects, 3);
+    assert_int_equal(rc, -EEXIST);
+    rc = dss_lock_status(handle, DSS_OBJECT, objects, 1, NULL);
+    assert_int_equal(rc, -ENOLCK);
+    rc = dss_lock_status(handle, DSS_OBJECT, &objects[1], 1, NULL);
+    assert_int_equal(rc, -ENOLCK);
+
+    rc = dss_lock_hostname_each(handle, DSS_OBJECT, objects, 3,
+                                get_hostname(), rcs);
+    assert_int_equal(rc, -EEXIST);
+    assert_int_equal(rcs[0], 0);
+    assert_int_equal(rcs[1], 0);
+    assert_int_equal(rcs[2], -EEXIST);
+
+    /* refreshing or releasing a lock twice is the same as doing it once */
+    rc = dss_lock_refresh(handle, DSS_OBJECT, objects, 3);
+    assert_return_code(rc, -rc);
+    rc = dss_unlock(handle, DSS_OBJECT, objects, 3, false);
+    assert_return_code(rc, -rc);
+    rc = dss_lock_status(handle, DSS_OBJECT, objects, 2, NULL);
+    assert_int_equal(rc, -ENOLCK);
+
+    gettimeofday(&expected, NULL);
+    expected.tv_sec += 60;
+    expected.tv_usec = 0;
+
+    rc = dss_medium_reserve(handle, media, 2, &expected);
+    assert_int_equal(rc, -EEXIST);
+    rc = dss_medium_reservation(handle, &media[0].rsc.id, &hostname, &status);
+    assert_return_code(rc, -rc);
+    assert_string_equal(hostname, get_hostname());
+    assert_int_equal(status.tv_sec, expected.tv_sec);
+    free(hostname);
+
+    rc = dss_unlock(handle, DSS_MEDIA_RESERVATION, media, 2, false);
+    assert_return_code(rc, -rc);
+}
+
 int main(void)
 {
     const struct CMUnitTest dss_lock_test_cases[] = {
@@ -432,6 +719,12 @@ int main(void)
         cmocka_unit_test(dss_multiple_refresh_ok),
         cmocka_unit_test(dss_multiple_refresh_not_exists),
         cmocka_unit_test(dss_lock_hostname_unlock_ok),
+        cmocka_unit_test(dss_lock_hostname_each_partial),
+        cmocka_unit_test(dss_deprec_lock_unlock_ok),
+        cmocka_unit_test(dss_medium_reserve_ok),
+        cmocka_unit_test(dss_medium_reserve_takeover),
+        cmocka_unit_test(dss_lock_large_set),
+        cmocka_unit_test(dss_lock_duplicate_ids),
     };
 
     pho_context_init();
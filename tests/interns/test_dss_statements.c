@@ -0,0 +1,199 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the DSS prepared statements
+ */
+
+#include "test_setup.h"
+#include "dss_statements.h"
+#include "dss_utils.h"
+#include "pho_dss.h"
+#include "pho_type_utils.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cmocka.h>
+
+/* number of statements of a large batch */
+#define BATCH_STATEMENTS 2000
+
+static void drop_objects(struct dss_handle *handle, const char *pattern)
+{
+    GString *request = g_string_new("");
+    PGresult *res;
+    int rc;
+
+    g_string_printf(request, "DELETE FROM object WHERE oid LIKE '%s';",
+                    pattern);
+    rc = execute(handle->dh_conn, request->str, &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    g_string_free(request, true);
+    assert_return_code(rc, -rc);
+}
+
+static int count_objects(struct dss_handle *handle, const char *oid)
+{
+    struct dss_filter filter;
+    struct object_info *objs;
+    int count;
+    int rc;
+
+    rc = dss_filter_build(&filter, "{\"DSS::OBJ::oid\": \"%s\"}", oid);
+    assert_return_code(rc, -rc);
+
+    rc = dss_object_get(handle, &filter, &objs, &count, NULL);
+    dss_filter_free(&filter);
+    assert_return_code(rc, -rc);
+    dss_res_free(objs, count);
+
+    return count;
+}
+
+/* quotes used to need escaping when given as SQL literals */
+static void dss_prepared_insert_quotes(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct object_info object = {
+        .oid = "it's_an_object",
+        .user_md = "{\"owner\": \"o'brien\"}",
+        .obj_status = PHO_OBJ_STATUS_INCOMPLETE,
+    };
+    int rc;
+
+    rc = dss_object_insert(handle, &object, 1, DSS_SET_INSERT);
+    assert_return_code(rc, -rc);
+    assert_int_equal(count_objects(handle, object.oid), 1);
+
+    drop_objects(handle, "it''s_an_object");
+}
+
+/* a failed statement of a batch cancels the whole batch */
+static void dss_batch_all_or_nothing(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct dss_batch batch;
+    int rc;
+    int i;
+
+    dss_batch_init(&batch);
+    for (i = 0; i < 3; i++) {
+        struct dss_params params = {0};
+
+        /* the third insert conflicts with the first one */
+        dss_params_add_str(&params, i == 1 ? "batch_obj_1" : "batch_obj_0");
+        dss_params_add_str(&params, "{}");
+        dss_params_add_str(&params, "incomplete");
+        dss_batch_add(&batch, DSS_STMT_OBJECT_INSERT, &params);
+    }
+
+    rc = dss_batch_execute(handle, &batch);
+    dss_batch_clean(&batch);
+    assert_int_equal(rc, -EEXIST);
+
+    assert_int_equal(count_objects(handle, "batch_obj_0"), 0);
+    assert_int_equal(count_objects(handle, "batch_obj_1"), 0);
+}
+
+/* a statement can still be executed after the registry was reset */
+static void dss_prepared_reset(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct dss_params params = {0};
+    PGresult *res;
+    int rc;
+
+    dss_params_add_str(&params, "tape");
+    dss_params_add_str(&params, "no_such_medium");
+    dss_params_add_str(&params, "legacy");
+
+    rc = execute_prepared(handle, DSS_STMT_MEDIUM_HEALTH, &params, &res,
+                          PGRES_TUPLES_OK);
+    assert_return_code(rc, -rc);
+    assert_int_equal(PQntuples(res), 0);
+    PQclear(res);
+
+    /* the statement still exists on the connection */
+    dss_statements_reset(handle);
+    rc = execute_prepared(handle, DSS_STMT_MEDIUM_HEALTH, &params, &res,
+                          PGRES_TUPLES_OK);
+    PQclear(res);
+    assert_return_code(rc, -rc);
+
+    dss_params_clean(&params);
+}
+
+/* a batch sends all its statements before reading their results */
+static void dss_batch_large(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct dss_batch batch;
+    PGresult *res;
+    int rc;
+    int i;
+
+    dss_batch_init(&batch);
+    for (i = 0; i < BATCH_STATEMENTS; i++) {
+        struct dss_params params = {0};
+        char *oid = g_strdup_printf("batch_large_%d", i);
+
+        dss_params_add_str(&params, oid);
+        dss_params_add_str(&params, "{}");
+        dss_params_add_str(&params, "incomplete");
+        dss_batch_add(&batch, DSS_STMT_OBJECT_INSERT, &params);
+        g_free(oid);
+    }
+    rc = dss_batch_execute(handle, &batch);
+    dss_batch_clean(&batch);
+    assert_return_code(rc, -rc);
+
+    rc = execute(handle->dh_conn,
+                 "SELECT count(*) FROM object WHERE oid LIKE 'batch_large_%';",
+                 &res, PGRES_TUPLES_OK);
+    assert_return_code(rc, -rc);
+    assert_int_equal(atoi(PQgetvalue(res, 0, 0)), BATCH_STATEMENTS);
+    PQclear(res);
+
+    assert_int_equal(count_objects(handle, "batch_large_0"), 1);
+
+    drop_objects(handle, "batch_large_%");
+}
+
+int main(void)
+{
+    const struct CMUnitTest dss_statements_test_cases[] = {
+        cmocka_unit_test(dss_prepared_insert_quotes),
+        cmocka_unit_test(dss_batch_all_or_nothing),
+        cmocka_unit_test(dss_prepared_reset),
+        cmocka_unit_test(dss_batch_large),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(dss_statements_test_cases,
+                                  global_setup_dss_with_dbinit,
+                                  global_teardown_dss_with_dbdrop);
+}
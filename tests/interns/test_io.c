@@ -403,6 +403,117 @@ clean_test_dir_source:
     return rc;
 }
 
+static int write_file(const char *fpath, const unsigned char *buff,
+                      size_t size)
+{
+    FILE *stream;
+    int rc = 0;
+
+    stream = fopen(fpath, "w");
+    if (stream == NULL)
+        LOG_RETURN(-errno, "Cannot create '%s'", fpath);
+
+    if (fwrite(buff, 1, size, stream) != size)
+        rc = -EIO;
+
+    if (fclose(stream))
+        rc = rc ? : -errno;
+
+    return rc;
+}
+
+#define XOR_SIZE_0 (10 * 1024)
+#define XOR_SIZE_1 (7 * 1024 + 3)
+
+/* the shortest source is padded with zeroes */
+static int test_xor_extents(void *state)
+{
+    char test_dir[] = "/tmp/test_xor_extentsXXXXXX";
+    const size_t sizes[2] = {XOR_SIZE_0, XOR_SIZE_1};
+    struct pho_io_descr iod_sources[2] = {0};
+    struct pho_ext_loc loc_sources[2] = {0};
+    struct io_adapter_module *ioa = NULL;
+    char *addresses[2] = {"xor_0", "xor_1"};
+    struct pho_io_descr iod_target = {0};
+    struct pho_ext_loc loc_target = {0};
+    unsigned char *buffs[2] = {NULL};
+    struct extent ext_sources[2];
+    unsigned char *expected;
+    char *fpath_target = NULL;
+    char *fpaths[2] = {NULL};
+    struct extent ext_target;
+    int rc;
+    int i;
+
+    (void)state;
+
+    if (mkdtemp(test_dir) == NULL)
+        LOG_RETURN(-errno, "Unable to create test dir");
+
+    rc = get_io_adapter(PHO_FS_POSIX, &ioa);
+    if (rc)
+        LOG_GOTO(clean_test_dir, rc, "Unable to get posix ioa");
+
+    expected = xcalloc(XOR_SIZE_0, 1);
+    for (i = 0; i < 2; ++i) {
+        size_t j;
+
+        buffs[i] = xmalloc(sizes[i]);
+        for (j = 0; j < sizes[i]; ++j) {
+            buffs[i][j] = (unsigned char)(j * (i + 3) + i);
+            expected[j] ^= buffs[i][j];
+        }
+
+        if (asprintf(&fpaths[i], "%s/%s", test_dir, addresses[i]) < 0)
+            LOG_GOTO(free_buffs, rc = -ENOMEM, "Unable to allocate fpath");
+
+        rc = write_file(fpaths[i], buffs[i], sizes[i]);
+        if (rc)
+            LOG_GOTO(free_buffs, rc, "Unable to create source %d", i);
+
+        memset(&ext_sources[i], 0, sizeof(ext_sources[i]));
+        ext_sources[i].address.buff = addresses[i];
+        loc_sources[i].extent = &ext_sources[i];
+        loc_sources[i].root_path = test_dir;
+        iod_sources[i].iod_loc = &loc_sources[i];
+        iod_sources[i].iod_size = sizes[i];
+    }
+
+    if (asprintf(&fpath_target, "%s/xor_target", test_dir) < 0)
+        LOG_GOTO(free_buffs, rc = -ENOMEM, "Unable to allocate fpath");
+
+    memset(&ext_target, 0, sizeof(ext_target));
+    ext_target.address.buff = "xor_target";
+    loc_target.extent = &ext_target;
+    loc_target.root_path = test_dir;
+    iod_target.iod_loc = &loc_target;
+    iod_target.iod_size = XOR_SIZE_0;
+
+    rc = xor_extents(ioa, iod_sources, ioa, &iod_target);
+    pho_attrs_free(&iod_sources[0].iod_attrs);
+    if (rc)
+        LOG_GOTO(free_buffs, rc, "Extent XOR failed");
+
+    rc = check_file_content(fpath_target, expected, XOR_SIZE_0, 1);
+    remove(fpath_target);
+
+free_buffs:
+    for (i = 0; i < 2; ++i) {
+        if (fpaths[i])
+            remove(fpaths[i]);
+        free(fpaths[i]);
+        free(buffs[i]);
+    }
+    free(fpath_target);
+    free(expected);
+
+clean_test_dir:
+    if (rmdir(test_dir))
+        pho_error(rc = rc ? : -errno, "Unable to remove test dir");
+
+    return rc;
+}
+
 int main(int argc, char **argv)
 {
     test_env_initialize();
@@ -421,6 +532,8 @@ int main(int argc, char **argv)
 
     pho_run_test("Posix copy",
                  test_copy_extent, NULL, PHO_TEST_SUCCESS);
+    pho_run_test("Posix XOR of two extents",
+                 test_xor_extents, NULL, PHO_TEST_SUCCESS);
 
     pho_info("Unit IO posix open/write/close: All tests succeeded");
     exit(EXIT_SUCCESS);
@@ -0,0 +1,261 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Test the Reed-Solomon layout arithmetic
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pho_common.h"
+#include "rs.h"
+
+#include <cmocka.h>
+
+/* not a multiple of the SIMD width to exercise the generic tail */
+#define RS_TEST_LEN 4099
+
+struct rs_geometry {
+    int k;
+    int m;
+};
+
+static const struct rs_geometry geometries[] = {
+    {1, 1}, {2, 1}, {4, 2}, {8, 3}, {10, 4},
+};
+
+static uint8_t **alloc_extents(int n, size_t len)
+{
+    uint8_t **extents = xmalloc(n * sizeof(*extents));
+    int i;
+
+    for (i = 0; i < n; i++)
+        extents[i] = xmalloc(len);
+
+    return extents;
+}
+
+static void free_extents(uint8_t **extents, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        free(extents[i]);
+    free(extents);
+}
+
+static void fill_random(uint8_t **extents, int n, size_t len)
+{
+    size_t j;
+    int i;
+
+    for (i = 0; i < n; i++)
+        for (j = 0; j < len; j++)
+            extents[i][j] = rand();
+}
+
+static void encode(int k, int m, uint8_t **extents, size_t len)
+{
+    uint8_t *matrix = xmalloc(k * m);
+
+    rs_encoding_matrix(k, m, matrix);
+    rs_matrix_apply(matrix, m, k, extents, extents + k, len);
+    free(matrix);
+}
+
+static void rs_gf_mul(void **state)
+{
+    int a;
+    int b;
+
+    (void)state;
+
+    for (a = 0; a < 256; a++) {
+        assert_int_equal(gf_mul(a, 0), 0);
+        assert_int_equal(gf_mul(a, 1), a);
+
+        for (b = 0; b < 256; b++) {
+            uint8_t expected = 0;
+            uint8_t x = a;
+            int y = b;
+
+            /* shift and add multiplication */
+            while (y) {
+                if (y & 1)
+                    expected ^= x;
+                x = (x << 1) ^ (x & 0x80 ? 0x1d : 0);
+                y >>= 1;
+            }
+
+            assert_int_equal(gf_mul(a, b), expected);
+        }
+    }
+}
+
+static void rs_vect_mul_add(void **state)
+{
+    uint8_t src[RS_TEST_LEN];
+    uint8_t dst[RS_TEST_LEN];
+    uint8_t ref[RS_TEST_LEN];
+    int c;
+    int i;
+
+    (void)state;
+
+    for (i = 0; i < RS_TEST_LEN; i++)
+        src[i] = rand();
+
+    for (c = 0; c < 256; c++) {
+        for (i = 0; i < RS_TEST_LEN; i++) {
+            dst[i] = i;
+            ref[i] = i ^ gf_mul(c, src[i]);
+        }
+
+        gf_vect_mul_add(c, src, dst, RS_TEST_LEN);
+        assert_memory_equal(dst, ref, RS_TEST_LEN);
+    }
+}
+
+/**
+ * Rebuild the data extents from k of the k + m extents, chosen as the k first
+ * extents after a rotation of \p skip extents, i.e. losing up to m data
+ * extents.
+ */
+static void check_rebuild(int k, int m, uint8_t **extents, int skip)
+{
+    uint8_t **rebuilt = alloc_extents(m, RS_TEST_LEN);
+    uint8_t *available[RS_MAX_EXTENTS];
+    int missing[RS_MAX_EXTENTS] = {0};
+    int rows[RS_MAX_EXTENTS] = {0};
+    uint8_t *matrix;
+    int n_missing = 0;
+    int rc;
+    int i;
+
+    for (i = 0; i < k; i++) {
+        rows[i] = (skip + i) % (k + m);
+        available[i] = extents[rows[i]];
+    }
+
+    for (i = 0; i < k; i++) {
+        int j;
+
+        for (j = 0; j < k; j++)
+            if (rows[j] == i)
+                break;
+
+        if (j == k)
+            missing[n_missing++] = i;
+    }
+
+    matrix = xmalloc(k * k);
+    rc = rs_decoding_matrix(k, m, rows, missing, n_missing, matrix);
+    assert_return_code(rc, -rc);
+
+    rs_matrix_apply(matrix, n_missing, k, available, rebuilt, RS_TEST_LEN);
+    for (i = 0; i < n_missing; i++)
+        assert_memory_equal(rebuilt[i], extents[missing[i]], RS_TEST_LEN);
+
+    free(matrix);
+    free_extents(rebuilt, m);
+}
+
+static void rs_encode_rebuild(void **state)
+{
+    int g;
+
+    (void)state;
+
+    for (g = 0; g < sizeof(geometries) / sizeof(*geometries); g++) {
+        int k = geometries[g].k;
+        int m = geometries[g].m;
+        uint8_t **extents = alloc_extents(k + m, RS_TEST_LEN);
+        int skip;
+
+        fill_random(extents, k, RS_TEST_LEN);
+        encode(k, m, extents, RS_TEST_LEN);
+
+        for (skip = 0; skip <= m; skip++)
+            check_rebuild(k, m, extents, skip);
+
+        free_extents(extents, k + m);
+    }
+}
+
+static void rs_decoding_matrix_duplicate(void **state)
+{
+    int missing[] = {1};
+    int rows[] = {0, 0};
+    uint8_t matrix[2];
+    int rc;
+
+    (void)state;
+
+    rc = rs_decoding_matrix(2, 1, rows, missing, 1, matrix);
+    assert_int_equal(rc, -EINVAL);
+}
+
+/* the kernels do not expect their buffers to be aligned */
+static void rs_vect_mul_add_unaligned(void **state)
+{
+    uint8_t src[RS_TEST_LEN + 1];
+    uint8_t dst[RS_TEST_LEN + 3];
+    uint8_t ref[RS_TEST_LEN];
+    int i;
+
+    (void)state;
+
+    assert_non_null(gf_kernel_name());
+
+    for (i = 0; i < RS_TEST_LEN; i++) {
+        src[i + 1] = rand();
+        dst[i + 3] = i;
+        ref[i] = i ^ gf_mul(0x53, src[i + 1]);
+    }
+
+    gf_vect_mul_add(0x53, src + 1, dst + 3, RS_TEST_LEN);
+    assert_memory_equal(dst + 3, ref, RS_TEST_LEN);
+}
+
+int main(void)
+{
+    const struct CMUnitTest layout_rs_tests[] = {
+        cmocka_unit_test(rs_gf_mul),
+        cmocka_unit_test(rs_vect_mul_add),
+        cmocka_unit_test(rs_encode_rebuild),
+        cmocka_unit_test(rs_decoding_matrix_duplicate),
+        cmocka_unit_test(rs_vect_mul_add_unaligned),
+    };
+
+    srand(time(NULL));
+
+    return cmocka_run_group_tests(layout_rs_tests, NULL, NULL);
+}
@@ -20,9 +20,13 @@
  *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "ldm_common.h"
+#include "ldm_lib_dummy.h"
 #include "pho_test_utils.h"
 #include "pho_ldm.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
 static int _find_dev(const struct mntent *mntent, void *cb_data)
 {
     const char *dev_name = cb_data;
@@ -79,6 +83,75 @@ static int test_df_2(void *arg)
     return simple_statfs(NULL, &spc);
 }
 
+/** Load a medium and check whether it had to be moved from a far slot */
+static int dummy_load_check(struct lib_handle *lib_hdl, const char *drive,
+                            const char *medium, bool moved)
+{
+    struct dummy_lib *dummy = lib_hdl->lh_lib;
+    unsigned int moves = dummy->moves;
+    int rc;
+
+    rc = ldm_lib_load(lib_hdl, drive, medium);
+    if (rc)
+        return rc;
+
+    if ((dummy->moves != moves) != moved)
+        LOG_RETURN(-EINVAL, "load of '%s' in '%s' %s moved from a far slot",
+                   medium, drive, moved ? "was not" : "was");
+
+    return 0;
+}
+
+static int test_dummy_stage(void *arg)
+{
+    struct lib_handle lib_hdl;
+    int rc2;
+    int rc;
+
+    rc = get_lib_adapter_and_open(PHO_LIB_DUMMY, &lib_hdl, "legacy");
+    if (rc)
+        return rc;
+
+    /* a medium which was never staged is fetched from its slot */
+    rc = dummy_load_check(&lib_hdl, "host:/drive0", "/medium0", true);
+    if (rc)
+        goto out_close;
+
+    /* an unloaded medium is kept near its drive */
+    rc = ldm_lib_unload(&lib_hdl, "host:/drive0", "/medium0");
+    if (rc)
+        goto out_close;
+
+    rc = dummy_load_check(&lib_hdl, "host:/drive0", "/medium0", false);
+    if (rc)
+        goto out_close;
+
+    /* a medium staged for another drive is far from this one */
+    rc = ldm_lib_unload(&lib_hdl, "host:/drive0", "/medium0");
+    if (rc)
+        goto out_close;
+
+    rc = ldm_lib_stage(&lib_hdl, "host:/drive1", "/medium0");
+    if (rc)
+        goto out_close;
+
+    rc = dummy_load_check(&lib_hdl, "host:/drive0", "/medium0", true);
+    if (rc)
+        goto out_close;
+
+    /* a staged medium is near its drive */
+    rc = ldm_lib_stage(&lib_hdl, "host:/drive1", "/medium1");
+    if (rc)
+        goto out_close;
+
+    rc = dummy_load_check(&lib_hdl, "host:/drive1", "/medium1", false);
+
+out_close:
+    rc2 = ldm_lib_close(&lib_hdl);
+
+    return rc ? : rc2;
+}
+
 int main(int argc, char **argv)
 {
     test_env_initialize();
@@ -89,6 +162,9 @@ int main(int argc, char **argv)
     pho_run_test("test df (via fs_adapter)", test_df_1, NULL, PHO_TEST_SUCCESS);
     pho_run_test("test df (NULL path)", test_df_2, NULL, PHO_TEST_FAILURE);
 
+    pho_run_test("test dummy library staging", test_dummy_stage, NULL,
+                 PHO_TEST_SUCCESS);
+
     pho_info("ldm_common: All tests succeeded");
     exit(EXIT_SUCCESS);
 }
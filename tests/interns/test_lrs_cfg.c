@@ -288,6 +288,201 @@ static void gcwtv_invalid_numbers(void **state)
     assert_int_equal(rc, -ERANGE);
 }
 
+static void gcmcv_valid_tokens(void **state)
+{
+    unsigned int res;
+    int rc;
+
+    (void)state;
+
+    rc = setenv("PHOBOS_LRS_max_clients_per_medium", "dir=8,tape=4", 1);
+    assert_int_equal(rc, -rc);
+
+    rc = get_cfg_max_clients_value(PHO_RSC_DIR, &res);
+    ASSERT_VALID_GET_NB_REQ(rc, res, 8);
+
+    /* tapes are never shared */
+    rc = get_cfg_max_clients_value(PHO_RSC_TAPE, &res);
+    ASSERT_VALID_GET_NB_REQ(rc, res, 1);
+
+    /* a family which is not listed is not shared */
+    rc = get_cfg_max_clients_value(PHO_RSC_RADOS_POOL, &res);
+    ASSERT_VALID_GET_NB_REQ(rc, res, 1);
+}
+
+static void gcmcv_invalid_values(void **state)
+{
+    unsigned int res;
+    int rc;
+
+    (void)state;
+
+    rc = setenv("PHOBOS_LRS_max_clients_per_medium", "dir=0,rados_pool=4p",
+                1);
+    assert_int_equal(rc, -rc);
+
+    rc = get_cfg_max_clients_value(PHO_RSC_DIR, &res);
+    assert_int_equal(rc, -ERANGE);
+
+    rc = get_cfg_max_clients_value(PHO_RSC_RADOS_POOL, &res);
+    assert_int_equal(rc, -EINVAL);
+}
+
+/* the time parameters, which default to 0 for a family not listed */
+static const struct {
+    const char *env;
+    int (*get)(enum rsc_family family, struct timespec *value);
+} time_getters[] = {
+    { "PHOBOS_LRS_sync_latency_slo_ms", get_cfg_sync_latency_slo_value },
+    { "PHOBOS_LRS_sync_time_min_ms", get_cfg_sync_time_min_value },
+};
+
+static void gctime_valid_tokens(void **state)
+{
+    struct timespec res;
+    size_t i;
+    int rc;
+
+    (void)state;
+
+    for (i = 0; i < sizeof(time_getters) / sizeof(*time_getters); i++) {
+        rc = setenv(time_getters[i].env, "dir=0,tape=2500", 1);
+        assert_int_equal(rc, -rc);
+
+        rc = time_getters[i].get(PHO_RSC_TAPE, &res);
+        ASSERT_VALID_GET_TIME(rc, res, 2, 500000000);
+
+        rc = time_getters[i].get(PHO_RSC_DIR, &res);
+        ASSERT_VALID_GET_TIME(rc, res, 0, 0);
+
+        res.tv_sec = 1;
+        rc = time_getters[i].get(PHO_RSC_RADOS_POOL, &res);
+        ASSERT_VALID_GET_TIME(rc, res, 0, 0);
+    }
+}
+
+static void gctime_invalid_values(void **state)
+{
+    struct timespec res;
+    size_t i;
+    int rc;
+
+    (void)state;
+
+    for (i = 0; i < sizeof(time_getters) / sizeof(*time_getters); i++) {
+        rc = setenv(time_getters[i].env, "dir=-1,tape=60p", 1);
+        assert_int_equal(rc, -rc);
+
+        rc = time_getters[i].get(PHO_RSC_DIR, &res);
+        assert_int_equal(rc, -ERANGE);
+
+        rc = time_getters[i].get(PHO_RSC_TAPE, &res);
+        assert_int_equal(rc, -EINVAL);
+    }
+}
+
+static void gcflwv_valid_tokens(void **state)
+{
+    unsigned int watermark;
+    int rc;
+
+    (void)state;
+
+    rc = setenv("PHOBOS_LRS_format_low_watermark", "dir=0,tape=4", 1);
+    assert_int_equal(rc, -rc);
+
+    rc = get_cfg_format_low_watermark_value(PHO_RSC_TAPE, &watermark);
+    assert_return_code(rc, -rc);
+    assert_int_equal(watermark, 4);
+
+    rc = get_cfg_format_low_watermark_value(PHO_RSC_DIR, &watermark);
+    assert_return_code(rc, -rc);
+    assert_int_equal(watermark, 0);
+
+    /* a family which is not listed is not formatted in the background */
+    rc = get_cfg_format_low_watermark_value(PHO_RSC_RADOS_POOL, &watermark);
+    assert_return_code(rc, -rc);
+    assert_int_equal(watermark, 0);
+}
+
+static void gcflwv_invalid_values(void **state)
+{
+    unsigned int watermark;
+    int rc;
+
+    (void)state;
+
+    rc = setenv("PHOBOS_LRS_format_low_watermark", "dir=-1,tape=some", 1);
+    assert_int_equal(rc, -rc);
+
+    rc = get_cfg_format_low_watermark_value(PHO_RSC_DIR, &watermark);
+    assert_int_equal(rc, -ERANGE);
+
+    rc = get_cfg_format_low_watermark_value(PHO_RSC_TAPE, &watermark);
+    assert_int_equal(rc, -EINVAL);
+}
+
+/* the boolean parameters, which default to false for a family not listed */
+static const struct {
+    const char *env;
+    int (*get)(enum rsc_family family, bool *value);
+} bool_getters[] = {
+    { "PHOBOS_LRS_stage_media", get_cfg_stage_media_value },
+    { "PHOBOS_LRS_reserve_media", get_cfg_reserve_media_value },
+    { "PHOBOS_LRS_backfill", get_cfg_backfill_value },
+};
+
+static void gcbool_valid_tokens(void **state)
+{
+    bool value;
+    size_t i;
+    int rc;
+
+    (void)state;
+
+    for (i = 0; i < sizeof(bool_getters) / sizeof(*bool_getters); i++) {
+        rc = setenv(bool_getters[i].env, "dir=0,tape=1", 1);
+        assert_int_equal(rc, -rc);
+
+        rc = bool_getters[i].get(PHO_RSC_TAPE, &value);
+        assert_return_code(rc, -rc);
+        assert_true(value);
+
+        rc = bool_getters[i].get(PHO_RSC_DIR, &value);
+        assert_return_code(rc, -rc);
+        assert_false(value);
+
+        value = true;
+        rc = bool_getters[i].get(PHO_RSC_RADOS_POOL, &value);
+        assert_return_code(rc, -rc);
+        assert_false(value);
+    }
+}
+
+static void gcbool_invalid_values(void **state)
+{
+    bool value;
+    size_t i;
+    int rc;
+
+    (void)state;
+
+    for (i = 0; i < sizeof(bool_getters) / sizeof(*bool_getters); i++) {
+        rc = setenv(bool_getters[i].env, "dir=2,tape=yes,rados_pool=", 1);
+        assert_int_equal(rc, -rc);
+
+        rc = bool_getters[i].get(PHO_RSC_DIR, &value);
+        assert_int_equal(rc, -ERANGE);
+
+        rc = bool_getters[i].get(PHO_RSC_TAPE, &value);
+        assert_int_equal(rc, -EINVAL);
+
+        /* a family listed without a value is not "not configured" */
+        rc = bool_getters[i].get(PHO_RSC_RADOS_POOL, &value);
+        assert_int_equal(rc, -EINVAL);
+    }
+}
+
 int main(void)
 {
     const struct CMUnitTest get_time_threshold_test_cases[] = {
@@ -314,10 +509,35 @@ int main(void)
         cmocka_unit_test(gcwtv_invalid_numbers),
     };
 
+    const struct CMUnitTest get_max_clients_test_cases[] = {
+        cmocka_unit_test(gcmcv_valid_tokens),
+        cmocka_unit_test(gcmcv_invalid_values),
+    };
+
+    const struct CMUnitTest get_time_test_cases[] = {
+        cmocka_unit_test(gctime_valid_tokens),
+        cmocka_unit_test(gctime_invalid_values),
+    };
+
+    const struct CMUnitTest get_format_low_watermark_test_cases[] = {
+        cmocka_unit_test(gcflwv_valid_tokens),
+        cmocka_unit_test(gcflwv_invalid_values),
+    };
+
+    const struct CMUnitTest get_bool_test_cases[] = {
+        cmocka_unit_test(gcbool_valid_tokens),
+        cmocka_unit_test(gcbool_invalid_values),
+    };
+
     pho_context_init();
     atexit(pho_context_fini);
 
     return cmocka_run_group_tests(get_time_threshold_test_cases, NULL, NULL) +
         cmocka_run_group_tests(get_nb_req_threshold_test_cases, NULL, NULL) +
-        cmocka_run_group_tests(get_wsize_threshold_test_cases, NULL, NULL);
+        cmocka_run_group_tests(get_wsize_threshold_test_cases, NULL, NULL) +
+        cmocka_run_group_tests(get_max_clients_test_cases, NULL, NULL) +
+        cmocka_run_group_tests(get_time_test_cases, NULL, NULL) +
+        cmocka_run_group_tests(get_format_low_watermark_test_cases, NULL,
+                               NULL) +
+        cmocka_run_group_tests(get_bool_test_cases, NULL, NULL);
 }
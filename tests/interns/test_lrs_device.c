@@ -154,6 +154,61 @@ static void test_dev_init(void **data)
     lrs_dev_hdl_fini(&dev_handle);
 }
 
+static void test_sync_thresholds(void **data)
+{
+    struct lrs_dev_hdl handle = {
+        .sync_time_ms = { .tv_sec = 10, .tv_nsec = 0 },
+        .sync_nb_req = 100,
+        .sync_wsize_kb = 1024 * 1024 * 1024,
+        .sync_latency_slo = { .tv_sec = 2, .tv_nsec = 0 },
+    };
+    struct sync_params params = {0};
+
+    (void)data;
+
+    /* nothing measured yet: configured thresholds */
+    sync_thresholds_update(&handle, &params);
+    assert_int_equal(params.sync_time.tv_sec, 10);
+    assert_int_equal(params.sync_nb_req, 100);
+    assert_int_equal(params.sync_wsize, 1024 * 1024 * 1024);
+
+    /* the sync duration and the wait fit in the latency target */
+    params.sync_count = 1;
+    params.sync_cost_ms = 500;
+    params.release_interval_ms = 100;
+    params.release_size = 1024 * 1024;
+    sync_thresholds_update(&handle, &params);
+    assert_int_equal(params.sync_time.tv_sec, 1);
+    assert_int_equal(params.sync_time.tv_nsec, 500000000);
+    assert_int_equal(params.sync_nb_req, 16);
+    assert_int_equal(params.sync_wsize, 16 * 1024 * 1024);
+
+    /* a sync does not happen more often than it lasts */
+    params.sync_cost_ms = 3000;
+    sync_thresholds_update(&handle, &params);
+    assert_int_equal(params.sync_time.tv_sec, 3);
+    assert_int_equal(params.sync_nb_req, 31);
+
+    /* nor more often than the lower bound of the family */
+    handle.sync_time_min.tv_sec = 5;
+    sync_thresholds_update(&handle, &params);
+    assert_int_equal(params.sync_time.tv_sec, 5);
+    assert_int_equal(params.sync_nb_req, 51);
+    handle.sync_time_min.tv_sec = 0;
+
+    /* the configured thresholds are upper bounds */
+    params.release_interval_ms = 1;
+    sync_thresholds_update(&handle, &params);
+    assert_int_equal(params.sync_nb_req, 100);
+
+    /* no latency target: configured thresholds */
+    handle.sync_latency_slo.tv_sec = 0;
+    sync_thresholds_update(&handle, &params);
+    assert_int_equal(params.sync_time.tv_sec, 10);
+    assert_int_equal(params.sync_nb_req, 100);
+    assert_int_equal(params.sync_wsize, 1024 * 1024 * 1024);
+}
+
 static int remove_device(struct dss_handle *dss, char *device)
 {
     struct dev_info dev = {
@@ -342,6 +397,7 @@ int main(void)
 {
     const struct CMUnitTest lrs_device_tests[] = {
         cmocka_unit_test(test_dev_init),
+        cmocka_unit_test(test_sync_thresholds),
         cmocka_unit_test_setup_teardown(test_ldh_add_one_device,
                                         test_setup_one_device,
                                         test_teardown_one_device),
@@ -33,8 +33,12 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "pho_cfg.h"
 #include "pho_common.h"
@@ -118,7 +122,7 @@ static void dev_picker_no_device(void **data)
     bool one_device_available;
     struct lrs_dev *dev;
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_false(one_device_available);
@@ -137,7 +141,7 @@ static void dev_picker_one_available_device(void **data)
     create_device(&device, "test", LTO5_MODEL, NULL);
     gptr_array_from_list(devices, &device, 1, sizeof(device));
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -160,7 +164,7 @@ static void dev_picker_one_booked_device(void **data)
 
     device.ld_ongoing_io = true;
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_false(one_device_available);
@@ -184,7 +188,7 @@ static void dev_picker_one_booked_device_one_available(void **data)
 
     device[0].ld_ongoing_io = true;
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -192,7 +196,7 @@ static void dev_picker_one_booked_device_one_available(void **data)
     assert_string_equal(dev->ld_dev_path, "test2");
 
     dev->ld_ongoing_scheduled = true;
-    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_false(one_device_available);
@@ -216,7 +220,7 @@ static void dev_picker_search_mounted(void **data)
 
     gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -227,7 +231,7 @@ static void dev_picker_search_mounted(void **data)
 
     device[0].ld_ongoing_io = true;
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -236,7 +240,7 @@ static void dev_picker_search_mounted(void **data)
 
     device[0].ld_ongoing_io = false;
     dev->ld_ongoing_scheduled = true;
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -260,7 +264,7 @@ static void dev_picker_search_loaded(void **data)
 
     gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -271,7 +275,7 @@ static void dev_picker_search_loaded(void **data)
 
     device[0].ld_ongoing_io = true;
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -279,7 +283,7 @@ static void dev_picker_search_loaded(void **data)
 
     load_medium(&device[0], &medium);
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -287,7 +291,7 @@ static void dev_picker_search_loaded(void **data)
 
     device[0].ld_ongoing_io = false;
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL,
+    dev = dev_picker(devices, PHO_DEV_OP_ST_LOADED, NULL, PHO_QOS_NORMAL,
                      select_empty_loaded_mount, 0, &NO_TAGS, NULL, false, false,
                      &one_device_available);
     assert_true(one_device_available);
@@ -321,22 +325,25 @@ static void dev_picker_available_space(void **data)
 
     gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, select_first_fit,
-                     200, &NO_TAGS, NULL, true, false, &one_device_available);
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 200, &NO_TAGS, NULL, true, false,
+                     &one_device_available);
     assert_true(one_device_available);
     assert_null(dev);
 
     medium_set_size(&medium[0], 300);
 
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, select_first_fit,
-                     200, &NO_TAGS, NULL, true, false, &one_device_available);
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 200, &NO_TAGS, NULL, true, false,
+                     &one_device_available);
     assert_true(one_device_available);
     assert_non_null(dev);
     assert_string_equal(dev->ld_dev_path, "test1");
 
     dev->ld_ongoing_scheduled = true;
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, select_first_fit,
-                     200, &NO_TAGS, NULL, true, false, &one_device_available);
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 200, &NO_TAGS, NULL, true, false,
+                     &one_device_available);
     assert_true(one_device_available);
     assert_null(dev);
 
@@ -366,15 +373,17 @@ static void dev_picker_flags(void **data)
 
     device[0].ld_ongoing_io = true;
     device[1].ld_dss_media_info->flags.put = false;
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, select_first_fit,
-                     0, &NO_TAGS, NULL, true, false, &one_device_available);
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 0, &NO_TAGS, NULL, true, false,
+                     &one_device_available);
     assert_true(one_device_available);
     assert_null(dev);
 
     device[1].ld_dss_media_info->flags.put = true;
     device[1].ld_dss_media_info->fs.status = PHO_FS_STATUS_FULL;
-    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, select_first_fit,
-                     0, &NO_TAGS, NULL, true, false, &one_device_available);
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 0, &NO_TAGS, NULL, true, false,
+                     &one_device_available);
     assert_true(one_device_available);
     assert_null(dev);
 
@@ -383,6 +392,692 @@ static void dev_picker_flags(void **data)
     cleanup_device(&device[1]);
 }
 
+static void medium_add_grouping(struct media_info *medium, const char *grouping)
+{
+    size_t n = medium->groupings.n_tags;
+
+    medium->groupings.tags = xrealloc(medium->groupings.tags,
+                                      (n + 1) * sizeof(char *));
+    medium->groupings.tags[n] = xstrdup(grouping);
+    medium->groupings.n_tags = n + 1;
+}
+
+static void dev_picker_grouping(void **data)
+{
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium[2];
+    struct lrs_dev device[2];
+    struct lrs_dev *dev;
+
+    create_device(&device[0], "test1", LTO5_MODEL, NULL);
+    create_device(&device[1], "test2", LTO5_MODEL, NULL);
+
+    create_medium(&medium[0], "test1");
+    create_medium(&medium[1], "test2");
+
+    mount_medium(&device[0], &medium[0]);
+    mount_medium(&device[1], &medium[1]);
+
+    medium_set_size(&medium[0], 100);
+    medium_set_size(&medium[1], 100);
+
+    gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
+
+    /* no medium holds the grouping yet */
+    dev = grouping_dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                              PHO_QOS_NORMAL, "campaign", select_first_fit, 50,
+                              &NO_TAGS, false);
+    assert_null(dev);
+
+    medium_add_grouping(&medium[1], "campaign");
+    dev = grouping_dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                              PHO_QOS_NORMAL, "campaign", select_first_fit, 50,
+                              &NO_TAGS, false);
+    assert_non_null(dev);
+    assert_string_equal(dev->ld_dev_path, "test2");
+
+    /* not enough room left on the medium of the grouping */
+    dev = grouping_dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                              PHO_QOS_NORMAL, "campaign", select_first_fit, 200,
+                              &NO_TAGS, false);
+    assert_null(dev);
+
+    /* no grouping requested */
+    dev = grouping_dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                              PHO_QOS_NORMAL, NULL, select_first_fit, 50,
+                              &NO_TAGS, false);
+    assert_null(dev);
+
+    tags_free(&medium[1].groupings);
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device[0]);
+    cleanup_device(&device[1]);
+}
+
+static void dev_picker_shared_medium(void **data)
+{
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium;
+    struct lrs_dev device;
+    struct lrs_dev *dev;
+
+    create_device(&device, "test", LTO5_MODEL, NULL);
+    create_medium(&medium, "test");
+    mount_medium(&device, &medium);
+    medium_set_size(&medium, 100);
+
+    gptr_array_from_list(devices, &device, 1, sizeof(device));
+
+    /* one client writes on a medium which cannot be shared */
+    device.ld_ongoing_io = 1;
+    device.ld_max_clients = 1;
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 50, &NO_TAGS, NULL, true, false, NULL);
+    assert_null(dev);
+
+    /* a second writer shares the medium */
+    device.ld_max_clients = 2;
+    device.ld_reserved_size = 40;
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 50, &NO_TAGS, NULL, true, false, NULL);
+    assert_ptr_equal(dev, &device);
+
+    /* the space reserved by the first writer is not available */
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 70, &NO_TAGS, NULL, true, false, NULL);
+    assert_null(dev);
+
+    /* a busy device is never picked to load another medium */
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
+                     select_empty_loaded_mount, 0, &NO_TAGS, &medium, false,
+                     false, NULL);
+    assert_null(dev);
+
+    /* no more clients than configured */
+    device.ld_ongoing_io = 2;
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_NORMAL,
+                     select_first_fit, 50, &NO_TAGS, NULL, true, false, NULL);
+    assert_null(dev);
+
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device);
+}
+
+static void dev_picker_qos_reservation(void **data)
+{
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium[2];
+    struct lrs_dev device[2];
+    struct lrs_dev *dev;
+
+    create_device(&device[0], "test1", LTO5_MODEL, NULL);
+    create_device(&device[1], "test2", LTO5_MODEL, NULL);
+
+    create_medium(&medium[0], "test1");
+    create_medium(&medium[1], "test2");
+
+    mount_medium(&device[0], &medium[0]);
+    mount_medium(&device[1], &medium[1]);
+
+    medium_set_size(&medium[0], 100);
+    medium_set_size(&medium[1], 100);
+
+    gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
+
+    device[0].ld_qos_reserved = true;
+    device[0].ld_qos_class = PHO_QOS_INTERACTIVE;
+
+    /* the reserved device is skipped for the other classes */
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_BULK,
+                     select_first_fit, 50, &NO_TAGS, NULL, true, false, NULL);
+    assert_ptr_equal(dev, &device[1]);
+
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                     PHO_QOS_INTERACTIVE, select_first_fit, 50, &NO_TAGS,
+                     NULL, true, false, NULL);
+    assert_ptr_equal(dev, &device[0]);
+
+    device[1].ld_ongoing_scheduled = true;
+    dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL, PHO_QOS_BULK,
+                     select_first_fit, 50, &NO_TAGS, NULL, true, false, NULL);
+    assert_null(dev);
+
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device[0]);
+    cleanup_device(&device[1]);
+}
+
+static void dev_picker_earliest_completion(void **data)
+{
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium;
+    struct lrs_dev device[2];
+    struct lrs_dev *dev;
+
+    create_device(&device[0], "test1", LTO5_MODEL, NULL);
+    create_device(&device[1], "test2", LTO5_MODEL, NULL);
+
+    create_medium(&medium, "test1");
+    mount_medium(&device[0], &medium);
+
+    gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
+
+    /* nothing learnt yet: the empty device goes first */
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
+                     select_earliest_completion, 0, &NO_TAGS, NULL, false,
+                     false, NULL);
+    assert_ptr_equal(dev, &device[1]);
+
+    /* the empty device is slow to load a medium */
+    perf_model_add_op(&device[1].ld_perf, PERF_OP_LOAD, 120000);
+    perf_model_add_op(&device[1].ld_perf, PERF_OP_MOUNT, 30000);
+    perf_model_add_op(&device[0].ld_perf, PERF_OP_UMOUNT, 20000);
+    perf_model_add_op(&device[0].ld_perf, PERF_OP_UNLOAD, 10000);
+    perf_model_add_op(&device[0].ld_perf, PERF_OP_LOAD, 10000);
+    perf_model_add_op(&device[0].ld_perf, PERF_OP_MOUNT, 10000);
+    assert_int_equal(dev_switch_ms(&device[0]), 50000);
+    assert_int_equal(dev_switch_ms(&device[1]), 150000);
+
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
+                     select_earliest_completion, 0, &NO_TAGS, NULL, false,
+                     false, NULL);
+    assert_ptr_equal(dev, &device[0]);
+
+    /* the averages follow the new measurements */
+    perf_model_add_op(&device[1].ld_perf, PERF_OP_LOAD, 10000);
+    perf_model_add_op(&device[1].ld_perf, PERF_OP_LOAD, 10000);
+    perf_model_add_op(&device[1].ld_perf, PERF_OP_LOAD, 10000);
+    assert_true(perf_model_op_ms(&device[1].ld_perf, PERF_OP_LOAD) < 60000);
+    perf_model_add_op(&device[0].ld_perf, PERF_OP_UMOUNT, 200000);
+    assert_true(dev_switch_ms(&device[0]) > dev_switch_ms(&device[1]));
+
+    dev = dev_picker(devices, PHO_DEV_OP_ST_UNSPEC, NULL, PHO_QOS_NORMAL,
+                     select_earliest_completion, 0, &NO_TAGS, NULL, false,
+                     false, NULL);
+    assert_ptr_equal(dev, &device[1]);
+
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device[0]);
+    cleanup_device(&device[1]);
+}
+
+static void dev_picker_backfill(void **data)
+{
+    struct lrs_dev_hdl handle = { .backfill = true };
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium;
+    struct lrs_dev device;
+    struct lrs_dev *dev;
+
+    create_device(&device, "test", LTO5_MODEL, NULL);
+    create_medium(&medium, "test");
+    mount_medium(&device, &medium);
+    medium_set_size(&medium, 1000000000);
+
+    gptr_array_from_list(devices, &device, 1, sizeof(device));
+
+    /* the client of a multi-medium allocation holds the medium, which cannot
+     * be shared, and the clients transfer 1000 bytes per ms
+     */
+    device.ld_handle = &handle;
+    device.ld_ongoing_io = 1;
+    device.ld_max_clients = 1;
+    perf_model_add_transfer(&device.ld_perf, 1000000, 1000);
+
+    /* the allocation does not wait for another medium */
+    assert_true(dev_backfill_ms(&device, 1000000) == 0);
+    dev = backfill_dev_picker(devices, NULL, PHO_QOS_NORMAL, 1000000,
+                              &NO_TAGS, false);
+    assert_null(dev);
+
+    /* the other medium is expected to be mounted in 10s */
+    clock_gettime(CLOCK_REALTIME, &device.ld_backfill.until);
+    device.ld_backfill.until.tv_sec += 10;
+
+    /* a short write ends before */
+    assert_int_equal(dev_backfill_ms(&device, 1000000), 1000);
+    dev = backfill_dev_picker(devices, NULL, PHO_QOS_NORMAL, 1000000,
+                              &NO_TAGS, false);
+    assert_ptr_equal(dev, &device);
+
+    /* a long one would delay the allocation */
+    assert_true(dev_backfill_ms(&device, 100000000) == 0);
+    dev = backfill_dev_picker(devices, NULL, PHO_QOS_NORMAL, 100000000,
+                              &NO_TAGS, false);
+    assert_null(dev);
+
+    /* one request is backfilled at a time */
+    device.ld_ongoing_io = 2;
+    assert_true(dev_backfill_ms(&device, 1000000) == 0);
+
+    /* the family does not backfill its devices */
+    device.ld_ongoing_io = 1;
+    handle.backfill = false;
+    assert_true(dev_backfill_ms(&device, 1000000) == 0);
+
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device);
+}
+
+/* the source medium of a copy is read by the device holding it */
+static void sched_source_alloc(void **data)
+{
+    struct lrs_dev *alloc_devices[2] = {NULL, NULL};
+    struct resp_container respc = {0};
+    struct req_container reqc = {0};
+    struct lrs_sched sched = {0};
+    struct media_info source;
+    struct lrs_dev device;
+    size_t n_tags = 0;
+    int rc;
+
+    create_medium(&source, "source");
+    create_device(&device, "test", LTO5_MODEL, NULL);
+    load_medium(&device, &source);
+
+    sched.devices.ldh_devices = g_ptr_array_new();
+    g_ptr_array_add(sched.devices.ldh_devices, &device);
+    sched.lock_handle.lock_hostname = get_hostname();
+    sched.lock_handle.lock_owner = getpid();
+
+    /* the source is already locked by this LRS */
+    source.lock.hostname = (char *) get_hostname();
+    source.lock.owner = getpid();
+
+    /* a copy: one medium to write, then one source to read */
+    reqc.req = xcalloc(1, sizeof(*reqc.req));
+    pho_srl_request_write_alloc(reqc.req, 1, &n_tags);
+    pho_srl_request_write_alloc_sources(reqc.req, 1);
+    reqc.req->walloc->sources[0]->family = PHO_RSC_TAPE;
+    reqc.req->walloc->sources[0]->name = xstrdup("source");
+    reqc.req->walloc->sources[0]->library = xstrdup("legacy");
+    reqc.params.rwalloc.n_media = 2;
+    reqc.params.rwalloc.media = xcalloc(2, sizeof(*reqc.params.rwalloc.media));
+    reqc.params.rwalloc.media[1].alloc_medium = &source;
+    reqc.params.rwalloc.respc = &respc;
+    respc.devices = alloc_devices;
+    respc.devices_len = 2;
+
+    /* the device holding the source is busy, wait for it */
+    device.ld_ongoing_io = 1;
+    rc = sched_source_alloc_one_medium(&sched, &reqc, 1);
+    assert_int_equal(rc, -EAGAIN);
+    assert_null(alloc_devices[1]);
+    assert_ptr_equal(reqc.params.rwalloc.media[1].alloc_medium, &source);
+
+    /* once idle, it reads the source */
+    device.ld_ongoing_io = 0;
+    rc = sched_source_alloc_one_medium(&sched, &reqc, 1);
+    assert_return_code(rc, -rc);
+    assert_ptr_equal(alloc_devices[1], &device);
+    assert_true(device.ld_ongoing_scheduled);
+
+    free(reqc.params.rwalloc.media);
+    pho_srl_request_free(reqc.req, false);
+    free(reqc.req);
+    g_ptr_array_free(sched.devices.ldh_devices, true);
+    cleanup_device(&device);
+}
+
+/* end the background format of \p medium, its medium still being blank */
+static void auto_format_fail(struct auto_format *auto_format,
+                             const char *medium, struct timespec *end)
+{
+    struct req_container reqc = {0};
+
+    reqc.req = xcalloc(1, sizeof(*reqc.req));
+    pho_srl_request_format_alloc(reqc.req);
+    reqc.req->format->med_id->family = PHO_RSC_TAPE;
+    reqc.req->format->med_id->name = xstrdup(medium);
+    reqc.req->format->med_id->library = xstrdup("legacy");
+    reqc.params.format.auto_format = auto_format;
+
+    clock_gettime(CLOCK_REALTIME, end);
+    auto_format_end(&reqc);
+
+    pho_srl_request_free(reqc.req, false);
+    free(reqc.req);
+}
+
+/* whether the background format of \p medium is due \p delay s after \p end */
+static bool auto_format_due(struct auto_format *auto_format,
+                            const struct pho_id *medium,
+                            const struct timespec *end, time_t delay)
+{
+    struct timespec date = *end;
+
+    date.tv_sec += delay;
+
+    return auto_format_retry_due(auto_format, medium, &date);
+}
+
+/* a medium whose background format failed is retried less and less often */
+static void auto_format_backoff(void **data)
+{
+    struct auto_format auto_format;
+    struct pho_id blank;
+    struct pho_id other;
+    struct timespec end;
+    int rc;
+    int i;
+
+    (void) data;
+
+    rc = auto_format_init(&auto_format, PHO_RSC_TAPE);
+    assert_return_code(rc, -rc);
+
+    blank.family = PHO_RSC_TAPE;
+    pho_id_name_set(&blank, "blank", "legacy");
+    other.family = PHO_RSC_TAPE;
+    pho_id_name_set(&other, "other", "legacy");
+
+    /* never formatted */
+    clock_gettime(CLOCK_REALTIME, &end);
+    assert_true(auto_format_due(&auto_format, &blank, &end, 0));
+
+    /* not retried before the next check, then after twice as long */
+    auto_format_fail(&auto_format, "blank", &end);
+    assert_false(auto_format_due(&auto_format, &blank, &end, 0));
+    assert_false(auto_format_due(&auto_format, &blank, &end, 59));
+    assert_true(auto_format_due(&auto_format, &blank, &end, 61));
+
+    auto_format_fail(&auto_format, "blank", &end);
+    assert_false(auto_format_due(&auto_format, &blank, &end, 119));
+    assert_true(auto_format_due(&auto_format, &blank, &end, 121));
+
+    /* the other media are not delayed */
+    assert_true(auto_format_due(&auto_format, &other, &end, 0));
+
+    /* the delay does not exceed a day */
+    for (i = 0; i < 64; i++)
+        auto_format_fail(&auto_format, "blank", &end);
+    assert_false(auto_format_due(&auto_format, &blank, &end, 24 * 3600 - 1));
+    assert_true(auto_format_due(&auto_format, &blank, &end, 24 * 3600 + 1));
+
+    auto_format_clean(&auto_format);
+}
+
+#define RECALL_DRIVES    4
+#define RECALL_GROUPINGS 4
+#define RECALL_BATCHES   32
+
+/**
+ * Write RECALL_BATCHES batches of concurrent writes, one object of each
+ * grouping per batch in a random order, on as many mounted drives, and return
+ * the number of mounts needed to recall each grouping afterwards.
+ */
+static int grouping_recall_mounts(bool collocate)
+{
+    bool used[RECALL_GROUPINGS][RECALL_DRIVES] = {{false}};
+    char names[RECALL_DRIVES][16];
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium[RECALL_DRIVES];
+    struct lrs_dev device[RECALL_DRIVES];
+    unsigned int seed = 42;
+    int mounts = 0;
+    int batch;
+    int i;
+
+    for (i = 0; i < RECALL_DRIVES; i++) {
+        snprintf(names[i], sizeof(names[i]), "recall%d", i);
+        create_device(&device[i], names[i], LTO5_MODEL, NULL);
+        create_medium(&medium[i], names[i]);
+        mount_medium(&device[i], &medium[i]);
+        medium_set_size(&medium[i], 1LL << 40);
+    }
+
+    gptr_array_from_list(devices, &device, RECALL_DRIVES, sizeof(device[0]));
+
+    for (batch = 0; batch < RECALL_BATCHES; batch++) {
+        int order[RECALL_GROUPINGS];
+
+        /* the writes of a batch reach the LRS in any order */
+        for (i = 0; i < RECALL_GROUPINGS; i++)
+            order[i] = i;
+        for (i = RECALL_GROUPINGS - 1; i > 0; i--) {
+            int j = rand_r(&seed) % (i + 1);
+            int tmp = order[i];
+
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+
+        for (i = 0; i < RECALL_GROUPINGS; i++) {
+            char grouping[16];
+            struct lrs_dev *dev = NULL;
+            int m;
+
+            snprintf(grouping, sizeof(grouping), "grouping%d", order[i]);
+            if (collocate)
+                dev = grouping_dev_picker(devices, PHO_DEV_OP_ST_MOUNTED,
+                                          NULL, PHO_QOS_NORMAL, grouping,
+                                          select_first_fit, 1, &NO_TAGS,
+                                          false);
+            if (!dev)
+                dev = dev_picker(devices, PHO_DEV_OP_ST_MOUNTED, NULL,
+                                 PHO_QOS_NORMAL, select_first_fit, 1, &NO_TAGS,
+                                 NULL, true, false, NULL);
+            assert_non_null(dev);
+
+            /* the drive is busy until the end of the batch */
+            dev->ld_ongoing_scheduled = true;
+            m = dev - device;
+            used[order[i]][m] = true;
+            if (collocate && !tag_exists(&medium[m].groupings, grouping))
+                medium_add_grouping(&medium[m], grouping);
+        }
+
+        for (i = 0; i < RECALL_DRIVES; i++)
+            device[i].ld_ongoing_scheduled = false;
+    }
+
+    for (i = 0; i < RECALL_GROUPINGS; i++) {
+        int m;
+
+        for (m = 0; m < RECALL_DRIVES; m++)
+            mounts += used[i][m];
+    }
+
+    g_ptr_array_free(devices, true);
+    for (i = 0; i < RECALL_DRIVES; i++) {
+        tags_free(&medium[i].groupings);
+        cleanup_device(&device[i]);
+    }
+
+    return mounts;
+}
+
+/**
+ * A grouping collocated on one medium is recalled with a single mount, while
+ * the device selection policy alone scatters it.
+ */
+static void grouping_recall_collocation(void **data)
+{
+    int scattered = grouping_recall_mounts(false);
+    int collocated = grouping_recall_mounts(true);
+
+    assert_int_equal(collocated, RECALL_GROUPINGS);
+    assert_true(scattered > collocated);
+}
+
+#define REPLAY_MEDIA       64
+#define REPLAY_DRIVES      4
+#define REPLAY_REQUESTS    4000
+#define REPLAY_MOUNT_S     90.
+#define REPLAY_MIB_PER_S   300.
+
+struct replay_request {
+    double arrival_s;
+    int    medium;
+    size_t size;
+    double done_s;
+};
+
+/**
+ * Generate a read trace of REPLAY_REQUESTS requests, with a few popular media.
+ */
+static struct replay_request *replay_trace(void)
+{
+    struct replay_request *trace;
+    unsigned int seed = 42;
+    double arrival_s = 0.;
+    size_t i;
+
+    trace = xcalloc(REPLAY_REQUESTS, sizeof(*trace));
+    for (i = 0; i < REPLAY_REQUESTS; i++) {
+        struct replay_request *req = &trace[i];
+
+        arrival_s += rand_r(&seed) % 6;
+        req->arrival_s = arrival_s;
+        /* half the requests target an eighth of the media */
+        if (rand_r(&seed) % 2)
+            req->medium = rand_r(&seed) % (REPLAY_MEDIA / 8);
+        else
+            req->medium = rand_r(&seed) % REPLAY_MEDIA;
+        req->size = (1 + rand_r(&seed) % 256) * (1024 * 1024ULL);
+    }
+
+    return trace;
+}
+
+/* Medium of the oldest pending request (first), or of the pending requests with
+ * the best grouped_read_queue_score (cost), which is not in another drive.
+ */
+static int replay_pick_medium(struct replay_request *trace, size_t count,
+                              const struct grouped_read_cost *cost,
+                              const int *drive_medium, int drive, double now)
+{
+    size_t n_requests[REPLAY_MEDIA] = {0};
+    size_t bytes[REPLAY_MEDIA] = {0};
+    double oldest[REPLAY_MEDIA];
+    double best_score = -1.;
+    int best = -1;
+    size_t i;
+    int m;
+
+    for (i = 0; i < count && trace[i].arrival_s <= now; i++) {
+        bool busy = false;
+        int d;
+
+        if (trace[i].done_s >= 0.)
+            continue;
+
+        m = trace[i].medium;
+        for (d = 0; d < REPLAY_DRIVES; d++)
+            if (d != drive && drive_medium[d] == m)
+                busy = true;
+        if (busy)
+            continue;
+
+        /* the trace is sorted by arrival */
+        if (!cost)
+            return m;
+
+        if (!n_requests[m])
+            oldest[m] = trace[i].arrival_s;
+        n_requests[m]++;
+        bytes[m] += trace[i].size;
+    }
+
+    for (m = 0; m < REPLAY_MEDIA; m++) {
+        double score;
+
+        if (!n_requests[m])
+            continue;
+
+        score = grouped_read_queue_score(cost, n_requests[m], bytes[m],
+                                         now - oldest[m],
+                                         drive_medium[drive] == m);
+        if (score > best_score) {
+            best_score = score;
+            best = m;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Replay the trace on REPLAY_DRIVES drives and return the mean latency of its
+ * requests. Each time a drive is free, it mounts the medium chosen by the
+ * policy, unless already loaded, and reads all the requests pending on it.
+ */
+static double replay(struct replay_request *trace, size_t count,
+                     const struct grouped_read_cost *cost)
+{
+    int drive_medium[REPLAY_DRIVES];
+    double drive_free[REPLAY_DRIVES];
+    double mean_latency_s = 0.;
+    size_t served = 0;
+    size_t i;
+    int d;
+
+    for (i = 0; i < count; i++)
+        trace[i].done_s = -1.;
+    for (d = 0; d < REPLAY_DRIVES; d++) {
+        drive_medium[d] = -1;
+        drive_free[d] = 0.;
+    }
+
+    while (served < count) {
+        double now;
+        int m;
+
+        d = 0;
+        for (i = 1; i < REPLAY_DRIVES; i++)
+            if (drive_free[i] < drive_free[d])
+                d = i;
+        now = drive_free[d];
+
+        m = replay_pick_medium(trace, count, cost, drive_medium, d, now);
+        if (m < 0) {
+            /* idle until the next request arrives */
+            for (i = 0; i < count && trace[i].arrival_s <= now; i++)
+                ;
+            drive_free[d] = i < count ? trace[i].arrival_s : now + 1.;
+            continue;
+        }
+
+        if (drive_medium[d] != m) {
+            drive_medium[d] = m;
+            now += REPLAY_MOUNT_S;
+        }
+
+        for (i = 0; i < count && trace[i].arrival_s <= now; i++) {
+            if (trace[i].medium != m || trace[i].done_s >= 0.)
+                continue;
+
+            now += trace[i].size / (REPLAY_MIB_PER_S * 1024 * 1024);
+            trace[i].done_s = now;
+            served++;
+        }
+        drive_free[d] = now;
+    }
+
+    for (i = 0; i < count; i++)
+        mean_latency_s += (trace[i].done_s - trace[i].arrival_s) / count;
+
+    return mean_latency_s;
+}
+
+/**
+ * On a trace with a few popular media, the "cost" policy of grouped_read
+ * serves the reads sooner than the "first" one.
+ */
+static void grouped_read_cost_replay(void **data)
+{
+    struct grouped_read_cost cost = {
+        .mount_cost_s = REPLAY_MOUNT_S,
+        .deadline_s = 3600.,
+    };
+    struct replay_request *trace = replay_trace();
+    double first = replay(trace, REPLAY_REQUESTS, NULL);
+    double by_cost = replay(trace, REPLAY_REQUESTS, &cost);
+
+    assert_true(by_cost <= first);
+    free(trace);
+}
+
 int tape_drive_compat_models(const char *tape_model, const char *drive_model,
                              bool *res)
 {
@@ -1561,6 +2256,120 @@ static char *make_name(size_t i)
     return name;
 }
 
+#define QOS_NB_REQUESTS 9
+
+static void io_sched_qos_weighted_share(void **data)
+{
+    struct io_sched_handle *io_sched = (struct io_sched_handle *) *data;
+    struct req_container interactive[QOS_NB_REQUESTS];
+    struct req_container bulk[QOS_NB_REQUESTS];
+    int nb_interactive = 0;
+    int nb_bulk = 0;
+    int rc;
+    int i;
+
+    memset(interactive, 0, sizeof(interactive));
+    memset(bulk, 0, sizeof(bulk));
+
+    /* bulk requests first, they must not delay the interactive ones */
+    for (i = 0; i < QOS_NB_REQUESTS; i++) {
+        create_request(&bulk[i], NULL, 1, 1, io_sched->lock_handle);
+        bulk[i].req->has_qos = true;
+        bulk[i].req->qos = PHO_QOS_BULK;
+        rc = io_sched_push_request(io_sched, &bulk[i]);
+        assert_return_code(rc, -rc);
+    }
+
+    for (i = 0; i < QOS_NB_REQUESTS; i++) {
+        create_request(&interactive[i], NULL, 1, 1, io_sched->lock_handle);
+        interactive[i].req->has_qos = true;
+        interactive[i].req->qos = PHO_QOS_INTERACTIVE;
+        rc = io_sched_push_request(io_sched, &interactive[i]);
+        assert_return_code(rc, -rc);
+    }
+
+    assert_int_equal(io_sched->qos.stats[PHO_QOS_BULK].queued,
+                     QOS_NB_REQUESTS);
+    assert_int_equal(io_sched->qos.stats[PHO_QOS_INTERACTIVE].queued,
+                     QOS_NB_REQUESTS);
+
+    /* with weights 8 and 1, 8 of the first 9 requests are interactive */
+    for (i = 0; i < QOS_NB_REQUESTS; i++) {
+        struct req_container *reqc;
+
+        rc = io_sched_peek_request(io_sched, &reqc);
+        assert_return_code(rc, -rc);
+        assert_non_null(reqc);
+
+        if (pho_request_qos(reqc->req) == PHO_QOS_INTERACTIVE)
+            assert_ptr_equal(reqc, &interactive[nb_interactive++]);
+        else
+            assert_ptr_equal(reqc, &bulk[nb_bulk++]);
+
+        rc = io_sched_remove_request(io_sched, reqc);
+        assert_return_code(rc, -rc);
+    }
+
+    assert_int_equal(nb_interactive, 8);
+    assert_int_equal(nb_bulk, 1);
+    assert_int_equal(io_sched->qos.stats[PHO_QOS_INTERACTIVE].scheduled, 8);
+
+    for (i = 0; i < QOS_NB_REQUESTS; i++) {
+        struct req_container *reqc;
+
+        rc = io_sched_peek_request(io_sched, &reqc);
+        assert_return_code(rc, -rc);
+        rc = io_sched_remove_request(io_sched, reqc);
+        assert_return_code(rc, -rc);
+    }
+
+    for (i = 0; i < QOS_NB_REQUESTS; i++) {
+        destroy_request(&interactive[i]);
+        destroy_request(&bulk[i]);
+    }
+}
+
+static void io_sched_qos_reserve_devices(void **data)
+{
+    struct io_sched_handle *io_sched = (struct io_sched_handle *) *data;
+    GPtrArray *devices = g_ptr_array_new();
+    struct lrs_dev *reserved;
+    struct lrs_dev device[2];
+    int rc;
+
+    create_device(&device[0], "D1", LTO5_MODEL, NULL);
+    create_device(&device[1], "D2", LTO5_MODEL, NULL);
+    io_sched->qos.reserved_devices[PHO_QOS_INTERACTIVE] = 2;
+
+    /* a single device is never reserved */
+    gptr_array_from_list(devices, &device, 1, sizeof(device[0]));
+    rc = io_sched_dispatch_devices(io_sched, devices);
+    assert_return_code(rc, -rc);
+    assert_false(device[0].ld_qos_reserved);
+
+    /* one device is left to the other classes */
+    g_ptr_array_add(devices, &device[1]);
+    rc = io_sched_dispatch_devices(io_sched, devices);
+    assert_return_code(rc, -rc);
+    assert_int_equal(device[0].ld_qos_reserved + device[1].ld_qos_reserved,
+                     1);
+
+    /* the reservation of a device which is no longer online is dropped */
+    reserved = device[0].ld_qos_reserved ? &device[0] : &device[1];
+    reserved->ld_dss_dev_info->rsc.adm_status = PHO_RSC_ADM_ST_LOCKED;
+    rc = io_sched_dispatch_devices(io_sched, devices);
+    assert_return_code(rc, -rc);
+    assert_false(device[0].ld_qos_reserved);
+    assert_false(device[1].ld_qos_reserved);
+
+    io_sched->qos.reserved_devices[PHO_QOS_INTERACTIVE] = 0;
+    io_sched_remove_device(io_sched, &device[0]);
+    io_sched_remove_device(io_sched, &device[1]);
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device[0]);
+    cleanup_device(&device[1]);
+}
+
 static void test_lrs_dev_techno(void **data)
 {
     struct lrs_dev dev;
@@ -2197,6 +3006,15 @@ int main(void)
         cmocka_unit_test(dev_picker_search_loaded),
         cmocka_unit_test(dev_picker_available_space),
         cmocka_unit_test(dev_picker_flags),
+        cmocka_unit_test(dev_picker_grouping),
+        cmocka_unit_test(dev_picker_shared_medium),
+        cmocka_unit_test(dev_picker_qos_reservation),
+        cmocka_unit_test(dev_picker_earliest_completion),
+        cmocka_unit_test(dev_picker_backfill),
+        cmocka_unit_test(sched_source_alloc),
+        cmocka_unit_test(auto_format_backoff),
+        cmocka_unit_test(grouping_recall_collocation),
+        cmocka_unit_test(grouped_read_cost_replay),
     };
     const struct CMUnitTest test_io_sched_api[] = {
         cmocka_unit_test(io_sched_add_device_twice),
@@ -2217,6 +3035,10 @@ int main(void)
          */
         /* TODO failure on device: set status to failed */
     };
+    const struct CMUnitTest test_io_sched_qos[] = {
+        cmocka_unit_test(io_sched_qos_weighted_share),
+        cmocka_unit_test(io_sched_qos_reserve_devices),
+    };
     const struct CMUnitTest test_fair_share[] = {
         cmocka_unit_test(test_lrs_dev_techno),
         cmocka_unit_test(fair_share_repartition),
@@ -2261,6 +3083,11 @@ int main(void)
                                           io_sched_setup,
                                           io_sched_teardown);
 
+    pho_info("Starting QoS test for WRITE requests");
+    error_count += cmocka_run_group_tests(test_io_sched_qos,
+                                          io_sched_setup,
+                                          io_sched_teardown);
+
     IO_REQ_TYPE = IO_REQ_READ;
     pho_info("Starting I/O scheduler test for READ requests");
     error_count += cmocka_run_group_tests(test_io_sched_api,
@@ -0,0 +1,197 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the serialization of the LRS protocol
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "pho_common.h"
+#include "pho_srl_lrs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+static void set_rsc_id(pho_rsc_id_t *id, const char *name)
+{
+    id->family = PHO_RSC_TAPE;
+    id->name = xstrdup(name);
+    id->library = xstrdup("legacy");
+}
+
+static void check_rsc_id(const pho_rsc_id_t *id, const char *name)
+{
+    assert_int_equal(id->family, PHO_RSC_TAPE);
+    assert_string_equal(id->name, name);
+    assert_string_equal(id->library, "legacy");
+}
+
+/* a write allocation carries the media to read and the ones to avoid */
+static void srl_request_write_sources(void **state)
+{
+    size_t n_tags = 0;
+    struct pho_buff buf;
+    pho_req_t *unpacked;
+    pho_req_t req;
+
+    (void) state;
+
+    pho_srl_request_write_alloc(&req, 1, &n_tags);
+    pho_srl_request_write_alloc_sources(&req, 2);
+    pho_srl_request_write_alloc_excluded(&req, 1);
+    req.id = 2;
+    req.walloc->family = PHO_RSC_TAPE;
+    req.walloc->media[0]->size = 4096;
+    set_rsc_id(req.walloc->sources[0], "source_0");
+    set_rsc_id(req.walloc->sources[1], "source_1");
+    set_rsc_id(req.walloc->excluded[0], "excluded_0");
+
+    pho_srl_request_pack(&req, &buf);
+    pho_srl_request_free(&req, false);
+
+    unpacked = pho_srl_request_unpack(&buf);
+    assert_non_null(unpacked);
+    assert_true(pho_request_is_write(unpacked));
+    assert_int_equal(unpacked->id, 2);
+    assert_int_equal(unpacked->walloc->n_media, 1);
+    assert_int_equal(unpacked->walloc->media[0]->size, 4096);
+    assert_int_equal(unpacked->walloc->n_sources, 2);
+    check_rsc_id(unpacked->walloc->sources[0], "source_0");
+    check_rsc_id(unpacked->walloc->sources[1], "source_1");
+    assert_int_equal(unpacked->walloc->n_excluded, 1);
+    check_rsc_id(unpacked->walloc->excluded[0], "excluded_0");
+
+    pho_srl_request_free(unpacked, true);
+}
+
+/* the response gives the mounted source media along with the target */
+static void srl_response_write_sources(void **state)
+{
+    pho_resp_write_elt_t *target;
+    pho_resp_read_elt_t *source;
+    pho_resp_t *unpacked;
+    struct pho_buff buf;
+    pho_resp_t resp;
+    int i;
+
+    (void) state;
+
+    pho_srl_response_write_alloc(&resp, 1);
+    pho_srl_response_write_alloc_sources(&resp, 2);
+    resp.req_id = 2;
+
+    target = resp.walloc->media[0];
+    set_rsc_id(target->med_id, "target");
+    target->avail_size = 8192;
+    target->root_path = xstrdup("/mnt/target");
+    target->fs_type = PHO_FS_LTFS;
+    target->addr_type = PHO_ADDR_HASH1;
+
+    for (i = 0; i < 2; i++) {
+        source = resp.walloc->sources[i];
+        set_rsc_id(source->med_id, i == 0 ? "source_0" : "source_1");
+        source->root_path = xstrdup(i == 0 ? "/mnt/src0" : "/mnt/src1");
+        source->fs_type = PHO_FS_LTFS;
+        source->addr_type = PHO_ADDR_PATH;
+    }
+
+    pho_srl_response_pack(&resp, &buf);
+    pho_srl_response_free(&resp, false);
+
+    unpacked = pho_srl_response_unpack(&buf);
+    assert_non_null(unpacked);
+    assert_true(pho_response_is_write(unpacked));
+    assert_int_equal(unpacked->req_id, 2);
+
+    target = unpacked->walloc->media[0];
+    check_rsc_id(target->med_id, "target");
+    assert_int_equal(target->avail_size, 8192);
+    assert_string_equal(target->root_path, "/mnt/target");
+    assert_int_equal(target->addr_type, PHO_ADDR_HASH1);
+
+    assert_int_equal(unpacked->walloc->n_sources, 2);
+    source = unpacked->walloc->sources[0];
+    check_rsc_id(source->med_id, "source_0");
+    assert_string_equal(source->root_path, "/mnt/src0");
+    source = unpacked->walloc->sources[1];
+    check_rsc_id(source->med_id, "source_1");
+    assert_string_equal(source->root_path, "/mnt/src1");
+    assert_int_equal(source->fs_type, PHO_FS_LTFS);
+    assert_int_equal(source->addr_type, PHO_ADDR_PATH);
+
+    pho_srl_response_free(unpacked, true);
+}
+
+/* the QoS class of a request is the one set by the client once unpacked */
+static void srl_request_qos(void **state)
+{
+    enum pho_qos_class qos;
+
+    (void) state;
+
+    for (qos = PHO_QOS_UNSET; qos < PHO_QOS_LAST; qos++) {
+        struct pho_buff buf;
+        pho_req_t *unpacked;
+        pho_req_t req;
+
+        pho_srl_request_read_alloc(&req, 1);
+        req.id = qos;
+        req.ralloc->n_required = 1;
+        set_rsc_id(req.ralloc->med_ids[0], "medium");
+        if (qos != PHO_QOS_UNSET) {
+            req.has_qos = true;
+            req.qos = qos;
+        }
+
+        pho_srl_request_pack(&req, &buf);
+        pho_srl_request_free(&req, false);
+
+        unpacked = pho_srl_request_unpack(&buf);
+        assert_non_null(unpacked);
+        assert_true(pho_request_is_read(unpacked));
+        assert_int_equal(unpacked->id, qos);
+        assert_int_equal(pho_request_qos(unpacked),
+                         qos == PHO_QOS_UNSET ? PHO_QOS_NORMAL : qos);
+
+        pho_srl_request_free(unpacked, true);
+    }
+}
+
+int main(void)
+{
+    const struct CMUnitTest srl_lrs_test_cases[] = {
+        cmocka_unit_test(srl_request_write_sources),
+        cmocka_unit_test(srl_response_write_sources),
+        cmocka_unit_test(srl_request_qos),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(srl_lrs_test_cases, NULL, NULL);
+}
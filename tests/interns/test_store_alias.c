@@ -46,6 +46,7 @@ static void test_fill_put_params(void)
     char *alias_name_no_layout = "empty-layout-test";
     char *alias_name_no_tags = "empty-tag-test";
     char *alias_name_no_library = "empty-lib-test";
+    char *alias_name_qos = "qos-test";
     char *pre_existing_tag[1];
 
     pre_existing_tag[0] = "new-tag";
@@ -154,6 +155,29 @@ static void test_fill_put_params(void)
     assert(xfer.xd_params.put.library == NULL);
 
     tags_free(&xfer.xd_params.put.tags);
+
+    /* test alias with a QoS class, a zeroed xfer has no class set */
+    xfer = empty_xfer;
+    xfer.xd_params.put.alias = alias_name_qos;
+    assert(xfer.xd_qos == PHO_QOS_UNSET);
+
+    assert(fill_put_params(&xfer) == 0);
+
+    assert(xfer.xd_params.put.family == PHO_RSC_DIR);
+    assert(xfer.xd_qos == PHO_QOS_BULK);
+
+    tags_free(&xfer.xd_params.put.tags);
+
+    /* test QoS class given by the client */
+    xfer = empty_xfer;
+    xfer.xd_params.put.alias = alias_name_qos;
+    xfer.xd_qos = PHO_QOS_INTERACTIVE;
+
+    assert(fill_put_params(&xfer) == 0);
+
+    assert(xfer.xd_qos == PHO_QOS_INTERACTIVE);
+
+    tags_free(&xfer.xd_params.put.tags);
 }
 
 static void load_config(char *execution_filename)
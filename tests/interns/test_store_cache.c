@@ -0,0 +1,350 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the read cache of the store
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "store_cache.h"
+
+#include "pho_common.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define UUID "cache-uuid"
+#define OTHER_UUID "cache-other-uuid"
+#define DATA "0123456789"
+#define DATA_SIZE (sizeof(DATA) - 1)
+
+static char cache_dir[] = "/tmp/test_store_cache.XXXXXX";
+
+static int cache_setup(void **state)
+{
+    struct read_cache *cache = xcalloc(1, sizeof(*cache));
+
+    /* room for two objects */
+    setenv("PHOBOS_STORE_cache_dir", cache_dir, 1);
+    setenv("PHOBOS_STORE_cache_max_bytes", "25", 1);
+    read_cache_init(cache);
+    assert_non_null(cache->dir);
+
+    *state = cache;
+
+    return 0;
+}
+
+static int cache_teardown(void **state)
+{
+    struct read_cache *cache = *state;
+    char *path;
+
+    read_cache_invalidate(cache, UUID);
+    read_cache_invalidate(cache, OTHER_UUID);
+    if (asprintf(&path, "%s/.stats", cache_dir) > 0) {
+        unlink(path);
+        free(path);
+    }
+
+    read_cache_fini(cache);
+    free(cache);
+
+    return 0;
+}
+
+/* destination of a GET, opened for writing only like the ones of the CLI */
+static void xfer_init(struct pho_xfer_desc *xfer, const char *uuid,
+                      int version)
+{
+    char path[] = "/tmp/test_store_cache_dst.XXXXXX";
+    int fd;
+
+    memset(xfer, 0, sizeof(*xfer));
+    xfer->xd_op = PHO_XFER_OP_GET;
+    xfer->xd_objid = (char *) uuid;
+    xfer->xd_objuuid = (char *) uuid;
+    xfer->xd_version = version;
+
+    fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+    xfer->xd_fd = open(path, O_WRONLY);
+    assert_true(xfer->xd_fd >= 0);
+    unlink(path);
+}
+
+static char *entry_path(const char *uuid, int version)
+{
+    char *path;
+
+    assert_true(asprintf(&path, "%s/%s/%d", cache_dir, uuid, version) > 0);
+
+    return path;
+}
+
+static bool entry_exists(const char *uuid, int version)
+{
+    char *path = entry_path(uuid, version);
+    bool exists = !access(path, F_OK);
+
+    free(path);
+
+    return exists;
+}
+
+/* make the entry \p age seconds old for the LRU */
+static void entry_age(const char *uuid, int version, time_t age)
+{
+    struct timespec times[2];
+    char *path = entry_path(uuid, version);
+
+    clock_gettime(CLOCK_REALTIME, &times[0]);
+    times[0].tv_sec -= age;
+    times[1] = times[0];
+    assert_int_equal(utimensat(AT_FDCWD, path, times, 0), 0);
+    free(path);
+}
+
+/* GET an object which is not cached, and add it to the cache */
+static void cache_miss(struct read_cache *cache, const char *uuid,
+                       int version)
+{
+    struct pho_xfer_desc xfer;
+    struct cache_info info;
+    int rc;
+
+    xfer_init(&xfer, uuid, version);
+
+    rc = read_cache_get(cache, &xfer, DATA_SIZE, &info);
+    assert_int_equal(rc, -ENOENT);
+    assert_false(info.hit);
+    assert_int_equal(info.start, 0);
+
+    /* the object is retrieved from its media */
+    assert_int_equal(write(xfer.xd_fd, DATA, DATA_SIZE), DATA_SIZE);
+
+    rc = read_cache_add(cache, &xfer, &info);
+    assert_return_code(rc, -rc);
+    close(xfer.xd_fd);
+}
+
+/* GET an object from the cache */
+static void cache_hit(struct read_cache *cache, const char *uuid, int version)
+{
+    char path[64];
+    char buffer[DATA_SIZE];
+    struct pho_xfer_desc xfer;
+    struct cache_info info;
+    int fd;
+    int rc;
+
+    xfer_init(&xfer, uuid, version);
+
+    rc = read_cache_get(cache, &xfer, DATA_SIZE, &info);
+    assert_return_code(rc, -rc);
+    assert_true(info.hit);
+
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", xfer.xd_fd);
+    fd = open(path, O_RDONLY);
+    assert_true(fd >= 0);
+    assert_int_equal(read(fd, buffer, sizeof(buffer)), DATA_SIZE);
+    assert_memory_equal(buffer, DATA, DATA_SIZE);
+    close(fd);
+
+    /* a hit is not added again */
+    rc = read_cache_add(cache, &xfer, &info);
+    assert_return_code(rc, -rc);
+    close(xfer.xd_fd);
+}
+
+static void check_stats(struct read_cache *cache, size_t hits, size_t misses,
+                        size_t evictions, size_t n_entries)
+{
+    struct pho_read_cache_stats stats;
+    int rc;
+
+    rc = read_cache_stats_get(cache, &stats);
+    assert_return_code(rc, -rc);
+    assert_int_equal(stats.hits, hits);
+    assert_int_equal(stats.misses, misses);
+    assert_int_equal(stats.evictions, evictions);
+    assert_int_equal(stats.n_entries, n_entries);
+    assert_int_equal(stats.size, n_entries * DATA_SIZE);
+    assert_int_equal(stats.max_size, 25);
+}
+
+/* an object is retrieved from its media once, then from the cache */
+static void rc_miss_then_hit(void **state)
+{
+    struct read_cache *cache = *state;
+    struct stat st;
+    char *path;
+
+    cache_miss(cache, UUID, 1);
+    assert_true(entry_exists(UUID, 1));
+    check_stats(cache, 0, 1, 0, 1);
+
+    /* the objects are only readable by the processes sharing the cache */
+    path = entry_path(UUID, 1);
+    assert_int_equal(stat(path, &st), 0);
+    assert_int_equal(st.st_mode & 0777, 0600);
+    free(path);
+
+    cache_hit(cache, UUID, 1);
+    cache_hit(cache, UUID, 1);
+    check_stats(cache, 2, 1, 0, 1);
+
+    /* another version is another entry */
+    cache_miss(cache, UUID, 2);
+    check_stats(cache, 2, 2, 0, 2);
+}
+
+/* the least recently read entry is evicted to make room for a new one */
+static void rc_lru_eviction(void **state)
+{
+    struct read_cache *cache = *state;
+
+    cache_miss(cache, UUID, 1);
+    cache_miss(cache, OTHER_UUID, 1);
+    entry_age(UUID, 1, 20);
+    entry_age(OTHER_UUID, 1, 10);
+
+    /* reading the oldest entry makes it the most recently used */
+    cache_hit(cache, UUID, 1);
+
+    cache_miss(cache, UUID, 2);
+    assert_true(entry_exists(UUID, 1));
+    assert_true(entry_exists(UUID, 2));
+    assert_false(entry_exists(OTHER_UUID, 1));
+    check_stats(cache, 1, 3, 1, 2);
+}
+
+/* a deleted or overwritten object is removed from the cache */
+static void rc_invalidate(void **state)
+{
+    struct read_cache *cache = *state;
+    char *path;
+
+    cache_miss(cache, UUID, 1);
+    cache_miss(cache, UUID, 2);
+    cache_miss(cache, OTHER_UUID, 1);
+
+    read_cache_invalidate(cache, UUID);
+    assert_false(entry_exists(UUID, 1));
+    assert_false(entry_exists(UUID, 2));
+    assert_true(entry_exists(OTHER_UUID, 1));
+
+    assert_true(asprintf(&path, "%s/%s", cache_dir, UUID) > 0);
+    assert_int_equal(access(path, F_OK), -1);
+    free(path);
+
+    /* not cached anymore */
+    cache_miss(cache, UUID, 2);
+
+    /* nothing to remove */
+    read_cache_invalidate(cache, "unknown");
+}
+
+/* an entry whose size is not the one of its object is never served */
+static void rc_size_mismatch(void **state)
+{
+    struct read_cache *cache = *state;
+    struct pho_xfer_desc xfer;
+    struct cache_info info;
+    int rc;
+
+    cache_miss(cache, UUID, 1);
+
+    xfer_init(&xfer, UUID, 1);
+    rc = read_cache_get(cache, &xfer, DATA_SIZE + 1, &info);
+    assert_int_equal(rc, -ENOENT);
+    assert_false(info.hit);
+    assert_int_equal(lseek(xfer.xd_fd, 0, SEEK_CUR), 0);
+    close(xfer.xd_fd);
+
+    assert_false(entry_exists(UUID, 1));
+    check_stats(cache, 0, 2, 0, 0);
+}
+
+/* only whole objects are added to the cache */
+static void rc_range_not_cached(void **state)
+{
+    struct read_cache *cache = *state;
+    struct pho_xfer_desc xfer;
+    struct cache_info info;
+    int rc;
+
+    xfer_init(&xfer, UUID, 1);
+    xfer.xd_params.get.offset = 2;
+
+    rc = read_cache_get(cache, &xfer, DATA_SIZE, &info);
+    assert_int_equal(rc, -ENOENT);
+    assert_int_equal(info.start, -1);
+
+    assert_int_equal(write(xfer.xd_fd, DATA, 4), 4);
+    rc = read_cache_add(cache, &xfer, &info);
+    assert_return_code(rc, -rc);
+    close(xfer.xd_fd);
+
+    assert_false(entry_exists(UUID, 1));
+}
+
+int main(void)
+{
+    const struct CMUnitTest store_cache_test_cases[] = {
+        cmocka_unit_test_setup_teardown(rc_miss_then_hit, cache_setup,
+                                        cache_teardown),
+        cmocka_unit_test_setup_teardown(rc_lru_eviction, cache_setup,
+                                        cache_teardown),
+        cmocka_unit_test_setup_teardown(rc_invalidate, cache_setup,
+                                        cache_teardown),
+        cmocka_unit_test_setup_teardown(rc_size_mismatch, cache_setup,
+                                        cache_teardown),
+        cmocka_unit_test_setup_teardown(rc_range_not_cached, cache_setup,
+                                        cache_teardown),
+    };
+    int rc;
+
+    if (!mkdtemp(cache_dir))
+        return EXIT_FAILURE;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    rc = cmocka_run_group_tests(store_cache_test_cases, NULL, NULL);
+    rmdir(cache_dir);
+
+    return rc;
+}
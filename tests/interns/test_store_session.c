@@ -0,0 +1,290 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2024 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests of the write sessions of the store
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "store_session.h"
+
+#include "pho_common.h"
+#include "pho_srl_lrs.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define MEDIUM "session_medium"
+#define MAX_SENT 8
+
+/* requests sent to the LRS, by kind and id */
+static struct {
+    int kind;
+    int id;
+} sent[MAX_SENT];
+static int n_sent;
+static int send_rc;
+
+/* the LRS connection of the write sessions */
+int pho_comm_send(const struct pho_comm_data *data)
+{
+    struct pho_buff buf;
+    pho_req_t *req;
+
+    if (send_rc)
+        return send_rc;
+
+    /* the unpacking frees its buffer, the one of data belongs to the sender */
+    buf.size = data->buf.size;
+    buf.buff = xmalloc(buf.size);
+    memcpy(buf.buff, data->buf.buff, buf.size);
+    req = pho_srl_request_unpack(&buf);
+    assert_non_null(req);
+    assert_true(n_sent < MAX_SENT);
+
+    sent[n_sent].kind = pho_request_is_write(req) ?
+        PHO_REQUEST_KIND__RQ_WRITE : PHO_REQUEST_KIND__RQ_RELEASE;
+    sent[n_sent].id = req->id;
+    n_sent++;
+    pho_srl_request_free(req, true);
+
+    return 0;
+}
+
+static int ws_setup(void **state)
+{
+    static struct pho_comm_info comm = { .socket_fd = -1 };
+    struct write_sessions *ws = xcalloc(1, sizeof(*ws));
+
+    g_queue_init(&ws->responses);
+    ws->comm = &comm;
+    ws->max_bytes = 1000;
+    ws->max_ms = 60000;
+    n_sent = 0;
+    send_rc = 0;
+
+    *state = ws;
+
+    return 0;
+}
+
+static int ws_teardown(void **state)
+{
+    struct write_sessions *ws = *state;
+
+    write_sessions_fini(ws);
+    free(ws);
+
+    return 0;
+}
+
+static void send_walloc(struct write_sessions *ws, int id, size_t size)
+{
+    size_t n_tags = 0;
+    pho_req_t req;
+    int rc;
+
+    pho_srl_request_write_alloc(&req, 1, &n_tags);
+    req.id = id;
+    req.walloc->family = PHO_RSC_DIR;
+    req.walloc->media[0]->size = size;
+
+    rc = write_sessions_send(ws, &req);
+    assert_return_code(rc, -rc);
+}
+
+static void send_release(struct write_sessions *ws, int id, size_t written)
+{
+    pho_req_t req;
+    int rc;
+
+    pho_srl_request_release_alloc(&req, 1);
+    req.id = id;
+    req.release->media[0]->med_id->family = PHO_RSC_DIR;
+    req.release->media[0]->med_id->name = xstrdup(MEDIUM);
+    req.release->media[0]->med_id->library = xstrdup("legacy");
+    req.release->media[0]->size_written = written;
+    req.release->media[0]->nb_extents_written = 1;
+    req.release->media[0]->to_sync = true;
+
+    rc = write_sessions_send(ws, &req);
+    assert_return_code(rc, -rc);
+}
+
+/* the LRS grants the allocation of the session of \p id */
+static void recv_walloc(struct write_sessions *ws, int id)
+{
+    pho_resp_t resp;
+
+    pho_srl_response_write_alloc(&resp, 1);
+    resp.req_id = id;
+    resp.walloc->media[0]->med_id->family = PHO_RSC_DIR;
+    resp.walloc->media[0]->med_id->name = xstrdup(MEDIUM);
+    resp.walloc->media[0]->med_id->library = xstrdup("legacy");
+    resp.walloc->media[0]->avail_size = 10000;
+    resp.walloc->media[0]->root_path = xstrdup("/tmp");
+
+    /* delivered to the transfer which requested the allocation */
+    assert_false(write_sessions_recv(ws, &resp));
+    pho_srl_response_free(&resp, false);
+}
+
+/* the LRS acknowledges the release of the session of \p id */
+static void recv_release(struct write_sessions *ws, int id)
+{
+    pho_resp_t resp;
+
+    pho_srl_response_release_alloc(&resp, 1);
+    resp.req_id = id;
+    resp.release->med_ids[0]->family = PHO_RSC_DIR;
+    resp.release->med_ids[0]->name = xstrdup(MEDIUM);
+    resp.release->med_ids[0]->library = xstrdup("legacy");
+
+    assert_true(write_sessions_recv(ws, &resp));
+    pho_srl_response_free(&resp, false);
+}
+
+/* pop the next response of the sessions, which must be for \p id */
+static void check_response(struct write_sessions *ws, int id, bool write)
+{
+    pho_resp_t *resp = write_sessions_pop_response(ws);
+
+    assert_non_null(resp);
+    assert_int_equal(resp->req_id, id);
+    if (write)
+        assert_true(pho_response_is_write(resp));
+    else
+        assert_true(pho_response_is_release(resp));
+    write_sessions_response_free(resp);
+}
+
+/* a transfer requesting the same media joins the pending session */
+static void ws_join(void **state)
+{
+    struct write_sessions *ws = *state;
+    int rc;
+
+    send_walloc(ws, 0, 100);
+    send_walloc(ws, 1, 100);
+
+    /* only the allocation of the session is sent */
+    assert_int_equal(n_sent, 1);
+    assert_int_equal(sent[0].kind, PHO_REQUEST_KIND__RQ_WRITE);
+    assert_int_equal(sent[0].id, 0);
+
+    recv_walloc(ws, 0);
+    rc = write_sessions_flush(ws);
+    assert_return_code(rc, -rc);
+
+    /* the waiting transfer is served from the session */
+    check_response(ws, 1, true);
+    assert_null(write_sessions_pop_response(ws));
+    assert_int_equal(n_sent, 1);
+
+    /* the media are released once, when both transfers released them */
+    send_release(ws, 1, 100);
+    assert_int_equal(n_sent, 1);
+    send_release(ws, 0, 100);
+    assert_int_equal(n_sent, 2);
+    assert_int_equal(sent[1].kind, PHO_REQUEST_KIND__RQ_RELEASE);
+    assert_int_equal(sent[1].id, 0);
+
+    recv_release(ws, 0);
+    check_response(ws, 0, false);
+    check_response(ws, 1, false);
+    assert_true(write_sessions_idle(ws));
+}
+
+/* the transfer owning the session ends, the other one keeps writing */
+static void ws_owner_end(void **state)
+{
+    struct write_sessions *ws = *state;
+    int rc;
+
+    send_walloc(ws, 0, 100);
+    recv_walloc(ws, 0);
+    send_walloc(ws, 1, 100);
+    check_response(ws, 1, true);
+
+    rc = write_sessions_xfer_end(ws, 0);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_sent, 1);
+
+    send_release(ws, 1, 100);
+    assert_int_equal(n_sent, 2);
+    assert_int_equal(sent[1].kind, PHO_REQUEST_KIND__RQ_RELEASE);
+
+    /* only the remaining transfer gets the release */
+    recv_release(ws, 0);
+    check_response(ws, 1, false);
+    assert_null(write_sessions_pop_response(ws));
+    assert_true(write_sessions_idle(ws));
+}
+
+/* the end of the last writing transfer closes the session */
+static void ws_close(void **state)
+{
+    struct write_sessions *ws = *state;
+    pho_resp_t *resp;
+    int rc;
+
+    send_walloc(ws, 0, 100);
+    recv_walloc(ws, 0);
+    send_walloc(ws, 1, 100);
+    check_response(ws, 1, true);
+    send_release(ws, 1, 100);
+
+    /* the release of the session cannot be sent */
+    send_rc = -ENOTCONN;
+    rc = write_sessions_xfer_end(ws, 0);
+    assert_int_equal(rc, -ENOTCONN);
+
+    resp = write_sessions_pop_response(ws);
+    assert_non_null(resp);
+    assert_int_equal(resp->req_id, 1);
+    assert_true(pho_response_is_error(resp));
+    assert_int_equal(resp->error->rc, -ENOTCONN);
+    write_sessions_response_free(resp);
+    assert_true(write_sessions_idle(ws));
+}
+
+int main(void)
+{
+    const struct CMUnitTest store_session_test_cases[] = {
+        cmocka_unit_test_setup_teardown(ws_join, ws_setup, ws_teardown),
+        cmocka_unit_test_setup_teardown(ws_owner_end, ws_setup,
+                                        ws_teardown),
+        cmocka_unit_test_setup_teardown(ws_close, ws_setup, ws_teardown),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(store_session_test_cases, NULL, NULL);
+}